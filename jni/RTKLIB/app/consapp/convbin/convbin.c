@@ -54,13 +54,32 @@
 #define PRGNAME   "CONVBIN"
 #define TRACEFILE "convbin.trace"
 #define NOUTFILE        9       /* number of output files */
+#define MAXINFILE       1024    /* max number of input files */
+
+/* type definitions ----------------------------------------------------------*/
+typedef struct {                /* conversion task type */
+    int format;                 /* input format */
+    rnxopt_t opt;               /* RINEX options */
+    char *ifile;                /* input file */
+    double size;                /* input file size (bytes) */
+    double time;                /* conversion time (s) */
+    int stat;                   /* conversion status */
+} task_t;
+
+/* global variables ----------------------------------------------------------*/
+static task_t *tasks=NULL;      /* conversion tasks */
+static int ntask=0,itask=0;     /* number of tasks and next task index */
+static char **ofiles=NULL;      /* output files */
+static char *odir="";           /* output directory */
+static int quiet=0;             /* suppress messages */
+static lock_t tasklock;         /* lock flag of tasks */
 
 /* help text -----------------------------------------------------------------*/
 static const char *help[]={
 "",
 " Synopsys",
 "",
-" convbin [option ...] file", 
+" convbin [option ...] file [file ...]", 
 "",
 " Description",
 "",
@@ -89,7 +108,7 @@ static const char *help[]={
 "",
 " Options [default]",
 "",
-"     file         input receiver binary log file",
+"     file         input receiver binary log file(s)",
 "     -ts y/m/d h:m:s  start time [all]",
 "     -te y/m/d h:m:s  end time [all]",
 "     -tr y/m/d h:m:s  approximated time for RTCM",
@@ -143,6 +162,9 @@ static const char *help[]={
 "     -b cfile     output RINEX CNAV file",
 "     -i ifile     output RINEX INAV file",
 "     -s sfile     output SBAS message file",
+"     -onepass     decode input file only once (single-pass) [off]",
+"     -j njob      number of concurrent conversions for multiple input",
+"                  files [number of cpus]",
 "     -trace level output trace level [off]",
 "",
 " If any output file specified, default output files (<file>.obs,",
@@ -152,6 +174,12 @@ static const char *help[]={
 " Without -tr option, the program obtains the week number from the time-tag file"
 " (if it exists) or the last modified time of the log file instead.",
 "",
+" If multiple input files are specified, each file is converted independently",
+" to the default output files. Up to njob files are converted concurrently.",
+" Options -o, -n, -g, -h, -q, -l, -b, -i, -s and -c are not allowed for",
+" multiple input files. After conversion, the input data rate (MB/s) and the",
+" rate per core are shown.",
+"",
 " If receiver type is not specified, type is recognized by the input",
 " file extension as follows.",
 "     *.rtcm2       RTCM 2",
@@ -180,6 +208,7 @@ static void printhelp(void)
 extern int showmsg(const char *format, ...)
 {
     va_list arg;
+    if (quiet) return 0;
     va_start(arg,format); vfprintf(stderr,format,arg); va_end(arg);
     fprintf(stderr,*format?"\r":"\n");
     return 0;
@@ -189,7 +218,7 @@ static int convbin(int format, rnxopt_t *opt, const char *ifile, char **file,
                    char *dir)
 {
     int i,def;
-    static char work[1024],ofile_[NOUTFILE][1024]={"","","","","","","","",""};
+    char work[1024],ofile_[NOUTFILE][1024]={"","","","","","","","",""};
     char ifile_[1024],*ofile[NOUTFILE],*p;
     char *extnav=(opt->rnxver<=299||opt->navsys==SYS_GPS)?"N":"P";
     char *extlog="sbs";
@@ -293,6 +322,8 @@ static int convbin(int format, rnxopt_t *opt, const char *ifile, char **file,
         else strcpy(work,ofile[i]);
         sprintf(ofile[i],"%s%c%s",dir,FILEPATHSEP,work);
     }
+    if (quiet) return convrnx(format,opt,ifile,ofile)?0:-1;
+    
     fprintf(stderr,"input file  : %s (%s)\n",ifile,formatstrs[format]);
     
     if (*ofile[0]) fprintf(stderr,"->rinex obs : %s\n",ofile[0]);
@@ -374,14 +405,34 @@ static int get_filetime(const char *file, gtime_t *time)
     }
     return 0;
 }
+/* get input file size -------------------------------------------------------*/
+static double get_filesize(const char *file)
+{
+    struct stat st;
+    double size=0.0;
+    char *paths[MAXEXFILE]={0};
+    int i,n=0;
+    
+    for (i=0;i<MAXEXFILE;i++) {
+        if (!(paths[i]=(char *)malloc(1024))) break;
+    }
+    if (i>=MAXEXFILE) n=expath(file,paths,MAXEXFILE);
+    
+    for (i=0;i<n;i++) {
+        if (!stat(paths[i],&st)) size+=(double)st.st_size;
+    }
+    for (i=0;i<MAXEXFILE;i++) free(paths[i]);
+    return size;
+}
 /* parse command line options ------------------------------------------------*/
-static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
-                   char **ofile, char **dir, int *trace)
+static void cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
+                    int *nfile, char **ofile, char **dir, int *trace,
+                    int *njob, char **fmt)
 {
     double eps[]={1980,1,1,0,0,0},epe[]={2037,12,31,0,0,0};
     double epr[]={2010,1,1,0,0,0},span=0.0;
-    int i,j,k,sat,nf=5,nc=2,format=-1;
-    char *p,*sys,*fmt="",*paths[1],path[1024],buff[256];
+    int i,j,k,sat,nf=5,nc=2;
+    char *p,*sys,buff[256];
     
     opt->rnxver=304;
     opt->obstype=OBSTYPE_PR|OBSTYPE_CP;
@@ -415,7 +466,7 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
             span=atof(argv[++i]);
         }
         else if (!strcmp(argv[i],"-r" )&&i+1<argc) {
-            fmt=argv[++i];
+            *fmt=argv[++i];
         }
         else if (!strcmp(argv[i],"-ro")&&i+1<argc) {
             strcpy(opt->rcvopt,argv[++i]);
@@ -524,12 +575,18 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
         else if (!strcmp(argv[i],"-b" )&&i+1<argc) ofile[6]=argv[++i];
         else if (!strcmp(argv[i],"-i" )&&i+1<argc) ofile[7]=argv[++i];
         else if (!strcmp(argv[i],"-s" )&&i+1<argc) ofile[8]=argv[++i];
+        else if (!strcmp(argv[i],"-onepass")) {
+            opt->onepass=1;
+        }
+        else if (!strcmp(argv[i],"-j" )&&i+1<argc) {
+            *njob=atoi(argv[++i]);
+        }
         else if (!strcmp(argv[i],"-trace" )&&i+1<argc) {
             *trace=atoi(argv[++i]);
         }
         else if (!strncmp(argv[i],"-",1)) printhelp();
         
-        else *ifile=argv[i];
+        else if (*nfile<MAXINFILE) ifile[(*nfile)++]=argv[i];
     }
     if (span>0.0&&opt->ts.time) {
         opt->te=timeadd(opt->ts,span*3600.0-1e-3);
@@ -539,10 +596,13 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
     if (nf>=3) opt->freqtype|=FREQTYPE_L3;
     if (nf>=4) opt->freqtype|=FREQTYPE_L4;
     if (nf>=5) opt->freqtype|=FREQTYPE_L5;
+}
+/* get input format ----------------------------------------------------------*/
+static int getformat(const char *fmt, const char *file)
+{
+    int format=-1;
+    char *p,*paths[1],path[1024];
     
-    if (!opt->trtcm.time) {
-        get_filetime(*ifile,&opt->trtcm);
-    }
     if (*fmt) {
         if      (!strcmp(fmt,"rtcm2")) format=STRFMT_RTCM2;
         else if (!strcmp(fmt,"rtcm3")) format=STRFMT_RTCM3;
@@ -562,7 +622,7 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
     }
     else {
         paths[0]=path;
-        if (!expath(*ifile,paths,1)||!(p=strrchr(path,'.'))) return -1;
+        if (!expath(file,paths,1)||!(p=strrchr(path,'.'))) return -1;
         if      (!strcmp(p,".rtcm2"))  format=STRFMT_RTCM2;
         else if (!strcmp(p,".rtcm3"))  format=STRFMT_RTCM3;
         else if (!strcmp(p,".gps"  ))  format=STRFMT_OEM4;
@@ -586,38 +646,160 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
     }
     return format;
 }
+/* set conversion task ------------------------------------------------------*/
+static int settask(task_t *task, const char *fmt, const rnxopt_t *opt,
+                   char *ifile)
+{
+    task->ifile=ifile;
+    task->opt=*opt;
+    task->stat=-1;
+    task->size=task->time=0.0;
+    
+    if ((task->format=getformat(fmt,ifile))<0) {
+        fprintf(stderr,"input format can not be recognized: %s\n",ifile);
+        return 0;
+    }
+    if (!task->opt.trtcm.time) {
+        get_filetime(ifile,&task->opt.trtcm);
+    }
+    sprintf(task->opt.comment[0],"log: %-55.55s",ifile);
+    sprintf(task->opt.comment[1],"format: %s",formatstrs[task->format]);
+    if (*task->opt.rcvopt) {
+        strcat(task->opt.comment[1],", option: ");
+        strcat(task->opt.comment[1],task->opt.rcvopt);
+    }
+    task->size=get_filesize(ifile);
+    return 1;
+}
+/* execute conversion task ---------------------------------------------------*/
+static void exectask(task_t *task)
+{
+    uint32_t tick=tickget();
+    
+    task->stat=convbin(task->format,&task->opt,task->ifile,ofiles,odir);
+    task->time=(tickget()-tick)*1E-3;
+    
+    if (!quiet) return;
+    
+    lock(&tasklock);
+    fprintf(stderr,"%s (%s): %.1f MB %.2f s %s\n",task->ifile,
+            formatstrs[task->format],task->size*1E-6,task->time,
+            task->stat?"error":"ok");
+    unlock(&tasklock);
+}
+/* conversion thread ---------------------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI convthread(void *arg)
+#else
+static void *convthread(void *arg)
+#endif
+{
+    task_t *task;
+    
+    for (;;) {
+        lock(&tasklock);
+        task=itask<ntask?tasks+itask++:NULL;
+        unlock(&tasklock);
+        if (!task) break;
+        exectask(task);
+    }
+    return 0;
+}
+/* execute conversion tasks --------------------------------------------------*/
+static int exectasks(int njob)
+{
+    thread_t thread[MAXINFILE];
+    uint32_t tick=tickget();
+    double size=0.0,time;
+    int i,nt,run[MAXINFILE]={0},stat=0;
+    
+    nt=njob<ntask?njob:ntask;
+    if (nt<1) nt=1;
+    
+    initlock(&tasklock);
+    
+    for (i=1;i<nt;i++) {
+#ifdef WIN32
+        if (!(thread[i]=CreateThread(NULL,0,convthread,NULL,0,NULL))) break;
+#else
+        if (pthread_create(thread+i,NULL,convthread,NULL)) break;
+#endif
+        run[i]=1;
+    }
+    convthread(NULL);
+    
+    for (i=1;i<nt;i++) {
+        if (!run[i]) continue;
+#ifdef WIN32
+        WaitForSingleObject(thread[i],INFINITE);
+        CloseHandle(thread[i]);
+#else
+        pthread_join(thread[i],NULL);
+#endif
+    }
+    for (nt=1;nt<MAXINFILE&&run[nt];nt++) ;
+    
+    time=(tickget()-tick)*1E-3;
+    
+    for (i=0;i<ntask;i++) {
+        size+=tasks[i].size;
+        if (tasks[i].stat) stat=-1;
+    }
+    if (time<=0.0) time=1E-3;
+    
+    fprintf(stderr,"converted   : %d file(s) %.1f MB %.2f s %.2f MB/s "
+            "(%.2f MB/s per core, %d core(s))\n",ntask,size*1E-6,time,
+            size*1E-6/time,size*1E-6/time/nt,nt);
+    return stat;
+}
 /* main ----------------------------------------------------------------------*/
 int main(int argc, char **argv)
 {
     rnxopt_t opt={{0}};
-    int format,trace=0,stat;
-    char *ifile="",*ofile[NOUTFILE]={0},*dir="";
+    int i,nfile=0,trace=0,njob=0,stat;
+    char *ifile[MAXINFILE],*ofile[NOUTFILE]={0},*dir="",*fmt="";
     
     /* parse command line options */
-    format=cmdopts(argc,argv,&opt,&ifile,ofile,&dir,&trace);
+    cmdopts(argc,argv,&opt,ifile,&nfile,ofile,&dir,&trace,&njob,&fmt);
     
-    if (!*ifile) {
+    if (nfile<=0) {
         fprintf(stderr,"no input file\n");
         return -1;
     }
-    if (format<0) {
-        fprintf(stderr,"input format can not be recognized\n");
-        return -1;
+    if (nfile>1) {
+        for (i=0;i<NOUTFILE;i++) if (ofile[i]) break;
+        if (i<NOUTFILE||*opt.staid) {
+            fprintf(stderr,"output file option for multiple input files\n");
+            return -1;
+        }
+        quiet=1;
     }
+    if (njob<=0) njob=getncpu();
+    
     sprintf(opt.prog,"%s %s %s",PRGNAME,VER_RTKLIB,PATCH_LEVEL);
-    sprintf(opt.comment[0],"log: %-55.55s",ifile);
-    sprintf(opt.comment[1],"format: %s",formatstrs[format]);
-    if (*opt.rcvopt) {
-        strcat(opt.comment[1],", option: ");
-        strcat(opt.comment[1],opt.rcvopt);
+    
+    if (!(tasks=(task_t *)malloc(sizeof(task_t)*nfile))) {
+        fprintf(stderr,"memory allocation error\n");
+        return -1;
     }
+    for (i=0;i<nfile;i++) {
+        if (!settask(tasks+i,fmt,&opt,ifile[i])) {
+            free(tasks);
+            return -1;
+        }
+    }
+    ntask=nfile;
+    ofiles=ofile;
+    odir=dir;
+    
     if (trace>0) {
         traceopen(TRACEFILE);
         tracelevel(trace);
     }
-    stat=convbin(format,&opt,ifile,ofile,dir);
+    stat=exectasks(njob);
     
     traceclose();
+    free(tasks);
     
     return stat;
 }
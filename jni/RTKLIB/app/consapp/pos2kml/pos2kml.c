@@ -22,7 +22,9 @@ static const char *help[]={
 "",
 " usage: pos2kml [option]... file [...]",
 "",
-" Read solution file(s) and convert it to Google Earth KML file or GPX file.",
+" Read solution file(s) and convert it to Google Earth KML file, GPX file or",
+" solution file of another format (e.g. binary solution to text). With -stat,",
+" binary solution status file(s) are converted to text solution status.",
 " Each line in the input file shall contain fields of time, position fields ",
 " (latitude/longitude/height or x/y/z-ecef), and quality flag(option). The line",
 " started with '%', '#', ';' is treated as comment. Command options are as ",
@@ -30,7 +32,8 @@ static const char *help[]={
 "",
 " -h        print help",
 " -o file   output file [infile + .kml]",
-" -c color  track color (0:off,1:white,2:green,3:orange,4:red,5:yellow) [5]",
+" -c color  track color (0:off,1:white,2:green,3:orange,4:red,5:yellow,",
+"           6:by qflag) [5]",
 " -p color  point color (0:off,1:white,2:green,3:orange,4:red,5:by qflag) [5]",
 " -a        output altitude information [off]",
 " -ag       output geodetic altitude [off]",
@@ -39,7 +42,11 @@ static const char *help[]={
 " -i tint   output time interval (s) (0:all) [0]",
 " -q qflg   output q-flags (0:all) [0]",
 " -f n e h  add north/east/height offset to position (m) [0 0 0]",
-" -gpx      output GPX file"
+" -dp tol   decimate track and points by Douglas-Peucker with tolerance (m)",
+"           (0:off) [0]",
+" -gpx      output GPX file",
+" -sol fmt  output solution file (0:llh,1:xyz,2:enu,6:bin) [infile + .pos/.bin]",
+" -stat     convert binary solution status file to text [infile + .txt]"
 };
 /* print help ----------------------------------------------------------------*/
 static void printhelp(void)
@@ -51,9 +58,11 @@ static void printhelp(void)
 /* pos2kml main --------------------------------------------------------------*/
 int main(int argc, char **argv)
 {
-    int i,j,n,outalt=0,outtime=0,qflg=0,tcolor=5,pcolor=5,gpx=0,stat;
+    solopt_t solopt=solopt_default;
+    int i,j,n,outalt=0,outtime=0,qflg=0,tcolor=5,pcolor=5,gpx=0,sol=-1,stat;
+    int sstat=0;
     char *infile[32],*outfile="";
-    double offset[3]={0.0},tint=0.0,es[6]={2000,1,1},ee[6]={2000,1,1};
+    double offset[3]={0.0},tint=0.0,tol=0.0,es[6]={2000,1,1},ee[6]={2000,1,1};
     gtime_t ts={0},te={0};
     
     for (i=1,n=0;i<argc;i++) {
@@ -79,11 +88,15 @@ int main(int argc, char **argv)
         else if (!strcmp(argv[i],"-tu")) outtime=2;
         else if (!strcmp(argv[i],"-i")&&i+i<argc) tint=atof(argv[++i]);
         else if (!strcmp(argv[i],"-q")&&i+i<argc) qflg=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-dp")&&i+1<argc) tol=atof(argv[++i]);
         else if (!strcmp(argv[i],"-gpx")) gpx=1;
+        else if (!strcmp(argv[i],"-sol")&&i+1<argc) sol=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-stat")) sstat=1;
         else if (*argv[i]=='-') printhelp();
         else if (n<32) infile[n++]=argv[i];
     }
-    if (tcolor<0||5<tcolor||pcolor<0||5<pcolor) {
+    if (tcolor<0||6<tcolor||pcolor<0||5<pcolor||
+        (sol>=0&&sol!=SOLF_LLH&&sol!=SOLF_XYZ&&sol!=SOLF_ENU&&sol!=SOLF_BIN)) {
         fprintf(stderr,"pos2kml : command option error\n");
         return -1;
     }
@@ -91,14 +104,22 @@ int main(int argc, char **argv)
         fprintf(stderr,"pos2kml : no input file\n");
         return -1;
     }
+    solopt.posf=sol;
+    
     for (i=0;i<n;i++) {
-        if (gpx) {
-            stat=convgpx(infile[i],outfile,ts,te,tint,qflg,offset,tcolor,pcolor,
-                         outalt,outtime);
+        if (sstat) {
+            stat=convstat(infile[i],outfile);
+        }
+        else if (sol>=0) {
+            stat=convsol(infile[i],outfile,ts,te,tint,qflg,&solopt);
+        }
+        else if (gpx) {
+            stat=convgpxdp(infile[i],outfile,ts,te,tint,qflg,offset,tcolor,
+                           pcolor,outalt,outtime,tol);
         }
         else {
-            stat=convkml(infile[i],outfile,ts,te,tint,qflg,offset,tcolor,pcolor,
-                         outalt,outtime);
+            stat=convkmldp(infile[i],outfile,ts,te,tint,qflg,offset,tcolor,
+                           pcolor,outalt,outtime,tol);
         }
         switch (stat) {
         case -1: fprintf(stderr,"pos2kml : file read error (%d)\n",i+1);   break;
@@ -69,8 +69,11 @@ static const char *help[]={
 "           rover receiver ecef pos (m) for fixed or ppp-fixed mode",
 " -l lat lon hgt reference (base) receiver latitude/longitude/height (deg/m)",
 "           rover latitude/longitude/height for fixed or ppp-fixed mode",
-" -y level  output soltion status (0:off,1:states,2:residuals) [0]",
-" -x level  debug trace level (0:off) [0]"
+" -y level  output soltion status (0:off,1:states,2:residuals,3:binary) [0]",
+" -x level  debug trace level (0:off) [0]",
+" -cache dir cache directory of parsed input files [input file directory]",
+"           cache files (*.rtc) are written next to the input files by default",
+" --no-cache disable cache of parsed input files [on]"
 };
 /* show message --------------------------------------------------------------*/
 extern int showmsg(const char *format, ...)
@@ -98,8 +101,8 @@ int main(int argc, char **argv)
     filopt_t filopt={""};
     gtime_t ts={0},te={0};
     double tint=0.0,es[]={2000,1,1,0,0,0},ee[]={2000,12,31,23,59,59},pos[3];
-    int i,j,n,ret;
-    char *infile[MAXFILE],*outfile="",*p;
+    int i,j,n,ret,cache=1;
+    char *infile[MAXFILE],*outfile="",*cachedir="",*p;
     
     prcopt.mode  =PMODE_KINEMA;
     prcopt.navsys=0;
@@ -174,6 +177,8 @@ int main(int argc, char **argv)
         }
         else if (!strcmp(argv[i],"-y")&&i+1<argc) solopt.sstat=atoi(argv[++i]);
         else if (!strcmp(argv[i],"-x")&&i+1<argc) solopt.trace=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-cache")&&i+1<argc) cachedir=argv[++i];
+        else if (!strcmp(argv[i],"--no-cache")) cache=0;
         else if (*argv[i]=='-') printhelp();
         else if (n<MAXFILE) infile[n++]=argv[i];
     }
@@ -184,6 +189,8 @@ int main(int argc, char **argv)
         showmsg("error : no input file");
         return -2;
     }
+    setcache(cache,cachedir);
+    
     ret=postpos(ts,te,tint,0.0,&prcopt,&solopt,&filopt,infile,n,outfile,"","");
     
     if (!ret) fprintf(stderr,"%40s\r","");
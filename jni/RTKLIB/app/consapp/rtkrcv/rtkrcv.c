@@ -134,7 +134,7 @@ static const char *usage[]={
     "  -d dev     terminal device for console",
     "  -o file    processing options file",
     "  -w pwd     login password for remote console (\"\": no password)",
-    "  -r level   output solution status file (0:off,1:states,2:residuals)",
+    "  -r level   output solution status file (0:off,1:states,2:residuals,3:binary)",
     "  -t level   debug trace level (0:off,1-5:on)",
     "  -sta sta   station name for receiver dcb"
 };
@@ -155,6 +155,7 @@ static const char *helptxt[]={
     "load [file]           : load options from file",
     "save [file]           : save options to file",
     "log [file|off]        : start/stop log to file",
+    "profile [reset|cycle] : show stage profile",
     "help|? [path]         : print help",
     "exit|ctr-D            : logout console (only for telnet)",
     "shutdown              : shutdown rtk server",
@@ -182,7 +183,7 @@ static const char *pathopts[]={         /* path options help */
 #define OSTOPT  "0:off,1:serial,2:file,3:tcpsvr,4:tcpcli,5:ntripsvr,9:ntripcas"
 #define FMTOPT  "0:rtcm2,1:rtcm3,2:oem4,4:ubx,5:swift,6:hemis,7:skytraq,8:javad,9:nvs,10:binex,11:rt17,12:sbf,14,15:sp3"
 #define NMEOPT  "0:off,1:latlon,2:single"
-#define SOLOPT  "0:llh,1:xyz,2:enu,3:nmea,4:stat"
+#define SOLOPT  "0:llh,1:xyz,2:enu,3:nmea,4:stat,6:bin"
 #define MSGOPT  "0:all,1:rover,2:base,3:corr"
 
 static opt_t rcvopts[]={
@@ -936,7 +937,7 @@ static void prstream(vt_t *vt)
     };
     const char *fmt[]={"rtcm2","rtcm3","oem4","","ubx","swift","hemis","skytreq",
                        "javad","nvs","binex","rt17","sbf","","","sp3",""};
-    const char *sol[]={"llh","xyz","enu","nmea","stat","-"};
+    const char *sol[]={"llh","xyz","enu","nmea","stat","gsif","bin"};
     stream_t stream[9];
     int i,format[9]={0};
     
@@ -1024,18 +1025,20 @@ static void cmd_restart(char **args, int narg, vt_t *vt)
 /* solution command ----------------------------------------------------------*/
 static void cmd_solution(char **args, int narg, vt_t *vt)
 {
-    int i,cycle=0;
+    sol_t sol;
+    int cycle=0;
     
     trace(3,"cmd_solution:\n");
     
     if (narg>1) cycle=(int)(atof(args[1])*1000.0);
     
-    if (cycle>0) svr.nsol=0;
+    if (cycle>0) while (solringget(&svr.solring,&sol,NULL)) ;
     
     while (!vt_chkbrk(vt)) {
         rtksvrlock(&svr);
-        for (i=0;i<svr.nsol;i++) prsolution(vt,&svr.solbuf[i],svr.rtk.rb);
-        svr.nsol=0;
+        while (solringget(&svr.solring,&sol,NULL)) {
+            prsolution(vt,&sol,svr.rtk.rb);
+        }
         rtksvrunlock(&svr);
         if (cycle>0) sleepms(cycle); else return;
     }
@@ -1300,6 +1303,32 @@ static void cmd_log(char **args, int narg, vt_t *vt)
     }
     vt_printf(vt,"log on: %s\n",args[1]);
 }
+/* profile command -----------------------------------------------------------*/
+static void cmd_profile(char **args, int narg, vt_t *vt)
+{
+    prof_t prof;
+    char buff[(NPRFSTAGE+1)*128];
+    int cycle=0,reset=0;
+    
+    trace(3,"cmd_profile:\n");
+    
+    if (narg>1) {
+        if (!strcmp(args[1],"reset")) reset=1;
+        else cycle=(int)(atof(args[1])*1000.0);
+    }
+    while (!vt_chkbrk(vt)) {
+        if (cycle>0) vt_printf(vt,ESC_CLEAR);
+        if (!rtksvrpstat(&svr,&prof,reset)) {
+            vt_printf(vt,"stage profiling disabled (set misc-profile on)\n");
+            return;
+        }
+        prf2str(&prof,"",buff);
+        vt_printf(vt,"%s",buff);
+        if (reset) vt_printf(vt,"profile reset\n");
+        if (cycle>0) sleepms(cycle); else return;
+    }
+    vt_printf(vt,"\n");
+}
 /* help command --------------------------------------------------------------*/
 static void cmd_help(char **args, int narg, vt_t *vt)
 {
@@ -1343,7 +1372,7 @@ static void *con_thread(void *arg)
     const char *cmds[]={
         "start","stop","restart","solution","status","satellite","observ",
         "navidata","stream","ssr","error","option","set","load","save","log",
-        "help","?","exit","shutdown",""
+        "profile","help","?","exit","shutdown",""
     };
     con_t *con=(con_t *)arg;
     int i,j,narg;
@@ -1405,12 +1434,13 @@ static void *con_thread(void *arg)
             case 13: cmd_load     (args,narg,con->vt); break;
             case 14: cmd_save     (args,narg,con->vt); break;
             case 15: cmd_log      (args,narg,con->vt); break;
-            case 16: cmd_help     (args,narg,con->vt); break;
+            case 16: cmd_profile  (args,narg,con->vt); break;
             case 17: cmd_help     (args,narg,con->vt); break;
-            case 18: /* exit */
+            case 18: cmd_help     (args,narg,con->vt); break;
+            case 19: /* exit */
                 if (con->vt->type) con->state=0;
                 break;
-            case 19: /* shutdown */
+            case 20: /* shutdown */
                 if (!strcmp(args[0],"shutdown")) {
                     vt_printf(con->vt,"rtk server shutdown ...\n");
                     sleepms(1000);
@@ -1544,7 +1574,7 @@ static void accept_sock(int ssock, con_t **con)
 *     -d dev     terminal device for console
 *     -o file    processing options file
 *     -w pwd     login password for remote console ("": no password)
-*     -r level   output solution status file (0:off,1:states,2:residuals)
+*     -r level   output solution status file (0:off,1:states,2:residuals,3:binary)
 *     -t level   debug trace level (0:off,1-5:on)
 *     -sta sta   station name for receiver dcb
 *
@@ -1605,6 +1635,12 @@ static void accept_sock(int ssock, con_t **con)
 *     log [file|off]
 *       Record console log to file. To stop recording the log, use option off.
 *
+*     profile [reset|cycle]
+*       Show processing time profile of positioning stages and stream read/
+*       decode (calls, total, mean, percentiles and maximum). With option
+*       reset, the profile is cleared after shown. The profile is collected
+*       only if the option misc-profile is set to on.
+*
 *     help|? [path]
 *       Show the command list. With option path, the stream path options are
 *       shown.
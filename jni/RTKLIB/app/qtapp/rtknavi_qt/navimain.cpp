@@ -1309,8 +1309,8 @@ void MainWindow::SvrStop(void)
 // callback on interval timer -----------------------------------------------
 void MainWindow::TimerTimer()
 {
-    sol_t *sol;
-    int i, update = 0;
+    sol_t sol;
+    int update = 0;
 
     trace(4, "TimerTimer\n");
 
@@ -1318,13 +1318,11 @@ void MainWindow::TimerTimer()
 
     rtksvrlock(&rtksvr);
 
-    for (i = 0; i < rtksvr.nsol; i++) {
-        sol = rtksvr.solbuf + i;
-        UpdateLog(sol->stat, sol->time, sol->rr, sol->qr, rtksvr.rtk.rb, sol->ns,
-              sol->age, sol->ratio);
+    while (solringget(&rtksvr.solring, &sol, NULL)) {
+        UpdateLog(sol.stat, sol.time, sol.rr, sol.qr, rtksvr.rtk.rb, sol.ns,
+              sol.age, sol.ratio);
         update = 1;
     }
-    rtksvr.nsol = 0;
     SolCurrentStat = rtksvr.state ? rtksvr.rtk.sol.stat : 0;
 
     rtksvrunlock(&rtksvr);
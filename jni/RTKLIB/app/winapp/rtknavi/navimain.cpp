@@ -1357,8 +1357,8 @@ void __fastcall TMainForm::SvrStop(void)
 // callback on interval timer -----------------------------------------------
 void __fastcall TMainForm::TimerTimer(TObject *Sender)
 {
-    sol_t *sol;
-    int i,update=0;
+    sol_t sol;
+    int update=0;
     uint8_t buff[8];
     
     trace(4,"TimerTimer\n");
@@ -1367,13 +1367,11 @@ void __fastcall TMainForm::TimerTimer(TObject *Sender)
     
     rtksvrlock(&rtksvr);
     
-    for (i=0;i<rtksvr.nsol;i++) {
-        sol=rtksvr.solbuf+i;
-        UpdateLog(sol->stat,sol->time,sol->rr,sol->qr,rtksvr.rtk.rb,sol->ns,
-                  sol->age,sol->ratio);
+    while (solringget(&rtksvr.solring,&sol,NULL)) {
+        UpdateLog(sol.stat,sol.time,sol.rr,sol.qr,rtksvr.rtk.rb,sol.ns,
+                  sol.age,sol.ratio);
         update=1;
     }
-    rtksvr.nsol=0;
     SolCurrentStat=rtksvr.state?rtksvr.rtk.sol.stat:0;
     
     rtksvrunlock(&rtksvr);
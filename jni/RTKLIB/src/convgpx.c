@@ -51,23 +51,26 @@ static void outpoint(FILE *fp, gtime_t time, const double *pos,
     fprintf(fp,"</wpt>\n");
 }
 /* output track --------------------------------------------------------------*/
-static void outtrack(FILE *fp, const solbuf_t *solbuf, int outalt, int outtime)
+static int outtrack(FILE *fp, solfp_t *solf, const double *dr, int outalt,
+                    int outtime)
 {
+    sol_t sol;
     gtime_t time;
-    double pos[3],ep[6];
-    int i;
+    double rr[3],pos[3],ep[6];
+    int i,n;
     
     fprintf(fp,"<trk>\n");
     fprintf(fp," <trkseg>\n");
-    for (i=0;i<solbuf->n;i++) {
-        ecef2pos(solbuf->data[i].rr,pos);
+    for (n=0;solfread(solf,&sol);n++) {
+        for (i=0;i<3;i++) rr[i]=sol.rr[i]+dr[i];
+        ecef2pos(rr,pos);
         fprintf(fp,"  <trkpt lat=\"%.9f\" lon=\"%.9f\">\n",pos[0]*R2D,
                 pos[1]*R2D);
         if (outalt) {
             fprintf(fp,"   <ele>%.4f</ele>\n",pos[2]-(outalt==2?geoidh(pos):0.0));
         }
         if (outtime) {
-            time=solbuf->data[i].time;
+            time=sol.time;
             if      (outtime==2) time=gpst2utc(time);
             else if (outtime==3) time=timeadd(gpst2utc(time),9*3600.0);
             time2epoch(time,ep);
@@ -81,13 +84,18 @@ static void outtrack(FILE *fp, const solbuf_t *solbuf, int outalt, int outtime)
     }
     fprintf(fp," </trkseg>\n");
     fprintf(fp,"</trk>\n");
+    return n;
 }
 /* save gpx file -------------------------------------------------------------*/
-static int savegpx(const char *file, const solbuf_t *solbuf, int outtrk,
-                   int outpnt, int outalt, int outtime)
+static int savegpx(const char *file, char *infile, gtime_t ts, gtime_t te,
+                   double tint, int qflg, const double *dr, double *rb,
+                   gtime_t time0, int outtrk, int outpnt, int outalt,
+                   int outtime, double tol)
 {
     FILE *fp;
-    double pos[3];
+    solfp_t solf;
+    sol_t sol;
+    double rr[3],pos[3];
     int i;
     
     if (!(fp=fopen(file,"w"))) {
@@ -99,20 +107,32 @@ static int savegpx(const char *file, const solbuf_t *solbuf, int outtrk,
     
     /* output waypoint */
     if (outpnt) {
-        for (i=0;i<solbuf->n;i++) {
-            ecef2pos(solbuf->data[i].rr,pos);
-            outpoint(fp,solbuf->data[i].time,pos,"",solbuf->data[i].stat,outalt,
-                     outtime);
+        if (!solfopendp(&solf,&infile,1,ts,te,tint,qflg,tol,1)) {
+            fclose(fp);
+            return 0;
+        }
+        while (solfread(&solf,&sol)) {
+            for (i=0;i<3;i++) rr[i]=sol.rr[i]+dr[i];
+            ecef2pos(rr,pos);
+            outpoint(fp,sol.time,pos,"",sol.stat,outalt,outtime);
         }
+        matcpy(rb,solf.rb,3,1);
+        solfclose(&solf);
     }
     /* output waypoint of ref position */
-    if (norm(solbuf->rb,3)>0.0) {
-        ecef2pos(solbuf->rb,pos);
-        outpoint(fp,solbuf->data[0].time,pos,"Reference Position",0,outalt,0);
+    if (norm(rb,3)>0.0) {
+        for (i=0;i<3;i++) rr[i]=rb[i]+dr[i];
+        ecef2pos(rr,pos);
+        outpoint(fp,time0,pos,"Reference Position",0,outalt,0);
     }
     /* output track */
     if (outtrk) {
-        outtrack(fp,solbuf,outalt,outtime);
+        if (!solfopendp(&solf,&infile,1,ts,te,tint,qflg,tol,1)) {
+            fclose(fp);
+            return 0;
+        }
+        outtrack(fp,&solf,dr,outalt,outtime);
+        solfclose(&solf);
     }
     fprintf(fp,"%s\n",TAILGPX);
     fclose(fp);
@@ -130,18 +150,24 @@ static int savegpx(const char *file, const solbuf_t *solbuf, int outtrk,
 *          int    outpnt    I   output waypoint (0:off,1:on)
 *          int    outalt    I   output altitude (0:off,1:elipsoidal,2:geodetic)
 *          int    outtime   I   output time (0:off,1:gpst,2:utc,3:jst)
+*          double tol       I   tolerance of Douglas-Peucker decimation (m)
+*                               (0:no decimation)
 * return : status (0:ok,-1:file read,-2:file format,-3:no data,-4:file write)
+* notes  : solutions are read by solution stream (solfopen()) for each of
+*          waypoints and track with constant memory. the first and the last
+*          solution of each run of the same solution status are kept by the
+*          decimation.
 *-----------------------------------------------------------------------------*/
-extern int convgpx(const char *infile, const char *outfile, gtime_t ts,
-                   gtime_t te, double tint, int qflg, double *offset,
-                   int outtrk, int outpnt, int outalt, int outtime)
+extern int convgpxdp(const char *infile, const char *outfile, gtime_t ts,
+                     gtime_t te, double tint, int qflg, double *offset,
+                     int outtrk, int outpnt, int outalt, int outtime,
+                     double tol)
 {
-    solbuf_t solbuf={0};
-    double rr[3]={0},pos[3],dr[3];
-    int i,j;
+    gtime_t time0={0};
+    double dr[3]={0},rb[3]={0};
     char *p,file[1024];
     
-    trace(3,"convgpx : infile=%s outfile=%s\n",infile,outfile);
+    trace(3,"convgpxdp: infile=%s outfile=%s tol=%.3f\n",infile,outfile,tol);
     
     if (!*outfile) {
         if ((p=strrchr(infile,'.'))) {
@@ -152,24 +178,24 @@ extern int convgpx(const char *infile, const char *outfile, gtime_t ts,
     }
     else strcpy(file,outfile);
     
-    /* read solution file */
-    if (!readsolt((char **)&infile,1,ts,te,tint,qflg,&solbuf)) return -1;
-    
-	/* mean position */
-	for (i=0;i<3;i++) {
-        for (j=0;j<solbuf.n;j++) rr[i]+=solbuf.data[j].rr[i];
-        rr[i]/=solbuf.n;
-    }
-    /* add offset */
-    ecef2pos(rr,pos);
-    enu2ecef(pos,offset,dr);
-    for (i=0;i<solbuf.n;i++) {
-        for (j=0;j<3;j++) solbuf.data[i].rr[j]+=dr[j];
-    }
-    if (norm(solbuf.rb,3)>0.0) {
-        for (i=0;i<3;i++) solbuf.rb[i]+=dr[i];
+    /* first solution, offset by mean position and reference position */
+    if (!solfoffset((char **)&infile,1,ts,te,tint,qflg,offset,
+                    norm(offset,3)>0.0||!outpnt,dr,rb,&time0)) {
+        return -1;
     }
     /* save gpx file */
-    return savegpx(file,&solbuf,outtrk,outpnt,outalt,outtime)?0:-4;
+    return savegpx(file,(char *)infile,ts,te,tint,qflg,dr,rb,time0,outtrk,
+                   outpnt,outalt,outtime,tol)?0:-4;
+}
+/* convert to GPX file ---------------------------------------------------------
+* convert solutions to GPX file [1] without decimation
+* args   : see convgpxdp()
+* return : status (0:ok,-1:file read,-2:file format,-3:no data,-4:file write)
+*-----------------------------------------------------------------------------*/
+extern int convgpx(const char *infile, const char *outfile, gtime_t ts,
+                   gtime_t te, double tint, int qflg, double *offset,
+                   int outtrk, int outpnt, int outalt, int outtime)
+{
+    return convgpxdp(infile,outfile,ts,te,tint,qflg,offset,outtrk,outpnt,
+                     outalt,outtime,0.0);
 }
-
@@ -31,32 +31,69 @@ static const char *head1="<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
 static const char *head2="<kml xmlns=\"http://earth.google.com/kml/2.1\">";
 static const char *mark="http://maps.google.com/mapfiles/kml/pal2/icon18.png";
 
-/* output track --------------------------------------------------------------*/
-static void outtrack(FILE *f, const solbuf_t *solbuf, const char *color,
-                     int outalt, int outtime)
+static const int qcolor[]={0,1,2,5,4,3,0}; /* style by solution status */
+static const char *color[]={
+    "ffffffff","ff008800","ff00aaff","ff0000ff","ff00ffff","ffff00ff"
+};
+/* style index by solution status --------------------------------------------*/
+static int qstyle(int stat)
+{
+    return stat>=0&&stat<=6?qcolor[stat]:0;
+}
+/* output track header -------------------------------------------------------*/
+static void outtrackhead(FILE *f, const char *lcolor, int outalt)
 {
-    double pos[3];
-    int i;
-    
     fprintf(f,"<Placemark>\n");
     fprintf(f,"<name>Rover Track</name>\n");
     fprintf(f,"<Style>\n");
     fprintf(f,"<LineStyle>\n");
-    fprintf(f,"<color>%s</color>\n",color);
+    fprintf(f,"<color>%s</color>\n",lcolor);
     fprintf(f,"</LineStyle>\n");
     fprintf(f,"</Style>\n");
     fprintf(f,"<LineString>\n");
     if (outalt) fprintf(f,"<altitudeMode>absolute</altitudeMode>\n");
     fprintf(f,"<coordinates>\n");
-    for (i=0;i<solbuf->n;i++) {
-        ecef2pos(solbuf->data[i].rr,pos);
+}
+/* output track tail ---------------------------------------------------------*/
+static void outtracktail(FILE *f)
+{
+    fprintf(f,"</coordinates>\n");
+    fprintf(f,"</LineString>\n");
+    fprintf(f,"</Placemark>\n");
+}
+/* output track ----------------------------------------------------------------
+* output track of solutions in solution stream. with tcolor=6, a placemark is
+* output for each run of the same solution status and starts with the last
+* position of the previous run.
+*-----------------------------------------------------------------------------*/
+static int outtrack(FILE *f, solfp_t *solf, const double *dr, int tcolor,
+                    int outalt)
+{
+    sol_t sol;
+    double rr[3],pos[3],prev[3]={0};
+    int i,n=0,stat=-1;
+    
+    while (solfread(solf,&sol)) {
+        for (i=0;i<3;i++) rr[i]=sol.rr[i]+dr[i];
+        ecef2pos(rr,pos);
         if      (outalt==0) pos[2]=0.0;
         else if (outalt==2) pos[2]-=geoidh(pos);
+        
+        if (stat<0||(tcolor==6&&sol.stat!=stat)) {
+            if (stat>=0) outtracktail(f);
+            outtrackhead(f,color[tcolor==6?qstyle(sol.stat):tcolor-1],outalt);
+            if (stat>=0) {
+                fprintf(f,"%13.9f,%12.9f,%5.3f\n",prev[1]*R2D,prev[0]*R2D,
+                        prev[2]);
+            }
+            stat=sol.stat;
+        }
         fprintf(f,"%13.9f,%12.9f,%5.3f\n",pos[1]*R2D,pos[0]*R2D,pos[2]);
+        for (i=0;i<3;i++) prev[i]=pos[i];
+        n++;
     }
-    fprintf(f,"</coordinates>\n");
-    fprintf(f,"</LineString>\n");
-    fprintf(f,"</Placemark>\n");
+    if (stat>=0) outtracktail(f);
+    return n;
 }
 /* output point --------------------------------------------------------------*/
 static void outpoint(FILE *fp, gtime_t time, const double *pos,
@@ -92,15 +129,17 @@ static void outpoint(FILE *fp, gtime_t time, const double *pos,
     fprintf(fp,"</Placemark>\n");
 }
 /* save kml file -------------------------------------------------------------*/
-static int savekml(const char *file, const solbuf_t *solbuf, int tcolor,
-                   int pcolor, int outalt, int outtime)
+static int savekml(const char *file, char **files, int nfile, gtime_t ts,
+                   gtime_t te, double tint, int qflg, const double *dr,
+                   double *rb, gtime_t time0, int tcolor, int pcolor,
+                   int outalt, int outtime, double tol)
 {
     FILE *fp;
-    double pos[3];
-    int i,qcolor[]={0,1,2,5,4,3,0};
-    char *color[]={
-        "ffffffff","ff008800","ff00aaff","ff0000ff","ff00ffff","ffff00ff"
-    };
+    solfp_t solf;
+    sol_t sol;
+    double rr[3],pos[3];
+    int i,n=0;
+    
     if (!(fp=fopen(file,"w"))) {
         fprintf(stderr,"file open error : %s\n",file);
         return 0;
@@ -117,25 +156,41 @@ static int savekml(const char *file, const solbuf_t *solbuf, int tcolor,
         fprintf(fp,"</Style>\n");
     }
     if (tcolor>0) {
-        outtrack(fp,solbuf,color[tcolor-1],outalt,outtime);
+        if (!solfopendp(&solf,files,nfile,ts,te,tint,qflg,tol,tcolor==6)) {
+            fclose(fp);
+            return 0;
+        }
+        n=outtrack(fp,&solf,dr,tcolor,outalt);
+        matcpy(rb,solf.rb,3,1);
+        solfclose(&solf);
     }
     if (pcolor>0) {
+        if (!solfopendp(&solf,files,nfile,ts,te,tint,qflg,tol,pcolor==5)) {
+            fclose(fp);
+            return 0;
+        }
         fprintf(fp,"<Folder>\n");
         fprintf(fp,"  <name>Rover Position</name>\n");
-        for (i=0;i<solbuf->n;i++) {
-            ecef2pos(solbuf->data[i].rr,pos);
-            outpoint(fp,solbuf->data[i].time,pos,"",
-                     pcolor==5?qcolor[solbuf->data[i].stat]:pcolor-1,outalt,outtime);
+        for (n=0;solfread(&solf,&sol);n++) {
+            for (i=0;i<3;i++) rr[i]=sol.rr[i]+dr[i];
+            ecef2pos(rr,pos);
+            outpoint(fp,sol.time,pos,"",pcolor==5?qstyle(sol.stat):pcolor-1,
+                     outalt,outtime);
         }
         fprintf(fp,"</Folder>\n");
+        matcpy(rb,solf.rb,3,1);
+        solfclose(&solf);
     }
-    if (norm(solbuf->rb,3)>0.0) {
-        ecef2pos(solbuf->rb,pos);
-        outpoint(fp,solbuf->data[0].time,pos,"Reference Position",0,outalt,0);
+    if (norm(rb,3)>0.0) {
+        for (i=0;i<3;i++) rr[i]=rb[i]+dr[i];
+        ecef2pos(rr,pos);
+        outpoint(fp,time0,pos,"Reference Position",0,outalt,0);
     }
     fprintf(fp,"</Document>\n");
     fprintf(fp,"</kml>\n");
     fclose(fp);
+    
+    trace(3,"savekml: file=%s n=%d\n",file,n);
     return 1;
 }
 /* convert to google earth kml file --------------------------------------------
@@ -147,24 +202,34 @@ static int savekml(const char *file, const solbuf_t *solbuf, int tcolor,
 *          int    qflg      I   quality flag (0:all)
 *          double *offset   I   add offset {east,north,up} (m)
 *          int    tcolor    I   track color
-*                               (0:none,1:white,2:green,3:orange,4:red,5:yellow)
+*                               (0:none,1:white,2:green,3:orange,4:red,5:yellow,
+*                                6:by qflag)
 *          int    pcolor    I   point color
 *                               (0:none,1:white,2:green,3:orange,4:red,5:by qflag)
 *          int    outalt    I   output altitude (0:off,1:elipsoidal,2:geodetic)
 *          int    outtime   I   output time (0:off,1:gpst,2:utc,3:jst)
+*          double tol       I   tolerance of Douglas-Peucker decimation (m)
+*                               (0:no decimation)
 * return : status (0:ok,-1:file read,-2:file format,-3:no data,-4:file write)
 * notes  : see ref [1] for google earth kml file format
+*          solutions are read by solution stream (solfopen()) for each of
+*          track and points with constant memory. input files are read in
+*          the order of expanded file paths without merge by time.
+*          with decimation, the track and the points are decimated separately.
+*          with color by qflag, the first and the last solution of each run of
+*          the same solution status are kept.
 *-----------------------------------------------------------------------------*/
-extern int convkml(const char *infile, const char *outfile, gtime_t ts,
-                   gtime_t te, double tint, int qflg, double *offset,
-                   int tcolor, int pcolor, int outalt, int outtime)
+extern int convkmldp(const char *infile, const char *outfile, gtime_t ts,
+                     gtime_t te, double tint, int qflg, double *offset,
+                     int tcolor, int pcolor, int outalt, int outtime,
+                     double tol)
 {
-    solbuf_t solbuf={0};
-    double rr[3]={0},pos[3],dr[3];
-    int i,j,nfile,stat;
+    gtime_t time0={0};
+    double dr[3]={0},rb[3]={0};
+    int i,nfile,stat;
     char *p,file[1024],*files[MAXEXFILE]={0};
     
-    trace(3,"convkml : infile=%s outfile=%s\n",infile,outfile);
+    trace(3,"convkmldp: infile=%s outfile=%s tol=%.3f\n",infile,outfile,tol);
     
     /* expand wild-card of infile */
     for (i=0;i<MAXEXFILE;i++) {
@@ -186,28 +251,30 @@ extern int convkml(const char *infile, const char *outfile, gtime_t ts,
     }
     else strcpy(file,outfile);
     
-    /* read solution file */
-    stat=readsolt(files,nfile,ts,te,tint,qflg,&solbuf);
-    
-    for (i=0;i<MAXEXFILE;i++) free(files[i]);
-    
-    if (!stat) {
-        return -1;
-    }
-    /* mean position */
-    for (i=0;i<3;i++) {
-        for (j=0;j<solbuf.n;j++) rr[i]+=solbuf.data[j].rr[i];
-        rr[i]/=solbuf.n;
-    }
-    /* add offset */
-    ecef2pos(rr,pos);
-    enu2ecef(pos,offset,dr);
-    for (i=0;i<solbuf.n;i++) {
-        for (j=0;j<3;j++) solbuf.data[i].rr[j]+=dr[j];
-    }
-    if (norm(solbuf.rb,3)>0.0) {
-        for (i=0;i<3;i++) solbuf.rb[i]+=dr[i];
+    /* first solution, offset by mean position and reference position */
+    if (!solfoffset(files,nfile,ts,te,tint,qflg,offset,
+                    norm(offset,3)>0.0||(tcolor<=0&&pcolor<=0),dr,rb,&time0)) {
+        stat=-1;
     }
     /* save kml file */
-    return savekml(file,&solbuf,tcolor,pcolor,outalt,outtime)?0:-4;
+    else if (!savekml(file,files,nfile,ts,te,tint,qflg,dr,rb,time0,tcolor,
+                      pcolor,outalt,outtime,tol)) {
+        stat=-4;
+    }
+    else stat=0;
+    
+    for (i=0;i<MAXEXFILE;i++) free(files[i]);
+    return stat;
+}
+/* convert to google earth kml file --------------------------------------------
+* convert solutions to google earth kml file without decimation
+* args   : see convkmldp()
+* return : status (0:ok,-1:file read,-2:file format,-3:no data,-4:file write)
+*-----------------------------------------------------------------------------*/
+extern int convkml(const char *infile, const char *outfile, gtime_t ts,
+                   gtime_t te, double tint, int qflg, double *offset,
+                   int tcolor, int pcolor, int outalt, int outtime)
+{
+    return convkmldp(infile,outfile,ts,te,tint,qflg,offset,tcolor,pcolor,
+                     outalt,outtime,0.0);
 }
@@ -49,6 +49,7 @@
 #define NOUTFILE        9       /* number of output files */
 #define NSATSYS         7       /* number of satellite systems */
 #define TSTARTMARGIN    60.0    /* time margin for file name replacement */
+#define MAXOBSBUFF      (64*1024*1024) /* max obs buffer in memory (bytes) */
 
 #define EVENT_STARTMOVE 2       /* rinex event start moving antenna */
 #define EVENT_NEWSITE   3       /* rinex event new site occupation */
@@ -88,6 +89,18 @@ typedef struct {                /* stream file type */
     FILE   *fp;                 /* output file pointer */
 } strfile_t;
 
+typedef struct {                /* observation epoch buffer type */
+    uint8_t *buff;              /* epoch records in memory */
+    size_t nb,nmax;             /* size and allocated size of buffer (bytes) */
+    size_t rp;                  /* read pointer of buffer (bytes) */
+    FILE   *fp;                 /* spill file (NULL: in memory) */
+} obsbuf_t;
+
+typedef struct {                /* observation epoch record type */
+    gtime_t time;               /* message time */
+    int n,flag,staid;           /* number of obs data, event flag, station ID */
+} obsrec_t;
+
 /* global variables ----------------------------------------------------------*/
 static const int navsys[]={     /* system codes */
     SYS_GPS,SYS_GLO,SYS_GAL,SYS_QZS,SYS_SBS,SYS_CMP,SYS_IRN,0
@@ -169,6 +182,7 @@ static strfile_t *gen_strfile(int format, const char *opt)
         str->nav=&str->rtcm.nav; 
         str->sta=&str->rtcm.sta; 
         strcpy(str->rtcm.opt,opt);
+        compopt(str->rtcm.opt,&str->rtcm.copt);
     }
     else if (format<=MAXRCVFMT) {
         if (!init_raw(&str->raw,format)) {
@@ -180,6 +194,7 @@ static strfile_t *gen_strfile(int format, const char *opt)
         str->nav=&str->raw.nav;
         str->sta=&str->raw.sta;
         strcpy(str->raw.opt,opt);
+        compopt(str->raw.opt,&str->raw.copt);
     }
     else if (format==STRFMT_RINEX) {
         if (!init_rnxctr(&str->rnx)) {
@@ -714,81 +729,58 @@ static void resolve_halfc(const strfile_t *str, obsd_t *data, int n)
         data[i].LLI[j]&=~(LLI_HALFA|LLI_HALFS);
     }
 }
-/* scan input files ----------------------------------------------------------*/
-static int scan_file(char **files, int nf, rnxopt_t *opt, strfile_t *str,
-                     int *mask)
+/* scan message for obs-types, half-cycle ambiguity and station info --------*/
+static void scan_msg(int type, const rnxopt_t *opt, strfile_t *str,
+                     uint8_t codes[][33], uint8_t types[][33], int *n)
 {
-    eph_t  eph0 ={0,-1,-1};
-    geph_t geph0={0,-1};
-    seph_t seph0={0};
-    uint8_t codes[NSATSYS][33]={{0}};
-    uint8_t types[NSATSYS][33]={{0}};
-    char msg[128];
-    int i,j,k,l,m,c=0,type,sys,prn,abort=0,n[NSATSYS]={0};
-    
-    trace(3,"scan_file: nf=%d\n",nf);
-    
-    for (m=0;m<nf&&!abort;m++) {
-        
-        if (!open_strfile(str,files[m])) {
-            continue;
-        }
-        while ((type=input_strfile(str))>=-1) {
-            if (opt->ts.time&&timediff(str->time,opt->ts)<-opt->ttol) continue;
-            if (opt->te.time&&timediff(str->time,opt->te)>-opt->ttol) break;
-            mask[m]=1; /* update file mask */
+    int i,j,k,l,sys;
+    
+    if (type==1) { /* observation data */
+        for (i=0;i<str->obs->n;i++) {
+            sys=satsys(str->obs->data[i].sat,NULL);
+            if (!(sys&opt->navsys)) continue;
+            for (l=0;navsys[l];l++) if (navsys[l]==sys) break;
+            if (!navsys[l]) continue;
             
-            if (type==1) { /* observation data */
-                for (i=0;i<str->obs->n;i++) {
-                    sys=satsys(str->obs->data[i].sat,NULL);
-                    if (!(sys&opt->navsys)) continue;
-                    for (l=0;navsys[l];l++) if (navsys[l]==sys) break;
-                    if (!navsys[l]) continue;
-                    
-                    /* update obs-types */
-                    for (j=0;j<NFREQ+NEXOBS;j++) {
-                        if (!str->obs->data[i].code[j]) continue;
-                        
-                        for (k=0;k<n[l];k++) {
-                            if (codes[l][k]==str->obs->data[i].code[j]) break;
-                        }
-                        if (k>=n[l]&&n[l]<32) {
-                            codes[l][n[l]++]=str->obs->data[i].code[j];
-                        }
-                        if (k<n[l]) {
-                            if (str->obs->data[i].P[j]!=0.0) types[l][k]|=1;
-                            if (str->obs->data[i].L[j]!=0.0) types[l][k]|=2;
-                            if (str->obs->data[i].D[j]!=0.0) types[l][k]|=4;
-                            if (str->obs->data[i].SNR[j]!=0) types[l][k]|=8;
-                        }
-                    }
-                    /* update half-cycle ambiguity list */
-                    if (opt->halfcyc) {
-                        update_halfc(str,str->obs->data+i);
-                    }
+            /* update obs-types */
+            for (j=0;j<NFREQ+NEXOBS;j++) {
+                if (!str->obs->data[i].code[j]) continue;
+                
+                for (k=0;k<n[l];k++) {
+                    if (codes[l][k]==str->obs->data[i].code[j]) break;
                 }
-                /* update station list */
-                update_stas(str);
+                if (k>=n[l]&&n[l]<32) {
+                    codes[l][n[l]++]=str->obs->data[i].code[j];
+                }
+                if (k<n[l]) {
+                    if (str->obs->data[i].P[j]!=0.0) types[l][k]|=1;
+                    if (str->obs->data[i].L[j]!=0.0) types[l][k]|=2;
+                    if (str->obs->data[i].D[j]!=0.0) types[l][k]|=4;
+                    if (str->obs->data[i].SNR[j]!=0) types[l][k]|=8;
                 }
-            else if (type==5) { /* station info */
-                /* update station info */
-                update_stainf(str);
             }
-            if (++c%11) continue;
-            
-            sprintf(msg,"scanning: %s %s%s%s%s%s%s%s",time_str(str->time,0),
-                    n[0]?"G":"",n[1]?"R":"",n[2]?"E":"",n[3]?"J":"",
-                    n[4]?"S":"",n[5]?"C":"",n[6]?"I":"");
-            if ((abort=showmsg(msg))) break;
+            /* update half-cycle ambiguity list */
+            if (opt->halfcyc) {
+                update_halfc(str,str->obs->data+i);
+            }
         }
-        close_strfile(str);
+        /* update station list */
+        update_stas(str);
     }
-    showmsg("");
-    
-    if (abort) {
-        trace(2,"aborted in scan\n");
-        return 0;
+    else if (type==5) { /* station info */
+        /* update station info */
+        update_stainf(str);
     }
+}
+/* set scanned obs-types and station info in RINEX options -------------------*/
+static void setopt_scan(uint8_t codes[][33], uint8_t types[][33], const int *n,
+                        rnxopt_t *opt, strfile_t *str)
+{
+    eph_t  eph0 ={0,-1,-1};
+    geph_t geph0={0,-1};
+    seph_t seph0={0};
+    int i,j,prn;
+    
     for (i=0;i<NSATSYS;i++) for (j=0;j<n[i];j++) {
         trace(2,"scan_file: sys=%d code=%s type=%d\n",i,code2obs(codes[i][j]),
               types[i][j]);
@@ -823,6 +815,46 @@ static int scan_file(char **files, int nf, rnxopt_t *opt, strfile_t *str,
     }
     dump_stas(str);
     dump_halfc(str);
+}
+/* scan input files ----------------------------------------------------------*/
+static int scan_file(char **files, int nf, rnxopt_t *opt, strfile_t *str,
+                     int *mask)
+{
+    uint8_t codes[NSATSYS][33]={{0}};
+    uint8_t types[NSATSYS][33]={{0}};
+    char msg[128];
+    int m,c=0,type,abort=0,n[NSATSYS]={0};
+    
+    trace(3,"scan_file: nf=%d\n",nf);
+    
+    for (m=0;m<nf&&!abort;m++) {
+        
+        if (!open_strfile(str,files[m])) {
+            continue;
+        }
+        while ((type=input_strfile(str))>=-1) {
+            if (opt->ts.time&&timediff(str->time,opt->ts)<-opt->ttol) continue;
+            if (opt->te.time&&timediff(str->time,opt->te)>-opt->ttol) break;
+            mask[m]=1; /* update file mask */
+            
+            scan_msg(type,opt,str,codes,types,n);
+            
+            if (++c%11) continue;
+            
+            sprintf(msg,"scanning: %s %s%s%s%s%s%s%s",time_str(str->time,0),
+                    n[0]?"G":"",n[1]?"R":"",n[2]?"E":"",n[3]?"J":"",
+                    n[4]?"S":"",n[5]?"C":"",n[6]?"I":"");
+            if ((abort=showmsg(msg))) break;
+        }
+        close_strfile(str);
+    }
+    showmsg("");
+    
+    if (abort) {
+        trace(2,"aborted in scan\n");
+        return 0;
+    }
+    setopt_scan(codes,types,n,opt,str);
     return 1;
 }
 /* write RINEX header --------------------------------------------------------*/
@@ -983,31 +1015,36 @@ static int screent_ttol(gtime_t time, gtime_t ts, gtime_t te, double tint,
            (ts.time==0||timediff(time,ts)>=-ttol)&&
            (te.time==0||timediff(time,te)<  ttol);
 }
-/* convert observation data --------------------------------------------------*/
-static void convobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
-                    gtime_t *tend, int *staid)
+/* screen observation data ---------------------------------------------------*/
+static int screen_obs(rnxopt_t *opt, strfile_t *str, gtime_t *tend)
 {
     gtime_t time;
-    int i,j;
     
-    trace(3,"convobs :\n");
-    
-    if (!ofp[0]||str->obs->n<=0) return;
+    if (str->obs->n<=0) return 0;
     
     time=str->obs->data[0].time;
     
     /* avoid duplicated data by multiple files handover */
-    if (tend->time&&timediff(time,*tend)<opt->ttol) return;
+    if (tend->time&&timediff(time,*tend)<opt->ttol) return 0;
     *tend=time;
     
     /* save cycle slips */
     save_slips(str,str->obs->data,str->obs->n);
     
-    if (!screent_ttol(time,opt->ts,opt->te,opt->tint,opt->ttol)) return;
+    if (!screent_ttol(time,opt->ts,opt->te,opt->tint,opt->ttol)) return 0;
     
     /* restore cycle slips */
     rest_slips(str,str->obs->data,str->obs->n);
     
+    return 1;
+}
+/* output observation data ---------------------------------------------------*/
+static void outobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
+                   int *staid)
+{
+    gtime_t time=str->obs->data[0].time;
+    int i,j;
+    
     if (str->staid!=*staid) { /* station ID changed */
         
         if (*staid>=0) { /* output RINEX event */
@@ -1039,6 +1076,16 @@ static void convobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
     
     n[0]++;
 }
+/* convert observation data --------------------------------------------------*/
+static void convobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
+                    gtime_t *tend, int *staid)
+{
+    trace(3,"convobs :\n");
+    
+    if (!ofp[0]||!screen_obs(opt,str,tend)) return;
+    
+    outobs(ofp,opt,str,n,staid);
+}
 /* convert navigattion data --------------------------------------------------*/
 static void convnav(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n)
 {
@@ -1226,6 +1273,204 @@ static int showstat(int sess, gtime_t ts, gtime_t te, int *n)
     }
     return showmsg(msg);
 }
+/* add observation epoch to buffer -------------------------------------------*/
+static int add_obsbuf(obsbuf_t *buf, const strfile_t *str)
+{
+    obsrec_t rec;
+    uint8_t *buff;
+    size_t size,nmax;
+    
+    rec.time=str->time;
+    rec.n=str->obs->n;
+    rec.flag=str->obs->flag;
+    rec.staid=str->staid;
+    size=sizeof(obsrec_t)+sizeof(obsd_t)*rec.n;
+    
+    /* spill buffered epochs to temporary file */
+    if (!buf->fp&&buf->nb+size>MAXOBSBUFF&&(buf->fp=tmpfile())) {
+        trace(3,"add_obsbuf: spill nb=%d\n",(int)buf->nb);
+        if (buf->nb>0&&fwrite(buf->buff,buf->nb,1,buf->fp)<1) return 0;
+        free(buf->buff); buf->buff=NULL;
+        buf->nb=buf->nmax=0;
+    }
+    if (buf->fp) {
+        return fwrite(&rec,sizeof(obsrec_t),1,buf->fp)==1&&
+               fwrite(str->obs->data,sizeof(obsd_t),rec.n,buf->fp)==
+               (size_t)rec.n;
+    }
+    if (buf->nb+size>buf->nmax) {
+        for (nmax=buf->nmax>0?buf->nmax*2:65536;nmax<buf->nb+size;nmax*=2) ;
+        if (!(buff=(uint8_t *)realloc(buf->buff,nmax))) {
+            trace(1,"add_obsbuf: malloc error nmax=%d\n",(int)nmax);
+            return 0;
+        }
+        buf->buff=buff;
+        buf->nmax=nmax;
+    }
+    memcpy(buf->buff+buf->nb,&rec,sizeof(obsrec_t));
+    memcpy(buf->buff+buf->nb+sizeof(obsrec_t),str->obs->data,
+           sizeof(obsd_t)*rec.n);
+    buf->nb+=size;
+    return 1;
+}
+/* read observation epoch from buffer ----------------------------------------*/
+static int read_obsbuf(obsbuf_t *buf, obs_t *obs, gtime_t *time, int *staid)
+{
+    obsrec_t rec;
+    
+    if (buf->fp) {
+        if (fread(&rec,sizeof(obsrec_t),1,buf->fp)<1||rec.n>obs->nmax||
+            fread(obs->data,sizeof(obsd_t),rec.n,buf->fp)<(size_t)rec.n) {
+            return 0;
+        }
+    }
+    else {
+        if (buf->rp+sizeof(obsrec_t)>buf->nb) return 0;
+        memcpy(&rec,buf->buff+buf->rp,sizeof(obsrec_t));
+        if (rec.n>obs->nmax) return 0;
+        memcpy(obs->data,buf->buff+buf->rp+sizeof(obsrec_t),
+               sizeof(obsd_t)*rec.n);
+        buf->rp+=sizeof(obsrec_t)+sizeof(obsd_t)*rec.n;
+    }
+    obs->n=rec.n;
+    obs->flag=rec.flag;
+    *time=rec.time;
+    *staid=rec.staid;
+    return 1;
+}
+/* free observation epoch buffer ---------------------------------------------*/
+static void free_obsbuf(obsbuf_t *buf)
+{
+    if (buf->fp) fclose(buf->fp);
+    free(buf->buff);
+    buf->buff=NULL;
+    buf->fp=NULL;
+    buf->nb=buf->nmax=buf->rp=0;
+}
+/* RINEX converter for single-session in single-pass -------------------------*/
+static int convrnx_p(int sess, int format, rnxopt_t *opt, strfile_t *str,
+                     char **epath, int nf, const char *path, char **ofile)
+{
+    FILE *ofp[NOUTFILE]={NULL},*tfp[NOUTFILE]={NULL};
+    obsbuf_t buf={0};
+    obs_t obs={0},*obs_str=str->obs;
+    gtime_t tend[3]={{0}};
+    uint8_t codes[NSATSYS][33]={{0}};
+    uint8_t types[NSATSYS][33]={{0}};
+    size_t nb;
+    int i,j,type,n[NOUTFILE+2]={0},ns[NSATSYS]={0},mask[MAXEXFILE]={0};
+    int staid=-1,abort=0,stat=1;
+    char *paths[NOUTFILE],s[NOUTFILE][1024],buff[4096];
+    char *staname=*opt->staid?opt->staid:"0000";
+    
+    trace(3,"convrnx_p: sess=%d nf=%d\n",sess,nf);
+    
+    /* open temporary files for nav and SBAS message bodies */
+    for (i=1;i<NOUTFILE;i++) {
+        if (!*ofile[i]||(tfp[i]=tmpfile())) continue;
+        showmsg("temporary file open error");
+        for (i--;i>0;i--) if (tfp[i]) fclose(tfp[i]);
+        return 0;
+    }
+    for (i=0;i<nf&&!abort&&stat;i++) {
+        
+        /* open stream file */
+        if (!open_strfile(str,epath[i])) continue;
+        
+        /* input message */
+        for (j=0;(type=input_strfile(str))>=-1;j++) {
+            
+            if (!(j%11)&&(abort=showstat(sess,str->time,str->time,n))) break;
+            
+            if (opt->ts.time&&timediff(str->time,opt->ts)<-opt->ttol) continue;
+            if (opt->te.time&&timediff(str->time,opt->te)>-opt->ttol) break;
+            mask[i]=1; /* update file mask */
+            
+            /* update obs-types, half-cycle ambiguity and station info */
+            scan_msg(type,opt,str,codes,types,ns);
+            
+            /* buffer observation data and convert other messages */
+            switch (type) {
+                case  1:
+                    if (!*ofile[0]||!screen_obs(opt,str,tend)) break;
+                    if (!(stat=add_obsbuf(&buf,str))) {
+                        showmsg("observation buffer error");
+                        break;
+                    }
+                    str->obs->flag=0;
+                    n[0]++;
+                    break;
+                case  2: convnav(tfp,opt,str,n); break;
+                case  3: convsbs(tfp,opt,str,n,tend+1); break;
+                case -1: n[NOUTFILE]++; break; /* error */
+            }
+            if (!stat) break;
+            
+            /* set approx position in rinex option */
+            if (type==1&&!opt->autopos&&norm(opt->apppos,3)<=0.0) {
+                setopt_apppos(str,opt);
+            }
+        }
+        /* close stream file */
+        close_strfile(str);
+    }
+    /* set obs-types and station info in RINEX options */
+    setopt_scan(codes,types,ns,opt,str);
+    
+    /* set format and file in RINEX options comments */
+    setopt_file(format,epath,nf,mask,opt);
+    
+    /* replace keywords in output file */
+    for (i=0;i<NOUTFILE&&stat;i++) {
+        paths[i]=s[i];
+        if (reppath(ofile[i],paths[i],opt->ts.time?opt->ts:str->tstart,
+                    staname,"")<0) {
+            showmsg("no time for output path: %s",ofile[i]);
+            stat=0;
+        }
+    }
+    /* open output files and write RINEX headers */
+    if (stat&&!openfile(ofp,paths,path,opt,str->nav)) {
+        stat=0;
+    }
+    if (stat) {
+        
+        /* convert buffered observation data */
+        if (ofp[0]&&(obs.data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) {
+            obs.nmax=MAXOBS;
+            str->obs=&obs;
+            if (buf.fp) rewind(buf.fp);
+            for (n[0]=0;read_obsbuf(&buf,&obs,&str->time,&str->staid);) {
+                outobs(ofp,opt,str,n,&staid);
+            }
+            str->obs=obs_str;
+            free(obs.data);
+        }
+        /* copy nav and SBAS message bodies */
+        for (i=1;i<NOUTFILE;i++) {
+            if (!ofp[i]||!tfp[i]) continue;
+            rewind(tfp[i]);
+            while ((nb=fread(buff,1,sizeof(buff),tfp[i]))>0) {
+                fwrite(buff,1,nb,ofp[i]);
+            }
+        }
+        /* close output files (rewrite RINEX headers) */
+        closefile(ofp,opt,str->nav);
+        
+        /* remove empty output files */
+        for (i=0;i<NOUTFILE;i++) {
+            if (ofp[i]&&n[i]<=0) remove(paths[i]);
+        }
+        showstat(sess,opt->tstart,opt->tend,n);
+    }
+    /* unset RINEX options comments */
+    unsetopt_file(opt);
+    
+    for (i=1;i<NOUTFILE;i++) if (tfp[i]) fclose(tfp[i]);
+    free_obsbuf(&buf);
+    
+    return !stat?0:(abort?-1:1);
+}
 /* RINEX converter for single-session ----------------------------------------*/
 static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
                      char **ofile)
@@ -1234,6 +1479,7 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
     strfile_t *str;
     gtime_t tend[3]={{0}};
     int i,j,nf,type,n[NOUTFILE+2]={0},mask[MAXEXFILE]={0},staid=-1,abort=0;
+    int stat;
     char path[1024],*paths[NOUTFILE],s[NOUTFILE][1024];
     char *epath[MAXEXFILE]={0},*staname=*opt->staid?opt->staid:"0000";
     
@@ -1271,6 +1517,13 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
     for (i=0;i<MAXPRNGLO;i++) {
         str->nav->glo_fcn[i]=opt->glofcn[i]; /* FCN+8 */
     }
+    /* convert input files in single-pass */
+    if (opt->onepass) {
+        stat=convrnx_p(sess,format,opt,str,epath,nf,path,ofile);
+        free_strfile(str);
+        for (i=0;i<MAXEXFILE;i++) free(epath[i]);
+        return stat;
+    }
     /* scan input files */
     if (!scan_file(epath,nf,opt,str,mask)) {
         for (i=0;i<MAXEXFILE;i++) free(epath[i]);
@@ -1367,6 +1620,13 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
 *          keywords in ofile[] are replaced by first observation date/time and
 *          station ID (%r)
 *          the order of wild-card expanded files must be in-order by time
+*          if opt->onepass is set, input files are decoded only once. the
+*          observation data are buffered in memory (spilled to a temporary
+*          file over MAXOBSBUFF bytes) and nav/SBAS messages are written to
+*          temporary files until the obs-types are determined, then RINEX
+*          headers and bodies are written. GLONASS phase in messages without
+*          FCN before the first GLONASS ephemeris may be lost unless
+*          opt->glofcn is set
 *-----------------------------------------------------------------------------*/
 extern int convrnx(int format, rnxopt_t *opt, const char *file, char **ofile)
 {
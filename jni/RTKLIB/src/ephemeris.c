@@ -105,11 +105,6 @@
 
 #define MAX_ITER_KEPLER 30        /* max number of iteration of Kelpler */
 
-/* ephemeris selections ------------------------------------------------------*/
-static int eph_sel[]={ /* GPS,GLO,GAL,QZS,BDS,IRN,SBS */
-    0,0,0,0,0,0,0
-};
-
 /* variance by ura ephemeris -------------------------------------------------*/
 static double var_uraeph(int sys, int ura)
 {
@@ -428,11 +423,11 @@ static eph_t *seleph(gtime_t time, int sat, int iode, const nav_t *nav)
     
     sys=satsys(sat,NULL);
     switch (sys) {
-        case SYS_GPS: tmax=MAXDTOE+1.0    ; sel=eph_sel[0]; break;
-        case SYS_GAL: tmax=MAXDTOE_GAL    ; sel=eph_sel[2]; break;
-        case SYS_QZS: tmax=MAXDTOE_QZS+1.0; sel=eph_sel[3]; break;
-        case SYS_CMP: tmax=MAXDTOE_CMP+1.0; sel=eph_sel[4]; break;
-        case SYS_IRN: tmax=MAXDTOE_IRN+1.0; sel=eph_sel[5]; break;
+        case SYS_GPS: tmax=MAXDTOE+1.0    ; sel=nav->eph_sel[0]; break;
+        case SYS_GAL: tmax=MAXDTOE_GAL    ; sel=nav->eph_sel[2]; break;
+        case SYS_QZS: tmax=MAXDTOE_QZS+1.0; sel=nav->eph_sel[3]; break;
+        case SYS_CMP: tmax=MAXDTOE_CMP+1.0; sel=nav->eph_sel[4]; break;
+        case SYS_IRN: tmax=MAXDTOE_IRN+1.0; sel=nav->eph_sel[5]; break;
         default: tmax=MAXDTOE+1.0; break;
     }
     tmin=tmax+1.0;
@@ -441,7 +436,7 @@ static eph_t *seleph(gtime_t time, int sat, int iode, const nav_t *nav)
         if (nav->eph[i].sat!=sat) continue;
         if (iode>=0&&nav->eph[i].iode!=iode) continue;
         if (sys==SYS_GAL) {
-            sel=getseleph(SYS_GAL);
+            sel=getseleph(nav,SYS_GAL);
             if (sel==0&&!(nav->eph[i].code&(1<<9))) continue; /* I/NAV */
             if (sel==1&&!(nav->eph[i].code&(1<<8))) continue; /* F/NAV */
             if (timediff(nav->eph[i].toe,time)>=0.0) continue; /* AOD<=0 */
@@ -576,22 +571,21 @@ static int ephpos(gtime_t time, gtime_t teph, int sat, const nav_t *nav,
 static int satpos_sbas(gtime_t time, gtime_t teph, int sat, const nav_t *nav,
                         double *rs, double *dts, double *var, int *svh)
 {
-    const sbssatp_t *sbs=NULL;
+    const sbssatp_t *sbs;
     int i;
     
     trace(4,"satpos_sbas: time=%s sat=%2d\n",time_str(time,3),sat);
     
-    /* search sbas satellite correciton */
-    for (i=0;i<nav->sbssat.nsat;i++) {
-        sbs=nav->sbssat.sat+i;
-        if (sbs->sat==sat) break;
-    }
-    if (i>=nav->sbssat.nsat) {
+    /* sbas satellite correciton by satellite slot */
+    i=nav->sbssat.slot[sat-1]-1;
+    if (i<0||i>=nav->sbssat.nsat) {
         trace(2,"no sbas, use brdcast: %s sat=%2d\n",time_str(time,0),sat);
         ephpos(time,teph,sat,nav,-1,rs,dts,var,svh);
         /* *svh=-1; */ /* use broadcast if no sbas */
         return 1;
     }
+    sbs=nav->sbssat.sat+i;
+    
     /* satellite postion and clock by broadcast ephemeris */
     if (!ephpos(time,teph,sat,nav,sbs->lcorr.iode,rs,dts,var,svh)) return 0;
 
@@ -602,7 +596,8 @@ static int satpos_sbas(gtime_t time, gtime_t teph, int sat, const nav_t *nav,
 }
 /* satellite position and clock with ssr correction --------------------------*/
 static int satpos_ssr(gtime_t time, gtime_t teph, int sat, const nav_t *nav,
-                      int opt, double *rs, double *dts, double *var, int *svh)
+                      int opt, const astro_t *astro, double *rs, double *dts,
+                      double *var, int *svh)
 {
     const ssr_t *ssr;
     eph_t *eph;
@@ -682,7 +677,7 @@ static int satpos_ssr(gtime_t time, gtime_t teph, int sat, const nav_t *nav,
     
     /* satellite antenna offset correction */
     if (opt) {
-        satantoff(time,rs,sat,nav,dant);
+        satantoff(time,rs,sat,nav,astro,dant);
     }
     for (i=0;i<3;i++) {
         rs[i]+=-(er[i]*deph[0]+ea[i]*deph[1]+ec[i]*deph[2])+dant[i];
@@ -698,6 +693,26 @@ static int satpos_ssr(gtime_t time, gtime_t teph, int sat, const nav_t *nav,
     
     return 1;
 }
+/* satellite position and clock with astronomical context -------------------*/
+static int satpos_a(gtime_t time, gtime_t teph, int sat, int ephopt,
+                    const nav_t *nav, const astro_t *astro, double *rs,
+                    double *dts, double *var, int *svh)
+{
+    trace(4,"satpos  : time=%s sat=%2d ephopt=%d\n",time_str(time,3),sat,ephopt);
+    
+    *svh=0;
+
+    switch (ephopt) {
+        case EPHOPT_BRDC  : return ephpos     (time,teph,sat,nav,-1,rs,dts,var,svh);
+        case EPHOPT_SBAS  : return satpos_sbas(time,teph,sat,nav,   rs,dts,var,svh);
+        case EPHOPT_SSRAPC: return satpos_ssr (time,teph,sat,nav, 0,astro,rs,dts,var,svh);
+        case EPHOPT_SSRCOM: return satpos_ssr (time,teph,sat,nav, 1,astro,rs,dts,var,svh);
+        case EPHOPT_PREC  :
+            if (!peph2pos(time,sat,nav,1,astro,rs,dts,var)) break; else return 1;
+    }
+    *svh=-1;
+    return 0;
+}
 /* satellite position and clock ------------------------------------------------
 * compute satellite position, velocity and clock
 * args   : gtime_t time     I   time (gpst)
@@ -718,20 +733,7 @@ extern int satpos(gtime_t time, gtime_t teph, int sat, int ephopt,
                   const nav_t *nav, double *rs, double *dts, double *var,
                   int *svh)
 {
-    trace(4,"satpos  : time=%s sat=%2d ephopt=%d\n",time_str(time,3),sat,ephopt);
-    
-    *svh=0;
-
-    switch (ephopt) {
-        case EPHOPT_BRDC  : return ephpos     (time,teph,sat,nav,-1,rs,dts,var,svh);
-        case EPHOPT_SBAS  : return satpos_sbas(time,teph,sat,nav,   rs,dts,var,svh);
-        case EPHOPT_SSRAPC: return satpos_ssr (time,teph,sat,nav, 0,rs,dts,var,svh);
-        case EPHOPT_SSRCOM: return satpos_ssr (time,teph,sat,nav, 1,rs,dts,var,svh);
-        case EPHOPT_PREC  :
-            if (!peph2pos(time,sat,nav,1,rs,dts,var)) break; else return 1;
-    }
-    *svh=-1;
-    return 0;
+    return satpos_a(time,teph,sat,ephopt,nav,NULL,rs,dts,var,svh);
 }
 /* satellite positions and clocks ----------------------------------------------
 * compute satellite positions, velocities and clocks
@@ -740,6 +742,7 @@ extern int satpos(gtime_t time, gtime_t teph, int sat, int ephopt,
 *          int    n         I   number of observation data
 *          nav_t  *nav      I   navigation data
 *          int    ephopt    I   ephemeris option (EPHOPT_???)
+*          astro_t *astro   I   astronomical context of epoch (NULL: no use)
 *          double *rs       O   satellite positions and velocities (ecef)
 *          double *dts      O   satellite clocks
 *          double *var      O   sat position and clock error variances (m^2)
@@ -758,7 +761,8 @@ extern int satpos(gtime_t time, gtime_t teph, int sat, int ephopt,
 *          signal transmission time
 *-----------------------------------------------------------------------------*/
 extern void satposs(gtime_t teph, const obsd_t *obs, int n, const nav_t *nav,
-                    int ephopt, double *rs, double *dts, double *var, int *svh)
+                    int ephopt, const astro_t *astro, double *rs, double *dts,
+                    double *var, int *svh)
 {
     gtime_t time[2*MAXOBS]={{0}};
     double dt,pr;
@@ -789,8 +793,8 @@ extern void satposs(gtime_t teph, const obsd_t *obs, int n, const nav_t *nav,
         time[i]=timeadd(time[i],-dt);
         
         /* satellite position and clock at transmission time */
-        if (!satpos(time[i],teph,obs[i].sat,ephopt,nav,rs+i*6,dts+i*2,var+i,
-                    svh+i)) {
+        if (!satpos_a(time[i],teph,obs[i].sat,ephopt,nav,astro,rs+i*6,dts+i*2,
+                      var+i,svh+i)) {
             trace(3,"no ephemeris %s sat=%2d\n",time_str(time[i],3),obs[i].sat);
             continue;
         }
@@ -810,42 +814,46 @@ extern void satposs(gtime_t teph, const obsd_t *obs, int n, const nav_t *nav,
 /* set selected satellite ephemeris --------------------------------------------
 * Set selected satellite ephemeris for multiple ones like LNAV - CNAV, I/NAV -
 * F/NAV. Call it before calling satpos(),satposs() to use unselected one.
-* args   : int    sys       I   satellite system (SYS_???)
+* args   : nav_t  *nav      IO  navigation data
+*          int    sys       I   satellite system (SYS_???)
 *          int    sel       I   selection of ephemeris
 *                                 GPS,QZS : 0:LNAV ,1:CNAV  (default: LNAV)
 *                                 GAL     : 0:I/NAV,1:F/NAV (default: I/NAV)
 *                                 others : undefined
 * return : none
 * notes  : default ephemeris selection for galileo is any.
+*          the selection is kept in the navigation data, so solutions with
+*          their own navigation data may select ephemeris independently
 *-----------------------------------------------------------------------------*/
-extern void setseleph(int sys, int sel)
+extern void setseleph(nav_t *nav, int sys, int sel)
 {
     switch (sys) {
-        case SYS_GPS: eph_sel[0]=sel; break;
-        case SYS_GLO: eph_sel[1]=sel; break;
-        case SYS_GAL: eph_sel[2]=sel; break;
-        case SYS_QZS: eph_sel[3]=sel; break;
-        case SYS_CMP: eph_sel[4]=sel; break;
-        case SYS_IRN: eph_sel[5]=sel; break;
-        case SYS_SBS: eph_sel[6]=sel; break;
-    }
+        case SYS_GPS: nav->eph_sel[0]=sel; break;
+        case SYS_GLO: nav->eph_sel[1]=sel; break;
+        case SYS_GAL: nav->eph_sel[2]=sel; break;
+        case SYS_QZS: nav->eph_sel[3]=sel; break;
+        case SYS_CMP: nav->eph_sel[4]=sel; break;
+        case SYS_IRN: nav->eph_sel[5]=sel; break;
+        case SYS_SBS: nav->eph_sel[6]=sel; break;
     }
+}
 /* get selected satellite ephemeris -------------------------------------------
 * Get the selected satellite ephemeris.
-* args   : int    sys       I   satellite system (SYS_???)
+* args   : nav_t  *nav      I   navigation data
+*          int    sys       I   satellite system (SYS_???)
 * return : selected ephemeris
 *            refer setseleph()
 *-----------------------------------------------------------------------------*/
-extern int getseleph(int sys)
+extern int getseleph(const nav_t *nav, int sys)
 {
     switch (sys) {
-        case SYS_GPS: return eph_sel[0];
-        case SYS_GLO: return eph_sel[1];
-        case SYS_GAL: return eph_sel[2];
-        case SYS_QZS: return eph_sel[3];
-        case SYS_CMP: return eph_sel[4];
-        case SYS_IRN: return eph_sel[5];
-        case SYS_SBS: return eph_sel[6];
+        case SYS_GPS: return nav->eph_sel[0];
+        case SYS_GLO: return nav->eph_sel[1];
+        case SYS_GAL: return nav->eph_sel[2];
+        case SYS_QZS: return nav->eph_sel[3];
+        case SYS_CMP: return nav->eph_sel[4];
+        case SYS_IRN: return nav->eph_sel[5];
+        case SYS_SBS: return nav->eph_sel[6];
     }
     return 0;
 }
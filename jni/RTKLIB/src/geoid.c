@@ -16,10 +16,42 @@
 *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
+#define MIN(x,y)    ((x)<(y)?(x):(y))
+#define MAX(x,y)    ((x)>(y)?(x):(y))
+
+#define NTILE       16              /* grid points of cached tile (each axis) */
+
+typedef struct {                    /* geoid grid cell and tile cache type */
+    int i,j;                        /* grid index of cell (-1: empty) */
+    double y[4];                    /* geoid heights at cell corners (m) */
+    int i0,j0;                      /* grid index of tile origin (-1: empty) */
+    double v[NTILE][NTILE];         /* geoid heights of tile grid points (m) */
+} gcell_t;
+
+typedef double gval_t(geoid_t *gm, int i, int j); /* grid value function */
+
+typedef struct {                    /* global geoid grid type */
+    double lon0,lat0;               /* origin of grid (deg) */
+    double dlon,dlat;               /* interval of grid (deg) */
+    int nlon,nlat;                  /* number of grid points */
+    gval_t *gval;                   /* grid value function */
+} ggrid_t;
+
+static double gval_egm96(geoid_t *gm, int i, int j);
+static double gval_egm08(geoid_t *gm, int i, int j);
+
+static const ggrid_t grid_egm96={ /* egm96 15x15" */
+    0.0,90.0,15.0/60.0,-15.0/60.0,1440,721,gval_egm96
+};
+static const ggrid_t grid_egm08_25={ /* egm2008 2.5x2.5" */
+    0.0,90.0,2.5/60.0,-2.5/60.0,8640,4321,gval_egm08
+};
+static const ggrid_t grid_egm08_10={ /* egm2008 1.0x1.0" */
+    0.0,90.0,1.0/60.0,-1.0/60.0,21600,10801,gval_egm08
+};
 static const double range[4];       /* embedded geoid area range {W,E,S,N} (deg) */
 static const float geoid[361][181]; /* embedded geoid heights (m) (lon x lat) */
-static FILE *fp_geoid=NULL;         /* geoid file pointer */
-static int model_geoid=GEOID_EMBEDDED; /* geoid model */
+static geoid_t geoid_model={GEOID_EMBEDDED}; /* geoid model by opengeoid() */
 
 /* bilinear interpolation ----------------------------------------------------*/
 static double interpb(const double *y, double a, double b)
@@ -47,71 +79,43 @@ static double geoidh_emb(const double *pos)
     y[3]=geoid[i2][j2];
     return interpb(y,a,b);
 }
+/* read geoid model data -----------------------------------------------------*/
+static int readgeoid(geoid_t *gm, long off, int len, void *buff)
+{
+    if (gm->data) {
+        if (off<0||(size_t)off+len>gm->size) return 0;
+        memcpy(buff,gm->data+off,len);
+        return 1;
+    }
+    return gm->fp&&fseek(gm->fp,off,SEEK_SET)!=EOF&&fread(buff,len,1,gm->fp)==1;
+}
 /* get 2 byte signed integer from file ---------------------------------------*/
-static int16_t fget2b(FILE *fp, int32_t off)
+static int16_t fget2b(geoid_t *gm, long off)
 {
     uint8_t v[2]={0x00};
-    if (fseek(fp,off,SEEK_SET)==EOF||fread(v,2,1,fp)<1) {
+    if (!readgeoid(gm,off,2,v)) {
         trace(2,"geoid data file range error: off=%ld\n",off);
     }
     return ((int16_t)v[0]<<8)+v[1]; /* big-endian */
 }
-/* egm96 15x15" model --------------------------------------------------------*/
-static double geoidh_egm96(const double *pos)
+/* egm96 15x15" grid value --------------------------------------------------*/
+static double gval_egm96(geoid_t *gm, int i, int j)
 {
-    const double lon0=0.0,lat0=90.0,dlon=15.0/60.0,dlat=-15.0/60.0;
-    const int nlon=1440,nlat=721;
-    double a,b,y[4];
-    int i1,i2,j1,j2;
-    
-    if (!fp_geoid) return 0.0;
-    
-    a=(pos[1]-lon0)/dlon;
-    b=(pos[0]-lat0)/dlat;
-    i1=(int)a; a-=i1; i2=i1<nlon-1?i1+1:0;
-    j1=(int)b; b-=j1; j2=j1<nlat-1?j1+1:j1;
-    y[0]=fget2b(fp_geoid,2L*(i1+j1*nlon))*0.01;
-    y[1]=fget2b(fp_geoid,2L*(i2+j1*nlon))*0.01;
-    y[2]=fget2b(fp_geoid,2L*(i1+j2*nlon))*0.01;
-    y[3]=fget2b(fp_geoid,2L*(i2+j2*nlon))*0.01;
-    return interpb(y,a,b);
+    return fget2b(gm,2L*(i+j*1440))*0.01;
 }
 /* get 4byte float from file -------------------------------------------------*/
-static float fget4f(FILE *fp, int off)
+static float fget4f(geoid_t *gm, long off)
 {
     float v=0.0;
-    if (fseek(fp,(long)off,SEEK_SET)==EOF||fread(&v,4,1,fp)<1) {
+    if (!readgeoid(gm,off,4,&v)) {
         trace(2,"geoid data file range error: off=%ld\n",off);
     }
     return v; /* small-endian */
 }
-/* egm2008 model -------------------------------------------------------------*/
-static double geoidh_egm08(const double *pos, int model)
+/* egm2008 grid value --------------------------------------------------------*/
+static double gval_egm08(geoid_t *gm, int i, int j)
 {
-    const double lon0=0.0,lat0=90.0;
-    double dlon,dlat;
-    double a,b,y[4];
-    int i1,i2,j1,j2;
-    int nlon,nlat;
-    
-    if (!fp_geoid) return 0.0;
-    
-    if (model==GEOID_EGM2008_M25) { /* 2.5 x 2.5" grid */
-        dlon= 2.5/60.0;
-        dlat=-2.5/60.0;
-        nlon=8640;
-        nlat=4321;
-    }
-    else { /* 1 x 1" grid */
-        dlon= 1.0/60.0;
-        dlat=-1.0/60.0;
-        nlon=21600;
-        nlat=10801;
-    }
-    a=(pos[1]-lon0)/dlon;
-    b=(pos[0]-lat0)/dlat;
-    i1=(int)a; a-=i1; i2=i1<nlon-1?i1+1:0;
-    j1=(int)b; b-=j1; j2=j1<nlat-1?j1+1:j1;
+    int nlon=gm->model==GEOID_EGM2008_M25?8640:21600;
     
     /* notes: 4byte-zeros are inserted at first and last field of a record */
     /*        for current geoid data files */
@@ -120,28 +124,69 @@ static double geoidh_egm08(const double *pos, int model)
     /* (2) Und_min2.5x2.5_egm2008_isw=82_WGS84_TideFree_SE.gz */
 #if 0
     /* not zero-inserted */
-    y[0]=fget4f(fp_geoid,4L*(i1+j1*(nlon)));
-    y[1]=fget4f(fp_geoid,4L*(i2+j1*(nlon)));
-    y[2]=fget4f(fp_geoid,4L*(i1+j2*(nlon)));
-    y[3]=fget4f(fp_geoid,4L*(i2+j2*(nlon)));
+    return fget4f(gm,4L*(i+j*(nlon)));
 #else
     /* zero-inserted version (2009/12/10) */
-    y[0]=fget4f(fp_geoid,4L*(i1+j1*(nlon+2)+1));
-    y[1]=fget4f(fp_geoid,4L*(i2+j1*(nlon+2)+1));
-    y[2]=fget4f(fp_geoid,4L*(i1+j2*(nlon+2)+1));
-    y[3]=fget4f(fp_geoid,4L*(i2+j2*(nlon+2)+1));
+    return fget4f(gm,4L*(i+j*(nlon+2)+1));
 #endif
-    return interpb(y,a,b);
+}
+/* egm96 and egm2008 global grid models ----------------------------------------
+* geoid height by bilinear interpolation of global grid. the heights at the
+* corners of the last cell and, while positions stay in the neighborhood of
+* the last cell, the heights of a tile of NTILExNTILE grid points are cached
+*-----------------------------------------------------------------------------*/
+static double geoidh_grid(geoid_t *gm, const ggrid_t *g, const double *pos,
+                          gcell_t *c)
+{
+    double a,b,y[4];
+    int i,j,i1,i2,j1,j2,di,dj;
+    
+    if (!gm->data&&!gm->fp) return 0.0;
+    
+    a=(pos[1]-g->lon0)/g->dlon;
+    b=(pos[0]-g->lat0)/g->dlat;
+    i1=(int)a; a-=i1;
+    j1=(int)b; b-=j1;
+    
+    /* cell in cached tile */
+    di=i1-c->i0; dj=j1-c->j0;
+    if (c->i0>=0&&0<=di&&di<NTILE-1&&0<=dj&&dj<NTILE-1) {
+        y[0]=c->v[dj  ][di  ];
+        y[1]=c->v[dj  ][di+1];
+        y[2]=c->v[dj+1][di  ];
+        y[3]=c->v[dj+1][di+1];
+        return interpb(y,a,b);
+    }
+    if (c->i==i1&&c->j==j1) return interpb(c->y,a,b);
+    
+    /* fill tile if the cell is near the last cell and not at the edge */
+    if (c->i>=0&&abs(i1-c->i)<NTILE&&abs(j1-c->j)<NTILE&&i1<g->nlon-1&&
+        j1<g->nlat-1) {
+        c->i0=MIN(MAX(i1-NTILE/2,0),g->nlon-NTILE);
+        c->j0=MIN(MAX(j1-NTILE/2,0),g->nlat-NTILE);
+        for (j=0;j<NTILE;j++) for (i=0;i<NTILE;i++) {
+            c->v[j][i]=g->gval(gm,c->i0+i,c->j0+j);
+        }
+        return geoidh_grid(gm,g,pos,c);
+    }
+    i2=i1<g->nlon-1?i1+1:0;
+    j2=j1<g->nlat-1?j1+1:j1;
+    c->y[0]=g->gval(gm,i1,j1);
+    c->y[1]=g->gval(gm,i2,j1);
+    c->y[2]=g->gval(gm,i1,j2);
+    c->y[3]=g->gval(gm,i2,j2);
+    c->i=i1; c->j=j1;
+    return interpb(c->y,a,b);
 }
 /* get gsi geoid data --------------------------------------------------------*/
-static double fgetgsi(FILE *fp, int nlon, int nlat, int i, int j)
+static double fgetgsi(geoid_t *gm, int nlon, int nlat, int i, int j)
 {
     const int nf=28,wf=9,nl=nf*wf+2,nr=(nlon-1)/nf+1;
     double v;
     int off=nl+j*nr*nl+i/nf*nl+i%nf*wf;
     char buff[16]="";
     
-    if (fseek(fp,(long)off,SEEK_SET)==EOF||fread(buff,wf,1,fp)<1) {
+    if (!readgeoid(gm,(long)off,wf,buff)) {
         trace(2,"out of range for gsi geoid: i=%d j=%d\n",i,j);
         return 0.0;
     }
@@ -152,15 +197,16 @@ static double fgetgsi(FILE *fp, int nlon, int nlat, int i, int j)
     return v;
 }
 /* gsi geoid 2000 1.0x1.5" model ---------------------------------------------*/
-static double geoidh_gsi(const double *pos)
+static double geoidh_gsi(geoid_t *gm, const double *pos, gcell_t *c)
 {
     const double lon0=120.0,lon1=150.0,lat0=20.0,lat1=50.0;
     const double dlon=1.5/60.0,dlat=1.0/60.0;
     const int nlon=1201,nlat=1801;
-    double a,b,y[4];
+    double a,b;
     int i1,i2,j1,j2;
     
-    if (!fp_geoid||pos[1]<lon0||lon1<pos[1]||pos[0]<lat0||lat1<pos[0]) {
+    if ((!gm->data&&!gm->fp)||pos[1]<lon0||lon1<pos[1]||pos[0]<lat0||
+        lat1<pos[0]) {
         trace(2,"out of range for gsi geoid: lat=%.3f lon=%.3f\n",pos[0],pos[1]);
         return 0.0;
     }
@@ -168,15 +214,78 @@ static double geoidh_gsi(const double *pos)
     b=(pos[0]-lat0)/dlat;
     i1=(int)a; a-=i1; i2=i1<nlon-1?i1+1:i1;
     j1=(int)b; b-=j1; j2=j1<nlat-1?j1+1:j1;
-    y[0]=fgetgsi(fp_geoid,nlon,nlat,i1,j1);
-    y[1]=fgetgsi(fp_geoid,nlon,nlat,i2,j1);
-    y[2]=fgetgsi(fp_geoid,nlon,nlat,i1,j2);
-    y[3]=fgetgsi(fp_geoid,nlon,nlat,i2,j2);
-    if (y[0]==999.0||y[1]==999.0||y[2]==999.0||y[3]==999.0) {
+    if (c->i!=i1||c->j!=j1) {
+        c->y[0]=fgetgsi(gm,nlon,nlat,i1,j1);
+        c->y[1]=fgetgsi(gm,nlon,nlat,i2,j1);
+        c->y[2]=fgetgsi(gm,nlon,nlat,i1,j2);
+        c->y[3]=fgetgsi(gm,nlon,nlat,i2,j2);
+        c->i=i1; c->j=j1;
+    }
+    if (c->y[0]==999.0||c->y[1]==999.0||c->y[2]==999.0||c->y[3]==999.0) {
         trace(2,"geoidh_gsi: data outage (lat=%.3f lon=%.3f)\n",pos[0],pos[1]);
         return 0.0;
     }
-    return interpb(y,a,b);
+    return interpb(c->y,a,b);
+}
+/* geoid height of a position ------------------------------------------------*/
+static double geoidh_pos(geoid_t *gm, const double *pos, gcell_t *c)
+{
+    double posd[2],h;
+    
+    posd[1]=pos[1]*R2D; posd[0]=pos[0]*R2D; if (posd[1]<0.0) posd[1]+=360.0;
+    
+    if (posd[1]<0.0||360.0-1E-12<posd[1]||posd[0]<-90.0||90.0<posd[0]) {
+        trace(2,"out of range for geoid model: lat=%.3f lon=%.3f\n",posd[0],posd[1]);
+        return 0.0;
+    }
+    switch (gm->model) {
+        case GEOID_EMBEDDED   : h=geoidh_emb  (posd);      break;
+        case GEOID_EGM96_M150 : h=geoidh_grid(gm,&grid_egm96   ,posd,c); break;
+        case GEOID_EGM2008_M25: h=geoidh_grid(gm,&grid_egm08_25,posd,c); break;
+        case GEOID_EGM2008_M10: h=geoidh_grid(gm,&grid_egm08_10,posd,c); break;
+        case GEOID_GSI2000_M15: h=geoidh_gsi  (gm,posd,c); break;
+        default: h=0.0; break;
+    }
+    if (fabs(h)>200.0) {
+        trace(2,"invalid geoid model: lat=%.3f lon=%.3f h=%.3f\n",posd[0],posd[1],h);
+        return 0.0;
+    }
+    return h;
+}
+/* geoid heights of positions by mapped global grid ---------------------------
+* same as geoidh_pos() for each position but interpolated in the cached tile
+* inline. positions out of the tile interior, out of range or with invalid
+* heights are passed to geoidh_pos()
+*-----------------------------------------------------------------------------*/
+static void grid_batch(geoid_t *gm, const ggrid_t *g, const double *pos, int n,
+                       double *h, gcell_t *c)
+{
+    const double lon0=g->lon0,lat0=g->lat0,dlon=g->dlon,dlat=g->dlat;
+    double lat,lon,a,b,hh;
+    int i,i1,j1,di,dj;
+    
+    for (i=0;i<n;i++) {
+        lat=pos[i*2]*R2D; lon=pos[i*2+1]*R2D; if (lon<0.0) lon+=360.0;
+        
+        if (lon<0.0||360.0-1E-12<lon||lat<-90.0||90.0<lat) {
+            h[i]=geoidh_pos(gm,pos+i*2,c);
+            continue;
+        }
+        a=(lon-lon0)/dlon;
+        b=(lat-lat0)/dlat;
+        i1=(int)a; a-=i1;
+        j1=(int)b; b-=j1;
+        di=i1-c->i0; dj=j1-c->j0;
+        
+        if (c->i0<0||di<0||NTILE-1<=di||dj<0||NTILE-1<=dj) {
+            h[i]=geoidh_pos(gm,pos+i*2,c); /* fill tile */
+            continue;
+        }
+        hh=c->v[dj  ][di  ]*(1.0-a)*(1.0-b)+c->v[dj  ][di+1]*a*(1.0-b)+
+           c->v[dj+1][di  ]*(1.0-a)*b      +c->v[dj+1][di+1]*a*b;
+        
+        h[i]=fabs(hh)>200.0?geoidh_pos(gm,pos+i*2,c):hh;
+    }
 }
 /* open geoid model file -------------------------------------------------------
 * open geoid model file
@@ -200,20 +309,7 @@ extern int opengeoid(int model, const char *file)
     trace(3,"opengeoid: model=%d file=%s\n",model,file);
     
     closegeoid();
-    if (model==GEOID_EMBEDDED) {
-        return 1;
-    }
-    if (model!=GEOID_EGM96_M150 &&model!=GEOID_EGM2008_M25&&
-        model!=GEOID_EGM2008_M10&&model!=GEOID_GSI2000_M15) {
-        trace(2,"invalid geoid model: model=%d file=%s\n",model,file);
-        return 0;
-    }
-    if (!(fp_geoid=fopen(file,"rb"))) {
-        trace(2,"geoid model file open error: model=%d file=%s\n",model,file);
-        return 0;
-    }
-    model_geoid=model;
-    return 1;
+    return opengeoid_ctx(&geoid_model,model,file);
 }
 /* close geoid model file ------------------------------------------------------
 * close geoid model file
@@ -224,9 +320,7 @@ extern void closegeoid(void)
 {
     trace(3,"closegoid:\n");
     
-    if (fp_geoid) fclose(fp_geoid);
-    fp_geoid=NULL;
-    model_geoid=GEOID_EMBEDDED;
+    closegeoid_ctx(&geoid_model);
 }
 /* geoid height ----------------------------------------------------------------
 * get geoid height from geoid model
@@ -235,31 +329,131 @@ extern void closegeoid(void)
 * notes  : to use external geoid model, call function opengeoid() to open
 *          geoid model before calling the function. If the external geoid model
 *          is not open, the function uses embedded geoid model.
+*          access to external geoid model file is serialized by a lock if the
+*          file is not mapped to memory
 *-----------------------------------------------------------------------------*/
 extern double geoidh(const double *pos)
 {
-    double posd[2],h;
+    return geoidh_ctx(&geoid_model,pos);
+}
+/* geoid heights of positions --------------------------------------------------
+* get geoid heights of positions from geoid model opened by opengeoid()
+* args   : double *pos      I   geodetic positions {lat,lon} (rad)
+*                               (pos[i*2]: lat, pos[i*2+1]: lon of position i)
+*          int    n         I   number of positions
+*          double *h        O   geoid heights (m) (0.0:error)
+* return : none
+* notes  : see geoidh_batch_ctx()
+*-----------------------------------------------------------------------------*/
+extern void geoidh_batch(const double *pos, int n, double *h)
+{
+    geoidh_batch_ctx(&geoid_model,pos,n,h);
+}
+/* open geoid model with context -----------------------------------------------
+* open geoid model file to geoid model context
+* args   : geoid_t *gm      O   geoid model context
+*          int    model     I   geoid model type (see opengeoid())
+*          char   *file     I   geoid model file path
+* return : status (1:ok,0:error)
+* notes  : the geoid model file is mapped to memory for lock-free access by
+*          multiple threads. if the mapping fails (ex. lack of address space
+*          for EGM2008 1x1" model on 32bit cpu), the file is accessed by file
+*          pointer with a lock.
+*          the context should be closed by closegeoid_ctx()
+*-----------------------------------------------------------------------------*/
+extern int opengeoid_ctx(geoid_t *gm, int model, const char *file)
+{
+    trace(3,"opengeoid_ctx: model=%d file=%s\n",model,file);
     
-    posd[1]=pos[1]*R2D; posd[0]=pos[0]*R2D; if (posd[1]<0.0) posd[1]+=360.0;
+    gm->model=GEOID_EMBEDDED;
+    gm->data=NULL;
+    gm->size=0;
+    gm->fp=NULL;
     
-    if (posd[1]<0.0||360.0-1E-12<posd[1]||posd[0]<-90.0||90.0<posd[0]) {
-        trace(2,"out of range for geoid model: lat=%.3f lon=%.3f\n",posd[0],posd[1]);
-        return 0.0;
+    if (model==GEOID_EMBEDDED) {
+        return 1;
     }
-    switch (model_geoid) {
-        case GEOID_EMBEDDED   : h=geoidh_emb  (posd); break;
-        case GEOID_EGM96_M150 : h=geoidh_egm96(posd); break;
-        case GEOID_EGM2008_M25: h=geoidh_egm08(posd,model_geoid); break;
-        case GEOID_EGM2008_M10: h=geoidh_egm08(posd,model_geoid); break;
-        case GEOID_GSI2000_M15: h=geoidh_gsi  (posd); break;
-        default: return 0.0;
+    if (model!=GEOID_EGM96_M150 &&model!=GEOID_EGM2008_M25&&
+        model!=GEOID_EGM2008_M10&&model!=GEOID_GSI2000_M15) {
+        trace(2,"invalid geoid model: model=%d file=%s\n",model,file);
+        return 0;
     }
-    if (fabs(h)>200.0) {
-        trace(2,"invalid geoid model: lat=%.3f lon=%.3f h=%.3f\n",posd[0],posd[1],h);
-        return 0.0;
+    if (!(gm->data=(const uint8_t *)mapfile(file,&gm->size))) {
+        if (!(gm->fp=fopen(file,"rb"))) {
+            trace(2,"geoid model file open error: model=%d file=%s\n",model,file);
+            return 0;
+        }
+        initlock(&gm->lock);
     }
+    gm->model=model;
+    return 1;
+}
+/* close geoid model with context ----------------------------------------------
+* close geoid model file of geoid model context
+* args   : geoid_t *gm      IO  geoid model context
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void closegeoid_ctx(geoid_t *gm)
+{
+    trace(3,"closegeoid_ctx:\n");
+    
+    if (gm->data) unmapfile((void *)gm->data,gm->size);
+    if (gm->fp) fclose(gm->fp);
+    gm->data=NULL;
+    gm->size=0;
+    gm->fp=NULL;
+    gm->model=GEOID_EMBEDDED;
+}
+/* geoid height with context ---------------------------------------------------
+* get geoid height from geoid model context
+* args   : geoid_t *gm      I   geoid model context
+*          double *pos      I   geodetic position {lat,lon} (rad)
+* return : geoid height (m) (0.0:error)
+*-----------------------------------------------------------------------------*/
+extern double geoidh_ctx(geoid_t *gm, const double *pos)
+{
+    double h;
+    
+    geoidh_batch_ctx(gm,pos,1,&h);
     return h;
 }
+/* geoid heights of positions with context -------------------------------------
+* get geoid heights of positions from geoid model context
+* args   : geoid_t *gm      I   geoid model context
+*          double *pos      I   geodetic positions {lat,lon} (rad)
+*                               (pos[i*2]: lat, pos[i*2+1]: lon of position i)
+*          int    n         I   number of positions
+*          double *h        O   geoid heights (m) (0.0:error)
+* return : none
+* notes  : the grid cell of the previous position is reused for the next
+*          position in the same cell and grid values of a tile around the cell
+*          are cached while positions stay in the neighborhood. so positions
+*          sorted or clustered by area (ex. points of a map tile) are converted
+*          efficiently.
+*          the function can be called by multiple threads with a context. if
+*          the file is not mapped, the file access is serialized by a lock.
+*-----------------------------------------------------------------------------*/
+extern void geoidh_batch_ctx(geoid_t *gm, const double *pos, int n, double *h)
+{
+    gcell_t cell;
+    int i,locked=!gm->data&&gm->fp;
+    
+    cell.i=cell.j=cell.i0=cell.j0=-1;
+    
+    if (gm->data) {
+        switch (gm->model) {
+            case GEOID_EGM96_M150 : grid_batch(gm,&grid_egm96   ,pos,n,h,&cell); return;
+            case GEOID_EGM2008_M25: grid_batch(gm,&grid_egm08_25,pos,n,h,&cell); return;
+            case GEOID_EGM2008_M10: grid_batch(gm,&grid_egm08_10,pos,n,h,&cell); return;
+        }
+    }
+    if (locked) lock(&gm->lock);
+    
+    for (i=0;i<n;i++) {
+        h[i]=geoidh_pos(gm,pos+i*2,&cell);
+    }
+    if (locked) unlock(&gm->lock);
+}
 /*------------------------------------------------------------------------------
 * embedded geoid model
 * notes  : geoid heights are derived from EGM96 (1 x 1 deg grid)
@@ -23,6 +23,8 @@
 #define MIN_EL      0.0         /* min elevation angle (rad) */
 #define MIN_HGT     -1000.0     /* min user height (m) */
 
+static THREADLOCAL int itec_=0; /* time cursor of tec grid data */
+
 /* get index -----------------------------------------------------------------*/
 static int getindex(double value, const double *range)
 {
@@ -77,6 +79,8 @@ static tec_t *addtec(const double *lats, const double *lons, const double *hgts,
             p->lons[i] = lons[i];
             p->hgts[i] = hgts[i];
         }
+        p->stride[0] = ndata[0];
+        p->stride[1] = ndata[0] * ndata[1];
         n = ndata[0] * ndata[1] * ndata[2];
 
         if (!(p->data = (double*)malloc(sizeof(double) * n)) ||
@@ -334,7 +338,7 @@ static int interptec(const tec_t *tec, int k, const double *posp, double *value,
                      double *rms)
 {
     double dlat,dlon,a,b,d[4]={0},r[4]={0};
-    int i,j,n,index;
+    int i,j,n,i1,j1,index;
     
     trace(3,"interptec: k=%d posp=%.2f %.2f\n",k,posp[0]*R2D,posp[1]*R2D);
     *value=*rms=0.0;
@@ -351,9 +355,13 @@ static int interptec(const tec_t *tec, int k, const double *posp, double *value,
     i=(int)floor(a); a-=i;
     j=(int)floor(b); b-=j;
     
-    /* get gridded tec data */
+    /* get gridded tec data (grid data index by strides) */
+    if (k<0||k>=tec->ndata[2]) return 0;
     for (n=0;n<4;n++) {
-        if ((index=dataindex(i+(n%2),j+(n<2?0:1),k,tec->ndata))<0) continue;
+        i1=i+(n%2);
+        j1=j+(n<2?0:1);
+        if (i1<0||i1>=tec->ndata[0]||j1<0||j1>=tec->ndata[1]) continue;
+        index=i1+tec->stride[0]*j1+tec->stride[1]*k;
         d[n]=tec->data[index];
         r[n]=tec->rms [index];
     }
@@ -376,44 +384,178 @@ static int interptec(const tec_t *tec, int k, const double *posp, double *value,
     }
     return 1;
 }
-/* ionosphere delay by tec grid data -----------------------------------------*/
-static int iondelay(gtime_t time, const tec_t *tec, const double *pos,
-                    const double *azel, int opt, double *delay, double *var)
+/* ionosphere delays of satellites by tec grid data ----------------------------
+* compute ionosphere delays of n satellites by a tec grid map. the pierce
+* points of all satellites are computed for a layer before the interpolation
+* to keep the loops free of branches and function calls (same as ionppp())
+*-----------------------------------------------------------------------------*/
+static void iondelay(gtime_t time, const tec_t *tec, const double *pos,
+                     const double *azel, int n, int opt, double *posp,
+                     double *fs, double *delay, double *var, int *stat)
 {
     const double fact=40.30E16/FREQL1/FREQL1; /* tecu->L1 iono (m) */
-    double fs,posp[3]={0},vtec,rms,hion,rp;
-    int i;
+    double sinlat,coslat,tanlatn,tanlats,drot=0.0,hion,rp,ap,sinap,tanap,cosaz;
+    double vtec,rms;
+    int i,j;
     
-    trace(3,"iondelay: time=%s pos=%.1f %.1f azel=%.1f %.1f\n",time_str(time,0),
-          pos[0]*R2D,pos[1]*R2D,azel[0]*R2D,azel[1]*R2D);
+    trace(4,"iondelay: time=%s pos=%.1f %.1f n=%d\n",time_str(time,0),
+          pos[0]*R2D,pos[1]*R2D,n);
+    
+    sinlat=sin(pos[0]);
+    coslat=cos(pos[0]);
+    tanlatn=tan(PI/2.0-pos[0]);
+    tanlats=tan(PI/2.0+pos[0]);
     
-    *delay=*var=0.0;
+    /* earth rotation correction (sun-fixed coordinate) */
+    if (opt&1) drot=2.0*PI*timediff(time,tec->time)/86400.0;
     
+    for (j=0;j<n;j++) {
+        delay[j]=var[j]=0.0;
+        stat[j]=1;
+    }
     for (i=0;i<tec->ndata[2];i++) { /* for a layer */
         
         hion=tec->hgts[0]+tec->hgts[2]*i;
         
-        /* ionospheric pierce point position */
-        fs=ionppp(pos,azel,tec->rb,hion,posp);
-        
-        if (opt&2) {
-            /* modified single layer mapping function (M-SLM) ref [2] */
-            rp=tec->rb/(tec->rb+hion)*sin(0.9782*(PI/2.0-azel[1]));
-            fs=1.0/sqrt(1.0-rp*rp);
-        }
-        if (opt&1) {
-            /* earth rotation correction (sun-fixed coordinate) */
-            posp[1]+=2.0*PI*timediff(time,tec->time)/86400.0;
+        /* ionospheric pierce point positions */
+        for (j=0;j<n;j++) {
+            rp=tec->rb/(tec->rb+hion)*cos(azel[1+j*2]);
+            ap=PI/2.0-azel[1+j*2]-asin(rp);
+            sinap=sin(ap);
+            tanap=tan(ap);
+            cosaz=cos(azel[j*2]);
+            posp[j*2]=asin(sinlat*cos(ap)+coslat*sinap*cosaz);
+            
+            if ((pos[0]> 70.0*D2R&& tanap*cosaz>tanlatn)||
+                (pos[0]<-70.0*D2R&&-tanap*cosaz>tanlats)) {
+                posp[1+j*2]=pos[1]+PI-asin(sinap*sin(azel[j*2])/cos(posp[j*2]));
+            }
+            else {
+                posp[1+j*2]=pos[1]+asin(sinap*sin(azel[j*2])/cos(posp[j*2]));
+            }
+            fs[j]=1.0/sqrt(1.0-rp*rp);
+            
+            if (opt&2) {
+                /* modified single layer mapping function (M-SLM) ref [2] */
+                rp=tec->rb/(tec->rb+hion)*sin(0.9782*(PI/2.0-azel[1+j*2]));
+                fs[j]=1.0/sqrt(1.0-rp*rp);
+            }
+            posp[1+j*2]+=drot;
         }
         /* interpolate tec grid data */
-        if (!interptec(tec,i,posp,&vtec,&rms)) return 0;
+        for (j=0;j<n;j++) {
+            if (!stat[j]) continue;
+            if (!interptec(tec,i,posp+j*2,&vtec,&rms)) {
+                stat[j]=0;
+                continue;
+            }
+            delay[j]+=fact*fs[j]*vtec;
+            var[j]+=fact*fact*fs[j]*fs[j]*rms*rms;
+        }
+    }
+}
+/* search tec grid data by time ----------------------------------------------*/
+static int searchtec(gtime_t time, const nav_t *nav)
+{
+    int i=itec_,lo,hi;
+    
+    /* time cursor for monotonic time (tec[i-1].time<=time<tec[i].time) */
+    if (i<1||i>=nav->nt) i=1;
+    if (i<nav->nt&&timediff(nav->tec[i].time,time)<=0.0) i++;
+    
+    if (i<1||i>=nav->nt||timediff(nav->tec[i  ].time,time)<=0.0||
+                         timediff(nav->tec[i-1].time,time)> 0.0) {
         
-        *delay+=fact*fs*vtec;
-        *var+=fact*fact*fs*fs*rms*rms;
+        /* binary search of first tec grid data after time */
+        for (lo=0,hi=nav->nt;lo<hi;) {
+            i=(lo+hi)/2;
+            if (timediff(nav->tec[i].time,time)>0.0) hi=i; else lo=i+1;
+        }
+        i=lo;
     }
-    trace(4,"iondelay: delay=%7.2f std=%6.2f\n",*delay,sqrt(*var));
+    return itec_=i;
+}
+/* ionosphere model by tec grid data of satellites -----------------------------
+* compute ionospheric delays by tec grid data for satellites of an epoch
+* args   : gtime_t time     I   time (gpst)
+*          nav_t  *nav      I   navigation data
+*          double *pos      I   receiver position {lat,lon,h} (rad,m)
+*          double *azel     I   azimuth/elevation angles {az,el,...} (rad)
+*          int    n         I   number of satellites
+*          int    opt       I   model option (see iontec())
+*          double *delay    O   ionospheric delays (L1) (m) (n x 1)
+*          double *var      O   ionospheric delay (L1) variances (m^2) (n x 1)
+*          int    *stat     O   status of satellites (1:ok,0:error) (n x 1)
+* return : number of satellites with ok status
+* notes  : same results as iontec() for each satellite. the time bracket of
+*          tec grid data is searched once and the pierce points of satellites
+*          are computed in a loop for a layer.
+*-----------------------------------------------------------------------------*/
+extern int iontec_sats(gtime_t time, const nav_t *nav, const double *pos,
+                       const double *azel, int n, int opt, double *delay,
+                       double *var, int *stat)
+{
+    double *posp,*fs,*dels,*vars,a=0.0,tt;
+    int i,j,nok=0,*stats;
     
-    return 1;
+    trace(3,"iontec_sats: time=%s pos=%.1f %.1f n=%d\n",time_str(time,0),
+          pos[0]*R2D,pos[1]*R2D,n);
+    
+    for (j=0;j<n;j++) {
+        stat[j]=azel[1+j*2]<MIN_EL||pos[2]<MIN_HGT;
+        delay[j]=0.0;
+        var[j]=stat[j]?VAR_NOTEC:0.0;
+    }
+    if (n<=0) return 0;
+    if (pos[2]<MIN_HGT) return n;
+    
+    i=searchtec(time,nav);
+    
+    if (i==0||i>=nav->nt) {
+        trace(2,"%s: tec grid out of period\n",time_str(time,0));
+        for (j=0;j<n;j++) nok+=stat[j];
+        return nok;
+    }
+    if ((tt=timediff(nav->tec[i].time,nav->tec[i-1].time))==0.0) {
+        trace(2,"tec grid time interval error\n");
+        for (j=0;j<n;j++) nok+=stat[j];
+        return nok;
+    }
+    posp=mat(2,n); fs=mat(n,1); dels=mat(n,2); vars=mat(n,2); stats=imat(n,2);
+    
+    /* ionospheric delays by tec grid data */
+    iondelay(time,nav->tec+i-1,pos,azel,n,opt,posp,fs,dels  ,vars  ,stats  );
+    iondelay(time,nav->tec+i  ,pos,azel,n,opt,posp,fs,dels+n,vars+n,stats+n);
+    a=timediff(time,nav->tec[i-1].time)/tt;
+    
+    for (j=0;j<n;j++) {
+        if (stat[j]) {
+            nok++;
+            continue;
+        }
+        if (stats[j]&&stats[j+n]) { /* linear interpolation by time */
+            delay[j]=dels[j]*(1.0-a)+dels[j+n]*a;
+            var  [j]=vars[j]*(1.0-a)+vars[j+n]*a;
+        }
+        else if (stats[j]) { /* nearest-neighbour extrapolation by time */
+            delay[j]=dels[j];
+            var  [j]=vars[j];
+        }
+        else if (stats[j+n]) {
+            delay[j]=dels[j+n];
+            var  [j]=vars[j+n];
+        }
+        else {
+            trace(2,"%s: tec grid out of area pos=%6.2f %7.2f azel=%6.1f %5.1f\n",
+                  time_str(time,0),pos[0]*R2D,pos[1]*R2D,azel[j*2]*R2D,
+                  azel[1+j*2]*R2D);
+            continue;
+        }
+        stat[j]=1;
+        nok++;
+    }
+    free(posp); free(fs); free(dels); free(vars); free(stats);
+    return nok;
 }
 /* ionosphere model by tec grid data -------------------------------------------
 * compute ionospheric delay by tec grid data
@@ -429,11 +571,13 @@ static int iondelay(gtime_t time, const tec_t *tec, const double *pos,
 * return : status (1:ok,0:error)
 * notes  : before calling the function, read tec grid data by calling readtec()
 *          return ok with delay=0 and var=VAR_NOTEC if el<MIN_EL or h<MIN_HGT
+*          the time bracket of tec grid data is searched from the last one
+*          of the thread, so the search is O(1) for monotonic time.
 *-----------------------------------------------------------------------------*/
 extern int iontec(gtime_t time, const nav_t *nav, const double *pos,
                   const double *azel, int opt, double *delay, double *var)
 {
-    double dels[2],vars[2],a,tt;
+    double dels[2],vars[2],posp[2],fs,a,tt;
     int i,stat[2];
     
     trace(3,"iontec  : time=%s pos=%.1f %.1f azel=%.1f %.1f\n",time_str(time,0),
@@ -444,9 +588,8 @@ extern int iontec(gtime_t time, const nav_t *nav, const double *pos,
         *var=VAR_NOTEC;
         return 1;
     }
-    for (i=0;i<nav->nt;i++) {
-        if (timediff(nav->tec[i].time,time)>0.0) break;
-    }
+    i=searchtec(time,nav);
+    
     if (i==0||i>=nav->nt) {
         trace(2,"%s: tec grid out of period\n",time_str(time,0));
         return 0;
@@ -456,8 +599,8 @@ extern int iontec(gtime_t time, const nav_t *nav, const double *pos,
         return 0;
     }
     /* ionospheric delay by tec grid data */
-    stat[0]=iondelay(time,nav->tec+i-1,pos,azel,opt,dels  ,vars  );
-    stat[1]=iondelay(time,nav->tec+i  ,pos,azel,opt,dels+1,vars+1);
+    iondelay(time,nav->tec+i-1,pos,azel,1,opt,posp,&fs,dels  ,vars  ,stat  );
+    iondelay(time,nav->tec+i  ,pos,azel,1,opt,posp,&fs,dels+1,vars+1,stat+1);
     
     if (!stat[0]&&!stat[1]) {
         trace(2,"%s: tec grid out of area pos=%6.2f %7.2f azel=%6.1f %5.1f\n",
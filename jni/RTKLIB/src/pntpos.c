@@ -132,7 +132,7 @@ static double prange(const obsd_t *obs, const nav_t *nav, const prcopt_t *opt,
         }
         else if (sys==SYS_GAL) { /* E1-E5b */
             gamma=SQR(FREQL1/FREQE5b);
-            if (getseleph(SYS_GAL)) { /* F/NAV */
+            if (getseleph(nav,SYS_GAL)) { /* F/NAV */
                 P2-=gettgd(sat,nav,0)-gettgd(sat,nav,1); /* BGD_E5aE5b */
             }
             return (P2-gamma*P1)/(1.0-gamma);
@@ -163,7 +163,7 @@ static double prange(const obsd_t *obs, const nav_t *nav, const prcopt_t *opt,
             return P1-b1/(gamma-1.0);
         }
         else if (sys==SYS_GAL) { /* E1 */
-            if (getseleph(SYS_GAL)) b1=gettgd(sat,nav,0); /* BGD_E1E5a */
+            if (getseleph(nav,SYS_GAL)) b1=gettgd(sat,nav,0); /* BGD_E1E5a */
             else                    b1=gettgd(sat,nav,1); /* BGD_E1E5b */
             return P1-b1;
         }
@@ -272,7 +272,8 @@ static int rescode(int iter, const obsd_t *obs, int n, const double *rs,
     gtime_t time;
     double r,freq,dion=0.0,dtrp=0.0,vmeas,vion=0.0,vtrp=0.0,rr[3],pos[3],dtr,e[3],P;
     double snr_rover = (ssat) ? SNR_UNIT * ssat->snr_rover[0] : opt->err[5];
-    int i,j,nv=0,sat,sys,mask[NX-3]={0};
+    double dions[MAXOBS],vions[MAXOBS];
+    int i,j,nv=0,sat,sys,mask[NX-3]={0},stats[MAXOBS]={0};
     
     trace(3,"resprng : n=%d\n",n);
     
@@ -281,6 +282,14 @@ static int rescode(int iter, const obsd_t *obs, int n, const double *rs,
     
     ecef2pos(rr,pos);
     
+    /* ionospheric delays by tec grid for satellites of epoch */
+    if (iter>0&&opt->ionoopt==IONOOPT_TEC) {
+        for (i=0;i<n&&i<MAXOBS;i++) {
+            azel[i*2]=azel[1+i*2]=0.0;
+            if (geodist(rs+i*6,rr,e)>0.0) satazel(pos,e,azel+i*2);
+        }
+        iontec_sats(obs[0].time,nav,pos,azel,i,1,dions,vions,stats);
+    }
     for (i=*ns=0;i<n&&i<MAXOBS;i++) {
         vsat[i]=0; azel[i*2]=azel[1+i*2]=resp[i]=0.0;
         time=obs[i].time;
@@ -304,8 +313,13 @@ static int rescode(int iter, const obsd_t *obs, int n, const double *rs,
             /* test SNR mask */
             if (!snrmask(obs+i,azel+i*2,opt)) continue;
         
-            /* ionospheric correction */
-            if (!ionocorr(time,nav,sat,pos,azel+i*2,opt->ionoopt,&dion,&vion)) {
+            /* ionospheric correction (broadcast model if tec grid error) */
+            if (opt->ionoopt==IONOOPT_TEC&&stats[i]) {
+                dion=dions[i]; vion=vions[i];
+            }
+            else if (!ionocorr(time,nav,sat,pos,azel+i*2,
+                               opt->ionoopt==IONOOPT_TEC?IONOOPT_BRDC:
+                               opt->ionoopt,&dion,&vion)) {
                 continue;
             }
             if ((freq=sat2freq(sat,obs[i].code[0],nav))==0.0) continue;
@@ -662,7 +676,7 @@ extern int pntpos(const obsd_t *obs, int n, const nav_t *nav,
         opt_.tropopt=TROPOPT_SAAS;
     }
     /* satellite positons, velocities and clocks */
-    satposs(sol->time,obs,n,nav,opt_.sateph,rs,dts,var,svh);
+    satposs(sol->time,obs,n,nav,opt_.sateph,NULL,rs,dts,var,svh);
     
     /* estimate receiver position with pseudorange */
     stat=estpos(obs,n,rs,dts,var,svh,nav,&opt_,ssat,sol,azel_,vsat,resp,msg);
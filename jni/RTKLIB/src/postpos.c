@@ -57,14 +57,14 @@
 
 static pcvs_t pcvss={0};        /* receiver antenna parameters */
 static pcvs_t pcvsr={0};        /* satellite antenna parameters */
-static obs_t obss={0};          /* observation data */
+static obsc_t obss={0};         /* observation data */
 static nav_t navs={0};          /* navigation data */
 static sbs_t sbss={0};          /* sbas messages */
 static sta_t stas[MAXRCV];      /* station infomation */
 static int nepoch=0;            /* number of observation epochs */
 static int nitm  =0;            /* number of invalid time marks */
-static int iobsu =0;            /* current rover observation data index */
-static int iobsr =0;            /* current reference observation data index */
+static int iobsu =0;            /* current rover observation epoch index */
+static int iobsr =0;            /* current reference observation epoch index */
 static int isbs  =0;            /* current sbas message index */
 static int iitm  =0;            /* current invalid time mark index */
 static int revs  =0;            /* analysis direction (0:forward,1:backward) */
@@ -82,6 +82,7 @@ static char rtcm_path[1024]=""; /* rtcm data path */
 static gtime_t invalidtm[MAXINVALIDTM]={{0}};/* invalid time marks */
 static rtcm_t rtcm;             /* rtcm control struct */
 static FILE *fp_rtcm=NULL;      /* rtcm data file pointer */
+static prof_t profs;            /* stage profile of all processings */
 
 /* show message and check break ----------------------------------------------*/
 static int checkbrk(const char *format, ...)
@@ -138,6 +139,10 @@ static void outheader(FILE *fp, char **file, int n, const prcopt_t *popt,
     if (sopt->posf==SOLF_NMEA||sopt->posf==SOLF_STAT) {
         return;
     }
+    if (sopt->posf==SOLF_BIN) { /* no comment lines in binary */
+        outsolhead(fp,sopt);
+        return;
+    }
     if (sopt->outhead) {
         if (!*sopt->prog) {
             fprintf(fp,"%s program   : RTKLIB ver.%s %s\n",COMMENTH,VER_RTKLIB,PATCH_LEVEL);
@@ -148,11 +153,11 @@ static void outheader(FILE *fp, char **file, int n, const prcopt_t *popt,
         for (i=0;i<n;i++) {
             fprintf(fp,"%s inp file  : %s\n",COMMENTH,file[i]);
         }
-        for (i=0;i<obss.n;i++)    if (obss.data[i].rcv==1) break;
-        for (j=obss.n-1;j>=0;j--) if (obss.data[j].rcv==1) break;
+        for (i=0;i<obss.ne;i++)    if (obss.rcv[i]==1) break;
+        for (j=obss.ne-1;j>=0;j--) if (obss.rcv[j]==1) break;
         if (j<i) {fprintf(fp,"\n%s no rover obs data\n",COMMENTH); return;}
-        ts=obss.data[i].time;
-        te=obss.data[j].time;
+        ts=obss.time[i];
+        te=obss.time[j];
         t1=time2gpst(ts,&w1);
         t2=time2gpst(te,&w2);
         if (sopt->times>=1) ts=gpst2utc(ts);
@@ -176,30 +181,16 @@ static void outheader(FILE *fp, char **file, int n, const prcopt_t *popt,
     
     outsolhead(fp,sopt);
 }
-/* search next observation data index ----------------------------------------*/
-static int nextobsf(const obs_t *obs, int *i, int rcv)
+/* search next observation epoch index ---------------------------------------*/
+static int nextobsf(const obsc_t *obs, int *i, int rcv)
 {
-    double tt;
-    int n;
-    
-    for (;*i<obs->n;(*i)++) if (obs->data[*i].rcv==rcv) break;
-    for (n=0;*i+n<obs->n;n++) {
-        tt=timediff(obs->data[*i+n].time,obs->data[*i].time);
-        if (obs->data[*i+n].rcv!=rcv||tt>DTTOL) break;
-    }
-    return n;
+    for (;*i<obs->ne;(*i)++) if (obs->rcv[*i]==rcv) break;
+    return *i<obs->ne?obs->iobs[*i+1]-obs->iobs[*i]:0;
 }
-static int nextobsb(const obs_t *obs, int *i, int rcv)
+static int nextobsb(const obsc_t *obs, int *i, int rcv)
 {
-    double tt;
-    int n;
-    
-    for (;*i>=0;(*i)--) if (obs->data[*i].rcv==rcv) break;
-    for (n=0;*i-n>=0;n++) {
-        tt=timediff(obs->data[*i-n].time,obs->data[*i].time);
-        if (obs->data[*i-n].rcv!=rcv||tt<-DTTOL) break;
-    }
-    return n;
+    for (;*i>=0;(*i)--) if (obs->rcv[*i]==rcv) break;
+    return *i>=0?obs->iobs[*i+1]-obs->iobs[*i]:0;
 }
 /* update rtcm ssr correction ------------------------------------------------*/
 static void update_rtcm_ssr(gtime_t time)
@@ -245,8 +236,8 @@ static int inputobs(obsd_t *obs, int solq, const prcopt_t *popt)
     
     trace(3,"\ninfunc  : revs=%d iobsu=%d iobsr=%d isbs=%d\n",revs,iobsu,iobsr,isbs);
     
-    if (0<=iobsu&&iobsu<obss.n) {
-        settime((time=obss.data[iobsu].time));
+    if (0<=iobsu&&iobsu<obss.ne) {
+        settime((time=obss.time[iobsu]));
         if (checkbrk("processing : %s Q=%d",time_str(time,0),solq)) {
             aborts=1; showmsg("aborted"); return -1;
         }
@@ -254,20 +245,20 @@ static int inputobs(obsd_t *obs, int solq, const prcopt_t *popt)
     if (!revs) { /* input forward data */
         if ((nu=nextobsf(&obss,&iobsu,1))<=0) return -1;
         if (popt->intpref) {
-            for (;(nr=nextobsf(&obss,&iobsr,2))>0;iobsr+=nr)
-                if (timediff(obss.data[iobsr].time,obss.data[iobsu].time)>-DTTOL) break;
+            for (;(nr=nextobsf(&obss,&iobsr,2))>0;iobsr++)
+                if (timediff(obss.time[iobsr],obss.time[iobsu])>-DTTOL) break;
         }
         else {
-            for (i=iobsr;(nr=nextobsf(&obss,&i,2))>0;iobsr=i,i+=nr)
-                if (timediff(obss.data[i].time,obss.data[iobsu].time)>DTTOL) break;
+            for (i=iobsr;(nr=nextobsf(&obss,&i,2))>0;iobsr=i,i++)
+                if (timediff(obss.time[i],obss.time[iobsu])>DTTOL) break;
         }
         nr=nextobsf(&obss,&iobsr,2);
         if (nr<=0) {
             nr=nextobsf(&obss,&iobsr,2);
         }
-        for (i=0;i<nu&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsu+i];
-        for (i=0;i<nr&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsr+i];
-        iobsu+=nu;
+        n+=getobsc(&obss,iobsu,obs+n,MAXOBS*2-n);
+        if (nr>0) n+=getobsc(&obss,iobsr,obs+n,MAXOBS*2-n);
+        iobsu++;
         
         /* update sbas corrections */
         while (isbs<sbss.n) {
@@ -287,17 +278,17 @@ static int inputobs(obsd_t *obs, int solq, const prcopt_t *popt)
     else { /* input backward data */
         if ((nu=nextobsb(&obss,&iobsu,1))<=0) return -1;
         if (popt->intpref) {
-            for (;(nr=nextobsb(&obss,&iobsr,2))>0;iobsr-=nr)
-                if (timediff(obss.data[iobsr].time,obss.data[iobsu].time)<DTTOL) break;
+            for (;(nr=nextobsb(&obss,&iobsr,2))>0;iobsr--)
+                if (timediff(obss.time[iobsr],obss.time[iobsu])<DTTOL) break;
         }
         else {
-            for (i=iobsr;(nr=nextobsb(&obss,&i,2))>0;iobsr=i,i-=nr)
-                if (timediff(obss.data[i].time,obss.data[iobsu].time)<-DTTOL) break;
+            for (i=iobsr;(nr=nextobsb(&obss,&i,2))>0;iobsr=i,i--)
+                if (timediff(obss.time[i],obss.time[iobsu])<-DTTOL) break;
         }
         nr=nextobsb(&obss,&iobsr,2);
-        for (i=0;i<nu&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsu-nu+1+i];
-        for (i=0;i<nr&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsr-nr+1+i];
-        iobsu-=nu;
+        n+=getobsc(&obss,iobsu,obs+n,MAXOBS*2-n);
+        if (nr>0) n+=getobsc(&obss,iobsr,obs+n,MAXOBS*2-n);
+        iobsu--;
         
         /* update sbas corrections */
         while (isbs>=0) {
@@ -414,7 +405,7 @@ static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
         if (n<=0) continue;
         
         /* carrier-phase bias correction */
-        if (!strstr(popt->pppopt,"-ENA_FCB")) {
+        if (!(rtk->copt.flag&COPT_ENA_FCB)) {
             corr_phase_bias_ssr(obs_ptr,n,&navs);
         }
         if (!rtkpos(rtk, obs_ptr,n,&navs)) {
@@ -451,19 +442,13 @@ static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
             oldsol = rtk->sol;
         }
         else if (!revs) { /* combined-forward */
-            if (isolf >= nepoch) {
-                free(obs_ptr);
-                return;
-            }
+            if (isolf>=nepoch) break;
             solf[isolf]=rtk->sol;
             for (i=0;i<3;i++) rbf[i+isolf*3]=rtk->rb[i];
             isolf++;
         }
         else { /* combined-backward */
-            if (isolb>=nepoch) {
-                free(obs_ptr);
-                return;
-            }
+            if (isolb>=nepoch) break;
             solb[isolb]=rtk->sol;
             for (i=0;i<3;i++) rbb[i+isolb*3]=rtk->rb[i];
             isolb++;
@@ -473,7 +458,9 @@ static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
         sol.time=time;
         outsol(fp,&sol,rb,sopt);
     }
-
+    /* accumulate stage profile */
+    if (popt->prof) prfmerge(&profs,&rtk->prof);
+    
     free(obs_ptr); /* moved from stack to heap to kill a stack overflow warning */
 }
 /* validation of combined solutions ------------------------------------------*/
@@ -679,6 +666,7 @@ static void freepreceph(nav_t *nav, sbs_t *sbs)
     trace(3,"freepreceph:\n");
     
     free(nav->peph); nav->peph=NULL; nav->ne=nav->nemax=0;
+    free(nav->pfit); nav->pfit=NULL; nav->nf=0;
     free(nav->pclk); nav->pclk=NULL; nav->nc=nav->ncmax=0;
     free(nav->seph); nav->seph=NULL; nav->ns=nav->nsmax=0;
     free(sbs->msgs); sbs->msgs=NULL; sbs->n =sbs->nmax =0;
@@ -694,13 +682,13 @@ static void freepreceph(nav_t *nav, sbs_t *sbs)
 /* read obs and nav data -----------------------------------------------------*/
 static int readobsnav(gtime_t ts, gtime_t te, double ti, char **infile,
                       const int *index, int n, const prcopt_t *prcopt,
-                      obs_t *obs, nav_t *nav, sta_t *sta)
+                      obsc_t *obs, nav_t *nav, sta_t *sta)
 {
     int i,j,ind=0,nobs=0,rcv=1;
     
     trace(3,"readobsnav: ts=%s n=%d\n",time_str(ts,0),n);
     
-    obs->data=NULL; obs->n =obs->nmax =0;
+    memset(obs,0,sizeof(obsc_t));
     nav->eph =NULL; nav->n =nav->nmax =0;
     nav->geph=NULL; nav->ng=nav->ngmax=0;
     /* free(nav->seph); */ /* is this needed to avoid memory leak??? */
@@ -715,8 +703,8 @@ static int readobsnav(gtime_t ts, gtime_t te, double ti, char **infile,
             ind=index[i]; nobs=obs->n; 
         }
         /* read rinex obs and nav file */
-        if (readrnxt(infile[i],rcv,ts,te,ti,prcopt->rnxopt[rcv<=1?0:1],obs,nav,
-                     rcv<=2?sta+rcv-1:NULL)<0) {
+        if (readrnxobsc(infile[i],rcv,ts,te,ti,prcopt->rnxopt[rcv<=1?0:1],obs,
+                        nav,rcv<=2?sta+rcv-1:NULL)<0) {
             checkbrk("error : insufficient memory");
             trace(1,"insufficient memory\n");
             return 0;
@@ -733,35 +721,39 @@ static int readobsnav(gtime_t ts, gtime_t te, double ti, char **infile,
         return 0;
     }
     /* sort observation data */
-    nepoch=sortobs(obs);
+    if ((nepoch=sortobsc(obs))<0) {
+        checkbrk("error : insufficient memory");
+        trace(1,"insufficient memory\n");
+        return 0;
+    }
     
     /* delete duplicated ephemeris */
     uniqnav(nav);
 
     /* set time span for progress display */
     if (ts.time==0||te.time==0) {
-        for (i=0;   i<obs->n;i++) if (obs->data[i].rcv==1) break;
-        for (j=obs->n-1;j>=0;j--) if (obs->data[j].rcv==1) break;
+        for (i=0;    i<obs->ne;i++) if (obs->rcv[i]==1) break;
+        for (j=obs->ne-1;j>=0;j--) if (obs->rcv[j]==1) break;
         if (i<j) {
-            if (ts.time==0) ts=obs->data[i].time;
-            if (te.time==0) te=obs->data[j].time;
+            if (ts.time==0) ts=obs->time[i];
+            if (te.time==0) te=obs->time[j];
             settspan(ts,te);
         }
     }
     return 1;
 }
 /* free obs and nav data -----------------------------------------------------*/
-static void freeobsnav(obs_t *obs, nav_t *nav)
+static void freeobsnav(obsc_t *obs, nav_t *nav)
 {
     trace(3,"freeobsnav:\n");
     
-    free(obs->data); obs->data=NULL; obs->n =obs->nmax =0;
+    freeobsc(obs);
     free(nav->eph ); nav->eph =NULL; nav->n =nav->nmax =0;
     free(nav->geph); nav->geph=NULL; nav->ng=nav->ngmax=0;
     free(nav->seph); nav->seph=NULL; nav->ns=nav->nsmax=0;
 }
 /* average of single position ------------------------------------------------*/
-static int avepos(double *ra, int rcv, const obs_t *obs, const nav_t *nav,
+static int avepos(double *ra, int rcv, const obsc_t *obs, const nav_t *nav,
                   const prcopt_t *opt)
 {
     obsd_t data[MAXOBS];
@@ -774,12 +766,13 @@ static int avepos(double *ra, int rcv, const obs_t *obs, const nav_t *nav,
     
     for (i=0;i<3;i++) ra[i]=0.0;
     
-    for (iobs=0;(m=nextobsf(obs,&iobs,rcv))>0;iobs+=m) {
+    for (iobs=0;nextobsf(obs,&iobs,rcv)>0;iobs++) {
         
-        for (i=j=0;i<m&&i<MAXOBS;i++) {
-            data[j]=obs->data[iobs+i];
-            if ((satsys(data[j].sat,NULL)&opt->navsys)&&
-                opt->exsats[data[j].sat-1]!=1) j++;
+        m=getobsc(obs,iobs,data,MAXOBS);
+        
+        for (i=j=0;i<m;i++) {
+            if ((satsys(data[i].sat,NULL)&opt->navsys)&&
+                opt->exsats[data[i].sat-1]!=1) data[j++]=data[i];
         }
         if (j<=0||!screent(data[0].time,ts,ts,1.0)) continue; /* only 1 hz */
         
@@ -829,7 +822,7 @@ static int getstapos(const char *file, char *name, double *r)
     return 0;
 }
 /* antenna phase center position ---------------------------------------------*/
-static int antpos(prcopt_t *opt, int rcvno, const obs_t *obs, const nav_t *nav,
+static int antpos(prcopt_t *opt, int rcvno, const obsc_t *obs, const nav_t *nav,
                   const sta_t *sta, const char *posfile)
 {
     double *rr=rcvno==1?opt->ru:opt->rb,del[3],pos[3],dr[3]={0};
@@ -1081,7 +1074,7 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     }
     /* set antenna parameters */
     if (popt_.mode!=PMODE_SINGLE) {
-        setpcv(obss.n>0?obss.data[0].time:timeget(),&popt_,&navs,&pcvss,&pcvsr,
+        setpcv(obss.ne>0?obss.time[0]:timeget(),&popt_,&navs,&pcvss,&pcvsr,
                stas);
     }
     /* read ocean tide loading parameters */
@@ -1137,7 +1130,7 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     }
     else if (popt_.soltype==1) {
         if ((fp=openfile(outfile)) && (fptm=openfile(outfiletm))) {
-            revs=1; iobsu=iobsr=obss.n-1; isbs=sbss.n-1;
+            revs=1; iobsu=iobsr=obss.ne-1; isbs=sbss.n-1;
             procpos(fp,fptm,&popt_,sopt,rtk_ptr,0); /* backward */
             fclose(fp);
             fclose(fptm);
@@ -1152,7 +1145,7 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
         if (solf&&solb) {
             isolf=isolb=0;
             procpos(NULL,NULL,&popt_,sopt,rtk_ptr,1); /* forward */
-            revs=1; iobsu=iobsr=obss.n-1; isbs=sbss.n-1;
+            revs=1; iobsu=iobsr=obss.ne-1; isbs=sbss.n-1;
             procpos(NULL,NULL,&popt_,sopt,rtk_ptr,1); /* backward */
             
             /* combine forward/backward solutions */
@@ -1175,6 +1168,20 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     
     return aborts?1:0;
 }
+/* output stage profile ------------------------------------------------------*/
+static void outprof(void)
+{
+    char buff[(NPRFSTAGE+1)*128],*p,*q;
+    
+    prf2str(&profs,"",buff);
+    
+    for (p=buff;*p;p=q+1) {
+        if (!(q=strchr(p,'\n'))) break;
+        *q='\0';
+        trace(2,"%s\n",p);
+        showmsg("%s\n",p);
+    }
+}
 /* execute processing session for each rover ---------------------------------*/
 static int execses_r(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
                      const solopt_t *sopt, const filopt_t *fopt, int flag,
@@ -1341,6 +1348,8 @@ extern int postpos(gtime_t ts, gtime_t te, double ti, double tu,
     /* open processing session */
     if (!openses(popt,sopt,fopt,&navs,&pcvss,&pcvsr)) return -1;
     
+    memset(&profs,0,sizeof(prof_t));
+    
     if (ts.time!=0&&te.time!=0&&tu>=0.0) {
         if (timediff(te,ts)<0.0) {
             showmsg("error : no period");
@@ -1432,6 +1441,9 @@ extern int postpos(gtime_t ts, gtime_t te, double ti, double tu,
         stat=execses_b(ts,te,ti,popt,sopt,fopt,1,infile,index,n,outfile,rov,
                        base);
     }
+    /* output stage profile */
+    if (popt->prof) outprof();
+    
     /* close processing session */
     closeses(&navs,&pcvss,&pcvsr);
     
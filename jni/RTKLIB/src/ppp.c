@@ -65,6 +65,8 @@
 #define SQR(x)      ((x)*(x))
 #define SQRT(x)     ((x)<=0.0||(x)!=(x)?0.0:sqrt(x))
 #define MAX(x,y)    ((x)>(y)?(x):(y))
+#define PRFTICK(rtk) ((rtk)->opt.prof?prftick():0.0) /* tick of profile stage */
+#define PRFADD(rtk,s,t) ((rtk)->opt.prof?prfadd(&(rtk)->prof,s,prftick()-(t)):(void)0)
 #define MIN(x,y)    ((x)<(y)?(x):(y))
 #define ROUND(x)    (int)floor((x)+0.5)
 
@@ -123,53 +125,52 @@ static double STD(rtk_t *rtk, int i)
     if (rtk->sol.stat==SOLQ_FIX) return SQRT(rtk->Pa[i+i*rtk->nx]);
     return SQRT(rtk->P[i+i*rtk->nx]);
 }
-/* write solution status for PPP ---------------------------------------------*/
-extern int pppoutstat(rtk_t *rtk, char *buff)
+/* write solution status states for PPP as binary records -------------------*/
+extern int pppoutstatb(rtk_t *rtk, uint8_t *buff)
 {
     ssat_t *ssat;
-    double tow,pos[3],vel[3],acc[3],*x;
-    int i,j,week;
-    char id[32],*p=buff;
+    double pos[3],v[12],*x;
+    int i,j;
+    uint8_t *p=buff;
     
     if (!rtk->sol.stat) return 0;
     
-    trace(3,"pppoutstat:\n");
-    
-    tow=time2gpst(rtk->sol.time,&week);
+    trace(3,"pppoutstatb:\n");
     
     x=rtk->sol.stat==SOLQ_FIX?rtk->xa:rtk->x;
     
     /* receiver position */
-    p+=sprintf(p,"$POS,%d,%.3f,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",week,tow,
-               rtk->sol.stat,x[0],x[1],x[2],STD(rtk,0),STD(rtk,1),STD(rtk,2));
+    for (i=0;i<3;i++) {
+        v[i]=x[i]; v[i+3]=STD(rtk,i);
+    }
+    p+=outstatl(p,STATL_POS,0,0,v);
     
     /* receiver velocity and acceleration */
     if (rtk->opt.dynamics) {
+        for (i=6;i<12;i++) v[i]=0.0;
         ecef2pos(rtk->sol.rr,pos);
-        ecef2enu(pos,rtk->x+3,vel);
-        ecef2enu(pos,rtk->x+6,acc);
-        p+=sprintf(p,"$VELACC,%d,%.3f,%d,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f,%.4f,%.4f,"
-                   "%.4f,%.5f,%.5f,%.5f\n",week,tow,rtk->sol.stat,vel[0],vel[1],
-                   vel[2],acc[0],acc[1],acc[2],0.0,0.0,0.0,0.0,0.0,0.0);
+        ecef2enu(pos,rtk->x+3,v);
+        ecef2enu(pos,rtk->x+6,v+3);
+        p+=outstatl(p,STATL_VELACC,0,0,v);
     }
     /* receiver clocks */
     i=IC(0,&rtk->opt);
-    p+=sprintf(p,"$CLK,%d,%.3f,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
-               week,tow,rtk->sol.stat,1,x[i]*1E9/CLIGHT,x[i+1]*1E9/CLIGHT,
-               x[i+2]*1E9/CLIGHT,x[i+3]*1E9/CLIGHT,STD(rtk,i)*1E9/CLIGHT,
-               STD(rtk,i+1)*1E9/CLIGHT,STD(rtk,i+2)*1E9/CLIGHT,
-               STD(rtk,i+2)*1E9/CLIGHT);
+    for (j=0;j<4;j++) {
+        v[j]=x[i+j]*1E9/CLIGHT;
+        v[j+4]=STD(rtk,i+(j<3?j:2))*1E9/CLIGHT;
+    }
+    p+=outstatl(p,STATL_CLKP,0,1,v);
     
     /* tropospheric parameters */
     if (rtk->opt.tropopt==TROPOPT_EST||rtk->opt.tropopt==TROPOPT_ESTG) {
         i=IT(&rtk->opt);
-        p+=sprintf(p,"$TROP,%d,%.3f,%d,%d,%.4f,%.4f\n",week,tow,rtk->sol.stat,
-                   1,x[i],STD(rtk,i));
+        v[0]=x[i]; v[1]=STD(rtk,i);
+        p+=outstatl(p,STATL_TROP,0,1,v);
     }
     if (rtk->opt.tropopt==TROPOPT_ESTG) {
         i=IT(&rtk->opt);
-        p+=sprintf(p,"$TRPG,%d,%.3f,%d,%d,%.5f,%.5f,%.5f,%.5f\n",week,tow,
-                   rtk->sol.stat,1,x[i+1],x[i+2],STD(rtk,i+1),STD(rtk,i+2));
+        v[0]=x[i+1]; v[1]=x[i+2]; v[2]=STD(rtk,i+1); v[3]=STD(rtk,i+2);
+        p+=outstatl(p,STATL_TRPG,0,1,v);
     }
     /* ionosphere parameters */
     if (rtk->opt.ionoopt==IONOOPT_EST) {
@@ -178,36 +179,46 @@ extern int pppoutstat(rtk_t *rtk, char *buff)
             if (!ssat->vs) continue;
             j=II(i+1,&rtk->opt);
             if (rtk->x[j]==0.0) continue;
-            satno2id(i+1,id);
-            p+=sprintf(p,"$ION,%d,%.3f,%d,%s,%.1f,%.1f,%.4f,%.4f\n",week,tow,
-                       rtk->sol.stat,id,rtk->ssat[i].azel[0]*R2D,
-                       rtk->ssat[i].azel[1]*R2D,x[j],STD(rtk,j));
+            v[0]=ssat->azel[0]*R2D; v[1]=ssat->azel[1]*R2D;
+            v[2]=x[j]; v[3]=STD(rtk,j);
+            p+=outstatl(p,STATL_ION,i+1,0,v);
         }
     }
 #ifdef OUTSTAT_AMB
     /* ambiguity parameters */
     for (i=0;i<MAXSAT;i++) for (j=0;j<NF(&rtk->opt);j++) {
-        k=IB(i+1,j,&rtk->opt);
+        int k=IB(i+1,j,&rtk->opt);
         if (rtk->x[k]==0.0) continue;
-        satno2id(i+1,id);
-        p+=sprintf(p,"$AMB,%d,%.3f,%d,%s,%d,%.4f,%.4f\n",week,tow,
-                   rtk->sol.stat,id,j+1,x[k],STD(rtk,k));
+        v[0]=x[k]; v[1]=STD(rtk,k);
+        p+=outstatl(p,STATL_AMB,i+1,j+1,v);
     }
 #endif
     return (int)(p-buff);
 }
+/* write solution status for PPP ---------------------------------------------*/
+extern int pppoutstat(rtk_t *rtk, char *buff)
+{
+    uint8_t data[MAXSOLMSG];
+    double tow;
+    int n,week;
+    
+    if ((n=pppoutstatb(rtk,data))<=0) return 0;
+    
+    tow=time2gpst(rtk->sol.time,&week);
+    return statl2str(data,n,week,tow,rtk->sol.stat,buff);
+}
 /* exclude meas of eclipsing satellite (block IIA) ---------------------------*/
-static void testeclipse(const obsd_t *obs, int n, const nav_t *nav, double *rs)
+static void testeclipse(const obsd_t *obs, int n, const nav_t *nav,
+                        const astro_t *astro, double *rs)
 {
-    double rsun[3],esun[3],r,ang,erpv[5]={0},cosa;
+    double esun[3],r,ang,cosa;
     int i,j;
     const char *type;
     
     trace(3,"testeclipse:\n");
     
     /* unit vector of sun direction (ecef) */
-    sunmoonpos(gpst2utc(obs[0].time),erpv,rsun,NULL,NULL);
-    normv3(rsun,esun);
+    normv3(astro->rsun,esun);
     
     for (i=0;i<n;i++) {
         type=nav->pcvs[obs[i].sat-1].type;
@@ -246,14 +257,14 @@ extern int yaw_angle(int sat, const char *type, int opt, double beta, double mu,
 }
 /* satellite attitude model --------------------------------------------------*/
 static int sat_yaw(gtime_t time, int sat, const char *type, int opt,
-                   const double *rs, double *exs, double *eys)
+                   const double *rs, const astro_t *astro, double *exs,
+                   double *eys)
 {
-    double rsun[3],ri[6],es[3],esun[3],n[3],p[3],en[3],ep[3],ex[3],E,beta,mu;
-    double yaw,cosy,siny,erpv[5]={0};
+    const double *rsun=astro->rsun;
+    double ri[6],es[3],esun[3],n[3],p[3],en[3],ep[3],ex[3],E,beta,mu;
+    double yaw,cosy,siny;
     int i;
     
-    sunmoonpos(gpst2utc(time),erpv,rsun,NULL,NULL);
-    
     /* beta and orbit angle */
     matcpy(ri,rs,6,1);
     ri[3]-=OMGE*ri[1];
@@ -283,7 +294,8 @@ static int sat_yaw(gtime_t time, int sat, const char *type, int opt,
 }
 /* phase windup model --------------------------------------------------------*/
 static int model_phw(gtime_t time, int sat, const char *type, int opt,
-                     const double *rs, const double *rr, double *phw)
+                     const double *rs, const double *rr, const astro_t *astro,
+                     double *phw)
 {
     double exs[3],eys[3],ek[3],exr[3],eyr[3],eks[3],ekr[3],E[9];
     double dr[3],ds[3],drs[3],r[3],pos[3],cosp,ph;
@@ -292,7 +304,7 @@ static int model_phw(gtime_t time, int sat, const char *type, int opt,
     if (opt<=0) return 1; /* no phase windup */
     
     /* satellite yaw attitude model */
-    if (!sat_yaw(time,sat,type,opt,rs,exs,eys)) return 0;
+    if (!sat_yaw(time,sat,type,opt,rs,astro,exs,eys)) return 0;
     
     /* unit vector satellite to receiver */
     for (i=0;i<3;i++) r[i]=rr[i]-rs[i];
@@ -504,6 +516,48 @@ static void detslp_mw(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
         }
     }
 }
+/* temporal update of wide-lane ambiguity averages --------------------------*/
+static void udwl_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
+{
+    ambc_t *amb;
+    double freq1,freq2,mw,d;
+    int i,sat;
+    
+    trace(4,"udwl_ppp: n=%d\n",n);
+    
+    for (i=0;i<n&&i<MAXOBS;i++) {
+        sat=obs[i].sat;
+        amb=rtk->ambc+sat-1;
+        
+        /* reset average by cycle slip or data outage */
+        if ((rtk->ssat[sat-1].slip[0]|rtk->ssat[sat-1].slip[1])&1||
+            rtk->ssat[sat-1].outc[0]>(uint32_t)rtk->opt.maxout) {
+            amb->n[0]=0;
+        }
+        if ((mw=mwmeas(obs+i,nav))==0.0) continue;
+        
+        freq1=sat2freq(sat,obs[i].code[0],nav);
+        freq2=sat2freq(sat,obs[i].code[1],nav);
+        
+        /* satellite code biases of ssr (phase biases already corrected) */
+        if (rtk->opt.sateph==EPHOPT_SSRAPC||rtk->opt.sateph==EPHOPT_SSRCOM) {
+            mw-=(freq1*nav->ssr[sat-1].cbias[obs[i].code[0]-1]+
+                 freq2*nav->ssr[sat-1].cbias[obs[i].code[1]-1])/(freq1+freq2);
+        }
+        mw/=CLIGHT/(freq1-freq2); /* m -> wide-lane cycle */
+        
+        /* running mean and variance of wide-lane ambiguity */
+        if (amb->n[0]<=0) {
+            amb->n[0]=0;
+            amb->LC[0]=amb->LCv[0]=0.0;
+        }
+        d=mw-amb->LC[0];
+        amb->n[0]++;
+        amb->LC[0]+=d/amb->n[0];
+        amb->LCv[0]+=(d*(mw-amb->LC[0])-amb->LCv[0])/amb->n[0];
+        amb->epoch[0]=obs[i].time;
+    }
+}
 /* temporal update of position -----------------------------------------------*/
 static void udpos_ppp(rtk_t *rtk)
 {
@@ -648,14 +702,12 @@ static void udtrop_ppp(rtk_t *rtk)
 static void udiono_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
 {
     double freq1,freq2,ion,sinel,pos[3],*azel;
-    char *p;
     int i,j,gap_resion=GAP_RESION;
     
     trace(3,"udiono_ppp:\n");
     
-    if ((p=strstr(rtk->opt.pppopt,"-GAP_RESION="))) {
-        sscanf(p,"-GAP_RESION=%d",&gap_resion);
-    }
+    if (rtk->copt.flag&COPT_GAPION) gap_resion=rtk->copt.gapion;
+    
     /* reset ionosphere delay estimate if outage too long */
     for (i=0;i<MAXSAT;i++) {
         j=II(i+1,&rtk->opt);
@@ -723,6 +775,9 @@ static void udbias_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
     /* detect slip by Melbourne-Wubbena linear combination jump */
     detslp_mw(rtk,obs,n,nav);
     
+    /* update wide-lane ambiguity averages for ambiguity resolution */
+    if (rtk->opt.modear!=ARMODE_OFF) udwl_ppp(rtk,obs,n,nav);
+    
     ecef2pos(rtk->sol.rr,pos);
     
     for (f=0;f<NF(&rtk->opt);f++) {
@@ -731,7 +786,11 @@ static void udbias_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
         for (i=0;i<MAXSAT;i++) {
             if (++rtk->ssat[i].outc[f]>(uint32_t)rtk->opt.maxout||
                 rtk->opt.modear==ARMODE_INST||clk_jump) {
-                initx(rtk,0.0,0.0,IB(i+1,f,&rtk->opt));
+                j=IB(i+1,f,&rtk->opt);
+                
+                /* skip inactive state already reset */
+                if (rtk->x[j]==0.0&&rtk->P[j+j*rtk->nx]==0.0) continue;
+                initx(rtk,0.0,0.0,j);
             }
         }
         for (i=k=0;i<n&&i<MAXOBS;i++) {
@@ -892,9 +951,6 @@ static int model_iono(gtime_t time, const double *pos, const double *azel,
     if (opt->ionoopt==IONOOPT_SBAS) {
         return sbsioncorr(time,nav,pos,azel,dion,var);
     }
-    if (opt->ionoopt==IONOOPT_TEC) {
-        return iontec(time,nav,pos,azel,1,dion,var);
-    }
     if (opt->ionoopt==IONOOPT_BRDC) {
         *dion=ionmodel(time,nav->ion_gps,pos,azel);
         *var=SQR(*dion*ERR_BRDCI);
@@ -911,29 +967,49 @@ static int model_iono(gtime_t time, const double *pos, const double *azel,
     }
     return 0;
 }
+/* set design matrix element of active state ---------------------------------*/
+static void seth(const int *ia, int na, int nv, int i, double h, double *H)
+{
+    if (ia[i]>=0) H[ia[i]+na*nv]=h;
+}
 /* phase and code residuals --------------------------------------------------*/
 static int ppp_res(int post, const obsd_t *obs, int n, const double *rs,
                    const double *dts, const double *var_rs, const int *svh,
                    const double *dr, int *exc, const nav_t *nav,
-                   const double *x, rtk_t *rtk, double *v, double *H, double *R,
-                   double *azel)
+                   const astro_t *astro, const double *x, const int *ia, int na,
+                   rtk_t *rtk, double *v, double *H, double *R, double *azel)
 {
     prcopt_t *opt=&rtk->opt;
     double y,r,cdtr,bias,C=0.0,rr[3],pos[3],e[3],dtdx[3],L[NFREQ],P[NFREQ],Lc,Pc;
     double var[MAXOBS*2],dtrp=0.0,dion=0.0,vart=0.0,vari=0.0,dcb,freq;
     double dantr[NFREQ]={0},dants[NFREQ]={0};
-    double ve[MAXOBS*2*NFREQ]={0},vmax=0;
+    double ve[MAXOBS*2*NFREQ]={0},vmax=0,dions[MAXOBS],varis[MAXOBS];
     char str[32];
     int ne=0,obsi[MAXOBS*2*NFREQ]={0},frqi[MAXOBS*2*NFREQ],maxobs,maxfrq,rej;
-    int i,j,k,sat,sys,nv=0,nx=rtk->nx,nf = NF(opt),stat=1,frq,code;
+    int stats[MAXOBS]={0};
+    int i,j,k,sat,sys,nv=0,nf = NF(opt),stat=1,frq,code;
     
     time2str(obs[0].time,str,2);
     
-    for (i=0;i<MAXSAT;i++) for (j=0;j<opt->nf;j++) rtk->ssat[i].vsat[j]=0;
-    
+    /* reset valid flags of satellites of last call and current observations */
+    for (i=0;i<rtk->nsatact;i++) for (j=0;j<opt->nf;j++) {
+        rtk->ssat[rtk->satact[i]-1].vsat[j]=0;
+    }
+    for (i=rtk->nsatact=0;i<n&&i<MAXOBS;i++) {
+        for (j=0;j<opt->nf;j++) rtk->ssat[obs[i].sat-1].vsat[j]=0;
+        rtk->satact[rtk->nsatact++]=obs[i].sat;
+    }
     for (i=0;i<3;i++) rr[i]=x[i]+dr[i];
     ecef2pos(rr,pos);
     
+    /* ionospheric delays by tec grid for satellites of epoch */
+    if (opt->ionoopt==IONOOPT_TEC) {
+        for (i=0;i<n&&i<MAXOBS;i++) {
+            azel[i*2]=azel[1+i*2]=0.0;
+            if (geodist(rs+i*6,rr,e)>0.0) satazel(pos,e,azel+i*2);
+        }
+        iontec_sats(obs[0].time,nav,pos,azel,i,1,dions,varis,stats);
+    }
     for (i=0;i<n&&i<MAXOBS;i++) {
         sat=obs[i].sat;
         
@@ -948,8 +1024,15 @@ static int ppp_res(int post, const obsd_t *obs, int n, const double *rs,
             continue;
         }
         /* tropospheric and ionospheric model */
-        if (!model_trop(obs[i].time,pos,azel+i*2,opt,x,dtdx,nav,&dtrp,&vart)||
-            !model_iono(obs[i].time,pos,azel+i*2,opt,sat,x,nav,&dion,&vari)) {
+        if (!model_trop(obs[i].time,pos,azel+i*2,opt,x,dtdx,nav,&dtrp,&vart)) {
+            continue;
+        }
+        if (opt->ionoopt==IONOOPT_TEC) {
+            if (!stats[i]) continue;
+            dion=dions[i]; vari=varis[i];
+        }
+        else if (!model_iono(obs[i].time,pos,azel+i*2,opt,sat,x,nav,&dion,
+                             &vari)) {
             continue;
         }
         /* satellite and receiver antenna model */
@@ -958,7 +1041,8 @@ static int ppp_res(int post, const obsd_t *obs, int n, const double *rs,
         
         /* phase windup model */
         if (!model_phw(rtk->sol.time,sat,nav->pcvs[sat-1].type,
-                       opt->posopt[2]?2:0,rs+i*6,rr,&rtk->ssat[sat-1].phw)) {
+                       opt->posopt[2]?2:0,rs+i*6,rr,astro,
+                       &rtk->ssat[sat-1].phw)) {
             continue;
         }
         /* corrected phase and code measurements */
@@ -981,7 +1065,8 @@ static int ppp_res(int post, const obsd_t *obs, int n, const double *rs,
                 if ((freq=sat2freq(sat,obs[i].code[frq],nav))==0.0) continue;
                 C=SQR(FREQL1/freq)*ionmapf(pos,azel+i*2)*(code==0?-1.0:1.0);
             }
-            for (k=0;k<nx;k++) H[k+nx*nv]=k<3?-e[k]:0.0;
+            for (k=0;k<na;k++) H[k+na*nv]=0.0;
+            for (k=0;k<3;k++) seth(ia,na,nv,k,-e[k],H);
             
             /* receiver clock */
             switch (sys) {
@@ -992,24 +1077,24 @@ static int ppp_res(int post, const obsd_t *obs, int n, const double *rs,
                 default:      k=0; break;
             }
             cdtr=x[IC(k,opt)];
-            H[IC(k,opt)+nx*nv]=1.0;
+            seth(ia,na,nv,IC(k,opt),1.0,H);
             
             if (opt->tropopt==TROPOPT_EST||opt->tropopt==TROPOPT_ESTG) {
                 for (k=0;k<(opt->tropopt>=TROPOPT_ESTG?3:1);k++) {
-                    H[IT(opt)+k+nx*nv]=dtdx[k];
+                    seth(ia,na,nv,IT(opt)+k,dtdx[k],H);
                 }
             }
             if (opt->ionoopt==IONOOPT_EST) {
                 if (rtk->x[II(sat,opt)]==0.0) continue;
-                H[II(sat,opt)+nx*nv]=C;
+                seth(ia,na,nv,II(sat,opt),C,H);
             }
             if (frq==2&&code==1) { /* L5-receiver-dcb */
                 dcb+=rtk->x[ID(opt)];
-                H[ID(opt)+nx*nv]=1.0;
+                seth(ia,na,nv,ID(opt),1.0,H);
             }
             if (code==0) { /* phase bias */
                 if ((bias=x[IB(sat,frq,opt)])==0.0) continue;
-                H[IB(sat,frq,opt)+nx*nv]=1.0;
+                seth(ia,na,nv,IB(sat,frq,opt),1.0,H);
             }
             /* residual */
             v[nv]=y-(r+cdtr-CLIGHT*dts[i*2]+dtrp+C*dion+dcb+bias);
@@ -1064,6 +1149,11 @@ extern int pppnx(const prcopt_t *opt)
 {
     return NX(opt);
 }
+/* index of phase-bias state (-1: no state for the frequency) ----------------*/
+extern int pppib(int sat, int f, const prcopt_t *opt)
+{
+    return f<NF(opt)?IB(sat,f,opt):-1;
+}
 /* update solution status ----------------------------------------------------*/
 static void update_stat(rtk_t *rtk, const obsd_t *obs, int n, int stat)
 {
@@ -1148,21 +1238,46 @@ static int test_hold_amb(rtk_t *rtk)
     /* test # of continuous fixed */
     return ++rtk->nfix>=rtk->opt.minfix;
 }
+/* update covariance of active states ----------------------------------------*/
+static void setstates(double *P, int nx, const double *Pa, const int *ix,
+                      int na)
+{
+    int i,j;
+    
+    for (i=0;i<na;i++) for (j=0;j<na;j++) {
+        P[ix[i]+ix[j]*nx]=Pa[i+j*na];
+    }
+}
+/* clear covariance of states dropped from active states ---------------------*/
+static void clearstates(double *P, int nx, const int *ia)
+{
+    int i,j;
+    
+    for (i=0;i<nx;i++) {
+        if (ia[i]>=0||P[i+i*nx]==0.0) continue;
+        for (j=0;j<nx;j++) P[i+j*nx]=P[j+i*nx]=0.0;
+    }
+}
 /* precise point positioning -------------------------------------------------*/
 extern void pppos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
 {
     const prcopt_t *opt=&rtk->opt;
-    double *rs,*dts,*var,*v,*H,*R,*azel,*xp,*Pp,dr[3]={0},std[3];
+    astro_t astro;
+    double *rs,*dts,*var,*v,*H,*R,*azel,*xp,*x_,*Pp,dr[3]={0},std[3],tick;
     char str[32];
-    int i,j,nv,info,svh[MAXOBS],exc[MAXOBS]={0},stat=SOLQ_SINGLE;
+    int i,j,k,nv,na,nx=rtk->nx,info,*ix,*ia,svh[MAXOBS],exc[MAXOBS]={0};
+    int stat=SOLQ_SINGLE,valid;
     
     time2str(obs[0].time,str,2);
     trace(3,"pppos   : time=%s nx=%d n=%d\n",str,rtk->nx,n);
     
     rs=mat(6,n); dts=mat(2,n); var=mat(1,n); azel=zeros(2,n);
     
-    for (i=0;i<MAXSAT;i++) for (j=0;j<opt->nf;j++) rtk->ssat[i].fix[j]=0;
-    for (i=0;i<MAXOBS;i++) for (j=0;j<opt->nf;j++) {
+    /* fix flags are set only for satellites of last call of ppp_res() */
+    for (i=0;i<rtk->nsatact;i++) for (j=0;j<opt->nf;j++) {
+        rtk->ssat[rtk->satact[i]-1].fix[j]=0;
+    }
+    for (i=0;i<n&&i<MAXOBS;i++) for (j=0;j<opt->nf;j++) {
         rtk->ssat[obs[i].sat-1].snr_rover[j]=obs[i].SNR[j];
         rtk->ssat[obs[i].sat-1].snr_base[j] =0;
     }
@@ -1170,41 +1285,74 @@ extern void pppos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
     /* temporal update of ekf states */
     udstate_ppp(rtk,obs,n,nav);
     
+    /* astronomical context of epoch */
+    setastro(obs[0].time,&nav->erp,&astro);
+    
     /* satellite positions and clocks */
-    satposs(obs[0].time,obs,n,nav,rtk->opt.sateph,rs,dts,var,svh);
+    tick=PRFTICK(rtk);
+    satposs(obs[0].time,obs,n,nav,rtk->opt.sateph,&astro,rs,dts,var,svh);
+    PRFADD(rtk,PRF_SATPOSS,tick);
     
     /* exclude measurements of eclipsing satellite (block IIA) */
     if (rtk->opt.posopt[3]) {
-        testeclipse(obs,n,nav,rs);
+        testeclipse(obs,n,nav,&astro,rs);
     }
     /* earth tides correction */
     if (opt->tidecorr) {
-        tidedisp(gpst2utc(obs[0].time),rtk->x,opt->tidecorr==1?1:7,&nav->erp,
-                 opt->odisp[0],dr);
+        if (opt->tideint>0.0) {
+            tidedisp_cache(rtk->tidec,opt->tideint,gpst2utc(obs[0].time),
+                           rtk->x,opt->tidecorr==1?1:7,&nav->erp,opt->odisp[0],
+                           dr);
+        }
+        else {
+            tidedisp(gpst2utc(obs[0].time),rtk->x,opt->tidecorr==1?1:7,
+                     &nav->erp,opt->odisp[0],&astro,dr);
+        }
+    }
+    /* active states (non-zero states with positive variance) */
+    ix=imat(nx,1); ia=imat(nx,1);
+    for (i=na=0;i<nx;i++) {
+        ia[i]=rtk->x[i]!=0.0&&rtk->P[i+i*nx]>0.0?na:-1;
+        if (ia[i]>=0) ix[na++]=i;
     }
     nv=n*rtk->opt.nf*2+MAXSAT+3;
-    xp=mat(rtk->nx,1); Pp=zeros(rtk->nx,rtk->nx);
-    v=mat(nv,1); H=mat(rtk->nx,nv); R=mat(nv,nv);
+    xp=mat(nx,1); x_=mat(na,1); Pp=mat(na,na);
+    v=mat(nv,1); H=mat(na,nv); R=mat(nv,nv);
     
     for (i=0;i<MAX_ITER;i++) {
         
-        matcpy(xp,rtk->x,rtk->nx,1);
-        matcpy(Pp,rtk->P,rtk->nx,rtk->nx);
-        
+        matcpy(xp,rtk->x,nx,1);
+        for (j=0;j<na;j++) for (k=0;k<na;k++) {
+            Pp[j+k*na]=rtk->P[ix[j]+ix[k]*nx];
+        }
         /* prefit residuals */
-        if (!(nv=ppp_res(0,obs,n,rs,dts,var,svh,dr,exc,nav,xp,rtk,v,H,R,azel))) {
+        tick=PRFTICK(rtk);
+        nv=ppp_res(0,obs,n,rs,dts,var,svh,dr,exc,nav,&astro,xp,ia,na,rtk,v,H,R,
+                   azel);
+        PRFADD(rtk,PRF_PPPRES,tick);
+        if (!nv) {
             trace(2,"%s ppp (%d) no valid obs data\n",str,i+1);
             break;
         }
         /* measurement update of ekf states */
-        if ((info=filter(xp,Pp,H,v,R,rtk->nx,nv))) {
+        for (j=0;j<na;j++) x_[j]=xp[ix[j]];
+        tick=PRFTICK(rtk);
+        info=filter(x_,Pp,H,v,R,na,nv);
+        PRFADD(rtk,PRF_FILTER,tick);
+        if (info) {
             trace(2,"%s ppp (%d) filter error info=%d\n",str,i+1,info);
             break;
         }
+        for (j=0;j<na;j++) xp[ix[j]]=x_[j];
+        
         /* postfit residuals */
-        if (ppp_res(i+1,obs,n,rs,dts,var,svh,dr,exc,nav,xp,rtk,v,H,R,azel)) {
-            matcpy(rtk->x,xp,rtk->nx,1);
-            matcpy(rtk->P,Pp,rtk->nx,rtk->nx);
+        tick=PRFTICK(rtk);
+        valid=ppp_res(i+1,obs,n,rs,dts,var,svh,dr,exc,nav,&astro,xp,ia,na,rtk,
+                      v,H,R,azel);
+        PRFADD(rtk,PRF_PPPRES,tick);
+        if (valid) {
+            matcpy(rtk->x,xp,nx,1);
+            setstates(rtk->P,nx,Pp,ix,na);
             stat=SOLQ_PPP;
             break;
         }
@@ -1214,13 +1362,22 @@ extern void pppos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
     }
     if (stat==SOLQ_PPP) {
         
-        if (ppp_ar(rtk,obs,n,exc,nav,azel,xp,Pp)&&
-            ppp_res(9,obs,n,rs,dts,var,svh,dr,exc,nav,xp,rtk,v,H,R,azel)) {
+        tick=PRFTICK(rtk);
+        valid=ppp_ar(rtk,obs,n,exc,nav,azel,xp,Pp,ix,na);
+        PRFADD(rtk,PRF_PPPAR,tick);
+        if (valid) {
+            tick=PRFTICK(rtk);
+            valid=ppp_res(9,obs,n,rs,dts,var,svh,dr,exc,nav,&astro,xp,ia,na,rtk,
+                          v,H,R,azel);
+            PRFADD(rtk,PRF_PPPRES,tick);
+        }
+        if (valid) {
             
-            matcpy(rtk->xa,xp,rtk->nx,1);
-            matcpy(rtk->Pa,Pp,rtk->nx,rtk->nx);
+            matcpy(rtk->xa,xp,nx,1);
+            clearstates(rtk->Pa,nx,ia);
+            setstates(rtk->Pa,nx,Pp,ix,na);
             
-            for (i=0;i<3;i++) std[i]=sqrt(Pp[i+i*rtk->nx]);
+            for (i=0;i<3;i++) std[i]=sqrt(rtk->Pa[i+i*nx]);
             if (norm(std,3)<MAX_STD_FIX) stat=SOLQ_FIX;
         }
         else { 
@@ -1230,12 +1387,12 @@ extern void pppos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
         update_stat(rtk,obs,n,stat);
         
         if (stat==SOLQ_FIX&&test_hold_amb(rtk)) {
-            matcpy(rtk->x,xp,rtk->nx,1);
-            matcpy(rtk->P,Pp,rtk->nx,rtk->nx);
+            matcpy(rtk->x,xp,nx,1);
+            setstates(rtk->P,nx,Pp,ix,na);
             trace(2,"%s hold ambiguity\n",str);
             rtk->nfix=0;
         } 
     }
-    free(rs); free(dts); free(var); free(azel);
-    free(xp); free(Pp); free(v); free(H); free(R);
+    free(rs); free(dts); free(var); free(azel); free(ix); free(ia);
+    free(xp); free(x_); free(Pp); free(v); free(H); free(R);
 }
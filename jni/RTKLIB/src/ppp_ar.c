@@ -4,6 +4,9 @@
 * reference :
 *    [1] H.Okumura, C-gengo niyoru saishin algorithm jiten (in Japanese),
 *        Software Technology, 1991
+*    [2] D.Laurichesse et al., Integer ambiguity resolution on undifferenced
+*        GPS phase measurements and its application to PPP and satellite
+*        precise orbit determination, Navigation 56(2), 2009
 *
 *          Copyright (C) 2012-2015 by T.TAKASU, All rights reserved.
 *
@@ -13,9 +16,236 @@
 *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
-/* ambiguity resolution in ppp -----------------------------------------------*/
+#define SQR(x)      ((x)*(x))
+#define MIN(x,y)    ((x)<(y)?(x):(y))
+#define MAX(x,y)    ((x)>(y)?(x):(y))
+#define ROUND(x)    (int)floor((x)+0.5)
+
+#define MIN_ARC_WL  10              /* min epochs of MW average to fix wide-lane */
+#define MAX_STD_WL  0.15            /* max std-dev of MW average to fix (cyc) */
+#define THRES_WL    0.25            /* max fraction of wide-lane to fix (cyc) */
+#define MAX_RATIO   999.9           /* max ratio-test value */
+#define VAR_FIXAMB  SQR(0.001)      /* variance of fixed ambiguity (m^2) */
+
+/* number of frequencies of phase-bias states for ar (state layout of ppp.c) */
+#define NFAR(opt)   (pppib(1,1,opt)<0?1:2)
+
+typedef struct {                /* ambiguity resolution satellite type */
+    int sat;                    /* satellite number */
+    int sys;                    /* satellite system */
+    int ib[2];                  /* phase-bias indexes in active states */
+    double el;                  /* elevation angle (rad) */
+    double freq[2];             /* L1/L2 frequencies (Hz) */
+    double wl;                  /* average of wide-lane ambiguity (cycle) */
+} arsat_t;
+
+typedef struct {                /* single-difference ambiguity type */
+    int i,j;                    /* satellite/reference satellite indexes */
+    int nw;                     /* single-difference wide-lane ambiguity */
+} sdamb_t;
+
+/* index of state in active states -------------------------------------------*/
+static int actidx(const int *ix, int na, int i)
+{
+    int lo=0,hi=na-1,k;
+    
+    while (lo<=hi) {
+        k=(lo+hi)/2;
+        if (ix[k]==i) return k;
+        if (ix[k]<i) lo=k+1; else hi=k-1;
+    }
+    return -1;
+}
+/* select satellite for ambiguity resolution ---------------------------------*/
+static int selsat(const rtk_t *rtk, const obsd_t *obs, const nav_t *nav,
+                  const double *azel, const int *ix, int na, arsat_t *s)
+{
+    const prcopt_t *opt=&rtk->opt;
+    const ambc_t *amb=rtk->ambc+obs->sat-1;
+    int f,k;
+    
+    s->sat=obs->sat;
+    s->sys=satsys(obs->sat,NULL);
+    s->el=azel[1];
+    
+    /* glonass fdma and sbas excluded */
+    if (!(s->sys&(SYS_GPS|SYS_GAL|SYS_QZS|SYS_CMP))) return 0;
+    if (s->el<MAX(opt->elmaskar,opt->elmin)) return 0;
+    if (!rtk->ssat[obs->sat-1].vsat[0]||
+        rtk->ssat[obs->sat-1].lock[0]<opt->minlock) return 0;
+    
+    /* wide-lane ambiguity average */
+    if (amb->n[0]<MIN_ARC_WL||amb->LCv[0]/amb->n[0]>SQR(MAX_STD_WL)) return 0;
+    s->wl=amb->LC[0];
+    
+    for (f=0;f<2;f++) {
+        s->freq[f]=sat2freq(obs->sat,obs->code[f],nav);
+        if (s->freq[f]==0.0) return 0;
+        s->ib[f]=-1;
+        if ((k=pppib(obs->sat,f,opt))<0) continue;
+        if ((s->ib[f]=actidx(ix,na,k))<0) return 0;
+    }
+    return 1;
+}
+/* narrow-lane/L1 float ambiguities and covariance ---------------------------*/
+static void nlfloat(const prcopt_t *opt, const arsat_t *s, const sdamb_t *sd,
+                    int m, const double *x, const double *P, const int *ix,
+                    int na, double *a, double *Q)
+{
+    double c[MAXOBS],f1,f2,lam_nl,alpha;
+    int k,l,ik,jk,il,jl;
+    
+    for (k=0;k<m;k++) {
+        f1=s[sd[k].i].freq[0];
+        f2=s[sd[k].i].freq[1];
+        ik=s[sd[k].i].ib[0];
+        jk=s[sd[k].j].ib[0];
+        
+        if (opt->ionoopt==IONOOPT_IFLC) {
+            /* B_IF=lam_NL*N1+alpha*Nw (m) */
+            lam_nl=CLIGHT/(f1+f2);
+            alpha=CLIGHT*f2/(SQR(f1)-SQR(f2));
+            c[k]=1.0/lam_nl;
+            a[k]=(x[ix[ik]]-x[ix[jk]]-alpha*sd[k].nw)*c[k];
+        }
+        else { /* B1=lam1*N1 (m) */
+            c[k]=f1/CLIGHT;
+            a[k]=(x[ix[ik]]-x[ix[jk]])*c[k];
+        }
+    }
+    for (k=0;k<m;k++) for (l=0;l<=k;l++) {
+        ik=s[sd[k].i].ib[0]; jk=s[sd[k].j].ib[0];
+        il=s[sd[l].i].ib[0]; jl=s[sd[l].j].ib[0];
+        Q[k+l*m]=Q[l+k*m]=c[k]*c[l]*(P[ik+il*na]-P[ik+jl*na]-P[jk+il*na]+
+                                     P[jk+jl*na]);
+    }
+}
+/* update states by fixed ambiguities ----------------------------------------*/
+static int fixamb(const prcopt_t *opt, const arsat_t *s, const sdamb_t *sd,
+                  int m, const double *F, double *x, double *P, const int *ix,
+                  int na)
+{
+    double *x_,*H,*v,*R,f1,f2,y;
+    int i,k,f,nv=0,nf=NFAR(opt),info;
+    
+    x_=mat(na,1); H=zeros(na,m*nf); v=mat(m*nf,1); R=zeros(m*nf,m*nf);
+    
+    for (i=0;i<na;i++) x_[i]=x[ix[i]];
+    
+    for (k=0;k<m;k++) for (f=0;f<nf;f++) {
+        f1=s[sd[k].i].freq[0];
+        f2=s[sd[k].i].freq[1];
+        
+        if (opt->ionoopt==IONOOPT_IFLC) {
+            y=CLIGHT/(f1+f2)*F[k]+CLIGHT*f2/(SQR(f1)-SQR(f2))*sd[k].nw;
+        }
+        else if (f==0) y=CLIGHT/f1*F[k];
+        else           y=CLIGHT/f2*(F[k]-sd[k].nw); /* N2=N1-Nw */
+        
+        H[s[sd[k].i].ib[f]+nv*na]= 1.0;
+        H[s[sd[k].j].ib[f]+nv*na]=-1.0;
+        v[nv]=y-(x_[s[sd[k].i].ib[f]]-x_[s[sd[k].j].ib[f]]);
+        R[nv+nv*m*nf]=VAR_FIXAMB;
+        nv++;
+    }
+    if (!(info=filter(x_,P,H,v,R,na,nv))) {
+        for (i=0;i<na;i++) x[ix[i]]=x_[i];
+    }
+    free(x_); free(H); free(v); free(R);
+    return !info;
+}
+/* ambiguity resolution in ppp -------------------------------------------------
+* resolve integer ambiguities of ppp on the active states of the filter
+* args   : double *x        IO  states (rtk->nx x 1)
+*          double *P        IO  covariance of active states (na x na)
+*          int    *ix       I   indexes of active states in x (na x 1)
+*          int    na        I   number of active states
+* return : status (1:fixed,0:not fixed)
+* notes  : wide-lane ambiguities are fixed by rounding the Melbourne-Wubbena
+*          averages of udwl_ppp() in ppp.c and narrow-lane (iono-free LC) or
+*          L1 (iono estimation) ambiguities by LAMBDA [2]. ambiguities are
+*          single-differenced between satellites of a system to cancel the
+*          receiver biases, the satellite biases should be corrected by
+*          phase-bias/FCB products of ssr (corr_phase_bias_ssr()).
+*          x and P are updated with the fixed ambiguities as constraints.
+*-----------------------------------------------------------------------------*/
 extern int ppp_ar(rtk_t *rtk, const obsd_t *obs, int n, int *exc,
-                  const nav_t *nav, const double *azel, double *x, double *P)
+                  const nav_t *nav, const double *azel, double *x, double *P,
+                  const int *ix, int na)
 {
-    return 0;
+    const prcopt_t *opt=&rtk->opt;
+    arsat_t s[MAXOBS];
+    sdamb_t sd[MAXOBS];
+    double *a,*Q,F[MAXOBS*2],r[2],ratio=0.0,wl;
+    int i,j,k,m,ns,nmin,stat=0;
+    
+    trace(3,"ppp_ar  : n=%d na=%d\n",n,na);
+    
+    rtk->sol.ratio=0.0f;
+    rtk->sol.thres=(float)opt->thresar[0];
+    
+    if (opt->modear==ARMODE_OFF||opt->nf<2||
+        (opt->ionoopt!=IONOOPT_IFLC&&opt->ionoopt!=IONOOPT_EST)) return 0;
+    
+    /* select satellites */
+    for (i=ns=0;i<n&&i<MAXOBS;i++) {
+        if (exc[i]) continue;
+        if (selsat(rtk,obs+i,nav,azel+i*2,ix,na,s+ns)) ns++;
+    }
+    /* fix single-difference wide-lane ambiguities */
+    for (i=m=0;i<ns;i++) {
+        
+        /* reference satellite with highest elevation in system */
+        for (j=k=0;k<ns;k++) {
+            if (s[k].sys!=s[i].sys) continue;
+            if (s[k].el>s[j].el||s[j].sys!=s[i].sys) j=k;
+        }
+        if (j==i||s[i].freq[0]!=s[j].freq[0]||s[i].freq[1]!=s[j].freq[1]) {
+            continue;
+        }
+        wl=s[i].wl-s[j].wl;
+        if (fabs(wl-ROUND(wl))>THRES_WL) {
+            trace(3,"ppp_ar: wide-lane not fixed sat=%2d-%2d wl=%.3f\n",
+                  s[i].sat,s[j].sat,wl);
+            continue;
+        }
+        sd[m].i=i; sd[m].j=j; sd[m++].nw=ROUND(wl);
+    }
+    nmin=opt->minfixsats>1?opt->minfixsats-1:1;
+    if (m<nmin) return 0;
+    
+    a=mat(m,1); Q=mat(m,m);
+    
+    /* fix narrow-lane ambiguities excluding low elevation satellites */
+    while (m>=nmin) {
+        nlfloat(opt,s,sd,m,x,P,ix,na,a,Q);
+        
+        if (!lambda(m,2,a,Q,F,r)) {
+            ratio=r[0]>0.0?r[1]/r[0]:MAX_RATIO;
+            if (ratio>MAX_RATIO) ratio=MAX_RATIO;
+            
+            trace(3,"ppp_ar: m=%d ratio=%.2f\n",m,ratio);
+            
+            if (ratio>=opt->thresar[0]) {
+                stat=1;
+                break;
+            }
+        }
+        for (i=k=0;i<m;i++) {
+            if (s[sd[i].i].el<s[sd[k].i].el) k=i;
+        }
+        for (i=k;i<m-1;i++) sd[i]=sd[i+1];
+        m--;
+    }
+    rtk->sol.ratio=(float)ratio;
+    
+    if (stat&&(stat=fixamb(opt,s,sd,m,F,x,P,ix,na))) {
+        for (k=0;k<m;k++) for (i=0;i<NFAR(opt);i++) {
+            rtk->ssat[s[sd[k].i].sat-1].fix[i]=2;
+            rtk->ssat[s[sd[k].j].sat-1].fix[i]=2;
+        }
+        trace(3,"ppp_ar: ambiguity fixed m=%d ratio=%.2f\n",m,ratio);
+    }
+    free(a); free(Q);
+    return stat;
 }
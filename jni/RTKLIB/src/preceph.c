@@ -57,6 +57,8 @@
 #define MAXDTE      900.0           /* max time difference to ephem time (s) */
 #define EXTERR_CLK  1E-3            /* extrapolation error for clock (m/s) */
 #define EXTERR_EPH  5E-7            /* extrapolation error for ephem (m/s^2) */
+#define TOLPFIT     1E-4            /* tolerance of Chebyshev fit (m) */
+#define CACHE_PEPH  1               /* cache section: precise ephemeris */
 
 /* satellite code to satellite system ----------------------------------------*/
 static int code2sys(char code)
@@ -112,7 +114,7 @@ static int readsp3h(FILE *fp, gtime_t *time, char *type, int *sats,
     return ns;
 }
 /* add precise ephemeris -----------------------------------------------------*/
-static int addpeph(nav_t *nav, peph_t *peph)
+static int addpeph(nav_t *nav, const peph_t *peph)
 {
     peph_t *nav_peph;
     
@@ -250,6 +252,58 @@ static void combpeph(nav_t *nav, int opt)
     
     trace(4,"combpeph: ne=%d\n",nav->ne);
 }
+/* read sp3 file with binary cache -------------------------------------------*/
+static int readsp3f(const char *file, int index, int opt, nav_t *nav)
+{
+    FILE *fp;
+    cache_t cache;
+    uncomp_t unc;
+    const peph_t *peph;
+    gtime_t time={0};
+    double bfact[2]={0};
+    int i,n,ne=nav->ne,ns,cstat,sats[MAXSAT]={0};
+    char key[64],type=' ',tsys[4]="";
+    
+    sprintf(key,"sp3 %d %d",index,opt);
+    
+    if (opencache(file,key,&cache)) {
+        if ((peph=(const peph_t *)getcache(&cache,CACHE_PEPH,sizeof(peph_t),
+                                           &n))) {
+            for (i=0;i<n;i++) if (!addpeph(nav,peph+i)) break;
+            closecache(&cache,0);
+            return 1;
+        }
+        closecache(&cache,-1);
+        opencache(file,key,&cache);
+    }
+    /* open compressed file by in-process uncompressed stream */
+    if ((cstat=openuncomp(file,&unc))>0) {
+        fp=unc.fp;
+    }
+    else if (cstat<0||!(fp=fopen(file,"r"))) {
+        trace(2,"sp3 file open error %s\n",file);
+        closecache(&cache,0);
+        return 0;
+    }
+    /* read sp3 header */
+    ns=readsp3h(fp,&time,&type,sats,bfact,tsys);
+    
+    /* read sp3 body */
+    readsp3b(fp,type,sats,ns,bfact,tsys,index,opt,nav);
+    
+    if (cstat>0) {
+        if (closeuncomp(&unc)<0) {
+            trace(2,"sp3 file uncompress error %s\n",file);
+        }
+    }
+    else fclose(fp);
+    
+    if (nav->ne>=ne) {
+        putcache(&cache,CACHE_PEPH,nav->peph+ne,sizeof(peph_t),nav->ne-ne);
+    }
+    closecache(&cache,nav->ne>=ne);
+    return 1;
+}
 /* read sp3 precise ephemeris file ---------------------------------------------
 * read sp3 precise ephemeris/clock files and set them to navigation data
 * args   : char   *file       I   sp3-c precise ephemeris file
@@ -263,14 +317,13 @@ static void combpeph(nav_t *nav, int opt)
 *          nav->peph and nav->ne must by properly initialized before calling the
 *          function
 *          only files with extensions of .sp3, .SP3, .eph* and .EPH* are read
+*          gzip or unix compressed files (*.gz, *.Z) are uncompressed in-process
+*          Chebyshev polynomials are fitted to orbits by fitpeph() after reading
 *-----------------------------------------------------------------------------*/
 extern void readsp3(const char *file, nav_t *nav, int opt)
 {
-    FILE *fp;
-    gtime_t time={0};
-    double bfact[2]={0};
-    int i,j,n,ns,sats[MAXSAT]={0};
-    char *efiles[MAXEXFILE],*ext,type=' ',tsys[4]="";
+    int i,j,n;
+    char *efiles[MAXEXFILE],*ext,path[1024];
     
     trace(3,"readpephs: file=%s\n",file);
     
@@ -284,27 +337,28 @@ extern void readsp3(const char *file, nav_t *nav, int opt)
     n=expath(file,efiles,MAXEXFILE);
     
     for (i=j=0;i<n;i++) {
-        if (!(ext=strrchr(efiles[i],'.'))) continue;
+        strcpy(path,efiles[i]);
         
-        if (!strstr(ext,".sp3")&&!strstr(ext,".SP3")&&
-            !strstr(ext,".eph")&&!strstr(ext,".EPH")) continue;
-        
-        if (!(fp=fopen(efiles[i],"r"))) {
-            trace(2,"sp3 file open error %s\n",efiles[i]);
-            continue;
+        /* strip extension of compressed file */
+        if ((ext=strrchr(path,'.'))&&
+            (!strcmp(ext,".gz")||!strcmp(ext,".GZ")||!strcmp(ext,".Z"))) {
+            *ext='\0';
         }
-        /* read sp3 header */
-        ns=readsp3h(fp,&time,&type,sats,bfact,tsys);
+        if (!(ext=strrchr(path,'.'))) continue;
         
-        /* read sp3 body */
-        readsp3b(fp,type,sats,ns,bfact,tsys,j++,opt,nav);
+        if (!strstr(ext,".sp3")&&!strstr(ext,".SP3")&&
+            !strstr(ext,".eph")&&!strstr(ext,".EPH")) continue;
         
-        fclose(fp);
+        /* read sp3 file */
+        if (readsp3f(efiles[i],j,opt,nav)) j++;
     }
     for (i=0;i<MAXEXFILE;i++) free(efiles[i]);
     
     /* combine precise ephemeris */
     if (nav->ne>0) combpeph(nav,opt);
+    
+    /* fit Chebyshev polynomials to orbits */
+    fitpeph(nav,TOLPFIT);
 }
 /* read satellite antenna parameters -------------------------------------------
 * read satellite antenna parameters
@@ -418,43 +472,60 @@ static double interppol(const double *x, double *y, int n)
     }
     return y[0];
 }
-/* satellite position by precise ephemeris -----------------------------------*/
-static int pephpos(gtime_t time, int sat, const nav_t *nav, double *rs,
-                   double *dts, double *vare, double *varc)
+/* search index of time-tagged data ------------------------------------------
+* search index of last data before time (0 if none) in data sorted by time.
+* each element of data should start with time tag (gtime_t). the index is
+* guessed by uniform interval and checked, then binary search is done only
+* for non-uniform interval
+*-----------------------------------------------------------------------------*/
+static int searchtime(const void *data, int n, size_t size, gtime_t time)
 {
-    double t[NMAX+1],p[3][NMAX+1],c[2],*pos,std=0.0,s[3],sinl,cosl;
-    int i,j,k,index;
+    const uint8_t *p=(const uint8_t *)data;
+    double span,t0;
+    int i,j,k;
     
-    trace(4,"pephpos : time=%s sat=%2d\n",time_str(time,3),sat);
+    if (n<2) return 0;
     
-    rs[0]=rs[1]=rs[2]=dts[0]=0.0;
+    span=timediff(*(const gtime_t *)(p+(n-1)*size),*(const gtime_t *)p);
+    t0=timediff(time,*(const gtime_t *)p);
+    k=span>0.0?(int)floor(t0/span*(n-1)):0;
+    if (k<0) k=0; else if (k>n-2) k=n-2;
     
-    if (nav->ne<NMAX+1||
-        timediff(time,nav->peph[0].time)<-MAXDTE||
-        timediff(time,nav->peph[nav->ne-1].time)>MAXDTE) {
-        trace(3,"no prec ephem %s sat=%2d\n",time_str(time,0),sat);
-        return 0;
+    if ((k<=0||timediff(*(const gtime_t *)(p+k*size),time)<0.0)&&
+        (k>=n-2||timediff(*(const gtime_t *)(p+(k+1)*size),time)>=0.0)) {
+        return k;
     }
     /* binary search */
-    for (i=0,j=nav->ne-1;i<j;) {
+    for (i=0,j=n-1;i<j;) {
         k=(i+j)/2;
-        if (timediff(nav->peph[k].time,time)<0.0) i=k+1; else j=k;
+        if (timediff(*(const gtime_t *)(p+k*size),time)<0.0) i=k+1; else j=k;
     }
-    index=i<=0?0:i-1;
+    return i<=0?0:i-1;
+}
+/* first index of interpolation nodes for interval ---------------------------*/
+static int nodeindex(const nav_t *nav, int index)
+{
+    int i=index-(NMAX+1)/2;
     
-    /* polynomial interpolation for orbit */
-    i=index-(NMAX+1)/2;
     if (i<0) i=0; else if (i+NMAX>=nav->ne) i=nav->ne-NMAX-1;
+    return i;
+}
+/* satellite position by polynomial interpolation ----------------------------*/
+static int interppos(const nav_t *nav, int i0, gtime_t time, int sat,
+                     double *rs)
+{
+    double t[NMAX+1],p[3][NMAX+1],*pos,sinl,cosl;
+    int i,j;
     
     for (j=0;j<=NMAX;j++) {
-        t[j]=timediff(nav->peph[i+j].time,time);
-        if (norm(nav->peph[i+j].pos[sat-1],3)<=0.0) {
+        t[j]=timediff(nav->peph[i0+j].time,time);
+        if (norm(nav->peph[i0+j].pos[sat-1],3)<=0.0) {
             trace(3,"prec ephem outage %s sat=%2d\n",time_str(time,0),sat);
             return 0;
         }
     }
     for (j=0;j<=NMAX;j++) {
-        pos=nav->peph[i+j].pos[sat-1];
+        pos=nav->peph[i0+j].pos[sat-1];
         /* correciton for earh rotation ver.2.4.0 */
         sinl=sin(OMGE*t[j]);
         cosl=cos(OMGE*t[j]);
@@ -465,15 +536,46 @@ static int pephpos(gtime_t time, int sat, const nav_t *nav, double *rs,
     for (i=0;i<3;i++) {
         rs[i]=interppol(t,p[i],NMAX+1);
     }
-    if (vare) {
-        for (i=0;i<3;i++) s[i]=nav->peph[index].std[sat-1][i];
-        std=norm(s,3);
-        
-        /* extrapolation error for orbit */
-        if      (t[0   ]>0.0) std+=EXTERR_EPH*SQR(t[0   ])/2.0;
-        else if (t[NMAX]<0.0) std+=EXTERR_EPH*SQR(t[NMAX])/2.0;
-        *vare=SQR(std);
-    }
+    return 1;
+}
+/* satellite position/velocity by Chebyshev fit ------------------------------*/
+static void pfitpos(const pfit_t *pfit, gtime_t time, int sat, double *rs)
+{
+    double T,tau,u,Tk[MAXPFIT],dTk[MAXPFIT],q[3]={0},dq[3]={0},sinl,cosl;
+    int i,k,n=pfit->n[sat-1];
+    
+    T=timediff(pfit->te,pfit->ts);
+    tau=timediff(time,pfit->ts);
+    u=2.0*tau/T-1.0;
+    
+    /* Chebyshev polynomials and derivatives */
+    Tk[0]=1.0; dTk[0]=0.0;
+    Tk[1]=u;   dTk[1]=1.0;
+    for (k=2;k<n;k++) {
+        Tk [k]=2.0*u*Tk[k-1]-Tk[k-2];
+        dTk[k]=2.0*Tk[k-1]+2.0*u*dTk[k-1]-dTk[k-2];
+    }
+    for (i=0;i<3;i++) for (k=0;k<n;k++) {
+        q [i]+=pfit->c[sat-1][i][k]*Tk [k];
+        dq[i]+=pfit->c[sat-1][i][k]*dTk[k]*2.0/T;
+    }
+    /* inertial frame at start of interval to ecef */
+    sinl=sin(OMGE*tau);
+    cosl=cos(OMGE*tau);
+    rs[0]= cosl*q[0]+sinl*q[1];
+    rs[1]=-sinl*q[0]+cosl*q[1];
+    rs[2]=q[2];
+    rs[3]= cosl*dq[0]+sinl*dq[1]+OMGE*rs[1];
+    rs[4]=-sinl*dq[0]+cosl*dq[1]-OMGE*rs[0];
+    rs[5]=dq[2];
+}
+/* satellite clock by precise ephemeris --------------------------------------*/
+static void sp3clk(gtime_t time, int index, int sat, const nav_t *nav,
+                   double *dts, double *varc)
+{
+    double t[2],c[2],std=0.0;
+    int i;
+    
     /* linear interpolation for clock */
     t[0]=timediff(time,nav->peph[index  ].time);
     t[1]=timediff(time,nav->peph[index+1].time);
@@ -499,6 +601,52 @@ static int pephpos(gtime_t time, int sat, const nav_t *nav, double *rs,
         dts[0]=0.0;
     }
     if (varc) *varc=SQR(std);
+}
+/* satellite position/velocity by precise ephemeris --------------------------*/
+static int pephpos(gtime_t time, int sat, const nav_t *nav, double *rs,
+                   double *dts, double *vare, double *varc)
+{
+    const pfit_t *pfit;
+    double t[2],std=0.0,s[3],rst[3],tt=1E-3;
+    int i,i0,index;
+    
+    rs[0]=rs[1]=rs[2]=dts[0]=0.0;
+    
+    if (nav->ne<NMAX+1||
+        timediff(time,nav->peph[0].time)<-MAXDTE||
+        timediff(time,nav->peph[nav->ne-1].time)>MAXDTE) {
+        trace(3,"no prec ephem %s sat=%2d\n",time_str(time,0),sat);
+        return 0;
+    }
+    index=searchtime(nav->peph,nav->ne,sizeof(peph_t),time);
+    i0=nodeindex(nav,index);
+    pfit=nav->nf==nav->ne-1?nav->pfit+index:NULL;
+    
+    if (pfit&&pfit->n[sat-1]>0&&timediff(time,pfit->ts)>=0.0&&
+        timediff(time,pfit->te)<=0.0) {
+        
+        /* Chebyshev fit for orbit */
+        pfitpos(pfit,time,sat,rs);
+    }
+    else {
+        /* polynomial interpolation for orbit */
+        if (!interppos(nav,i0,time,sat,rs)||
+            !interppos(nav,i0,timeadd(time,tt),sat,rst)) return 0;
+        for (i=0;i<3;i++) rs[i+3]=(rst[i]-rs[i])/tt;
+    }
+    if (vare) {
+        for (i=0;i<3;i++) s[i]=nav->peph[index].std[sat-1][i];
+        std=norm(s,3);
+        
+        /* extrapolation error for orbit */
+        t[0]=timediff(nav->peph[i0     ].time,time);
+        t[1]=timediff(nav->peph[i0+NMAX].time,time);
+        if      (t[0]>0.0) std+=EXTERR_EPH*SQR(t[0])/2.0;
+        else if (t[1]<0.0) std+=EXTERR_EPH*SQR(t[1])/2.0;
+        *vare=SQR(std);
+    }
+    /* clock by precise ephemeris */
+    sp3clk(time,index,sat,nav,dts,varc);
     return 1;
 }
 /* satellite clock by precise clock ------------------------------------------*/
@@ -506,9 +654,7 @@ static int pephclk(gtime_t time, int sat, const nav_t *nav, double *dts,
                    double *varc)
 {
     double t[2],c[2],std;
-    int i,j,k,index;
-    
-    trace(4,"pephclk : time=%s sat=%2d\n",time_str(time,3),sat);
+    int i,index;
     
     if (nav->nc<2||
         timediff(time,nav->pclk[0].time)<-MAXDTE||
@@ -516,12 +662,7 @@ static int pephclk(gtime_t time, int sat, const nav_t *nav, double *dts,
         trace(3,"no prec clock %s sat=%2d\n",time_str(time,0),sat);
         return 1;
     }
-    /* binary search */
-    for (i=0,j=nav->nc-1;i<j;) {
-        k=(i+j)/2;
-        if (timediff(nav->pclk[k].time,time)<0.0) i=k+1; else j=k;
-    }
-    index=i<=0?0:i-1;
+    index=searchtime(nav->pclk,nav->nc,sizeof(pclk_t),time);
     
     /* linear interpolation for clock */
     t[0]=timediff(time,nav->pclk[index  ].time);
@@ -549,6 +690,94 @@ static int pephclk(gtime_t time, int sat, const nav_t *nav, double *dts,
     if (varc) *varc=SQR(std);
     return 1;
 }
+/* fit Chebyshev polynomial to interval of precise ephemeris -----------------*/
+static void fitpephsat(const nav_t *nav, int k, int sat, double tol,
+                       pfit_t *pfit)
+{
+    double T,t[NMAX+1],q[3][NMAX+1],y[NMAX+1],f[3][MAXPFIT],*pos,sinl,cosl;
+    double tm,cmax,sum;
+    int i,j,m,n,i0=nodeindex(nav,k);
+    
+    pfit->n[sat-1]=0;
+    
+    if ((T=timediff(pfit->te,pfit->ts))<=0.0) return;
+    
+    /* node positions in inertial frame at start of interval */
+    for (j=0;j<=NMAX;j++) {
+        pos=nav->peph[i0+j].pos[sat-1];
+        if (norm(pos,3)<=0.0) return;
+        t[j]=timediff(nav->peph[i0+j].time,pfit->ts);
+        sinl=sin(OMGE*t[j]);
+        cosl=cos(OMGE*t[j]);
+        q[0][j]=cosl*pos[0]-sinl*pos[1];
+        q[1][j]=sinl*pos[0]+cosl*pos[1];
+        q[2][j]=pos[2];
+    }
+    /* interpolated positions at Chebyshev nodes */
+    for (m=0;m<MAXPFIT;m++) {
+        tm=(cos(PI*(m+0.5)/MAXPFIT)+1.0)*T/2.0;
+        for (i=0;i<3;i++) {
+            for (j=0;j<=NMAX;j++) {
+                y[j]=q[i][j];
+                t[j]=timediff(nav->peph[i0+j].time,pfit->ts)-tm;
+            }
+            f[i][m]=interppol(t,y,NMAX+1);
+        }
+    }
+    /* Chebyshev coefficients */
+    for (i=0;i<3;i++) for (j=0;j<MAXPFIT;j++) {
+        for (m=0,sum=0.0;m<MAXPFIT;m++) {
+            sum+=f[i][m]*cos(PI*j*(m+0.5)/MAXPFIT);
+        }
+        pfit->c[sat-1][i][j]=sum*(j==0?1.0:2.0)/MAXPFIT;
+    }
+    /* truncate coefficients within tolerance */
+    for (n=MAXPFIT,sum=0.0;n>2;n--) {
+        for (i=0,cmax=0.0;i<3;i++) {
+            if (fabs(pfit->c[sat-1][i][n-1])>cmax) {
+                cmax=fabs(pfit->c[sat-1][i][n-1]);
+            }
+        }
+        if ((sum+=cmax)>tol) break;
+    }
+    pfit->n[sat-1]=(uint8_t)n;
+}
+/* fit Chebyshev polynomials to precise ephemeris ------------------------------
+* fit Chebyshev polynomials to satellite orbits of precise ephemeris for each
+* interval of ephemeris epochs
+* args   : nav_t  *nav        IO  navigation data
+*          double tol         I   tolerance of fit (m) (0: no fit)
+* return : number of fits
+* notes  : satellite positions are fitted in the inertial frame aligned to ecef
+*          at the start of each interval. the fit is done to the same polynomial
+*          interpolation by peph2pos() without fit, and higher coefficients are
+*          truncated as far as the sum of truncated ones is within tolerance.
+*          peph2pos() uses the fit if nav->nf==nav->ne-1, otherwise it uses the
+*          polynomial interpolation as before
+*-----------------------------------------------------------------------------*/
+extern int fitpeph(nav_t *nav, double tol)
+{
+    int i,j;
+    
+    trace(3,"fitpeph : ne=%d tol=%.3g\n",nav->ne,tol);
+    
+    free(nav->pfit); nav->pfit=NULL; nav->nf=0;
+    
+    if (tol<=0.0||nav->ne<NMAX+1) return 0;
+    
+    if (!(nav->pfit=(pfit_t *)malloc(sizeof(pfit_t)*(nav->ne-1)))) {
+        trace(1,"fitpeph malloc error n=%d\n",nav->ne-1);
+        return 0;
+    }
+    for (i=0;i<nav->ne-1;i++) {
+        nav->pfit[i].ts=nav->peph[i  ].time;
+        nav->pfit[i].te=nav->peph[i+1].time;
+        for (j=0;j<MAXSAT;j++) {
+            fitpephsat(nav,i,j+1,tol,nav->pfit+i);
+        }
+    }
+    return nav->nf=nav->ne-1;
+}
 /* satellite antenna phase center offset ---------------------------------------
 * compute satellite antenna phase center offset in ecef
 * args   : gtime_t time       I   time (gpst)
@@ -556,10 +785,13 @@ static int pephclk(gtime_t time, int sat, const nav_t *nav, double *dts,
 *                                 {x,y,z,vx,vy,vz} (m|m/s)
 *          int    sat         I   satellite number
 *          nav_t  *nav        I   navigation data
+*          astro_t *astro     I   astronomical context of epoch (NULL: no use)
 *          double *dant       O   satellite antenna phase center offset (ecef)
 *                                 {dx,dy,dz} (m) (iono-free LC value)
 * return : none
-* notes  : iono-free LC frequencies defined as follows:
+* notes  : sun position is rotated from the epoch of astro to time by earth
+*          rotation
+*          iono-free LC frequencies defined as follows:
 *            GPS/QZSS : L1-L2
 *            GLONASS  : G1-G2
 *            Galileo  : E1-E5b
@@ -567,11 +799,11 @@ static int pephclk(gtime_t time, int sat, const nav_t *nav, double *dts,
 *            NavIC    : L5-S
 *-----------------------------------------------------------------------------*/
 extern void satantoff(gtime_t time, const double *rs, int sat, const nav_t *nav,
-                      double *dant)
+                      const astro_t *astro, double *dant)
 {
     const pcv_t *pcv=nav->pcvs+sat-1;
     double ex[3],ey[3],ez[3],es[3],r[3],rsun[3],gmst,erpv[5]={0},freq[2];
-    double C1,C2,dant1,dant2;
+    double C1,C2,dant1,dant2,sinl,cosl;
     int i,sys;
     
     trace(4,"satantoff: time=%s sat=%2d\n",time_str(time,3),sat);
@@ -579,7 +811,16 @@ extern void satantoff(gtime_t time, const double *rs, int sat, const nav_t *nav,
     dant[0]=dant[1]=dant[2]=0.0;
     
     /* sun position in ecef */
-    sunmoonpos(gpst2utc(time),erpv,rsun,NULL,&gmst);
+    if (astro) {
+        sinl=sin(OMGE*timediff(time,astro->time));
+        cosl=cos(OMGE*timediff(time,astro->time));
+        rsun[0]= cosl*astro->rsun[0]+sinl*astro->rsun[1];
+        rsun[1]=-sinl*astro->rsun[0]+cosl*astro->rsun[1];
+        rsun[2]=astro->rsun[2];
+    }
+    else {
+        sunmoonpos(gpst2utc(time),erpv,rsun,NULL,&gmst);
+    }
     
     /* unit vectors of satellite fixed coordinates */
     for (i=0;i<3;i++) r[i]=-rs[i];
@@ -631,6 +872,7 @@ extern void satantoff(gtime_t time, const double *rs, int sat, const nav_t *nav,
 *          nav_t  *nav        I   navigation data
 *          int    opt         I   sat postion option
 *                                 (0: center of mass, 1: antenna phase center)
+*          astro_t *astro     I   astronomical context of epoch (NULL: no use)
 *          double *rs         O   sat position and velocity (ecef)
 *                                 {x,y,z,vx,vy,vz} (m|m/s)
 *          double *dts        O   sat clock {bias,drift} (s|s/s)
@@ -643,31 +885,33 @@ extern void satantoff(gtime_t time, const double *rs, int sat, const nav_t *nav,
 *          if precise clocks are not set, clocks in sp3 are used instead
 *-----------------------------------------------------------------------------*/
 extern int peph2pos(gtime_t time, int sat, const nav_t *nav, int opt,
-                    double *rs, double *dts, double *var)
+                    const astro_t *astro, double *rs, double *dts, double *var)
 {
     gtime_t time_tt;
-    double rss[3],rst[3],dtss[1],dtst[1],dant[3]={0},vare=0.0,varc=0.0,tt=1E-3;
+    double rss[6],dtss[1],dtst[1],dant[3]={0},vare=0.0,varc=0.0,tt=1E-3;
     int i;
     
     trace(4,"peph2pos: time=%s sat=%2d opt=%d\n",time_str(time,3),sat,opt);
     
     if (sat<=0||MAXSAT<sat) return 0;
     
-    /* satellite position and clock bias */
+    /* satellite position/velocity and clock bias */
     if (!pephpos(time,sat,nav,rss,dtss,&vare,&varc)||
         !pephclk(time,sat,nav,dtss,&varc)) return 0;
     
+    /* clock bias after tt for clock drift */
     time_tt=timeadd(time,tt);
-    if (!pephpos(time_tt,sat,nav,rst,dtst,NULL,NULL)||
-        !pephclk(time_tt,sat,nav,dtst,NULL)) return 0;
+    sp3clk(time_tt,searchtime(nav->peph,nav->ne,sizeof(peph_t),time_tt),sat,
+           nav,dtst,NULL);
+    if (!pephclk(time_tt,sat,nav,dtst,NULL)) return 0;
     
     /* satellite antenna offset correction */
     if (opt) {
-        satantoff(time,rss,sat,nav,dant);
+        satantoff(time,rss,sat,nav,astro,dant);
     }
     for (i=0;i<3;i++) {
         rs[i  ]=rss[i]+dant[i];
-        rs[i+3]=(rst[i]-rss[i])/tt;
+        rs[i+3]=rss[i+3];
     }
     /* relativistic effect correction */
     if (dtss[0]!=0.0) {
@@ -289,7 +289,7 @@ static int decode_bnx_01_01(raw_t *raw, uint8_t *buff, int len)
     eph.code=(flag>>9)&0x03;
     eph.sva=uraindex(ura);
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (raw->nav.eph[eph.sat-1].iode==eph.iode&&
             raw->nav.eph[eph.sat-1].iodc==eph.iodc) return 0; /* unchanged */
     }
@@ -345,7 +345,7 @@ static int decode_bnx_01_02(raw_t *raw, uint8_t *buff, int len)
     geph.tof=utc2gpst(adjday(raw->time,tof-10800.0));
     geph.iode=(int)(fmod(tod,86400.0)/900.0+0.5);
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (fabs(timediff(geph.toe,raw->nav.geph[prn-MINPRNGLO].toe))<1.0&&
             geph.svh==raw->nav.geph[prn-MINPRNGLO].svh) return 0;
     }
@@ -396,7 +396,7 @@ static int decode_bnx_01_03(raw_t *raw, uint8_t *buff, int len)
     seph.t0=gpst2time(week,tow);
     seph.tof=adjweek(seph.t0,tof);
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (fabs(timediff(seph.t0,raw->nav.seph[prn-MINPRNSBS].t0))<1.0&&
             seph.sva==raw->nav.seph[prn-MINPRNSBS].sva) return 0;
     }
@@ -415,8 +415,8 @@ static int decode_bnx_01_04(raw_t *raw, uint8_t *buff, int len)
     
     trace(4,"BINEX 0x01-04: len=%d\n",len);
     
-    if (strstr(raw->opt,"-GALFNAV")) eph_sel=1;
-    if (strstr(raw->opt,"-GALINAV")) eph_sel=2;
+    if (raw->copt.flag&COPT_GALFNAV) eph_sel=1;
+    if (raw->copt.flag&COPT_GALINAV) eph_sel=2;
     
     if (len>=127) {
         prn       =U1(p)+1;      p+=1;
@@ -467,7 +467,7 @@ static int decode_bnx_01_04(raw_t *raw, uint8_t *buff, int len)
     eph.toc=gpst2time(eph.week,eph.toes);
     eph.ttr=adjweek(eph.toe,tow);
     eph.sva=ura<0.0?(int)(-ura)-1:sisaindex(ura); /* SISA index */
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (raw->nav.eph[sat-1+MAXSAT*set].iode==eph.iode&&
             fabs(timediff(raw->nav.eph[sat-1+MAXSAT*set].toe,eph.toe))<1.0&&
             fabs(timediff(raw->nav.eph[sat-1+MAXSAT*set].toc,eph.toc))<1.0) {
@@ -545,7 +545,7 @@ static int decode_bnx_01_05(raw_t *raw, uint8_t *buff, int len)
     eph.code=(flag2>>25)&0x7F;
         /* message source (0:unknown,1:B1I,2:B1Q,3:B2I,4:B2Q,5:B3I,6:B3Q)*/
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (fabs(timediff(raw->nav.eph[sat-1].toe,eph.toe))<1.0) return 0;
     }
     raw->nav.eph[sat-1]=eph;
@@ -610,7 +610,7 @@ static int decode_bnx_01_06(raw_t *raw, uint8_t *buff, int len)
     eph.sva=uraindex(ura);
     eph.code=2; /* codes on L2 channel */
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (raw->nav.eph[sat-1].iode==eph.iode&&
             raw->nav.eph[sat-1].iodc==eph.iodc) return 0;
     }
@@ -674,7 +674,7 @@ static int decode_bnx_01_07(raw_t *raw, uint8_t *buff, int len)
     eph.iode=eph.iodc=iodec&0xFF;
     eph.tgd[0]=(int8_t)(iodec>>8)*P2_31;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (raw->nav.eph[sat-1].iode==eph.iode&&
             fabs(timediff(raw->nav.eph[sat-1].toe,eph.toe))<1.0&&
             fabs(timediff(raw->nav.eph[sat-1].toc,eph.toc))<1.0) return 0;
@@ -694,8 +694,8 @@ static int decode_bnx_01_14(raw_t *raw, uint8_t *buff, int len)
     
     trace(4,"BINEX 0x01-14: len=%d\n",len);
     
-    if (strstr(raw->opt,"-GALFNAV")) eph_sel=1;
-    if (strstr(raw->opt,"-GALINAV")) eph_sel=2;
+    if (raw->copt.flag&COPT_GALFNAV) eph_sel=1;
+    if (raw->copt.flag&COPT_GALINAV) eph_sel=2;
     
     if (len>=135) {
         prn       =U1(p)+1;      p+=1;
@@ -747,7 +747,7 @@ static int decode_bnx_01_14(raw_t *raw, uint8_t *buff, int len)
     eph.toc=gpst2time(eph.week,tocs);
     eph.ttr=adjweek(eph.toe,tow);
     eph.sva=ura<0.0?(int)(-ura)-1:sisaindex(ura); /* SISA index */
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (raw->nav.eph[sat-1+MAXSAT*set].iode==eph.iode&&
             fabs(timediff(raw->nav.eph[sat-1+MAXSAT*set].toe,eph.toe))<1.0&&
             fabs(timediff(raw->nav.eph[sat-1+MAXSAT*set].toc,eph.toc))<1.0) {
@@ -968,7 +968,7 @@ static uint8_t *decode_bnx_7f_05_obs(raw_t *raw, uint8_t *buff, int sat,
     /* get code priority */
     for (i=0;i<nobs;i++) {
         idx[i]=code2idx(sys,codes[code[i]]);
-        pri[i]=getcodepri(sys,codes[code[i]],raw->opt);
+        pri[i]=getcodepric(sys,codes[code[i]],&raw->copt);
     }
     for (i=0;i<NFREQ;i++) {
         for (j=0,k=-1;j<nobs;j++) {
@@ -195,22 +195,22 @@ static int decode_trackstat(unsigned int stat, int *sys, int *code, int *track,
     return freq;
 }
 /* check code priority and return obs position -------------------------------*/
-static int checkpri(const char *opt, int sys, int code, int freq)
+static int checkpri(const copt_t *copt, int sys, int code, int freq)
 {
     int nex=NEXOBS; /* number of extended obs data */
     
     if (sys==SYS_GPS) {
-        if (strstr(opt,"-GL1P")&&freq==0) return code==CODE_L1P?0:-1;
-        if (strstr(opt,"-GL2X")&&freq==1) return code==CODE_L2X?1:-1;
+        if (testsigopt(copt,sys,"1P")&&freq==0) return code==CODE_L1P?0:-1;
+        if (testsigopt(copt,sys,"2X")&&freq==1) return code==CODE_L2X?1:-1;
         if (code==CODE_L1P) return nex<1?-1:NFREQ;
         if (code==CODE_L2X) return nex<2?-1:NFREQ+1;
     }
     else if (sys==SYS_GLO) {
-        if (strstr(opt,"-RL2C")&&freq==1) return code==CODE_L2C?1:-1;
+        if (testsigopt(copt,sys,"2C")&&freq==1) return code==CODE_L2C?1:-1;
         if (code==CODE_L2C) return nex<1?-1:NFREQ;
     }
     else if (sys==SYS_GAL) {
-        if (strstr(opt,"-EL1B")&&freq==0) return code==CODE_L1B?0:-1;
+        if (testsigopt(copt,sys,"1B")&&freq==0) return code==CODE_L1B?0:-1;
         if (code==CODE_L1B) return nex<1?-1:NFREQ;
         if (code==CODE_L7Q) return nex<2?-1:NFREQ+1;
         if (code==CODE_L8Q) return nex<3?-1:NFREQ+2;
@@ -245,7 +245,7 @@ static int decode_rangecmpb(raw_t *raw)
                                    &parity,&halfc))<0) continue;
         
         /* obs position */
-        if ((pos=checkpri(raw->opt,sys,code,freq))<0) continue;
+        if ((pos=checkpri(&raw->copt,sys,code,freq))<0) continue;
         
         prn=U1(p+17);
         if (sys==SYS_GLO) prn-=37;
@@ -342,7 +342,7 @@ static int decode_rangeb(raw_t *raw)
                                    &parity,&halfc))<0) continue;
         
         /* obs position */
-        if ((pos=checkpri(raw->opt,sys,code,freq))<0) continue;
+        if ((pos=checkpri(&raw->copt,sys,code,freq))<0) continue;
         
         prn=U2(p);
         if (sys==SYS_GLO) prn-=37;
@@ -427,7 +427,7 @@ static int decode_rawephemb(raw_t *raw)
         trace(2,"cnav rawephemb subframe error: prn=%d\n",prn);
         return -1;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode) return 0; /* unchanged */
     }
     eph.sat=sat;
@@ -538,7 +538,7 @@ static int decode_gloephemerisb(raw_t *raw)
     else if (tof>tow+43200.0) tof-=86400.0;
     geph.tof=gpst2time(week,tof);
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (fabs(timediff(geph.toe,raw->nav.geph[prn-1].toe))<1.0&&
             geph.svh==raw->nav.geph[prn-1].svh) return 0; /* unchanged */
     }
@@ -583,7 +583,7 @@ static int decode_qzssrawephemb(raw_t *raw)
         decode_frame(raw->subfrm[sat-1]+60,&eph,NULL,NULL,NULL,NULL)!=3) {
         return 0;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iodc==raw->nav.eph[sat-1].iodc&&
             eph.iode==raw->nav.eph[sat-1].iode) return 0; /* unchanged */
     }
@@ -622,7 +622,7 @@ static int decode_qzssrawsubframeb(raw_t *raw)
         decode_frame(p+72,&eph,NULL,NULL,NULL,NULL)!=3) {
         return 0;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iodc==raw->nav.eph[sat-1].iodc&&
             eph.iode==raw->nav.eph[sat-1].iode) return 0; /* unchanged */
     }
@@ -710,8 +710,8 @@ static int decode_galephemerisb(raw_t *raw)
                (svh_e1b<<1)|dvs_e1b;
     
     /* ephemeris selection (0:INAV,1:FNAV) */
-    if      (strstr(raw->opt,"-GALINAV")) sel_nav=0;
-    else if (strstr(raw->opt,"-GALFNAV")) sel_nav=1;
+    if      (raw->copt.flag&COPT_GALINAV) sel_nav=0;
+    else if (raw->copt.flag&COPT_GALFNAV) sel_nav=1;
     else if (!rcv_inav&&rcv_fnav) sel_nav=1;
     
     eph.A     =sqrtA*sqrtA;
@@ -740,7 +740,7 @@ static int decode_galephemerisb(raw_t *raw)
     eph.toc=adjweek(eph.toe,sel_nav?toc_fnav:toc_inav);
     eph.ttr=adjweek(eph.toe,tow);
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (raw->nav.eph[eph.sat-1].iode==eph.iode&&
             raw->nav.eph[eph.sat-1].code==eph.code) return 0; /* unchanged */
     }
@@ -995,7 +995,7 @@ static int decode_bdsephemerisb(raw_t *raw)
     eph.toc=bdt2gpst(bdt2time(eph.week,toc));      /* bdt -> gpst */
     eph.ttr=raw->time;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (timediff(raw->nav.eph[eph.sat-1].toe,eph.toe)==0.0&&
             raw->nav.eph[eph.sat-1].iode==eph.iode&&
             raw->nav.eph[eph.sat-1].iodc==eph.iodc) return 0; /* unchanged */
@@ -117,7 +117,7 @@ static int decode_cresraw(raw_t *raw)
     time=gpst2time(week,tows);
     
     /* time tag offset correction */
-    if (strstr(raw->opt,"-TTCORR")) {
+    if (raw->copt.flag&COPT_TTCORR) {
         toff=CLIGHT*(tows-tow);
     }
     for (i=n=0,p+=12;i<12&&n<MAXOBS;i++,p+=24) {
@@ -183,7 +183,7 @@ static int decode_cresraw2(raw_t *raw)
     time=gpst2time(week,tows);
     
     /* time tag offset correction */
-    if (strstr(raw->opt,"-TTCORR")) {
+    if (raw->copt.flag&COPT_TTCORR) {
         toff=CLIGHT*(tows-tow);
     }
     if (fabs(timediff(time,raw->time))<1e-9) {
@@ -271,7 +271,7 @@ static int decode_cresraw2(raw_t *raw)
     }
     raw->time=time;
     raw->obs.n=n;
-    if (strstr(raw->opt,"-ENAGLO")) return 0; /* glonass follows */
+    if (raw->copt.flag&COPT_ENAGLO) return 0; /* glonass follows */
     return 1;
 }
 /* decode bin 95 ephemeris ---------------------------------------------------*/
@@ -301,7 +301,7 @@ static int decode_creseph(raw_t *raw)
         trace(2,"crescent bin 95 navigation frame error: prn=%d\n",prn);
         return -1;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode) return 0; /* unchanged */
     }
     eph.sat=sat;
@@ -374,7 +374,7 @@ static int decode_cresgloraw(raw_t *raw)
     
     trace(4,"decode_cregloraw: len=%d\n",raw->len);
     
-    if (!strstr(raw->opt,"-ENAGLO")) return 0;
+    if (!(raw->copt.flag&COPT_ENAGLO)) return 0;
     
     if (raw->len!=364) {
         trace(2,"crescent bin 66 message length error: len=%d\n",raw->len);
@@ -386,7 +386,7 @@ static int decode_cresgloraw(raw_t *raw)
     time=gpst2time(week,tows);
     
     /* time tag offset correction */
-    if (strstr(raw->opt,"-TTCORR")) {
+    if (raw->copt.flag&COPT_TTCORR) {
         toff=CLIGHT*(tows-tow);
     }
     if (fabs(timediff(time,raw->time))<1e-9) {
@@ -487,7 +487,7 @@ static int decode_cresgloeph(raw_t *raw)
     
     trace(4,"decode_cregloeph: len=%d\n",raw->len);
     
-    if (!strstr(raw->opt,"-ENAGLO")) return 0;
+    if (!(raw->copt.flag&COPT_ENAGLO)) return 0;
     
     prn =U1(p);   p+=1;
     frq =U1(p)-8; p+=1+2;
@@ -513,7 +513,7 @@ static int decode_cresgloeph(raw_t *raw)
     if (!decode_glostr(raw->subfrm[sat-1],&geph,NULL)||geph.sat!=sat) return -1;
     geph.frq=frq;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (geph.iode==raw->nav.geph[prn-1].iode) return 0; /* unchanged */
     }
     raw->nav.geph[prn-1]=geph;
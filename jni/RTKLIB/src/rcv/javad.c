@@ -140,27 +140,27 @@ static int sig2idx(int sys, char sig, int *code)
     return idx<NFREQ?idx:-1;
 }
 /* check code priority and return freq-index ---------------------------------*/
-static int checkpri(int sys, int code, const char *opt, int idx)
+static int checkpri(int sys, int code, const copt_t *copt, int idx)
 {
     int nex=NEXOBS; /* number of extended obs data */
     
     if (sys==SYS_GPS) {
-        if (strstr(opt,"-GL1W")&&idx==0) return code==CODE_L1W?0:-1;
-        if (strstr(opt,"-GL1X")&&idx==0) return code==CODE_L1X?0:-1;
-        if (strstr(opt,"-GL2X")&&idx==1) return code==CODE_L2X?1:-1;
+        if (testsigopt(copt,sys,"1W")&&idx==0) return code==CODE_L1W?0:-1;
+        if (testsigopt(copt,sys,"1X")&&idx==0) return code==CODE_L1X?0:-1;
+        if (testsigopt(copt,sys,"2X")&&idx==1) return code==CODE_L2X?1:-1;
         if (code==CODE_L1W) return nex<1?-1:NFREQ;
         if (code==CODE_L2X) return nex<2?-1:NFREQ+1;
         if (code==CODE_L1X) return nex<3?-1:NFREQ+2;
     }
     else if (sys==SYS_GLO) {
-        if (strstr(opt,"-RL1P")&&idx==0) return code==CODE_L1P?0:-1;
-        if (strstr(opt,"-RL2C")&&idx==1) return code==CODE_L2C?1:-1;
+        if (testsigopt(copt,sys,"1P")&&idx==0) return code==CODE_L1P?0:-1;
+        if (testsigopt(copt,sys,"2C")&&idx==1) return code==CODE_L2C?1:-1;
         if (code==CODE_L1P) return nex<1?-1:NFREQ;
         if (code==CODE_L2C) return nex<2?-1:NFREQ+1;
     }
     else if (sys==SYS_QZS) {
-        if (strstr(opt,"-JL1Z")&&idx==0) return code==CODE_L1Z?0:-1;
-        if (strstr(opt,"-JL1X")&&idx==0) return code==CODE_L1X?0:-1;
+        if (testsigopt(copt,sys,"1Z")&&idx==0) return code==CODE_L1Z?0:-1;
+        if (testsigopt(copt,sys,"1X")&&idx==0) return code==CODE_L1X?0:-1;
         if (code==CODE_L1Z) return nex<1?-1:NFREQ;
         if (code==CODE_L1X) return nex<2?-1:NFREQ+1;
     }
@@ -462,8 +462,8 @@ static int decode_eph(raw_t *raw, int sys)
     
     trace(3,"decode_eph: sys=%2d prn=%3d\n",sys,U1(p));
     
-    if (strstr(raw->opt,"-GALINAV")) eph_sel=1;
-    if (strstr(raw->opt,"-GALFNAV")) eph_sel=2;
+    if (raw->copt.flag&COPT_GALINAV) eph_sel=1;
+    if (raw->copt.flag&COPT_GALFNAV) eph_sel=2;
     
     prn       =U1(p);        p+=1;
     tow       =U4(p);        p+=4;
@@ -564,7 +564,7 @@ static int decode_eph(raw_t *raw, int sys)
     }
     else return 0;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (timediff(raw->nav.eph[sat-1+MAXSAT*set].toe,eph.toe)==0.0&&
             raw->nav.eph[sat-1+MAXSAT*set].iode==eph.iode&&
             raw->nav.eph[sat-1+MAXSAT*set].iodc==eph.iodc) return 0; /* unchanged */
@@ -653,7 +653,7 @@ static int decode_NE(raw_t *raw)
               raw->nav.geph[prn-1].frq,geph.frq);
         return -1;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (fabs(timediff(geph.toe,raw->nav.geph[prn-1].toe))<1.0&&
             geph.svh==raw->nav.geph[prn-1].svh) return 0; /* unchanged */
     }
@@ -713,7 +713,7 @@ static int decode_WE(raw_t *raw)
     seph.tof=gpst2time(adjgpsweek(week),tow);
     seph.t0=adjday(seph.tof,tod);
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (fabs(timediff(seph.t0,raw->nav.seph[prn-MINPRNSBS].t0))<1.0&&
             seph.sva==raw->nav.seph[prn-MINPRNSBS].sva) return 0; /* unchanged */
     }
@@ -835,7 +835,7 @@ static int decode_L1eph(int sat, raw_t *raw)
     
     if (!decode_frame(raw->subfrm[sat-1],&eph,NULL,NULL,NULL)) return 0;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode&&
             eph.iodc==raw->nav.eph[sat-1].iodc) return 0;
     }
@@ -1095,7 +1095,7 @@ static int decode_lD(raw_t *raw)
     if (!decode_glostr(raw->subfrm[sat-1],&geph,NULL)||geph.sat!=sat) return -1;
     geph.frq=frq;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (geph.iode==raw->nav.geph[prn-1].iode) return 0; /* unchanged */
     }
     raw->nav.geph[prn-1]=geph;
@@ -1199,7 +1199,7 @@ static int decode_Rx(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             raw->obuf.data[i].P[idx]=prm;
             raw->obuf.data[i].code[idx]=code;
@@ -1245,7 +1245,7 @@ static int decode_rx(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             raw->obuf.data[i].P[idx]=prm;
             raw->obuf.data[i].code[idx]=(uint8_t)code;
@@ -1278,7 +1278,7 @@ static int decode_xR(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             raw->obuf.data[i].P[idx]=pr*CLIGHT+raw->prCA[sat-1];
             raw->obuf.data[i].code[idx]=(uint8_t)code;
@@ -1314,7 +1314,7 @@ static int decode_xr(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             raw->obuf.data[i].P[idx]=prm;
             raw->obuf.data[i].code[idx]=(uint8_t)code;
@@ -1346,7 +1346,7 @@ static int decode_Px(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             raw->obuf.data[i].L[idx]=cp;
             raw->obuf.data[i].code[idx]=(uint8_t)code;
@@ -1378,7 +1378,7 @@ static int decode_px(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             raw->obuf.data[i].L[idx]=cp/1024.0;
             raw->obuf.data[i].code[idx]=(uint8_t)code;
@@ -1411,7 +1411,7 @@ static int decode_xP(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             
             freq=code2freq(sys,code,raw->freqn[i]);
@@ -1448,7 +1448,7 @@ static int decode_xp(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             
             freq=code2freq(sys,(uint8_t)code,raw->freqn[i]);
@@ -1489,7 +1489,7 @@ static int decode_Dx(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             raw->obuf.data[i].D[idx]=(float)dop;
         }
@@ -1522,7 +1522,7 @@ static int decode_xd(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             f1=code2freq(sys,CODE_L1X,raw->freqn[i]);
             fn=code2freq(sys,code    ,raw->freqn[i]);
@@ -1557,7 +1557,7 @@ static int decode_Ex(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             raw->obuf.data[i].SNR[idx]=(uint16_t)(cnr/SNR_UNIT+0.5);
         }
@@ -1588,7 +1588,7 @@ static int decode_xE(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
             raw->obuf.data[i].SNR[idx]=(uint16_t)(cnr*0.25/SNR_UNIT+0.5);
         }
@@ -1620,7 +1620,7 @@ static int decode_Fx(raw_t *raw, char sig)
         
         if ((idx=sig2idx(sys,sig,&code))<0) continue;
         
-        if ((idx=checkpri(sys,code,raw->opt,idx))>=0) {
+        if ((idx=checkpri(sys,code,&raw->copt,idx))>=0) {
             if (!settag(raw->obuf.data+i,raw->time)) continue;
 #if 0 /* disable to suppress overdetection of cycle-slips */
             if (flags&0x20) { /* loss-of-lock potential */
@@ -1683,7 +1683,7 @@ static int decode_javad(raw_t *raw)
     }
     if (!strncmp(p,"~~",2)) return decode_RT(raw); /* receiver time */
     
-    if (strstr(raw->opt,"-NOET")) {
+    if (raw->copt.flag&COPT_NOET) {
         if (!strncmp(p,"::",2)) return decode_ET(raw); /* epoch time */
     }
     if (!strncmp(p,"RD",2)) return decode_RD(raw); /* receiver date */
@@ -322,35 +322,35 @@ static int decode_track_stat(uint32_t stat, int *sys, int *code, int *track,
     return idx;
 }
 /* check code priority and return freq-index ---------------------------------*/
-static int checkpri(const char *opt, int sys, int code, int idx)
+static int checkpri(const copt_t *copt, int sys, int code, int idx)
 {
     int nex=NEXOBS;
     
     if (sys==SYS_GPS) {
-        if (strstr(opt,"-GL1L")&&idx==0) return (code==CODE_L1L)?0:-1;
-        if (strstr(opt,"-GL2S")&&idx==1) return (code==CODE_L2X)?1:-1;
-        if (strstr(opt,"-GL2P")&&idx==1) return (code==CODE_L2P)?1:-1;
+        if (testsigopt(copt,sys,"1L")&&idx==0) return (code==CODE_L1L)?0:-1;
+        if (testsigopt(copt,sys,"2S")&&idx==1) return (code==CODE_L2X)?1:-1;
+        if (testsigopt(copt,sys,"2P")&&idx==1) return (code==CODE_L2P)?1:-1;
         if (code==CODE_L1L) return (nex<1)?-1:NFREQ;
         if (code==CODE_L2S) return (nex<2)?-1:NFREQ+1;
         if (code==CODE_L2P) return (nex<3)?-1:NFREQ+2;
     }
     else if (sys==SYS_GLO) {
-        if (strstr(opt,"-RL2C")&&idx==1) return (code==CODE_L2C)?1:-1;
+        if (testsigopt(copt,sys,"2C")&&idx==1) return (code==CODE_L2C)?1:-1;
         if (code==CODE_L2C) return (nex<1)?-1:NFREQ;
     }
     else if (sys==SYS_GAL) {
-        if (strstr(opt,"-EL6B")&&idx==3) return (code==CODE_L6B)?3:-1;
+        if (testsigopt(copt,sys,"6B")&&idx==3) return (code==CODE_L6B)?3:-1;
         if (code==CODE_L6B) return (nex<2)?-1:NFREQ;
     }
     else if (sys==SYS_QZS) {
-        if (strstr(opt,"-JL1L")&&idx==0) return (code==CODE_L1L)?0:-1;
-        if (strstr(opt,"-JL1Z")&&idx==0) return (code==CODE_L1Z)?0:-1;
+        if (testsigopt(copt,sys,"1L")&&idx==0) return (code==CODE_L1L)?0:-1;
+        if (testsigopt(copt,sys,"1Z")&&idx==0) return (code==CODE_L1Z)?0:-1;
         if (code==CODE_L1L) return (nex<1)?-1:NFREQ;
         if (code==CODE_L1Z) return (nex<2)?-1:NFREQ+1;
     }
     else if (sys==SYS_CMP) {
-        if (strstr(opt,"-CL1P")&&idx==0) return (code==CODE_L1P)?0:-1;
-        if (strstr(opt,"-CL7D")&&idx==0) return (code==CODE_L7D)?0:-1;
+        if (testsigopt(copt,sys,"1P")&&idx==0) return (code==CODE_L1P)?0:-1;
+        if (testsigopt(copt,sys,"7D")&&idx==0) return (code==CODE_L7D)?0:-1;
         if (code==CODE_L1P) return (nex<1)?-1:NFREQ;
         if (code==CODE_L7D) return (nex<2)?-1:NFREQ+1;
     }
@@ -360,11 +360,10 @@ static int checkpri(const char *opt, int sys, int code, int idx)
 static int decode_rangecmpb(raw_t *raw)
 {
     uint8_t *p=raw->buff+OEM4HLEN;
-    char *q;
     double psr,adr,adr_rolls,lockt,tt,dop,snr,freq,glo_bias=0.0;
     int i,index,nobs,prn,sat,sys,code,idx,track,plock,clock,parity,halfc,lli;
     
-    if ((q=strstr(raw->opt,"-GLOBIAS="))) sscanf(q,"-GLOBIAS=%lf",&glo_bias);
+    if (raw->copt.flag&COPT_GLOBIAS) glo_bias=raw->copt.globias;
     
     nobs=U4(p);
     if (raw->len<OEM4HLEN+4+nobs*24) {
@@ -392,7 +391,7 @@ static int decode_rangecmpb(raw_t *raw)
         }
         if (sys==SYS_GLO&&!parity) continue; /* invalid if GLO parity unknown */
         
-        if ((idx=checkpri(raw->opt,sys,code,idx))<0) continue;
+        if ((idx=checkpri(&raw->copt,sys,code,idx))<0) continue;
         
         dop=exsign(U4(p+4)&0xFFFFFFF,28)/256.0;
         psr=(U4(p+7)>>4)/128.0+U1(p+11)*2097152.0;
@@ -443,12 +442,11 @@ static int decode_rangecmpb(raw_t *raw)
 static int decode_rangeb(raw_t *raw)
 {
     uint8_t *p=raw->buff+OEM4HLEN;
-    char *q;
     double psr,adr,dop,snr,lockt,tt,freq,glo_bias=0.0;
     int i,index,nobs,prn,sat,sys,code,idx,track,plock,clock,parity,halfc,lli;
     int gfrq;
     
-    if ((q=strstr(raw->opt,"-GLOBIAS="))) sscanf(q,"-GLOBIAS=%lf",&glo_bias);
+    if (raw->copt.flag&COPT_GLOBIAS) glo_bias=raw->copt.globias;
     
     nobs=U4(p);
     if (raw->len<OEM4HLEN+4+nobs*44) {
@@ -476,7 +474,7 @@ static int decode_rangeb(raw_t *raw)
         }
         if (sys==SYS_GLO&&!parity) continue;
         
-        if ((idx=checkpri(raw->opt,sys,code,idx))<0) continue;
+        if ((idx=checkpri(&raw->copt,sys,code,idx))<0) continue;
         
         gfrq =U2(p+ 2); /* GLONASS FCN+8 */
         psr  =R8(p+ 4);
@@ -547,7 +545,7 @@ static int decode_rawephemb(raw_t *raw)
         trace(2,"oem4 rawephemb subframe error: prn=%d\n",prn);
         return -1;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode&&
             eph.iodc==raw->nav.eph[sat-1].iodc) return 0;
     }
@@ -653,7 +651,7 @@ static int decode_gloephemerisb(raw_t *raw)
     else if (tof>tow+43200.0) tof-=86400.0;
     geph.tof=gpst2time(week,tof);
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (fabs(timediff(geph.toe,raw->nav.geph[prn-1].toe))<1.0&&
             geph.svh==raw->nav.geph[prn-1].svh) return 0; /* unchanged */
     }
@@ -688,7 +686,7 @@ static int decode_qzssrawephemb(raw_t *raw)
         trace(3,"oem4 qzssrawephemb ephemeris error: prn=%d\n",prn);
         return 0;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iodc==raw->nav.eph[sat-1].iodc&&
             eph.iode==raw->nav.eph[sat-1].iode) return 0; /* unchanged */
     }
@@ -727,7 +725,7 @@ static int decode_qzssrawsubframeb(raw_t *raw)
     
     if (id==3) {
         if (!decode_frame(raw->subfrm[sat-1],&eph,NULL,NULL,NULL)) return 0;
-        if (!strstr(raw->opt,"-EPHALL")) {
+        if (!(raw->copt.flag&COPT_EPHALL)) {
             if (eph.iodc==raw->nav.eph[sat-1].iodc&&
                 eph.iode==raw->nav.eph[sat-1].iode) return 0; /* unchanged */
         }
@@ -773,8 +771,8 @@ static int decode_galephemerisb(raw_t *raw)
     int prn,sat,week,rcv_fnav,rcv_inav,svh_e1b,svh_e5a,svh_e5b,dvs_e1b,dvs_e5a;
     int dvs_e5b,toc_fnav,toc_inav,set,sel_eph=3; /* 1:I/NAV+2:F/NAV */
     
-    if (strstr(raw->opt,"-GALINAV")) sel_eph=1;
-    if (strstr(raw->opt,"-GALFNAV")) sel_eph=2;
+    if (raw->copt.flag&COPT_GALINAV) sel_eph=1;
+    if (raw->copt.flag&COPT_GALFNAV) sel_eph=2;
     
     if (raw->len<OEM4HLEN+220) {
         trace(2,"oem4 galephemrisb length error: len=%d\n",raw->len);
@@ -849,7 +847,7 @@ static int decode_galephemerisb(raw_t *raw)
     eph.toc=adjweek(raw->time,set?toc_fnav:toc_inav);
     eph.ttr=raw->time;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1+MAXSAT*set].iode&&
             timediff(eph.toe,raw->nav.eph[sat-1+MAXSAT*set].toe)==0.0&&
             timediff(eph.toc,raw->nav.eph[sat-1+MAXSAT*set].toc)==0.0) {
@@ -972,7 +970,7 @@ static int decode_bdsephemerisb(raw_t *raw)
     eph.toc=bdt2gpst(bdt2time(eph.week,toc));      /* bdt -> gpst */
     eph.ttr=raw->time;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (timediff(raw->nav.eph[sat-1].toe,eph.toe)==0.0&&
             timediff(raw->nav.eph[sat-1].toc,eph.toc)==0.0) return 0;
     }
@@ -1047,7 +1045,7 @@ static int decode_navicephemerisb(raw_t *raw)
     eph.ttr=raw->time;
     eph.tgd[1]=0.0;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (timediff(raw->nav.eph[sat-1].toe,eph.toe)==0.0&&
             raw->nav.eph[sat-1].iode==eph.iode) return 0; /* unchanged */
     }
@@ -1200,7 +1198,7 @@ static int decode_repb(raw_t *raw)
         trace(2,"oem3 repb subframe error: prn=%d\n",prn);
         return -1;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode) return 0; /* unchanged */
     }
     eph.sat=sat;
@@ -221,7 +221,7 @@ static int decode_gpsephem(int sat, raw_t *raw)
     eph.toc=gpst2time(eph.week,toc);
     eph.ttr=raw->time;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode) return 0; /* unchanged */
     }
     eph.sat=sat;
@@ -295,7 +295,7 @@ static int decode_gloephem(int sat, raw_t *raw)
               raw->nav.geph[prn-MINPRNGLO].frq,geph.frq);
         return -1;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (fabs(timediff(geph.toe,raw->nav.geph[prn-MINPRNGLO].toe))<1.0&&
             geph.svh==raw->nav.geph[prn-MINPRNGLO].svh) return 0;
     }
@@ -917,7 +917,7 @@ static int DecodeBeidouEphemeris(raw_t *Raw)
     eph.toe   = bdt2gpst(bdt2time(eph.week, toe));
     eph.ttr   = bdt2gpst(bdt2time(eph.week, tow));
     tracet(3, "RT17: DecodeBeidouEphemeris(); SAT=%d, IODC=%d, IODE=%d, WEEK=%d.\n", sat, eph.iodc, eph.iode, eph.week);
-    if (!strstr(Raw->opt,"-EPHALL"))
+    if (!(Raw->copt.flag&COPT_EPHALL))
     {
         if (eph.iode == Raw->nav.eph[sat-1].iode)
             return 0; /* unchanged */
@@ -1022,7 +1022,7 @@ static int DecodeGalileoEphemeris(raw_t *Raw)
     eph.toe   = gst2time(eph.week, toe);
     eph.ttr   = gst2time(eph.week, tow);
     tracet(3, "RT17: DecodeGalileoEphemeris(); SAT=%d, IODC=%d, IODE=%d, WEEK=%d.\n", sat, eph.iodc, eph.iode, eph.week);
-    if (!strstr(Raw->opt,"-EPHALL"))
+    if (!(Raw->copt.flag&COPT_EPHALL))
     {
         if (eph.iode == Raw->nav.eph[sat-1].iode)
             return 0; /* unchanged */
@@ -1198,7 +1198,7 @@ static int DecodeGPSEphemeris(raw_t *Raw)
         }
     }
  
-    if (!strstr(Raw->opt,"-EPHALL"))
+    if (!(Raw->copt.flag&COPT_EPHALL))
     {
         if (eph.iode == Raw->nav.eph[sat-1].iode)
             return 0; /* unchanged */
@@ -1529,7 +1529,7 @@ static int DecodeQZSSEphemeris(raw_t *Raw)
     eph.toe   = gpst2time(eph.week, toe);
     eph.ttr   = gpst2time(eph.week, tow);
     tracet(3, "RT17: DecodeQZSSEphemeris(); SAT=%d, IODC=%d, IODE=%d, WEEK=%d.\n", sat, eph.iodc, eph.iode, eph.week);
-    if (!strstr(Raw->opt,"-EPHALL"))
+    if (!(Raw->copt.flag&COPT_EPHALL))
     {
         if (eph.iode == Raw->nav.eph[sat-1].iode)
             return 0; /* unchanged */
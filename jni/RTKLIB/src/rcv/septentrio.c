@@ -122,7 +122,7 @@ static uint8_t sig_tbl[SBF_MAXSIG+1][2]={ /* system, obs-code */
     {SYS_IRN, CODE_L9A}  /* 36: IRN S */
 };
 /* signal number to freq-index and code --------------------------------------*/
-static int sig2idx(int sat, int sig, const char *opt, uint8_t *code)
+static int sig2idx(int sat, int sig, const copt_t *copt, uint8_t *code)
 {
     int idx,sys=satsys(sat,NULL),nex=NEXOBS;
     
@@ -132,27 +132,27 @@ static int sig2idx(int sat, int sig, const char *opt, uint8_t *code)
     
     /* resolve code priority in a freq-index */
     if (sys==SYS_GPS) {
-        if (strstr(opt,"-GL1W")&&idx==0) return (*code==CODE_L1W)?0:-1;
-        if (strstr(opt,"-GL1L")&&idx==0) return (*code==CODE_L1L)?0:-1;
-        if (strstr(opt,"-GL2L")&&idx==1) return (*code==CODE_L2L)?1:-1;
+        if (testsigopt(copt,sys,"1W")&&idx==0) return (*code==CODE_L1W)?0:-1;
+        if (testsigopt(copt,sys,"1L")&&idx==0) return (*code==CODE_L1L)?0:-1;
+        if (testsigopt(copt,sys,"2L")&&idx==1) return (*code==CODE_L2L)?1:-1;
         if (*code==CODE_L1W) return (nex<1)?-1:NFREQ;
         if (*code==CODE_L2L) return (nex<2)?-1:NFREQ+1;
         if (*code==CODE_L1L) return (nex<3)?-1:NFREQ+2;
     }
     else if (sys==SYS_GLO) {
-        if (strstr(opt,"-RL1P")&&idx==0) return (*code==CODE_L1P)?0:-1;
-        if (strstr(opt,"-RL2C")&&idx==1) return (*code==CODE_L2C)?1:-1;
+        if (testsigopt(copt,sys,"1P")&&idx==0) return (*code==CODE_L1P)?0:-1;
+        if (testsigopt(copt,sys,"2C")&&idx==1) return (*code==CODE_L2C)?1:-1;
         if (*code==CODE_L1P) return (nex<1)?-1:NFREQ;
         if (*code==CODE_L2C) return (nex<2)?-1:NFREQ+1;
     }
     else if (sys==SYS_QZS) {
-        if (strstr(opt,"-JL1L")&&idx==0) return (*code==CODE_L1L)?0:-1;
-        if (strstr(opt,"-JL1Z")&&idx==0) return (*code==CODE_L1Z)?0:-1;
+        if (testsigopt(copt,sys,"1L")&&idx==0) return (*code==CODE_L1L)?0:-1;
+        if (testsigopt(copt,sys,"1Z")&&idx==0) return (*code==CODE_L1Z)?0:-1;
         if (*code==CODE_L1L) return (nex<1)?-1:NFREQ;
         if (*code==CODE_L1Z) return (nex<2)?-1:NFREQ+1;
     }
     else if (sys==SYS_CMP) {
-        if (strstr(opt,"-CL1P")&&idx==0) return (*code==CODE_L1P)?0:-1;
+        if (testsigopt(copt,sys,"1P")&&idx==0) return (*code==CODE_L1P)?0:-1;
         if (*code==CODE_L1P) return (nex<1)?-1:NFREQ;
     }
     return (idx<NFREQ)?idx:-1;
@@ -181,8 +181,8 @@ static int decode_measepoch(raw_t *raw)
     int i,j,idx,n,n1,n2,len1,len2,sig,ant,svid,info,sat,sys,lock,fcn,LLI;
     int ant_sel=0; /* antenna selection (0:main) */
     
-    if      (strstr(raw->opt,"-AUX1")) ant_sel=1;
-    else if (strstr(raw->opt,"-AUX2")) ant_sel=2;
+    if      (raw->copt.flag&COPT_AUX1) ant_sel=1;
+    else if (raw->copt.flag&COPT_AUX2) ant_sel=2;
     
     if (raw->len<20) {
         trace(2,"sbf measepoch length error: len=%d\n",raw->len);
@@ -219,7 +219,7 @@ static int decode_measepoch(raw_t *raw)
             p+=len1+len2*n2;
             continue;
         }
-        if ((idx=sig2idx(sat,sig,raw->opt,&code))<0) {
+        if ((idx=sig2idx(sat,sig,&raw->copt,&code))<0) {
             trace(2,"sbf measepoch sig error: sat=%d sig=%d\n",sat,sig);
             p+=len1+len2*n2;
             continue;
@@ -261,7 +261,7 @@ static int decode_measepoch(raw_t *raw)
                 trace(3,"sbf measepoch ant error: sat=%d ant=%d\n",sat,ant);
                 continue;
             }
-            if ((idx=sig2idx(sat,sig,raw->opt,&code))<0) {
+            if ((idx=sig2idx(sat,sig,&raw->copt,&code))<0) {
                 trace(3,"sbf measepoch sig error: sat=%d sig=%d\n",sat,sig);
                 continue;
             }
@@ -311,7 +311,7 @@ static int decode_eph(raw_t *raw, int sat)
     
     if (!decode_frame(raw->subfrm[sat-1],&eph,NULL,NULL,NULL)) return 0;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode&&
             eph.iodc==raw->nav.eph[sat-1].iodc&&
             timediff(eph.toe,raw->nav.eph[sat-1].toe)==0.0&&
@@ -455,7 +455,7 @@ static int decode_glorawca(raw_t *raw)
     }
     geph.frq=(int)U1(p+4)-8;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (geph.iode==raw->nav.geph[prn-1].iode&&
             timediff(geph.toe,raw->nav.geph[prn-1].toe)==0.0) return 0;
     }
@@ -472,7 +472,7 @@ static int decode_galrawfnav(raw_t *raw)
     uint8_t *p=raw->buff+14,buff[32];
     int i,svid,src,sat,prn,type;
     
-    if (strstr(raw->opt,"-GALINAV")) return 0;
+    if (raw->copt.flag&COPT_GALINAV) return 0;
     
     if (raw->len<52) {
         trace(2,"sbf galrawfnav length error: len=%d\n",raw->len);
@@ -522,7 +522,7 @@ static int decode_galrawfnav(raw_t *raw)
     matcpy(raw->nav.ion_gal,ion,4,1);
     matcpy(raw->nav.utc_gal,utc,8,1);
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1+MAXSAT].iode&&
             timediff(eph.toe,raw->nav.eph[sat-1+MAXSAT].toe)==0.0&&
             timediff(eph.toc,raw->nav.eph[sat-1+MAXSAT].toc)==0.0) return 0;
@@ -540,7 +540,7 @@ static int decode_galrawinav(raw_t *raw)
     uint8_t *p=raw->buff+14,buff[32],type,part1,part2,page1,page2;
     int i,j,svid,src,sat,prn;
     
-    if (strstr(raw->opt,"-GALFNAV")) return 0;
+    if (raw->copt.flag&COPT_GALFNAV) return 0;
     
     if (raw->len<52) {
         trace(2,"sbf galrawinav length error: len=%d\n",raw->len);
@@ -603,7 +603,7 @@ static int decode_galrawinav(raw_t *raw)
     matcpy(raw->nav.ion_gal,ion,4,1);
     matcpy(raw->nav.utc_gal,utc,8,1);
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode&&
             timediff(eph.toe,raw->nav.eph[sat-1].toe)==0.0&&
             timediff(eph.toc,raw->nav.eph[sat-1].toc)==0.0) return 0;
@@ -707,7 +707,7 @@ static int decode_bdsraw(raw_t *raw)
         }
         else return 0;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (timediff(eph.toe,raw->nav.eph[sat-1].toe)==0.0) return 0;
     }
     eph.sat=sat;
@@ -755,7 +755,7 @@ static int decode_navicraw(raw_t *raw)
     if (id==1) { /* subframe 2 */
         if (!decode_irn_nav(raw->subfrm[sat-1],&eph,NULL,NULL)) return 0;
         
-        if (!strstr(raw->opt,"-EPHALL")) {
+        if (!(raw->copt.flag&COPT_EPHALL)) {
             if (eph.iode==raw->nav.eph[sat-1].iode&&
                 timediff(eph.toe,raw->nav.eph[sat-1].toe)==0.0) {
                 return 0;
@@ -280,7 +280,7 @@ static int decode_stqraw(raw_t *raw)
             raw->lockt[sat-1][0]=0;
         }
         /* receiver dependent options */
-        if (strstr(raw->opt,"-INVCP")) {
+        if (raw->copt.flag&COPT_INVCP) {
             raw->obs.data[n].L[0]*=-1.0;
         }
         raw->obs.data[n].time=raw->time;
@@ -369,7 +369,7 @@ static int decode_stqrawx(raw_t *raw)
             raw->lockt[sat-1][idx]=0;
         }
         /* receiver dependent options */
-        if (strstr(raw->opt,"-INVCP")) {
+        if (raw->copt.flag&COPT_INVCP) {
             raw->obs.data[n].L[idx]*=-1.0;
         }
         raw->obs.data[n].time=raw->time;
@@ -451,7 +451,7 @@ static int decode_stqgene(raw_t *raw)
     matcpy(raw->nav.ion_gal,ion,4,1);
     matcpy(raw->nav.utc_gal,utc,8,1);
 
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode&&
             timediff(eph.toe,raw->nav.eph[sat-1].toe)==0.0&&
             timediff(eph.toc,raw->nav.eph[sat-1].toc)==0.0) return 0;
@@ -496,7 +496,7 @@ static int decode_ephem(int sat, raw_t *raw)
     
     if (!decode_frame(raw->subfrm[sat-1],&eph,NULL,NULL,NULL)) return 0;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode&&
             eph.iodc==raw->nav.eph[sat-1].iodc) return 0; /* unchanged */
     }
@@ -605,7 +605,7 @@ static int decode_stqglo(raw_t *raw)
     geph.tof=raw->time;
     if (!decode_glostr(raw->subfrm[sat-1],&geph,NULL)||geph.sat!=sat) return 0;
 
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (geph.iode==raw->nav.geph[prn-1].iode) return 0; /* unchanged */
     }
     /* keep freq channel number */
@@ -694,7 +694,7 @@ static int decode_stqbds(raw_t *raw)
         if (pgn!=10) return 0;
         if (!decode_bds_d2(raw->subfrm[sat-1],&eph,NULL)) return 0;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (timediff(eph.toe,raw->nav.eph[sat-1].toe)==0.0) return 0; /* unchanged */
     }
     eph.sat=sat;
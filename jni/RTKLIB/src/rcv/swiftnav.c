@@ -272,8 +272,6 @@ static const uint8_t decoding_table[256] = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00};
 
-static uint8_t puPayloadTmp[256];
-
 static const gtime_t time0 = {0};
 
 static int Base64_Decode(uint8_t *_pcData,
@@ -495,11 +493,11 @@ static int decode_msgobs(raw_t *raw) {
     band_code = p[16];
 
     /* Check for RAIM exclusion */
-    if ((flags & 0x80) && (NULL == strstr(raw->opt, "OBSALL"))) {
+    if ((flags & 0x80) && !(raw->copt.flag & COPT_OBSALL)) {
       continue;
     }
 
-    if (strstr(raw->opt, "ANT_AUX")) {
+    if (raw->copt.flag & COPT_ANT_AUX) {
       if (!aux_antenna(band_code)) continue;
     } else {
       if (aux_antenna(band_code)) continue;
@@ -774,7 +772,7 @@ static int decode_gpsnav_dep_e(raw_t *raw) {
     eph.ttr = raw->time;
   }
 
-  if (!strstr(raw->opt, "EPHALL")) {
+  if (!(raw->copt.flag & COPT_EPHALL)) {
     if ((eph.iode == raw->nav.eph[sat - 1].iode) &&
         (eph.iodc == raw->nav.eph[sat - 1].iodc)) {
       trace(3,
@@ -835,7 +833,7 @@ static int decode_gpsnav_dep_f(raw_t *raw) {
   eph.ttr = raw->time;
   }
 
-  if (!strstr(raw->opt, "EPHALL")) {
+  if (!(raw->copt.flag & COPT_EPHALL)) {
     if ((eph.iode == raw->nav.eph[sat - 1].iode) &&
         (eph.iodc == raw->nav.eph[sat - 1].iodc)) {
       return 0;
@@ -890,7 +888,7 @@ static int decode_gpsnav(raw_t *raw) {
     eph.ttr = raw->time;
   }
 
-  if (!strstr(raw->opt, "EPHALL")) {
+  if (!(raw->copt.flag & COPT_EPHALL)) {
     if ((eph.iode == raw->nav.eph[sat - 1].iode) &&
         (eph.iodc == raw->nav.eph[sat - 1].iodc)) {
       trace(3,
@@ -953,7 +951,7 @@ static int decode_qzssnav(raw_t *raw) {
   eph.ttr = raw->time;
   }
 
-  if (!strstr(raw->opt, "EPHALL")) {
+  if (!(raw->copt.flag & COPT_EPHALL)) {
     if ((eph.iode == raw->nav.eph[sat - 1].iode) &&
         (eph.iodc == raw->nav.eph[sat - 1].iodc)) {
       trace(3,
@@ -1012,7 +1010,7 @@ static int decode_bdsnav(raw_t *raw) {
 
   eph.ttr = raw->time;
 
-  if (!strstr(raw->opt, "EPHALL")) {
+  if (!(raw->copt.flag & COPT_EPHALL)) {
     if ((eph.iode == raw->nav.eph[sat - 1].iode) &&
         (eph.iodc == raw->nav.eph[sat - 1].iodc)) {
       return 0;
@@ -1064,7 +1062,7 @@ static int decode_galnav_dep_a(raw_t *raw) {
 
   eph.ttr = raw->time;
 
-  if (!strstr(raw->opt, "EPHALL")) {
+  if (!(raw->copt.flag & COPT_EPHALL)) {
     if ((eph.iode == raw->nav.eph[sat - 1].iode) &&
         (eph.iodc == raw->nav.eph[sat - 1].iodc)) {
       return 0;
@@ -1116,7 +1114,7 @@ static int decode_galnav(raw_t *raw) {
 
   eph.ttr = raw->time;
 
-  if (!strstr(raw->opt, "EPHALL")) {
+  if (!(raw->copt.flag & COPT_EPHALL)) {
     if ((eph.iode == raw->nav.eph[sat - 1].iode) &&
         (eph.iodc == raw->nav.eph[sat - 1].iodc)) {
       return 0;
@@ -1195,7 +1193,7 @@ static int decode_glonav_dep_d(raw_t *raw) {
 
   geph.frq = (int)puiTmp[118] - 8;
 
-  if (!strstr(raw->opt, "EPHALL")) {
+  if (!(raw->copt.flag & COPT_EPHALL)) {
     if (geph.iode == raw->nav.geph[prn - 1].iode) return 0; /* unchanged */
   }
 
@@ -1269,7 +1267,7 @@ static int decode_glonav(raw_t *raw) {
 
   geph.frq = (int)puiTmp[90] - 8;
 
-  if (!strstr(raw->opt, "EPHALL")) {
+  if (!(raw->copt.flag & COPT_EPHALL)) {
     if (geph.iode == raw->nav.geph[prn - 1].iode) return 0; /* unchanged */
   }
 
@@ -1357,8 +1355,8 @@ static int decode_sbp(raw_t *raw) {
   int type = U2(raw->buff + 1);
   int sender = U2(raw->buff + 3);
 
-  if ((sender == 0) && (NULL == strstr(raw->opt, "CONVBASE"))) return 0;
-  if ((sender != 0) && (NULL != strstr(raw->opt, "CONVBASE"))) return 0;
+  if ((sender == 0) && !(raw->copt.flag & COPT_CONVBASE)) return 0;
+  if ((sender != 0) && (raw->copt.flag & COPT_CONVBASE)) return 0;
 
   trace(3, "decode_sbp: type=%04x len=%d\n", type, raw->len);
 
@@ -1518,7 +1516,7 @@ extern int input_sbpjsonf(raw_t *raw, FILE *fp) {
   const char JSON_SENDER_FIELD[] = "\"sender\":";
   const char JSON_PAYLOAD_FIELD[] = "\"payload\":";
   const char JSON_CRC_FIELD[] = "\"crc\":";
-  uint8_t *pcPayloadBeg, *pcPayloadEnd;
+  uint8_t puPayloadTmp[256], *pcPayloadBeg, *pcPayloadEnd;
   int stat, iRet;
   uint32_t uPayloadSize, uMsgType, uSender, uMsgCrc, uLength;
   char *pcTmp;
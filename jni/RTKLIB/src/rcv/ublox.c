@@ -280,7 +280,6 @@ static int decode_rxmraw(raw_t *raw)
     gtime_t time;
     double tow,tt,tadj=0.0,toff=0.0,tn;
     int i,j,prn,sat,n=0,nsat,week;
-    char *q;
     
     trace(4,"decode_rxmraw: len=%d\n",raw->len);
     
@@ -288,9 +287,7 @@ static int decode_rxmraw(raw_t *raw)
         sprintf(raw->msgtype,"UBX RXM-RAW   (%4d): nsat=%d",raw->len,U1(p+6));
     }
     /* time tag adjustment option (-TADJ) */
-    if ((q=strstr(raw->opt,"-TADJ="))) {
-        sscanf(q,"-TADJ=%lf",&tadj);
-    }
+    if (raw->copt.flag&COPT_TADJ) tadj=raw->copt.tadj;
     nsat=U1(p+6);
     if (raw->len<12+24*nsat) {
         trace(2,"ubx rxmraw length error: len=%d nsat=%d\n",raw->len,nsat);
@@ -323,7 +320,7 @@ static int decode_rxmraw(raw_t *raw)
         raw->obs.data[n].code[0]=CODE_L1C;
         
         /* phase polarity flip option (-INVCP) */
-        if (strstr(raw->opt,"-INVCP")) {
+        if (raw->copt.flag&COPT_INVCP) {
             raw->obs.data[n].L[0]=-raw->obs.data[n].L[0];
         }
         if (!(sat=satno(MINPRNSBS<=prn?SYS_SBS:SYS_GPS,prn))) {
@@ -354,7 +351,7 @@ static int decode_rxmrawx(raw_t *raw)
 {
     uint8_t *p=raw->buff+6;
     gtime_t time;
-    char *q,tstr[64];
+    char tstr[64];
     double tow,P,L,D,tn,tadj=0.0,toff=0.0;
     int i,j,k,idx,sys,prn,sat,code,slip,halfv,halfc,LLI,n=0,cpstd_valid,cpstd_slip;
     int week,nmeas,ver,gnss,svid,sigid,frqid,lockt,cn0,cpstd,prstd,tstat;
@@ -387,22 +384,17 @@ static int decode_rxmrawx(raw_t *raw)
                 raw->len,tstr,nmeas,ver);
     }
     /* time tag adjustment option (-TADJ) */
-    if ((q=strstr(raw->opt,"-TADJ="))) {
-        sscanf(q,"-TADJ=%lf",&tadj);
-    }
+    if (raw->copt.flag&COPT_TADJ) tadj=raw->copt.tadj;
     /* max valid std-dev of carrier-phase (-MAX_STD_CP) */
-    if ((q=strstr(raw->opt,"-MAX_STD_CP="))) {
-        sscanf(q,"-MAX_STD_CP=%d",&cpstd_valid);
-    } 
+    if (raw->copt.flag&COPT_MAXSTDCP) cpstd_valid=raw->copt.maxstdcp;
     else if (ver>=1) cpstd_valid=MAX_CPSTD_VALID_GEN9;  /* F9P */
     else cpstd_valid=MAX_CPSTD_VALID_GEN8;  /* M8T, M8P */
 
     /* slip threshold of std-dev of carrier-phase (-STD_SLIP) */
-    if ((q=strstr(raw->opt,"-STD_SLIP="))) {
-        sscanf(q,"-STD_SLIP=%d",&cpstd_slip);
-    } else cpstd_slip=CPSTD_SLIP;
+    if (raw->copt.flag&COPT_STDSLIP) cpstd_slip=raw->copt.stdslip;
+    else cpstd_slip=CPSTD_SLIP;
     /* use multiple codes for each freq (-MULTICODE) */
-    if ((q=strstr(raw->opt,"-MULTICODE"))) multicode=1;
+    if (raw->copt.flag&COPT_MULTICODE) multicode=1;
 
     /* time tag adjustment */
     if (tadj>0.0) {
@@ -559,7 +551,6 @@ static int decode_trkmeas(raw_t *raw)
     gtime_t time;
     double ts,tr=-1.0,t,tau,utc_gpst,snr,adr,dop;
     int i,j,n=0,nch,sys,prn,sat,qi,frq,flag,lock1,lock2,week,fw=0;
-    char *q;
     /* adjustment to code measurement in meters, based on GLONASS freq,
        values based on difference between TRK_MEAS values and  RXM-RAWX values */
     const char P_adj_fw2[]={ 0, 0, 0, 0, 1, 3, 2, 0,-4,-3,-9,-8,-7,-4, 0};  /* fw 2.30 */
@@ -573,9 +564,7 @@ static int decode_trkmeas(raw_t *raw)
     if (!raw->time.time) return 0;
 
     /* trk meas code adjust (-TRKM_ADJ) */
-    if ((q=strstr(raw->opt,"-TRKM_ADJ="))) {
-        sscanf(q,"-TRKM_ADJ=%d",&fw);
-    }
+    if (raw->copt.flag&COPT_TRKMADJ) fw=raw->copt.trkmadj;
     
     /* number of channels */
     nch=U1(p+2);
@@ -822,7 +811,7 @@ static int decode_eph(raw_t *raw, int sat)
     
     if (!decode_frame(raw->subfrm[sat-1],&eph,NULL,NULL,NULL)) return 0;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode&&
             eph.iodc==raw->nav.eph[sat-1].iodc&&
             timediff(eph.toe,raw->nav.eph[sat-1].toe)==0.0&&
@@ -946,7 +935,7 @@ static int decode_enav(raw_t *raw, int sat, int off)
     matcpy(raw->nav.ion_gal,ion,4,1);
     matcpy(raw->nav.utc_gal,utc,8,1);
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (eph.iode==raw->nav.eph[sat-1].iode&&
             timediff(eph.toe,raw->nav.eph[sat-1].toe)==0.0&&
             timediff(eph.toc,raw->nav.eph[sat-1].toc)==0.0) return 0;
@@ -1008,7 +997,7 @@ static int decode_cnav(raw_t *raw, int sat, int off)
         }
         else return 0;
     }
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
         if (timediff(eph.toe,raw->nav.eph[sat-1].toe)==0.0) return 0;
     }
     eph.sat=sat;
@@ -1060,7 +1049,7 @@ static int decode_gnav(raw_t *raw, int sat, int off, int frq)
         }
     geph.frq=frq-7;
     
-    if (!strstr(raw->opt,"-EPHALL")) {
+    if (!(raw->copt.flag&COPT_EPHALL)) {
             if (geph.iode==raw->nav.geph[prn-1].iode) return 0;
     }
     raw->nav.geph[prn-1]=geph;
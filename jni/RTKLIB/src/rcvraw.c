@@ -1326,6 +1326,7 @@ extern int init_raw(raw_t *raw, int format)
     raw->tod=-1;
     for (i=0;i<MAXRAWLEN;i++) raw->buff[i]=0;
     raw->opt[0]='\0';
+    compopt(raw->opt,&raw->copt);
     raw->format=-1;
     
     raw->obs.data =NULL;
@@ -1357,6 +1358,7 @@ extern int init_raw(raw_t *raw, int format)
     for (i=0;i<MAXSAT   ;i++) raw->nav.alm  [i]=alm0;
     for (i=0;i<NSATGLO  ;i++) raw->nav.geph [i]=geph0;
     for (i=0;i<NSATSBS*2;i++) raw->nav.seph [i]=seph0;
+    for (i=0;i<32       ;i++) raw->nav.glo_frq[i]=0;
     raw->sta.name[0]=raw->sta.marker[0]='\0';
     raw->sta.antdes[0]=raw->sta.antsno[0]='\0';
     raw->sta.rectype[0]=raw->sta.recver[0]=raw->sta.recsno[0]='\0';
@@ -1407,6 +1409,8 @@ extern void free_raw(raw_t *raw)
 * return : status (-1: error message, 0: no message, 1: input observation data,
 *                  2: input ephemeris, 3: input sbas message,
 *                  9: input ion/utc parameter)
+* notes  : receiver dependent options are compiled by compopt() into raw->copt.
+*          call compopt(raw->opt,&raw->copt) after changing raw->opt
 *-----------------------------------------------------------------------------*/
 extern int input_raw(raw_t *raw, int format, uint8_t data)
 {
@@ -130,6 +130,20 @@
 #define MINFREQ_GLO -7                  /* min frequency number GLONASS */
 #define MAXFREQ_GLO 13                  /* max frequency number GLONASS */
 #define NINCOBS     262144              /* incremental number of obs data */
+#define MINMTCHUNK  1048576             /* min chunk size of parallel obs read */
+#define NINCSTREAM  16777216            /* incremental size of stream buffer */
+#define MAXMTTHREAD 16                  /* max threads of parallel obs read */
+#define NAVHNONE    -1E300              /* nav header parameter not set */
+
+#define CACHE_STAT  1                   /* cache section: status and type */
+#define CACHE_STA   2                   /* cache section: station parameters */
+#define CACHE_NAVH  3                   /* cache section: nav header params */
+#define CACHE_EPH   4                   /* cache section: GPS/QZS/GAL/BDS eph */
+#define CACHE_GEPH  5                   /* cache section: GLONASS ephemeris */
+#define CACHE_SEPH  6                   /* cache section: SBAS ephemeris */
+#define CACHE_PCLK  7                   /* cache section: precise clock */
+#define CACHE_OBS   8                   /* cache section: obs data records */
+#define CACHE_OBSC  9                   /* cache section: compact obs data */
 
 static const int navsys[]={             /* satellite systems */
     SYS_GPS,SYS_GLO,SYS_GAL,SYS_QZS,SYS_SBS,SYS_CMP,SYS_IRN,0
@@ -157,6 +171,29 @@ typedef struct {                        /* signal index type */
     double shift[MAXOBSTYPE];           /* phase shift (cycle) */
 } sigind_t;
 
+typedef struct {                        /* obs body chunk for parallel read */
+    const char *p,*end;                 /* chunk text in mapped file */
+    double ver;                         /* RINEX version */
+    int tsys,mask,rcv;                  /* time system, system mask, receiver */
+    gtime_t ts,te;                      /* time start/end for screening */
+    double tint;                        /* time interval for screening */
+    const sigind_t *index;              /* signal index */
+    obsd_t *data;                       /* obs data records (pre-sized) */
+    int n,nmax;                         /* number of obs data/allocated */
+    obsd_t *buff;                       /* epoch buffer for compact obs data */
+    obsc_t obsc;                        /* compact obs data */
+    uint8_t slips[MAXSAT][NFREQ+NEXOBS]; /* slips pending at end of chunk */
+    int stat;                           /* status (1:ok,0:unsupported record) */
+} obschunk_t;
+
+typedef struct {                        /* nav header parameters type */
+    double utc_gps[8],utc_glo[8],utc_gal[8],utc_qzs[8],utc_cmp[8],utc_irn[9];
+    double utc_sbs[4];                  /* UTC parameters */
+    double ion_gps[8],ion_gal[4],ion_qzs[8],ion_cmp[8],ion_irn[8];
+                                        /* iono model parameters */
+    int glo_fcn[32];                    /* GLONASS FCN + 8 */
+} navh_t;
+
 /* set string without tail space ---------------------------------------------*/
 static void setstr(char *dst, const char *src, int n)
 {
@@ -762,9 +799,9 @@ static int decode_obsepoch(FILE *fp, char *buff, double ver, gtime_t *time,
 }
 /* decode observation data ---------------------------------------------------*/
 static int decode_obsdata(FILE *fp, char *buff, double ver, int mask,
-                          sigind_t *index, obsd_t *obs)
+                          const sigind_t *index, obsd_t *obs)
 {
-    sigind_t *ind;
+    const sigind_t *ind;
     double val[MAXOBSTYPE]={0};
     uint8_t lli[MAXOBSTYPE]={0};
     uint8_t qual[MAXOBSTYPE]={0};
@@ -1074,22 +1111,391 @@ static int readrnxobsb(FILE *fp, const char *opt, double ver, int *tsys,
     }
     return -1;
 }
+/* read line from memory -----------------------------------------------------*/
+static int memgets(char *buff, int size, const char **p, const char *end)
+{
+    const char *q;
+    int n;
+    
+    if (*p>=end) return 0;
+    n=end-*p<size-1?(int)(end-*p):size-1;
+    if ((q=(const char *)memchr(*p,'\n',n))) n=(int)(q-*p)+1;
+    memcpy(buff,*p,n);
+    buff[n]='\0';
+    *p+=n;
+    return 1;
+}
+/* sort observation data in an epoch by satellite ----------------------------*/
+static void sortepoch(obsd_t *data, int n)
+{
+    obsd_t tmp;
+    int i,j;
+    
+    for (i=1;i<n;i++) {
+        if (data[i-1].sat<=data[i].sat) continue;
+        tmp=data[i];
+        for (j=i;j>0&&data[j-1].sat>tmp.sat;j--) data[j]=data[j-1];
+        data[j]=tmp;
+    }
+}
+/* read RINEX 3 observation data body in a chunk -----------------------------*/
+static void readrnxobs_chunk(obschunk_t *c)
+{
+    gtime_t time={0};
+    obsd_t *data,data0={{0}};
+    char buff[MAXRNXLEN];
+    const char *p=c->p;
+    int i,n,nsat,flag=0,sats[MAXOBS];
+    
+    c->n=0; c->stat=1;
+    
+    while (memgets(buff,MAXRNXLEN,&p,c->end)) {
+        
+        /* decode observation epoch */
+        nsat=decode_obsepoch(NULL,buff,c->ver,&time,&flag,sats);
+        
+        /* event or header records need sequential read */
+        if (flag==5||((flag==3||flag==4)&&nsat>0)) {
+            c->stat=0;
+            return;
+        }
+        if (nsat<=0) continue;
+        
+        data=c->buff?c->buff:c->data+c->n;
+        
+        for (i=n=0;i<nsat;i++) {
+            if (!memgets(buff,MAXRNXLEN,&p,c->end)) return; /* partial epoch */
+            
+            if ((flag<=2||flag==6)&&n<MAXOBS&&(c->buff||c->n+n<c->nmax)) {
+                data[n]=data0;
+                data[n].time=time;
+                
+                /* decode RINEX observation data */
+                if (decode_obsdata(NULL,buff,c->ver,c->mask,c->index,data+n)) {
+                    n++;
+                }
+            }
+        }
+        for (i=0;i<n;i++) {
+            
+            /* UTC -> GPST */
+            if (c->tsys==TSYS_UTC) data[i].time=utc2gpst(data[i].time);
+            
+            /* save cycle slip */
+            saveslips(c->slips,data+i);
+        }
+        /* screen data by time */
+        if (n>0&&!screent(data[0].time,c->ts,c->te,c->tint)) continue;
+        
+        for (i=0;i<n;i++) {
+            
+            /* restore cycle slip */
+            restslips(c->slips,data+i);
+            
+            data[i].rcv=(uint8_t)c->rcv;
+        }
+        sortepoch(data,n);
+        
+        if (!c->buff) {
+            c->n+=n;
+        }
+        else if (addobsc(&c->obsc,data,n)<0) {
+            c->stat=-1;
+            return;
+        }
+    }
+}
+/* parallel obs read thread --------------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI obschunkthread(void *arg)
+#else
+static void *obschunkthread(void *arg)
+#endif
+{
+    readrnxobs_chunk((obschunk_t *)arg);
+    return 0;
+}
+/* concatenate compact obs data of chunks ------------------------------------*/
+static int catobsc_mt(obschunk_t *chunk, int nt, obsc_t *obsc, int *stat)
+{
+    obsc_t *c;
+    uint8_t slips[MAXSAT][NFREQ+NEXOBS]={{0}};
+    int i,j,k,l,n=obsc->n,sat;
+    
+    *stat=1;
+    
+    for (i=0;i<nt;i++) {
+        c=&chunk[i].obsc;
+        
+        /* carry cycle slips over chunk boundaries (slips of signals without
+           any observable are not stored as in the sequential read) */
+        for (j=0;j<c->n;j++) {
+            sat=c->sat[j];
+            for (k=c->isig[j];k<c->isig[j+1];k++) {
+                if (slips[sat-1][c->slot[k]]&1) c->LLI[k]|=LLI_SLIP;
+            }
+            for (l=0;l<NFREQ+NEXOBS;l++) slips[sat-1][l]=0;
+        }
+        for (j=0;j<MAXSAT;j++) for (k=0;k<NFREQ+NEXOBS;k++) {
+            slips[j][k]|=chunk[i].slips[j][k];
+        }
+        if (*stat>=0&&catobsc(obsc,c)<0) *stat=-1;
+        freeobsc(c);
+    }
+    if (*stat>0&&obsc->n<=n) *stat=0;
+    
+    trace(3,"readrnxobs_mt: nthread=%d nobs=%d\n",nt,obsc->n);
+    
+    free(chunk);
+    return 1;
+}
+/* read RINEX 3 observation data by parallel read in memory ------------------
+* split the body in memory (memory-mapped file or uncompressed stream) at epoch
+* records and decode chunks in parallel into pre-sized slices of obs data
+* concatenated in time order. return 0 without any change to obs if the body
+* can not be read in this way (event/header records in body) to fallback to
+* sequential read. for compact obs data, each chunk is packed to its own
+* compact obs data and appended in time order.
+*-----------------------------------------------------------------------------*/
+static int readrnxobs_mt(const char *buff, size_t size, long offset,
+                         gtime_t ts, gtime_t te, double tint, const char *opt,
+                         int rcv, double ver, int tsys,
+                         char tobs[][MAXOBSTYPE][4], obs_t *obs, obsc_t *obsc,
+                         int *stat)
+{
+    obschunk_t *chunk;
+    obsd_t *obs_data;
+    sigind_t index[NUMSYS]={{0}};
+    thread_t thread[MAXMTTHREAD];
+    uint8_t slips[MAXSAT][NFREQ+NEXOBS]={{0}};
+    const char *p,*q,*end;
+    int i,j,k,n,nt,nmax=0,ok=1,run[MAXMTTHREAD]={0};
+    
+    if (offset<0||(size_t)offset>=size) return 0;
+    
+    p=buff+offset; end=buff+size;
+    
+    nt=(int)((end-p)/MINMTCHUNK);
+    if (nt>(n=getncpu())) nt=n;
+    if (nt>MAXMTTHREAD) nt=MAXMTTHREAD;
+    if (nt<1) nt=1;
+    
+    if (!(chunk=(obschunk_t *)calloc(nt,sizeof(obschunk_t)))) return 0;
+    /* set signal index */
+    set_index(ver,SYS_GPS,opt,tobs[0],index  );
+    set_index(ver,SYS_GLO,opt,tobs[1],index+1);
+    set_index(ver,SYS_GAL,opt,tobs[2],index+2);
+    set_index(ver,SYS_QZS,opt,tobs[3],index+3);
+    set_index(ver,SYS_SBS,opt,tobs[4],index+4);
+    set_index(ver,SYS_CMP,opt,tobs[5],index+5);
+    set_index(ver,SYS_IRN,opt,tobs[6],index+6);
+    
+    /* split body at epoch records */
+    for (i=n=0;i<nt;i++) {
+        if (i<nt-1) {
+            for (q=p+(end-p)/(nt-i);q<end;q++) {
+                if (!(q=(const char *)memchr(q,'\n',end-q))) {q=end; break;}
+                if (q+1<end&&q[1]=='>') {q++; break;}
+            }
+        }
+        else q=end;
+        if (q<=p) continue;
+        
+        chunk[n].p=p; chunk[n].end=p=q;
+        chunk[n].ver=ver; chunk[n].tsys=tsys; chunk[n].mask=set_sysmask(opt);
+        chunk[n].rcv=rcv; chunk[n].ts=ts; chunk[n].te=te; chunk[n].tint=tint;
+        chunk[n].index=index;
+        
+        /* number of lines as upper bound of number of records */
+        for (q=chunk[n].p,k=0;q<chunk[n].end;q++,k++) {
+            if (!(q=(const char *)memchr(q,'\n',chunk[n].end-q))) break;
+        }
+        chunk[n].nmax=k+1;
+        nmax+=chunk[n++].nmax;
+    }
+    nt=n;
+    
+    /* allocate epoch buffers for compact obs data */
+    if (obsc) {
+        for (i=0;i<nt;i++) {
+            if ((chunk[i].buff=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) continue;
+            for (i--;i>=0;i--) free(chunk[i].buff);
+            free(chunk);
+            *stat=-1;
+            return 1;
+        }
+    }
+    /* allocate obs data and assign a slice to each chunk */
+    else if (obs->nmax<obs->n+nmax) {
+        if (!(obs_data=(obsd_t *)realloc(obs->data,sizeof(obsd_t)*(obs->n+nmax)))) {
+            trace(1,"readrnxobs_mt: malloc error n=%dx%d\n",sizeof(obsd_t),
+                  obs->n+nmax);
+            free(obs->data); obs->data=NULL; obs->n=obs->nmax=0;
+            free(chunk);
+            *stat=-1;
+            return 1;
+        }
+        obs->data=obs_data;
+        obs->nmax=obs->n+nmax;
+    }
+    for (i=0,k=obs?obs->n:0;i<nt&&!obsc;k+=chunk[i++].nmax) {
+        chunk[i].data=obs->data+k;
+    }
+    /* decode chunks in parallel */
+    for (i=1;i<nt;i++) {
+#ifdef WIN32
+        if (!(thread[i]=CreateThread(NULL,0,obschunkthread,chunk+i,0,NULL))) {
+#else
+        if (pthread_create(thread+i,NULL,obschunkthread,chunk+i)) {
+#endif
+            readrnxobs_chunk(chunk+i); /* decode in caller thread */
+            continue;
+        }
+        run[i]=1;
+    }
+    readrnxobs_chunk(chunk);
+    
+    for (i=1;i<nt;i++) {
+        if (!run[i]) continue;
+#ifdef WIN32
+        WaitForSingleObject(thread[i],INFINITE);
+        CloseHandle(thread[i]);
+#else
+        pthread_join(thread[i],NULL);
+#endif
+    }
+    for (i=0;i<nt;i++) {
+        free(chunk[i].buff);
+        if (chunk[i].stat<0) ok=-1;
+        else if (!chunk[i].stat&&ok>0) ok=0;
+    }
+    if (ok<=0) {
+        if (ok<0) trace(1,"readrnxobs_mt: malloc error\n");
+        else trace(3,"readrnxobs_mt: fallback to sequential read\n");
+        for (i=0;i<nt;i++) freeobsc(&chunk[i].obsc);
+        free(chunk);
+        if (ok<0) *stat=-1;
+        return ok<0;
+    }
+    if (obsc) {
+        return catobsc_mt(chunk,nt,obsc,stat);
+    }
+    /* concatenate chunks and carry cycle slips over chunk boundaries */
+    for (i=0,n=obs->n;i<nt;i++) {
+        for (j=0;j<chunk[i].n;j++) {
+            obs_data=chunk[i].data+j;
+            for (k=0;k<NFREQ+NEXOBS;k++) {
+                if (slips[obs_data->sat-1][k]&1) obs_data->LLI[k]|=LLI_SLIP;
+                slips[obs_data->sat-1][k]=0;
+            }
+        }
+        for (j=0;j<MAXSAT;j++) for (k=0;k<NFREQ+NEXOBS;k++) {
+            slips[j][k]|=chunk[i].slips[j][k];
+        }
+        if (chunk[i].data!=obs->data+n) {
+            memmove(obs->data+n,chunk[i].data,sizeof(obsd_t)*chunk[i].n);
+        }
+        n+=chunk[i].n;
+    }
+    *stat=n>obs->n?1:0;
+    obs->n=n;
+    
+    trace(3,"readrnxobs_mt: nthread=%d nobs=%d\n",nt,obs->n);
+    
+    /* shrink unused area */
+    if (obs->nmax-obs->n>NINCOBS&&
+        (obs_data=(obsd_t *)realloc(obs->data,sizeof(obsd_t)*obs->n))) {
+        obs->data=obs_data;
+        obs->nmax=obs->n;
+    }
+    free(chunk);
+    return 1;
+}
+/* read rest of stream to memory ---------------------------------------------*/
+static char *readstream(FILE *fp, size_t *size)
+{
+    char *buff=NULL,*p;
+    size_t n,nmax=0;
+    
+    *size=0;
+    do {
+        if (*size>=nmax) {
+            nmax=nmax?nmax*2:NINCSTREAM;
+            if (!(p=(char *)realloc(buff,nmax))) {
+                free(buff);
+                *size=0;
+                return NULL;
+            }
+            buff=p;
+        }
+        n=fread(buff+*size,1,nmax-*size,fp);
+        *size+=n;
+    } while (n>0);
+    
+    if (ferror(fp)||*size<=0) {
+        free(buff);
+        *size=0;
+        return NULL;
+    }
+    return buff;
+}
 /* read RINEX observation data -----------------------------------------------*/
-static int readrnxobs(FILE *fp, gtime_t ts, gtime_t te, double tint,
-                      const char *opt, int rcv, double ver, int *tsys,
-                      char tobs[][MAXOBSTYPE][4], obs_t *obs, sta_t *sta)
+static int readrnxobs(FILE *fp, const char *file, gtime_t ts, gtime_t te,
+                      double tint, const char *opt, int rcv, double ver,
+                      int *tsys, char tobs[][MAXOBSTYPE][4], obs_t *obs,
+                      obsc_t *obsc, sta_t *sta)
 {
     gtime_t eventime={0},time0={0},time1={0};
     obsd_t *data;
+    FILE *fpt=NULL;
     uint8_t slips[MAXSAT][NFREQ+NEXOBS]={{0}};
-    int i,n,n1=0,flag=0,stat=0;
+    char *buff=NULL;
+    size_t size=0;
+    long offset=0;
+    int i,n,n1=0,flag=0,stat=0,ret;
     double dtime1=0;
     
     trace(4,"readrnxobs: rcv=%d ver=%.2f tsys=%d\n",rcv,ver,*tsys);
     
-    if (!obs||rcv>MAXRCV) return 0;
+    if ((!obs&&!obsc)||rcv>MAXRCV) return 0;
     
-    if (!(data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) return 0;
+    /* parallel read of memory-mapped file or uncompressed stream in memory */
+    if (ver>2.99) {
+        if (file) {
+            buff=(char *)mapfile(file,&size);
+            offset=ftell(fp);
+        }
+        else if (!(buff=readstream(fp,&size))&&(ferror(fp)||!feof(fp))) {
+            trace(1,"readrnxobs: stream read error\n");
+            return -1;
+        }
+    }
+    if (buff) {
+        ret=readrnxobs_mt(buff,size,offset,ts,te,tint,opt,rcv,ver,*tsys,tobs,
+                          obs,obsc,&stat);
+        
+        /* spool stream to temporary file for sequential read */
+        if (!file&&!ret) {
+            if (!(fpt=tmpfile())||fwrite(buff,size,1,fpt)<1) {
+                trace(2,"rinex obs temporary file write error\n");
+                stat=-1; ret=1;
+            }
+            else {
+                rewind(fpt);
+                fp=fpt;
+            }
+        }
+        if (file) unmapfile(buff,size); else free(buff);
+        
+        if (ret) {
+            if (fpt) fclose(fpt);
+            return stat;
+        }
+    }
+    if (!(data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) {
+        if (fpt) fclose(fpt);
+        return 0;
+    }
     
     /* read RINEX observation data body */
     while ((n=readrnxobsb(fp,opt,ver,tsys,tobs,&flag,data,sta))>=0&&stat>=0) {
@@ -1101,11 +1507,13 @@ static int readrnxobs(FILE *fp, gtime_t ts, gtime_t te, double tint,
                 n = readrnxobsb(fp,opt,ver,tsys,tobs,&flag,data,sta);
         }
         
-        if (eventime.time==0 || obs->n-n1<=0 || timediff(eventime,time1)>=0) {
+        if (eventime.time==0 || (obsc?obsc->n:obs->n)-n1<=0 ||
+            timediff(eventime,time1)>=0) {
            for (i=0;i<n;i++) data[i].eventime = eventime;
         }  else {
            /* add event to previous epoch if delayed */
-            for (i=0;i<n1;i++) obs->data[obs->n-i-1].eventime = eventime;
+            if (obsc) obsc->eventime[obsc->ne-1]=eventime;
+            else for (i=0;i<n1;i++) obs->data[obs->n-i-1].eventime = eventime;
             for (i=0;i<n;i++) data[i].eventime=time0;
         }
         /* set to zero eventime for the next iteration */
@@ -1131,13 +1539,17 @@ static int readrnxobs(FILE *fp, gtime_t ts, gtime_t te, double tint,
             data[i].rcv=(uint8_t)rcv;
             
             /* save obs data */
-            if ((stat=addobsdata(obs,data+i))<0) break;
+            if (!obsc&&(stat=addobsdata(obs,data+i))<0) break;
         }
+        if (obsc&&n>0&&(stat=addobsc(obsc,data,n))<0) break;
+        if (stat<0) break;
+        
         n1=n;dtime1=timediff(data[0].time,time1);time1=data[0].time;
     }
-    trace(4,"readrnxobs: nobs=%d stat=%d\n",obs->n,stat);
+    trace(4,"readrnxobs: nobs=%d stat=%d\n",obsc?obsc->n:obs->n,stat);
     
     free(data);
+    if (fpt) fclose(fpt);
     
     return stat;
 }
@@ -1552,9 +1964,10 @@ static int readrnxclk(FILE *fp, const char *opt, int index, nav_t *nav)
     return nav->nc>0;
 }
 /* read RINEX file -----------------------------------------------------------*/
-static int readrnxfp(FILE *fp, gtime_t ts, gtime_t te, double tint,
-                     const char *opt, int flag, int index, char *type,
-                     obs_t *obs, nav_t *nav, sta_t *sta)
+static int readrnxfp(FILE *fp, const char *file, gtime_t ts, gtime_t te,
+                     double tint, const char *opt, int flag, int index,
+                     char *type, obs_t *obs, obsc_t *obsc, nav_t *nav,
+                     sta_t *sta)
 {
     double ver;
     int sys,tsys=TSYS_GPS;
@@ -1570,8 +1983,8 @@ static int readrnxfp(FILE *fp, gtime_t ts, gtime_t te, double tint,
     
     /* read RINEX file body */
     switch (*type) {
-        case 'O': return readrnxobs(fp,ts,te,tint,opt,index,ver,&tsys,tobs,obs,
-                                    sta);
+        case 'O': return readrnxobs(fp,file,ts,te,tint,opt,index,ver,&tsys,
+                                    tobs,obs,obsc,sta);
         case 'N': return readrnxnav(fp,opt,ver,sys    ,nav);
         case 'G': return readrnxnav(fp,opt,ver,SYS_GLO,nav);
         case 'H': return readrnxnav(fp,opt,ver,SYS_SBS,nav);
@@ -1585,9 +1998,10 @@ static int readrnxfp(FILE *fp, gtime_t ts, gtime_t te, double tint,
 /* uncompress and read RINEX file --------------------------------------------*/
 static int readrnxfile(const char *file, gtime_t ts, gtime_t te, double tint,
                        const char *opt, int flag, int index, char *type,
-                       obs_t *obs, nav_t *nav, sta_t *sta)
+                       obs_t *obs, obsc_t *obsc, nav_t *nav, sta_t *sta)
 {
     FILE *fp;
+    uncomp_t unc;
     int cstat,stat;
     char tmpfile[1024];
     
@@ -1595,6 +2009,16 @@ static int readrnxfile(const char *file, gtime_t ts, gtime_t te, double tint,
     
     if (sta) init_sta(sta);
     
+    /* read compressed file by in-process uncompressed stream (the body of
+       RINEX 3 obs is read to memory and decoded in parallel by readrnxobs()) */
+    if ((cstat=openuncomp(file,&unc))>0) {
+        stat=readrnxfp(unc.fp,NULL,ts,te,tint,opt,flag,index,type,obs,obsc,
+                       nav,sta);
+        if (closeuncomp(&unc)<0) {
+            trace(2,"rinex file uncompress error: %s\n",file);
+        }
+        return stat;
+    }
     /* uncompress file */
     if ((cstat=rtk_uncompress(file,tmpfile))<0) {
         trace(2,"rinex file uncompact error: %s\n",file);
@@ -1605,7 +2029,8 @@ static int readrnxfile(const char *file, gtime_t ts, gtime_t te, double tint,
         return 0;
     }
     /* read RINEX file */
-    stat=readrnxfp(fp,ts,te,tint,opt,flag,index,type,obs,nav,sta);
+    stat=readrnxfp(fp,cstat?tmpfile:file,ts,te,tint,opt,flag,index,type,obs,
+                   obsc,nav,sta);
     
     fclose(fp);
     
@@ -1614,6 +2039,308 @@ static int readrnxfile(const char *file, gtime_t ts, gtime_t te, double tint,
     
     return stat;
 }
+/* get/set nav header parameters ---------------------------------------------*/
+static void getnavh(const nav_t *nav, navh_t *h)
+{
+    memcpy(h->utc_gps,nav->utc_gps,sizeof(h->utc_gps));
+    memcpy(h->utc_glo,nav->utc_glo,sizeof(h->utc_glo));
+    memcpy(h->utc_gal,nav->utc_gal,sizeof(h->utc_gal));
+    memcpy(h->utc_qzs,nav->utc_qzs,sizeof(h->utc_qzs));
+    memcpy(h->utc_cmp,nav->utc_cmp,sizeof(h->utc_cmp));
+    memcpy(h->utc_irn,nav->utc_irn,sizeof(h->utc_irn));
+    memcpy(h->utc_sbs,nav->utc_sbs,sizeof(h->utc_sbs));
+    memcpy(h->ion_gps,nav->ion_gps,sizeof(h->ion_gps));
+    memcpy(h->ion_gal,nav->ion_gal,sizeof(h->ion_gal));
+    memcpy(h->ion_qzs,nav->ion_qzs,sizeof(h->ion_qzs));
+    memcpy(h->ion_cmp,nav->ion_cmp,sizeof(h->ion_cmp));
+    memcpy(h->ion_irn,nav->ion_irn,sizeof(h->ion_irn));
+    memcpy(h->glo_fcn,nav->glo_fcn,sizeof(h->glo_fcn));
+}
+static void setpar(double *dst, const double *src, int n)
+{
+    int i;
+    for (i=0;i<n;i++) if (src[i]!=NAVHNONE) dst[i]=src[i];
+}
+static void setnavh(nav_t *nav, const navh_t *h)
+{
+    int i;
+    
+    setpar(nav->utc_gps,h->utc_gps,8);
+    setpar(nav->utc_glo,h->utc_glo,8);
+    setpar(nav->utc_gal,h->utc_gal,8);
+    setpar(nav->utc_qzs,h->utc_qzs,8);
+    setpar(nav->utc_cmp,h->utc_cmp,8);
+    setpar(nav->utc_irn,h->utc_irn,9);
+    setpar(nav->utc_sbs,h->utc_sbs,4);
+    setpar(nav->ion_gps,h->ion_gps,8);
+    setpar(nav->ion_gal,h->ion_gal,4);
+    setpar(nav->ion_qzs,h->ion_qzs,8);
+    setpar(nav->ion_cmp,h->ion_cmp,8);
+    setpar(nav->ion_irn,h->ion_irn,8);
+    for (i=0;i<32;i++) if (h->glo_fcn[i]>=0) nav->glo_fcn[i]=h->glo_fcn[i];
+}
+static void clrnavh(navh_t *h)
+{
+    double *p;
+    int i;
+    
+    for (p=h->utc_gps;p<h->utc_gps+8;p++) *p=NAVHNONE;
+    for (p=h->utc_glo;p<h->utc_glo+8;p++) *p=NAVHNONE;
+    for (p=h->utc_gal;p<h->utc_gal+8;p++) *p=NAVHNONE;
+    for (p=h->utc_qzs;p<h->utc_qzs+8;p++) *p=NAVHNONE;
+    for (p=h->utc_cmp;p<h->utc_cmp+8;p++) *p=NAVHNONE;
+    for (p=h->utc_irn;p<h->utc_irn+9;p++) *p=NAVHNONE;
+    for (p=h->utc_sbs;p<h->utc_sbs+4;p++) *p=NAVHNONE;
+    for (p=h->ion_gps;p<h->ion_gps+8;p++) *p=NAVHNONE;
+    for (p=h->ion_gal;p<h->ion_gal+4;p++) *p=NAVHNONE;
+    for (p=h->ion_qzs;p<h->ion_qzs+8;p++) *p=NAVHNONE;
+    for (p=h->ion_cmp;p<h->ion_cmp+8;p++) *p=NAVHNONE;
+    for (p=h->ion_irn;p<h->ion_irn+8;p++) *p=NAVHNONE;
+    for (i=0;i<32;i++) h->glo_fcn[i]=-1;
+}
+/* append data array ---------------------------------------------------------*/
+static int catdata(void *data, int *n, int *nmax, const void *src, int m,
+                   size_t size, void **p)
+{
+    *p=data;
+    
+    if (m<=0) return 1;
+    
+    if (*nmax<*n+m) {
+        if (!(*p=realloc(data,size*(*n+m)))) {
+            trace(1,"catdata: malloc error n=%d\n",*n+m);
+            *p=data;
+            return 0;
+        }
+        *nmax=*n+m;
+    }
+    memcpy((char *)*p+size*(*n),src,size*m);
+    *n+=m;
+    return 1;
+}
+/* append precise clocks -----------------------------------------------------*/
+static int catpclk(nav_t *nav, const pclk_t *pclk, int n)
+{
+    void *p;
+    int i;
+    
+    /* merge first epoch to last epoch as readrnxclk() */
+    if (n>0&&nav->nc>0&&
+        fabs(timediff(pclk[0].time,nav->pclk[nav->nc-1].time))<=1E-9) {
+        for (i=0;i<MAXSAT;i++) {
+            if (pclk[0].clk[i][0]==0.0&&pclk[0].std[i][0]==0.0f) continue;
+            nav->pclk[nav->nc-1].clk[i][0]=pclk[0].clk[i][0];
+            nav->pclk[nav->nc-1].std[i][0]=pclk[0].std[i][0];
+        }
+        pclk++; n--;
+    }
+    if (!catdata(nav->pclk,&nav->nc,&nav->ncmax,pclk,n,sizeof(pclk_t),&p)) {
+        return 0;
+    }
+    nav->pclk=(pclk_t *)p;
+    return 1;
+}
+/* read RINEX file data from cache -------------------------------------------*/
+static int getrnxcache(cache_t *cache, char *type, obs_t *obs, obsc_t *obsc,
+                       nav_t *nav, sta_t *sta)
+{
+    const void *p[CACHE_OBSC+17];
+    obsc_t src={0};
+    void *q;
+    int i,n[CACHE_OBSC+17],stat=1;
+    size_t size[CACHE_OBSC+17]={
+        0,sizeof(int),sizeof(sta_t),sizeof(navh_t),sizeof(eph_t),
+        sizeof(geph_t),sizeof(seph_t),sizeof(pclk_t),sizeof(obsd_t),
+        sizeof(gtime_t),sizeof(gtime_t),1,1,sizeof(int),1,1,sizeof(int),1,1,1,
+        1,1,sizeof(uint16_t),sizeof(double),sizeof(double),sizeof(float)
+    };
+    
+    for (i=CACHE_STAT;i<CACHE_OBSC+(obsc?17:0);i++) {
+        if (!(p[i]=getcache(cache,i,size[i],n+i))) return -2;
+    }
+    if (n[CACHE_STAT]!=2||(sta&&n[CACHE_STA]!=1)||(nav&&n[CACHE_NAVH]!=1)) {
+        return -2;
+    }
+    if (obsc) {
+        src.time=(gtime_t *)p[CACHE_OBSC];
+        src.eventime=(gtime_t *)p[CACHE_OBSC+1];
+        src.rcv=(uint8_t *)p[CACHE_OBSC+2];
+        src.timevalid=(uint8_t *)p[CACHE_OBSC+3];
+        src.iobs=(int *)p[CACHE_OBSC+4];
+        src.sat=(uint8_t *)p[CACHE_OBSC+5];
+        src.freq=(uint8_t *)p[CACHE_OBSC+6];
+        src.isig=(int *)p[CACHE_OBSC+7];
+        src.slot=(uint8_t *)p[CACHE_OBSC+8];
+        src.code=(uint8_t *)p[CACHE_OBSC+9];
+        src.LLI=(uint8_t *)p[CACHE_OBSC+10];
+        src.qualL=(uint8_t *)p[CACHE_OBSC+11];
+        src.qualP=(uint8_t *)p[CACHE_OBSC+12];
+        src.SNR=(uint16_t *)p[CACHE_OBSC+13];
+        src.L=(double *)p[CACHE_OBSC+14];
+        src.P=(double *)p[CACHE_OBSC+15];
+        src.D=(float *)p[CACHE_OBSC+16];
+        src.ne=n[CACHE_OBSC];
+        src.n=n[CACHE_OBSC+5];
+        src.ns=n[CACHE_OBSC+8];
+        for (i=CACHE_OBSC;i<CACHE_OBSC+17;i++) {
+            if (n[i]!=(i<CACHE_OBSC+4?src.ne:(i==CACHE_OBSC+4?src.ne+1:
+                (i<CACHE_OBSC+7?src.n:(i==CACHE_OBSC+7?src.n+1:src.ns))))) {
+                return -2;
+            }
+        }
+        if (src.iobs[src.ne]!=src.n||src.isig[src.n]!=src.ns) return -2;
+    }
+    trace(3,"getrnxcache: nobs=%d neph=%d ngeph=%d nseph=%d npclk=%d\n",
+          obsc?src.n:n[CACHE_OBS],n[CACHE_EPH],n[CACHE_GEPH],n[CACHE_SEPH],
+          n[CACHE_PCLK]);
+    
+    *type=(char)((const int *)p[CACHE_STAT])[1];
+    
+    if (sta) {
+        *sta=*(const sta_t *)p[CACHE_STA];
+    }
+    if (obs) {
+        if (!catdata(obs->data,&obs->n,&obs->nmax,p[CACHE_OBS],n[CACHE_OBS],
+                     sizeof(obsd_t),&q)) stat=-1;
+        obs->data=(obsd_t *)q;
+    }
+    if (obsc&&catobsc(obsc,&src)<0) stat=-1;
+    
+    if (nav) {
+        setnavh(nav,(const navh_t *)p[CACHE_NAVH]);
+        
+        if (!catdata(nav->eph,&nav->n,&nav->nmax,p[CACHE_EPH],n[CACHE_EPH],
+                     sizeof(eph_t),&q)) stat=-1;
+        nav->eph=(eph_t *)q;
+        if (!catdata(nav->geph,&nav->ng,&nav->ngmax,p[CACHE_GEPH],
+                     n[CACHE_GEPH],sizeof(geph_t),&q)) stat=-1;
+        nav->geph=(geph_t *)q;
+        if (!catdata(nav->seph,&nav->ns,&nav->nsmax,p[CACHE_SEPH],
+                     n[CACHE_SEPH],sizeof(seph_t),&q)) stat=-1;
+        nav->seph=(seph_t *)q;
+        if (!catpclk(nav,(const pclk_t *)p[CACHE_PCLK],n[CACHE_PCLK])) {
+            stat=-1;
+        }
+    }
+    return stat<0?-1:((const int *)p[CACHE_STAT])[0];
+}
+/* write RINEX file data to cache --------------------------------------------*/
+static void putrnxcache(cache_t *cache, char type, int stat, const obs_t *obs,
+                        const obsc_t *obsc, const nav_t *nav, const navh_t *navh,
+                        const sta_t *sta, const int *n0)
+{
+    int i,*iobs=NULL,*isig=NULL,ne=0,n=0,ns=0,buff[2];
+    
+    buff[0]=stat;
+    buff[1]=type;
+    putcache(cache,CACHE_STAT,buff,sizeof(int),2);
+    putcache(cache,CACHE_STA ,sta,sizeof(sta_t),sta?1:0);
+    putcache(cache,CACHE_NAVH,navh,sizeof(navh_t),nav?1:0);
+    putcache(cache,CACHE_EPH ,nav?nav->eph +n0[4]:NULL,sizeof(eph_t ),
+             nav?nav->n -n0[4]:0);
+    putcache(cache,CACHE_GEPH,nav?nav->geph+n0[5]:NULL,sizeof(geph_t),
+             nav?nav->ng-n0[5]:0);
+    putcache(cache,CACHE_SEPH,nav?nav->seph+n0[6]:NULL,sizeof(seph_t),
+             nav?nav->ns-n0[6]:0);
+    putcache(cache,CACHE_PCLK,nav?nav->pclk:NULL,sizeof(pclk_t),
+             nav?nav->nc:0);
+    putcache(cache,CACHE_OBS ,obs?obs->data+n0[0]:NULL,sizeof(obsd_t),
+             obs?obs->n-n0[0]:0);
+    if (!obsc) return;
+    
+    ne=obsc->ne-n0[1]; n=obsc->n-n0[2]; ns=obsc->ns-n0[3];
+    
+    /* offsets of appended epochs and records */
+    if (!(iobs=(int *)malloc(sizeof(int)*(ne+1)))||
+        !(isig=(int *)malloc(sizeof(int)*(n+1)))) {
+        free(iobs);
+        closecache(cache,0);
+        return;
+    }
+    for (i=0;i<=ne;i++) iobs[i]=ne>0?obsc->iobs[n0[1]+i]-n0[2]:0;
+    for (i=0;i<=n ;i++) isig[i]=n >0?obsc->isig[n0[2]+i]-n0[3]:0;
+    
+    putcache(cache,CACHE_OBSC   ,obsc->time     +n0[1],sizeof(gtime_t),ne);
+    putcache(cache,CACHE_OBSC+1 ,obsc->eventime +n0[1],sizeof(gtime_t),ne);
+    putcache(cache,CACHE_OBSC+2 ,obsc->rcv      +n0[1],1,ne);
+    putcache(cache,CACHE_OBSC+3 ,obsc->timevalid+n0[1],1,ne);
+    putcache(cache,CACHE_OBSC+4 ,iobs,sizeof(int),ne+1);
+    putcache(cache,CACHE_OBSC+5 ,obsc->sat +n0[2],1,n);
+    putcache(cache,CACHE_OBSC+6 ,obsc->freq+n0[2],1,n);
+    putcache(cache,CACHE_OBSC+7 ,isig,sizeof(int),n+1);
+    putcache(cache,CACHE_OBSC+8 ,obsc->slot +n0[3],1,ns);
+    putcache(cache,CACHE_OBSC+9 ,obsc->code +n0[3],1,ns);
+    putcache(cache,CACHE_OBSC+10,obsc->LLI  +n0[3],1,ns);
+    putcache(cache,CACHE_OBSC+11,obsc->qualL+n0[3],1,ns);
+    putcache(cache,CACHE_OBSC+12,obsc->qualP+n0[3],1,ns);
+    putcache(cache,CACHE_OBSC+13,obsc->SNR  +n0[3],sizeof(uint16_t),ns);
+    putcache(cache,CACHE_OBSC+14,obsc->L    +n0[3],sizeof(double),ns);
+    putcache(cache,CACHE_OBSC+15,obsc->P    +n0[3],sizeof(double),ns);
+    putcache(cache,CACHE_OBSC+16,obsc->D    +n0[3],sizeof(float),ns);
+    free(iobs);
+    free(isig);
+}
+/* read RINEX file with binary cache -------------------------------------------
+* read RINEX file by readrnxfile() or from binary cache of the file. if the
+* cache is invalid, the data read from the file are written to new cache.
+*-----------------------------------------------------------------------------*/
+static int readrnxcache(const char *file, gtime_t ts, gtime_t te, double tint,
+                        const char *opt, int flag, int index, char *type,
+                        obs_t *obs, obsc_t *obsc, nav_t *nav, sta_t *sta)
+{
+    cache_t cache;
+    navh_t navh0,navh;
+    pclk_t *pclk=NULL,*nav_pclk;
+    char key[512];
+    int stat,n,nc=0,ncmax=0,n0[7]={0};
+    
+    sprintf(key,"rnx %.0f %.9f %.0f %.9f %.9g %.255s %d %d %d%d%d%d",
+            (double)ts.time,ts.sec,(double)te.time,te.sec,tint,opt,flag,index,
+            obs!=NULL,obsc!=NULL,nav!=NULL,sta!=NULL);
+    
+    if (opencache(file,key,&cache)) {
+        if (sta) init_sta(sta);
+        stat=getrnxcache(&cache,type,obs,obsc,nav,sta);
+        closecache(&cache,stat>-2?0:-1);
+        if (stat>-2) return stat;
+        opencache(file,key,&cache);
+    }
+    if (!cache.fp) {
+        return readrnxfile(file,ts,te,tint,opt,flag,index,type,obs,obsc,nav,
+                           sta);
+    }
+    /* separate data read from the file from data already read */
+    if (obs) n0[0]=obs->n;
+    if (obsc) {n0[1]=obsc->ne; n0[2]=obsc->n; n0[3]=obsc->ns;}
+    if (nav) {
+        n0[4]=nav->n; n0[5]=nav->ng; n0[6]=nav->ns;
+        getnavh(nav,&navh0);
+        clrnavh(&navh);
+        setnavh(nav,&navh);
+        pclk=nav->pclk; nc=nav->nc; ncmax=nav->ncmax;
+        nav->pclk=NULL; nav->nc=nav->ncmax=0;
+    }
+    stat=readrnxfile(file,ts,te,tint,opt,flag,index,type,obs,obsc,nav,sta);
+    
+    if (nav) getnavh(nav,&navh);
+    
+    if (stat>=0) {
+        putrnxcache(&cache,*type,stat,obs,obsc,nav,&navh,sta,n0);
+    }
+    closecache(&cache,stat>=0);
+    
+    /* restore nav header parameters and precise clocks */
+    if (nav) {
+        setnavh(nav,&navh0);
+        setnavh(nav,&navh);
+        
+        nav_pclk=nav->pclk; n=nav->nc;
+        nav->pclk=pclk; nav->nc=nc; nav->ncmax=ncmax;
+        if (!catpclk(nav,nav_pclk,n)) stat=-1;
+        free(nav_pclk);
+    }
+    return stat;
+}
 /* read RINEX OBS and NAV files ------------------------------------------------
 * read RINEX OBS and NAV files
 * args   : char *file    I      file (wild-card * expanded) ("": stdin)
@@ -1631,6 +2358,9 @@ static int readrnxfile(const char *file, gtime_t ts, gtime_t te, double tint,
 *          observation data and navigation data are not sorted.
 *          navigation data may be duplicated.
 *          call sortobs() or uniqnav() to sort data or delete duplicated eph.
+*          RINEX 3 OBS files are memory-mapped and decoded in parallel by
+*          chunks split at epoch records. obs data of the files are in time
+*          order and sorted by satellite in each epoch.
 *
 *          RINEX options (separated by spaces) :
 *
@@ -1648,18 +2378,16 @@ static int readrnxfile(const char *file, gtime_t ts, gtime_t te, double tint,
 *                               (sys=G:GPS,R:GLO,E:GAL,J:QZS,C:BDS,I:IRN,S:SBS)
 *
 *-----------------------------------------------------------------------------*/
-extern int readrnxt(const char *file, int rcv, gtime_t ts, gtime_t te,
-                    double tint, const char *opt, obs_t *obs, nav_t *nav,
-                    sta_t *sta)
+static int readrnxtc(const char *file, int rcv, gtime_t ts, gtime_t te,
+                     double tint, const char *opt, obs_t *obs, obsc_t *obsc,
+                     nav_t *nav, sta_t *sta)
 {
     int i,n,stat=0;
     const char *p;
     char type=' ',*files[MAXEXFILE]={0};
     
-    trace(3,"readrnxt: file=%s rcv=%d\n",file,rcv);
-    
     if (!*file) {
-        return readrnxfp(stdin,ts,te,tint,opt,0,1,&type,obs,nav,sta);
+        return readrnxfp(stdin,NULL,ts,te,tint,opt,0,1,&type,obs,obsc,nav,sta);
     }
     for (i=0;i<MAXEXFILE;i++) {
         if (!(files[i]=(char *)malloc(1024))) {
@@ -1674,7 +2402,8 @@ extern int readrnxt(const char *file, int rcv, gtime_t ts, gtime_t te,
     }
     /* read rinex files */
     for (i=0;i<n&&stat>=0;i++) {
-        stat=readrnxfile(files[i],ts,te,tint,opt,0,rcv,&type,obs,nav,sta);
+        stat=readrnxcache(files[i],ts,te,tint,opt,0,rcv,&type,obs,obsc,nav,
+                          sta);
     }
     /* if station name empty, set 4-char name from file head */
     if (type=='O'&&sta) {
@@ -1685,6 +2414,37 @@ extern int readrnxt(const char *file, int rcv, gtime_t ts, gtime_t te,
     
     return stat;
 }
+extern int readrnxt(const char *file, int rcv, gtime_t ts, gtime_t te,
+                    double tint, const char *opt, obs_t *obs, nav_t *nav,
+                    sta_t *sta)
+{
+    trace(3,"readrnxt: file=%s rcv=%d\n",file,rcv);
+    
+    return readrnxtc(file,rcv,ts,te,tint,opt,obs,NULL,nav,sta);
+}
+/* read RINEX OBS and NAV files to compact observation data --------------------
+* read RINEX OBS and NAV files as readrnxt() but store observation data to
+* compact observation data
+* args   : char   *file  I      file (wild-card * expanded) ("": stdin)
+*          int    rcv    I      receiver number for obs data
+*          gtime_t ts    I      observation time start (ts.time==0: no limit)
+*          gtime_t te    I      observation time end   (te.time==0: no limit)
+*          double tint   I      observation time interval (s) (0:all)
+*          char   *opt   I      RINEX options (see readrnxt())
+*          obsc_t *obsc  IO     compact observation data (NULL: no input)
+*          nav_t  *nav   IO     navigation data    (NULL: no input)
+*          sta_t  *sta   IO     station parameters (NULL: no input)
+* return : status (1:ok,0:no data,-1:error)
+* notes  : call sortobsc() to sort epochs and delete duplicated data
+*-----------------------------------------------------------------------------*/
+extern int readrnxobsc(const char *file, int rcv, gtime_t ts, gtime_t te,
+                       double tint, const char *opt, obsc_t *obsc, nav_t *nav,
+                       sta_t *sta)
+{
+    trace(3,"readrnxobsc: file=%s rcv=%d\n",file,rcv);
+    
+    return readrnxtc(file,rcv,ts,te,tint,opt,NULL,obsc,nav,sta);
+}
 extern int readrnx(const char *file, int rcv, const char *opt, obs_t *obs,
                    nav_t *nav, sta_t *sta)
 {
@@ -1760,7 +2520,7 @@ extern int readrnxc(const char *file, nav_t *nav)
     
     /* read rinex clock files */
     for (i=0;i<n;i++) {
-        if (readrnxfile(files[i],t,t,0.0,"",1,index++,&type,NULL,nav,NULL)) {
+        if (readrnxcache(files[i],t,t,0.0,"",1,index++,&type,NULL,NULL,nav,NULL)) {
             continue;
         }
         stat=0;
@@ -1816,6 +2576,7 @@ extern int init_rnxctr(rnxctr_t *rnx)
     for (i=0;i<MAXSAT*2 ;i++) rnx->nav.eph [i]=eph0;
     for (i=0;i<NSATGLO  ;i++) rnx->nav.geph[i]=geph0;
     for (i=0;i<NSATSBS*2;i++) rnx->nav.seph[i]=seph0;
+    for (i=0;i<32       ;i++) rnx->nav.glo_frq[i]=0;
     rnx->ephsat=rnx->ephset=0;
     rnx->opt[0]='\0';
     
@@ -89,6 +89,7 @@ extern int init_rtcm(rtcm_t *rtcm)
         rtcm->ssr[i]=ssr0;
     }
     rtcm->msg[0]=rtcm->msgtype[0]=rtcm->opt[0]='\0';
+    compopt(rtcm->opt,&rtcm->copt);
     for (i=0;i<6;i++) rtcm->msmtype[i][0]='\0';
     rtcm->obsflag=rtcm->ephsat=0;
     for (i=0;i<MAXSAT;i++) for (j=0;j<NFREQ+NEXOBS;j++) {
@@ -118,6 +119,7 @@ extern int init_rtcm(rtcm_t *rtcm)
     for (i=0;i<MAXOBS   ;i++) rtcm->obs.data[i]=data0;
     for (i=0;i<MAXSAT*2 ;i++) rtcm->nav.eph [i]=eph0;
     for (i=0;i<MAXPRNGLO;i++) rtcm->nav.geph[i]=geph0;
+    for (i=0;i<32       ;i++) rtcm->nav.glo_frq[i]=0;
     return 1;
 }
 /* free rtcm control ----------------------------------------------------------
@@ -214,6 +216,9 @@ extern int input_rtcm2(rtcm_t *rtcm, uint8_t data)
 *          -GALINAV : select I/NAV for Galileo ephemeris (default: all)
 *          -GALFNAV : select F/NAV for Galileo ephemeris (default: all)
 *
+*          the options are compiled by compopt() into rtcm->copt. call
+*          compopt(rtcm->opt,&rtcm->copt) after changing rtcm->opt
+*
 *          supported RTCM 3 messages (ref [7][10][15][16][17][18])
 *
 *            TYPE       :  GPS   GLONASS Galileo  QZSS     BDS    SBAS    NavIC
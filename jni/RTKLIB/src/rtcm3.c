@@ -241,13 +241,11 @@ static int obsindex(obs_t *obs, gtime_t time, int sat)
 /* test station ID consistency -----------------------------------------------*/
 static int test_staid(rtcm_t *rtcm, int staid)
 {
-    char *p;
-    int type,id;
+    int type;
     
     /* test station id option */
-    if ((p=strstr(rtcm->opt,"-STA="))&&sscanf(p,"-STA=%d",&id)==1) {
-        if (staid!=id) return 0;
-    }
+    if ((rtcm->copt.flag&COPT_STA)&&staid!=rtcm->copt.sta) return 0;
+    
     /* save station id */
     if (rtcm->staid==0||rtcm->obsflag) {
         rtcm->staid=staid;
@@ -797,7 +795,7 @@ static int decode_type1019(rtcm_t *rtcm)
     eph.toc=gpst2time(eph.week,toc);
     eph.ttr=rtcm->time;
     eph.A=sqrtA*sqrtA;
-    if (!strstr(rtcm->opt,"-EPHALL")) {
+    if (!(rtcm->copt.flag&COPT_EPHALL)) {
         if (eph.iode==rtcm->nav.eph[sat-1].iode) return 0; /* unchanged */
     }
     rtcm->nav.eph[sat-1]=eph;
@@ -865,7 +863,7 @@ static int decode_type1020(rtcm_t *rtcm)
     else if (toe>tod+43200.0) toe-=86400.0;
     geph.toe=utc2gpst(gpst2time(week,tow+toe)); /* utc->gpst */
     
-    if (!strstr(rtcm->opt,"-EPHALL")) {
+    if (!(rtcm->copt.flag&COPT_EPHALL)) {
         if (fabs(timediff(geph.toe,rtcm->nav.geph[prn-1].toe))<1.0&&
             geph.svh==rtcm->nav.geph[prn-1].svh) return 0; /* unchanged */
     }
@@ -1115,7 +1113,7 @@ static int decode_type1041(rtcm_t *rtcm)
     eph.ttr=rtcm->time;
     eph.A=sqrtA*sqrtA;
     eph.iodc=eph.iode;
-    if (!strstr(rtcm->opt,"-EPHALL")) {
+    if (!(rtcm->copt.flag&COPT_EPHALL)) {
         if (eph.iode==rtcm->nav.eph[sat-1].iode) return 0; /* unchanged */
     }
     rtcm->nav.eph[sat-1]=eph;
@@ -1188,7 +1186,7 @@ static int decode_type1044(rtcm_t *rtcm)
     eph.ttr=rtcm->time;
     eph.A=sqrtA*sqrtA;
     eph.flag=1; /* fixed to 1 */
-    if (!strstr(rtcm->opt,"-EPHALL")) {
+    if (!(rtcm->copt.flag&COPT_EPHALL)) {
         if (eph.iode==rtcm->nav.eph[sat-1].iode&&
             eph.iodc==rtcm->nav.eph[sat-1].iodc) return 0; /* unchanged */
     }
@@ -1205,7 +1203,7 @@ static int decode_type1045(rtcm_t *rtcm)
     char *msg;
     int i=24+12,prn,sat,week,e5a_hs,e5a_dvs,rsv,sys=SYS_GAL;
     
-    if (strstr(rtcm->opt,"-GALINAV")) return 0;
+    if (rtcm->copt.flag&COPT_GALINAV) return 0;
 
     if (i+484<=rtcm->len*8) {
         prn       =getbitu(rtcm->buff,i, 6);              i+= 6;
@@ -1252,7 +1250,7 @@ static int decode_type1045(rtcm_t *rtcm)
         trace(2,"rtcm3 1045 satellite number error: prn=%d\n",prn);
         return -1;
     }
-    if (strstr(rtcm->opt,"-GALINAV")) {
+    if (rtcm->copt.flag&COPT_GALINAV) {
         return 0;
     }
     eph.sat=sat;
@@ -1268,7 +1266,7 @@ static int decode_type1045(rtcm_t *rtcm)
     eph.svh=(e5a_hs<<4)+(e5a_dvs<<3);
     eph.code=(1<<1)+(1<<8); /* data source = F/NAV+E5a */
     eph.iodc=eph.iode;
-    if (!strstr(rtcm->opt,"-EPHALL")) {
+    if (!(rtcm->copt.flag&COPT_EPHALL)) {
         if (eph.iode==rtcm->nav.eph[sat-1+MAXSAT].iode) return 0; /* unchanged */
     }
     rtcm->nav.eph[sat-1+MAXSAT]=eph;
@@ -1284,7 +1282,7 @@ static int decode_type1046(rtcm_t *rtcm)
     char *msg;
     int i=24+12,prn,sat,week,e5b_hs,e5b_dvs,e1_hs,e1_dvs,sys=SYS_GAL;
     
-    if (strstr(rtcm->opt,"-GALFNAV")) return 0;
+    if (rtcm->copt.flag&COPT_GALFNAV) return 0;
 
     if (i+492<=rtcm->len*8) {
         prn       =getbitu(rtcm->buff,i, 6);              i+= 6;
@@ -1333,7 +1331,7 @@ static int decode_type1046(rtcm_t *rtcm)
         trace(2,"rtcm3 1046 satellite number error: prn=%d\n",prn);
         return -1;
     }
-    if (strstr(rtcm->opt,"-GALFNAV")) {
+    if (rtcm->copt.flag&COPT_GALFNAV) {
         return 0;
     }
     eph.sat=sat;
@@ -1349,7 +1347,7 @@ static int decode_type1046(rtcm_t *rtcm)
     eph.svh=(e5b_hs<<7)+(e5b_dvs<<6)+(e1_hs<<1)+(e1_dvs<<0);
     eph.code=(1<<0)+(1<<2)+(1<<9); /* data source = I/NAV+E1+E5b */
     eph.iodc=eph.iode;
-    if (!strstr(rtcm->opt,"-EPHALL")) {
+    if (!(rtcm->copt.flag&COPT_EPHALL)) {
         if (eph.iode==rtcm->nav.eph[sat-1].iode) return 0; /* unchanged */
     }
     rtcm->nav.eph[sat-1]=eph;
@@ -1420,7 +1418,7 @@ static int decode_type1042(rtcm_t *rtcm)
     eph.toc=bdt2gpst(bdt2time(eph.week,toc));      /* bdt -> gpst */
     eph.ttr=rtcm->time;
     eph.A=sqrtA*sqrtA;
-    if (!strstr(rtcm->opt,"-EPHALL")) {
+    if (!(rtcm->copt.flag&COPT_EPHALL)) {
         if (timediff(eph.toe,rtcm->nav.eph[sat-1].toe)==0.0&&
             eph.iode==rtcm->nav.eph[sat-1].iode&&
             eph.iodc==rtcm->nav.eph[sat-1].iodc) return 0; /* unchanged */
@@ -1946,7 +1944,7 @@ static int decode_ssr7(rtcm_t *rtcm, int sys, int subtype)
     return 20;
 }
 /* get signal index ----------------------------------------------------------*/
-static void sigindex(int sys, const uint8_t *code, int n, const char *opt,
+static void sigindex(int sys, const uint8_t *code, int n, const copt_t *copt,
                      int *idx)
 {
     int i,nex,pri,pri_h[8]={0},index[8]={0},ex[32]={0};
@@ -1960,7 +1958,7 @@ static void sigindex(int sys, const uint8_t *code, int n, const char *opt,
             continue;
         }
         /* code priority */
-        pri=getcodepri(sys,code[i],opt);
+        pri=getcodepric(sys,code[i],copt);
         
         /* select highest priority signal */
         if (pri>pri_h[idx[i]]) {
@@ -2034,7 +2032,7 @@ static void save_msm_obs(rtcm_t *rtcm, int sys, msm_h_t *h, const double *r,
     trace(3,"rtcm3 %d: signals=%s\n",type,msm_type);
     
     /* get signal index */
-    sigindex(sys,code,h->nsig,rtcm->opt,idx);
+    sigindex(sys,code,h->nsig,&rtcm->copt,idx);
     
     for (i=j=0;i<h->nsat;i++) {
         
@@ -2545,7 +2543,7 @@ extern int decode_rtcm3(rtcm_t *rtcm)
         sprintf(rtcm->msgtype,"RTCM %4d (%4d):",type,rtcm->len);
     }
     /* real-time input option */
-    if (strstr(rtcm->opt,"-RT_INP")) {
+    if (rtcm->copt.flag&COPT_RT_INP) {
         tow=time2gpst(utc2gpst(timeget()),&week);
         rtcm->time=gpst2time(week,floor(tow));
     }
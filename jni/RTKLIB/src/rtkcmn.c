@@ -153,6 +153,14 @@
 #include <sys/time.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#else
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 #endif
 #include "rtklib.h"
 
@@ -163,6 +171,8 @@
 
 #define SQR(x)      ((x)*(x))
 #define MAX_VAR_EPH SQR(300.0)  /* max variance eph to reject satellite (m^2) */
+#define MAXOBSRUN   64          /* max sorted runs of obs data to merge */
+#define NINCOBSC    262144      /* incremental number of compact obs signals */
 
 static const double gpst0[]={1980,1, 6,0,0,0}; /* gps time reference */
 static const double gst0 []={1999,8,22,0,0,0}; /* galileo system time reference */
@@ -264,7 +274,7 @@ static char *obscodes[]={       /* observation code strings */
     "5B","5C","9A","9B","9C", "9X","1D","5D","5P","5Z", /* 50-59 */
     "6E","7D","7P","7Z","8D", "8P","4A","4B","4X",""    /* 60-69 */
 };
-static char codepris[7][MAXFREQ][16]={  /* code priority for each freq-index */
+static const char codepris[7][MAXFREQ][16]={ /* code priority for each freq-index */
    /* L1/E1/B1   L2/E5b/B2    L5/E5a/L3 E6/LEX    E5(a+b)         */
     {"CPYWMNSL","CPYWMNDLSX","IQX"     ,""       ,""       ,""}, /* GPS */
     {"CPABX"   ,"CPABX"     ,"IQX"     ,""       ,""       ,""}, /* GLO */
@@ -426,6 +436,59 @@ extern int satno(int sys, int prn)
     }
     return 0;
 }
+/* satellite number to system/prn table --------------------------------------*/
+#define SATOFF_GPS  (MINPRNGPS-1)
+#define SATOFF_GLO  (MINPRNGLO-1-NSATGPS)
+#define SATOFF_GAL  (MINPRNGAL-1-NSATGPS-NSATGLO)
+#define SATOFF_QZS  (MINPRNQZS-1-NSATGPS-NSATGLO-NSATGAL)
+#define SATOFF_CMP  (MINPRNCMP-1-NSATGPS-NSATGLO-NSATGAL-NSATQZS)
+#define SATOFF_IRN  (MINPRNIRN-1-NSATGPS-NSATGLO-NSATGAL-NSATQZS-NSATCMP)
+#define SATOFF_LEO  (MINPRNLEO-1-NSATGPS-NSATGLO-NSATGAL-NSATQZS-NSATCMP-NSATIRN)
+#define SATOFF_SBS  (MINPRNSBS-1-NSATGPS-NSATGLO-NSATGAL-NSATQZS-NSATCMP-NSATIRN-\
+                     NSATLEO)
+#define SAT_GPS()   {SYS_GPS,SATOFF_GPS}
+#define SAT_GLO()   {SYS_GLO,SATOFF_GLO}
+#define SAT_GAL()   {SYS_GAL,SATOFF_GAL}
+#define SAT_QZS()   {SYS_QZS,SATOFF_QZS}
+#define SAT_CMP()   {SYS_CMP,SATOFF_CMP}
+#define SAT_IRN()   {SYS_IRN,SATOFF_IRN}
+#define SAT_LEO()   {SYS_LEO,SATOFF_LEO}
+#define SAT_SBS()   {SYS_SBS,SATOFF_SBS}
+#define REP1(e)     e()
+#define REP2(e)     e(),e()
+#define REP4(e)     REP2(e),REP2(e)
+#define REP8(e)     REP4(e),REP4(e)
+#define REP16(e)    REP8(e),REP8(e)
+#define REP32(e)    REP16(e),REP16(e)
+
+static const struct {           /* satellite table indexed by sat (0:error) */
+    uint8_t sys;                /* satellite system (SYS_???) */
+    int16_t off;                /* prn offset (prn=sat+off) */
+} sattbl[]={
+    {SYS_NONE,0},
+    REP32(SAT_GPS),                                     /* 32 */
+#if NSATGLO>0
+    REP16(SAT_GLO),REP8(SAT_GLO),REP2(SAT_GLO),REP1(SAT_GLO), /* 27 */
+#endif
+#if NSATGAL>0
+    REP32(SAT_GAL),REP4(SAT_GAL),                       /* 36 */
+#endif
+#if NSATQZS>0
+    REP8(SAT_QZS),REP2(SAT_QZS),                        /* 10 */
+#endif
+#if NSATCMP>0
+    REP32(SAT_CMP),REP8(SAT_CMP),REP4(SAT_CMP),REP2(SAT_CMP), /* 46 */
+#endif
+#if NSATIRN>0
+    REP8(SAT_IRN),REP4(SAT_IRN),REP2(SAT_IRN),          /* 14 */
+#endif
+#if NSATLEO>0
+    REP8(SAT_LEO),REP2(SAT_LEO),                        /* 10 */
+#endif
+    REP32(SAT_SBS),REP4(SAT_SBS),REP2(SAT_SBS),REP1(SAT_SBS) /* 39 */
+};
+/* table size must follow the number of satellites of each system */
+typedef char sattbl_size_check[sizeof(sattbl)/sizeof(sattbl[0])==MAXSAT+1?1:-1];
 /* satellite number to satellite system ----------------------------------------
 * convert satellite number to satellite system
 * args   : int    sat       I   satellite number (1-MAXSAT)
@@ -434,35 +497,9 @@ extern int satno(int sys, int prn)
 *-----------------------------------------------------------------------------*/
 extern int satsys(int sat, int *prn)
 {
-    int sys=SYS_NONE;
     if (sat<=0||MAXSAT<sat) sat=0;
-    else if (sat<=NSATGPS) {
-        sys=SYS_GPS; sat+=MINPRNGPS-1;
-    }
-    else if ((sat-=NSATGPS)<=NSATGLO) {
-        sys=SYS_GLO; sat+=MINPRNGLO-1;
-    }
-    else if ((sat-=NSATGLO)<=NSATGAL) {
-        sys=SYS_GAL; sat+=MINPRNGAL-1;
-    }
-    else if ((sat-=NSATGAL)<=NSATQZS) {
-        sys=SYS_QZS; sat+=MINPRNQZS-1; 
-    }
-    else if ((sat-=NSATQZS)<=NSATCMP) {
-        sys=SYS_CMP; sat+=MINPRNCMP-1; 
-    }
-    else if ((sat-=NSATCMP)<=NSATIRN) {
-        sys=SYS_IRN; sat+=MINPRNIRN-1; 
-    }
-    else if ((sat-=NSATIRN)<=NSATLEO) {
-        sys=SYS_LEO; sat+=MINPRNLEO-1; 
-    }
-    else if ((sat-=NSATLEO)<=NSATSBS) {
-        sys=SYS_SBS; sat+=MINPRNSBS-1; 
-    }
-    else sat=0;
-    if (prn) *prn=sat;
-    return sys;
+    if (prn) *prn=sat+sattbl[sat].off;
+    return sattbl[sat].sys;
 }
 /* satellite id to satellite number --------------------------------------------
 * convert satellite id to satellite number
@@ -600,97 +637,51 @@ extern char *code2obs(uint8_t code)
     if (code<=CODE_NONE||MAXCODE<code) return "";
     return obscodes[code];
 }
-/* GPS obs code to frequency -------------------------------------------------*/
-static int code2freq_GPS(uint8_t code, double *freq)
-{
-    char *obs=code2obs(code);
-    
-    switch (obs[0]) {
-        case '1': *freq=FREQL1; return 0; /* L1 */
-        case '2': *freq=FREQL2; return 1; /* L2 */
-        case '5': *freq=FREQL5; return 2; /* L5 */
-    }
-    return -1;
-}
-/* GLONASS obs code to frequency ---------------------------------------------*/
-static int code2freq_GLO(uint8_t code, int fcn, double *freq)
-{
-    char *obs=code2obs(code);
-    
-    if (fcn<-7||fcn>6) return -1;
-    
-    switch (obs[0]) {
-        case '1': *freq=FREQ1_GLO+DFRQ1_GLO*fcn; return 0; /* G1 */
-        case '2': *freq=FREQ2_GLO+DFRQ2_GLO*fcn; return 1; /* G2 */
-        case '3': *freq=FREQ3_GLO;               return 2; /* G3 */
-        case '4': *freq=FREQ1a_GLO;              return 0; /* G1a */
-        case '6': *freq=FREQ2a_GLO;              return 1; /* G2a */
-    }
-    return -1;
-}
-/* Galileo obs code to frequency ---------------------------------------------*/
-static int code2freq_GAL(uint8_t code, double *freq)
-{
-    char *obs=code2obs(code);
-    
-    switch (obs[0]) {
-        case '1': *freq=FREQL1; return 0; /* E1 */
-        case '7': *freq=FREQE5b; return 1; /* E5b */
-        case '5': *freq=FREQL5; return 2; /* E5a */
-        case '6': *freq=FREQL6; return 3; /* E6 */
-        case '8': *freq=FREQE5ab; return 4; /* E5ab */
-    }
-    return -1;
-}
-/* QZSS obs code to frequency ------------------------------------------------*/
-static int code2freq_QZS(uint8_t code, double *freq)
-{
-    char *obs=code2obs(code);
-    
-    switch (obs[0]) {
-        case '1': *freq=FREQL1; return 0; /* L1 */
-        case '2': *freq=FREQL2; return 1; /* L2 */
-        case '5': *freq=FREQL5; return 2; /* L5 */
-        case '6': *freq=FREQL6; return 3; /* L6 */
-    }
-    return -1;
-}
-/* SBAS obs code to frequency ------------------------------------------------*/
-static int code2freq_SBS(uint8_t code, double *freq)
-{
-    char *obs=code2obs(code);
-    
-    switch (obs[0]) {
-        case '1': *freq=FREQL1; return 0; /* L1 */
-        case '5': *freq=FREQL5; return 1; /* L5 */
-    }
-    return -1;
-}
-/* BDS obs code to frequency -------------------------------------------------*/
-static int code2freq_BDS(uint8_t code, double *freq)
+/* frequency index and carrier frequency by system and band -----------------*/
+static const int8_t band_idx[7][10]={ /* band: 1st char of obs code (0-9) */
+    /* 0  1  2  3  4  5  6  7  8  9 */
+    {-1, 0, 1,-1,-1, 2,-1,-1,-1,-1}, /* GPS: L1,L2,L5 */
+    {-1, 0, 1, 2, 0,-1, 1,-1,-1,-1}, /* GLO: G1,G2,G3,G1a,G2a */
+    {-1, 0,-1,-1,-1, 2, 3, 1, 4,-1}, /* GAL: E1,E5a,E6,E5b,E5ab */
+    {-1, 0, 1,-1,-1, 2, 3,-1,-1,-1}, /* QZS: L1,L2,L5,L6 */
+    {-1, 0,-1,-1,-1, 1,-1,-1,-1,-1}, /* SBS: L1,L5 */
+    {-1, 0, 0,-1,-1, 2, 3, 1, 4,-1}, /* BDS: B1C,B1I,B2a,B3,B2I/B2b,B2ab */
+    {-1,-1,-1,-1,-1, 0,-1,-1,-1, 1}  /* IRN: L5,S */
+};
+static const double band_freq[7][10]={
+    {0.0,FREQL1,FREQL2,0.0,0.0,FREQL5,0.0,0.0,0.0,0.0},
+    {0.0,FREQ1_GLO,FREQ2_GLO,FREQ3_GLO,FREQ1a_GLO,0.0,FREQ2a_GLO,0.0,0.0,0.0},
+    {0.0,FREQL1,0.0,0.0,0.0,FREQL5,FREQL6,FREQE5b,FREQE5ab,0.0},
+    {0.0,FREQL1,FREQL2,0.0,0.0,FREQL5,FREQL6,0.0,0.0,0.0},
+    {0.0,FREQL1,0.0,0.0,0.0,FREQL5,0.0,0.0,0.0,0.0},
+    {0.0,FREQL1,FREQ1_CMP,0.0,0.0,FREQL5,FREQ3_CMP,FREQ2_CMP,FREQE5ab,0.0},
+    {0.0,0.0,0.0,0.0,0.0,FREQL5,0.0,0.0,0.0,FREQs}
+};
+static const double band_dfrq_glo[10]={ /* GLONASS FDMA channel spacing */
+    0.0,DFRQ1_GLO,DFRQ2_GLO,0.0,0.0,0.0,0.0,0.0,0.0,0.0
+};
+/* system to band table row --------------------------------------------------*/
+static int sys2row(int sys)
 {
-    char *obs=code2obs(code);
-    
-    switch (obs[0]) {
-        case '1': *freq=FREQL1;     return 0; /* B1C */
-        case '2': *freq=FREQ1_CMP; return 0; /* B1I */
-        case '7': *freq=FREQ2_CMP; return 1; /* B2I/B2b */
-        case '5': *freq=FREQL5;     return 2; /* B2a */
-        case '6': *freq=FREQ3_CMP; return 3; /* B3 */
-        case '8': *freq=FREQE5ab;     return 4; /* B2ab */
+    switch (sys) {
+        case SYS_GPS: return 0;
+        case SYS_GLO: return 1;
+        case SYS_GAL: return 2;
+        case SYS_QZS: return 3;
+        case SYS_SBS: return 4;
+        case SYS_CMP: return 5;
+        case SYS_IRN: return 6;
     }
     return -1;
 }
-/* NavIC obs code to frequency -----------------------------------------------*/
-static int code2freq_IRN(uint8_t code, double *freq)
+/* obs code to band (1st char of obs code) -----------------------------------*/
+static int code2band(uint8_t code)
 {
-    char *obs=code2obs(code);
+    int band;
     
-    switch (obs[0]) {
-        case '5': *freq=FREQL5; return 0; /* L5 */
-        case '9': *freq=FREQs; return 1; /* S */
-    }
-    return -1;
+    if (code<=CODE_NONE||MAXCODE<code) return -1;
+    band=obscodes[code][0]-'0';
+    return (band<0||band>9)?-1:band;
 }
 /* system and obs code to frequency index --------------------------------------
 * convert system and obs code to frequency index
@@ -709,18 +700,10 @@ static int code2freq_IRN(uint8_t code, double *freq)
 *-----------------------------------------------------------------------------*/
 extern int code2idx(int sys, uint8_t code)
 {
-    double freq;
+    int row,band;
     
-    switch (sys) {
-        case SYS_GPS: return code2freq_GPS(code,&freq);
-        case SYS_GLO: return code2freq_GLO(code,0,&freq);
-        case SYS_GAL: return code2freq_GAL(code,&freq);
-        case SYS_QZS: return code2freq_QZS(code,&freq);
-        case SYS_SBS: return code2freq_SBS(code,&freq);
-        case SYS_CMP: return code2freq_BDS(code,&freq);
-        case SYS_IRN: return code2freq_IRN(code,&freq);
-    }
-    return -1;
+    if ((row=sys2row(sys))<0||(band=code2band(code))<0) return -1;
+    return band_idx[row][band];
 }
 /* system and obs code to frequency --------------------------------------------
 * convert system and obs code to carrier frequency
@@ -731,18 +714,14 @@ extern int code2idx(int sys, uint8_t code)
 *-----------------------------------------------------------------------------*/
 extern double code2freq(int sys, uint8_t code, int fcn)
 {
-    double freq=0.0;
+    int row,band;
     
-    switch (sys) {
-        case SYS_GPS: (void)code2freq_GPS(code,&freq); break;
-        case SYS_GLO: (void)code2freq_GLO(code,fcn,&freq); break;
-        case SYS_GAL: (void)code2freq_GAL(code,&freq); break;
-        case SYS_QZS: (void)code2freq_QZS(code,&freq); break;
-        case SYS_SBS: (void)code2freq_SBS(code,&freq); break;
-        case SYS_CMP: (void)code2freq_BDS(code,&freq); break;
-        case SYS_IRN: (void)code2freq_IRN(code,&freq); break;
+    if ((row=sys2row(sys))<0||(band=code2band(code))<0) return 0.0;
+    if (sys==SYS_GLO) {
+        if (fcn<-7||fcn>6) return 0.0;
+        return band_freq[row][band]+band_dfrq_glo[band]*fcn;
     }
-    return freq;
+    return band_freq[row][band];
 }
 /* satellite and obs code to frequency -----------------------------------------
 * convert satellite and obs code to carrier frequency
@@ -750,6 +729,7 @@ extern double code2freq(int sys, uint8_t code, int fcn)
 *          uint8_t code     I   obs code (CODE_???)
 *          nav_t  *nav_t    I   navigation data for GLONASS (NULL: not used)
 * return : carrier frequency (Hz) (0.0: error)
+* notes  : GLONASS FCN resolved by updatefcn() is used if available
 *-----------------------------------------------------------------------------*/
 extern double sat2freq(int sat, uint8_t code, const nav_t *nav)
 {
@@ -759,6 +739,9 @@ extern double sat2freq(int sat, uint8_t code, const nav_t *nav)
     
     if (sys==SYS_GLO) {
         if (!nav) return 0.0;
+        if (nav->glo_frq[prn-1]>0) {
+            return code2freq(sys,code,nav->glo_frq[prn-1]-8);
+        }
         for (i=0;i<nav->ng;i++) {
             if (nav->geph[i].sat==sat) break;
         }
@@ -774,24 +757,29 @@ extern double sat2freq(int sat, uint8_t code, const nav_t *nav)
 }
 /* set code priority -----------------------------------------------------------
 * set code priority for multiple codes in a frequency
-* args   : int    sys     I     system (or of SYS_???)
+* args   : copt_t *copt   IO    compiled options
+*          int    sys     I     system (or of SYS_???)
 *          int    idx       I   frequency index (0- )
 *          char   *pri    I     priority of codes (series of code characters)
-*                               (higher priority precedes lower)
+*                               (higher priority precedes lower, "":default)
 * return : none
+* notes  : code priorities are kept in the compiled options of a decoder and
+*          used by getcodepric(). compopt() resets them to default, so set
+*          them after compopt(). getcodepri() uses the default priorities
 *-----------------------------------------------------------------------------*/
-extern void setcodepri(int sys, int idx, const char *pri)
+extern void setcodepri(copt_t *copt, int sys, int idx, const char *pri)
 {
+    const int syss[]={SYS_GPS,SYS_GLO,SYS_GAL,SYS_QZS,SYS_SBS,SYS_CMP,SYS_IRN};
+    int i;
+    
     trace(3,"setcodepri:sys=%d idx=%d pri=%s\n",sys,idx,pri);
     
     if (idx<0||idx>=MAXFREQ) return;
-    if (sys&SYS_GPS) strcpy(codepris[0][idx],pri);
-    if (sys&SYS_GLO) strcpy(codepris[1][idx],pri);
-    if (sys&SYS_GAL) strcpy(codepris[2][idx],pri);
-    if (sys&SYS_QZS) strcpy(codepris[3][idx],pri);
-    if (sys&SYS_SBS) strcpy(codepris[4][idx],pri);
-    if (sys&SYS_CMP) strcpy(codepris[5][idx],pri);
-    if (sys&SYS_IRN) strcpy(codepris[6][idx],pri);
+    for (i=0;i<7;i++) {
+        if (!(sys&syss[i])) continue;
+        strncpy(copt->codepri[i][idx],pri,15);
+        copt->codepri[i][idx][15]='\0';
+    }
 }
 /* get code priority -----------------------------------------------------------
 * get code priority for multiple codes in a frequency
@@ -827,6 +815,129 @@ extern int getcodepri(int sys, uint8_t code, const char *opt)
     /* search code priority */
     return (p=strchr(codepris[i][j],obs[1]))?14-(int)(p-codepris[i][j]):0;
 }
+/* compile options -------------------------------------------------------------
+* compile receiver, rtcm or ppp dependent option string to flags and tables
+* args   : char   *opt      I   option string (NULL:no option)
+*          copt_t *copt     O   compiled options
+* return : none
+* notes  : decoders and positioning consult the compiled options instead of
+*          searching the option string for each message or epoch. compile the
+*          options again after changing the option string
+*          EPHALL, OBSALL, ANT_AUX and CONVBASE are accepted with or without
+*          leading '-' (swiftnav options)
+*-----------------------------------------------------------------------------*/
+extern void compopt(const char *opt, copt_t *copt)
+{
+    static const char *optflag[]={ /* same order as COPT_??? bits */
+        "EPHALL","-GALINAV","-GALFNAV","-RT_INP","-INVCP","-MULTICODE",
+        "-TTCORR","-ENAGLO","-NOET","-AUX1","-AUX2","-DIS_FCB","-ENA_FCB",
+        "OBSALL","ANT_AUX","CONVBASE",""
+    };
+    const char *p,*q,*syscode="GREJSCI";
+    char str[8];
+    int i,j;
+    
+    trace(3,"compopt: opt=%s\n",opt?opt:"");
+    
+    memset(copt,0,sizeof(copt_t));
+    
+    if (!opt) return;
+    
+    for (i=0;*optflag[i];i++) {
+        if (strstr(opt,optflag[i])) copt->flag|=1u<<i;
+    }
+    if ((p=strstr(opt,"-STA="))&&sscanf(p,"-STA=%d",&copt->sta)==1) {
+        copt->flag|=COPT_STA;
+    }
+    if ((p=strstr(opt,"-GLOBIAS="))&&sscanf(p,"-GLOBIAS=%lf",&copt->globias)==1) {
+        copt->flag|=COPT_GLOBIAS;
+    }
+    if ((p=strstr(opt,"-TADJ="))&&sscanf(p,"-TADJ=%lf",&copt->tadj)==1) {
+        copt->flag|=COPT_TADJ;
+    }
+    if ((p=strstr(opt,"-MAX_STD_CP="))&&
+        sscanf(p,"-MAX_STD_CP=%d",&copt->maxstdcp)==1) {
+        copt->flag|=COPT_MAXSTDCP;
+    }
+    if ((p=strstr(opt,"-STD_SLIP="))&&sscanf(p,"-STD_SLIP=%d",&copt->stdslip)==1) {
+        copt->flag|=COPT_STDSLIP;
+    }
+    if ((p=strstr(opt,"-TRKM_ADJ="))&&sscanf(p,"-TRKM_ADJ=%d",&copt->trkmadj)==1) {
+        copt->flag|=COPT_TRKMADJ;
+    }
+    if ((p=strstr(opt,"-GAP_RESION="))&&
+        sscanf(p,"-GAP_RESION=%d",&copt->gapion)==1) {
+        copt->flag|=COPT_GAPION;
+    }
+    /* code options (-?L??) */
+    for (p=opt;(p=strchr(p,'-'));p++) {
+        if (!p[1]||!(q=strchr(syscode,p[1]))||p[2]!='L') continue;
+        if (sscanf(p+3,"%2s",str)<1||str[0]<'0'||'9'<str[0]) continue;
+        i=(int)(q-syscode);
+        j=str[0]-'0';
+        if (!copt->sigpri[i][j]) copt->sigpri[i][j]=str[1]?str[1]:'-';
+        if ('A'<=str[1]&&str[1]<='Z') copt->sigmsk[i][j]|=1u<<(str[1]-'A');
+    }
+}
+/* get code priority with compiled options -------------------------------------
+* get code priority for multiple codes in a frequency with compiled options
+* args   : int    sys     I     system (SYS_???)
+*          uint8_t code     I   obs code (CODE_???)
+*          copt_t *copt   I     compiled options (NULL:no option)
+* return : priority (15:highest-1:lowest,0:error)
+* notes  : same as getcodepri() with the option string compiled by compopt()
+*-----------------------------------------------------------------------------*/
+extern int getcodepric(int sys, uint8_t code, const copt_t *copt)
+{
+    const char *p,*q;
+    char *obs;
+    int i,j;
+    
+    switch (sys) {
+        case SYS_GPS: i=0; break;
+        case SYS_GLO: i=1; break;
+        case SYS_GAL: i=2; break;
+        case SYS_QZS: i=3; break;
+        case SYS_SBS: i=4; break;
+        case SYS_CMP: i=5; break;
+        case SYS_IRN: i=6; break;
+        default: return 0;
+    }
+    if ((j=code2idx(sys,code))<0) return 0;
+    obs=code2obs(code);
+    
+    /* code options */
+    if (copt&&'0'<=obs[0]&&obs[0]<='9'&&copt->sigpri[i][obs[0]-'0']) {
+        return copt->sigpri[i][obs[0]-'0']==obs[1]?15:0;
+    }
+    /* search code priority */
+    q=copt&&*copt->codepri[i][j]?copt->codepri[i][j]:codepris[i][j];
+    return (p=strchr(q,obs[1]))?14-(int)(p-q):0;
+}
+/* test code option ------------------------------------------------------------
+* test code option (-?L??) in compiled options
+* args   : copt_t *copt   I     compiled options
+*          int    sys     I     system (SYS_???)
+*          char   *obs    I     obs code string without L (ex. "1L")
+* return : 1:option set,0:not set
+*-----------------------------------------------------------------------------*/
+extern int testsigopt(const copt_t *copt, int sys, const char *obs)
+{
+    int i;
+    
+    switch (sys) {
+        case SYS_GPS: i=0; break;
+        case SYS_GLO: i=1; break;
+        case SYS_GAL: i=2; break;
+        case SYS_QZS: i=3; break;
+        case SYS_SBS: i=4; break;
+        case SYS_CMP: i=5; break;
+        case SYS_IRN: i=6; break;
+        default: return 0;
+    }
+    if (obs[0]<'0'||'9'<obs[0]||obs[1]<'A'||'Z'<obs[1]) return 0;
+    return (copt->sigmsk[i][obs[0]-'0']>>(obs[1]-'A'))&1u;
+}
 /* extract unsigned/signed bits ------------------------------------------------
 * extract unsigned/signed bits from byte data
 * args   : uint8_t *buff    I   byte data
@@ -1588,7 +1699,7 @@ extern double timediff(gtime_t t1, gtime_t t2)
 * args   : none
 * return : current time in utc
 *-----------------------------------------------------------------------------*/
-static double timeoffset_=0.0;        /* time offset (s) */
+static THREADLOCAL double timeoffset_=0.0; /* time offset (s) */
 
 extern gtime_t timeget(void)
 {
@@ -1600,16 +1711,17 @@ extern gtime_t timeget(void)
     GetSystemTime(&ts); /* utc */
     ep[0]=ts.wYear; ep[1]=ts.wMonth;  ep[2]=ts.wDay;
     ep[3]=ts.wHour; ep[4]=ts.wMinute; ep[5]=ts.wSecond+ts.wMilliseconds*1E-3;
+    time=epoch2time(ep);
 #else
     struct timeval tv;
-    struct tm *tt;
     
-    if (!gettimeofday(&tv,NULL)&&(tt=gmtime(&tv.tv_sec))) {
-        ep[0]=tt->tm_year+1900; ep[1]=tt->tm_mon+1; ep[2]=tt->tm_mday;
-        ep[3]=tt->tm_hour; ep[4]=tt->tm_min; ep[5]=tt->tm_sec+tv.tv_usec*1E-6;
+    /* avoid gmtime() (not reentrant) */
+    if (!gettimeofday(&tv,NULL)) {
+        time.time=tv.tv_sec;
+        time.sec=tv.tv_usec*1E-6;
     }
+    else time=epoch2time(ep);
 #endif
-    time=epoch2time(ep);
     
 #ifdef CPUTIME_IN_GPST /* cputime operated in gpst */
     time=gpst2utc(time);
@@ -1621,8 +1733,8 @@ extern gtime_t timeget(void)
 * args   : gtime_t          I   current time in utc
 * return : none
 * notes  : just set time offset between cpu time and current time
-*          the time offset is reflected to only timeget()
-*          not reentrant
+*          the time offset is reflected to only timeget() of the calling
+*          thread, so each server thread may follow its own input time
 *-----------------------------------------------------------------------------*/
 extern void timeset(gtime_t t)
 {
@@ -1632,6 +1744,7 @@ extern void timeset(gtime_t t)
 * reset current time
 * args   : none
 * return : none
+* notes  : reset time offset of the calling thread
 *-----------------------------------------------------------------------------*/
 extern void timereset(void)
 {
@@ -1817,10 +1930,11 @@ extern void time2str(gtime_t t, char *s, int n)
 *          int    n         I   number of decimals
 * return : time string
 * notes  : not reentrant, do not use multiple in a function
+*          the string buffer is allocated for each thread
 *-----------------------------------------------------------------------------*/
 extern char *time_str(gtime_t t, int n)
 {
-    static char buff[64];
+    static THREADLOCAL char buff[64];
     time2str(t,buff,n);
     return buff;
 }
@@ -1894,6 +2008,459 @@ extern void sleepms(int ms)
     nanosleep(&ts,NULL);
 #endif
 }
+/* get number of processors ----------------------------------------------------
+* get number of online processors
+* args   : none
+* return : number of processors (>=1)
+*-----------------------------------------------------------------------------*/
+extern int getncpu(void)
+{
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors>0?(int)info.dwNumberOfProcessors:1;
+#else
+    long n=sysconf(_SC_NPROCESSORS_ONLN);
+    return n>0?(int)n:1;
+#endif
+}
+/* get profile tick ------------------------------------------------------------
+* get current tick of monotonic clock for stage profiling
+* args   : none
+* return : current tick (us)
+*-----------------------------------------------------------------------------*/
+extern double prftick(void)
+{
+#ifdef WIN32
+    LARGE_INTEGER cnt,frq;
+    
+    QueryPerformanceCounter(&cnt);
+    QueryPerformanceFrequency(&frq);
+    return (double)cnt.QuadPart*1E6/(double)frq.QuadPart;
+#else
+    struct timespec tp={0};
+    
+    clock_gettime(CLOCK_MONOTONIC,&tp);
+    return tp.tv_sec*1E6+tp.tv_nsec*1E-3;
+#endif
+}
+/* add profile stage time ------------------------------------------------------
+* add time of a call to profile stage
+* args   : prof_t *prof     IO  stage profile
+*          int    stage     I   profile stage (PRF_???)
+*          double t         I   time of stage (us) (difference of prftick())
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void prfadd(prof_t *prof, int stage, double t)
+{
+    prfstage_t *s;
+    uint32_t u;
+    int i;
+    
+    if (stage<0||stage>=NPRFSTAGE) return;
+    s=prof->stage+stage;
+    if (t<0.0) t=0.0;
+    for (i=0,u=(uint32_t)(t<1E9?t:1E9);u&&i<NPRFBIN-1;u>>=1) i++;
+    s->n++;
+    s->sum+=t;
+    if (t>s->max) s->max=t;
+    s->hist[i]++;
+}
+/* merge stage profiles --------------------------------------------------------
+* add stage profile to another
+* args   : prof_t *dst      IO  stage profile
+*          prof_t *src      I   stage profile to be added
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void prfmerge(prof_t *dst, const prof_t *src)
+{
+    int i,j;
+    
+    for (i=0;i<NPRFSTAGE;i++) {
+        dst->stage[i].n+=src->stage[i].n;
+        dst->stage[i].sum+=src->stage[i].sum;
+        if (src->stage[i].max>dst->stage[i].max) {
+            dst->stage[i].max=src->stage[i].max;
+        }
+        for (j=0;j<NPRFBIN;j++) dst->stage[i].hist[j]+=src->stage[i].hist[j];
+    }
+}
+/* quantile of profile stage time ----------------------------------------------
+* estimate quantile of stage time from histogram
+* args   : prfstage_t *stage I  profile stage
+*          double p         I   probability (0-1)
+* return : upper bound of histogram bin including quantile (us) (0.0: no data)
+*-----------------------------------------------------------------------------*/
+extern double prfquant(const prfstage_t *stage, double p)
+{
+    double c=0.0,m=p*stage->n,q;
+    int i;
+    
+    if (stage->n<=0) return 0.0;
+    for (i=0;i<NPRFBIN-1;i++) {
+        if ((c+=stage->hist[i])<m) continue;
+        q=ldexp(1.0,i);
+        return q<stage->max?q:stage->max;
+    }
+    return stage->max;
+}
+/* stage profile to string -----------------------------------------------------
+* output summary of stage profile to string
+* args   : prof_t *prof     I   stage profile
+*          char   *prefix   I   prefix of each line
+*          char   *buff     O   output string ((NPRFSTAGE+1)*(strlen(prefix)+96))
+* return : number of output bytes
+* notes  : stages without call are not output
+*-----------------------------------------------------------------------------*/
+extern int prf2str(const prof_t *prof, const char *prefix, char *buff)
+{
+    const char *names[]={
+        "pntpos","satposs","zdres","ddres","filter","lambda","holdamb",
+        "valpos","ppp_res","ppp_ar","read","decode"
+    };
+    const prfstage_t *s;
+    char *p=buff;
+    int i;
+    
+    p+=sprintf(p,"%s%-8s %9s %11s %9s %9s %9s %9s %9s\n",prefix,"stage",
+               "calls","total(ms)","mean(us)","p50(us)","p90(us)","p99(us)",
+               "max(us)");
+    for (i=0;i<NPRFSTAGE;i++) {
+        s=prof->stage+i;
+        if (s->n<=0) continue;
+        p+=sprintf(p,"%s%-8s %9u %11.3f %9.1f %9.0f %9.0f %9.0f %9.1f\n",prefix,
+                   names[i],s->n,s->sum*1E-3,s->sum/s->n,prfquant(s,0.5),
+                   prfquant(s,0.9),prfquant(s,0.99),s->max);
+    }
+    return (int)(p-buff);
+}
+/* map file to memory ----------------------------------------------------------
+* map whole file to memory for read-only access
+* args   : char   *file     I   file path
+*          size_t *size     O   file size (bytes)
+* return : pointer to mapped file (NULL: open error, map error or empty file)
+* notes  : the mapped region should be released by unmapfile()
+*-----------------------------------------------------------------------------*/
+extern void *mapfile(const char *file, size_t *size)
+{
+#ifdef WIN32
+    HANDLE hf,hm;
+    LARGE_INTEGER len;
+    void *p=NULL;
+    
+    *size=0;
+    hf=CreateFile(file,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,
+                  FILE_ATTRIBUTE_NORMAL,NULL);
+    if (hf==INVALID_HANDLE_VALUE) return NULL;
+    if (!GetFileSizeEx(hf,&len)||len.QuadPart<=0||
+        (uint64_t)len.QuadPart!=(uint64_t)(size_t)len.QuadPart) {
+        CloseHandle(hf);
+        return NULL;
+    }
+    if ((hm=CreateFileMapping(hf,NULL,PAGE_READONLY,0,0,NULL))) {
+        p=MapViewOfFile(hm,FILE_MAP_READ,0,0,0);
+        CloseHandle(hm);
+    }
+    CloseHandle(hf);
+    if (p) *size=(size_t)len.QuadPart;
+    return p;
+#else
+    struct stat st;
+    void *p;
+    int fd;
+    
+    *size=0;
+    if ((fd=open(file,O_RDONLY))<0) return NULL;
+    if (fstat(fd,&st)||st.st_size<=0||
+        (p=mmap(NULL,(size_t)st.st_size,PROT_READ,MAP_PRIVATE,fd,0))==MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    *size=(size_t)st.st_size;
+    return p;
+#endif
+}
+/* unmap file ------------------------------------------------------------------
+* release memory mapped by mapfile()
+* args   : void   *p        I   pointer to mapped file
+*          size_t size      I   file size (bytes)
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void unmapfile(void *p, size_t size)
+{
+    if (!p) return;
+#ifdef WIN32
+    UnmapViewOfFile(p);
+#else
+    munmap(p,size);
+#endif
+}
+/* binary cache of parsed input files ------------------------------------------
+* cache file layout (native byte order, 8-byte aligned):
+*   header  : magic "RTKCACHE", version, key length, source file mtime and size
+*   key     : cache key string (source path, read options and data layout)
+*   section : id, element size, number of elements, element data ...
+*-----------------------------------------------------------------------------*/
+#define CACHEID     "RTKCACHE"          /* cache file magic */
+#define CACHEVER    1                   /* cache format version */
+#define CACHEEXT    ".rtc"              /* cache file extension */
+#define PAD8(n)     (((n)+7)&~(size_t)7) /* size padded to 8 bytes */
+
+typedef struct {                        /* cache file header type */
+    char magic[8];                      /* magic (CACHEID) */
+    int ver,keylen;                     /* version, key length */
+    double mtime,size;                  /* source file mtime and size */
+} cacheh_t;
+
+static int  cache_ena=0;                /* cache enable flag */
+static char cache_dir[1024]="";         /* cache directory ("": input dir) */
+
+/* set binary cache ------------------------------------------------------------
+* enable or disable binary cache of parsed input files
+* args   : int    ena       I   enable flag (0:off,1:on)
+*          char   *dir      I   cache directory ("": same as input file)
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void setcache(int ena, const char *dir)
+{
+    trace(3,"setcache: ena=%d dir=%s\n",ena,dir);
+    
+    cache_ena=ena;
+    sprintf(cache_dir,"%.1023s",dir);
+}
+/* modified time and size of file --------------------------------------------*/
+static int filestat(const char *file, double *mtime, double *size)
+{
+#ifdef WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    
+    if (!GetFileAttributesEx(file,GetFileExInfoStandard,&attr)) return 0;
+    *mtime=attr.ftLastWriteTime.dwHighDateTime*4294967296.0+
+           attr.ftLastWriteTime.dwLowDateTime;
+    *size=attr.nFileSizeHigh*4294967296.0+attr.nFileSizeLow;
+#else
+    struct stat st;
+    
+    if (stat(file,&st)) return 0;
+    *mtime=(double)st.st_mtime;
+    *size=(double)st.st_size;
+#endif
+    return 1;
+}
+/* cache file path (0:path too long) ----------------------------------------*/
+static int cachepath(const char *file, const char *key, char *path,
+                     size_t size)
+{
+    const char *p,*dir;
+    uint32_t hash=2166136261u; /* FNV-1a */
+    size_t ndir,nsep,nname;
+    
+    for (p=key;*p;p++) hash=(hash^(uint8_t)*p)*16777619u;
+    
+    if (!(p=strrchr(file,FILEPATHSEP))) p=file; else p++;
+    
+    if (*cache_dir) {
+        dir=cache_dir; ndir=strlen(cache_dir); nsep=1;
+    }
+    else {
+        dir=file; ndir=(size_t)(p-file); nsep=0;
+    }
+    nname=strlen(p);
+    
+    /* dir + sep + name + .hash + ext + .pid.id.tmp of temporary file */
+    if (ndir+nsep+nname+9+strlen(CACHEEXT)+42>=size) return 0;
+    
+    memcpy(path,dir,ndir);
+    if (nsep) path[ndir]=FILEPATHSEP;
+    memcpy(path+ndir+nsep,p,nname);
+    sprintf(path+ndir+nsep+nname,".%08x%s",(unsigned int)hash,CACHEEXT);
+    return 1;
+}
+/* create temporary cache file unique to writer -----------------------------*/
+static FILE *opencachetmp(cache_t *cache)
+{
+    FILE *fp;
+    unsigned long pid,id;
+    int i,fd;
+    
+#ifdef WIN32
+    pid=(unsigned long)GetCurrentProcessId();
+#else
+    pid=(unsigned long)getpid();
+#endif
+    /* cache object address is unique among writers in process */
+    id=(unsigned long)(size_t)cache;
+    
+    for (i=0;i<16;i++) {
+        sprintf(cache->tmpfile,"%.981s.%lu.%lx.tmp",cache->file,pid,id+i);
+#ifdef WIN32
+        fd=_open(cache->tmpfile,_O_WRONLY|_O_CREAT|_O_EXCL|_O_BINARY,
+                 _S_IREAD|_S_IWRITE);
+        if (fd>=0) {
+            if (!(fp=_fdopen(fd,"wb"))) _close(fd);
+            return fp;
+        }
+#else
+        fd=open(cache->tmpfile,O_WRONLY|O_CREAT|O_EXCL,0644);
+        if (fd>=0) {
+            if (!(fp=fdopen(fd,"wb"))) close(fd);
+            return fp;
+        }
+#endif
+        if (errno!=EEXIST) break;
+    }
+    return NULL;
+}
+/* open binary cache -----------------------------------------------------------
+* open binary cache of parsed input file. if valid cache exists, map it for
+* reading by getcache(). otherwise create new cache for writing by putcache().
+* args   : char    *file    I   input file path
+*          char    *key     I   cache key (read options)
+*          cache_t *cache   O   cache
+* return : status (1:valid cache mapped,0:no valid cache)
+* notes  : cache is invalidated by modified time or size of input file, read
+*          options, cache format version or data layout of the build.
+*          the cache shall be closed by closecache() in any case.
+*          new cache is written to temporary file unique to the writer (process
+*          id and cache address) and published by atomic rename in
+*          closecache(), so concurrent writers of same cache do not corrupt it.
+*-----------------------------------------------------------------------------*/
+extern int opencache(const char *file, const char *key, cache_t *cache)
+{
+    static const char pad[8]={0};
+    cacheh_t h={{0}};
+    const cacheh_t *p;
+    char buff[2048];
+    double mtime,size;
+    size_t len;
+    
+    memset(cache,0,sizeof(cache_t));
+    
+    if (!cache_ena||!filestat(file,&mtime,&size)) return 0;
+    
+    sprintf(buff,"%.1023s|%.511s|%d %d %d %d %d %d %d %d %d %d %d",file,key,
+            MAXSAT,NFREQ,NEXOBS,(int)sizeof(gtime_t),(int)sizeof(obsd_t),
+            (int)sizeof(eph_t),(int)sizeof(geph_t),(int)sizeof(seph_t),
+            (int)sizeof(peph_t),(int)sizeof(pclk_t),(int)sizeof(pcv_t));
+    len=strlen(buff);
+    if (!cachepath(file,buff,cache->file,sizeof(cache->file))) {
+        trace(2,"cache path too long: %s\n",file);
+        return 0;
+    }
+    
+    /* map and validate cache */
+    if ((cache->buff=(char *)mapfile(cache->file,&cache->size))) {
+        p=(const cacheh_t *)cache->buff;
+        cache->pos=sizeof(cacheh_t)+PAD8(len);
+        
+        if (cache->size>=cache->pos&&!memcmp(p->magic,CACHEID,8)&&
+            p->ver==CACHEVER&&p->keylen==(int)len&&p->mtime==mtime&&
+            p->size==size&&!memcmp(p+1,buff,len)) {
+            trace(3,"opencache: cache=%s\n",cache->file);
+            return 1;
+        }
+        unmapfile(cache->buff,cache->size);
+        cache->buff=NULL;
+        cache->size=cache->pos=0;
+    }
+    /* create new cache */
+    if (!(cache->fp=opencachetmp(cache))) {
+        trace(2,"cache file open error: %s\n",cache->tmpfile);
+        return 0;
+    }
+    memcpy(h.magic,CACHEID,8);
+    h.ver=CACHEVER;
+    h.keylen=(int)len;
+    h.mtime=mtime;
+    h.size=size;
+    if (fwrite(&h,sizeof(h),1,cache->fp)<1||fwrite(buff,len,1,cache->fp)<1||
+        (PAD8(len)>len&&fwrite(pad,PAD8(len)-len,1,cache->fp)<1)) {
+        closecache(cache,0);
+    }
+    return 0;
+}
+/* get section of binary cache -------------------------------------------------
+* get next section of binary cache mapped by opencache()
+* args   : cache_t *cache   IO  cache
+*          int     id       I   section id
+*          size_t  size     I   element size (bytes)
+*          int     *n       O   number of elements
+* return : pointer to elements (NULL: no section or error)
+*-----------------------------------------------------------------------------*/
+extern const void *getcache(cache_t *cache, int id, size_t size, int *n)
+{
+    const int *p;
+    size_t len;
+    
+    *n=0;
+    if (!cache->buff||cache->pos+sizeof(int)*4>cache->size) return NULL;
+    p=(const int *)(cache->buff+cache->pos);
+    if (p[0]!=id||p[1]!=(int)size||p[2]<0) return NULL;
+    len=PAD8(size*(size_t)p[2]);
+    if (cache->pos+sizeof(int)*4+len>cache->size) return NULL;
+    cache->pos+=sizeof(int)*4+len;
+    *n=p[2];
+    return p+4;
+}
+/* put section to binary cache -------------------------------------------------
+* append section to binary cache created by opencache()
+* args   : cache_t *cache   IO  cache
+*          int     id       I   section id
+*          void    *data    I   elements
+*          size_t  size     I   element size (bytes)
+*          int     n        I   number of elements
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void putcache(cache_t *cache, int id, const void *data, size_t size,
+                     int n)
+{
+    static const char pad[8]={0};
+    size_t len=size*(size_t)n;
+    int h[4];
+    
+    if (!cache->fp) return;
+    
+    h[0]=id; h[1]=(int)size; h[2]=n; h[3]=0;
+    if (fwrite(h,sizeof(h),1,cache->fp)<1||
+        (len>0&&fwrite(data,len,1,cache->fp)<1)||
+        (PAD8(len)>len&&fwrite(pad,PAD8(len)-len,1,cache->fp)<1)) {
+        trace(2,"cache file write error: %s\n",cache->tmpfile);
+        closecache(cache,0);
+    }
+}
+/* close binary cache ----------------------------------------------------------
+* close binary cache opened by opencache()
+* args   : cache_t *cache   IO  cache
+*          int     commit   I   commit new cache (0:discard,1:commit,
+*                               -1:delete mapped cache as invalid)
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void closecache(cache_t *cache, int commit)
+{
+    if (cache->buff) {
+        unmapfile(cache->buff,cache->size);
+        cache->buff=NULL;
+        if (commit<0) {
+            trace(2,"invalid cache file: %s\n",cache->file);
+            remove(cache->file);
+        }
+    }
+    if (cache->fp) {
+        if (fclose(cache->fp)) commit=0;
+        cache->fp=NULL;
+        /* publish cache by atomic replace */
+        if (commit) {
+#ifdef WIN32
+            if (!MoveFileEx(cache->tmpfile,cache->file,
+                            MOVEFILE_REPLACE_EXISTING)) commit=0;
+#else
+            if (rename(cache->tmpfile,cache->file)) commit=0;
+#endif
+        }
+        if (!commit) remove(cache->tmpfile);
+    }
+}
 /* convert degree to deg-min-sec -----------------------------------------------
 * convert degree to degree-minute-second
 * args   : double deg       I   degree
@@ -2038,29 +2605,162 @@ extern void covecef(const double *pos, const double *Q, double *P)
     matmul("TN",3,3,3,1.0,E,Q,0.0,EQ);
     matmul("NN",3,3,3,1.0,EQ,E,0.0,P);
 }
-/* coordinate rotation matrix ------------------------------------------------*/
-#define Rx(t,X) do { \
-    (X)[0]=1.0; (X)[1]=(X)[2]=(X)[3]=(X)[6]=0.0; \
-    (X)[4]=(X)[8]=cos(t); (X)[7]=sin(t); (X)[5]=-(X)[7]; \
-} while (0)
-
-#define Ry(t,X) do { \
-    (X)[4]=1.0; (X)[1]=(X)[3]=(X)[5]=(X)[7]=0.0; \
-    (X)[0]=(X)[8]=cos(t); (X)[2]=sin(t); (X)[6]=-(X)[2]; \
-} while (0)
-
-#define Rz(t,X) do { \
-    (X)[8]=1.0; (X)[2]=(X)[5]=(X)[6]=(X)[7]=0.0; \
-    (X)[0]=(X)[4]=cos(t); (X)[3]=sin(t); (X)[1]=-(X)[3]; \
-} while (0)
+/* transform ecef to geodetic positions ----------------------------------------
+* transform ecef positions to geodetic positions (structure of arrays)
+* args   : double *x,*y,*z  I   ecef positions {x,y,z} (m) (n x 1)
+*          int    n         I   number of positions
+*          double *lat,*lon,*h O geodetic positions {lat,lon,h} (rad,m) (n x 1)
+* return : none
+* notes  : WGS84, ellipsoidal height
+*          fixed number of iterations without branches for vectorization.
+*          difference to ecef2pos() is less than 1E-6 m for terrestrial
+*          and orbital positions.
+*          output arrays should not overlap input arrays
+*-----------------------------------------------------------------------------*/
+#define NITR_ECEF2POS   5       /* number of iterations in ecef2pos_batch() */
 
-/* astronomical arguments: f={l,l',F,D,OMG} (rad) ----------------------------*/
-static void ast_args(double t, double *f)
+extern void ecef2pos_batch(const double *x, const double *y, const double *z,
+                           int n, double *lat, double *lon, double *h)
 {
-    static const double fc[][5]={ /* coefficients for iau 1980 nutation */
-        { 134.96340251, 1717915923.2178,  31.8792,  0.051635, -0.00024470},
-        { 357.52910918,  129596581.0481,  -0.5532,  0.000136, -0.00001149},
-        {  93.27209062, 1739527262.8478, -12.7512, -0.001037,  0.00000417},
+    double e2=FE_WGS84*(2.0-FE_WGS84),r2,zk,v,sinp;
+    int i,j;
+    
+    /* iterations for z+dz stored in lat (no library call) */
+    for (i=0;i<n;i++) {
+        r2=x[i]*x[i]+y[i]*y[i];
+        for (j=0,zk=z[i],v=RE_WGS84;j<NITR_ECEF2POS;j++) {
+            sinp=r2+zk*zk>0.0?zk/sqrt(r2+zk*zk):0.0; /* origin: h=-RE */
+            v=RE_WGS84/sqrt(1.0-e2*sinp*sinp);
+            zk=z[i]+v*e2*sinp;
+        }
+        lat[i]=zk;
+        h[i]=sqrt(r2+zk*zk)-v;
+    }
+    for (i=0;i<n;i++) {
+        r2=x[i]*x[i]+y[i]*y[i];
+        lat[i]=r2>1E-12?atan(lat[i]/sqrt(r2)):(z[i]>0.0?PI/2.0:-PI/2.0);
+        lon[i]=r2>1E-12?atan2(y[i],x[i]):0.0;
+    }
+}
+/* transform geodetic to ecef positions ----------------------------------------
+* transform geodetic positions to ecef positions (structure of arrays)
+* args   : double *lat,*lon,*h I geodetic positions {lat,lon,h} (rad,m) (n x 1)
+*          int    n         I   number of positions
+*          double *x,*y,*z  O   ecef positions {x,y,z} (m) (n x 1)
+* return : none
+* notes  : WGS84, ellipsoidal height. same results as pos2ecef()
+*-----------------------------------------------------------------------------*/
+extern void pos2ecef_batch(const double *lat, const double *lon,
+                           const double *h, int n, double *x, double *y,
+                           double *z)
+{
+    double e2=FE_WGS84*(2.0-FE_WGS84),sinp,cosp,sinl,cosl,v,hi;
+    int i;
+    
+    for (i=0;i<n;i++) {
+        sinp=sin(lat[i]); cosp=cos(lat[i]); sinl=sin(lon[i]); cosl=cos(lon[i]);
+        v=RE_WGS84/sqrt(1.0-e2*sinp*sinp);
+        hi=h[i];
+        x[i]=(v+hi)*cosp*cosl;
+        y[i]=(v+hi)*cosp*sinl;
+        z[i]=(v*(1.0-e2)+hi)*sinp;
+    }
+}
+/* transform ecef vectors to local tangental coordinate ------------------------
+* transform ecef vectors to local tangental coordinate (structure of arrays)
+* args   : double *lat,*lon I   geodetic positions {lat,lon} (rad) (n x 1)
+*          double *x,*y,*z  I   vectors in ecef coordinate {x,y,z} (n x 1)
+*          int    n         I   number of vectors
+*          double *e,*nn,*u O   vectors in local tangental coordinate {e,n,u}
+*                               (n x 1)
+* return : none
+* notes  : same results as ecef2enu()
+*-----------------------------------------------------------------------------*/
+extern void ecef2enu_batch(const double *lat, const double *lon,
+                           const double *x, const double *y, const double *z,
+                           int n, double *e, double *nn, double *u)
+{
+    double sinp,cosp,sinl,cosl,xi,yi,zi;
+    int i;
+    
+    for (i=0;i<n;i++) {
+        sinp=sin(lat[i]); cosp=cos(lat[i]); sinl=sin(lon[i]); cosl=cos(lon[i]);
+        xi=x[i]; yi=y[i]; zi=z[i];
+        e [i]=-sinl*xi+cosl*yi;
+        nn[i]=-sinp*cosl*xi+(-sinp*sinl)*yi+cosp*zi;
+        u [i]=cosp*cosl*xi+cosp*sinl*yi+sinp*zi;
+    }
+}
+/* transform covariances to local tangental coordinate -------------------------
+* transform ecef covariances to local tangental coordinate (structure of arrays)
+* args   : double *lat,*lon I   geodetic positions {lat,lon} (rad) (n x 1)
+*          double *P        I   covariances in ecef coordinate (6 x n)
+*                               {xx(n),yy(n),zz(n),xy(n),yz(n),zx(n)}
+*          int    n         I   number of covariances
+*          double *Q        O   covariances in local tangental coordinate
+*                               (6 x n) {ee(n),nn(n),uu(n),en(n),nu(n),ue(n)}
+* return : none
+* notes  : same element order as sol_t qr. same results as covenu() for
+*          symmetric P
+*-----------------------------------------------------------------------------*/
+extern void covenu_batch(const double *lat, const double *lon, const double *P,
+                         int n, double *Q)
+{
+    const double *xx=P,*yy=P+n,*zz=P+2*n,*xy=P+3*n,*yz=P+4*n,*zx=P+5*n;
+    double sinp,cosp,sinl,cosl,a[2],b[3],c[3],pe[3],pn[3],pu[3];
+    int i;
+    
+    for (i=0;i<n;i++) {
+        sinp=sin(lat[i]); cosp=cos(lat[i]); sinl=sin(lon[i]); cosl=cos(lon[i]);
+    
+        /* rows of ecef to local transformation matrix E */
+        a[0]=-sinl;      a[1]=cosl;
+        b[0]=-sinp*cosl; b[1]=-sinp*sinl; b[2]=cosp;
+        c[0]=cosp*cosl;  c[1]=cosp*sinl;  c[2]=sinp;
+    
+        /* E*P */
+        pe[0]=a[0]*xx[i]+a[1]*xy[i];
+        pe[1]=a[0]*xy[i]+a[1]*yy[i];
+        pe[2]=a[0]*zx[i]+a[1]*yz[i];
+        pn[0]=b[0]*xx[i]+b[1]*xy[i]+b[2]*zx[i];
+        pn[1]=b[0]*xy[i]+b[1]*yy[i]+b[2]*yz[i];
+        pn[2]=b[0]*zx[i]+b[1]*yz[i]+b[2]*zz[i];
+        pu[0]=c[0]*xx[i]+c[1]*xy[i]+c[2]*zx[i];
+        pu[1]=c[0]*xy[i]+c[1]*yy[i]+c[2]*yz[i];
+        pu[2]=c[0]*zx[i]+c[1]*yz[i]+c[2]*zz[i];
+    
+        /* E*P*E' */
+        Q[    i]=pe[0]*a[0]+pe[1]*a[1];
+        Q[  n+i]=pn[0]*b[0]+pn[1]*b[1]+pn[2]*b[2];
+        Q[2*n+i]=pu[0]*c[0]+pu[1]*c[1]+pu[2]*c[2];
+        Q[3*n+i]=pn[0]*a[0]+pn[1]*a[1];
+        Q[4*n+i]=pu[0]*b[0]+pu[1]*b[1]+pu[2]*b[2];
+        Q[5*n+i]=pu[0]*a[0]+pu[1]*a[1];
+    }
+}
+/* coordinate rotation matrix ------------------------------------------------*/
+#define Rx(t,X) do { \
+    (X)[0]=1.0; (X)[1]=(X)[2]=(X)[3]=(X)[6]=0.0; \
+    (X)[4]=(X)[8]=cos(t); (X)[7]=sin(t); (X)[5]=-(X)[7]; \
+} while (0)
+
+#define Ry(t,X) do { \
+    (X)[4]=1.0; (X)[1]=(X)[3]=(X)[5]=(X)[7]=0.0; \
+    (X)[0]=(X)[8]=cos(t); (X)[2]=sin(t); (X)[6]=-(X)[2]; \
+} while (0)
+
+#define Rz(t,X) do { \
+    (X)[8]=1.0; (X)[2]=(X)[5]=(X)[6]=(X)[7]=0.0; \
+    (X)[0]=(X)[4]=cos(t); (X)[3]=sin(t); (X)[1]=-(X)[3]; \
+} while (0)
+
+/* astronomical arguments: f={l,l',F,D,OMG} (rad) ----------------------------*/
+static void ast_args(double t, double *f)
+{
+    static const double fc[][5]={ /* coefficients for iau 1980 nutation */
+        { 134.96340251, 1717915923.2178,  31.8792,  0.051635, -0.00024470},
+        { 357.52910918,  129596581.0481,  -0.5532,  0.000136, -0.00001149},
+        {  93.27209062, 1739527262.8478, -12.7512, -0.001037,  0.00000417},
         { 297.85019547, 1602961601.2090,  -6.3706,  0.006593, -0.00003169},
         { 125.04455501,   -6962890.2665,   7.4722,  0.007702, -0.00005939}
     };
@@ -2208,13 +2908,13 @@ static void nut_iau1980(double t, const double *f, double *dpsi, double *deps)
 *                               (NULL: no output)
 * return : none
 * note   : see ref [3] chap 5
-*          not thread-safe
+*          the last result is cached for each thread
 *-----------------------------------------------------------------------------*/
 extern void eci2ecef(gtime_t tutc, const double *erpv, double *U, double *gmst)
 {
     const double ep2000[]={2000,1,1,12,0,0};
-    static gtime_t tutc_;
-    static double U_[9],gmst_;
+    static THREADLOCAL gtime_t tutc_;
+    static THREADLOCAL double U_[9],gmst_;
     gtime_t tgps;
     double eps,ze,th,z,t,t2,t3,dpsi,deps,gast,f[5];
     double R1[9],R2[9],R3[9],R[9],W[9],N[9],P[9],NP[9];
@@ -2430,20 +3130,40 @@ static int readantex(const char *file, pcvs_t *pcvs)
 *-----------------------------------------------------------------------------*/
 extern int readpcv(const char *file, pcvs_t *pcvs)
 {
+    cache_t cache;
+    const pcv_t *pcv0;
+    const int *p;
     pcv_t *pcv;
     char *ext;
-    int i,stat;
+    int i,n,m=pcvs->n,stat;
     
     trace(3,"readpcv: file=%s\n",file);
     
     if (!(ext=strrchr(file,'.'))) ext="";
     
+    /* read antenna parameters from cache */
+    if (opencache(file,"pcv",&cache)) {
+        if ((p=(const int *)getcache(&cache,1,sizeof(int),&n))&&n==1&&
+            (pcv0=(const pcv_t *)getcache(&cache,2,sizeof(pcv_t),&n))) {
+            for (i=0;i<n;i++) addpcv(pcv0+i,pcvs);
+            stat=*p;
+            closecache(&cache,0);
+            return stat;
+        }
+        closecache(&cache,-1);
+        opencache(file,"pcv",&cache);
+    }
     if (!strcmp(ext,".atx")||!strcmp(ext,".ATX")) {
         stat=readantex(file,pcvs);
     }
     else {
         stat=readngspcv(file,pcvs);
     }
+    if (pcvs->n>=m) {
+        putcache(&cache,1,&stat,sizeof(int),1);
+        putcache(&cache,2,pcvs->pcv+m,sizeof(pcv_t),pcvs->n-m);
+    }
+    closecache(&cache,pcvs->n>=m);
     for (i=0;i<pcvs->n;i++) {
         pcv=pcvs->pcv+i;
         trace(4,"sat=%2d type=%20s code=%s off=%8.4f %8.4f %8.4f  %8.4f %8.4f %8.4f\n",
@@ -2511,11 +3231,10 @@ extern pcv_t *searchpcv(int sat, const char *type, gtime_t time,
 *-----------------------------------------------------------------------------*/
 extern void readpos(const char *file, const char *rcv, double *pos)
 {
-    static double poss[2048][3];
-    static char stas[2048][16];
     FILE *fp;
-    int i,j,len,np=0;
-    char buff[256],str[256];
+    double poss[3];
+    int j,len=(int)strlen(rcv),np=0;
+    char buff[256],str[256],sta[16];
     
     trace(3,"readpos: file=%s\n",file);
     
@@ -2525,18 +3244,15 @@ extern void readpos(const char *file, const char *rcv, double *pos)
     }
     while (np<2048&&fgets(buff,sizeof(buff),fp)) {
         if (buff[0]=='%'||buff[0]=='#') continue;
-        if (sscanf(buff,"%lf %lf %lf %s",&poss[np][0],&poss[np][1],&poss[np][2],
-                   str)<4) continue;
-        sprintf(stas[np++],"%.15s",str);
-    }
-    fclose(fp);
-    len=(int)strlen(rcv);
-    for (i=0;i<np;i++) {
-        if (strncmp(stas[i],rcv,len)) continue;
-        for (j=0;j<3;j++) pos[j]=poss[i][j];
+        if (sscanf(buff,"%lf %lf %lf %s",poss,poss+1,poss+2,str)<4) continue;
+        sprintf(sta,"%.15s",str); np++;
+        if (strncmp(sta,rcv,len)) continue;
+        for (j=0;j<3;j++) pos[j]=poss[j];
         pos[0]*=D2R; pos[1]*=D2R;
+        fclose(fp);
         return;
     }
+    fclose(fp);
     pos[0]=pos[1]=pos[2]=0.0;
 }
 /* read blq record -----------------------------------------------------------*/
@@ -2804,7 +3520,7 @@ static void uniqseph(nav_t *nav)
     trace(4,"uniqseph: ns=%d\n",nav->ns);
 }
 /* unique ephemerides ----------------------------------------------------------
-* unique ephemerides in navigation data and update carrier wave length
+* unique ephemerides in navigation data and resolve GLONASS FCN
 * args   : nav_t *nav    IO     navigation data
 * return : number of epochs
 *-----------------------------------------------------------------------------*/
@@ -2816,6 +3532,32 @@ extern void uniqnav(nav_t *nav)
     uniqeph (nav);
     uniqgeph(nav);
     uniqseph(nav);
+    
+    /* resolve GLONASS FCN */
+    updatefcn(nav);
+}
+/* update GLONASS frequency channel numbers ------------------------------------
+* resolve GLONASS FCN of each slot from navigation data for sat2freq()
+* args   : nav_t *nav    IO     navigation data
+* return : none
+* notes  : FCN of the first ephemeris of the slot precedes nav->glo_fcn[].
+*          call it after updating nav->geph[] or nav->glo_fcn[]
+*-----------------------------------------------------------------------------*/
+extern void updatefcn(nav_t *nav)
+{
+    int i,prn,done[32]={0};
+    
+    for (i=0;i<nav->ng;i++) {
+        if (satsys(nav->geph[i].sat,&prn)!=SYS_GLO||prn>32||done[prn-1]) {
+            continue;
+        }
+        nav->glo_frq[prn-1]=nav->geph[i].frq+8;
+        done[prn-1]=1;
+    }
+    for (i=0;i<32;i++) {
+        if (!done[i]) nav->glo_frq[i]=nav->glo_fcn[i]>0?nav->glo_fcn[i]:0;
+        if (nav->glo_frq[i]<0) nav->glo_frq[i]=0;
+    }
 }
 /* compare observation data -------------------------------------------------*/
 static int cmpobs(const void *p1, const void *p2)
@@ -2826,20 +3568,65 @@ static int cmpobs(const void *p1, const void *p2)
     if (q1->rcv!=q2->rcv) return (int)q1->rcv-(int)q2->rcv;
     return (int)q1->sat-(int)q2->sat;
 }
+/* merge sorted runs of observation data ------------------------------------*/
+static int mergeobs(obs_t *obs, int *run, int nrun)
+{
+    obsd_t *buff,*src=obs->data,*dst,*tmp;
+    int i,j,k,m,n;
+    
+    if (!(buff=(obsd_t *)malloc(sizeof(obsd_t)*obs->n))) return 0;
+    dst=buff;
+    
+    for (;nrun>1;nrun=(nrun+1)/2) {
+        for (i=0;i<nrun;i+=2) {
+            if (i+1>=nrun) {
+                memcpy(dst+run[i],src+run[i],sizeof(obsd_t)*(run[i+1]-run[i]));
+                run[i/2]=run[i];
+                continue;
+            }
+            for (j=run[i],k=run[i+1],m=run[i+1],n=run[i];n<run[i+2];) {
+                if (k>=run[i+2]||(j<m&&cmpobs(src+j,src+k)<=0)) dst[n++]=src[j++];
+                else dst[n++]=src[k++];
+            }
+            run[i/2]=run[i];
+        }
+        run[(nrun+1)/2]=obs->n;
+        tmp=src; src=dst; dst=tmp;
+    }
+    if (src!=obs->data) {
+        memcpy(obs->data,src,sizeof(obsd_t)*obs->n);
+    }
+    free(buff);
+    return 1;
+}
 /* sort and unique observation data --------------------------------------------
 * sort and unique observation data by time, rcv, sat
 * args   : obs_t *obs    IO     observation data
 * return : number of epochs
+* notes  : data already in order or composed of a few sorted runs (e.g. files
+*          of receivers read by readrnxt()) are merged without full sort
 *-----------------------------------------------------------------------------*/
 extern int sortobs(obs_t *obs)
 {
-    int i,j,n;
+    int i,j,n,run[MAXOBSRUN+1];
     
     trace(3,"sortobs: nobs=%d\n",obs->n);
     
     if (obs->n<=0) return 0;
     
-    qsort(obs->data,obs->n,sizeof(obsd_t),cmpobs);
+    /* detect sorted runs */
+    for (i=1,n=0,run[0]=0;i<obs->n&&n<MAXOBSRUN;i++) {
+        if (cmpobs(obs->data+i-1,obs->data+i)>0) run[++n]=i;
+    }
+    if (n>=MAXOBSRUN) {
+        qsort(obs->data,obs->n,sizeof(obsd_t),cmpobs);
+    }
+    else if (n>0) {
+        run[++n]=obs->n;
+        if (!mergeobs(obs,run,n)) {
+            qsort(obs->data,obs->n,sizeof(obsd_t),cmpobs);
+        }
+    }
     
     /* delete duplicated data */
     for (i=j=0;i<obs->n;i++) {
@@ -2943,6 +3730,7 @@ extern int readnav(const char *file, nav_t *nav)
         }
     }
     fclose(fp);
+    updatefcn(nav);
     return 1;
 }
 extern int savenav(const char *file, const nav_t *nav)
@@ -3003,6 +3791,341 @@ extern void freeobs(obs_t *obs)
 {
     free(obs->data); obs->data=NULL; obs->n=obs->nmax=0;
 }
+/* resize compact observation data -------------------------------------------*/
+#define RESIZE(p,type,n) \
+    ((tmp=realloc(p,sizeof(type)*(n)))?((p)=(type *)tmp,1):0)
+
+static int resizeobsc(obsc_t *obsc, int ne, int n, int ns)
+{
+    void *tmp;
+    
+    if (ne>obsc->nemax) {
+        if (ne<2*obsc->nemax) ne=2*obsc->nemax;
+        if (ne<NINCOBSC/16) ne=NINCOBSC/16;
+        if (!RESIZE(obsc->time,gtime_t,ne)||!RESIZE(obsc->eventime,gtime_t,ne)||
+            !RESIZE(obsc->rcv,uint8_t,ne)||!RESIZE(obsc->timevalid,uint8_t,ne)||
+            !RESIZE(obsc->iobs,int,ne+1)) return 0;
+        obsc->nemax=ne;
+    }
+    if (n>obsc->nmax) {
+        if (n<2*obsc->nmax) n=2*obsc->nmax;
+        if (n<NINCOBSC/4) n=NINCOBSC/4;
+        if (!RESIZE(obsc->sat,uint8_t,n)||!RESIZE(obsc->freq,uint8_t,n)||
+            !RESIZE(obsc->isig,int,n+1)) return 0;
+        obsc->nmax=n;
+    }
+    if (ns>obsc->nsmax) {
+        if (ns<2*obsc->nsmax) ns=2*obsc->nsmax;
+        if (ns<NINCOBSC) ns=NINCOBSC;
+        if (!RESIZE(obsc->slot,uint8_t,ns)||!RESIZE(obsc->code,uint8_t,ns)||
+            !RESIZE(obsc->LLI,uint8_t,ns)||!RESIZE(obsc->qualL,uint8_t,ns)||
+            !RESIZE(obsc->qualP,uint8_t,ns)||!RESIZE(obsc->SNR,uint16_t,ns)||
+            !RESIZE(obsc->L,double,ns)||!RESIZE(obsc->P,double,ns)||
+            !RESIZE(obsc->D,float,ns)) return 0;
+        obsc->nsmax=ns;
+    }
+    return 1;
+}
+#undef RESIZE
+/* add observation data epoch to compact observation data ----------------------
+* add observation data records of an epoch to compact observation data. only
+* signal slots with any observable are stored.
+* args   : obsc_t *obsc     IO  compact observation data
+*          obsd_t *data     I   observation data records of an epoch
+*                               (same time and receiver)
+*          int    n         I   number of observation data records
+* return : status (1:ok,0:no data,-1:memory allocation error)
+*-----------------------------------------------------------------------------*/
+extern int addobsc(obsc_t *obsc, const obsd_t *data, int n)
+{
+    int i,j,ns;
+    
+    if (n<=0) return 0;
+    
+    for (i=ns=0;i<n;i++) for (j=0;j<NFREQ+NEXOBS;j++) {
+        if (data[i].L[j]!=0.0||data[i].P[j]!=0.0||data[i].D[j]!=0.0||
+            data[i].SNR[j]||data[i].LLI[j]||data[i].code[j]||data[i].qualL[j]||
+            data[i].qualP[j]) ns++;
+    }
+    if (!resizeobsc(obsc,obsc->ne+1,obsc->n+n,obsc->ns+ns)) {
+        trace(1,"addobsc: malloc error ne=%d n=%d ns=%d\n",obsc->ne,obsc->n,
+              obsc->ns);
+        freeobsc(obsc);
+        return -1;
+    }
+    obsc->time     [obsc->ne]=data[0].time;
+    obsc->eventime [obsc->ne]=data[0].eventime;
+    obsc->rcv      [obsc->ne]=data[0].rcv;
+    obsc->timevalid[obsc->ne]=(uint8_t)data[0].timevalid;
+    obsc->iobs     [obsc->ne]=obsc->n;
+    
+    for (i=0;i<n;i++) {
+        obsc->sat [obsc->n]=data[i].sat;
+        obsc->freq[obsc->n]=data[i].freq;
+        obsc->isig[obsc->n++]=obsc->ns;
+        
+        for (j=0;j<NFREQ+NEXOBS;j++) {
+            if (data[i].L[j]==0.0&&data[i].P[j]==0.0&&data[i].D[j]==0.0&&
+                !data[i].SNR[j]&&!data[i].LLI[j]&&!data[i].code[j]&&
+                !data[i].qualL[j]&&!data[i].qualP[j]) continue;
+            obsc->slot [obsc->ns]=(uint8_t)j;
+            obsc->code [obsc->ns]=data[i].code[j];
+            obsc->LLI  [obsc->ns]=data[i].LLI[j];
+            obsc->qualL[obsc->ns]=data[i].qualL[j];
+            obsc->qualP[obsc->ns]=data[i].qualP[j];
+            obsc->SNR  [obsc->ns]=data[i].SNR[j];
+            obsc->L    [obsc->ns]=data[i].L[j];
+            obsc->P    [obsc->ns]=data[i].P[j];
+            obsc->D    [obsc->ns++]=data[i].D[j];
+        }
+    }
+    obsc->ne++;
+    obsc->iobs[obsc->ne]=obsc->n;
+    obsc->isig[obsc->n]=obsc->ns;
+    return 1;
+}
+/* append compact observation data ---------------------------------------------
+* append all epochs of compact observation data to another
+* args   : obsc_t *obsc     IO  compact observation data
+*          obsc_t *src      I   compact observation data to be appended
+* return : status (1:ok,0:no data,-1:memory allocation error)
+*-----------------------------------------------------------------------------*/
+extern int catobsc(obsc_t *obsc, const obsc_t *src)
+{
+    int i,ne=obsc->ne,n=obsc->n,ns=obsc->ns;
+    
+    if (src->ne<=0) return 0;
+    
+    if (!resizeobsc(obsc,ne+src->ne,n+src->n,ns+src->ns)) {
+        trace(1,"catobsc: malloc error ne=%d n=%d ns=%d\n",ne,n,ns);
+        freeobsc(obsc);
+        return -1;
+    }
+    memcpy(obsc->time     +ne,src->time     ,sizeof(gtime_t)*src->ne);
+    memcpy(obsc->eventime +ne,src->eventime ,sizeof(gtime_t)*src->ne);
+    memcpy(obsc->rcv      +ne,src->rcv      ,sizeof(uint8_t)*src->ne);
+    memcpy(obsc->timevalid+ne,src->timevalid,sizeof(uint8_t)*src->ne);
+    for (i=0;i<=src->ne;i++) obsc->iobs[ne+i]=src->iobs[i]+n;
+    memcpy(obsc->sat +n,src->sat ,sizeof(uint8_t)*src->n);
+    memcpy(obsc->freq+n,src->freq,sizeof(uint8_t)*src->n);
+    for (i=0;i<=src->n;i++) obsc->isig[n+i]=src->isig[i]+ns;
+    memcpy(obsc->slot +ns,src->slot ,sizeof(uint8_t )*src->ns);
+    memcpy(obsc->code +ns,src->code ,sizeof(uint8_t )*src->ns);
+    memcpy(obsc->LLI  +ns,src->LLI  ,sizeof(uint8_t )*src->ns);
+    memcpy(obsc->qualL+ns,src->qualL,sizeof(uint8_t )*src->ns);
+    memcpy(obsc->qualP+ns,src->qualP,sizeof(uint8_t )*src->ns);
+    memcpy(obsc->SNR  +ns,src->SNR  ,sizeof(uint16_t)*src->ns);
+    memcpy(obsc->L    +ns,src->L    ,sizeof(double  )*src->ns);
+    memcpy(obsc->P    +ns,src->P    ,sizeof(double  )*src->ns);
+    memcpy(obsc->D    +ns,src->D    ,sizeof(float   )*src->ns);
+    obsc->ne+=src->ne;
+    obsc->n +=src->n;
+    obsc->ns+=src->ns;
+    return 1;
+}
+/* get observation data records of an epoch in compact observation data --------
+* expand an epoch of compact observation data to observation data records
+* args   : obsc_t *obsc     I   compact observation data
+*          int    epoch     I   epoch index (0 to obsc->ne-1)
+*          obsd_t *data     O   observation data records
+*          int    nmax      I   max number of observation data records
+* return : number of observation data records
+*-----------------------------------------------------------------------------*/
+extern int getobsc(const obsc_t *obsc, int epoch, obsd_t *data, int nmax)
+{
+    obsd_t data0={{0}};
+    int i,j,k,n;
+    
+    if (epoch<0||epoch>=obsc->ne) return 0;
+    
+    for (i=obsc->iobs[epoch],n=0;i<obsc->iobs[epoch+1]&&n<nmax;i++,n++) {
+        data[n]=data0;
+        data[n].time=obsc->time[epoch];
+        data[n].eventime=obsc->eventime[epoch];
+        data[n].timevalid=obsc->timevalid[epoch];
+        data[n].rcv=obsc->rcv[epoch];
+        data[n].sat=obsc->sat[i];
+        data[n].freq=obsc->freq[i];
+        
+        for (j=obsc->isig[i];j<obsc->isig[i+1];j++) {
+            k=obsc->slot[j];
+            data[n].code [k]=obsc->code [j];
+            data[n].LLI  [k]=obsc->LLI  [j];
+            data[n].qualL[k]=obsc->qualL[j];
+            data[n].qualP[k]=obsc->qualP[j];
+            data[n].SNR  [k]=obsc->SNR  [j];
+            data[n].L    [k]=obsc->L    [j];
+            data[n].P    [k]=obsc->P    [j];
+            data[n].D    [k]=obsc->D    [j];
+        }
+    }
+    return n;
+}
+/* compare epochs of compact observation data --------------------------------*/
+typedef struct {
+    gtime_t time;
+    int rcv,index;
+} obscind_t;
+
+static int cmpobsc(const void *p1, const void *p2)
+{
+    obscind_t *q1=(obscind_t *)p1,*q2=(obscind_t *)p2;
+    double tt=timediff(q1->time,q2->time);
+    if (fabs(tt)>DTTOL) return tt<0?-1:1;
+    if (q1->rcv!=q2->rcv) return q1->rcv-q2->rcv;
+    return q1->index-q2->index;
+}
+/* sort and unique compact observation data ------------------------------------
+* sort epochs of compact observation data by time and rcv, merge epochs of the
+* same time and rcv and sort satellite records by sat without duplication
+* args   : obsc_t *obsc     IO  compact observation data
+* return : number of epochs (-1: memory allocation error)
+* notes  : same order as sortobs() of the expanded observation data
+*-----------------------------------------------------------------------------*/
+extern int sortobsc(obsc_t *obsc)
+{
+    obsc_t tmp={0};
+    obscind_t *ind;
+    obsd_t *data,*p;
+    int i,j,k,m,n,nmax=MAXOBS,sorted=1;
+    
+    trace(3,"sortobsc: ne=%d n=%d ns=%d\n",obsc->ne,obsc->n,obsc->ns);
+    
+    if (obsc->ne<=0) return 0;
+    
+    /* check order of epochs and satellites */
+    for (i=0;i<obsc->ne&&sorted;i++) {
+        if (i>0) {
+            if (timediff(obsc->time[i],obsc->time[i-1])<-DTTOL) sorted=0;
+            else if (timediff(obsc->time[i],obsc->time[i-1])<=DTTOL&&
+                     obsc->rcv[i]<=obsc->rcv[i-1]) sorted=0;
+        }
+        for (j=obsc->iobs[i]+1;j<obsc->iobs[i+1];j++) {
+            if (obsc->sat[j]<=obsc->sat[j-1]) {sorted=0; break;}
+        }
+    }
+    if (!sorted) {
+        if (!(ind=(obscind_t *)malloc(sizeof(obscind_t)*obsc->ne))||
+            !(data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) {
+            free(ind);
+            return -1;
+        }
+        for (i=0;i<obsc->ne;i++) {
+            ind[i].time=obsc->time[i];
+            ind[i].rcv=obsc->rcv[i];
+            ind[i].index=i;
+        }
+        qsort(ind,obsc->ne,sizeof(obscind_t),cmpobsc);
+        
+        for (i=0;i<obsc->ne;i=j) {
+            
+            /* number of records of epochs of same time and rcv */
+            for (j=i,n=0;j<obsc->ne;j++) {
+                if (ind[j].rcv!=ind[i].rcv||
+                    timediff(ind[j].time,ind[i].time)>DTTOL) break;
+                n+=obsc->iobs[ind[j].index+1]-obsc->iobs[ind[j].index];
+            }
+            if (n>nmax) {
+                if (!(p=(obsd_t *)realloc(data,sizeof(obsd_t)*n))) {
+                    free(ind); free(data); freeobsc(&tmp);
+                    return -1;
+                }
+                data=p; nmax=n;
+            }
+            /* merge epochs of same time and rcv */
+            for (k=i,n=0;k<j;k++) {
+                n+=getobsc(obsc,ind[k].index,data+n,nmax-n);
+            }
+            /* sort satellites and delete duplicated data */
+            for (k=1;k<n;k++) {
+                obsd_t d=data[k];
+                for (m=k;m>0&&data[m-1].sat>d.sat;m--) data[m]=data[m-1];
+                data[m]=d;
+            }
+            for (k=m=0;k<n;k++) {
+                if (m>0&&data[k].sat==data[m-1].sat) continue;
+                if (k!=m) data[m]=data[k];
+                m++;
+            }
+            if (addobsc(&tmp,data,m)<0) {
+                free(ind); free(data);
+                return -1;
+            }
+        }
+        free(ind); free(data);
+        freeobsc(obsc);
+        *obsc=tmp;
+    }
+    /* number of epochs */
+    for (i=n=0;i<obsc->ne;i=j,n++) {
+        for (j=i+1;j<obsc->ne;j++) {
+            if (timediff(obsc->time[j],obsc->time[i])>DTTOL) break;
+        }
+    }
+    return n;
+}
+/* convert observation data to compact observation data ------------------------
+* convert observation data sorted by sortobs() to compact observation data
+* args   : obs_t  *obs      I   observation data
+*          obsc_t *obsc     IO  compact observation data (appended)
+* return : status (1:ok,0:no data,-1:memory allocation error)
+*-----------------------------------------------------------------------------*/
+extern int obs2obsc(const obs_t *obs, obsc_t *obsc)
+{
+    int i,j,stat=0;
+    
+    for (i=0;i<obs->n;i=j) {
+        for (j=i+1;j<obs->n;j++) {
+            if (obs->data[j].rcv!=obs->data[i].rcv||
+                timediff(obs->data[j].time,obs->data[i].time)>DTTOL) break;
+        }
+        if ((stat=addobsc(obsc,obs->data+i,j-i))<0) return -1;
+    }
+    return stat;
+}
+/* convert compact observation data to observation data ------------------------
+* expand all epochs of compact observation data to observation data records
+* for consumers of obsd_t arrays
+* args   : obsc_t *obsc     I   compact observation data
+*          obs_t  *obs      IO  observation data (appended)
+* return : status (1:ok,0:no data,-1:memory allocation error)
+*-----------------------------------------------------------------------------*/
+extern int obsc2obs(const obsc_t *obsc, obs_t *obs)
+{
+    obsd_t *obs_data;
+    int i;
+    
+    if (obsc->n<=0) return 0;
+    
+    if (obs->nmax<obs->n+obsc->n) {
+        if (!(obs_data=(obsd_t *)realloc(obs->data,sizeof(obsd_t)*
+                                         (obs->n+obsc->n)))) {
+            trace(1,"obsc2obs: malloc error n=%d\n",obs->n+obsc->n);
+            return -1;
+        }
+        obs->data=obs_data;
+        obs->nmax=obs->n+obsc->n;
+    }
+    for (i=0;i<obsc->ne;i++) {
+        obs->n+=getobsc(obsc,i,obs->data+obs->n,obs->nmax-obs->n);
+    }
+    return 1;
+}
+/* free compact observation data -----------------------------------------------
+* free memory for compact observation data
+* args   : obsc_t *obsc     IO  compact observation data
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void freeobsc(obsc_t *obsc)
+{
+    free(obsc->time ); free(obsc->eventime); free(obsc->rcv);
+    free(obsc->timevalid); free(obsc->iobs);
+    free(obsc->sat  ); free(obsc->freq ); free(obsc->isig);
+    free(obsc->slot ); free(obsc->code ); free(obsc->LLI  );
+    free(obsc->qualL); free(obsc->qualP); free(obsc->SNR  );
+    free(obsc->L    ); free(obsc->P    ); free(obsc->D    );
+    memset(obsc,0,sizeof(obsc_t));
+}
 /* free navigation data ---------------------------------------------------------
 * free memory for navigation data
 * args   : nav_t *nav    IO     navigation data
@@ -3018,7 +4141,8 @@ extern void freenav(nav_t *nav, int opt)
     if (opt&0x01) {free(nav->eph ); nav->eph =NULL; nav->n =nav->nmax =0;}
     if (opt&0x02) {free(nav->geph); nav->geph=NULL; nav->ng=nav->ngmax=0;}
     if (opt&0x04) {free(nav->seph); nav->seph=NULL; nav->ns=nav->nsmax=0;}
-    if (opt&0x08) {free(nav->peph); nav->peph=NULL; nav->ne=nav->nemax=0;}
+    if (opt&0x08) {free(nav->peph); nav->peph=NULL; nav->ne=nav->nemax=0;
+                   free(nav->pfit); nav->pfit=NULL; nav->nf=0;}
     if (opt&0x10) {free(nav->pclk); nav->pclk=NULL; nav->nc=nav->ncmax=0;}
     if (opt&0x20) {free(nav->alm ); nav->alm =NULL; nav->na=nav->namax=0;}
     if (opt&0x40) {free(nav->tec ); nav->tec =NULL; nav->nt=nav->ntmax=0;}
@@ -3033,22 +4157,19 @@ static uint32_t tick_trace=0;   /* tick time at traceopen (ms) */
 static gtime_t time_trace={0};  /* time at traceopen */
 static lock_t lock_trace;       /* lock for trace */
 
+/* swap trace file (call with lock_trace locked) -----------------------------*/
 static void traceswap(void)
 {
     gtime_t time=utc2gpst(timeget());
     char path[1024];
     
-    lock(&lock_trace);
-    
     if ((int)(time2gpst(time      ,NULL)/INT_SWAP_TRAC)==
         (int)(time2gpst(time_trace,NULL)/INT_SWAP_TRAC)) {
-        unlock(&lock_trace);
         return;
     }
     time_trace=time;
     
     if (!reppath(file_trace,path,time,"","")) {
-        unlock(&lock_trace);
         return;
     }
     if (fp_trace) fclose(fp_trace);
@@ -3056,7 +4177,6 @@ static void traceswap(void)
     if (!(fp_trace=fopen(path,"w"))) {
         fp_trace=stderr;
     }
-    unlock(&lock_trace);
 }
 extern void traceopen(const char *file)
 {
@@ -3093,25 +4213,31 @@ extern void trace(int level, const char *format, ...)
         va_start(ap,format); vfprintf(stderr,format,ap); va_end(ap);
     }
     if (!fp_trace||level>level_trace) return;
+    lock(&lock_trace);
     traceswap();
     fprintf(fp_trace,"%d ",level);
     va_start(ap,format); vfprintf(fp_trace,format,ap); va_end(ap);
     fflush(fp_trace);
+    unlock(&lock_trace);
 }
 extern void tracet(int level, const char *format, ...)
 {
     va_list ap;
     
     if (!fp_trace||level>level_trace) return;
+    lock(&lock_trace);
     traceswap();
     fprintf(fp_trace,"%d %9.3f: ",level,(tickget()-tick_trace)/1000.0);
     va_start(ap,format); vfprintf(fp_trace,format,ap); va_end(ap);
     fflush(fp_trace);
+    unlock(&lock_trace);
 }
 extern void tracemat(int level, const double *A, int n, int m, int p, int q)
 {
     if (!fp_trace||level>level_trace) return;
+    lock(&lock_trace);
     matfprint(A,n,m,p,q,fp_trace); fflush(fp_trace);
+    unlock(&lock_trace);
 }
 extern void traceobs(int level, const obsd_t *obs, int n)
 {
@@ -3119,6 +4245,7 @@ extern void traceobs(int level, const obsd_t *obs, int n)
     int i;
     
     if (!fp_trace||level>level_trace) return;
+    lock(&lock_trace);
     for (i=0;i<n;i++) {
         time2str(obs[i].time,str,3);
         satno2id(obs[i].sat,id);
@@ -3128,6 +4255,7 @@ extern void traceobs(int level, const obsd_t *obs, int n)
               obs[i].code[1],obs[i].qualL[0],obs[i].qualP[0],obs[i].SNR[0]*SNR_UNIT,obs[i].SNR[1]*SNR_UNIT);
     }
     fflush(fp_trace);
+    unlock(&lock_trace);
 }
 extern void tracenav(int level, const nav_t *nav)
 {
@@ -3954,13 +5082,1023 @@ extern void sunmoonpos(gtime_t tutc, const double *erpv, double *rsun,
     if (rmoon) matmul("NN",3,1,3,1.0,U,rm,0.0,rmoon);
     if (gmst ) *gmst=gmst_;
 }
+/* set astronomical context of epoch -------------------------------------------
+* compute erp values, eci to ecef transformation matrix, gmst and sun and moon
+* positions in ecef for an epoch
+* args   : gtime_t time     I   epoch time (gpst)
+*          erp_t  *erp      I   earth rotation parameters (NULL: not used)
+*          astro_t *astro   O   astronomical context of epoch
+* return : none
+* notes  : the context is computed once per epoch and passed to the functions
+*          of satellite antenna offset, phase windup and earth tides instead of
+*          calling sunmoonpos() in each of them
+*-----------------------------------------------------------------------------*/
+extern void setastro(gtime_t time, const erp_t *erp, astro_t *astro)
+{
+    gtime_t tutc;
+    double rs[3],rm[3];
+    int i;
+    
+    trace(4,"setastro: time=%s\n",time_str(time,3));
+    
+    astro->time=time;
+    for (i=0;i<5;i++) astro->erpv[i]=0.0;
+    if (erp) geterp(erp,time,astro->erpv);
+    tutc=gpst2utc(time);
+    
+    /* sun and moon position in eci */
+    sunmoonpos_eci(timeadd(tutc,astro->erpv[2]),rs,rm);
+    
+    /* eci to ecef transformation matrix */
+    eci2ecef(tutc,astro->erpv,astro->U,&astro->gmst);
+    
+    /* sun and moon postion in ecef */
+    matmul("NN",3,1,3,1.0,astro->U,rs,0.0,astro->rsun );
+    matmul("NN",3,1,3,1.0,astro->U,rm,0.0,astro->rmoon);
+}
+/* in-process stream decompression -------------------------------------------*/
+#define UNCBUFF     65536       /* stream buffer size (bytes) */
+#define UNCWSIZE    32768       /* deflate window size (bytes) */
+#define UNCWMASK    (UNCWSIZE-1)
+#define LZWMAXBITS  16          /* max code length of unix compress */
+#define CRXMAXLINE  4096        /* max line length of hatanaka-compressed file */
+#define CRXMAXSAT   256         /* max number of satellites in an epoch */
+#define CRXMAXARC   9           /* max order of difference in hatanaka file */
+
+typedef struct {            /* compressed input stream type */
+    FILE *fp;               /* input file pointer */
+    uint8_t buff[UNCBUFF];  /* input buffer */
+    int nb,ib;              /* number of bytes/read index in input buffer */
+    uint32_t bitbuf;        /* bit buffer (lsb first) */
+    int nbit;               /* number of bits in bit buffer */
+} uncin_t;
+
+typedef struct {            /* huffman decoding table type */
+    short count[16];        /* number of codes for each code length */
+    short symbol[288];      /* symbols ordered by code length */
+    uint16_t fast[512];     /* 9-bit lookup table (len<<9|symbol,0:no entry) */
+} huff_t;
+
+typedef struct {            /* inflate state type */
+    huff_t lit,dist;        /* literal/length and distance code tables */
+    uint8_t win[UNCWSIZE];  /* sliding window */
+    uint32_t wp,fp;         /* window write/flush position */
+    int full;               /* window filled flag */
+    uint32_t crc;           /* crc-32 of uncompressed data */
+    uint32_t tbl[256];      /* crc-32 table */
+} inflate_t;
+
+typedef struct {            /* hatanaka-compressed data arc type */
+    double y[CRXMAXARC+1];  /* value and differences (1E-3/1E-9/1E-12 unit) */
+    int ord,arc;            /* current/max order of difference (arc<0:none) */
+} crxarc_t;
+
+typedef struct {            /* hatanaka-compressed satellite state type */
+    char flag[MAXOBSTYPE*2+1]; /* LLI and signal strength flags */
+    crxarc_t arc[MAXOBSTYPE]; /* observation data arcs */
+} crxsat_t;
+
+typedef struct {            /* uncompressed output stream type */
+    FILE *fp;               /* output file pointer */
+    int mode;               /* mode (0:detect,1:plain,2:hatanaka) */
+    int stat;               /* hatanaka line state */
+    int ver;                /* compact RINEX version (1,3) */
+    int ntype[128];         /* number of obs types for each system */
+    int nsat,isat,nline;    /* number of satellites,data index,lines to copy */
+    int nl;                 /* number of characters in line buffer */
+    char line[CRXMAXLINE];  /* line buffer */
+    char epoch[CRXMAXLINE]; /* previous epoch line */
+    char id[CRXMAXSAT][4];  /* satellite ids in epoch */
+    int idx[CRXMAXSAT];     /* satellite state indices */
+    crxsat_t *sat;          /* satellite states */
+    crxarc_t clk;           /* receiver clock offset arc */
+    int clkok;              /* receiver clock offset flag */
+} uncout_t;
+
+static const short lbase[]={ /* deflate length base */
+    3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,
+    163,195,227,258
+};
+static const short lext[]={ /* deflate length extra bits */
+    0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0
+};
+static const short dbase[]={ /* deflate distance base */
+    1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,
+    2049,3073,4097,6145,8193,12289,16385,24577
+};
+static const short dext[]={ /* deflate distance extra bits */
+    0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13
+};
+static const uint8_t clorder[]={ /* deflate code length code order */
+    16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15
+};
+/* get byte from compressed input --------------------------------------------*/
+static int uncgetc(uncin_t *in)
+{
+    if (in->ib>=in->nb) {
+        if ((in->nb=(int)fread(in->buff,1,UNCBUFF,in->fp))<=0) {
+            in->nb=0;
+            return -1;
+        }
+        in->ib=0;
+    }
+    return in->buff[in->ib++];
+}
+/* get bits from compressed input (lsb first, n<=24) -------------------------*/
+static int uncbits(uncin_t *in, int n, int *val)
+{
+    int c;
+    
+    while (in->nbit<n) {
+        if ((c=uncgetc(in))<0) return 0;
+        in->bitbuf|=(uint32_t)c<<in->nbit;
+        in->nbit+=8;
+    }
+    *val=(int)(in->bitbuf&((1u<<n)-1));
+    in->bitbuf=n<32?in->bitbuf>>n:0;
+    in->nbit-=n;
+    return 1;
+}
+/* get byte from compressed input at byte boundary ---------------------------*/
+static int uncbyte(uncin_t *in)
+{
+    int val;
+    
+    in->bitbuf>>=in->nbit%8; /* align to byte boundary */
+    in->nbit-=in->nbit%8;
+    return uncbits(in,8,&val)?val:-1;
+}
+/* write uncompressed data to output file ------------------------------------*/
+static int uncputs(uncout_t *out, const char *buff, int n)
+{
+    return fwrite(buff,1,n,out->fp)==(size_t)n?0:-1;
+}
+/* output line of hatanaka-decompressed data ---------------------------------*/
+static int crxputs(uncout_t *out, char *buff, int n)
+{
+    while (n>0&&buff[n-1]==' ') n--;
+    buff[n++]='\n';
+    return uncputs(out,buff,n);
+}
+/* repair text by difference (' ':no change,'&':space) -----------------------*/
+static void crxrepair(char *s, const char *ds)
+{
+    for (;*s&&*ds;s++,ds++) {
+        if (*ds==' ') continue;
+        *s=*ds=='&'?' ':*ds;
+    }
+    if (!*ds) return;
+    for (;*ds;s++,ds++) *s=*ds=='&'?' ':*ds;
+    *s='\0';
+}
+/* decode integer field of hatanaka-compressed data --------------------------*/
+static int crxint(const char *p, const char *q, double *val)
+{
+    double sgn=1.0;
+    
+    if (p<q&&(*p=='-'||*p=='+')) sgn=*p++=='-'?-1.0:1.0;
+    if (p>=q) return 0;
+    for (*val=0.0;p<q;p++) {
+        if (*p<'0'||*p>'9') return 0;
+        *val=*val*10.0+(*p-'0');
+    }
+    *val*=sgn;
+    return 1;
+}
+/* decode field of hatanaka-compressed data ----------------------------------*/
+static int crxfield(crxarc_t *a, const char *p, const char *q)
+{
+    const char *r;
+    double d;
+    int i,arc;
+    
+    for (r=p;r<q&&*r!='&';r++) ;
+    
+    if (r<q) { /* initialize arc */
+        for (arc=0;p<r;p++) {
+            if (*p<'0'||*p>'9') return 0;
+            arc=arc*10+(*p-'0');
+        }
+        if (arc>CRXMAXARC||!crxint(r+1,q,a->y)) return 0;
+        a->arc=arc;
+        a->ord=0;
+        return 1;
+    }
+    if (a->arc<0||!crxint(p,q,&d)) return 0;
+    if (a->ord<a->arc) a->ord++;
+    a->y[a->ord]=d;
+    for (i=a->ord;i>0;i--) a->y[i-1]+=a->y[i];
+    return 1;
+}
+/* output epoch lines of hatanaka-decompressed data --------------------------*/
+static int crxputepoch(uncout_t *out)
+{
+    char buff[CRXMAXLINE],*p;
+    int i,j;
+    
+    if (out->ver==1) {
+        for (i=0;i==0||i<out->nsat;i+=12) {
+            p=buff;
+            if (i==0) memcpy(p,out->epoch,32); else memset(p,' ',32);
+            p+=32;
+            for (j=i;j<i+12&&j<out->nsat;j++,p+=3) memcpy(p,out->id[j],3);
+            if (i==0&&out->clkok) {
+                while (p<buff+68) *p++=' ';
+                p+=sprintf(p,"%12.9f",out->clk.y[0]*1E-9);
+            }
+            if (crxputs(out,buff,(int)(p-buff))) return -1;
+        }
+        return 0;
+    }
+    memcpy(buff,out->epoch,35);
+    p=buff+35;
+    if (out->clkok) {
+        memset(p,' ',6);
+        p+=6;
+        p+=sprintf(p,"%15.12f",out->clk.y[0]*1E-12);
+    }
+    return crxputs(out,buff,(int)(p-buff));
+}
+/* output satellite data line of hatanaka-decompressed data ------------------*/
+static int crxputdata(uncout_t *out, const crxsat_t *sat, const char *id,
+                      int ntype)
+{
+    char buff[CRXMAXLINE],*p=buff;
+    int i,nf=(int)strlen(sat->flag);
+    
+    if (out->ver==3) {
+        memcpy(p,id,3);
+        p+=3;
+    }
+    for (i=0;i<ntype;i++) {
+        if (out->ver==1&&i>0&&i%5==0) {
+            if (crxputs(out,buff,(int)(p-buff))) return -1;
+            p=buff;
+        }
+        if (sat->arc[i].arc>=0) {
+            p+=sprintf(p,"%14.3f",sat->arc[i].y[0]/1000.0);
+        }
+        else {
+            memset(p,' ',14);
+            p+=14;
+        }
+        *p++=2*i  <nf?sat->flag[2*i  ]:' ';
+        *p++=2*i+1<nf?sat->flag[2*i+1]:' ';
+    }
+    return crxputs(out,buff,(int)(p-buff));
+}
+/* decode epoch line of hatanaka-compressed data -----------------------------*/
+static int crxepoch(uncout_t *out, const char *line)
+{
+    char buff[CRXMAXLINE],id[CRXMAXSAT][4];
+    uint8_t used[CRXMAXSAT]={0};
+    int i,j,k,n,flag,nsat,idx[CRXMAXSAT],init=0;
+    int off=out->ver==1?32:41,iflag=out->ver==1?28:31;
+    
+    if (!*line) return 0;
+    
+    if (*line==(out->ver==1?'&':'>')) { /* initialize epoch */
+        strcpy(buff,line);
+        if (out->ver==1) buff[0]=' ';
+        init=1;
+    }
+    else if (*out->epoch) {
+        strcpy(buff,out->epoch);
+        crxrepair(buff,line);
+    }
+    else return -1;
+    
+    if ((n=(int)strlen(buff))<iflag+4) return -1;
+    flag=buff[iflag]-'0';
+    nsat=(int)str2num(buff,iflag+1,3);
+    
+    /* special event: copy following records */
+    if (flag>=2&&flag<=5) {
+        if (crxputs(out,buff,n)) return -1;
+        if ((out->nline=nsat)>0) out->stat=5;
+        return 0;
+    }
+    if (nsat<0||nsat>CRXMAXSAT||n<off+3*nsat) return -1;
+    buff[off+3*nsat]='\0';
+    strcpy(out->epoch,buff);
+    
+    /* reuse states of satellites in previous epoch */
+    if (init) out->nsat=0;
+    for (i=0;i<nsat;i++) {
+        memcpy(id[i],buff+off+3*i,3); id[i][3]='\0';
+        for (j=0;j<out->nsat;j++) {
+            if (!used[out->idx[j]]&&!strcmp(id[i],out->id[j])) break;
+        }
+        idx[i]=j<out->nsat?out->idx[j]:-1;
+        if (idx[i]>=0) used[idx[i]]=1;
+    }
+    for (i=k=0;i<nsat;i++) {
+        if (idx[i]>=0) continue;
+        while (used[k]) k++;
+        used[idx[i]=k]=1;
+        out->sat[k].flag[0]='\0';
+        for (j=0;j<MAXOBSTYPE;j++) out->sat[k].arc[j].arc=-1;
+    }
+    for (i=0;i<nsat;i++) {
+        strcpy(out->id[i],id[i]);
+        out->idx[i]=idx[i];
+    }
+    out->nsat=nsat;
+    out->stat=3;
+    return 0;
+}
+/* decode clock line of hatanaka-compressed data -----------------------------*/
+static int crxclock(uncout_t *out, const char *line)
+{
+    if (!*line) {
+        out->clkok=0;
+        out->clk.arc=-1;
+    }
+    else if (crxfield(&out->clk,line,line+strlen(line))) {
+        out->clkok=1;
+    }
+    else return -1;
+    
+    if (crxputepoch(out)) return -1;
+    out->isat=0;
+    out->stat=out->nsat>0?4:2;
+    return 0;
+}
+/* decode data line of hatanaka-compressed data ------------------------------*/
+static int crxdata(uncout_t *out, const char *line)
+{
+    crxsat_t *sat=out->sat+out->idx[out->isat];
+    const char *p=line,*q,*id=out->id[out->isat];
+    int i,ntype;
+    
+    ntype=out->ntype[out->ver==1?0:(uint8_t)id[0]&0x7F];
+    
+    for (i=0;i<ntype;i++) {
+        if (!*p) {
+            for (;i<ntype;i++) sat->arc[i].arc=-1;
+            break;
+        }
+        for (q=p;*q&&*q!=' ';q++) ;
+        if (q==p) sat->arc[i].arc=-1;
+        else if (!crxfield(sat->arc+i,p,q)) return -1;
+        p=*q?q+1:q;
+    }
+    if (strlen(p)>MAXOBSTYPE*2) return -1;
+    crxrepair(sat->flag,p);
+    
+    if (crxputdata(out,sat,id,ntype)) return -1;
+    if (++out->isat>=out->nsat) out->stat=2;
+    return 0;
+}
+/* decode line of hatanaka-compressed data -----------------------------------*/
+static int crxline(uncout_t *out, char *line, int n)
+{
+    int i;
+    
+    if (n>0&&line[n-1]=='\r') line[--n]='\0';
+    
+    switch (out->stat) {
+        case 0: /* CRINEX PROG / DATE */
+            out->stat=1;
+            return 0;
+        case 1: /* RINEX header */
+            if (strstr(line,"# / TYPES OF OBSERV")&&line[5]!=' ') {
+                out->ntype[0]=(int)str2num(line,0,6);
+            }
+            else if (strstr(line,"SYS / # / OBS TYPES")&&line[0]!=' ') {
+                out->ntype[(uint8_t)line[0]&0x7F]=(int)str2num(line,3,3);
+            }
+            else if (strstr(line,"END OF HEADER")) {
+                for (i=0;i<128;i++) {
+                    if (out->ntype[i]>MAXOBSTYPE) out->ntype[i]=MAXOBSTYPE;
+                }
+                out->stat=2;
+            }
+            line[n++]='\n';
+            return uncputs(out,line,n);
+        case 2: return crxepoch(out,line);
+        case 3: return crxclock(out,line);
+        case 4: return crxdata(out,line);
+        case 5: /* special event records */
+            if (--out->nline<=0) out->stat=2;
+            line[n++]='\n';
+            return uncputs(out,line,n);
+    }
+    return -1;
+}
+/* process line of uncompressed data -----------------------------------------*/
+static int uncline(uncout_t *out, int eol)
+{
+    out->line[out->nl]='\0';
+    
+    if (out->mode==0) { /* detect hatanaka-compression by first line */
+        if (out->nl>=80&&!strncmp(out->line+60,"CRINEX VERS   / TYPE",20)) {
+            if (!(out->sat=(crxsat_t *)malloc(sizeof(crxsat_t)*CRXMAXSAT))) {
+                return -1;
+            }
+            out->ver=out->line[0]=='3'?3:1;
+            out->mode=2;
+            out->nl=0;
+            return 0;
+        }
+        out->mode=1;
+        if (eol) out->line[out->nl++]='\n';
+        if (uncputs(out,out->line,out->nl)) return -1;
+        out->nl=0;
+        return 0;
+    }
+    if (crxline(out,out->line,out->nl)) {
+        trace(2,"hatanaka decompression error: %.60s\n",out->line);
+        return -1;
+    }
+    out->nl=0;
+    return 0;
+}
+/* write uncompressed data ---------------------------------------------------*/
+static int uncwrite(uncout_t *out, const uint8_t *buff, int n)
+{
+    int i;
+    
+    for (i=0;i<n;i++) {
+        if (out->mode==1) {
+            return uncputs(out,(const char *)buff+i,n-i);
+        }
+        if (buff[i]=='\n') {
+            if (uncline(out,1)) return -1;
+        }
+        else if (out->nl<CRXMAXLINE-2) {
+            out->line[out->nl++]=(char)buff[i];
+        }
+        else if (out->mode==0) { /* no line structure */
+            if (uncline(out,0)) return -1;
+            i--;
+        }
+        else return -1;
+    }
+    return 0;
+}
+/* flush window of inflate ---------------------------------------------------*/
+static int inflush(inflate_t *inf, uncout_t *out)
+{
+    const uint8_t *p=inf->win+(inf->fp&UNCWMASK);
+    uint32_t crc=inf->crc;
+    int i,n=(int)(inf->wp-inf->fp);
+    
+    for (i=0;i<n;i++) crc=inf->tbl[(crc^p[i])&0xFF]^(crc>>8);
+    inf->crc=crc;
+    inf->fp=inf->wp;
+    return uncwrite(out,p,n);
+}
+/* build huffman decoding table ----------------------------------------------*/
+static int buildhuff(huff_t *h, const uint8_t *len, int n)
+{
+    short offs[16];
+    int i,j,k,l,left,code,next[16];
+    
+    for (i=0;i<16;i++) h->count[i]=0;
+    for (i=0;i<n;i++) h->count[len[i]]++;
+    
+    for (i=1,left=1;i<16;i++) {
+        left<<=1;
+        if ((left-=h->count[i])<0) return 0; /* over-subscribed */
+    }
+    for (i=1,offs[1]=0;i<15;i++) offs[i+1]=offs[i]+h->count[i];
+    for (i=0;i<n;i++) if (len[i]) h->symbol[offs[len[i]]++]=(short)i;
+    
+    /* canonical codes and 9-bit lookup table */
+    for (i=1,code=0;i<16;i++) {
+        code=(code+(i>1?h->count[i-1]:0))<<1;
+        next[i]=code;
+    }
+    memset(h->fast,0,sizeof(h->fast));
+    for (i=0;i<n;i++) {
+        if (!(l=len[i])) continue;
+        code=next[l]++;
+        if (l>9) continue;
+        for (j=k=0;j<l;j++) k=(k<<1)|((code>>j)&1); /* bit reverse */
+        for (;k<512;k+=1<<l) h->fast[k]=(uint16_t)(l<<9|i);
+    }
+    return 1;
+}
+/* decode huffman symbol -----------------------------------------------------*/
+static int decsym(uncin_t *in, const huff_t *h)
+{
+    int c,l,e,bit,code=0,first=0,index=0,count;
+    
+    while (in->nbit<9&&(c=uncgetc(in))>=0) {
+        in->bitbuf|=(uint32_t)c<<in->nbit;
+        in->nbit+=8;
+    }
+    if ((e=h->fast[in->bitbuf&511])&&(l=e>>9)<=in->nbit) {
+        in->bitbuf>>=l;
+        in->nbit-=l;
+        return e&511;
+    }
+    for (l=1;l<16;l++) {
+        if (!uncbits(in,1,&bit)) return -1;
+        code|=bit;
+        count=h->count[l];
+        if (code-count<first) return h->symbol[index+(code-first)];
+        index+=count;
+        first+=count;
+        first<<=1;
+        code<<=1;
+    }
+    return -1;
+}
+/* inflate stored block ------------------------------------------------------*/
+static int instored(uncin_t *in, inflate_t *inf, uncout_t *out)
+{
+    int i,c,len,nlen,hdr[4];
+    
+    for (i=0;i<4;i++) if ((hdr[i]=uncbyte(in))<0) return 0;
+    len =hdr[0]|hdr[1]<<8;
+    nlen=hdr[2]|hdr[3]<<8;
+    if (len!=(~nlen&0xFFFF)) return 0;
+    
+    while (len--) {
+        if ((c=uncbyte(in))<0) return 0;
+        inf->win[inf->wp++&UNCWMASK]=(uint8_t)c;
+        if (!(inf->wp&UNCWMASK)) {
+            inf->full=1;
+            if (inflush(inf,out)) return 0;
+        }
+    }
+    return 1;
+}
+/* inflate huffman-coded block -----------------------------------------------*/
+static int incodes(uncin_t *in, inflate_t *inf, uncout_t *out)
+{
+    int sym,len,dist,val;
+    
+    for (;;) {
+        if ((sym=decsym(in,&inf->lit))<0) return 0;
+        
+        if (sym<256) { /* literal */
+            inf->win[inf->wp++&UNCWMASK]=(uint8_t)sym;
+            if (!(inf->wp&UNCWMASK)) {
+                inf->full=1;
+                if (inflush(inf,out)) return 0;
+            }
+            continue;
+        }
+        if (sym==256) return 1; /* end of block */
+        
+        if ((sym-=257)>=29||!uncbits(in,lext[sym],&val)) return 0;
+        len=lbase[sym]+val;
+        if ((sym=decsym(in,&inf->dist))<0||sym>=30) return 0;
+        if (!uncbits(in,dext[sym],&val)) return 0;
+        dist=dbase[sym]+val;
+        if (!inf->full&&(uint32_t)dist>inf->wp) return 0;
+        
+        while (len--) {
+            inf->win[inf->wp&UNCWMASK]=inf->win[(inf->wp-dist)&UNCWMASK];
+            if (!(++inf->wp&UNCWMASK)) {
+                inf->full=1;
+                if (inflush(inf,out)) return 0;
+            }
+        }
+    }
+}
+/* inflate fixed huffman block -----------------------------------------------*/
+static int infixed(uncin_t *in, inflate_t *inf, uncout_t *out)
+{
+    uint8_t len[288];
+    int i;
+    
+    for (i=0;i<144;i++) len[i]=8;
+    for (;i<256;i++) len[i]=9;
+    for (;i<280;i++) len[i]=7;
+    for (;i<288;i++) len[i]=8;
+    buildhuff(&inf->lit,len,288);
+    for (i=0;i<30;i++) len[i]=5;
+    buildhuff(&inf->dist,len,30);
+    return incodes(in,inf,out);
+}
+/* inflate dynamic huffman block ---------------------------------------------*/
+static int indynamic(uncin_t *in, inflate_t *inf, uncout_t *out)
+{
+    uint8_t len[320]={0};
+    int i,n,sym,nlen,ndist,ncode,val,prev;
+    
+    if (!uncbits(in,5,&nlen)||!uncbits(in,5,&ndist)||!uncbits(in,4,&ncode)) {
+        return 0;
+    }
+    nlen+=257; ndist+=1; ncode+=4;
+    if (nlen>286||ndist>30) return 0;
+    
+    for (i=0;i<ncode;i++) {
+        if (!uncbits(in,3,&val)) return 0;
+        len[clorder[i]]=(uint8_t)val;
+    }
+    if (!buildhuff(&inf->lit,len,19)) return 0;
+    
+    for (i=0;i<nlen+ndist;) {
+        if ((sym=decsym(in,&inf->lit))<0) return 0;
+        if (sym<16) {
+            len[i++]=(uint8_t)sym;
+            continue;
+        }
+        if (sym==16) {
+            if (i==0||!uncbits(in,2,&val)) return 0;
+            prev=len[i-1]; n=3+val;
+        }
+        else if (sym==17) {
+            if (!uncbits(in,3,&val)) return 0;
+            prev=0; n=3+val;
+        }
+        else {
+            if (!uncbits(in,7,&val)) return 0;
+            prev=0; n=11+val;
+        }
+        if (i+n>nlen+ndist) return 0;
+        while (n--) len[i++]=(uint8_t)prev;
+    }
+    if (len[256]==0) return 0;
+    if (!buildhuff(&inf->lit,len,nlen)||!buildhuff(&inf->dist,len+nlen,ndist)) {
+        return 0;
+    }
+    return incodes(in,inf,out);
+}
+/* uncompress gzip stream ----------------------------------------------------*/
+static int ungzip(uncin_t *in, uncout_t *out)
+{
+    inflate_t *inf;
+    uint32_t crc,size;
+    int i,j,c,flg,last,type,xlen,stat=0;
+    
+    if (!(inf=(inflate_t *)malloc(sizeof(inflate_t)))) return -1;
+    
+    for (i=0;i<256;i++) {
+        for (j=0,crc=(uint32_t)i;j<8;j++) {
+            crc=(crc&1)?(crc>>1)^POLYCRC32:crc>>1;
+        }
+        inf->tbl[i]=crc;
+    }
+    for (;;) { /* gzip members */
+        
+        /* member header */
+        if (uncbyte(in)!=8||(flg=uncbyte(in))<0) {stat=-1; break;}
+        for (i=0;i<6;i++) if (uncbyte(in)<0) break;
+        if (i<6) {stat=-1; break;}
+        if (flg&4) { /* FEXTRA */
+            xlen=uncbyte(in); xlen|=uncbyte(in)<<8;
+            for (i=0;i<xlen;i++) if (uncbyte(in)<0) break;
+        }
+        if (flg&8 ) while ((c=uncbyte(in))>0) ; /* FNAME */
+        if (flg&16) while ((c=uncbyte(in))>0) ; /* FCOMMENT */
+        if (flg&2 ) {uncbyte(in); uncbyte(in);} /* FHCRC */
+        
+        /* deflate blocks */
+        inf->wp=inf->fp=0;
+        inf->full=0;
+        inf->crc=0xFFFFFFFFu;
+        do {
+            if (!uncbits(in,1,&last)||!uncbits(in,2,&type)) {stat=-1; break;}
+            if (type==0) {if (!instored (in,inf,out)) stat=-1;}
+            else if (type==1) {if (!infixed  (in,inf,out)) stat=-1;}
+            else if (type==2) {if (!indynamic(in,inf,out)) stat=-1;}
+            else stat=-1;
+        } while (!stat&&!last);
+        
+        if (stat||inflush(inf,out)) {stat=-1; break;}
+        
+        /* member trailer (crc-32 and size) */
+        for (i=0,crc=size=0;i<4;i++) {
+            if ((c=uncbyte(in))<0) break;
+            crc|=(uint32_t)c<<(8*i);
+        }
+        for (j=0;i==4&&j<4;j++) {
+            if ((c=uncbyte(in))<0) break;
+            size|=(uint32_t)c<<(8*j);
+        }
+        if (j<4||crc!=(inf->crc^0xFFFFFFFFu)||size!=inf->wp) {
+            trace(2,"gzip crc/size error\n");
+            stat=-1;
+            break;
+        }
+        /* next member */
+        if ((c=uncbyte(in))<0) break;
+        if (c!=0x1F||uncbyte(in)!=0x8B) break; /* ignore trailing garbage */
+    }
+    free(inf);
+    return stat;
+}
+/* uncompress unix compress (LZW) stream -------------------------------------*/
+static int unlzw(uncin_t *in, uncout_t *out)
+{
+    uint16_t *prefix;
+    uint8_t *suffix,*stack,*p,buff[UNCBUFF],finchar=0;
+    int c,n=0,nbits=9,maxbits,block,maxcode=511,maxmaxcode,freeent,ncode=0;
+    int code,incode,oldcode=-1,skip,val,clear=0,stat=0;
+    
+    if ((c=uncbyte(in))<0) return -1;
+    maxbits=c&0x1F;
+    block=c&0x80;
+    if (maxbits<9||maxbits>LZWMAXBITS) return -1;
+    maxmaxcode=1<<maxbits;
+    freeent=block?257:256;
+    
+    prefix=(uint16_t *)malloc(sizeof(uint16_t)<<LZWMAXBITS);
+    suffix=(uint8_t *)malloc(1<<LZWMAXBITS);
+    stack =(uint8_t *)malloc(1<<LZWMAXBITS);
+    if (!prefix||!suffix||!stack) {
+        free(prefix); free(suffix); free(stack);
+        return -1;
+    }
+    for (code=0;code<256;code++) {
+        prefix[code]=0;
+        suffix[code]=(uint8_t)code;
+    }
+    for (;;) {
+        if (clear||freeent>maxcode) {
+            
+            /* skip rest of codes in group of 8 codes */
+            for (skip=(8-ncode%8)%8*nbits;skip>0;skip-=val) {
+                val=skip<16?skip:16;
+                if (!uncbits(in,val,&c)) break;
+            }
+            if (skip>0) break;
+            ncode=0;
+            if (clear) {
+                nbits=9;
+                maxcode=511;
+                freeent=256;
+                clear=0;
+            }
+            else {
+                nbits++;
+                maxcode=nbits==maxbits?maxmaxcode:(1<<nbits)-1;
+            }
+        }
+        if (!uncbits(in,nbits,&code)) break;
+        ncode++;
+        
+        if (oldcode<0) { /* first code */
+            if (code>=256) {stat=-1; break;}
+            finchar=(uint8_t)(oldcode=code);
+            buff[n++]=finchar;
+            continue;
+        }
+        if (block&&code==256) { /* clear code */
+            clear=1;
+            continue;
+        }
+        
+        incode=code;
+        p=stack+(1<<LZWMAXBITS);
+        if (code>=freeent) { /* KwKwK */
+            if (code>freeent) {stat=-1; break;}
+            *--p=finchar;
+            code=oldcode;
+        }
+        while (code>=256) {
+            *--p=suffix[code];
+            code=prefix[code];
+        }
+        *--p=finchar=suffix[code];
+        
+        for (;p<stack+(1<<LZWMAXBITS);p++) {
+            buff[n++]=*p;
+            if (n>=UNCBUFF) {
+                if (uncwrite(out,buff,n)) {stat=-1; break;}
+                n=0;
+            }
+        }
+        if (stat) break;
+        
+        if (freeent<maxmaxcode) {
+            prefix[freeent]=(uint16_t)oldcode;
+            suffix[freeent++]=finchar;
+        }
+        oldcode=incode;
+    }
+    if (!stat&&n>0&&uncwrite(out,buff,n)) stat=-1;
+    free(prefix); free(suffix); free(stack);
+    return stat;
+}
+/* uncompress stream --------------------------------------------------------*/
+static int uncstream(FILE *fpi, FILE *fpo)
+{
+    uncin_t *in;
+    uncout_t *out;
+    uint8_t buff[2];
+    int c1,c2,n=0,stat=0;
+    
+    in =(uncin_t  *)malloc(sizeof(uncin_t ));
+    out=(uncout_t *)malloc(sizeof(uncout_t));
+    if (!in||!out) {
+        free(in); free(out);
+        return -1;
+    }
+    in->fp=fpi;
+    in->nb=in->ib=in->nbit=0;
+    in->bitbuf=0;
+    memset(out,0,sizeof(uncout_t));
+    out->fp=fpo;
+    out->clk.arc=-1;
+    
+    c1=uncgetc(in);
+    c2=uncgetc(in);
+    
+    if (c1==0x1F&&c2==0x8B) { /* gzip */
+        stat=ungzip(in,out);
+    }
+    else if (c1==0x1F&&c2==0x9D) { /* unix compress */
+        stat=unlzw(in,out);
+    }
+    else { /* not compressed */
+        if (c1>=0) buff[n++]=(uint8_t)c1;
+        if (c2>=0) buff[n++]=(uint8_t)c2;
+        stat=uncwrite(out,buff,n);
+        while (!stat&&uncgetc(in)>=0) {
+            stat=uncwrite(out,in->buff+in->ib-1,in->nb-in->ib+1);
+            in->ib=in->nb;
+        }
+    }
+    if (!stat&&out->nl>0) stat=uncline(out,0);
+    
+    free(out->sat);
+    free(in); free(out);
+    return stat;
+}
+/* check compressed file -----------------------------------------------------*/
+static int unccheck(FILE *fp)
+{
+    char buff[1024];
+    int c1,c2,stat=0;
+    
+    c1=fgetc(fp);
+    c2=fgetc(fp);
+    if (c1==0x1F&&(c2==0x8B||c2==0x9D)) {
+        stat=1; /* gzip or unix compress */
+    }
+    else {
+        rewind(fp);
+        if (fgets(buff,sizeof(buff),fp)&&strlen(buff)>=80&&
+            !strncmp(buff+60,"CRINEX VERS   / TYPE",20)) {
+            stat=1; /* hatanaka-compressed */
+        }
+    }
+    rewind(fp);
+    return stat;
+}
+/* uncompress file in-process ------------------------------------------------*/
+static int uncompfile(const char *file, const char *uncfile)
+{
+    FILE *fpi,*fpo;
+    int stat;
+    
+    if (!(fpi=fopen(file,"rb"))) return -1;
+    if (!(fpo=fopen(uncfile,"wb"))) {
+        fclose(fpi);
+        return -1;
+    }
+    stat=uncstream(fpi,fpo);
+    fclose(fpi);
+    if (fclose(fpo)==EOF) stat=-1;
+    return stat;
+}
+/* uncompressed file path of hatanaka-compressed file ------------------------*/
+static int crxpath(const char *file, char *uncfile)
+{
+    char *p;
+    
+    strcpy(uncfile,file);
+    if (!(p=strrchr(uncfile,'.'))) return 0;
+    
+    if ((strlen(p)>3&&(*(p+3)=='d'||*(p+3)=='D'))||
+        !strcmp(p,".crx")||!strcmp(p,".CRX")) {
+        *(p+3)=*(p+3)=='D'?'O':'o';
+        return 1;
+    }
+    return 0;
+}
+/* decompression thread ------------------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI uncthread(void *arg)
+#else
+static void *uncthread(void *arg)
+#endif
+{
+    uncomp_t *unc=(uncomp_t *)arg;
+#ifndef WIN32
+    sigset_t set;
+    
+    /* broken pipe by early close of stream is returned as write error */
+    sigemptyset(&set);
+    sigaddset(&set,SIGPIPE);
+    pthread_sigmask(SIG_BLOCK,&set,NULL);
+#endif
+    unc->stat=uncstream(unc->fpi,unc->fpo);
+    fclose(unc->fpi);
+    if (fclose(unc->fpo)==EOF) unc->stat=-1;
+    return 0;
+}
+/* open uncompressed stream ----------------------------------------------------
+* open stream of data uncompressed in-process from gzip, unix compress (.Z) or
+* hatanaka-compressed file without temporary file and external command
+* args   : char     *file   I   input file
+*          uncomp_t *unc    O   uncompressed stream (unc->fp: read stream)
+* return : status (-1:error,0:not compressed file,1:stream opened)
+* notes  : compression type is detected by the file contents. gzip or unix
+*          compressed hatanaka-compressed file is uncompressed to RINEX.
+*          tar archive (*.tar.*) is not handled.
+*          the stream has to be closed by closeuncomp()
+*-----------------------------------------------------------------------------*/
+extern int openuncomp(const char *file, uncomp_t *unc)
+{
+    FILE *fp;
+    char path[1024],*p;
+    int fd[2];
+    
+    trace(3,"openuncomp: file=%s\n",file);
+    
+    unc->fp=unc->fpi=unc->fpo=NULL;
+    unc->stat=0;
+    
+    strcpy(path,file);
+    if ((p=strrchr(path,'.'))&&(!strcmp(p,".gz")||!strcmp(p,".GZ")||
+        !strcmp(p,".z")||!strcmp(p,".Z"))) {
+        *p='\0';
+    }
+    if ((p=strrchr(path,'.'))&&(!strcmp(p,".tar")||!strcmp(p,".TAR"))) {
+        return 0;
+    }
+    if (!(fp=fopen(file,"rb"))) {
+        trace(2,"openuncomp: file open error %s\n",file);
+        return -1;
+    }
+    if (!unccheck(fp)) {
+        fclose(fp);
+        return 0;
+    }
+#ifdef WIN32
+    if (_pipe(fd,UNCBUFF,_O_BINARY)) {
+#else
+    if (pipe(fd)) {
+#endif
+        fclose(fp);
+        return -1;
+    }
+    unc->fpi=fp;
+#ifdef WIN32
+    unc->fpo=_fdopen(fd[1],"wb");
+    unc->fp =_fdopen(fd[0],"rb");
+#else
+    unc->fpo=fdopen(fd[1],"wb");
+    unc->fp =fdopen(fd[0],"r");
+#endif
+    if (!unc->fpo||!unc->fp) {
+        if (unc->fpo) fclose(unc->fpo); else close(fd[1]);
+        if (unc->fp ) fclose(unc->fp ); else close(fd[0]);
+        fclose(fp);
+        return -1;
+    }
+    setvbuf(unc->fpo,NULL,_IOFBF,UNCBUFF);
+    setvbuf(unc->fp ,NULL,_IOFBF,UNCBUFF);
+    
+#ifdef WIN32
+    if (!(unc->thread=CreateThread(NULL,0,uncthread,unc,0,NULL))) {
+#else
+    if (pthread_create(&unc->thread,NULL,uncthread,unc)) {
+#endif
+        fclose(unc->fpo);
+        fclose(unc->fp);
+        fclose(fp);
+        return -1;
+    }
+    return 1;
+}
+/* close uncompressed stream ---------------------------------------------------
+* close uncompressed stream opened by openuncomp()
+* args   : uncomp_t *unc    IO  uncompressed stream
+* return : status (-1:decompression error,0:ok)
+* notes  : -1 is also returned if the stream is closed before the end of data
+*-----------------------------------------------------------------------------*/
+extern int closeuncomp(uncomp_t *unc)
+{
+    trace(3,"closeuncomp:\n");
+    
+    fclose(unc->fp);
+#ifdef WIN32
+    WaitForSingleObject(unc->thread,INFINITE);
+    CloseHandle(unc->thread);
+#else
+    pthread_join(unc->thread,NULL);
+#endif
+    trace(3,"closeuncomp: stat=%d\n",unc->stat);
+    return unc->stat;
+}
 /* uncompress file -------------------------------------------------------------
 * uncompress (uncompress/unzip/uncompact hatanaka-compression/tar) file
 * args   : char   *file     I   input file
 *          char   *uncfile  O   uncompressed file
 * return : status (-1:error,0:not compressed file,1:uncompress completed)
 * note   : creates uncompressed file in tempolary directory
-*          gzip, tar and crx2rnx commands have to be installed in commands path
+*          gzip, unix compress and hatanaka-compressed files are uncompressed
+*          in-process. gzip and tar commands have to be installed in commands
+*          path for zip and tar files
 *-----------------------------------------------------------------------------*/
 extern int rtk_uncompress(const char *file, char *uncfile)
 {
@@ -3972,10 +6110,23 @@ extern int rtk_uncompress(const char *file, char *uncfile)
     strcpy(tmpfile,file);
     if (!(p=strrchr(tmpfile,'.'))) return 0;
     
-    /* uncompress by gzip */
+    /* uncompress gzip or unix compress (and hatanaka-compression) */
     if (!strcmp(p,".z"  )||!strcmp(p,".Z"  )||
-        !strcmp(p,".gz" )||!strcmp(p,".GZ" )||
-        !strcmp(p,".zip")||!strcmp(p,".ZIP")) {
+        !strcmp(p,".gz" )||!strcmp(p,".GZ" )) {
+        
+        *p='\0';
+        crxpath(tmpfile,uncfile);
+        *p='.';
+        
+        if (uncompfile(tmpfile,uncfile)) {
+            remove(uncfile);
+            return -1;
+        }
+        strcpy(tmpfile,uncfile);
+        stat=1;
+    }
+    /* uncompress zip file by gzip */
+    else if (!strcmp(p,".zip")||!strcmp(p,".ZIP")) {
         
         strcpy(uncfile,tmpfile); uncfile[p-tmpfile]='\0';
         sprintf(cmd,"gzip -f -d -c \"%s\" > \"%s\"",tmpfile,uncfile);
@@ -4012,16 +6163,10 @@ extern int rtk_uncompress(const char *file, char *uncfile)
         if (stat) remove(tmpfile);
         stat=1;
     }
-    /* extract hatanaka-compressed file by cnx2rnx */
-    else if ((p=strrchr(tmpfile,'.'))&&
-             ((strlen(p)>3&&(*(p+3)=='d'||*(p+3)=='D'))||
-              !strcmp(p,".crx")||!strcmp(p,".CRX"))) {
-        
-        strcpy(uncfile,tmpfile);
-        uncfile[p-tmpfile+3]=*(p+3)=='D'?'O':'o';
-        sprintf(cmd,"crx2rnx < \"%s\" > \"%s\"",tmpfile,uncfile);
+    /* uncompact hatanaka-compressed file */
+    else if (crxpath(tmpfile,uncfile)) {
         
-        if (execcmd(cmd)) {
+        if (uncompfile(tmpfile,uncfile)) {
             remove(uncfile);
             if (stat) remove(tmpfile);
             return -1;
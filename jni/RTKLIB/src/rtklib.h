@@ -246,6 +246,7 @@ extern "C" {
 #define INT_SWAP_STAT 86400.0           /* swap interval of solution status file (s) */
 
 #define MAXEXFILE   1024                /* max number of expanded files */
+#define MAXPFIT     11                  /* max number of Chebyshev coef of precise ephem */
 #define MAXSBSAGEF  30.0                /* max age of SBAS fast correction (s) */
 #define MAXSBSAGEL  1800.0              /* max age of SBAS long term corr (s) */
 #define MAXSBSURA   8                   /* max URA of SBAS satellite */
@@ -261,7 +262,9 @@ extern "C" {
 #define MAXRAWLEN   84096              /* max length of receiver raw message */
 #define MAXERRMSG   4096                /* max length of error/warning message */
 #define MAXANT      64                  /* max length of station name/antenna type */
-#define MAXSOLBUF   256                 /* max number of solution buffer */
+#define MAXSOLRING  1024                /* number of records in solution ring (2^n) */
+#define SNAPVER     1                   /* version of rtk server status snapshot */
+#define MAXSNAPMSG  512                 /* max length of error message in status snapshot */
 #define MAXOBSBUF   128                 /* max number of observation data buffer */
 #define MAXNRPOS    16                  /* max number of reference positions */
 #define MAXLEAPS    64                  /* max number of leap seconds table */
@@ -372,6 +375,67 @@ extern "C" {
 #define SOLF_NMEA   3                   /* solution format: NMEA-183 */
 #define SOLF_STAT   4                   /* solution format: solution status */
 #define SOLF_GSIF   5                   /* solution format: GSI F1/F2 */
+#define SOLF_BIN    6                   /* solution format: binary records */
+
+#define SOLBIN_MAGIC "RTKSOLB"          /* binary solution: magic */
+#define SOLBIN_VER  1                   /* binary solution: format version */
+#define SOLBIN_ORDER 0x01020304         /* binary solution: byte order mark */
+#define SOLBIN_VEL  0x01                /* binary solution: velocity records */
+
+#define SSTAT_BIN   3                   /* solution status level: binary residuals */
+
+#define STATBIN_MAGIC "RTKSTAB"         /* binary solution status: magic */
+#define STATBIN_VER 2                   /* binary solution status: format version */
+
+#define STATL_POS   0                   /* solution status state: $POS */
+#define STATL_VELACC 1                  /* solution status state: $VELACC */
+#define STATL_CLK   2                   /* solution status state: $CLK (rtk) */
+#define STATL_CLKP  3                   /* solution status state: $CLK (ppp) */
+#define STATL_ION   4                   /* solution status state: $ION */
+#define STATL_TROP  5                   /* solution status state: $TROP */
+#define STATL_TRPG  6                   /* solution status state: $TRPG */
+#define STATL_HWBIAS 7                  /* solution status state: $HWBIAS */
+#define STATL_AMB   8                   /* solution status state: $AMB */
+#define NSTATL      9                   /* number of solution status states */
+
+#define COPT_EPHALL  0x00000001         /* compiled option: input all ephemerides (-EPHALL) */
+#define COPT_GALINAV 0x00000002         /* compiled option: galileo i/nav only (-GALINAV) */
+#define COPT_GALFNAV 0x00000004         /* compiled option: galileo f/nav only (-GALFNAV) */
+#define COPT_RT_INP  0x00000008         /* compiled option: real-time input (-RT_INP) */
+#define COPT_INVCP   0x00000010         /* compiled option: invert carrier-phase (-INVCP) */
+#define COPT_MULTICODE 0x00000020       /* compiled option: multiple codes per freq (-MULTICODE) */
+#define COPT_TTCORR  0x00000040         /* compiled option: time-tag correction (-TTCORR) */
+#define COPT_ENAGLO  0x00000080         /* compiled option: enable glonass (-ENAGLO) */
+#define COPT_NOET    0x00000100         /* compiled option: discard epoch time (-NOET) */
+#define COPT_AUX1    0x00000200         /* compiled option: aux1 antenna (-AUX1) */
+#define COPT_AUX2    0x00000400         /* compiled option: aux2 antenna (-AUX2) */
+#define COPT_DIS_FCB 0x00000800         /* compiled option: disable fcb correction (-DIS_FCB) */
+#define COPT_ENA_FCB 0x00001000         /* compiled option: enable fcb correction (-ENA_FCB) */
+#define COPT_OBSALL  0x00002000         /* compiled option: input all observations (OBSALL) */
+#define COPT_ANT_AUX 0x00004000         /* compiled option: aux antenna (ANT_AUX) */
+#define COPT_CONVBASE 0x00008000        /* compiled option: convert base station (CONVBASE) */
+#define COPT_STA     0x00010000         /* compiled option: station id (-STA=) */
+#define COPT_GLOBIAS 0x00020000         /* compiled option: glonass bias (-GLOBIAS=) */
+#define COPT_TADJ    0x00040000         /* compiled option: time-tag adjust (-TADJ=) */
+#define COPT_MAXSTDCP 0x00080000        /* compiled option: max std-dev of phase (-MAX_STD_CP=) */
+#define COPT_STDSLIP 0x00100000         /* compiled option: slip std-dev of phase (-STD_SLIP=) */
+#define COPT_TRKMADJ 0x00200000         /* compiled option: trk meas code adjust (-TRKM_ADJ=) */
+#define COPT_GAPION  0x00400000         /* compiled option: ppp iono reset gap (-GAP_RESION=) */
+
+#define PRF_PNTPOS  0                   /* profile stage: pntpos() */
+#define PRF_SATPOSS 1                   /* profile stage: satposs() */
+#define PRF_ZDRES   2                   /* profile stage: zdres() */
+#define PRF_DDRES   3                   /* profile stage: ddres() */
+#define PRF_FILTER  4                   /* profile stage: filter() */
+#define PRF_LAMBDA  5                   /* profile stage: resamb_LAMBDA() */
+#define PRF_HOLDAMB 6                   /* profile stage: holdamb() */
+#define PRF_VALPOS  7                   /* profile stage: valpos() */
+#define PRF_PPPRES  8                   /* profile stage: ppp_res() */
+#define PRF_PPPAR   9                   /* profile stage: ppp_ar() */
+#define PRF_READ    10                  /* profile stage: stream read */
+#define PRF_DECODE  11                  /* profile stage: stream decode */
+#define NPRFSTAGE   12                  /* number of profile stages */
+#define NPRFBIN     20                  /* number of profile histogram bins */
 
 #define SOLQ_NONE   0                   /* solution status: no solution */
 #define SOLQ_FIX    1                   /* solution status: fix */
@@ -536,6 +600,9 @@ extern "C" {
 #define initlock(f) InitializeCriticalSection(f)
 #define lock(f)     EnterCriticalSection(f)
 #define unlock(f)   LeaveCriticalSection(f)
+#define rtkloadacq(p)    ((uint32_t)InterlockedCompareExchange((volatile LONG *)(p),0,0))
+#define rtkstorerel(p,v) InterlockedExchange((volatile LONG *)(p),(LONG)(v))
+#define rtkfence()       MemoryBarrier()
 #define FILEPATHSEP '\\'
 #else
 #define thread_t    pthread_t
@@ -543,8 +610,16 @@ extern "C" {
 #define initlock(f) pthread_mutex_init(f,NULL)
 #define lock(f)     pthread_mutex_lock(f)
 #define unlock(f)   pthread_mutex_unlock(f)
+#define rtkloadacq(p)    __atomic_load_n(p,__ATOMIC_ACQUIRE) /* uint32_t */
+#define rtkstorerel(p,v) __atomic_store_n(p,v,__ATOMIC_RELEASE)
+#define rtkfence()       __atomic_thread_fence(__ATOMIC_SEQ_CST)
 #define FILEPATHSEP '/'
 #endif
+#ifdef _MSC_VER
+#define THREADLOCAL __declspec(thread) /* thread local storage */
+#else
+#define THREADLOCAL __thread
+#endif
 
 /* type definitions ----------------------------------------------------------*/
 
@@ -579,6 +654,29 @@ typedef struct {        /* observation data */
     obsd_t *data;       /* observation data records */
 } obs_t;
 
+typedef struct {        /* compact observation data (epoch indexed, packed) */
+    int ne,nemax;       /* number of epochs/allocated */
+    int n,nmax;         /* number of satellite records/allocated */
+    int ns,nsmax;       /* number of signals/allocated */
+    gtime_t *time;      /* epoch time (GPST) {time[ne]} */
+    gtime_t *eventime;  /* time of event (GPST) {eventime[ne]} */
+    uint8_t *rcv;       /* receiver number {rcv[ne]} */
+    uint8_t *timevalid; /* time is valid for time mark {timevalid[ne]} */
+    int *iobs;          /* index of first satellite record {iobs[ne+1]} */
+    uint8_t *sat;       /* satellite number {sat[n]} */
+    uint8_t *freq;      /* GLONASS frequency channel {freq[n]} */
+    int *isig;          /* index of first signal {isig[n+1]} */
+    uint8_t *slot;      /* signal slot in obsd_t (0:L1,1:L2,...) {slot[ns]} */
+    uint8_t *code;      /* code indicator (CODE_???) {code[ns]} */
+    uint8_t *LLI;       /* loss of lock indicator {LLI[ns]} */
+    uint8_t *qualL;     /* quality of carrier phase {qualL[ns]} */
+    uint8_t *qualP;     /* quality of pseudorange {qualP[ns]} */
+    uint16_t *SNR;      /* signal strength (0.001 dBHz) {SNR[ns]} */
+    double *L;          /* carrier-phase (cycle) {L[ns]} */
+    double *P;          /* pseudorange (m) {P[ns]} */
+    float *D;           /* doppler frequency (Hz) {D[ns]} */
+} obsc_t;
+
 typedef struct {        /* earth rotation parameter data type */
     double mjd;         /* mjd (days) */
     double xp,yp;       /* pole offset (rad) */
@@ -587,11 +685,37 @@ typedef struct {        /* earth rotation parameter data type */
     double lod;         /* length of day (s/day) */
 } erpd_t;
 
+typedef struct {        /* geoid model type */
+    int model;          /* geoid model (GEOID_???) */
+    const uint8_t *data; /* mapped geoid model file (NULL: not mapped) */
+    size_t size;        /* size of mapped geoid model file (bytes) */
+    FILE *fp;           /* geoid model file pointer (if not mapped) */
+    lock_t lock;        /* lock for geoid model file access */
+} geoid_t;
+
 typedef struct {        /* earth rotation parameter type */
     int n,nmax;         /* number and max number of data */
     erpd_t *data;       /* earth rotation parameter data */
 } erp_t;
 
+typedef struct {        /* astronomical context of epoch type */
+    gtime_t time;       /* epoch time (GPST) */
+    double erpv[5];     /* erp values {xp,yp,ut1_utc,lod} (rad,rad,s,s/d) */
+    double U[9];        /* eci to ecef transformation matrix */
+    double gmst;        /* greenwich mean sidereal time (rad) */
+    double rsun[3];     /* sun position in ecef (m) */
+    double rmoon[3];    /* moon position in ecef (m) */
+} astro_t;
+
+typedef struct {        /* tide displacement cache type */
+    int opt;            /* tide options of nodes */
+    double tint;        /* interval of nodes (s) */
+    double rr[3];       /* site position of nodes (ecef) (m) */
+    const double *odisp; /* ocean loading parameters of nodes */
+    double kn[4];       /* node indexes (time/tint) of ring slots (-1:empty) */
+    double dr[4][3];    /* displacements at nodes (ecef) (m) */
+} tidec_t;
+
 typedef struct {        /* antenna parameter type */
     int sat;            /* satellite number (0:receiver) */
     char type[MAXANT];  /* antenna type */
@@ -670,6 +794,12 @@ typedef struct {        /* precise ephemeris type */
     float  vco[MAXSAT][3]; /* satellite velocity covariance (m^2) */
 } peph_t;
 
+typedef struct {        /* precise ephemeris Chebyshev fit type */
+    gtime_t ts,te;      /* start/end time of fit interval (GPST) */
+    uint8_t n[MAXSAT];  /* number of coefficients (0: no fit) */
+    double c[MAXSAT][3][MAXPFIT]; /* coefficients in inertial frame at ts (m) */
+} pfit_t;
+
 typedef struct {        /* precise clock type */
     gtime_t time;       /* time (GPST) */
     int index;          /* clock index for multiple files */
@@ -722,6 +852,7 @@ typedef struct {        /* TEC grid type */
     double lats[3];     /* latitude start/interval (deg) */
     double lons[3];     /* longitude start/interval (deg) */
     double hgts[3];     /* heights start/interval (km) */
+    int stride[2];      /* TEC grid data index strides {lon,hgt} */
     double *data;       /* TEC grid data (tecu) */
     float *rms;         /* RMS values (tecu) */
 } tec_t;
@@ -766,6 +897,7 @@ typedef struct {        /* SBAS satellite corrections type */
     int nsat;           /* number of satellites */
     int tlat;           /* system latency (s) */
     sbssatp_t sat[MAXSAT]; /* satellite correction */
+    int16_t slot[MAXSAT]; /* slot of satellite in sat[] +1 (0:not in mask) */
 } sbssat_t;
 
 typedef struct {        /* SBAS ionospheric correction type */
@@ -821,6 +953,7 @@ typedef struct {        /* navigation data type */
     int ns,nsmax;       /* number of sbas ephemeris */
     int ne,nemax;       /* number of precise ephemeris */
     int nc,ncmax;       /* number of precise clock */
+    int nf;             /* number of precise ephemeris fits */
     int na,namax;       /* number of almanac data */
     int nt,ntmax;       /* number of tec grid data */
     eph_t *eph;         /* GPS/QZS/GAL/BDS/IRN ephemeris */
@@ -828,6 +961,7 @@ typedef struct {        /* navigation data type */
     seph_t *seph;       /* SBAS ephemeris */
     peph_t *peph;       /* precise ephemeris */
     pclk_t *pclk;       /* precise clock */
+    pfit_t *pfit;       /* precise ephemeris Chebyshev fits */
     alm_t *alm;         /* almanac data */
     tec_t *tec;         /* tec grid data */
     erp_t  erp;         /* earth rotation parameters */
@@ -844,11 +978,15 @@ typedef struct {        /* navigation data type */
     double ion_cmp[8];  /* BeiDou iono model parameters {a0,a1,a2,a3,b0,b1,b2,b3} */
     double ion_irn[8];  /* IRNSS iono model parameters {a0,a1,a2,a3,b0,b1,b2,b3} */
     int glo_fcn[32];    /* GLONASS FCN + 8 */
+    int glo_frq[32];    /* GLONASS FCN + 8 resolved by updatefcn() (0:unresolved) */
+    int eph_sel[7];     /* ephemeris selection {GPS,GLO,GAL,QZS,BDS,IRN,SBS} */
     double cbias[MAXSAT][3]; /* satellite DCB (0:P1-P2,1:P1-C1,2:P2-C2) (m) */
     double rbias[MAXRCV][2][3]; /* receiver DCB (0:P1-P2,1:P1-C1,2:P2-C2) (m) */
     pcv_t pcvs[MAXSAT]; /* satellite antenna pcv */
     sbssat_t sbssat;    /* SBAS satellite corrections */
     sbsion_t sbsion[MAXBAND+1]; /* SBAS ionosphere corrections */
+    int16_t sbsigpx[2][37][72]; /* SBAS IGP index of 5 deg grid {band 0-8,9-10}
+                           (lat=-90:5:90,lon=-180:5:175) (band*MAXNIGP+igp+1) */
     dgps_t dgps[MAXSAT]; /* DGPS corrections */
     ssr_t ssr[MAXSAT];  /* SSR corrections */
 } nav_t;
@@ -922,6 +1060,20 @@ typedef struct {        /* solution status buffer type */
     solstat_t *data;    /* solution status data */
 } solstatbuf_t;
 
+typedef struct {        /* compiled option type */
+    uint32_t flag;      /* option flags (COPT_???) */
+    int sta;            /* station id (-STA=) */
+    int maxstdcp;       /* max valid std-dev of carrier-phase (-MAX_STD_CP=) */
+    int stdslip;        /* slip threshold of std-dev of phase (-STD_SLIP=) */
+    int trkmadj;        /* trk meas code adjust (-TRKM_ADJ=) */
+    int gapion;         /* ppp ionosphere reset gap (-GAP_RESION=) */
+    double globias;     /* glonass bias (-GLOBIAS=) (m) */
+    double tadj;        /* time-tag adjustment (-TADJ=) (s) */
+    char sigpri[7][10]; /* first code option attribute {G,R,E,J,S,C,I}x{0-9} */
+    uint32_t sigmsk[7][10]; /* code option attributes (bit:'A'-'Z') */
+    char codepri[7][MAXFREQ][16]; /* code priority set by setcodepri() ("":default) */
+} copt_t;
+
 typedef struct {        /* RTCM control struct type */
     int staid;          /* station id */
     int stah;           /* station health */
@@ -952,6 +1104,7 @@ typedef struct {        /* RTCM control struct type */
     uint32_t nmsg2[100]; /* message count of RTCM 2 (1-99:1-99,0:other) */
     uint32_t nmsg3[400]; /* message count of RTCM 3 (1-299:1001-1299,300-329:4070-4099,0:ohter) */
     char opt[256];      /* RTCM dependent options */
+    copt_t copt;        /* compiled RTCM dependent options */
 } rtcm_t;
 
 typedef struct {        /* RINEX control struct type */
@@ -1057,6 +1210,8 @@ typedef struct {        /* processing options type */
     double odisp[2][6*11]; /* ocean tide loading parameters {rov,base} */
     int freqopt;        /* disable L2-AR */
     char pppopt[256];   /* ppp option */
+    double tideint;     /* tide displacement evaluation interval (s) (0:every epoch) */
+    int prof;           /* stage profiling (0:off,1:on) */
 } prcopt_t;
 
 typedef struct {        /* solution options type */
@@ -1072,7 +1227,7 @@ typedef struct {        /* solution options type */
     int height;         /* height (0:ellipsoidal,1:geodetic) */
     int geoid;          /* geoid model (0:EGM96,1:JGD2000) */
     int solstatic;      /* solution of static mode (0:all,1:single) */
-    int sstat;          /* solution statistics level (0:off,1:states,2:residuals) */
+    int sstat;          /* solution statistics level (0:off,1:states,2:residuals,3:binary) */
     int trace;          /* debug trace level (0:off,1-5:debug) */
     double nmeaintv[2]; /* nmea output interval (s) (<0:no,0:all) */
                         /* nmeaintv[0]:gprmc,gpgga,nmeaintv[1]:gpgsv */
@@ -1129,6 +1284,7 @@ typedef struct {        /* RINEX options type */
     int phshift;        /* phase shift correction */
     int halfcyc;        /* half cycle correction */
     int sep_nav;        /* separated nav files */
+    int onepass;        /* single-pass conversion (0:off,1:on) */
     gtime_t tstart;     /* first obs time */
     gtime_t tend;       /* last obs time */
     gtime_t trtcm;      /* approx log start time for rtcm */
@@ -1170,6 +1326,25 @@ typedef struct {        /* ambiguity control type */
     char flags[MAXSAT]; /* fix flags */
 } ambc_t;
 
+typedef struct {        /* profile stage type */
+    uint32_t n;         /* number of calls */
+    uint32_t pad;       /* padding */
+    double sum;         /* total time (us) */
+    double max;         /* max time (us) */
+    uint32_t hist[NPRFBIN]; /* histogram of time (0:<1us,i:<2^i us,NPRFBIN-1:over) */
+} prfstage_t;
+
+typedef struct {        /* stage profile type */
+    prfstage_t stage[NPRFSTAGE]; /* profile stages (PRF_???) */
+} prof_t;
+
+typedef struct {        /* solution status file type */
+    int level;          /* status output level (0:off) */
+    FILE *fp;           /* status file pointer */
+    char file[1024];    /* status file original path */
+    gtime_t time;       /* status file time */
+} statf_t;
+
 typedef struct {        /* RTK control/result type */
     sol_t  sol;         /* RTK solution */
     double rb[6];       /* base position/velocity (ecef) (m|m/s) */
@@ -1188,6 +1363,14 @@ typedef struct {        /* RTK control/result type */
     char errbuf[MAXERRMSG]; /* error message buffer */
     prcopt_t opt;       /* processing options */
     int initial_mode;   /* initial positioning mode */
+    statf_t *statf;     /* solution status file (NULL: shared by rtkopenstat()) */
+    obsd_t obsb[MAXOBS]; /* base obs of previous epoch for time-interpolation */
+    int nobsb;          /* number of base obs of previous epoch */
+    tidec_t tidec[2];   /* tide displacement caches {rover,base} */
+    copt_t copt;        /* compiled ppp options (opt.pppopt) */
+    int satact[MAXOBS]; /* satellites with valid status of last epoch */
+    int nsatact;        /* number of satellites with valid status */
+    prof_t prof;        /* stage profile (opt.prof) */
 } rtk_t;
 
 typedef struct {        /* receiver raw data control type */
@@ -1217,6 +1400,7 @@ typedef struct {        /* receiver raw data control type */
     int outtype;        /* output message type */
     uint8_t buff[MAXRAWLEN]; /* message buffer */
     char opt[256];      /* receiver dependent options */
+    copt_t copt;        /* compiled receiver dependent options */
     int format;         /* receiver stream format */
     void *rcv_data;     /* receiver dependent data */
 } raw_t;
@@ -1270,6 +1454,190 @@ typedef struct {        /* stream server type */
     lock_t lock;        /* lock flag */
 } strsvr_t;
 
+typedef struct {        /* packed solution record type */
+    uint32_t seq;       /* sequence number of solution */
+    uint8_t type;       /* type (0:xyz-ecef,1:enu-baseline) */
+    uint8_t stat;       /* solution status (SOLQ_???) */
+    uint8_t ns;         /* number of valid satellites */
+    uint8_t pad;        /* padding */
+    int64_t time;       /* time (GPST) (gtime_t.time) */
+    double sec;         /* time (GPST) (gtime_t.sec) */
+    double rr[6];       /* position/velocity (m|m/s) */
+    double dtr[6];      /* receiver clock bias to time systems (s) */
+    float qr[6];        /* position variance/covariance (m^2) */
+    float age;          /* age of differential (s) */
+    float ratio;        /* AR ratio factor for valiation */
+} solrec_t;
+
+typedef struct {        /* binary solution file header type (SOLF_BIN) */
+    char magic[7];      /* magic (SOLBIN_MAGIC) */
+    uint8_t ver;        /* format version (SOLBIN_VER) */
+    uint16_t hsize;     /* header size (bytes) */
+    uint16_t rsize;     /* record size (bytes) */
+    uint32_t order;     /* byte order mark (SOLBIN_ORDER) */
+    uint32_t flags;     /* record flags (SOLBIN_???) */
+    uint32_t reserved[3];
+} solbinh_t;
+
+typedef struct {        /* binary solution record type (SOLF_BIN) */
+    int64_t time;       /* time (GPST) (gtime_t.time) */
+    double rr[3];       /* position {x,y,z} or {e,n,u} (m) */
+    float qr[6];        /* position variance/covariance (m^2) */
+    uint32_t nsec;      /* time (GPST) fraction of second (ns) */
+    float age;          /* age of differential (s) */
+    float ratio;        /* AR ratio factor for valiation */
+    uint8_t type;       /* type (0:xyz-ecef,1:enu-baseline) */
+    uint8_t stat;       /* solution status (SOLQ_???) */
+    uint8_t ns;         /* number of valid satellites */
+    uint8_t pad;        /* padding */
+} solbin_t;
+
+typedef struct {        /* binary solution velocity record type (SOLBIN_VEL) */
+    double rv[3];       /* velocity {vx,vy,vz} or {ve,vn,vu} (m/s) */
+    float qv[6];        /* velocity variance/covariance (m^2/s^2) */
+} solbinv_t;
+
+typedef struct {        /* binary solution status header type (SSTAT_BIN) */
+    char magic[7];      /* magic (STATBIN_MAGIC) */
+    uint8_t ver;        /* format version (STATBIN_VER) */
+    uint16_t hsize;     /* header size (bytes) */
+    uint16_t esize;     /* epoch record header size (bytes) */
+    uint16_t ssize;     /* satellite record size (bytes) */
+    uint16_t fsize;     /* signal record size (bytes) */
+    uint32_t order;     /* byte order mark (SOLBIN_ORDER) */
+    uint32_t reserved[3];
+} statbinh_t;
+
+typedef struct {        /* binary solution status epoch record type */
+    uint32_t size;      /* record size (bytes) */
+    uint16_t nstate;    /* size of state records (bytes) */
+    uint16_t nsat;      /* number of satellite records */
+    int32_t week;       /* gps week */
+    uint8_t stat;       /* solution status (SOLQ_???) */
+    uint8_t nfreq;      /* number of signal records per satellite */
+    uint8_t pad[2];     /* padding */
+    double tow;         /* gps time of week (s) */
+} statbine_t;
+
+typedef struct {        /* binary solution status state record type */
+    uint8_t type;       /* state line type (STATL_???) */
+    uint8_t nv;         /* number of values (double) following the record */
+    uint16_t sat;       /* satellite number (0: no satellite field) */
+    int32_t idx;        /* index field (receiver, frequency, ...) */
+} statbinl_t;
+
+typedef struct {        /* binary solution status satellite record type */
+    double azel[2];     /* azimuth/elevation angles {az,el} (rad) */
+    uint16_t sat;       /* satellite number */
+    uint8_t pad[6];     /* padding */
+} statbins_t;
+
+typedef struct {        /* binary solution status signal record type */
+    double resp,resc;   /* residuals of pseudorange/carrier-phase (m) */
+    double bias,vbias;  /* phase bias/variance of phase bias */
+    double icbias;      /* glonass IC bias (cycles) */
+    int32_t lock;       /* lock counter of phase */
+    uint32_t outc;      /* obs outage counter of phase */
+    uint32_t slipc;     /* cycle-slip counter */
+    uint32_t rejc;      /* reject counter */
+    uint16_t snr;       /* rover signal strength (0.25 dBHz) */
+    uint8_t vsat;       /* valid satellite flag */
+    uint8_t fix;        /* ambiguity fix flag */
+    uint8_t slip;       /* cycle-slip flag */
+    uint8_t pad[3];     /* padding */
+} statbinf_t;
+
+typedef struct {        /* solution ring header type (shared memory) */
+    uint32_t nrec;      /* number of records (2^n) */
+    uint32_t size;      /* record size (bytes) */
+    uint32_t pad1[14];
+    uint32_t head;      /* number of written records (producer) */
+    uint32_t over;      /* number of dropped solutions (producer) */
+    uint32_t pad2[14];
+    uint32_t tail;      /* number of read records (consumer) */
+    uint32_t pad3[15];
+} solringh_t;
+
+typedef struct {        /* solution ring type (single producer/consumer) */
+    uint8_t *buff;      /* ring memory (header+records) */
+    int size;           /* ring memory size (bytes) */
+    solringh_t *h;      /* ring header */
+    solrec_t *rec;      /* ring records */
+} solring_t;
+
+typedef struct {        /* solution file stream type */
+    char **files;       /* solution files */
+    int nfile,ifile;    /* number of files/index of next file */
+    gtime_t ts,te;      /* start/end time */
+    double tint;        /* time interval (0: all) */
+    int qflag;          /* quality flag (0: all) */
+    FILE *fp;           /* file pointer of current file */
+    solopt_t opt;       /* solution options of current file */
+    solbuf_t solbuf;    /* solutions decoded from read buffer */
+    int isol;           /* index of next solution in solbuf */
+    char *buff;         /* read buffer */
+    int rsize,outvel;   /* binary record size (0: no header)/velocity flag */
+    double rb[3];       /* reference position {x,y,z} (ecef) (m) */
+    double tol;         /* decimation tolerance (m) (0: no decimation) */
+    int bystat;         /* keep solution status changes in decimation */
+    int n,nmax;         /* number of solutions/max number in window */
+    int nout,iout;      /* number of output/index of next output in window */
+    int end;            /* end of solutions in window */
+    sol_t *data;        /* solutions in window */
+    uint8_t *keep;      /* keep flags of solutions in window */
+    int *stack;         /* segment stack of decimation */
+} solfp_t;
+
+typedef struct {        /* observation status in status snapshot type */
+    int64_t time;       /* time of observation data (gtime_t.time) */
+    double sec;         /* time of observation data (gtime_t.sec) */
+    int32_t ns;         /* number of satellites */
+    int32_t pad;        /* padding */
+    double az[MAXOBS];  /* satellite azimuth angles (rad) */
+    double el[MAXOBS];  /* satellite elevation angles (rad) */
+    int16_t sat[MAXOBS]; /* satellite numbers */
+    int16_t snr[3][MAXOBS]; /* satellite snr {L1,L2,L5} (dBHz) */
+    uint8_t vsat[MAXOBS]; /* valid satellite flags */
+} snapobs_t;
+
+typedef struct {        /* satellite status in status snapshot type */
+    int16_t sat;        /* satellite number */
+    uint8_t vs;         /* valid satellite flag single */
+    uint8_t vsat;       /* valid satellite flag L1 */
+    uint8_t fix[3];     /* ambiguity fix flags {L1,L2,L5} */
+    uint8_t slip;       /* cycle-slip flags {L1,L2,L5} (bits 0-2) */
+    uint16_t lock;      /* lock counter L1 (0-65535) */
+    uint16_t outc;      /* obs outage counter L1 (0-65535) */
+    float az,el;        /* azimuth/elevation angles (rad) */
+    float resp,resc;    /* residuals of pseudorange/carrier-phase L1 (m) */
+} snapsat_t;
+
+typedef struct {        /* rtk server status snapshot type */
+    uint32_t ver;       /* snapshot version */
+    uint32_t size;      /* snapshot size (bytes) */
+    uint32_t seq;       /* sequence number of snapshot (0:invalid) */
+    uint32_t maxobs;    /* max number of satellites (MAXOBS) */
+    uint32_t offobs;    /* offset of obs (bytes) */
+    uint32_t sizeobs;   /* size of an observation status (bytes) */
+    uint32_t offsat;    /* offset of ssat (bytes) */
+    uint32_t offstr;    /* offset of strmsg (bytes) */
+    uint32_t offerr;    /* offset of errmsg (bytes) */
+    uint32_t pad;       /* padding */
+    int32_t sstat[MAXSTRRTK]; /* stream status */
+    solrec_t sol;       /* rtk solution */
+    double rb[6];       /* base position/velocity (ecef) (m|m/s) */
+    double tt;          /* time difference between current and previous (s) */
+    int32_t nx,na;      /* number of float states/fixed states */
+    int32_t nfix;       /* number of continuous fixes of ambiguity */
+    int32_t nsat;       /* number of satellite status */
+    int32_t cputime;    /* CPU time (ms) for a processing cycle */
+    int32_t prcout;     /* missing observation data count */
+    snapobs_t obs[3];   /* observation status {rov,base,corr} */
+    snapsat_t ssat[MAXOBS]; /* satellite status */
+    char strmsg[MAXSTRMSG]; /* stream status messages */
+    char errmsg[MAXSNAPMSG]; /* last error messages */
+} svrsnap_t;
+
 typedef struct {        /* RTK server type */
     int state;          /* server state (0:stop,1:running) */
     int cycle;          /* processing cycle (ms) */
@@ -1281,7 +1649,6 @@ typedef struct {        /* RTK server type */
     solopt_t solopt[2]; /* output solution options {sol1,sol2} */
     int navsel;         /* ephemeris select (0:all,1:rover,2:base,3:corr) */
     int nsbs;           /* number of sbas message */
-    int nsol;           /* number of solution buffer */
     rtk_t rtk;          /* RTK control/result struct */
     int nb [3];         /* bytes in input buffers {rov,base} */
     int nsb[2];         /* bytes in soulution buffers */
@@ -1289,7 +1656,10 @@ typedef struct {        /* RTK server type */
     uint8_t *buff[3];   /* input buffers {rov,base,corr} */
     uint8_t *sbuf[2];   /* output buffers {sol1,sol2} */
     uint8_t *pbuf[3];   /* peek buffers {rov,base,corr} */
-    sol_t solbuf[MAXSOLBUF]; /* solution buffer */
+    solring_t solring;  /* solution ring */
+    svrsnap_t *snap;    /* status snapshots (double buffer) */
+    uint32_t snapseq;   /* sequence number of last snapshot */
+    uint32_t snaptick;  /* tick of last snapshot */
     uint32_t nmsg[3][10]; /* input message counts */
     raw_t  raw [3];     /* receiver raw control {rov,base,corr} */
     rtcm_t rtcm[3];     /* RTCM control {rov,base,corr} */
@@ -1341,6 +1711,22 @@ typedef struct {        /* GIS type */
     double bound[4];    /* boundary {lat0,lat1,lon0,lon1} */
 } gis_t;
 
+typedef struct {        /* binary cache type */
+    char file[1024];    /* cache file path */
+    char tmpfile[1024]; /* temporary cache file path for writing */
+    FILE *fp;           /* file pointer for writing (NULL: no writing) */
+    char *buff;         /* mapped cache for reading (NULL: no reading) */
+    size_t size,pos;    /* mapped cache size and read position (bytes) */
+} cache_t;
+
+typedef struct {        /* uncompressed stream type */
+    FILE *fp;           /* uncompressed data stream for reading */
+    FILE *fpi;          /* compressed input file */
+    FILE *fpo;          /* uncompressed data stream for writing */
+    thread_t thread;    /* decompression thread */
+    int stat;           /* decompression status (0:ok,-1:error) */
+} uncomp_t;
+
 typedef void fatalfunc_t(const char *); /* fatal callback function type */
 
 /* global variables ----------------------------------------------------------*/
@@ -1365,8 +1751,11 @@ EXPORT int  code2idx(int sys, uint8_t code);
 EXPORT int  satexclude(int sat, double var, int svh, const prcopt_t *opt);
 EXPORT int  testsnr(int base, int freq, double el, double snr,
                     const snrmask_t *mask);
-EXPORT void setcodepri(int sys, int idx, const char *pri);
+EXPORT void setcodepri(copt_t *copt, int sys, int idx, const char *pri);
 EXPORT int  getcodepri(int sys, uint8_t code, const char *opt);
+EXPORT void compopt(const char *opt, copt_t *copt);
+EXPORT int  getcodepric(int sys, uint8_t code, const copt_t *copt);
+EXPORT int  testsigopt(const copt_t *copt, int sys, const char *obs);
 
 /* matrix and vector functions -----------------------------------------------*/
 EXPORT double *mat  (int n, int m);
@@ -1424,6 +1813,20 @@ EXPORT int read_leaps(const char *file);
 EXPORT int adjgpsweek(int week);
 EXPORT uint32_t tickget(void);
 EXPORT void sleepms(int ms);
+EXPORT int getncpu(void);
+EXPORT double prftick(void);
+EXPORT void prfadd  (prof_t *prof, int stage, double t);
+EXPORT void prfmerge(prof_t *dst, const prof_t *src);
+EXPORT double prfquant(const prfstage_t *stage, double p);
+EXPORT int  prf2str (const prof_t *prof, const char *prefix, char *buff);
+EXPORT void *mapfile(const char *file, size_t *size);
+EXPORT void unmapfile(void *p, size_t size);
+EXPORT void setcache(int ena, const char *dir);
+EXPORT int  opencache(const char *file, const char *key, cache_t *cache);
+EXPORT const void *getcache(cache_t *cache, int id, size_t size, int *n);
+EXPORT void putcache(cache_t *cache, int id, const void *data, size_t size,
+                     int n);
+EXPORT void closecache(cache_t *cache, int commit);
 
 EXPORT int reppath(const char *path, char *rpath, gtime_t time, const char *rov,
                    const char *base);
@@ -1437,6 +1840,16 @@ EXPORT void ecef2enu(const double *pos, const double *r, double *e);
 EXPORT void enu2ecef(const double *pos, const double *e, double *r);
 EXPORT void covenu  (const double *pos, const double *P, double *Q);
 EXPORT void covecef (const double *pos, const double *Q, double *P);
+EXPORT void ecef2pos_batch(const double *x, const double *y, const double *z,
+                           int n, double *lat, double *lon, double *h);
+EXPORT void pos2ecef_batch(const double *lat, const double *lon,
+                           const double *h, int n, double *x, double *y,
+                           double *z);
+EXPORT void ecef2enu_batch(const double *lat, const double *lon,
+                           const double *x, const double *y, const double *z,
+                           int n, double *e, double *nn, double *u);
+EXPORT void covenu_batch(const double *lat, const double *lon, const double *P,
+                         int n, double *Q);
 EXPORT void xyz2enu (const double *pos, double *E);
 EXPORT void eci2ecef(gtime_t tutc, const double *erpv, double *U, double *gmst);
 EXPORT void deg2dms (double deg, double *dms, int ndec);
@@ -1446,10 +1859,18 @@ EXPORT double dms2deg(const double *dms);
 EXPORT void readpos(const char *file, const char *rcv, double *pos);
 EXPORT int  sortobs(obs_t *obs);
 EXPORT void uniqnav(nav_t *nav);
+EXPORT void updatefcn(nav_t *nav);
 EXPORT int  screent(gtime_t time, gtime_t ts, gtime_t te, double tint);
 EXPORT int  readnav(const char *file, nav_t *nav);
 EXPORT int  savenav(const char *file, const nav_t *nav);
 EXPORT void freeobs(obs_t *obs);
+EXPORT int  addobsc (obsc_t *obsc, const obsd_t *data, int n);
+EXPORT int  catobsc (obsc_t *obsc, const obsc_t *src);
+EXPORT int  getobsc (const obsc_t *obsc, int epoch, obsd_t *data, int nmax);
+EXPORT int  sortobsc(obsc_t *obsc);
+EXPORT int  obs2obsc(const obs_t *obs, obsc_t *obsc);
+EXPORT int  obsc2obs(const obsc_t *obsc, obs_t *obs);
+EXPORT void freeobsc(obsc_t *obsc);
 EXPORT void freenav(nav_t *nav, int opt);
 EXPORT int  readblq(const char *file, const char *sta, double *odisp);
 EXPORT int  readerp(const char *file, erp_t *erp);
@@ -1493,6 +1914,9 @@ EXPORT double tropmapf(gtime_t time, const double *pos, const double *azel,
                        double *mapfw);
 EXPORT int iontec(gtime_t time, const nav_t *nav, const double *pos,
                   const double *azel, int opt, double *delay, double *var);
+EXPORT int iontec_sats(gtime_t time, const nav_t *nav, const double *pos,
+                       const double *azel, int n, int opt, double *delay,
+                       double *var, int *stat);
 EXPORT void readtec(const char *file, nav_t *nav, int opt);
 EXPORT int ionocorr(gtime_t time, const nav_t *nav, int sat, const double *pos,
                     const double *azel, int ionoopt, double *ion, double *var);
@@ -1510,13 +1934,23 @@ EXPORT void antmodel_s(const pcv_t *pcv, double nadir, double *dant);
 /* earth tide models ---------------------------------------------------------*/
 EXPORT void sunmoonpos(gtime_t tutc, const double *erpv, double *rsun,
                        double *rmoon, double *gmst);
+EXPORT void setastro(gtime_t time, const erp_t *erp, astro_t *astro);
 EXPORT void tidedisp(gtime_t tutc, const double *rr, int opt, const erp_t *erp,
-                     const double *odisp, double *dr);
+                     const double *odisp, const astro_t *astro, double *dr);
+EXPORT void tidedisp_cache(tidec_t *tc, double tint, gtime_t tutc,
+                           const double *rr, int opt, const erp_t *erp,
+                           const double *odisp, double *dr);
 
 /* geiod models --------------------------------------------------------------*/
 EXPORT int opengeoid(int model, const char *file);
 EXPORT void closegeoid(void);
 EXPORT double geoidh(const double *pos);
+EXPORT void geoidh_batch(const double *pos, int n, double *h);
+EXPORT int  opengeoid_ctx(geoid_t *geoid, int model, const char *file);
+EXPORT void closegeoid_ctx(geoid_t *geoid);
+EXPORT double geoidh_ctx(geoid_t *geoid, const double *pos);
+EXPORT void geoidh_batch_ctx(geoid_t *geoid, const double *pos, int n,
+                             double *h);
 
 /* datum transformation ------------------------------------------------------*/
 EXPORT int loaddatump(const char *file);
@@ -1529,6 +1963,9 @@ EXPORT int readrnx (const char *file, int rcv, const char *opt, obs_t *obs,
 EXPORT int readrnxt(const char *file, int rcv, gtime_t ts, gtime_t te,
                     double tint, const char *opt, obs_t *obs, nav_t *nav,
                     sta_t *sta);
+EXPORT int readrnxobsc(const char *file, int rcv, gtime_t ts, gtime_t te,
+                       double tint, const char *opt, obsc_t *obsc, nav_t *nav,
+                       sta_t *sta);
 EXPORT int readrnxc(const char *file, nav_t *nav);
 EXPORT int outrnxobsh(FILE *fp, const rnxopt_t *opt, const nav_t *nav);
 EXPORT int outrnxobsb(FILE *fp, const rnxopt_t *opt, const obsd_t *obs, int n,
@@ -1544,6 +1981,8 @@ EXPORT int outrnxnavb (FILE *fp, const rnxopt_t *opt, const eph_t *eph);
 EXPORT int outrnxgnavb(FILE *fp, const rnxopt_t *opt, const geph_t *geph);
 EXPORT int outrnxhnavb(FILE *fp, const rnxopt_t *opt, const seph_t *seph);
 EXPORT int rtk_uncompress(const char *file, char *uncfile);
+EXPORT int openuncomp(const char *file, uncomp_t *unc);
+EXPORT int closeuncomp(uncomp_t *unc);
 EXPORT int convrnx(int format, rnxopt_t *opt, const char *file, char **ofile);
 EXPORT int  init_rnxctr (rnxctr_t *rnx);
 EXPORT void free_rnxctr (rnxctr_t *rnx);
@@ -1561,17 +2000,19 @@ EXPORT void geph2pos(gtime_t time, const geph_t *geph, double *rs, double *dts,
 EXPORT void seph2pos(gtime_t time, const seph_t *seph, double *rs, double *dts,
                      double *var);
 EXPORT int  peph2pos(gtime_t time, int sat, const nav_t *nav, int opt,
-                     double *rs, double *dts, double *var);
+                     const astro_t *astro, double *rs, double *dts, double *var);
 EXPORT void satantoff(gtime_t time, const double *rs, int sat, const nav_t *nav,
-                      double *dant);
+                      const astro_t *astro, double *dant);
 EXPORT int  satpos(gtime_t time, gtime_t teph, int sat, int ephopt,
                    const nav_t *nav, double *rs, double *dts, double *var,
                    int *svh);
 EXPORT void satposs(gtime_t time, const obsd_t *obs, int n, const nav_t *nav,
-                    int sateph, double *rs, double *dts, double *var, int *svh);
-EXPORT void setseleph(int sys, int sel);
-EXPORT int  getseleph(int sys);
+                    int sateph, const astro_t *astro, double *rs, double *dts,
+                    double *var, int *svh);
+EXPORT void setseleph(nav_t *nav, int sys, int sel);
+EXPORT int  getseleph(const nav_t *nav, int sys);
 EXPORT void readsp3(const char *file, nav_t *nav, int opt);
+EXPORT int  fitpeph(nav_t *nav, double tol);
 EXPORT int  readsap(const char *file, gtime_t time, nav_t *nav);
 EXPORT int  readdcb(const char *file, nav_t *nav, const sta_t *sta);
 EXPORT int  readfcb(const char *file, nav_t *nav);
@@ -1664,6 +2105,12 @@ EXPORT int gen_rtcm3   (rtcm_t *rtcm, int type, int subtype, int sync);
 /* solution functions --------------------------------------------------------*/
 EXPORT void initsolbuf(solbuf_t *solbuf, int cyclic, int nmax);
 EXPORT void freesolbuf(solbuf_t *solbuf);
+EXPORT void soltorec(const sol_t *sol, uint32_t seq, solrec_t *rec);
+EXPORT void rectosol(const solrec_t *rec, sol_t *sol, uint32_t *seq);
+EXPORT int  solringinit(solring_t *ring, int nrec);
+EXPORT void solringfree(solring_t *ring);
+EXPORT int  solringput (solring_t *ring, const sol_t *sol);
+EXPORT int  solringget (solring_t *ring, sol_t *sol, uint32_t *seq);
 EXPORT void freesolstatbuf(solstatbuf_t *solstatbuf);
 EXPORT sol_t *getsol(solbuf_t *solbuf, int index);
 EXPORT int addsol(solbuf_t *solbuf, const sol_t *sol);
@@ -1673,8 +2120,23 @@ EXPORT int readsolt(char *files[], int nfile, gtime_t ts, gtime_t te,
 EXPORT int readsolstat(char *files[], int nfile, solstatbuf_t *statbuf);
 EXPORT int readsolstatt(char *files[], int nfile, gtime_t ts, gtime_t te,
                         double tint, solstatbuf_t *statbuf);
+EXPORT int convstat(const char *infile, const char *outfile);
+EXPORT int outstatl(uint8_t *buff, int type, int sat, int idx, const double *v);
+EXPORT int statl2str(const uint8_t *data, int n, int week, double tow, int stat,
+                     char *buff);
 EXPORT int inputsol(uint8_t data, gtime_t ts, gtime_t te, double tint,
                     int qflag, const solopt_t *opt, solbuf_t *solbuf);
+EXPORT int  solfopen (solfp_t *fp, char *files[], int nfile, gtime_t ts,
+                      gtime_t te, double tint, int qflag);
+EXPORT int  solfdecim(solfp_t *fp, double tol, int bystat);
+EXPORT int  solfopendp(solfp_t *fp, char *files[], int nfile, gtime_t ts,
+                       gtime_t te, double tint, int qflag, double tol,
+                       int bystat);
+EXPORT int  solfoffset(char *files[], int nfile, gtime_t ts, gtime_t te,
+                       double tint, int qflag, const double *offset, int all,
+                       double *dr, double *rb, gtime_t *time0);
+EXPORT int  solfread (solfp_t *fp, sol_t *sol);
+EXPORT void solfclose(solfp_t *fp);
 
 EXPORT int outprcopts(uint8_t *buff, const prcopt_t *opt);
 EXPORT int outsolheads(uint8_t *buff, const solopt_t *opt);
@@ -1694,16 +2156,26 @@ EXPORT int outnmea_gsa(uint8_t *buff, const sol_t *sol,
                        const ssat_t *ssat);
 EXPORT int outnmea_gsv(uint8_t *buff, const sol_t *sol,
                        const ssat_t *ssat);
+EXPORT int convsol(const char *infile, const char *outfile, gtime_t ts,
+                   gtime_t te, double tint, int qflg, const solopt_t *opt);
 
 /* google earth kml converter ------------------------------------------------*/
 EXPORT int convkml(const char *infile, const char *outfile, gtime_t ts,
                    gtime_t te, double tint, int qflg, double *offset,
                    int tcolor, int pcolor, int outalt, int outtime);
+EXPORT int convkmldp(const char *infile, const char *outfile, gtime_t ts,
+                     gtime_t te, double tint, int qflg, double *offset,
+                     int tcolor, int pcolor, int outalt, int outtime,
+                     double tol);
 
 /* gpx converter -------------------------------------------------------------*/
 EXPORT int convgpx(const char *infile, const char *outfile, gtime_t ts,
                    gtime_t te, double tint, int qflg, double *offset,
                    int outtrk, int outpnt, int outalt, int outtime);
+EXPORT int convgpxdp(const char *infile, const char *outfile, gtime_t ts,
+                     gtime_t te, double tint, int qflg, double *offset,
+                     int outtrk, int outpnt, int outalt, int outtime,
+                     double tol);
 
 /* sbas functions ------------------------------------------------------------*/
 EXPORT int  sbsreadmsg (const char *file, int sel, sbs_t *sbs);
@@ -1772,15 +2244,21 @@ EXPORT void rtkfree(rtk_t *rtk);
 EXPORT int  rtkpos (rtk_t *rtk, const obsd_t *obs, int nobs, const nav_t *nav);
 EXPORT int  rtkopenstat(const char *file, int level);
 EXPORT void rtkclosestat(void);
+EXPORT int  rtkopenstatf(statf_t *statf, const char *file, int level);
+EXPORT void rtkclosestatf(statf_t *statf);
 EXPORT int  rtkoutstat(rtk_t *rtk, char *buff);
+EXPORT int  rtkoutstatb(rtk_t *rtk, uint8_t *buff);
 
 /* precise point positioning -------------------------------------------------*/
 EXPORT void pppos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav);
 EXPORT int pppnx(const prcopt_t *opt);
+EXPORT int pppib(int sat, int f, const prcopt_t *opt);
 EXPORT int pppoutstat(rtk_t *rtk, char *buff);
+EXPORT int pppoutstatb(rtk_t *rtk, uint8_t *buff);
 
 EXPORT int ppp_ar(rtk_t *rtk, const obsd_t *obs, int n, int *exc,
-                  const nav_t *nav, const double *azel, double *x, double *P);
+                  const nav_t *nav, const double *azel, double *x, double *P,
+                  const int *ix, int na);
 
 /* post-processing positioning -----------------------------------------------*/
 EXPORT int postpos(gtime_t ts, gtime_t te, double ti, double tu,
@@ -1817,6 +2295,8 @@ EXPORT void rtksvrunlock(rtksvr_t *svr);
 EXPORT int  rtksvrostat (rtksvr_t *svr, int type, gtime_t *time, int *sat,
                          double *az, double *el, int **snr, int *vsat);
 EXPORT void rtksvrsstat (rtksvr_t *svr, int *sstat, char *msg);
+EXPORT int  rtksvrpstat (rtksvr_t *svr, prof_t *prof, int reset);
+EXPORT int  rtksvrsnap  (rtksvr_t *svr, svrsnap_t *snap);
 EXPORT int  rtksvrmark(rtksvr_t *svr, const char *name, const char *comment);
 
 /* downloader functions ------------------------------------------------------*/
@@ -56,6 +56,8 @@
 #define SQRT(x)     ((x)<=0.0||(x)!=(x)?0.0:sqrt(x))
 #define MIN(x,y)    ((x)<=(y)?(x):(y))
 #define MAX(x,y)    ((x)>=(y)?(x):(y))
+#define PRFTICK(rtk) ((rtk)->opt.prof?prftick():0.0) /* tick of profile stage */
+#define PRFADD(rtk,s,t) ((rtk)->opt.prof?prfadd(&(rtk)->prof,s,prftick()-(t)):(void)0)
 #define ROUND(x)    (int)floor((x)+0.5)
 
 #define VAR_POS     SQR(30.0) /* initial variance of receiver pos (m^2) */
@@ -88,18 +90,38 @@
 #define IB(s,f,opt) (NR(opt)+MAXSAT*(f)+(s)-1) /* phase bias (s:satno,f:freq) */
 
 /* global variables ----------------------------------------------------------*/
-static int statlevel=0;          /* rtk status output level (0:off) */
-static FILE *fp_stat=NULL;       /* rtk status file pointer */
-static char file_stat[1024]="";  /* rtk status file original path */
-static gtime_t time_stat={0};    /* rtk status file time */
+static statf_t statf_={0};       /* rtk status file shared by rtkopenstat() */
 
+/* write binary solution status header --------------------------------------*/
+static void outstatbinh(FILE *fp)
+{
+    statbinh_t h={{0}};
+    
+    memcpy(h.magic,STATBIN_MAGIC,7);
+    h.ver  =STATBIN_VER;
+    h.hsize=(uint16_t)sizeof(statbinh_t);
+    h.esize=(uint16_t)sizeof(statbine_t);
+    h.ssize=(uint16_t)sizeof(statbins_t);
+    h.fsize=(uint16_t)sizeof(statbinf_t);
+    h.order=SOLBIN_ORDER;
+    fwrite(&h,sizeof(h),1,fp);
+}
 /* open solution status file ---------------------------------------------------
 * open solution status file and set output level
-* args   : char     *file   I   rtk status file
-*          int      level   I   rtk status level (0: off)
+* args   : statf_t  *statf  IO  solution status file
+*          char     *file   I   rtk status file
+*          int      level   I   rtk status level
+*                               (0:off,1:states,2:residuals,
+*                                3:residuals in binary (SSTAT_BIN))
 * return : status (1:ok,0:error)
 * notes  : file can constain time keywords (%Y,%y,%m...) defined in reppath().
 *          The time to replace keywords is based on UTC of CPU time.
+*          with level SSTAT_BIN, the records below are not formatted in real-
+*          time. a binary epoch record (statbine_t) with the raw values of
+*          states (statbinl_t) and the raw satellite (statbins_t) and signal
+*          (statbinf_t) status of $SAT records follows the file header
+*          (statbinh_t). convstat() renders the file to the text format.
+*          readsolstat() reads both.
 * output : solution status file record format
 *
 *   $POS,week,tow,stat,posx,posy,posz,posxf,posyf,poszf
@@ -167,7 +189,7 @@ static gtime_t time_stat={0};    /* rtk status file time */
 *          lambda   : wavelength
 *
 *-----------------------------------------------------------------------------*/
-extern int rtkopenstat(const char *file, int level)
+extern int rtkopenstatf(statf_t *statf, const char *file, int level)
 {
     gtime_t time=utc2gpst(timeget());
     char path[1024];
@@ -178,160 +200,239 @@ extern int rtkopenstat(const char *file, int level)
     
     reppath(file,path,time,"","");
     
-    if (!(fp_stat=fopen(path,"w"))) {
+    if (!(statf->fp=fopen(path,level>=SSTAT_BIN?"wb":"w"))) {
         trace(1,"rtkopenstat: file open error path=%s\n",path);
         return 0;
     }
-    strcpy(file_stat,file);
-    time_stat=time;
-    statlevel=level;
+    if (level>=SSTAT_BIN) outstatbinh(statf->fp);
+    
+    strcpy(statf->file,file);
+    statf->time=time;
+    statf->level=level;
     return 1;
 }
 /* close solution status file --------------------------------------------------
 * close solution status file
-* args   : none
+* args   : statf_t *statf   IO  solution status file
 * return : none
 *-----------------------------------------------------------------------------*/
-extern void rtkclosestat(void)
+extern void rtkclosestatf(statf_t *statf)
 {
     trace(3,"rtkclosestat:\n");
     
-    if (fp_stat) fclose(fp_stat);
-    fp_stat=NULL;
-    file_stat[0]='\0';
-    statlevel=0;
+    if (statf->fp) fclose(statf->fp);
+    statf->fp=NULL;
+    statf->file[0]='\0';
+    statf->level=0;
 }
-/* write solution status to buffer -------------------------------------------*/
-extern int rtkoutstat(rtk_t *rtk, char *buff)
+/* open/close shared solution status file --------------------------------------
+* open/close solution status file shared by rtk control structs without own
+* status file (rtk->statf==NULL)
+* args   : char     *file   I   rtk status file
+*          int      level   I   rtk status level (0: off)
+* return : status (1:ok,0:error)
+* notes  : to output solution status of concurrent solutions, set rtk->statf
+*          to a separate status file opened by rtkopenstatf() for each solution
+*-----------------------------------------------------------------------------*/
+extern int rtkopenstat(const char *file, int level)
+{
+    return rtkopenstatf(&statf_,file,level);
+}
+extern void rtkclosestat(void)
+{
+    rtkclosestatf(&statf_);
+}
+/* write solution status states to buffer as binary records ------------------*/
+extern int rtkoutstatb(rtk_t *rtk, uint8_t *buff)
 {
     ssat_t *ssat;
-    double tow,pos[3],vel[3],acc[3],vela[3]={0},acca[3]={0},xa[3];
-    int i,j,week,est,nfreq,nf=NF(&rtk->opt);
-    char id[32],*p=buff;
+    double pos[3],v[12];
+    int i,j,est,nf=NF(&rtk->opt);
+    uint8_t *p=buff;
     
     if (rtk->sol.stat<=SOLQ_NONE) {
         return 0;
     }
     /* write ppp solution status to buffer */
     if (rtk->opt.mode>=PMODE_PPP_KINEMA) {
-        return pppoutstat(rtk,buff);
+        return pppoutstatb(rtk,buff);
     }
     est=rtk->opt.mode>=PMODE_DGPS;
-    nfreq=est?nf:1;
-    tow=time2gpst(rtk->sol.time,&week);
     
     /* receiver position */
-    if (est) {
-        for (i=0;i<3;i++) xa[i]=i<rtk->na?rtk->xa[i]:0.0;
-        p+=sprintf(p,"$POS,%d,%.3f,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",week,tow,
-                   rtk->sol.stat,rtk->x[0],rtk->x[1],rtk->x[2],xa[0],xa[1],
-                   xa[2]);
-    }
-    else {
-        p+=sprintf(p,"$POS,%d,%.3f,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",week,tow,
-                   rtk->sol.stat,rtk->sol.rr[0],rtk->sol.rr[1],rtk->sol.rr[2],
-                   0.0,0.0,0.0);
+    for (i=0;i<3;i++) {
+        v[i  ]=est?rtk->x[i]:rtk->sol.rr[i];
+        v[i+3]=est&&i<rtk->na?rtk->xa[i]:0.0;
     }
+    p+=outstatl(p,STATL_POS,0,0,v);
+    
     /* receiver velocity and acceleration */
+    for (i=0;i<12;i++) v[i]=0.0;
+    ecef2pos(rtk->sol.rr,pos);
     if (est&&rtk->opt.dynamics) {
-        ecef2pos(rtk->sol.rr,pos);
-        ecef2enu(pos,rtk->x+3,vel);
-        ecef2enu(pos,rtk->x+6,acc);
-        if (rtk->na>=6) ecef2enu(pos,rtk->xa+3,vela);
-        if (rtk->na>=9) ecef2enu(pos,rtk->xa+6,acca);
-        p+=sprintf(p,"$VELACC,%d,%.3f,%d,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f\n",
-                   week,tow,rtk->sol.stat,vel[0],vel[1],vel[2],acc[0],acc[1],
-                   acc[2],vela[0],vela[1],vela[2],acca[0],acca[1],acca[2]);
+        ecef2enu(pos,rtk->x+3,v);
+        ecef2enu(pos,rtk->x+6,v+3);
+        if (rtk->na>=6) ecef2enu(pos,rtk->xa+3,v+6);
+        if (rtk->na>=9) ecef2enu(pos,rtk->xa+6,v+9);
     }
     else {
-        ecef2pos(rtk->sol.rr,pos);
-        ecef2enu(pos,rtk->sol.rr+3,vel);
-        p+=sprintf(p,"$VELACC,%d,%.3f,%d,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f\n",
-                   week,tow,rtk->sol.stat,vel[0],vel[1],vel[2],
-                   0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0);
+        ecef2enu(pos,rtk->sol.rr+3,v);
     }
+    p+=outstatl(p,STATL_VELACC,0,0,v);
+    
     /* receiver clocks */
-    p+=sprintf(p,"$CLK,%d,%.3f,%d,%d,%.3f,%.3f,%.3f,%.3f,%.2f\n",
-               week,tow,rtk->sol.stat,1,rtk->sol.dtr[0]*1E9,rtk->sol.dtr[1]*1E9,
-            rtk->sol.dtr[2]*1E9,rtk->sol.dtr[3]*1E9,rtk->com_bias);
+    for (i=0;i<4;i++) v[i]=rtk->sol.dtr[i]*1E9;
+    v[4]=rtk->com_bias;
+    p+=outstatl(p,STATL_CLK,0,1,v);
     
     /* ionospheric parameters */
     if (est&&rtk->opt.ionoopt==IONOOPT_EST) {
         for (i=0;i<MAXSAT;i++) {
             ssat=rtk->ssat+i;
             if (!ssat->vs) continue;
-            satno2id(i+1,id);
             j=II(i+1,&rtk->opt);
-            xa[0]=j<rtk->na?rtk->xa[j]:0.0;
-            p+=sprintf(p,"$ION,%d,%.3f,%d,%s,%.1f,%.1f,%.4f,%.4f\n",week,tow,
-                       rtk->sol.stat,id,ssat->azel[0]*R2D,ssat->azel[1]*R2D,
-                       rtk->x[j],xa[0]);
+            v[0]=ssat->azel[0]*R2D;
+            v[1]=ssat->azel[1]*R2D;
+            v[2]=rtk->x[j];
+            v[3]=j<rtk->na?rtk->xa[j]:0.0;
+            p+=outstatl(p,STATL_ION,i+1,0,v);
         }
     }
     /* tropospheric parameters */
     if (est&&(rtk->opt.tropopt==TROPOPT_EST||rtk->opt.tropopt==TROPOPT_ESTG)) {
         for (i=0;i<2;i++) {
             j=IT(i,&rtk->opt);
-            xa[0]=j<rtk->na?rtk->xa[j]:0.0;
-            p+=sprintf(p,"$TROP,%d,%.3f,%d,%d,%.4f,%.4f\n",week,tow,
-                       rtk->sol.stat,i+1,rtk->x[j],xa[0]);
+            v[0]=rtk->x[j];
+            v[1]=j<rtk->na?rtk->xa[j]:0.0;
+            p+=outstatl(p,STATL_TROP,0,i+1,v);
         }
     }
     /* receiver h/w bias */
     if (est&&rtk->opt.glomodear==GLO_ARMODE_AUTOCAL) {
-        for (i=0;i<nfreq;i++) {
+        for (i=0;i<nf;i++) {
             j=IL(i,&rtk->opt);
-            xa[0]=j<rtk->na?rtk->xa[j]:0.0;
-            p+=sprintf(p,"$HWBIAS,%d,%.3f,%d,%d,%.4f,%.4f\n",week,tow,
-                       rtk->sol.stat,i+1,rtk->x[j],xa[0]);
+            v[0]=rtk->x[j];
+            v[1]=j<rtk->na?rtk->xa[j]:0.0;
+            p+=outstatl(p,STATL_HWBIAS,0,i+1,v);
         }
     }
     return (int)(p-buff);
 }
+/* write solution status to buffer -------------------------------------------*/
+extern int rtkoutstat(rtk_t *rtk, char *buff)
+{
+    uint8_t data[MAXSOLMSG];
+    double tow;
+    int n,week;
+    
+    if ((n=rtkoutstatb(rtk,data))<=0) return 0;
+    
+    tow=time2gpst(rtk->sol.time,&week);
+    return statl2str(data,n,week,tow,rtk->sol.stat,buff);
+}
 /* swap solution status file -------------------------------------------------*/
-static void swapsolstat(void)
+static void swapsolstat(statf_t *statf)
 {
     gtime_t time=utc2gpst(timeget());
     char path[1024];
     
-    if ((int)(time2gpst(time     ,NULL)/INT_SWAP_STAT)==
-        (int)(time2gpst(time_stat,NULL)/INT_SWAP_STAT)) {
+    if ((int)(time2gpst(time       ,NULL)/INT_SWAP_STAT)==
+        (int)(time2gpst(statf->time,NULL)/INT_SWAP_STAT)) {
         return;
     }
-    time_stat=time;
+    statf->time=time;
     
-    if (!reppath(file_stat,path,time,"","")) {
+    if (!reppath(statf->file,path,time,"","")) {
         return;
     }
-    if (fp_stat) fclose(fp_stat);
+    if (statf->fp) fclose(statf->fp);
     
-    if (!(fp_stat=fopen(path,"w"))) {
+    if (!(statf->fp=fopen(path,statf->level>=SSTAT_BIN?"wb":"w"))) {
         trace(2,"swapsolstat: file open error path=%s\n",path);
         return;
     }
+    if (statf->level>=SSTAT_BIN) outstatbinh(statf->fp);
     trace(3,"swapsolstat: path=%s\n",path);
 }
+/* output solution status in binary ------------------------------------------*/
+static void outsolstatb(rtk_t *rtk, FILE *fp, const uint8_t *state,
+                        int nstate)
+{
+    struct {
+        statbins_t s;
+        statbinf_t f[NFREQ];
+    } rec;
+    statbine_t e={0};
+    ssat_t *ssat;
+    int i,j,k,week,nf=NF(&rtk->opt);
+    
+    memset(&rec,0,sizeof(rec));
+    
+    e.tow=time2gpst(rtk->sol.time,&week);
+    e.week=week;
+    e.stat=rtk->sol.stat;
+    e.nstate=(uint16_t)nstate;
+    
+    if (rtk->sol.stat!=SOLQ_NONE) {
+        e.nfreq=(uint8_t)(rtk->opt.mode>=PMODE_DGPS?nf:1);
+        for (i=0;i<MAXSAT;i++) if (rtk->ssat[i].vs) e.nsat++;
+    }
+    e.size=(uint32_t)(sizeof(e)+nstate+e.nsat*(sizeof(statbins_t)+
+                      e.nfreq*sizeof(statbinf_t)));
+    fwrite(&e,sizeof(e),1,fp);
+    fwrite(state,nstate,1,fp);
+    
+    for (i=0;i<MAXSAT&&e.nsat>0;i++) {
+        ssat=rtk->ssat+i;
+        if (!ssat->vs) continue;
+        rec.s.azel[0]=ssat->azel[0];
+        rec.s.azel[1]=ssat->azel[1];
+        rec.s.sat=(uint16_t)(i+1);
+        for (j=0;j<e.nfreq;j++) {
+            k=IB(i+1,j,&rtk->opt);
+            rec.f[j].resp  =ssat->resp[j];
+            rec.f[j].resc  =ssat->resc[j];
+            rec.f[j].bias  =k<rtk->nx?rtk->x[k]:0.0;
+            rec.f[j].vbias =k<rtk->nx?rtk->P[k+k*rtk->nx]:0.0;
+            rec.f[j].icbias=ssat->icbias[j];
+            rec.f[j].lock  =ssat->lock[j];
+            rec.f[j].outc  =ssat->outc[j];
+            rec.f[j].slipc =ssat->slipc[j];
+            rec.f[j].rejc  =ssat->rejc[j];
+            rec.f[j].snr   =ssat->snr_rover[j];
+            rec.f[j].vsat  =ssat->vsat[j];
+            rec.f[j].fix   =ssat->fix[j];
+            rec.f[j].slip  =ssat->slip[j]&3;
+        }
+        fwrite(&rec,sizeof(statbins_t)+e.nfreq*sizeof(statbinf_t),1,fp);
+    }
+}
 /* output solution status ----------------------------------------------------*/
 static void outsolstat(rtk_t *rtk,const nav_t *nav)
 {
+    statf_t *statf=rtk->statf?rtk->statf:&statf_;
     ssat_t *ssat;
-    double tow;
+    double tow,bias,vbias;
     char buff[MAXSOLMSG+1],id[32];
     int i,j,k,n,week,nfreq,nf=NF(&rtk->opt);
     
-    if (statlevel<=0||!fp_stat||!rtk->sol.stat) return;
+    if (statf->level<=0||!statf->fp||!rtk->sol.stat) return;
     
     trace(3,"outsolstat:\n");
     
     /* swap solution status file */
-    swapsolstat();
+    swapsolstat(statf);
     
-    /* write solution status */
+    /* write solution status states without formatting for binary */
+    if (statf->level>=SSTAT_BIN) {
+        n=rtkoutstatb(rtk,(uint8_t *)buff);
+        outsolstatb(rtk,statf->fp,(uint8_t *)buff,n);
+        return;
+    }
     n=rtkoutstat(rtk,buff); buff[n]='\0';
+    fputs(buff,statf->fp);
     
-    fputs(buff,fp_stat);
-    
-    if (rtk->sol.stat==SOLQ_NONE||statlevel<=1) return;
+    if (rtk->sol.stat==SOLQ_NONE||statf->level<=1) return;
     
     tow=time2gpst(rtk->sol.time,&week);
     nfreq=rtk->opt.mode>=PMODE_DGPS?nf:1;
@@ -343,12 +444,13 @@ static void outsolstat(rtk_t *rtk,const nav_t *nav)
         satno2id(i+1,id);
         for (j=0;j<nfreq;j++) {
             k=IB(i+1,j,&rtk->opt);
-            fprintf(fp_stat,"$SAT,%d,%.3f,%s,%d,%.1f,%.1f,%.4f,%.4f,%d,%.0f,%d,%d,%d,%d,%d,%d,%.2f,%.6f,%.5f\n",
+            bias=k<rtk->nx?rtk->x[k]:0.0; /* no bias states in single/dgps */
+            vbias=k<rtk->nx?rtk->P[k+k*rtk->nx]:0.0;
+            fprintf(statf->fp,"$SAT,%d,%.3f,%s,%d,%.1f,%.1f,%.4f,%.4f,%d,%.0f,%d,%d,%d,%d,%d,%d,%.2f,%.6f,%.5f\n",
                     week,tow,id,j+1,ssat->azel[0]*R2D,ssat->azel[1]*R2D,
                     ssat->resp[j],ssat->resc[j],ssat->vsat[j],ssat->snr_rover[j]*SNR_UNIT,
                     ssat->fix[j],ssat->slip[j]&3,ssat->lock[j],ssat->outc[j],
-                    ssat->slipc[j],ssat->rejc[j],rtk->x[k],
-                    rtk->P[k+k*rtk->nx],ssat->icbias[j]);
+                    ssat->slipc[j],ssat->rejc[j],bias,vbias,ssat->icbias[j]);
         }
     }
 }
@@ -447,6 +549,22 @@ static void initx(rtk_t *rtk, double xi, double var, int i)
         rtk->P[i+j*rtk->nx]=rtk->P[j+i*rtk->nx]=i==j?var:0.0;
     }
 }
+/* init valid flags, snr and residuals of satellites of last epoch and obs --*/
+static void initssat(rtk_t *rtk, const obsd_t *obs, int n)
+{
+    int i,j,sat;
+    
+    for (i=0;i<rtk->nsatact+n;i++) {
+        sat=i<rtk->nsatact?rtk->satact[i]:obs[i-rtk->nsatact].sat;
+        for (j=0;j<NFREQ;j++) {
+            rtk->ssat[sat-1].vsat[j]=0;
+            rtk->ssat[sat-1].snr_rover[j]=0;
+            rtk->ssat[sat-1].snr_base[j] =0;
+            rtk->ssat[sat-1].resp[j]=rtk->ssat[sat-1].resc[j]=0.0;
+        }
+    }
+    rtk->nsatact=0;
+}
 /* select common satellites between rover and reference station --------------*/
 static int selsat(const obsd_t *obs, double *azel, int nu, int nr,
                   const prcopt_t *opt, int *sat, int *iu, int *ir)
@@ -936,13 +1054,15 @@ static void zdres_sat(int base, double r, const obsd_t *obs, const nav_t *nav,
         I   rr   = rcvr pos (x,y,z)
         I   opt  = options
         I   index: 0=base,1=rover 
+        IO  tc   = tide displacement cache of rcvr
         O   y[(0:1)+i*2] = zero diff residuals {phase,code} (m)
         O   e    = line of sight unit vectors to sats
         O   azel = [az, el] to sats                                           */
 static int zdres(int base, const obsd_t *obs, int n, const double *rs,
                  const double *dts, const double *var, const int *svh,
                  const nav_t *nav, const double *rr, const prcopt_t *opt,
-                 int index, double *y, double *e, double *azel, double *freq)
+                 int index, tidec_t *tc, double *y, double *e, double *azel,
+                 double *freq)
 {
     double r,rr_[3],pos[3],dant[NFREQ]={0},disp[3];
     double zhd,zazel[]={0.0,90.0*D2R};
@@ -960,8 +1080,8 @@ static int zdres(int base, const obsd_t *obs, int n, const double *rs,
     
     /* adjust rcvr pos for earth tide correction */
     if (opt->tidecorr) {
-        tidedisp(gpst2utc(obs[0].time),rr_,opt->tidecorr,&nav->erp,
-                 opt->odisp[base],disp);
+        tidedisp_cache(tc,opt->tideint,gpst2utc(obs[0].time),rr_,
+                       opt->tidecorr,&nav->erp,opt->odisp[base],disp);
         for (i=0;i<3;i++) rr_[i]+=disp[i];
     }
     /* translate rcvr pos from ecef to geodetic */
@@ -1153,9 +1273,10 @@ static int ddres(rtk_t *rtk, const nav_t *nav, const obsd_t *obs, double dt, con
     Ri=mat(ns*nf*2+2,1); Rj=mat(ns*nf*2+2,1); im=mat(ns,1);
     tropu=mat(ns,1); tropr=mat(ns,1); dtdxu=mat(ns,3); dtdxr=mat(ns,3);
     
-    /* zero out residual phase and code biases for all satellites */
-    for (i=0;i<MAXSAT;i++) for (j=0;j<NFREQ;j++) {
-        rtk->ssat[i].resp[j]=rtk->ssat[i].resc[j]=0.0;
+    /* zero out residual phase and code biases for common satellites */
+    /* (others are cleared by initssat()) */
+    for (i=0;i<ns;i++) for (j=0;j<NFREQ;j++) {
+        rtk->ssat[sat[i]-1].resp[j]=rtk->ssat[sat[i]-1].resc[j]=0.0;
     }
     /* compute factors of ionospheric and tropospheric delay
            - only used if kalman filter contains states for ION and TROP delays
@@ -1347,26 +1468,31 @@ static int ddres(rtk_t *rtk, const nav_t *nav, const obsd_t *obs, double dt, con
 static double intpres(gtime_t time, const obsd_t *obs, int n, const nav_t *nav,
                       rtk_t *rtk, double *y)
 {
-    static obsd_t obsb[MAXOBS];
-    static double yb[MAXOBS*NFREQ*2],rs[MAXOBS*6],dts[MAXOBS*2],var[MAXOBS];
-    static double e[MAXOBS*3],azel[MAXOBS*2],freq[MAXOBS*NFREQ];
-    static int nb=0,svh[MAXOBS*2];
+    obsd_t *obsb=rtk->obsb;
+    double yb[MAXOBS*NFREQ*2],rs[MAXOBS*6],dts[MAXOBS*2],var[MAXOBS];
+    double e[MAXOBS*3],azel[MAXOBS*2],freq[MAXOBS*NFREQ];
     prcopt_t *opt=&rtk->opt;
-    double tt=timediff(time,obs[0].time),ttb,*p,*q;
-    int i,j,k,nf=NF(opt);
+    double tt=timediff(time,obs[0].time),ttb,*p,*q,tick;
+    int i,j,k,nb=rtk->nobsb,svh[MAXOBS*2],nf=NF(opt),stat;
     
     trace(3,"intpres : n=%d tt=%.1f\n",n,tt);
     
     if (nb==0||fabs(tt)<DTTOL) {
-        nb=n; for (i=0;i<n;i++) obsb[i]=obs[i];
+        rtk->nobsb=n; for (i=0;i<n;i++) obsb[i]=obs[i];
         return tt;
     }
     ttb=timediff(time,obsb[0].time);
     if (fabs(ttb)>opt->maxtdiff*2.0||ttb==tt) return tt;
     
-    satposs(time,obsb,nb,nav,opt->sateph,rs,dts,var,svh);
+    tick=PRFTICK(rtk);
+    satposs(time,obsb,nb,nav,opt->sateph,NULL,rs,dts,var,svh);
+    PRFADD(rtk,PRF_SATPOSS,tick);
     
-    if (!zdres(1,obsb,nb,rs,dts,var,svh,nav,rtk->rb,opt,1,yb,e,azel,freq)) {
+    tick=PRFTICK(rtk);
+    stat=zdres(1,obsb,nb,rs,dts,var,svh,nav,rtk->rb,opt,1,rtk->tidec+1,yb,e,
+               azel,freq);
+    PRFADD(rtk,PRF_ZDRES,tick);
+    if (!stat) {
         return tt;
     }
     for (i=0;i<n;i++) {
@@ -1706,6 +1832,7 @@ static int manage_amb_LAMBDA(rtk_t *rtk, double *bias, double *xa, const int *sa
     int i,f,lockc[NFREQ],ar=0,excflag=0,arsats[MAXOBS]={0};
     int gps1=-1,glo1=-1,gps2,glo2,nb,rerun,dly;
     float ratio1;
+    double tick;
 
     trace(3,"prevRatios= %.3f %.3f\n",rtk->sol.prev_ratio1,rtk->sol.prev_ratio2);
     /* if no fix on previous sample and enough sats, exclude next sat in list */
@@ -1735,7 +1862,9 @@ static int manage_amb_LAMBDA(rtk_t *rtk, double *bias, double *xa, const int *sa
         gps1=1;    /* always enable gps for initial pass */
         glo1=rtk->opt.glomodear>GLO_ARMODE_OFF?1:0;
         /* first attempt to resolve ambiguities */
+        tick=PRFTICK(rtk);
         nb=resamb_LAMBDA(rtk,bias,xa,gps1,glo1,glo1);
+        PRFADD(rtk,PRF_LAMBDA,tick);
         ratio1=rtk->sol.ratio;
         /* reject bad satellites if AR filtering enabled */
         if (rtk->opt.arfilter) {
@@ -1760,7 +1889,9 @@ static int manage_amb_LAMBDA(rtk_t *rtk, double *bias, double *xa, const int *sa
             if (rerun) {
                 trace(3,"rerun AR with new sat removed\n");
                 /* try again with new sats removed */
+                tick=PRFTICK(rtk);
                 nb=resamb_LAMBDA(rtk,bias,xa,gps1,glo1,glo1);
+                PRFADD(rtk,PRF_LAMBDA,tick);
             }
         }
         rtk->sol.prev_ratio1=ratio1;
@@ -1778,8 +1909,11 @@ static int manage_amb_LAMBDA(rtk_t *rtk, double *bias, double *xa, const int *sa
         gps2=rtk->opt.gpsmodear==0&&rtk->sol.ratio>=rtk->sol.thres?0:1;  
 
         /* if modes changed since initial AR run or haven't run yet,re-run with new modes */
-        if (glo1!=glo2||gps1!=gps2)
+        if (glo1!=glo2||gps1!=gps2) {
+            tick=PRFTICK(rtk);
             nb=resamb_LAMBDA(rtk,bias,xa,gps2,glo2,glo2);
+            PRFADD(rtk,PRF_LAMBDA,tick);
+        }
     }
     /* restore excluded sat if still no fix or significant increase in ar ratio */
     if (excflag && (rtk->sol.ratio<rtk->sol.thres) && (rtk->sol.ratio<(1.5*rtk->sol.prev_ratio2))) {
@@ -1829,9 +1963,9 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
 {
     prcopt_t *opt=&rtk->opt;
     gtime_t time=obs[0].time;
-    double *rs,*dts,*var,*y,*e,*azel,*freq,*v,*H,*R,*xp,*Pp,*xa,*bias,dt;
+    double *rs,*dts,*var,*y,*e,*azel,*freq,*v,*H,*R,*xp,*Pp,*xa,*bias,dt,tick;
     int i,j,f,n=nu+nr,ns,ny,nv,sat[MAXSAT],iu[MAXSAT],ir[MAXSAT],niter;
-    int info,vflg[MAXOBS*NFREQ*2+1],svh[MAXOBS*2];
+    int info,vflg[MAXOBS*NFREQ*2+1],svh[MAXOBS*2],valid;
     int stat=rtk->opt.mode<=PMODE_DGPS?SOLQ_DGPS:SOLQ_FLOAT;
     int nf=opt->ionoopt==IONOOPT_IFLC?1:opt->nf;
     
@@ -1849,23 +1983,22 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
     azel=zeros(2,n);        /* [az, el] */
     freq=zeros(nf,n);
 
-    /* init satellite status arrays */
-    for (i=0;i<MAXSAT;i++) {
-        rtk->ssat[i].sys=satsys(i+1,NULL);                                        /* gps system */
-        for (j=0;j<NFREQ;j++) {
-            rtk->ssat[i].vsat[j]=0;                                               /* valid satellite */
-                rtk->ssat[i].snr_rover[j]=0;
-                rtk->ssat[i].snr_base[j] =0;
-        }
-    }
+    /* init satellite status arrays of last epoch and current observations */
+    initssat(rtk,obs,n);
+    
     /* compute satellite positions, velocities and clocks */
-    satposs(time,obs,n,nav,opt->sateph,rs,dts,var,svh);
+    tick=PRFTICK(rtk);
+    satposs(time,obs,n,nav,opt->sateph,NULL,rs,dts,var,svh);
+    PRFADD(rtk,PRF_SATPOSS,tick);
     
     /* calculate [range - measured pseudorange] for base station (phase and code)
          output is in y[nu:nu+nr], see call for rover below for more details                                                 */
     trace(3,"base station:\n");
-    if (!zdres(1,obs+nu,nr,rs+nu*6,dts+nu*2,var+nu,svh+nu,nav,rtk->rb,opt,1,
-               y+nu*nf*2,e+nu*3,azel+nu*2,freq+nu*nf)) {
+    tick=PRFTICK(rtk);
+    valid=zdres(1,obs+nu,nr,rs+nu*6,dts+nu*2,var+nu,svh+nu,nav,rtk->rb,opt,1,
+                rtk->tidec+1,y+nu*nf*2,e+nu*3,azel+nu*2,freq+nu*nf);
+    PRFADD(rtk,PRF_ZDRES,tick);
+    if (!valid) {
         errmsg(rtk,"initial base station position error\n");
         
         free(rs); free(dts); free(var); free(y); free(e); free(azel);
@@ -1889,6 +2022,8 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
     
     trace(4,"x(0)="); tracemat(4,rtk->x,1,NR(opt),13,4);
     
+    for (i=0;i<ns&&i<MAXOBS;i++) rtk->satact[rtk->nsatact++]=sat[i];
+    
     for (i=0;i<ns;i++) for (j=0;j<nf;j++) {
         
         /* snr of base and rover receiver */
@@ -1921,7 +2056,11 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
                 e    = line of sight unit vectors to sats
                 azel = [az, el] to sats                                   */
         trace(3,"rover:\n");
-        if (!zdres(0,obs,nu,rs,dts,var,svh,nav,xp,opt,0,y,e,azel,freq)) {
+        tick=PRFTICK(rtk);
+        valid=zdres(0,obs,nu,rs,dts,var,svh,nav,xp,opt,0,rtk->tidec,y,e,azel,
+                    freq);
+        PRFADD(rtk,PRF_ZDRES,tick);
+        if (!valid) {
             errmsg(rtk,"rover initial position error\n");
             stat=SOLQ_NONE;
             break;
@@ -1938,7 +2077,10 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
                 O H = partial derivatives
                 O R = double diff measurement error covariances
                 O vflg = list of sats used for dd  */
-        if ((nv=ddres(rtk,nav,obs,dt,xp,Pp,sat,y,e,azel,freq,iu,ir,ns,v,H,R,vflg))<1) {
+        tick=PRFTICK(rtk);
+        nv=ddres(rtk,nav,obs,dt,xp,Pp,sat,y,e,azel,freq,iu,ir,ns,v,H,R,vflg);
+        PRFADD(rtk,PRF_DDRES,tick);
+        if (nv<1) {
             errmsg(rtk,"no double-differenced residual\n");
             stat=SOLQ_NONE;
             break;
@@ -1948,7 +2090,10 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
                 xp=x+K*v
                 Pp=(I-K*H')*P                  */
         matcpy(Pp,rtk->P,rtk->nx,rtk->nx);
-        if ((info=filter(xp,Pp,H,v,R,rtk->nx,nv))) {
+        tick=PRFTICK(rtk);
+        info=filter(xp,Pp,H,v,R,rtk->nx,nv);
+        PRFADD(rtk,PRF_FILTER,tick);
+        if (info) {
             errmsg(rtk,"filter error (info=%d)\n",info);
             stat=SOLQ_NONE;
             break;
@@ -1956,14 +2101,24 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
         trace(4,"x(%d)=",i+1); tracemat(4,xp,1,NR(opt),13,4);
     }
     /* calc zero diff residuals again after kalman filter update */
-    if (stat!=SOLQ_NONE&&zdres(0,obs,nu,rs,dts,var,svh,nav,xp,opt,0,y,e,azel,
-                               freq)) {
+    if (stat!=SOLQ_NONE) {
+        tick=PRFTICK(rtk);
+        valid=zdres(0,obs,nu,rs,dts,var,svh,nav,xp,opt,0,rtk->tidec,y,e,azel,
+                    freq);
+        PRFADD(rtk,PRF_ZDRES,tick);
+    }
+    if (stat!=SOLQ_NONE&&valid) {
         
         /* calc double diff residuals again after kalman filter update for float solution */
+        tick=PRFTICK(rtk);
         nv=ddres(rtk,nav,obs,dt,xp,Pp,sat,y,e,azel,freq,iu,ir,ns,v,NULL,R,vflg);
+        PRFADD(rtk,PRF_DDRES,tick);
         
         /* validation of float solution, always returns 1, msg to trace file if large residual */
-        if (valpos(rtk,v,R,vflg,nv,4.0)) {
+        tick=PRFTICK(rtk);
+        valid=valpos(rtk,v,R,vflg,nv,4.0);
+        PRFADD(rtk,PRF_VALPOS,tick);
+        if (valid) {
             
             /* update state and covariance matrix from kalman filter update */
             matcpy(rtk->x,xp,rtk->nx,1);
@@ -1987,19 +2142,31 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
         if (manage_amb_LAMBDA(rtk,bias,xa,sat,nf,ns)>1) {
     
             /* find zero-diff residuals for fixed solution */
-            if (zdres(0,obs,nu,rs,dts,var,svh,nav,xa,opt,0,y,e,azel,freq)) {
+            tick=PRFTICK(rtk);
+            valid=zdres(0,obs,nu,rs,dts,var,svh,nav,xa,opt,0,rtk->tidec,y,e,
+                        azel,freq);
+            PRFADD(rtk,PRF_ZDRES,tick);
+            if (valid) {
                 
                 /* post-fit residuals for fixed solution (xa includes fixed phase biases, rtk->xa does not) */
+                tick=PRFTICK(rtk);
                 nv=ddres(rtk,nav,obs,dt,xa,NULL,sat,y,e,azel,freq,iu,ir,ns,v,NULL,R,
                          vflg);
+                PRFADD(rtk,PRF_DDRES,tick);
                 
                 /* validation of fixed solution, always returns valid */
-                if (valpos(rtk,v,R,vflg,nv,4.0)) {
+                tick=PRFTICK(rtk);
+                valid=valpos(rtk,v,R,vflg,nv,4.0);
+                PRFADD(rtk,PRF_VALPOS,tick);
+                if (valid) {
                     
                     /* hold integer ambiguity if meet minfix count */
                     if (++rtk->nfix>=rtk->opt.minfix) {
-                        if (rtk->opt.modear==ARMODE_FIXHOLD||rtk->opt.glomodear==GLO_ARMODE_FIXHOLD) 
+                        if (rtk->opt.modear==ARMODE_FIXHOLD||rtk->opt.glomodear==GLO_ARMODE_FIXHOLD) {
+                            tick=PRFTICK(rtk);
                             holdamb(rtk,xa);
+                            PRFADD(rtk,PRF_HOLDAMB,tick);
+                        }
                         /* switch to kinematic after qualify for hold if in static-start mode */
                         if (rtk->opt.mode==PMODE_STATIC_START) {
                             rtk->opt.mode=PMODE_KINEMA;
@@ -2084,6 +2251,8 @@ extern void rtkinit(rtk_t *rtk, const prcopt_t *opt)
     sol_t sol0={{0}};
     ambc_t ambc0={{{0}}};
     ssat_t ssat0={0};
+    tidec_t tidec0={0};
+    prof_t prof0={{{0}}};
     int i;
     
     trace(3,"rtkinit :\n");
@@ -2101,7 +2270,10 @@ extern void rtkinit(rtk_t *rtk, const prcopt_t *opt)
     for (i=0;i<MAXSAT;i++) {
         rtk->ambc[i]=ambc0;
         rtk->ssat[i]=ssat0;
+        rtk->ssat[i].sys=satsys(i+1,NULL);
     }
+    rtk->nsatact=0;
+    rtk->prof=prof0;
     rtk->holdamb=0;
     rtk->excsat=0;
     rtk->nb_ar=0;
@@ -2110,6 +2282,10 @@ extern void rtkinit(rtk_t *rtk, const prcopt_t *opt)
     rtk->initial_mode=rtk->opt.mode;
     rtk->com_bias=0;
     rtk->sol.thres=(float)opt->thresar[0];
+    rtk->statf=NULL;
+    rtk->nobsb=0;
+    for (i=0;i<2;i++) rtk->tidec[i]=tidec0;
+    compopt(opt->pppopt,&rtk->copt);
 }
 /* free rtk control ------------------------------------------------------------
 * free memory for rtk control struct
@@ -2189,7 +2365,8 @@ extern int rtkpos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
     prcopt_t *opt=&rtk->opt;
     sol_t solb={{0}};
     gtime_t time;
-    int i,nu,nr;
+    double tick;
+    int i,nu,nr,stat;
     char msg[128]="";
     
     trace(3,"rtkpos  : time=%s n=%d\n",time_str(obs[0].time,3),n);
@@ -2208,7 +2385,10 @@ extern int rtkpos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
     time=rtk->sol.time; /* previous epoch */
     
     /* rover position by single point positioning */
-    if (!pntpos(obs,nu,nav,&rtk->opt,&rtk->sol,NULL,rtk->ssat,msg)) {
+    tick=PRFTICK(rtk);
+    stat=pntpos(obs,nu,nav,&rtk->opt,&rtk->sol,NULL,rtk->ssat,msg);
+    PRFADD(rtk,PRF_PNTPOS,tick);
+    if (!stat) {
         errmsg(rtk,"point pos error (%s)\n",msg);
         
         if (!rtk->opt.dynamics) {
@@ -2253,7 +2433,10 @@ extern int rtkpos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
     if (opt->mode==PMODE_MOVEB) { /*  moving baseline */
         
         /* estimate position/velocity of base station */
-        if (!pntpos(obs+nu,nr,nav,&rtk->opt,&solb,NULL,NULL,msg)) {
+        tick=PRFTICK(rtk);
+        stat=pntpos(obs+nu,nr,nav,&rtk->opt,&solb,NULL,NULL,msg);
+        PRFADD(rtk,PRF_PNTPOS,tick);
+        if (!stat) {
             errmsg(rtk,"base station position error (%s)\n",msg);
             return 0;
         }
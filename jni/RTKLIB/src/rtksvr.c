@@ -43,9 +43,12 @@
 *                            use API sat2freq() to get carrier frequency
 *                            use integer types in stdint.h
 *-----------------------------------------------------------------------------*/
+#include <stddef.h>
 #include "rtklib.h"
 
 #define MIN_INT_RESET   30000   /* mininum interval of reset command (ms) */
+#define MIN_INT_SNAP    1000    /* mininum interval of status snapshot (ms) */
+#define MAXSNAPTRY      8       /* max retries to read status snapshot */
 
 /* write solution header to output stream ------------------------------------*/
 static void writesolhead(stream_t *stream, const solopt_t *solopt)
@@ -106,12 +109,108 @@ static void writesol(rtksvr_t *svr, int index)
         n=outsols(buff,&svr->rtk.sol,svr->rtk.rb,&solopt);
         strwrite(svr->moni,buff,n);
     }
-    /* save solution buffer */
-    if (svr->nsol<MAXSOLBUF) {
-        rtksvrlock(svr);
-        svr->solbuf[svr->nsol++]=svr->rtk.sol;
-        rtksvrunlock(svr);
+    /* put solution to solution ring (without lock) */
+    solringput(&svr->solring,&svr->rtk.sol);
+}
+/* update status snapshot ------------------------------------------------------
+* write observation, rtk and stream status to the inactive snapshot of the
+* double buffer and publish it. called only by the server thread, which is the
+* writer of rtk and obs data, so the server lock is held only for streams, or
+* once after the thread was stopped.
+*-----------------------------------------------------------------------------*/
+static void updatesnap(rtksvr_t *svr)
+{
+    svrsnap_t *snap;
+    snapobs_t *so;
+    snapsat_t *ss;
+    const obs_t *obs;
+    const ssat_t *ssat;
+    uint32_t seq=svr->snapseq+1;
+    int i,j,n,sstat[MAXSTRRTK];
+    char msg[MAXSTRMSG*MAXSTRRTK]="";
+    
+    if (!svr->snap) return;
+    if (!seq) seq=2; /* skip 0 keeping parity */
+    
+    rtksvrsstat(svr,sstat,msg);
+    
+    snap=svr->snap+(seq&1);
+    rtkstorerel(&snap->seq,0);
+    rtkfence();
+    
+    snap->ver=SNAPVER;
+    snap->size=(uint32_t)sizeof(svrsnap_t);
+    snap->maxobs=MAXOBS;
+    snap->offobs=(uint32_t)offsetof(svrsnap_t,obs);
+    snap->sizeobs=(uint32_t)sizeof(snapobs_t);
+    snap->offsat=(uint32_t)offsetof(svrsnap_t,ssat);
+    snap->offstr=(uint32_t)offsetof(svrsnap_t,strmsg);
+    snap->offerr=(uint32_t)offsetof(svrsnap_t,errmsg);
+    snap->pad=0;
+    for (i=0;i<MAXSTRRTK;i++) snap->sstat[i]=sstat[i];
+    strncpy(snap->strmsg,msg,MAXSTRMSG-1);
+    snap->strmsg[MAXSTRMSG-1]='\0';
+    
+    /* rtk status */
+    soltorec(&svr->rtk.sol,seq,&snap->sol);
+    for (i=0;i<6;i++) snap->rb[i]=svr->rtk.rb[i];
+    snap->tt=svr->rtk.tt;
+    snap->nx=svr->rtk.nx;
+    snap->na=svr->rtk.na;
+    snap->nfix=svr->rtk.nfix;
+    snap->cputime=svr->cputime;
+    snap->prcout=svr->prcout;
+    n=svr->rtk.neb<MAXSNAPMSG-1?svr->rtk.neb:MAXSNAPMSG-1;
+    memcpy(snap->errmsg,svr->rtk.errbuf+svr->rtk.neb-n,n);
+    snap->errmsg[n]='\0';
+    
+    /* observation status {rov,base,corr} */
+    for (i=0;i<3;i++) {
+        obs=svr->obs[i];
+        so=snap->obs+i;
+        so->ns=obs->n<MAXOBS?obs->n:MAXOBS;
+        so->pad=0;
+        so->time=so->ns>0?(int64_t)obs->data[0].time.time:0;
+        so->sec =so->ns>0?obs->data[0].time.sec:0.0;
+        for (j=0;j<so->ns;j++) {
+            ssat=svr->rtk.ssat+obs->data[j].sat-1;
+            so->sat[j]=(int16_t)obs->data[j].sat;
+            so->az [j]=ssat->azel[0];
+            so->el [j]=ssat->azel[1];
+            for (n=0;n<3;n++) {
+                so->snr[n][j]=n<NFREQ?(int16_t)(obs->data[j].SNR[n]*SNR_UNIT+0.5):0;
+            }
+            if (svr->rtk.sol.stat==SOLQ_NONE||svr->rtk.sol.stat==SOLQ_SINGLE) {
+                so->vsat[j]=ssat->vs;
+            }
+            else {
+                so->vsat[j]=ssat->vsat[0];
+            }
+        }
     }
+    /* satellite status of rover satellites */
+    obs=svr->obs[0];
+    snap->nsat=snap->obs[0].ns;
+    for (j=0;j<snap->nsat;j++) {
+        ssat=svr->rtk.ssat+obs->data[j].sat-1;
+        ss=snap->ssat+j;
+        ss->sat=(int16_t)obs->data[j].sat;
+        ss->vs=ssat->vs;
+        ss->vsat=ssat->vsat[0];
+        for (n=0,ss->slip=0;n<3;n++) {
+            ss->fix[n]=n<NFREQ?ssat->fix[n]:0;
+            if (n<NFREQ&&(ssat->slip[n]&1)) ss->slip|=(uint8_t)(1<<n);
+        }
+        ss->lock=(uint16_t)(ssat->lock[0]<0?0:(ssat->lock[0]>65535?65535:ssat->lock[0]));
+        ss->outc=(uint16_t)(ssat->outc[0]>65535?65535:ssat->outc[0]);
+        ss->az=(float)ssat->azel[0];
+        ss->el=(float)ssat->azel[1];
+        ss->resp=(float)ssat->resp[0];
+        ss->resc=(float)ssat->resc[0];
+    }
+    /* publish snapshot */
+    rtkstorerel(&snap->seq,seq);
+    rtkstorerel(&svr->snapseq,seq);
 }
 /* update glonass frequency channel number in raw data struct ----------------*/
 static void update_glofcn(rtksvr_t *svr)
@@ -190,6 +289,7 @@ static void update_eph(rtksvr_t *svr, nav_t *nav, int ephsat, int ephset,
                    *geph3=*geph2;
                    *geph2=*geph1;
                 update_glofcn(svr);
+                updatefcn(&svr->nav);
                }
            }
            svr->nmsg[index][6]++;
@@ -427,8 +527,11 @@ static void decodefile(rtksvr_t *svr, int index)
         rtksvrlock(svr);
         
         if (svr->nav.peph) free(svr->nav.peph);
+        if (svr->nav.pfit) free(svr->nav.pfit);
         svr->nav.ne=svr->nav.nemax=nav.ne;
         svr->nav.peph=nav.peph;
+        svr->nav.nf=nav.nf;
+        svr->nav.pfit=nav.pfit;
         svr->ftime[index]=utc2gpst(timeget());
         strcpy(svr->files[index],file);
         
@@ -569,11 +672,11 @@ static void *rtksvrthread(void *arg)
     obs_t obs;
     obsd_t data[MAXOBS*2];
     sol_t sol={{0}};
-    double tt;
+    double tt,tick0,tick1=0.0,tick2=0.0;
     uint32_t tick,ticknmea,tick1hz,tickreset;
     uint8_t *p,*q;
     char msg[128];
-    int i,j,n,fobs[3]={0},cycle,cputime;
+    int i,j,n,nr,fobs[3]={0},cycle,cputime;
     
     tracet(3,"rtksvrthread:\n");
     
@@ -584,13 +687,15 @@ static void *rtksvrthread(void *arg)
     
     for (cycle=0;svr->state;cycle++) {
         tick=tickget();
-        for (i=0;i<3;i++) {
+        tick0=svr->rtk.opt.prof?prftick():0.0;
+        for (i=nr=0;i<3;i++) {
             p=svr->buff[i]+svr->nb[i]; q=svr->buff[i]+svr->buffsize;
             
             /* read receiver raw/rtcm data from input stream */
             if ((n=strread(svr->stream+i,p,q-p))<=0) {
                 continue;
             }
+            nr+=n;
             /* write receiver raw/rtcm data to log stream */
             strwrite(svr->stream+i+5,p,n);
             svr->nb[i]+=n;
@@ -602,6 +707,7 @@ static void *rtksvrthread(void *arg)
             svr->npb[i]+=n;
             rtksvrunlock(svr);
         }
+        if (svr->rtk.opt.prof) tick1=prftick();
         for (i=0;i<3;i++) {
             if (svr->format[i]==STRFMT_SP3||svr->format[i]==STRFMT_RNXCLK) {
                 /* decode download file */
@@ -612,6 +718,14 @@ static void *rtksvrthread(void *arg)
                 fobs[i]=decoderaw(svr,i);
             }
         }
+        /* profile stream read and decode of cycles with input data */
+        if (svr->rtk.opt.prof&&nr>0) {
+            tick2=prftick();
+            rtksvrlock(svr);
+            prfadd(&svr->rtk.prof,PRF_READ  ,tick1-tick0);
+            prfadd(&svr->rtk.prof,PRF_DECODE,tick2-tick1);
+            rtksvrunlock(svr);
+        }
         /* averaging single base pos */
         if (fobs[1]>0&&svr->rtk.opt.refpos==POSOPT_SINGLE) {
             if ((svr->rtk.opt.maxaveep<=0||svr->nave<svr->rtk.opt.maxaveep)&&
@@ -633,7 +747,7 @@ static void *rtksvrthread(void *arg)
                 obs.data[obs.n++]=svr->obs[1][0].data[j];
             }
             /* carrier phase bias correction */
-            if (!strstr(svr->rtk.opt.pppopt,"-DIS_FCB")) {
+            if (!(svr->rtk.copt.flag&COPT_DIS_FCB)) {
                 corr_phase_bias(obs.data,obs.n,&svr->nav);
             }
             /* rtk positioning */
@@ -669,6 +783,12 @@ static void *rtksvrthread(void *arg)
             send_nmea(svr,&tickreset);
             ticknmea=tick;
         }
+        /* update status snapshot */
+        if (fobs[0]>0||fobs[1]>0||fobs[2]>0||
+            (int)(tick-svr->snaptick)>=MIN_INT_SNAP) {
+            updatesnap(svr);
+            svr->snaptick=tick;
+        }
         if ((cputime=(int)(tickget()-tick))>0) svr->cputime=cputime;
         
         /* sleep until next cycle */
@@ -696,7 +816,6 @@ static void *rtksvrthread(void *arg)
 extern int rtksvrinit(rtksvr_t *svr)
 {
     gtime_t time0={0};
-    sol_t  sol0 ={{0}};
     eph_t  eph0 ={0,-1,-1};
     geph_t geph0={0,-1};
     seph_t seph0={0};
@@ -709,7 +828,7 @@ extern int rtksvrinit(rtksvr_t *svr)
     svr->buffsize=0;
     for (i=0;i<3;i++) svr->format[i]=0;
     for (i=0;i<2;i++) svr->solopt[i]=solopt_default;
-    svr->navsel=svr->nsbs=svr->nsol=0;
+    svr->navsel=svr->nsbs=0;
     rtkinit(&svr->rtk,&prcopt_default);
     for (i=0;i<3;i++) svr->nb[i]=0;
     for (i=0;i<2;i++) svr->nsb[i]=0;
@@ -717,7 +836,6 @@ extern int rtksvrinit(rtksvr_t *svr)
     for (i=0;i<3;i++) svr->buff[i]=NULL;
     for (i=0;i<2;i++) svr->sbuf[i]=NULL;
     for (i=0;i<3;i++) svr->pbuf[i]=NULL;
-    for (i=0;i<MAXSOLBUF;i++) svr->solbuf[i]=sol0;
     for (i=0;i<3;i++) for (j=0;j<10;j++) svr->nmsg[i][j]=0;
     for (i=0;i<3;i++) svr->ftime[i]=time0;
     for (i=0;i<3;i++) svr->files[i][0]='\0';
@@ -758,6 +876,12 @@ extern int rtksvrinit(rtksvr_t *svr)
     svr->bl_reset=10.0;
     initlock(&svr->lock);
     
+    svr->snapseq=svr->snaptick=0;
+    if (!solringinit(&svr->solring,MAXSOLRING)||
+        !(svr->snap=(svrsnap_t *)calloc(2,sizeof(svrsnap_t)))) {
+        tracet(1,"rtksvrinit: malloc error\n");
+        return 0;
+    }
     return 1;
 }
 /* free rtk server -------------------------------------------------------------
@@ -776,6 +900,8 @@ extern void rtksvrfree(rtksvr_t *svr)
         free(svr->obs[i][j].data);
     }
     rtkfree(&svr->rtk);
+    solringfree(&svr->solring);
+    free(svr->snap); svr->snap=NULL;
 }
 /* lock/unlock rtk server ------------------------------------------------------
 * lock/unlock rtk server
@@ -855,7 +981,6 @@ extern int rtksvrstart(rtksvr_t *svr, int cycle, int buffsize, int *strs,
     for (i=0;i<3;i++) svr->format[i]=formats[i];
     svr->navsel=navsel;
     svr->nsbs=0;
-    svr->nsol=0;
     svr->prcout=0;
     rtkfree(&svr->rtk);
     rtkinit(&svr->rtk,prcopt);
@@ -883,6 +1008,8 @@ extern int rtksvrstart(rtksvr_t *svr, int cycle, int buffsize, int *strs,
         /* set receiver and rtcm option */
         strcpy(svr->raw [i].opt,rcvopts[i]);
         strcpy(svr->rtcm[i].opt,rcvopts[i]);
+        compopt(svr->raw [i].opt,&svr->raw [i].copt);
+        compopt(svr->rtcm[i].opt,&svr->rtcm[i].copt);
         
         /* connect dgps corrections */
         svr->rtcm[i].dgps=svr->nav.dgps;
@@ -987,6 +1114,8 @@ extern void rtksvrstop(rtksvr_t *svr, char **cmds)
 #else
     pthread_join(svr->thread,NULL);
 #endif
+    /* publish status of closed streams */
+    updatesnap(svr);
 }
 /* open output/log stream ------------------------------------------------------
 * open output/log stream
@@ -1110,6 +1239,57 @@ extern void rtksvrsstat(rtksvr_t *svr, int *sstat, char *msg)
     }
     rtksvrunlock(svr);
 }
+/* get stage profile -----------------------------------------------------------
+* get processing time profile of positioning stages and stream read/decode
+* args   : rtksvr_t *svr    I  rtk server
+*          prof_t  *prof    O  stage profile
+*          int     reset    I  reset profile after copy (0:off,1:on)
+* return : status (1:profiling enabled,0:disabled)
+* notes  : profiling is enabled by processing option prof (misc-profile)
+*-----------------------------------------------------------------------------*/
+extern int rtksvrpstat(rtksvr_t *svr, prof_t *prof, int reset)
+{
+    prof_t prof0={{{0}}};
+    int stat;
+
+    tracet(4,"rtksvrpstat: reset=%d\n",reset);
+
+    rtksvrlock(svr);
+    *prof=svr->rtk.prof;
+    if (reset) svr->rtk.prof=prof0;
+    stat=svr->rtk.opt.prof;
+    rtksvrunlock(svr);
+    return stat;
+}
+/* get status snapshot ---------------------------------------------------------
+* get last status snapshot without server lock
+* args   : rtksvr_t *svr    I  rtk server
+*          svrsnap_t *snap  O  status snapshot
+* return : status (1:ok,0:no snapshot)
+* notes  : the server thread writes observation status of all receivers, rtk
+*          status, stream status and satellite status once per epoch (at least
+*          every MIN_INT_SNAP ms) to one of two buffers. a copy is retried if
+*          the buffer was overwritten during the copy.
+*          snapshot is packed with fixed size types and the header contains
+*          the offsets of the variable parts for readers in other languages
+*-----------------------------------------------------------------------------*/
+extern int rtksvrsnap(rtksvr_t *svr, svrsnap_t *snap)
+{
+    const svrsnap_t *p;
+    uint32_t seq;
+    int i;
+    
+    tracet(4,"rtksvrsnap:\n");
+    
+    for (i=0;i<MAXSNAPTRY;i++) {
+        if (!svr->snap||!(seq=rtkloadacq(&svr->snapseq))) return 0;
+        p=svr->snap+(seq&1);
+        memcpy(snap,p,sizeof(svrsnap_t));
+        rtkfence();
+        if (snap->seq==seq&&rtkloadacq(&p->seq)==seq) return 1;
+    }
+    return 0;
+}
 /* mark current position -------------------------------------------------------
 * open output/log stream
 * args   : rtksvr_t *svr    IO rtk server
@@ -1134,6 +1314,7 @@ extern int rtksvrmark(rtksvr_t *svr, const char *name, const char *comment)
     ecef2pos(svr->rtk.sol.rr,pos);
     
     for (i=0;i<2;i++) {
+        if (svr->solopt[i].posf==SOLF_BIN) continue; /* no mark in binary */
         p=buff;
         if (svr->solopt[i].posf==SOLF_STAT) {
             p+=sprintf(p,"$MARK,%d,%.3f,%d,%.4f,%.4f,%.4f,%s,%s\r\n",week,tow,
@@ -42,6 +42,7 @@
 /* constants -----------------------------------------------------------------*/
 
 #define WEEKOFFSET  1024        /* gps week offset for NovAtel OEM-3 */
+#define MAXINSMSG   256         /* max depth of in-order message insertion */
 
 /* sbas igp definition -------------------------------------------------------*/
 static const int16_t
@@ -131,6 +132,9 @@ static int decode_sbstype1(const sbsmsg_t *msg, sbssat_t *sbssat)
     
     trace(4,"decode_sbstype1:\n");
     
+    for (i=0;i<sbssat->nsat;i++) { /* clear slots of previous mask */
+        if ((sat=sbssat->sat[i].sat)>0) sbssat->slot[sat-1]=0;
+    }
     for (i=1,n=0;i<=210&&n<MAXSAT;i++) {
         if (getbitu(msg->msg,13+i,1)) {
            if      (i<= 37) sat=satno(SYS_GPS,i);    /*   0- 37: gps */
@@ -141,6 +145,7 @@ static int decode_sbstype1(const sbsmsg_t *msg, sbssat_t *sbssat)
            else if (i<=192) sat=satno(SYS_SBS,i+10); /* 183-192: qzss ref [2] */
            else if (i<=202) sat=satno(SYS_QZS,i);    /* 193-202: qzss ref [2] */
            else             sat=0;                   /* 203-   : reserved */
+           if (sat>0) sbssat->slot[sat-1]=(int16_t)(n+1);
            sbssat->sat[n++].sat=sat;
         }
     }
@@ -264,10 +269,18 @@ static int decode_sbstype9(const sbsmsg_t *msg, nav_t *nav)
     trace(5,"decode_sbstype9: prn=%d\n",msg->prn);
     return 1;
 }
+/* igp index of 5 deg grid --------------------------------------------------*/
+static int16_t *igpindex(const nav_t *nav, int band, int lat, int lon)
+{
+    if (lat<-90||lat>90||lon<-180||lon>=180||lat%5||lon%5) return NULL;
+    return (int16_t *)nav->sbsigpx[band<=8?0:1][(lat+90)/5]+(lon+180)/5;
+}
 /* decode type 18: ionospheric grid point masks ------------------------------*/
-static int decode_sbstype18(const sbsmsg_t *msg, sbsion_t *sbsion)
+static int decode_sbstype18(const sbsmsg_t *msg, nav_t *nav)
 {
     const sbsigpband_t *p;
+    sbsion_t *sbsion=nav->sbsion;
+    int16_t *q;
     int i,j,n,m,band=getbitu(msg->msg,18,4);
     
     trace(4,"decode_sbstype18:\n");
@@ -278,12 +291,19 @@ static int decode_sbstype18(const sbsmsg_t *msg, sbsion_t *sbsion)
     
     sbsion[band].iodi=(int16_t)getbitu(msg->msg,22,2);
     
+    for (i=0;i<sbsion[band].nigp;i++) { /* clear index of previous mask */
+        q=igpindex(nav,band,sbsion[band].igp[i].lat,sbsion[band].igp[i].lon);
+        if (q) *q=0;
+    }
     for (i=1,n=0;i<=201;i++) {
         if (!getbitu(msg->msg,23+i,1)) continue;
         for (j=0;j<m;j++) {
             if (i<p[j].bits||p[j].bite<i) continue;
             sbsion[band].igp[n].lat=band<=8?p[j].y[i-p[j].bits]:p[j].x;
-            sbsion[band].igp[n++].lon=band<=8?p[j].x:p[j].y[i-p[j].bits];
+            sbsion[band].igp[n].lon=band<=8?p[j].x:p[j].y[i-p[j].bits];
+            q=igpindex(nav,band,sbsion[band].igp[n].lat,sbsion[band].igp[n].lon);
+            if (q) *q=(int16_t)(band*MAXNIGP+n+1);
+            n++;
             break;
         }
     }
@@ -417,7 +437,9 @@ static int decode_sbstype26(const sbsmsg_t *msg, sbsion_t *sbsion)
 * args   : sbsmg_t  *msg    I   sbas message
 *          nav_t    *nav    IO  navigation data
 * return : message type (-1: error or not supported type)
-* notes  : nav->seph must point to seph[NSATSBS*2] (array of seph_t)
+* notes  : the satellite slots (nav->sbssat.slot) and the igp grid index
+*          (nav->sbsigpx) are updated with the masks by message type 1 and 18
+*          nav->seph must point to seph[NSATSBS*2] (array of seph_t)
 *               seph[prn-MINPRNSBS+1]          : sat prn current epehmeris 
 *               seph[prn-MINPRNSBS+1+MAXPRNSBS]: sat prn previous epehmeris 
 *-----------------------------------------------------------------------------*/
@@ -439,7 +461,7 @@ extern int sbsupdatecorr(const sbsmsg_t *msg, nav_t *nav)
         case  6: stat=decode_sbstype6 (msg,&nav->sbssat); break;
         case  7: stat=decode_sbstype7 (msg,&nav->sbssat); break;
         case  9: stat=decode_sbstype9 (msg,nav);          break;
-        case 18: stat=decode_sbstype18(msg,nav ->sbsion); break;
+        case 18: stat=decode_sbstype18(msg,nav);          break;
         case 24: stat=decode_sbstype24(msg,&nav->sbssat); break;
         case 25: stat=decode_sbstype25(msg,&nav->sbssat); break;
         case 26: stat=decode_sbstype26(msg,nav ->sbsion); break;
@@ -449,12 +471,37 @@ extern int sbsupdatecorr(const sbsmsg_t *msg, nav_t *nav)
     }
     return stat?type:-1;
 }
+/* compare sbas messages -----------------------------------------------------*/
+static int cmpmsgs(const void *p1, const void *p2)
+{
+    sbsmsg_t *q1=(sbsmsg_t *)p1,*q2=(sbsmsg_t *)p2;
+    return q1->week!=q2->week?q1->week-q2->week:
+           (q1->tow<q2->tow?-1:(q1->tow>q2->tow?1:q1->prn-q2->prn));
+}
+/* insert sbas message in order ---------------------------------------------*/
+static int insmsg(sbs_t *sbs, const sbsmsg_t *msg)
+{
+    int i;
+    
+    for (i=sbs->n;i>0&&cmpmsgs(sbs->msgs+i-1,msg)>0;i--) {
+        if (sbs->n-i>=MAXINSMSG) { /* append out of order */
+            sbs->msgs[sbs->n++]=*msg;
+            return 0;
+        }
+    }
+    if (i<sbs->n) {
+        memmove(sbs->msgs+i+1,sbs->msgs+i,sizeof(sbsmsg_t)*(sbs->n-i));
+    }
+    sbs->msgs[i]=*msg;
+    sbs->n++;
+    return 1;
+}
 /* read sbas log file --------------------------------------------------------*/
-static void readmsgs(const char *file, int sel, gtime_t ts, gtime_t te,
-                     sbs_t *sbs)
+static int readmsgs(const char *file, int sel, gtime_t ts, gtime_t te,
+                    sbs_t *sbs)
 {
-    sbsmsg_t *sbs_msgs;
-    int i,week,prn,ch,msg;
+    sbsmsg_t *sbs_msgs,sbsmsg;
+    int i,week,prn,ch,msg,sorted=1;
     uint32_t b;
     double tow,ep[6]={0};
     char buff[256],*p;
@@ -465,7 +512,7 @@ static void readmsgs(const char *file, int sel, gtime_t ts, gtime_t te,
     
     if (!(fp=fopen(file,"r"))) {
         trace(2,"sbas message file open error: %s\n",file);
-        return;
+        return 1;
     }
     while (fgets(buff,sizeof(buff),fp)) {
         if (sscanf(buff,"%d %lf %d",&week,&tow,&prn)==3&&(p=strstr(buff,": "))) {
@@ -504,27 +551,25 @@ static void readmsgs(const char *file, int sel, gtime_t ts, gtime_t te,
             if (!(sbs_msgs=(sbsmsg_t *)realloc(sbs->msgs,sbs->nmax*sizeof(sbsmsg_t)))) {
                 trace(1,"readsbsmsg malloc error: nmax=%d\n",sbs->nmax);
                 free(sbs->msgs); sbs->msgs=NULL; sbs->n=sbs->nmax=0;
-                return;
+                fclose(fp);
+                return 1;
             }
             sbs->msgs=sbs_msgs;
         }
-        sbs->msgs[sbs->n].week=week;
-        sbs->msgs[sbs->n].tow=(int)(tow+0.5);
-        sbs->msgs[sbs->n].prn=prn;
-        for (i=0;i<29;i++) sbs->msgs[sbs->n].msg[i]=0;
+        sbsmsg.week=week;
+        sbsmsg.tow=(int)(tow+0.5);
+        sbsmsg.prn=prn;
+        sbsmsg.rcv=0;
+        for (i=0;i<29;i++) sbsmsg.msg[i]=0;
         for (i=0;*(p-1)&&*p&&i<29;p+=2,i++) {
-            if (sscanf(p,"%2X",&b)==1) sbs->msgs[sbs->n].msg[i]=(uint8_t)b;
+            if (sscanf(p,"%2X",&b)==1) sbsmsg.msg[i]=(uint8_t)b;
         }
-        sbs->msgs[sbs->n++].msg[28]&=0xC0;
+        sbsmsg.msg[28]&=0xC0;
+        
+        if (!insmsg(sbs,&sbsmsg)) sorted=0;
     }
     fclose(fp);
-}
-/* compare sbas messages -----------------------------------------------------*/
-static int cmpmsgs(const void *p1, const void *p2)
-{
-    sbsmsg_t *q1=(sbsmsg_t *)p1,*q2=(sbsmsg_t *)p2;
-    return q1->week!=q2->week?q1->week-q2->week:
-           (q1->tow<q2->tow?-1:(q1->tow>q2->tow?1:q1->prn-q2->prn));
+    return sorted;
 }
 /* read sbas message file ------------------------------------------------------
 * read sbas message file
@@ -534,18 +579,20 @@ static int cmpmsgs(const void *p1, const void *p2)
 *         (gtime_t  te      I   end time  )
 *          sbs_t    *sbs    IO  sbas messages
 * return : number of sbas messages
-* notes  : sbas message are appended and sorted. before calling the funciton, 
+* notes  : sbas message are inserted in time order. before calling the funciton, 
 *          sbs->n, sbs->nmax and sbs->msgs must be set properly. (initially
 *          sbs->n=sbs->nmax=0, sbs->msgs=NULL)
 *          only the following file extentions after wild card expanded are valid
 *          to read. others are skipped
 *          .sbs, .SBS, .ems, .EMS
+*          messages are sorted after reading only if some of them are too far
+*          out of order to be inserted
 *-----------------------------------------------------------------------------*/
 extern int sbsreadmsgt(const char *file, int sel, gtime_t ts, gtime_t te,
                        sbs_t *sbs)
 {
     char *efiles[MAXEXFILE]={0},*ext;
-    int i,n;
+    int i,n,sorted=1;
     
     trace(3,"sbsreadmsgt: file=%s sel=%d\n",file,sel);
     
@@ -563,12 +610,12 @@ extern int sbsreadmsgt(const char *file, int sel, gtime_t ts, gtime_t te,
         if (strcmp(ext,".sbs")&&strcmp(ext,".SBS")&&
             strcmp(ext,".ems")&&strcmp(ext,".EMS")) continue;
         
-        readmsgs(efiles[i],sel,ts,te,sbs);
+        if (!readmsgs(efiles[i],sel,ts,te,sbs)) sorted=0;
     }
     for (i=0;i<MAXEXFILE;i++) free(efiles[i]);
     
     /* sort messages */
-    if (sbs->n>0) {
+    if (sbs->n>0&&!sorted) {
         qsort(sbs->msgs,sbs->n,sizeof(sbsmsg_t),cmpmsgs);
     }
     return sbs->n;
@@ -597,13 +644,26 @@ extern void sbsoutmsg(FILE *fp, sbsmsg_t *sbsmsg)
     for (i=0;i<29;i++) fprintf(fp,"%02X",sbsmsg->msg[i]);
     fprintf(fp,"\n");
 }
+/* get igp by grid index ----------------------------------------------------*/
+static const sbsigp_t *getigp(const nav_t *nav, int lat, int lon)
+{
+    const sbsigp_t *p;
+    const int16_t *q;
+    int i;
+    
+    for (i=0;i<2;i++) { /* band 0-8 prior to band 9-10 */
+        if (!(q=igpindex(nav,i?9:0,lat,lon))||*q<=0) continue;
+        p=nav->sbsion[(*q-1)/MAXNIGP].igp+(*q-1)%MAXNIGP;
+        if (p->t0.time!=0&&p->give>0) return p;
+    }
+    return NULL;
+}
 /* search igps ---------------------------------------------------------------*/
-static void searchigp(gtime_t time, const double *pos, const sbsion_t *ion,
+static void searchigp(gtime_t time, const double *pos, const nav_t *nav,
                       const sbsigp_t **igp, double *x, double *y)
 {
     int i,latp[2],lonp[4];
     double lat=pos[0]*R2D,lon=pos[1]*R2D;
-    const sbsigp_t *p;
     
     trace(4,"searchigp: pos=%.3f %.3f\n",pos[0]*R2D,pos[1]*R2D);
     
@@ -639,15 +699,10 @@ static void searchigp(gtime_t time, const double *pos, const sbsion_t *ion,
         }
     }
     for (i=0;i<4;i++) if (lonp[i]==180) lonp[i]=-180;
-    for (i=0;i<=MAXBAND;i++) {
-        for (p=ion[i].igp;p<ion[i].igp+ion[i].nigp;p++) {
-            if (p->t0.time==0) continue;
-            if      (p->lat==latp[0]&&p->lon==lonp[0]&&p->give>0) igp[0]=p;
-            else if (p->lat==latp[1]&&p->lon==lonp[1]&&p->give>0) igp[1]=p;
-            else if (p->lat==latp[0]&&p->lon==lonp[2]&&p->give>0) igp[2]=p;
-            else if (p->lat==latp[1]&&p->lon==lonp[3]&&p->give>0) igp[3]=p;
-            if (igp[0]&&igp[1]&&igp[2]&&igp[3]) return;
-        }
+    
+    /* igps by 5 deg grid index instead of searching all bands */
+    for (i=0;i<4;i++) {
+        igp[i]=getigp(nav,latp[i%2],lonp[i]);
     }
 }
 /* sbas ionospheric delay correction -------------------------------------------
@@ -662,6 +717,9 @@ static void searchigp(gtime_t time, const double *pos, const sbsion_t *ion,
 * notes  : before calling the function, sbas ionosphere correction parameters
 *          in navigation data (nav->sbsion) must be set by callig 
 *          sbsupdatecorr()
+*          igps around ipp are looked up by the 5 deg grid index (nav->sbsigpx)
+*          built by sbsupdatecorr(). if an igp is broadcast in both band 0-8
+*          and 9-10, the one in band 0-8 is used.
 *-----------------------------------------------------------------------------*/
 extern int sbsioncorr(gtime_t time, const nav_t *nav, const double *pos,
                       const double *azel, double *delay, double *var)
@@ -681,7 +739,7 @@ extern int sbsioncorr(gtime_t time, const nav_t *nav, const double *pos,
     fp=ionppp(pos,azel,re,hion,posp);
     
     /* search igps around ipp */
-    searchigp(time,posp,nav->sbsion,igp,&x,&y);
+    searchigp(time,posp,nav,igp,&x,&y);
     
     /* weight of igps */
     if (igp[0]&&igp[1]&&igp[2]&&igp[3]) {
@@ -753,7 +811,7 @@ extern double sbstropcorr(gtime_t time, const double *pos, const double *azel,
                           double *var)
 {
     const double k1=77.604,k2=382000.0,rd=287.054,gm=9.784,g=9.80665;
-    static double pos_[3]={0},zh=0.0,zw=0.0;
+    static THREADLOCAL double pos_[3]={0},zh=0.0,zw=0.0;
     int i;
     double c,met[10],sinel=sin(azel[1]),h=pos[2],m;
     
@@ -779,6 +837,15 @@ extern double sbstropcorr(gtime_t time, const double *pos, const double *azel,
     *var=0.12*0.12*m*m;
     return (zh+zw)*m;
 }
+/* sbas satellite correction by satellite slot ------------------------------*/
+static const sbssatp_t *getsatp(const sbssat_t *sbssat, int sat)
+{
+    int i;
+    
+    if (sat<=0||MAXSAT<sat) return NULL;
+    if ((i=sbssat->slot[sat-1]-1)<0||i>=sbssat->nsat) return NULL;
+    return sbssat->sat+i;
+}
 /* long term correction ------------------------------------------------------*/
 static int sbslongcorr(gtime_t time, int sat, const sbssat_t *sbssat,
                        double *drs, double *ddts)
@@ -789,8 +856,7 @@ static int sbslongcorr(gtime_t time, int sat, const sbssat_t *sbssat,
     
     trace(3,"sbslongcorr: sat=%2d\n",sat);
     
-    for (p=sbssat->sat;p<sbssat->sat+sbssat->nsat;p++) {
-        if (p->sat!=sat||p->lcorr.t0.time==0) continue;
+    if ((p=getsatp(sbssat,sat))&&p->lcorr.t0.time!=0) {
         t=timediff(time,p->lcorr.t0);
         if (fabs(t)>MAXSBSAGEL) {
             trace(2,"sbas long-term correction expired: %s sat=%2d t=%5.0f\n",
@@ -820,24 +886,23 @@ static int sbsfastcorr(gtime_t time, int sat, const sbssat_t *sbssat,
     
     trace(3,"sbsfastcorr: sat=%2d\n",sat);
     
-    for (p=sbssat->sat;p<sbssat->sat+sbssat->nsat;p++) {
-        if (p->sat!=sat) continue;
-        if (p->fcorr.t0.time==0) break;
+    if ((p=getsatp(sbssat,sat))&&p->fcorr.t0.time!=0) {
         t=timediff(time,p->fcorr.t0)+sbssat->tlat;
         
         /* expire age of correction or UDRE==14 (not monitored) */
-        if (fabs(t)>MAXSBSAGEF||p->fcorr.udre>=15) continue;
-        *prc=p->fcorr.prc;
+        if (fabs(t)<=MAXSBSAGEF&&p->fcorr.udre<15) {
+            *prc=p->fcorr.prc;
 #ifdef RRCENA
-        if (p->fcorr.ai>0&&fabs(t)<=8.0*p->fcorr.dt) {
-            *prc+=p->fcorr.rrc*t;
-        }
+            if (p->fcorr.ai>0&&fabs(t)<=8.0*p->fcorr.dt) {
+                *prc+=p->fcorr.rrc*t;
+            }
 #endif
-        *var=varfcorr(p->fcorr.udre)+degfcorr(p->fcorr.ai)*t*t/2.0;
-        
-        trace(5,"sbsfastcorr: sat=%3d prc=%7.2f sig=%7.2f t=%5.0f\n",sat,
-              *prc,sqrt(*var),t);
-        return 1;
+            *var=varfcorr(p->fcorr.udre)+degfcorr(p->fcorr.ai)*t*t/2.0;
+            
+            trace(5,"sbsfastcorr: sat=%3d prc=%7.2f sig=%7.2f t=%5.0f\n",sat,
+                  *prc,sqrt(*var),t);
+            return 1;
+        }
     }
     trace(2,"no sbas fast correction: %s sat=%2d\n",time_str(time,0),sat);
     return 0;
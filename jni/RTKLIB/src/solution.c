@@ -85,6 +85,34 @@
 #define MAXNMEA    256          /* max length of nmea sentence */
 
 #define KNOT2M     0.514444444  /* m/sec --> knot */
+#define MAXSOLTHREAD 16         /* max threads of parallel solution read */
+#define SOLFBUFF   65536        /* read buffer size of solution stream (bytes) */
+#define SOLFWIN    1024         /* window size of solution decimation */
+
+typedef struct {                /* solution file read type */
+    const char *file;           /* file path */
+    const char *buff;           /* memory-mapped file (NULL: read by fp) */
+    size_t size;                /* size of memory-mapped file (bytes) */
+    FILE *fp;                   /* file pointer */
+    gtime_t ts,te;              /* start/end time */
+    double tint;                /* time interval (0: all) */
+    int qflag;                  /* quality flag (0: all) */
+    solopt_t opt;               /* solution options */
+    solbuf_t solbuf;            /* solution buffer of the file */
+    int stat;                   /* status (1:ok,0:no data or error) */
+} solfile_t;
+
+typedef struct {                /* solution output format type */
+    const char *sep;            /* field separator */
+    int nsep;                   /* length of field separator */
+    int timeu;                  /* time digits under decimal point */
+} solfmt_t;
+
+typedef struct {                /* solution file read thread type */
+    solfile_t *files;           /* solution files */
+    int nfile;                  /* number of files */
+    int index,nthread;          /* thread index, number of threads */
+} solthread_t;
 
 static const int nmea_sys[]={ /* NMEA systems */
     SYS_GPS|SYS_SBS,SYS_GLO,SYS_GAL,SYS_CMP,SYS_QZS,SYS_IRN,0
@@ -115,6 +143,67 @@ static const char *opt2sep(const solopt_t *opt)
     else if (!strcmp(opt->sep,"\\t")) return "\t";
     return opt->sep;
 }
+/* parse decimal number ------------------------------------------------------
+* parse [+-]ddd[.ddd] as strtod() but without locale and conversion overhead.
+* an integer mantissa (<=2^53) divided by an exact power of 10 (<=1e22) is
+* correctly rounded as strtod() (fast path of Clinger's algorithm).
+* return 0 for other forms (exponent, long mantissa, inf, nan, hex) to be
+* parsed by strtod() or sscanf()
+*-----------------------------------------------------------------------------*/
+static int parsenum(const char *p, const char **q, double *v)
+{
+    static const double pow10n[]={
+        1E0,1E1,1E2,1E3,1E4,1E5,1E6,1E7,1E8,1E9,1E10,1E11,1E12,1E13,1E14,1E15,
+        1E16,1E17,1E18,1E19,1E20,1E21,1E22
+    };
+    uint64_t m=0;
+    int neg=0,nd=0,nf=0;
+    
+    if (*p=='-') {neg=1; p++;} else if (*p=='+') p++;
+    for (;*p>='0'&&*p<='9';p++,nd++) m=m*10+(uint64_t)(*p-'0');
+    if (*p=='.') {
+        for (p++;*p>='0'&&*p<='9';p++,nd++,nf++) m=m*10+(uint64_t)(*p-'0');
+    }
+    if (nd<=0||nd>19||nf>22||m>((uint64_t)1<<53)||*p=='e'||*p=='E'||
+        *p=='x'||*p=='X') {
+        return 0;
+    }
+    *v=neg?-((double)m/pow10n[nf]):(double)m/pow10n[nf];
+    *q=p;
+    return 1;
+}
+/* string to number (same as atof()) -----------------------------------------*/
+static double str2dbl(const char *p)
+{
+    const char *q;
+    double v;
+    
+    return parsenum(p,&q,&v)?v:atof(p);
+}
+/* scan number (same as sscanf(p,"%lf",v)==1) -------------------------------*/
+static int scannum(const char *p, double *v)
+{
+    const char *q;
+    
+    while (isspace((int)*p)) p++;
+    return parsenum(p,&q,v)||sscanf(p,"%lf",v)==1;
+}
+/* scan time yyyy/mm/dd hh:mm:ss ---------------------------------------------
+* same as sscanf(buff,"%lf/%lf/%lf %lf:%lf:%lf",...)>=6 for plain decimals.
+* return 0 if not scanned to fallback to sscanf()
+*-----------------------------------------------------------------------------*/
+static int scanepoch(const char *p, double *v)
+{
+    const char sep[]="// ::";
+    int i;
+    
+    for (i=0;i<6;i++) {
+        while (isspace((int)*p)) p++;
+        if (!parsenum(p,&p,v+i)) return 0;
+        if (i<5&&sep[i]!=' '&&*p++!=sep[i]) return 0;
+    }
+    return 1;
+}
 /* separate fields -----------------------------------------------------------*/
 static int tonum(char *buff, const char *sep, double *v)
 {
@@ -123,7 +212,7 @@ static int tonum(char *buff, const char *sep, double *v)
     
     for (p=buff,n=0;n<MAXFIELD;p=q+len) {
         if ((q=strstr(p,sep))) *q='\0'; 
-        if (*p) v[n++]=atof(p);
+        if (*p) v[n++]=str2dbl(p);
         if (!q) break;
     }
     return n;
@@ -133,6 +222,106 @@ static double sqvar(double covar)
 {
     return covar<0.0?-sqrt(-covar):sqrt(covar);
 }
+/* output fixed-point number ---------------------------------------------------
+* output x as sprintf("%*.*f") (zero=0) or sprintf("%0*.*f") (zero=1) without
+* sprintf. x scaled by 10^prec is rounded to an integer. the output is the same
+* as sprintf() except for a value near a tie of the rounding, a large value or
+* nan/inf, which are output by sprintf().
+*-----------------------------------------------------------------------------*/
+static char *fmtfix(char *p, double x, int width, int prec, int zero)
+{
+    static const double pow10n[]={
+        1E0,1E1,1E2,1E3,1E4,1E5,1E6,1E7,1E8,1E9,1E10,1E11,1E12,1E13,1E14,1E15
+    };
+    char digit[32],*q=digit+sizeof(digit);
+    uint64_t m;
+    double s,f;
+    int i,n,neg;
+    
+    if (prec<0||prec>15||!((s=fabs(x)*pow10n[prec])<4E15)) {
+        return p+sprintf(p,zero?"%0*.*f":"%*.*f",width,prec,x);
+    }
+    f=s-floor(s);
+    if (fabs(f-0.5)<=s*4E-16+1E-300) { /* near tie */
+        return p+sprintf(p,zero?"%0*.*f":"%*.*f",width,prec,x);
+    }
+    memcpy(&m,&x,sizeof(m));
+    neg=(int)(m>>63); /* sign bit (including -0.0) */
+    m=(uint64_t)s+(f>0.5?1:0);
+    
+    for (i=0;i<prec;i++) {
+        *--q=(char)('0'+m%10); m/=10;
+    }
+    if (prec>0) *--q='.';
+    do {
+        *--q=(char)('0'+m%10); m/=10;
+    } while (m);
+    n=(int)(digit+sizeof(digit)-q);
+    
+    if (!zero) for (i=n+neg;i<width;i++) *p++=' ';
+    if (neg) *p++='-';
+    if (zero) for (i=n+neg;i<width;i++) *p++='0';
+    memcpy(p,q,n);
+    return p+n;
+}
+/* output integer as sprintf("%*d") (zero=0) or sprintf("%0*d") (zero=1) ----*/
+static char *fmtint(char *p, int x, int width, int zero)
+{
+    char digit[16],*q=digit+sizeof(digit);
+    unsigned int m=x<0?0u-(unsigned int)x:(unsigned int)x;
+    int i,n;
+    
+    do {
+        *--q=(char)('0'+m%10); m/=10;
+    } while (m);
+    n=(int)(digit+sizeof(digit)-q);
+    
+    if (!zero) for (i=n+(x<0);i<width;i++) *p++=' ';
+    if (x<0) *p++='-';
+    if (zero) for (i=n+(x<0);i<width;i++) *p++='0';
+    memcpy(p,q,n);
+    return p+n;
+}
+/* output string -------------------------------------------------------------*/
+static char *fmtstr(char *p, const char *str, int len)
+{
+    memcpy(p,str,len);
+    return p+len;
+}
+/* output NMEA check-sum and trailer of sentence started at s ----------------*/
+static char *fmtsum(char *s, char *p)
+{
+    static const char hex[]="0123456789ABCDEF";
+    char *q;
+    uint8_t sum=0;
+    
+    for (q=s+1;q<p;q++) sum^=(uint8_t)*q;
+    *p++='*';
+    *p++=hex[sum>>4];
+    *p++=hex[sum&15];
+    *p++='\r';
+    *p++='\n';
+    *p='\0';
+    return p;
+}
+/* output time as time2str() -------------------------------------------------*/
+static char *fmttime(char *p, gtime_t t, int n)
+{
+    static const double pow10n[]={
+        1E0,1E1,1E2,1E3,1E4,1E5,1E6,1E7,1E8,1E9,1E10,1E11,1E12
+    };
+    double ep[6];
+    
+    if (n<0) n=0; else if (n>12) n=12;
+    if (1.0-t.sec<0.5/pow10n[n]) {t.time++; t.sec=0.0;}
+    time2epoch(t,ep);
+    p=fmtfix(p,ep[0],4,0,1); *p++='/';
+    p=fmtfix(p,ep[1],2,0,1); *p++='/';
+    p=fmtfix(p,ep[2],2,0,1); *p++=' ';
+    p=fmtfix(p,ep[3],2,0,1); *p++=':';
+    p=fmtfix(p,ep[4],2,0,1); *p++=':';
+    return fmtfix(p,ep[5],n<=0?2:n+3,n<=0?0:n,1);
+}
 /* convert ddmm.mm in nmea format to deg -------------------------------------*/
 static double dmm2deg(double dmm)
 {
@@ -395,7 +584,8 @@ static char *decode_soltime(char *buff, const solopt_t *opt, gtime_t *time)
         return p+len;
     }
     /* yyyy/mm/dd hh:mm:ss or yyyy mm dd hh:mm:ss */
-    if (sscanf(buff,"%lf/%lf/%lf %lf:%lf:%lf",v,v+1,v+2,v+3,v+4,v+5)>=6) {
+    if (scanepoch(buff,v)||
+        sscanf(buff,"%lf/%lf/%lf %lf:%lf:%lf",v,v+1,v+2,v+3,v+4,v+5)>=6) {
         if (v[0]<100.0) {
             v[0]+=v[0]<80.0?2000.0:1900.0;
         }
@@ -413,7 +603,7 @@ static char *decode_soltime(char *buff, const solopt_t *opt, gtime_t *time)
     else { /* wwww ssss */
     for (p=buff,n=0;n<2;p=q+len) {
         if ((q=strstr(p,s))) *q='\0'; 
-            if (sscanf(p,"%lf",v+n)==1) n++;
+            if (scannum(p,v+n)) n++;
         if (!q) break;
     }
     if (n>=2&&0.0<=v[0]&&v[0]<=3000.0&&0.0<=v[1]&&v[1]<604800.0) {
@@ -766,33 +956,30 @@ static void readsolopt(FILE *fp, solopt_t *opt)
         decode_solopt(buff,opt);
     }
 }
-/* input solution data from stream ---------------------------------------------
-* input solution data from stream
-* args   : uint8_t data     I stream data
-*          gtime_t ts       I  start time (ts.time==0: from start)
-*          gtime_t te       I  end time   (te.time==0: to end)
-*          double tint      I  time interval (0: all)
-*          int    qflag     I  quality flag  (0: all)
-*          solbuf_t *solbuf IO solution buffer
-* return : status (1:solution received,0:no solution,-1:disconnect received)
-*-----------------------------------------------------------------------------*/
-extern int inputsol(uint8_t data, gtime_t ts, gtime_t te, double tint,
-                    int qflag, const solopt_t *opt, solbuf_t *solbuf)
+/* read solution option from memory (same lines as fgets() in readsolopt()) --*/
+static void readsoloptm(const char *p, const char *end, solopt_t *opt)
 {
-    sol_t sol={{0}};
-    int stat;
-    
-    trace(4,"inputsol: data=0x%02x\n",data);
+    char buff[MAXSOLMSG+1];
+    int i,n;
     
-    sol.time=solbuf->time;
+    trace(3,"readsoloptm:\n");
     
-    if (data=='$'||(!isprint(data)&&data!='\r'&&data!='\n')) { /* sync header */
-        solbuf->nb=0;
-    }
-    if (data!='\r'&&data!='\n') {
-    solbuf->buff[solbuf->nb++]=data;
+    for (i=0;p<end&&i<100;i++) { /* only 100 lines */
+        for (n=0;p<end&&n<MAXSOLMSG;) {
+            if ((buff[n++]=*p++)=='\n') break;
+        }
+        buff[n]='\0';
+        
+        /* decode solution options */
+        decode_solopt(buff,opt);
     }
-    if (data!='\n'&&solbuf->nb<MAXSOLMSG) return 0; /* sync trailer */
+}
+/* input solution message in solution buffer ---------------------------------*/
+static int inputsolmsg(gtime_t ts, gtime_t te, double tint, int qflag,
+                       const solopt_t *opt, solbuf_t *solbuf)
+{
+    sol_t sol={{0}};
+    int stat;
     
     solbuf->buff[solbuf->nb]='\0';
     solbuf->nb=0;
@@ -814,6 +1001,31 @@ extern int inputsol(uint8_t data, gtime_t ts, gtime_t te, double tint,
     /* add solution to solution buffer */
     return addsol(solbuf,&sol);
 }
+/* input solution data from stream ---------------------------------------------
+* input solution data from stream
+* args   : uint8_t data     I stream data
+*          gtime_t ts       I  start time (ts.time==0: from start)
+*          gtime_t te       I  end time   (te.time==0: to end)
+*          double tint      I  time interval (0: all)
+*          int    qflag     I  quality flag  (0: all)
+*          solbuf_t *solbuf IO solution buffer
+* return : status (1:solution received,0:no solution,-1:disconnect received)
+*-----------------------------------------------------------------------------*/
+extern int inputsol(uint8_t data, gtime_t ts, gtime_t te, double tint,
+                    int qflag, const solopt_t *opt, solbuf_t *solbuf)
+{
+    trace(4,"inputsol: data=0x%02x\n",data);
+    
+    if (data=='$'||(!isprint(data)&&data!='\r'&&data!='\n')) { /* sync header */
+        solbuf->nb=0;
+    }
+    if (data!='\r'&&data!='\n') {
+    solbuf->buff[solbuf->nb++]=data;
+    }
+    if (data!='\n'&&solbuf->nb<MAXSOLMSG) return 0; /* sync trailer */
+    
+    return inputsolmsg(ts,te,tint,qflag,opt,solbuf);
+}
 /* read solution data --------------------------------------------------------*/
 static int readsoldata(FILE *fp, gtime_t ts, gtime_t te, double tint, int qflag,
                       const solopt_t *opt, solbuf_t *solbuf)
@@ -829,6 +1041,158 @@ static int readsoldata(FILE *fp, gtime_t ts, gtime_t te, double tint, int qflag,
     }
     return solbuf->n>0;
 }
+/* read solution data from memory ----------------------------------------------
+* read solution data in memory-mapped file by lines. the bytes of a line are
+* buffered as inputsol() does but without a call per byte.
+*-----------------------------------------------------------------------------*/
+static int readsoldatam(const char *p, const char *end, gtime_t ts, gtime_t te,
+                        double tint, int qflag, const solopt_t *opt,
+                        solbuf_t *solbuf)
+{
+    const char *q;
+    uint8_t c;
+    int nb=solbuf->nb;
+    
+    trace(3,"readsoldatam:\n");
+    
+    for (;p<end;p=q+1) {
+        if (!(q=(const char *)memchr(p,'\n',end-p))) q=end;
+        
+        for (;p<q;p++) {
+            if ((c=(uint8_t)*p)=='\r') continue;
+            if (c=='$'||!isprint(c)) nb=0; /* sync header */
+            solbuf->buff[nb++]=c;
+            if (nb<MAXSOLMSG) continue;
+            solbuf->nb=nb;
+            inputsolmsg(ts,te,tint,qflag,opt,solbuf);
+            nb=0;
+        }
+        solbuf->nb=nb;
+        if (q>=end) break;
+        
+        /* input solution at line end */
+        inputsolmsg(ts,te,tint,qflag,opt,solbuf);
+        nb=0;
+    }
+    return solbuf->n>0;
+}
+/* check binary solution header ----------------------------------------------*/
+static int issolbin(const char *buff, size_t size)
+{
+    return size>=sizeof(solbinh_t)&&!memcmp(buff,SOLBIN_MAGIC,7);
+}
+/* decode binary solution header ---------------------------------------------*/
+static int decode_solbinh(const char *p, int *hsize, int *rsize, int *outvel)
+{
+    solbinh_t h;
+    
+    memcpy(&h,p,sizeof(h));
+    *outvel=(h.flags&SOLBIN_VEL)?1:0;
+    if (h.order!=SOLBIN_ORDER||h.hsize<sizeof(h)||
+        h.rsize<sizeof(solbin_t)+(*outvel?sizeof(solbinv_t):0)) {
+        trace(2,"binary solution header error ver=%d order=%08X\n",h.ver,
+              h.order);
+        return 0;
+    }
+    *hsize=h.hsize;
+    *rsize=h.rsize;
+    return 1;
+}
+/* decode binary solution record ---------------------------------------------*/
+static void decode_solbin(const char *p, int outvel, sol_t *sol)
+{
+    static const sol_t sol0={{0}};
+    solbin_t rec;
+    solbinv_t vel;
+    int i;
+    
+    memcpy(&rec,p,sizeof(rec));
+    
+    *sol=sol0;
+    sol->time.time=(time_t)rec.time;
+    sol->time.sec=rec.nsec/1E9;
+    for (i=0;i<3;i++) sol->rr[i]=rec.rr[i];
+    for (i=0;i<6;i++) sol->qr[i]=rec.qr[i];
+    sol->age  =rec.age;
+    sol->ratio=rec.ratio;
+    sol->type =rec.type;
+    sol->stat =rec.stat;
+    sol->ns   =rec.ns;
+    
+    if (outvel) {
+        memcpy(&vel,p+sizeof(rec),sizeof(vel));
+        for (i=0;i<3;i++) sol->rr[i+3]=vel.rv[i];
+        for (i=0;i<6;i++) sol->qv[i]=vel.qv[i];
+    }
+}
+/* read binary solution data from memory ---------------------------------------
+* read fixed-size records of binary solution (SOLF_BIN). the record size is
+* taken from the header, so records extended by later versions can be read.
+* a header may appear again at a record boundary (e.g. appended output).
+*-----------------------------------------------------------------------------*/
+static int readsolbin(const char *p, const char *end, gtime_t ts, gtime_t te,
+                      double tint, int qflag, solbuf_t *solbuf)
+{
+    sol_t sol,*data;
+    int hsize,rsize=0,outvel=0,nmax;
+    
+    trace(3,"readsolbin:\n");
+    
+    while (p<end) {
+        
+        /* binary solution header */
+        if (issolbin(p,(size_t)(end-p))) {
+            if (!decode_solbinh(p,&hsize,&rsize,&outvel)||end-p<hsize) {
+                break;
+            }
+            p+=hsize;
+            
+            /* allocate solution buffer for records */
+            nmax=solbuf->n+(int)((end-p)/rsize);
+            if (nmax>solbuf->nmax) {
+                if (!(data=(sol_t *)realloc(solbuf->data,sizeof(sol_t)*nmax))) {
+                    trace(1,"readsolbin: memory allocation error\n");
+                    break;
+                }
+                solbuf->data=data;
+                solbuf->nmax=nmax;
+            }
+            continue;
+        }
+        if (rsize<=0||end-p<rsize) {
+            trace(2,"readsolbin: no header or truncated record\n");
+            break;
+        }
+        decode_solbin(p,outvel,&sol);
+        p+=rsize;
+        
+        if (!screent(sol.time,ts,te,tint)||(qflag&&sol.stat!=qflag)) continue;
+        
+        if (!addsol(solbuf,&sol)) break;
+    }
+    return solbuf->n>0;
+}
+/* read binary solution data from file ---------------------------------------*/
+static int readsolbinf(FILE *fp, gtime_t ts, gtime_t te, double tint,
+                       int qflag, solbuf_t *solbuf)
+{
+    char *buff;
+    long size;
+    int stat=0;
+    
+    if (fseek(fp,0,SEEK_END)||(size=ftell(fp))<=0||fseek(fp,0,SEEK_SET)) {
+        return 0;
+    }
+    if (!(buff=(char *)malloc(size))) {
+        trace(1,"readsolbinf: memory allocation error\n");
+        return 0;
+    }
+    if (fread(buff,size,1,fp)==1) {
+        stat=readsolbin(buff,buff+size,ts,te,tint,qflag,solbuf);
+    }
+    free(buff);
+    return stat;
+}
 /* compare solution data -----------------------------------------------------*/
 static int cmpsol(const void *p1, const void *p2)
 {
@@ -840,6 +1204,7 @@ static int cmpsol(const void *p1, const void *p2)
 static int sort_solbuf(solbuf_t *solbuf)
 {
     sol_t *solbuf_data;
+    int i;
     
     trace(4,"sort_solbuf: n=%d\n",solbuf->n);
     
@@ -851,12 +1216,170 @@ static int sort_solbuf(solbuf_t *solbuf)
         return 0;
     }
     solbuf->data=solbuf_data;
-    qsort(solbuf->data,solbuf->n,sizeof(sol_t),cmpsol);
+    
+    /* skip sort if already in time order */
+    for (i=1;i<solbuf->n;i++) {
+        if (cmpsol(solbuf->data+i-1,solbuf->data+i)>0) break;
+    }
+    if (i<solbuf->n) {
+        qsort(solbuf->data,solbuf->n,sizeof(sol_t),cmpsol);
+    }
     solbuf->nmax=solbuf->n;
     solbuf->start=0;
     solbuf->end=solbuf->n-1;
     return 1;
 }
+/* read solution file --------------------------------------------------------*/
+static void readsolfile(solfile_t *f)
+{
+    trace(3,"readsolfile: file=%s\n",f->file);
+    
+    if (f->buff) {
+        if (f->opt.posf==SOLF_BIN) {
+            f->stat=readsolbin(f->buff,f->buff+f->size,f->ts,f->te,f->tint,
+                               f->qflag,&f->solbuf);
+        }
+        else {
+            f->stat=readsoldatam(f->buff,f->buff+f->size,f->ts,f->te,f->tint,
+                                 f->qflag,&f->opt,&f->solbuf);
+        }
+        unmapfile((void *)f->buff,f->size);
+        f->buff=NULL;
+    }
+    else if (f->opt.posf==SOLF_BIN) {
+        f->stat=readsolbinf(f->fp,f->ts,f->te,f->tint,f->qflag,&f->solbuf);
+        fclose(f->fp);
+        f->fp=NULL;
+    }
+    else {
+        f->stat=readsoldata(f->fp,f->ts,f->te,f->tint,f->qflag,&f->opt,
+                            &f->solbuf);
+        fclose(f->fp);
+        f->fp=NULL;
+    }
+    if (f->stat) f->stat=sort_solbuf(&f->solbuf);
+}
+/* solution file read thread -------------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI solfilethread(void *arg)
+#else
+static void *solfilethread(void *arg)
+#endif
+{
+    solthread_t *t=(solthread_t *)arg;
+    int i;
+    
+    for (i=t->index;i<t->nfile;i+=t->nthread) readsolfile(t->files+i);
+    return 0;
+}
+/* read solution files in parallel -------------------------------------------*/
+static void readsolfiles(solfile_t *files, int nfile)
+{
+    solthread_t t[MAXSOLTHREAD];
+    thread_t thread[MAXSOLTHREAD];
+    int i,nt,run[MAXSOLTHREAD]={0};
+    
+    nt=getncpu();
+    if (nt>nfile) nt=nfile;
+    if (nt>MAXSOLTHREAD) nt=MAXSOLTHREAD;
+    if (nt<1) nt=1;
+    
+    trace(3,"readsolfiles: nfile=%d nthread=%d\n",nfile,nt);
+    
+    for (i=0;i<nt;i++) {
+        t[i].files=files; t[i].nfile=nfile; t[i].index=i; t[i].nthread=nt;
+    }
+    for (i=1;i<nt;i++) {
+#ifdef WIN32
+        if (!(thread[i]=CreateThread(NULL,0,solfilethread,t+i,0,NULL))) {
+#else
+        if (pthread_create(thread+i,NULL,solfilethread,t+i)) {
+#endif
+            solfilethread(t+i); /* read in caller thread */
+            continue;
+        }
+        run[i]=1;
+    }
+    solfilethread(t);
+    
+    for (i=1;i<nt;i++) {
+        if (!run[i]) continue;
+#ifdef WIN32
+        WaitForSingleObject(thread[i],INFINITE);
+        CloseHandle(thread[i]);
+#else
+        pthread_join(thread[i],NULL);
+#endif
+    }
+}
+/* compare next solution data of files (same time: by file index) -----------*/
+static int cmpfile(const solfile_t *files, const int *next, int i, int j)
+{
+    int stat=cmpsol(files[i].solbuf.data+next[i],files[j].solbuf.data+next[j]);
+    return stat?stat:i-j;
+}
+/* merge sorted solution data of files ---------------------------------------
+* k-way merge of solution data sorted by time with a binary heap of files.
+* solutions of the same time are ordered by file index.
+*-----------------------------------------------------------------------------*/
+static int mergesol(solfile_t *files, int nfile, solbuf_t *solbuf)
+{
+    sol_t *data,*p;
+    int i,j,k,n=0,nh=0,*heap,*next;
+    
+    for (i=0;i<nfile;i++) n+=files[i].solbuf.n;
+    
+    trace(3,"mergesol: nfile=%d n=%d\n",nfile,n);
+    
+    if (n<=0) return 0;
+    
+    if (!(data=(sol_t *)malloc(sizeof(sol_t)*n))||
+        !(heap=(int *)malloc(sizeof(int)*nfile*2))) {
+        trace(1,"mergesol: memory allocation error\n");
+        free(data);
+        return 0;
+    }
+    next=heap+nfile;
+    
+    for (i=0;i<nfile;i++) {
+        next[i]=0;
+        if (files[i].solbuf.n<=0) continue;
+        
+        /* push file to heap */
+        for (j=nh++;j>0;j=k) {
+            k=(j-1)/2;
+            if (cmpfile(files,next,heap[k],i)<0) break;
+            heap[j]=heap[k];
+        }
+        heap[j]=i;
+    }
+    for (p=data;nh>0;) {
+        
+        /* copy run of the top file up to the head of the second file */
+        i=heap[0];
+        do {
+            *p++=files[i].solbuf.data[next[i]++];
+        } while (next[i]<files[i].solbuf.n&&(nh<2||cmpfile(files,next,i,heap[1])<0)&&
+                 (nh<3||cmpfile(files,next,i,heap[2])<0));
+        
+        if (next[i]>=files[i].solbuf.n) i=heap[--nh]; /* file drained */
+        
+        /* sift down */
+        for (j=0;(k=2*j+1)<nh;j=k) {
+            if (k+1<nh&&cmpfile(files,next,heap[k+1],heap[k])<0) k++;
+            if (cmpfile(files,next,i,heap[k])<0) break;
+            heap[j]=heap[k];
+        }
+        if (nh>0) heap[j]=i;
+    }
+    free(heap);
+    
+    solbuf->data=data;
+    solbuf->n=solbuf->nmax=n;
+    solbuf->start=0;
+    solbuf->end=n-1;
+    return 1;
+}
 /* read solutions data from solution files -------------------------------------
 * read solution data from soluiton files
 * args   : char   *files[]  I  solution files
@@ -867,34 +1390,83 @@ static int sort_solbuf(solbuf_t *solbuf)
 *         (int    qflag)    I  quality flag  (0: all)
 *          solbuf_t *solbuf O  solution buffer
 * return : status (1:ok,0:no data or error)
+* notes  : files are memory-mapped and decoded in parallel by file. solution
+*          data of each file are sorted only if not in time order and merged
+*          into the solution buffer in time order.
+*          solution options in the header of a file are kept for the
+*          following files.
+*          binary solution files (SOLF_BIN) are detected by the header and
+*          can be mixed with text files.
 *-----------------------------------------------------------------------------*/
 extern int readsolt(char *files[], int nfile, gtime_t ts, gtime_t te,
                     double tint, int qflag, solbuf_t *solbuf)
 {
-    FILE *fp;
+    solfile_t *f;
     solopt_t opt=solopt_default;
-    int i;
+    char head[sizeof(solbinh_t)];
+    size_t size;
+    int i,n,stat;
     
     trace(3,"readsolt: nfile=%d\n",nfile);
     
     initsolbuf(solbuf,0,0);
     
-    for (i=0;i<nfile;i++) {
-        if (!(fp=fopen(files[i],"rb"))) {
+    if (nfile<=0) return 0;
+    
+    if (!(f=(solfile_t *)calloc(nfile,sizeof(solfile_t)))) {
+        trace(1,"readsolt: memory allocation error\n");
+        return 0;
+    }
+    /* read solution options in header */
+    for (i=n=0;i<nfile;i++) {
+        if ((f[n].buff=(const char *)mapfile(files[i],&f[n].size))) {
+            if (issolbin(f[n].buff,f[n].size)) opt.posf=SOLF_BIN;
+            else {
+                if (opt.posf==SOLF_BIN) opt.posf=SOLF_LLH;
+                readsoloptm(f[n].buff,f[n].buff+f[n].size,&opt);
+            }
+        }
+        else if ((f[n].fp=fopen(files[i],"rb"))) {
+            size=fread(head,1,sizeof(head),f[n].fp);
+            rewind(f[n].fp);
+            if (issolbin(head,size)) opt.posf=SOLF_BIN;
+            else {
+                if (opt.posf==SOLF_BIN) opt.posf=SOLF_LLH;
+                readsolopt(f[n].fp,&opt);
+                rewind(f[n].fp);
+            }
+        }
+        else {
             trace(2,"readsolt: file open error %s\n",files[i]);
             continue;
         }
-        /* read solution options in header */
-        readsolopt(fp,&opt);
-        rewind(fp);
+        f[n].file=files[i];
+        f[n].ts=ts; f[n].te=te; f[n].tint=tint; f[n].qflag=qflag;
+        f[n++].opt=opt;
+    }
+    /* read solution data */
+    readsolfiles(f,n);
+    
+    for (i=0;i<n;i++) {
+        if (!f[i].stat) trace(2,"readsolt: no solution in %s\n",f[i].file);
         
-        /* read solution data */
-        if (!readsoldata(fp,ts,te,tint,qflag,&opt,solbuf)) {
-            trace(2,"readsolt: no solution in %s\n",files[i]);
-        }
-        fclose(fp);
+        /* reference position in the last file */
+        if (norm(f[i].solbuf.rb,3)>0.0) matcpy(solbuf->rb,f[i].solbuf.rb,3,1);
+    }
+    /* merge solution data of files */
+    if (n==1) {
+        solbuf->data=f->solbuf.data;
+        solbuf->n=solbuf->nmax=f->solbuf.n;
+        solbuf->start=f->solbuf.start;
+        solbuf->end=f->solbuf.end;
+        stat=f->solbuf.n>0;
     }
-    return sort_solbuf(solbuf);
+    else {
+        stat=mergesol(f,n,solbuf);
+        for (i=0;i<n;i++) freesolbuf(&f[i].solbuf);
+    }
+    free(f);
+    return stat;
 }
 extern int readsol(char *files[], int nfile, solbuf_t *sol)
 {
@@ -904,39 +1476,369 @@ extern int readsol(char *files[], int nfile, solbuf_t *sol)
     
     return readsolt(files,nfile,time,time,0.0,0,sol);
 }
-/* add solution data to solution buffer ----------------------------------------
-* add solution data to solution buffer
-* args   : solbuf_t *solbuf IO solution buffer
-*          sol_t  *sol      I  solution data
-* return : status (1:ok,0:error)
-*-----------------------------------------------------------------------------*/
-extern int addsol(solbuf_t *solbuf, const sol_t *sol)
+/* open next file of solution stream ----------------------------------------*/
+static int solfnext(solfp_t *fp)
 {
-    sol_t *solbuf_data;
-    
-    trace(4,"addsol:\n");
+    char head[sizeof(solbinh_t)];
+    size_t size;
     
-    if (solbuf->cyclic) { /* ring buffer */
-        if (solbuf->nmax<=1) return 0;
-        solbuf->data[solbuf->end]=*sol;
-        if (++solbuf->end>=solbuf->nmax) solbuf->end=0;
-        if (solbuf->start==solbuf->end) {
-            if (++solbuf->start>=solbuf->nmax) solbuf->start=0;
-        }
-        else solbuf->n++;
-        
-        return 1;
+    if (fp->fp) {
+        fclose(fp->fp);
+        fp->fp=NULL;
     }
-    if (solbuf->n>=solbuf->nmax) {
-        solbuf->nmax=solbuf->nmax==0?8192:solbuf->nmax*2;
-        if (!(solbuf_data=(sol_t *)realloc(solbuf->data,sizeof(sol_t)*solbuf->nmax))) {
-            trace(1,"addsol: memory allocation error\n");
-            free(solbuf->data); solbuf->data=NULL; solbuf->n=solbuf->nmax=0;
-            return 0;
-        }
-        solbuf->data=solbuf_data;
+    for (;fp->ifile<fp->nfile;fp->ifile++) {
+        if ((fp->fp=fopen(fp->files[fp->ifile],"rb"))) break;
+        trace(2,"solfnext: file open error %s\n",fp->files[fp->ifile]);
+    }
+    if (!fp->fp) return 0;
+    
+    trace(3,"solfnext: file=%s\n",fp->files[fp->ifile]);
+    
+    fp->ifile++;
+    fp->solbuf.n=fp->solbuf.nb=fp->isol=0;
+    fp->solbuf.time.time=0; fp->solbuf.time.sec=0.0;
+    fp->solbuf.rb[0]=fp->solbuf.rb[1]=fp->solbuf.rb[2]=0.0;
+    fp->rsize=0;
+    
+    /* solution options in header */
+    size=fread(head,1,sizeof(head),fp->fp);
+    rewind(fp->fp);
+    if (issolbin(head,size)) fp->opt.posf=SOLF_BIN;
+    else {
+        if (fp->opt.posf==SOLF_BIN) fp->opt.posf=SOLF_LLH;
+        readsolopt(fp->fp,&fp->opt);
+        rewind(fp->fp);
     }
-    solbuf->data[solbuf->n++]=*sol;
+    return 1;
+}
+/* read binary solution record from solution stream --------------------------*/
+static int solfreadbin(solfp_t *fp, sol_t *sol)
+{
+    int n,hsize,rsize;
+    
+    for (;;) {
+        n=fp->rsize>0?fp->rsize:(int)sizeof(solbinh_t);
+        if (fread(fp->buff,n,1,fp->fp)!=1) return 0;
+        
+        /* binary solution header */
+        if (issolbin(fp->buff,n)) {
+            if (!decode_solbinh(fp->buff,&hsize,&rsize,&fp->outvel)||
+                rsize>SOLFBUFF||fseek(fp->fp,(long)(hsize-n),SEEK_CUR)) {
+                return 0;
+            }
+            fp->rsize=rsize;
+            continue;
+        }
+        if (fp->rsize<=0) {
+            trace(2,"solfreadbin: no header\n");
+            return 0;
+        }
+        decode_solbin(fp->buff,fp->outvel,sol);
+        
+        if (screent(sol->time,fp->ts,fp->te,fp->tint)&&
+            (!fp->qflag||sol->stat==fp->qflag)) return 1;
+    }
+}
+/* read solution from solution stream ----------------------------------------*/
+static int solfread1(solfp_t *fp, sol_t *sol)
+{
+    size_t n;
+    
+    for (;;) {
+        if (fp->opt.posf==SOLF_BIN&&fp->fp) {
+            if (solfreadbin(fp,sol)) return 1;
+        }
+        else if (fp->isol<fp->solbuf.n) {
+            *sol=fp->solbuf.data[fp->isol++];
+            return 1;
+        }
+        else if (fp->fp&&(n=fread(fp->buff,1,SOLFBUFF,fp->fp))>0) {
+            
+            /* decode solutions in read buffer */
+            fp->solbuf.n=fp->isol=0;
+            readsoldatam(fp->buff,fp->buff+n,fp->ts,fp->te,fp->tint,fp->qflag,
+                         &fp->opt,&fp->solbuf);
+            if (norm(fp->solbuf.rb,3)>0.0) matcpy(fp->rb,fp->solbuf.rb,3,1);
+            continue;
+        }
+        if (!solfnext(fp)) return 0;
+    }
+}
+/* open solution stream --------------------------------------------------------
+* open solution files to read solutions one by one with constant memory
+* args   : solfp_t *fp      O  solution stream
+*          char   *files[]  I  solution files
+*          int    nfile     I  number of files
+*          gtime_t ts       I  start time (ts.time==0: from start)
+*          gtime_t te       I  end time   (te.time==0: to end)
+*          double tint      I  time interval (0: all)
+*          int    qflag     I  quality flag  (0: all)
+* return : status (1:ok,0:error)
+* notes  : files are read in the order of files[] without sort or merge by
+*          time, unlike readsolt(). files[] should be kept until solfclose().
+*          text and binary (SOLF_BIN) solution files can be mixed.
+*-----------------------------------------------------------------------------*/
+extern int solfopen(solfp_t *fp, char *files[], int nfile, gtime_t ts,
+                    gtime_t te, double tint, int qflag)
+{
+    static const solfp_t fp0={0};
+    
+    trace(3,"solfopen: nfile=%d\n",nfile);
+    
+    *fp=fp0;
+    fp->files=files;
+    fp->nfile=nfile;
+    fp->ts=ts; fp->te=te; fp->tint=tint; fp->qflag=qflag;
+    fp->opt=solopt_default;
+    
+    if (!(fp->buff=(char *)malloc(SOLFBUFF))) {
+        trace(1,"solfopen: memory allocation error\n");
+        return 0;
+    }
+    initsolbuf(&fp->solbuf,0,0);
+    return 1;
+}
+/* set decimation of solution stream -------------------------------------------
+* set Douglas-Peucker decimation of solutions read by solfread()
+* args   : solfp_t *fp      IO solution stream
+*          double tol       I  tolerance of decimation (m) (0: no decimation)
+*          int    bystat    I  keep solution status changes (0:off,1:on)
+* return : status (1:ok,0:error)
+* notes  : the decimation is applied to each window of SOLFWIN solutions with
+*          the last solution of a window as the first of the next one. so the
+*          result is an approximation of the decimation of the whole track.
+*          with bystat=1, the first and the last solution of each run of the
+*          same solution status are kept.
+*          distances are measured in 3D between ecef positions (sol.rr).
+*-----------------------------------------------------------------------------*/
+extern int solfdecim(solfp_t *fp, double tol, int bystat)
+{
+    trace(3,"solfdecim: tol=%.3f bystat=%d\n",tol,bystat);
+    
+    fp->tol=tol;
+    fp->bystat=bystat;
+    if (tol<=0.0||fp->data) return 1;
+    
+    fp->data =(sol_t   *)malloc(sizeof(sol_t  )*SOLFWIN);
+    fp->keep =(uint8_t *)malloc(sizeof(uint8_t)*SOLFWIN);
+    fp->stack=(int     *)malloc(sizeof(int    )*SOLFWIN*2);
+    if (!fp->data||!fp->keep||!fp->stack) {
+        trace(1,"solfdecim: memory allocation error\n");
+        free(fp->data); free(fp->keep); free(fp->stack);
+        fp->data=NULL; fp->keep=NULL; fp->stack=NULL;
+        fp->tol=0.0;
+        return 0;
+    }
+    fp->nmax=SOLFWIN;
+    return 1;
+}
+/* open solution stream with decimation ----------------------------------------
+* open solution stream and set decimation (see solfopen() and solfdecim())
+* args   : solfp_t *fp      O  solution stream
+*          char   *files[]  I  solution files
+*          int    nfile     I  number of files
+*          gtime_t ts,te    I  start/end time (time==0: from start/to end)
+*          double tint      I  time interval (0: all)
+*          int    qflag     I  quality flag  (0: all)
+*          double tol       I  tolerance of decimation (m) (0: no decimation)
+*          int    bystat    I  keep solution status changes (0:off,1:on)
+* return : status (1:ok,0:error)
+*-----------------------------------------------------------------------------*/
+extern int solfopendp(solfp_t *fp, char *files[], int nfile, gtime_t ts,
+                      gtime_t te, double tint, int qflag, double tol,
+                      int bystat)
+{
+    if (!solfopen(fp,files,nfile,ts,te,tint,qflag)) return 0;
+    if (!solfdecim(fp,tol,bystat)) {
+        solfclose(fp);
+        return 0;
+    }
+    return 1;
+}
+/* offset of solutions ---------------------------------------------------------
+* read solution files and get offset of positions and reference position
+* args   : char   *files[]  I  solution files
+*          int    nfile     I  number of files
+*          gtime_t ts,te    I  start/end time (time==0: from start/to end)
+*          double tint      I  time interval (0: all)
+*          int    qflag     I  quality flag  (0: all)
+*          double *offset   I  offset {east,north,up} (m)
+*          int    all       I  mean position of all solutions (0:first only)
+*          double *dr       O  offset in ecef {x,y,z} (m) at mean position
+*          double *rb       O  reference position {x,y,z} (ecef) (m)
+*          gtime_t *time0   O  time of first solution
+* return : number of solutions for mean position (0:no solution)
+* notes  : only the first solution is read with all=0
+*-----------------------------------------------------------------------------*/
+extern int solfoffset(char *files[], int nfile, gtime_t ts, gtime_t te,
+                      double tint, int qflag, const double *offset, int all,
+                      double *dr, double *rb, gtime_t *time0)
+{
+    solfp_t solf;
+    sol_t sol;
+    double rr[3]={0},pos[3];
+    int i,n;
+    
+    if (!solfopen(&solf,files,nfile,ts,te,tint,qflag)) return 0;
+    
+    /* mean position only for offset or reference position */
+    for (n=0;n<1||all;n++) {
+        if (!solfread(&solf,&sol)) break;
+        if (n==0) *time0=sol.time;
+        for (i=0;i<3;i++) rr[i]+=sol.rr[i];
+    }
+    matcpy(rb,solf.rb,3,1);
+    solfclose(&solf);
+    
+    if (n<=0) return 0;
+    
+    for (i=0;i<3;i++) rr[i]/=n;
+    ecef2pos(rr,pos);
+    enu2ecef(pos,offset,dr);
+    return n;
+}
+/* distance between point and segment ----------------------------------------*/
+static double distseg(const double *r, const double *r1, const double *r2)
+{
+    double a[3],b[3],t,ab=0.0,bb=0.0;
+    int i;
+    
+    for (i=0;i<3;i++) {
+        a[i]=r[i]-r1[i];
+        b[i]=r2[i]-r1[i];
+        ab+=a[i]*b[i];
+        bb+=b[i]*b[i];
+    }
+    t=bb>0.0?ab/bb:0.0;
+    if (t<0.0) t=0.0; else if (t>1.0) t=1.0;
+    for (i=0;i<3;i++) a[i]-=t*b[i];
+    return norm(a,3);
+}
+/* Douglas-Peucker decimation of solutions in window -------------------------*/
+static void decimate(solfp_t *fp)
+{
+    double d,dmax;
+    int i,j,k,kmax,ns=0;
+    
+    for (i=0;i<fp->n;i++) fp->keep[i]=i==0||i==fp->n-1;
+    if (fp->n<=2) return;
+    
+    fp->stack[ns++]=0;
+    fp->stack[ns++]=fp->n-1;
+    
+    while (ns>0) {
+        j=fp->stack[--ns];
+        i=fp->stack[--ns];
+        for (k=i+1,kmax=-1,dmax=fp->tol;k<j;k++) {
+            d=distseg(fp->data[k].rr,fp->data[i].rr,fp->data[j].rr);
+            if (d>dmax) {dmax=d; kmax=k;}
+        }
+        if (kmax<0) continue;
+        fp->keep[kmax]=1;
+        if (kmax-i>1) {fp->stack[ns++]=i;    fp->stack[ns++]=kmax;}
+        if (j-kmax>1) {fp->stack[ns++]=kmax; fp->stack[ns++]=j;   }
+    }
+}
+/* read solution from solution stream ------------------------------------------
+* read next solution from solution stream
+* args   : solfp_t *fp      IO solution stream
+*          sol_t  *sol      O  solution
+* return : status (1:ok,0:end of solutions)
+* notes  : the reference position in solution files is set to fp->rb.
+*-----------------------------------------------------------------------------*/
+extern int solfread(solfp_t *fp, sol_t *sol)
+{
+    if (fp->tol<=0.0) return solfread1(fp,sol);
+    
+    for (;;) {
+        /* output kept solutions in decimated window */
+        while (fp->iout<fp->nout) {
+            if (fp->keep[fp->iout]) {
+                *sol=fp->data[fp->iout++];
+                return 1;
+            }
+            fp->iout++;
+        }
+        if (fp->end) return 0;
+        
+        if (fp->nout>0) {
+            memmove(fp->data,fp->data+fp->nout,sizeof(sol_t)*(fp->n-fp->nout));
+            fp->n-=fp->nout;
+            fp->nout=fp->iout=0;
+        }
+        if (!solfread1(fp,fp->data+fp->n)) {
+            decimate(fp);
+            fp->nout=fp->n;
+            fp->end=1;
+            continue;
+        }
+        /* decimate solutions before change of solution status */
+        if (fp->bystat&&fp->n>0&&fp->data[fp->n].stat!=fp->data[fp->n-1].stat) {
+            decimate(fp);
+            fp->nout=fp->n++;
+            continue;
+        }
+        if (++fp->n<fp->nmax) continue;
+        
+        /* decimate window with the last solution kept to the next */
+        decimate(fp);
+        fp->nout=fp->n-1;
+    }
+}
+/* close solution stream -------------------------------------------------------
+* close solution stream and free memory
+* args   : solfp_t *fp      IO solution stream
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void solfclose(solfp_t *fp)
+{
+    trace(3,"solfclose:\n");
+    
+    if (fp->fp) fclose(fp->fp);
+    freesolbuf(&fp->solbuf);
+    free(fp->buff);
+    free(fp->data);
+    free(fp->keep);
+    free(fp->stack);
+    fp->fp=NULL;
+    fp->buff=NULL;
+    fp->data=NULL;
+    fp->keep=NULL;
+    fp->stack=NULL;
+}
+/* add solution data to solution buffer ----------------------------------------
+* add solution data to solution buffer
+* args   : solbuf_t *solbuf IO solution buffer
+*          sol_t  *sol      I  solution data
+* return : status (1:ok,0:error)
+*-----------------------------------------------------------------------------*/
+extern int addsol(solbuf_t *solbuf, const sol_t *sol)
+{
+    sol_t *solbuf_data;
+    
+    trace(4,"addsol:\n");
+    
+    if (solbuf->cyclic) { /* ring buffer */
+        if (solbuf->nmax<=1) return 0;
+        solbuf->data[solbuf->end]=*sol;
+        if (++solbuf->end>=solbuf->nmax) solbuf->end=0;
+        if (solbuf->start==solbuf->end) {
+            if (++solbuf->start>=solbuf->nmax) solbuf->start=0;
+        }
+        else solbuf->n++;
+        
+        return 1;
+    }
+    if (solbuf->n>=solbuf->nmax) {
+        solbuf->nmax=solbuf->nmax==0?8192:solbuf->nmax*2;
+        if (!(solbuf_data=(sol_t *)realloc(solbuf->data,sizeof(sol_t)*solbuf->nmax))) {
+            trace(1,"addsol: memory allocation error\n");
+            free(solbuf->data); solbuf->data=NULL; solbuf->n=solbuf->nmax=0;
+            return 0;
+        }
+        solbuf->data=solbuf_data;
+    }
+    solbuf->data[solbuf->n++]=*sol;
     return 1;
 }
 /* get solution data from solution buffer --------------------------------------
@@ -1007,6 +1909,148 @@ extern void freesolbuf(solbuf_t *solbuf)
         solbuf->rb[i]=0.0;
     }
 }
+/* pack solution to solution record -------------------------------------------
+* pack solution to packed solution record
+* args   : sol_t  *sol      I   solution
+*          uint32_t seq     I   sequence number of solution
+*          solrec_t *rec    O   packed solution record
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void soltorec(const sol_t *sol, uint32_t seq, solrec_t *rec)
+{
+    int i;
+    
+    rec->seq =seq;
+    rec->type=sol->type;
+    rec->stat=sol->stat;
+    rec->ns  =sol->ns;
+    rec->pad =0;
+    rec->time=(int64_t)sol->time.time;
+    rec->sec =sol->time.sec;
+    for (i=0;i<6;i++) {
+        rec->rr [i]=sol->rr [i];
+        rec->dtr[i]=sol->dtr[i];
+        rec->qr [i]=sol->qr [i];
+    }
+    rec->age  =sol->age;
+    rec->ratio=sol->ratio;
+}
+/* unpack solution from solution record ----------------------------------------
+* unpack solution from packed solution record
+* args   : solrec_t *rec    I   packed solution record
+*          sol_t  *sol      O   solution (fields not in record are cleared)
+*          uint32_t *seq    O   sequence number of solution (NULL: no output)
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void rectosol(const solrec_t *rec, sol_t *sol, uint32_t *seq)
+{
+    sol_t sol0={{0}};
+    int i;
+    
+    *sol=sol0;
+    sol->type=rec->type;
+    sol->stat=rec->stat;
+    sol->ns  =rec->ns;
+    sol->time.time=(time_t)rec->time;
+    sol->time.sec =rec->sec;
+    for (i=0;i<6;i++) {
+        sol->rr [i]=rec->rr [i];
+        sol->dtr[i]=rec->dtr[i];
+        sol->qr [i]=rec->qr [i];
+    }
+    sol->age  =rec->age;
+    sol->ratio=rec->ratio;
+    if (seq) *seq=rec->seq;
+}
+/* initialize solution ring ----------------------------------------------------
+* initialize single producer/single consumer ring of packed solution records
+* args   : solring_t *ring  IO  solution ring
+*          int    nrec      I   number of records (2^n)
+* return : status (1:ok,0:error)
+* notes  : the ring memory is a header (solringh_t) followed by the records
+*          (solrec_t). it can be shared with another process or language
+*          (e.g. java direct ByteBuffer) as is.
+*          head, over and tail are counters of records with wrap-around.
+*          the producer writes head and over, the consumer writes tail.
+*          the producer never blocks. if the ring is full, the solution is
+*          dropped and counted in over. record sequence number is head+over,
+*          so a gap in sequence numbers shows dropped solutions.
+*-----------------------------------------------------------------------------*/
+extern int solringinit(solring_t *ring, int nrec)
+{
+    trace(3,"solringinit: nrec=%d\n",nrec);
+    
+    ring->buff=NULL; ring->size=0; ring->h=NULL; ring->rec=NULL;
+    
+    if (nrec<=0||(nrec&(nrec-1))) return 0;
+    ring->size=(int)(sizeof(solringh_t)+sizeof(solrec_t)*nrec);
+    if (!(ring->buff=(uint8_t *)calloc(ring->size,1))) {
+        ring->size=0;
+        return 0;
+    }
+    ring->h=(solringh_t *)ring->buff;
+    ring->rec=(solrec_t *)(ring->buff+sizeof(solringh_t));
+    ring->h->nrec=(uint32_t)nrec;
+    ring->h->size=(uint32_t)sizeof(solrec_t);
+    return 1;
+}
+/* free solution ring ----------------------------------------------------------
+* free solution ring
+* args   : solring_t *ring  IO  solution ring
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void solringfree(solring_t *ring)
+{
+    free(ring->buff);
+    ring->buff=NULL; ring->size=0; ring->h=NULL; ring->rec=NULL;
+}
+/* put solution to solution ring -----------------------------------------------
+* put solution to solution ring (producer)
+* args   : solring_t *ring  IO  solution ring
+*          sol_t  *sol      I   solution
+* return : status (1:ok,0:ring full or not initialized)
+*-----------------------------------------------------------------------------*/
+extern int solringput(solring_t *ring, const sol_t *sol)
+{
+    solringh_t *h=ring->h;
+    uint32_t head;
+    
+    if (!h) return 0;
+    
+    head=h->head;
+    if (head-rtkloadacq(&h->tail)>=h->nrec) {
+        rtkstorerel(&h->over,h->over+1);
+        return 0;
+    }
+    soltorec(sol,head+h->over,ring->rec+(head&(h->nrec-1)));
+    
+    /* publish record */
+    rtkstorerel(&h->head,head+1);
+    return 1;
+}
+/* get solution from solution ring ---------------------------------------------
+* get oldest solution from solution ring (consumer)
+* args   : solring_t *ring  IO  solution ring
+*          sol_t  *sol      O   solution (fields not in record are cleared)
+*          uint32_t *seq    O   sequence number of solution (NULL: no output)
+* return : status (1:ok,0:no solution)
+*-----------------------------------------------------------------------------*/
+extern int solringget(solring_t *ring, sol_t *sol, uint32_t *seq)
+{
+    solringh_t *h=ring->h;
+    uint32_t tail;
+    
+    if (!h) return 0;
+    
+    tail=h->tail;
+    if (rtkloadacq(&h->head)==tail) return 0;
+    
+    rectosol(ring->rec+(tail&(h->nrec-1)),sol,seq);
+    
+    /* release record */
+    rtkstorerel(&h->tail,tail+1);
+    return 1;
+}
 extern void freesolstatbuf(solstatbuf_t *solstatbuf)
 {
     trace(3,"freesolstatbuf: n=%d\n",solstatbuf->n);
@@ -1123,6 +2167,95 @@ static int readsolstatdata(FILE *fp, gtime_t ts, gtime_t te, double tint,
     }
     return statbuf->n>0;
 }
+/* read binary solution status header ---------------------------------------*/
+static int readstatbinh(FILE *fp, statbinh_t *h)
+{
+    if (fread(h,sizeof(*h),1,fp)!=1||memcmp(h->magic,STATBIN_MAGIC,7)) {
+        return 0;
+    }
+    if (h->order!=SOLBIN_ORDER||h->hsize<sizeof(*h)||
+        h->esize<sizeof(statbine_t)||h->ssize<sizeof(statbins_t)||
+        h->fsize<sizeof(statbinf_t)) {
+        trace(2,"binary solution status header error ver=%d order=%08X\n",
+              h->ver,h->order);
+        return 0;
+    }
+    return !fseek(fp,(long)(h->hsize-sizeof(*h)),SEEK_CUR);
+}
+/* read binary solution status epoch record ----------------------------------*/
+static int readstatbine(FILE *fp, const statbinh_t *h, statbine_t *e,
+                        uint8_t **buff, uint32_t *nmax)
+{
+    uint8_t *p;
+    uint32_t size;
+    
+    if (fread(&size,sizeof(size),1,fp)!=1||size<h->esize) return 0;
+    
+    if (size>*nmax) {
+        if (!(p=(uint8_t *)realloc(*buff,size))) {
+            trace(1,"readstatbine: memory allocation error\n");
+            return 0;
+        }
+        *buff=p;
+        *nmax=size;
+    }
+    memcpy(*buff,&size,sizeof(size));
+    if (fread(*buff+sizeof(size),size-sizeof(size),1,fp)!=1) {
+        trace(2,"readstatbine: truncated record\n");
+        return 0;
+    }
+    memcpy(e,*buff,sizeof(*e));
+    if (h->esize+e->nstate+(uint32_t)e->nsat*(h->ssize+e->nfreq*h->fsize)>size) {
+        trace(2,"readstatbine: record size error size=%u\n",size);
+        return 0;
+    }
+    return 1;
+}
+/* read binary solution status data ------------------------------------------*/
+static int readsolstatbin(FILE *fp, const statbinh_t *h, gtime_t ts,
+                          gtime_t te, double tint, solstatbuf_t *statbuf)
+{
+    static const solstat_t stat0={{0}};
+    solstat_t stat;
+    statbine_t e;
+    statbins_t s;
+    statbinf_t f;
+    uint8_t *buff=NULL,*p;
+    uint32_t nmax=0;
+    int i,j;
+    
+    trace(3,"readsolstatbin:\n");
+    
+    while (readstatbine(fp,h,&e,&buff,&nmax)) {
+        stat=stat0;
+        stat.time=gpst2time(e.week,e.tow);
+        if (!screent(stat.time,ts,te,tint)) continue;
+        
+        p=buff+h->esize+e.nstate;
+        for (i=0;i<e.nsat;i++) {
+            memcpy(&s,p,sizeof(s));
+            p+=h->ssize;
+            for (j=0;j<e.nfreq;j++,p+=h->fsize) {
+                memcpy(&f,p,sizeof(f));
+                stat.sat  =(uint8_t)s.sat;
+                stat.frq  =(uint8_t)(j+1);
+                stat.az   =(float)s.azel[0];
+                stat.el   =(float)s.azel[1];
+                stat.resp =(float)f.resp;
+                stat.resc =(float)f.resc;
+                stat.flag =(uint8_t)((f.vsat<<5)+(f.slip<<3)+f.fix);
+                stat.snr  =f.snr;
+                stat.lock =(uint16_t)f.lock;
+                stat.outc =(uint16_t)f.outc;
+                stat.slipc=(uint16_t)f.slipc;
+                stat.rejc =(uint16_t)f.rejc;
+                addsolstat(statbuf,&stat);
+            }
+        }
+    }
+    free(buff);
+    return statbuf->n>0;
+}
 /* read solution status --------------------------------------------------------
 * read solution status from solution status files
 * args   : char   *files[]  I  solution status files
@@ -1132,13 +2265,15 @@ static int readsolstatdata(FILE *fp, gtime_t ts, gtime_t te, double tint,
 *         (double tint)     I  time interval (0: all)
 *          solstatbuf_t *statbuf O  solution status buffer
 * return : status (1:ok,0:no data or error)
+* notes  : binary solution status files (SSTAT_BIN) are detected by the header
 *-----------------------------------------------------------------------------*/
 extern int readsolstatt(char *files[], int nfile, gtime_t ts, gtime_t te,
                         double tint, solstatbuf_t *statbuf)
 {
     FILE *fp;
+    statbinh_t h;
     char path[1024],*p;
-    int i;
+    int i,stat;
     
     trace(3,"readsolstatt: nfile=%d\n",nfile);
     
@@ -1152,12 +2287,19 @@ extern int readsolstatt(char *files[], int nfile, gtime_t ts, gtime_t te,
         else {
         sprintf(path,"%s.stat",files[i]);
         }
-        if (!(fp=fopen(path,"r"))) {
+        if (!(fp=fopen(path,"rb"))) {
             trace(2,"readsolstatt: file open error %s\n",path);
             continue;
         }
         /* read solution status data */
-        if (!readsolstatdata(fp,ts,te,tint,statbuf)) {
+        if (readstatbinh(fp,&h)) {
+            stat=readsolstatbin(fp,&h,ts,te,tint,statbuf);
+        }
+        else {
+            rewind(fp);
+            stat=readsolstatdata(fp,ts,te,tint,statbuf);
+        }
+        if (!stat) {
             trace(2,"readsolstatt: no solution in %s\n",path);
         }
         fclose(fp);
@@ -1172,39 +2314,208 @@ extern int readsolstat(char *files[], int nfile, solstatbuf_t *statbuf)
     
     return readsolstatt(files,nfile,time,time,0.0,statbuf);
 }
+/* state line formats of solution status (same order as STATL_???) ---------*/
+static const struct {
+    const char *label;  /* label of line */
+    int idx;            /* index field (0:no,1:yes) */
+    const char *prec;   /* precisions of values */
+} statl[]={
+    {"$POS"   ,0,"444444"      }, {"$VELACC",0,"444555444555"},
+    {"$CLK"   ,1,"33332"       }, {"$CLK"   ,1,"33333333"    },
+    {"$ION"   ,0,"1144"        }, {"$TROP"  ,1,"44"          },
+    {"$TRPG"  ,1,"5555"        }, {"$HWBIAS",1,"44"          },
+    {"$AMB"   ,1,"44"          }
+};
+/* output solution status state record -----------------------------------------
+* output solution status state to buffer as binary record without formatting
+* args   : uint8_t *buff    O   output buffer
+*          int    type      I   state line type (STATL_???)
+*          int    sat       I   satellite number (0: no satellite field)
+*          int    idx       I   index field (ignored without index field)
+*          double *v        I   values of state line as output in text
+* return : number of output bytes
+* notes  : statl2str() renders the records to the text solution status
+*-----------------------------------------------------------------------------*/
+extern int outstatl(uint8_t *buff, int type, int sat, int idx, const double *v)
+{
+    statbinl_t l;
+    
+    l.type=(uint8_t)type;
+    l.nv  =(uint8_t)strlen(statl[type].prec);
+    l.sat =(uint16_t)sat;
+    l.idx =(int32_t)idx;
+    memcpy(buff,&l,sizeof(l));
+    memcpy(buff+sizeof(l),v,sizeof(double)*l.nv);
+    return (int)(sizeof(l)+sizeof(double)*l.nv);
+}
+/* size of state record ------------------------------------------------------*/
+static int statlsize(const uint8_t *data, int n)
+{
+    statbinl_t l;
+    int size;
+    
+    if (n<(int)sizeof(l)) return 0;
+    memcpy(&l,data,sizeof(l));
+    size=(int)(sizeof(l)+sizeof(double)*l.nv);
+    if (l.type>=NSTATL||l.nv>strlen(statl[l.type].prec)||size>n) return 0;
+    return size;
+}
+/* render solution status state records ----------------------------------------
+* render solution status state records to text lines
+* args   : uint8_t *data    I   state records (outstatl())
+*          int    n         I   size of state records (bytes)
+*          int    week      I   gps week
+*          double tow       I   gps time of week (s)
+*          int    stat      I   solution status (SOLQ_???)
+*          char   *buff     O   text lines
+* return : number of output characters
+*-----------------------------------------------------------------------------*/
+extern int statl2str(const uint8_t *data, int n, int week, double tow, int stat,
+                     char *buff)
+{
+    statbinl_t l;
+    double v;
+    char *p=buff,id[32];
+    int i,size;
+    
+    for (;(size=statlsize(data,n))>0;data+=size,n-=size) {
+        memcpy(&l,data,sizeof(l));
+        p+=sprintf(p,"%s,%d,%.3f,%d",statl[l.type].label,week,tow,stat);
+        if (l.sat) {
+            satno2id(l.sat,id);
+            p+=sprintf(p,",%s",id);
+        }
+        if (statl[l.type].idx) p+=sprintf(p,",%d",(int)l.idx);
+        for (i=0;i<l.nv;i++) {
+            memcpy(&v,data+sizeof(l)+sizeof(double)*i,sizeof(v));
+            p+=sprintf(p,",%.*f",statl[l.type].prec[i]-'0',v);
+        }
+        p+=sprintf(p,"\n");
+    }
+    return (int)(p-buff);
+}
+/* render binary solution status epoch --------------------------------------*/
+static void outstatbine(FILE *fp, const statbinh_t *h, const statbine_t *e,
+                        const uint8_t *buff)
+{
+    statbins_t s;
+    statbinf_t f;
+    const uint8_t *p=buff+h->esize,*q;
+    char id[32],str[4096];
+    int i,j,size;
+    
+    if (h->ver<2) { /* text of states */
+        fwrite(p,e->nstate,1,fp);
+    }
+    else {
+        for (q=p;(size=statlsize(q,(int)(p+e->nstate-q)))>0;q+=size) {
+            fwrite(str,statl2str(q,size,e->week,e->tow,e->stat,str),1,fp);
+        }
+    }
+    p+=e->nstate;
+    
+    for (i=0;i<e->nsat;i++) {
+        memcpy(&s,p,sizeof(s));
+        p+=h->ssize;
+        satno2id(s.sat,id);
+        for (j=0;j<e->nfreq;j++,p+=h->fsize) {
+            memcpy(&f,p,sizeof(f));
+            fprintf(fp,"$SAT,%d,%.3f,%s,%d,%.1f,%.1f,%.4f,%.4f,%d,%.0f,%d,%d,%d,%d,%d,%d,%.2f,%.6f,%.5f\n",
+                    e->week,e->tow,id,j+1,s.azel[0]*R2D,s.azel[1]*R2D,f.resp,
+                    f.resc,f.vsat,f.snr*SNR_UNIT,f.fix,f.slip,f.lock,
+                    (int)f.outc,(int)f.slipc,(int)f.rejc,f.bias,f.vbias,
+                    f.icbias);
+        }
+    }
+}
+/* convert binary solution status to text --------------------------------------
+* render binary solution status file (SSTAT_BIN) to text solution status file
+* args   : char   *infile   I   binary solution status file
+*          char   *outfile  I   output text solution status file
+*                               ("": <infile>.txt)
+* return : status (0:ok,-1:file read,-2:file format,-4:file write)
+* notes  : the output is the same as the solution status file of level 2
+*-----------------------------------------------------------------------------*/
+extern int convstat(const char *infile, const char *outfile)
+{
+    FILE *ifp,*ofp;
+    statbinh_t h;
+    statbine_t e;
+    uint8_t *buff=NULL;
+    uint32_t nmax=0;
+    char file[1024];
+    
+    trace(3,"convstat: infile=%s outfile=%s\n",infile,outfile);
+    
+    if (!*outfile) sprintf(file,"%s.txt",infile);
+    else strcpy(file,outfile);
+    
+    if (!strcmp(file,infile)) return -4;
+    
+    if (!(ifp=fopen(infile,"rb"))) {
+        trace(2,"convstat: file open error %s\n",infile);
+        return -1;
+    }
+    if (!readstatbinh(ifp,&h)) {
+        fclose(ifp);
+        return -2;
+    }
+    if (!(ofp=fopen(file,"w"))) {
+        trace(2,"convstat: file open error %s\n",file);
+        fclose(ifp);
+        return -4;
+    }
+    while (readstatbine(ifp,&h,&e,&buff,&nmax)) {
+        outstatbine(ofp,&h,&e,buff);
+    }
+    free(buff);
+    fclose(ifp);
+    fclose(ofp);
+    return 0;
+}
+/* output separator and fixed-point number -----------------------------------*/
+static char *sepfix(char *p, const solfmt_t *fmt, double x, int width, int prec)
+{
+    return fmtfix(fmtstr(p,fmt->sep,fmt->nsep),x,width,prec,0);
+}
+/* output separator and integer ----------------------------------------------*/
+static char *sepint(char *p, const solfmt_t *fmt, int x, int width)
+{
+    return fmtint(fmtstr(p,fmt->sep,fmt->nsep),x,width,0);
+}
 /* output solution as the form of x/y/z-ecef ---------------------------------*/
-static int outecef(uint8_t *buff, const char *s, const sol_t *sol,
-                   const solopt_t *opt)
+static int outecef(uint8_t *buff, const sol_t *sol, const solopt_t *opt,
+                   const solfmt_t *fmt)
 {
-    const char *sep=opt2sep(opt);
     char *p=(char *)buff;
+    int i;
     
     trace(3,"outecef:\n");
     
-    p+=sprintf(p,"%s%s%14.4f%s%14.4f%s%14.4f%s%3d%s%3d%s%8.4f%s%8.4f%s%8.4f%s"
-               "%8.4f%s%8.4f%s%8.4f%s%6.2f%s%6.1f",
-               s,sep,sol->rr[0],sep,sol->rr[1],sep,sol->rr[2],sep,sol->stat,sep,
-               sol->ns,sep,SQRT(sol->qr[0]),sep,SQRT(sol->qr[1]),sep,
-               SQRT(sol->qr[2]),sep,sqvar(sol->qr[3]),sep,sqvar(sol->qr[4]),sep,
-               sqvar(sol->qr[5]),sep,sol->age,sep,sol->ratio);
+    for (i=0;i<3;i++) p=sepfix(p,fmt,sol->rr[i],14,4);
+    p=sepint(p,fmt,sol->stat,3);
+    p=sepint(p,fmt,sol->ns,3);
+    for (i=0;i<3;i++) p=sepfix(p,fmt,SQRT(sol->qr[i]),8,4);
+    for (i=3;i<6;i++) p=sepfix(p,fmt,sqvar(sol->qr[i]),8,4);
+    p=sepfix(p,fmt,sol->age,6,2);
+    p=sepfix(p,fmt,sol->ratio,6,1);
     
     if (opt->outvel) { /* output velocity */
-        p+=sprintf(p,"%s%10.5f%s%10.5f%s%10.5f%s%9.5f%s%8.5f%s%8.5f%s%8.5f%s"
-                   "%8.5f%s%8.5f",
-                   sep,sol->rr[3],sep,sol->rr[4],sep,sol->rr[5],sep,
-                   SQRT(sol->qv[0]),sep,SQRT(sol->qv[1]),sep,SQRT(sol->qv[2]),
-                   sep,sqvar(sol->qv[3]),sep,sqvar(sol->qv[4]),sep,
-                   sqvar(sol->qv[5]));
-    }
-    p+=sprintf(p,"\r\n");
+        for (i=3;i<6;i++) p=sepfix(p,fmt,sol->rr[i],10,5);
+        p=sepfix(p,fmt,SQRT(sol->qv[0]),9,5);
+        p=sepfix(p,fmt,SQRT(sol->qv[1]),8,5);
+        p=sepfix(p,fmt,SQRT(sol->qv[2]),8,5);
+        for (i=3;i<6;i++) p=sepfix(p,fmt,sqvar(sol->qv[i]),8,5);
+    }
+    p=fmtstr(p,"\r\n",2);
+    *p='\0';
     return (int)(p-(char *)buff);
 }
 /* output solution as the form of lat/lon/height -----------------------------*/
-static int outpos(uint8_t *buff, const char *s, const sol_t *sol,
-                  const solopt_t *opt)
+static int outpos(uint8_t *buff, const sol_t *sol, const solopt_t *opt,
+                  const solfmt_t *fmt)
 {
     double pos[3],vel[3],dms1[3],dms2[3],P[9],Q[9];
-    const char *sep=opt2sep(opt);
     char *p=(char *)buff;
     
     trace(3,"outpos  :\n");
@@ -1218,39 +2529,53 @@ static int outpos(uint8_t *buff, const char *s, const sol_t *sol,
     if (opt->degf) {
         deg2dms(pos[0]*R2D,dms1,5);
         deg2dms(pos[1]*R2D,dms2,5);
-        p+=sprintf(p,"%s%s%4.0f%s%02.0f%s%08.5f%s%4.0f%s%02.0f%s%08.5f",s,sep,
-                   dms1[0],sep,dms1[1],sep,dms1[2],sep,dms2[0],sep,dms2[1],sep,
-                   dms2[2]);
+        p=sepfix(p,fmt,dms1[0],4,0);
+        p=fmtfix(fmtstr(p,fmt->sep,fmt->nsep),dms1[1],2,0,1);
+        p=fmtfix(fmtstr(p,fmt->sep,fmt->nsep),dms1[2],8,5,1);
+        p=sepfix(p,fmt,dms2[0],4,0);
+        p=fmtfix(fmtstr(p,fmt->sep,fmt->nsep),dms2[1],2,0,1);
+        p=fmtfix(fmtstr(p,fmt->sep,fmt->nsep),dms2[2],8,5,1);
     }
     else {
-        p+=sprintf(p,"%s%s%14.9f%s%14.9f",s,sep,pos[0]*R2D,sep,pos[1]*R2D);
-    }
-    p+=sprintf(p,"%s%10.4f%s%3d%s%3d%s%8.4f%s%8.4f%s%8.4f%s%8.4f%s%8.4f%s%8.4f"
-               "%s%6.2f%s%6.1f",
-               sep,pos[2],sep,sol->stat,sep,sol->ns,sep,SQRT(Q[4]),sep,
-               SQRT(Q[0]),sep,SQRT(Q[8]),sep,sqvar(Q[1]),sep,sqvar(Q[2]),
-               sep,sqvar(Q[5]),sep,sol->age,sep,sol->ratio);
+        p=sepfix(p,fmt,pos[0]*R2D,14,9);
+        p=sepfix(p,fmt,pos[1]*R2D,14,9);
+    }
+    p=sepfix(p,fmt,pos[2],10,4);
+    p=sepint(p,fmt,sol->stat,3);
+    p=sepint(p,fmt,sol->ns,3);
+    p=sepfix(p,fmt,SQRT(Q[4]),8,4);
+    p=sepfix(p,fmt,SQRT(Q[0]),8,4);
+    p=sepfix(p,fmt,SQRT(Q[8]),8,4);
+    p=sepfix(p,fmt,sqvar(Q[1]),8,4);
+    p=sepfix(p,fmt,sqvar(Q[2]),8,4);
+    p=sepfix(p,fmt,sqvar(Q[5]),8,4);
+    p=sepfix(p,fmt,sol->age,6,2);
+    p=sepfix(p,fmt,sol->ratio,6,1);
     
     if (opt->outvel) { /* output velocity */
         soltocov_vel(sol,P);
         ecef2enu(pos,sol->rr+3,vel);
         covenu(pos,P,Q);
-        p+=sprintf(p,"%s%10.5f%s%10.5f%s%10.5f%s%9.5f%s%8.5f%s%8.5f%s%8.5f%s"
-                   "%8.5f%s%8.5f",
-                   sep,vel[1],sep,vel[0],sep,vel[2],sep,SQRT(Q[4]),sep,
-                   SQRT(Q[0]),sep,SQRT(Q[8]),sep,sqvar(Q[1]),sep,sqvar(Q[2]),
-                   sep,sqvar(Q[5]));
-    }
-    p+=sprintf(p,"\r\n");
+        p=sepfix(p,fmt,vel[1],10,5);
+        p=sepfix(p,fmt,vel[0],10,5);
+        p=sepfix(p,fmt,vel[2],10,5);
+        p=sepfix(p,fmt,SQRT(Q[4]),9,5);
+        p=sepfix(p,fmt,SQRT(Q[0]),8,5);
+        p=sepfix(p,fmt,SQRT(Q[8]),8,5);
+        p=sepfix(p,fmt,sqvar(Q[1]),8,5);
+        p=sepfix(p,fmt,sqvar(Q[2]),8,5);
+        p=sepfix(p,fmt,sqvar(Q[5]),8,5);
+    }
+    p=fmtstr(p,"\r\n",2);
+    *p='\0';
     return (int)(p-(char *)buff);
 }
 /* output solution as the form of e/n/u-baseline -----------------------------*/
-static int outenu(uint8_t *buff, const char *s, const sol_t *sol,
-                  const double *rb, const solopt_t *opt)
+static int outenu(uint8_t *buff, const sol_t *sol, const double *rb,
+                  const solfmt_t *fmt)
 {
     double pos[3],rr[3],enu[3],P[9],Q[9];
     int i;
-    const char *sep=opt2sep(opt);
     char *p=(char *)buff;
     
     trace(3,"outenu  :\n");
@@ -1260,28 +2585,57 @@ static int outenu(uint8_t *buff, const char *s, const sol_t *sol,
     soltocov(sol,P);
     covenu(pos,P,Q);
     ecef2enu(pos,rr,enu);
-    p+=sprintf(p,"%s%s%14.4f%s%14.4f%s%14.4f%s%3d%s%3d%s%8.4f%s%8.4f%s%8.4f%s"
-               "%8.4f%s%8.4f%s%8.4f%s%6.2f%s%6.1f\r\n",
-               s,sep,enu[0],sep,enu[1],sep,enu[2],sep,sol->stat,sep,sol->ns,sep,
-               SQRT(Q[0]),sep,SQRT(Q[4]),sep,SQRT(Q[8]),sep,sqvar(Q[1]),
-               sep,sqvar(Q[5]),sep,sqvar(Q[2]),sep,sol->age,sep,sol->ratio);
+    for (i=0;i<3;i++) p=sepfix(p,fmt,enu[i],14,4);
+    p=sepint(p,fmt,sol->stat,3);
+    p=sepint(p,fmt,sol->ns,3);
+    p=sepfix(p,fmt,SQRT(Q[0]),8,4);
+    p=sepfix(p,fmt,SQRT(Q[4]),8,4);
+    p=sepfix(p,fmt,SQRT(Q[8]),8,4);
+    p=sepfix(p,fmt,sqvar(Q[1]),8,4);
+    p=sepfix(p,fmt,sqvar(Q[5]),8,4);
+    p=sepfix(p,fmt,sqvar(Q[2]),8,4);
+    p=sepfix(p,fmt,sol->age,6,2);
+    p=sepfix(p,fmt,sol->ratio,6,1);
+    p=fmtstr(p,"\r\n",2);
+    *p='\0';
     return (int)(p-(char *)buff);
 }
+/* output NMEA time ----------------------------------------------------------*/
+static char *fmtnmeatime(char *p, const double *ep)
+{
+    p=fmtfix(p,ep[3],2,0,1);
+    p=fmtfix(p,ep[4],2,0,1);
+    return fmtfix(p,ep[5],5,2,1);
+}
+/* output NMEA latitude and longitude ----------------------------------------*/
+static char *fmtnmeapos(char *p, const double *pos)
+{
+    double dms1[3],dms2[3];
+    
+    deg2dms(fabs(pos[0])*R2D,dms1,7);
+    deg2dms(fabs(pos[1])*R2D,dms2,7);
+    p=fmtfix(p,dms1[0],2,0,1);
+    p=fmtfix(p,dms1[1]+dms1[2]/60.0,10,7,1);
+    p=fmtstr(p,pos[0]>=0?",N,":",S,",3);
+    p=fmtfix(p,dms2[0],3,0,1);
+    p=fmtfix(p,dms2[1]+dms2[2]/60.0,10,7,1);
+    return fmtstr(p,pos[1]>=0?",E,":",W,",3);
+}
 /* output solution in the form of NMEA RMC sentence --------------------------*/
 extern int outnmea_rmc(uint8_t *buff, const sol_t *sol)
 {
-    static double dirp=0.0;
+    static THREADLOCAL double dirp=0.0;
     gtime_t time;
-    double ep[6],pos[3],enuv[3],dms1[3],dms2[3],vel,dir,amag=0.0;
-    char *p=(char *)buff,*q,sum;
+    double ep[6],pos[3],enuv[3],vel,dir,amag=0.0;
+    char *p=(char *)buff;
     const char *emag="E",*mode="A",*status="V";
     
     trace(3,"outnmea_rmc:\n");
     
     if (sol->stat<=SOLQ_NONE) {
-        p+=sprintf(p,"$%sRMC,,,,,,,,,,,,,",NMEA_TID);
-        for (q=(char *)buff+1,sum=0;*q;q++) sum^=*q;
-        p+=sprintf(p,"*%02X%c%c",sum,0x0D,0x0A);
+        p=fmtstr(p,"$" NMEA_TID "RMC,,,,,,,,,,,,,",
+                 (int)strlen("$" NMEA_TID "RMC,,,,,,,,,,,,,"));
+        p=fmtsum((char *)buff,p);
         return (int)(p-(char *)buff);
     }
     time=gpst2utc(sol->time);
@@ -1301,31 +2655,36 @@ extern int outnmea_rmc(uint8_t *buff, const sol_t *sol)
     if      (sol->stat==SOLQ_DGPS ||sol->stat==SOLQ_SBAS) mode="D";
     else if (sol->stat==SOLQ_FLOAT||sol->stat==SOLQ_FIX ) mode="R";
     else if (sol->stat==SOLQ_PPP) mode="P";
-    deg2dms(fabs(pos[0])*R2D,dms1,7);
-    deg2dms(fabs(pos[1])*R2D,dms2,7);
-    p+=sprintf(p,"$%sRMC,%02.0f%02.0f%05.2f,A,%02.0f%010.7f,%s,%03.0f%010.7f,"
-               "%s,%4.2f,%4.2f,%02.0f%02.0f%02d,%.1f,%s,%s,%s",
-               NMEA_TID,ep[3],ep[4],ep[5],dms1[0],dms1[1]+dms1[2]/60.0,
-               pos[0]>=0?"N":"S",dms2[0],dms2[1]+dms2[2]/60.0,pos[1]>=0?"E":"W",
-               vel/KNOT2M,dir,ep[2],ep[1],(int)ep[0]%100,amag,emag,mode,status);
-    for (q=(char *)buff+1,sum=0;*q;q++) sum^=*q; /* check-sum */
-    p+=sprintf(p,"*%02X\r\n",sum);
+    p=fmtstr(p,"$" NMEA_TID "RMC,",(int)strlen("$" NMEA_TID "RMC,"));
+    p=fmtnmeatime(p,ep);
+    p=fmtstr(p,",A,",3);
+    p=fmtnmeapos(p,pos);
+    p=fmtfix(p,vel/KNOT2M,4,2,0); *p++=',';
+    p=fmtfix(p,dir,4,2,0); *p++=',';
+    p=fmtfix(p,ep[2],2,0,1);
+    p=fmtfix(p,ep[1],2,0,1);
+    p=fmtint(p,(int)ep[0]%100,2,1); *p++=',';
+    p=fmtfix(p,amag,0,1,0); *p++=',';
+    *p++=*emag; *p++=',';
+    *p++=*mode; *p++=',';
+    *p++=*status;
+    p=fmtsum((char *)buff,p);
     return (int)(p-(char *)buff);
 }
 /* output solution in the form of NMEA GGA sentence --------------------------*/
 extern int outnmea_gga(uint8_t *buff, const sol_t *sol)
 {
     gtime_t time;
-    double h,ep[6],pos[3],dms1[3],dms2[3],dop=1.0;
+    double h,ep[6],pos[3],dop=1.0;
     int solq,refid=0;
-    char *p=(char *)buff,*q,sum;
+    char *p=(char *)buff;
     
     trace(3,"outnmea_gga:\n");
     
     if (sol->stat<=SOLQ_NONE) {
-        p+=sprintf(p,"$%sGGA,,,,,,,,,,,,,,",NMEA_TID);
-        for (q=(char *)buff+1,sum=0;*q;q++) sum^=*q;
-        p+=sprintf(p,"*%02X%c%c",sum,0x0D,0x0A);
+        p=fmtstr(p,"$" NMEA_TID "GGA,,,,,,,,,,,,,,",
+                 (int)strlen("$" NMEA_TID "GGA,,,,,,,,,,,,,,"));
+        p=fmtsum((char *)buff,p);
         return (int)(p-(char *)buff);
     }
     for (solq=0;solq<8;solq++) if (nmea_solq[solq]==sol->stat) break;
@@ -1335,22 +2694,27 @@ extern int outnmea_gga(uint8_t *buff, const sol_t *sol)
     time2epoch(time,ep);
     ecef2pos(sol->rr,pos);
     h=geoidh(pos);
-    deg2dms(fabs(pos[0])*R2D,dms1,7);
-    deg2dms(fabs(pos[1])*R2D,dms2,7);
-    p+=sprintf(p,"$%sGGA,%02.0f%02.0f%05.2f,%02.0f%010.7f,%s,%03.0f%010.7f,%s,"
-               "%d,%02d,%.1f,%.3f,M,%.3f,M,%.1f,%04d",
-               NMEA_TID,ep[3],ep[4],ep[5],dms1[0],dms1[1]+dms1[2]/60.0,
-               pos[0]>=0?"N":"S",dms2[0],dms2[1]+dms2[2]/60.0,pos[1]>=0?"E":"W",
-               solq,sol->ns,dop,pos[2]-h,h,sol->age,refid);
-    for (q=(char *)buff+1,sum=0;*q;q++) sum^=*q; /* check-sum */
-    p+=sprintf(p,"*%02X\r\n",sum);
+    p=fmtstr(p,"$" NMEA_TID "GGA,",(int)strlen("$" NMEA_TID "GGA,"));
+    p=fmtnmeatime(p,ep);
+    *p++=',';
+    p=fmtnmeapos(p,pos);
+    p=fmtint(p,solq,0,0); *p++=',';
+    p=fmtint(p,sol->ns,2,1); *p++=',';
+    p=fmtfix(p,dop,0,1,0); *p++=',';
+    p=fmtfix(p,pos[2]-h,0,3,0);
+    p=fmtstr(p,",M,",3);
+    p=fmtfix(p,h,0,3,0);
+    p=fmtstr(p,",M,",3);
+    p=fmtfix(p,sol->age,0,1,0); *p++=',';
+    p=fmtint(p,refid,4,1);
+    p=fmtsum((char *)buff,p);
     return (int)(p-(char *)buff);
 }
 /* output solution in the form of NMEA GSA sentences -------------------------*/
 extern int outnmea_gsa(uint8_t *buff, const sol_t *sol, const ssat_t *ssat)
 {
     double azel[MAXSAT*2],dop[4];
-    char *p=(char *)buff,*q,*s,sum;
+    char *p=(char *)buff,*s;
     int i,j,sys,prn,nsat,mask=0,nsys=0,sats[MAXSAT];
     
     trace(3,"outnmea_gsa:\n");
@@ -1363,29 +2727,36 @@ extern int outnmea_gsa(uint8_t *buff, const sol_t *sol, const ssat_t *ssat)
         azel[2*nsat  ]=ssat[i].azel[0];
         azel[2*nsat+1]=ssat[i].azel[1];
         sats[nsat++]=i+1;
-        }
-        dops(nsat,azel,0.0,dop);
+    }
+    dops(nsat,azel,0.0,dop);
     
     for (i=0;nmea_sys[i];i++) {
         for (j=nsat=0;j<MAXSAT&&nsat<12;j++) {
             if (!(satsys(j+1,NULL)&nmea_sys[i])) continue;
             if (ssat[j].vs) sats[nsat++]=j+1;
-    }
-    if (nsat>0) {
-        s=p;
-            p+=sprintf(p,"$%sGSA,A,%d",nsys>1?"GN":nmea_tid[i],sol->stat?3:1);
+        }
+        if (nsat>0) {
+            s=p;
+            *p++='$';
+            p=fmtstr(p,nsys>1?"GN":nmea_tid[i],2);
+            p=fmtstr(p,"GSA,A,",6);
+            p=fmtint(p,sol->stat?3:1,0,0);
             for (j=0;j<12;j++) {
+                *p++=',';
+                if (j>=nsat) continue;
                 sys=satsys(sats[j],&prn);
                 if      (sys==SYS_SBS) prn-=87;  /* SBS: 33-64 */
                 else if (sys==SYS_GLO) prn+=64;  /* GLO: 65-99 */
                 else if (sys==SYS_QZS) prn-=192; /* QZS: 01-10 */
-                if (j<nsat) p+=sprintf(p,",%02d",prn);
-            else        p+=sprintf(p,",");
-        }
-            p+=sprintf(p,",%3.1f,%3.1f,%3.1f,%d",dop[1],dop[2],dop[3],
-                       nmea_sid[i]);
-        for (q=s+1,sum=0;*q;q++) sum^=*q; /* check-sum */
-            p+=sprintf(p,"*%02X\r\n",sum);
+                p=fmtint(p,prn,2,1);
+            }
+            for (j=1;j<4;j++) {
+                *p++=',';
+                p=fmtfix(p,dop[j],3,1,0);
+            }
+            *p++=',';
+            p=fmtint(p,nmea_sid[i],0,0);
+            p=fmtsum(s,p);
         }
     }
     return (int)(p-(char *)buff);
@@ -1395,7 +2766,7 @@ extern int outnmea_gsv(uint8_t *buff, const sol_t *sol, const ssat_t *ssat)
 {
     double az,el,snr;
     int i,j,k,n,nsat,nmsg,prn,sys,sats[MAXSAT];
-    char *p=(char *)buff,*q,*s,sum;
+    char *p=(char *)buff,*s;
     
     trace(3,"outnmea_gsv:\n");
     
@@ -1403,12 +2774,17 @@ extern int outnmea_gsv(uint8_t *buff, const sol_t *sol, const ssat_t *ssat)
         for (j=nsat=0;j<MAXSAT&&nsat<36;j++) {
             if (!(satsys(j+1,NULL)&nmea_sys[i])) continue;
             if (ssat[j].azel[1]>0.0) sats[nsat++]=j+1;
-    }
+        }
         nmsg=(nsat+3)/4;
-    
+        
         for (j=n=0;j<nmsg;j++) {
-        s=p;
-            p+=sprintf(p,"$%sGSV,%d,%d,%02d",nmea_tid[i],nmsg,j+1,nsat);
+            s=p;
+            *p++='$';
+            p=fmtstr(p,nmea_tid[i],2);
+            p=fmtstr(p,"GSV,",4);
+            p=fmtint(p,nmsg,0,0); *p++=',';
+            p=fmtint(p,j+1,0,0); *p++=',';
+            p=fmtint(p,nsat,2,1);
             for (k=0;k<4;k++,n++) {
                 if (n<nsat) {
                     sys=satsys(sats[n],&prn);
@@ -1418,13 +2794,15 @@ extern int outnmea_gsv(uint8_t *buff, const sol_t *sol, const ssat_t *ssat)
                     az =ssat[sats[n]-1].azel[0]*R2D; if (az<0.0) az+=360.0;
                     el =ssat[sats[n]-1].azel[1]*R2D;
                     snr=ssat[sats[n]-1].snr_rover[0]*SNR_UNIT;
-                p+=sprintf(p,",%02d,%02.0f,%03.0f,%02.0f",prn,el,az,snr);
+                    *p++=','; p=fmtint(p,prn,2,1);
+                    *p++=','; p=fmtfix(p,el,2,0,1);
+                    *p++=','; p=fmtfix(p,az,3,0,1);
+                    *p++=','; p=fmtfix(p,snr,2,0,1);
+                }
+                else p=fmtstr(p,",,,,",4);
             }
-            else p+=sprintf(p,",,,,");
-        }
-            p+=sprintf(p,",0"); /* all signals */
-        for (q=s+1,sum=0;*q;q++) sum^=*q; /* check-sum */
-            p+=sprintf(p,"*%02X\r\n",sum);
+            p=fmtstr(p,",0",2); /* all signals */
+            p=fmtsum(s,p);
         }
     }
     return (int)(p-(char *)buff);
@@ -1519,11 +2897,59 @@ extern int outprcopts(uint8_t *buff, const prcopt_t *opt)
     }
     return (int)(p-(char *)buff);
 }
+/* output binary solution header --------------------------------------------*/
+static int outsolbinh(uint8_t *buff, const solopt_t *opt)
+{
+    solbinh_t h;
+    
+    memset(&h,0,sizeof(h));
+    memcpy(h.magic,SOLBIN_MAGIC,sizeof(h.magic));
+    h.ver  =SOLBIN_VER;
+    h.hsize=(uint16_t)sizeof(solbinh_t);
+    h.rsize=(uint16_t)(sizeof(solbin_t)+(opt->outvel?sizeof(solbinv_t):0));
+    h.order=SOLBIN_ORDER;
+    h.flags=opt->outvel?SOLBIN_VEL:0;
+    memcpy(buff,&h,sizeof(h));
+    return (int)sizeof(h);
+}
+/* output binary solution record ---------------------------------------------*/
+static int outsolbin(uint8_t *buff, const sol_t *sol, const solopt_t *opt)
+{
+    solbin_t rec;
+    solbinv_t vel;
+    double nsec;
+    int i;
+    
+    memset(&rec,0,sizeof(rec));
+    rec.time=(int64_t)sol->time.time;
+    if ((nsec=floor(sol->time.sec*1E9+0.5))>=1E9) {
+        rec.time++;
+        nsec-=1E9;
+    }
+    rec.nsec=(uint32_t)nsec;
+    for (i=0;i<3;i++) rec.rr[i]=sol->rr[i];
+    for (i=0;i<6;i++) rec.qr[i]=sol->qr[i];
+    rec.age  =sol->age;
+    rec.ratio=sol->ratio;
+    rec.type =sol->type;
+    rec.stat =sol->stat;
+    rec.ns   =sol->ns;
+    memcpy(buff,&rec,sizeof(rec));
+    
+    if (!opt->outvel) return (int)sizeof(rec);
+    
+    for (i=0;i<3;i++) vel.rv[i]=sol->rr[i+3];
+    for (i=0;i<6;i++) vel.qv[i]=sol->qv[i];
+    memcpy(buff+sizeof(rec),&vel,sizeof(vel));
+    return (int)(sizeof(rec)+sizeof(vel));
+}
 /* output solution header ------------------------------------------------------
 * output solution header to buffer
 * args   : uint8_t *buff    IO  output buffer
 *          solopt_t *opt    I   solution options
 * return : number of output bytes
+* notes  : the binary header (solbinh_t) of SOLF_BIN is output regardless of
+*          opt->outhead as the records can not be read without it.
 *-----------------------------------------------------------------------------*/
 extern int outsolheads(uint8_t *buff, const solopt_t *opt)
 {
@@ -1539,6 +2965,9 @@ extern int outsolheads(uint8_t *buff, const solopt_t *opt)
     if (opt->posf==SOLF_NMEA||opt->posf==SOLF_STAT||opt->posf==SOLF_GSIF) {
         return 0;
     }
+    if (opt->posf==SOLF_BIN) { /* binary header is always output */
+        return outsolbinh(buff,opt);
+    }
     if (opt->outhead) {
         p+=sprintf(p,"%s (",COMMENTH);
         if      (opt->posf==SOLF_XYZ) p+=sprintf(p,"x/y/z-ecef=WGS84");
@@ -1616,16 +3045,18 @@ static double sol_std(const sol_t *sol)
 *          double *rb       I   base station position {x,y,z} (ecef) (m)
 *          solopt_t *opt    I   solution options
 * return : number of output bytes
+* notes  : SOLF_BIN outputs a fixed-size record (solbin_t followed by solbinv_t
+*          if opt->outvel) in host byte order. time is always GPST and the
+*          position is not converted, so the format options are not applied.
 *-----------------------------------------------------------------------------*/
 extern int outsols(uint8_t *buff, const sol_t *sol, const double *rb,
                    const solopt_t *opt)
 {
+    solfmt_t fmt;
     gtime_t time,ts={0};
     double gpst;
-    int week,timeu;
-    const char *sep=opt2sep(opt);
-    char s[64];
-    uint8_t *p=buff;
+    int week;
+    char *p=(char *)buff;
     
     trace(3,"outsols :\n");
     
@@ -1640,29 +3071,43 @@ extern int outsols(uint8_t *buff, const sol_t *sol, const double *rb,
     if (sol->stat<=SOLQ_NONE||(opt->posf==SOLF_ENU&&norm(rb,3)<=0.0)) {
         return 0;
     }
-    timeu=opt->timeu<0?0:(opt->timeu>20?20:opt->timeu);
+    if (opt->posf==SOLF_BIN) {
+        return outsolbin(buff,sol,opt);
+    }
+    if (opt->posf!=SOLF_LLH&&opt->posf!=SOLF_XYZ&&opt->posf!=SOLF_ENU&&
+        opt->posf!=SOLF_NMEA) {
+        return 0;
+    }
+    /* resolve output format */
+    fmt.sep=opt2sep(opt);
+    fmt.nsep=(int)strlen(fmt.sep);
+    fmt.timeu=opt->timeu<0?0:(opt->timeu>20?20:opt->timeu);
     
     time=sol->time;
     if (opt->times>=TIMES_UTC) time=gpst2utc(time);
     if (opt->times==TIMES_JST) time=timeadd(time,9*3600.0);
     
-    if (opt->timef) time2str(time,s,timeu);
-    else {
-        gpst=time2gpst(time,&week);
-        if (86400*7-gpst<0.5/pow(10.0,timeu)) {
-            week++;
-            gpst=0.0;
+    if (opt->posf!=SOLF_NMEA) {
+        if (opt->timef) p=fmttime(p,time,fmt.timeu);
+        else {
+            gpst=time2gpst(time,&week);
+            if (86400*7-gpst<0.5/pow(10.0,fmt.timeu)) {
+                week++;
+                gpst=0.0;
+            }
+            p=fmtint(p,week,4,0);
+            p=fmtstr(p,fmt.sep,fmt.nsep<16?fmt.nsep:16);
+            p=fmtfix(p,gpst,6+(fmt.timeu<=0?0:fmt.timeu+1),fmt.timeu,0);
         }
-        sprintf(s,"%4d%.16s%*.*f",week,sep,6+(timeu<=0?0:timeu+1),timeu,gpst);
     }
     switch (opt->posf) {
-        case SOLF_LLH:  p+=outpos (p,s,sol,opt);   break;
-        case SOLF_XYZ:  p+=outecef(p,s,sol,opt);   break;
-        case SOLF_ENU:  p+=outenu(p,s,sol,rb,opt); break;
-        case SOLF_NMEA: p+=outnmea_rmc(p,sol);
-                        p+=outnmea_gga(p,sol); break;
+        case SOLF_LLH:  p+=outpos ((uint8_t *)p,sol,opt,&fmt); break;
+        case SOLF_XYZ:  p+=outecef((uint8_t *)p,sol,opt,&fmt); break;
+        case SOLF_ENU:  p+=outenu ((uint8_t *)p,sol,rb,&fmt);  break;
+        case SOLF_NMEA: p+=outnmea_rmc((uint8_t *)p,sol);
+                        p+=outnmea_gga((uint8_t *)p,sol); break;
     }
-    return (int)(p-buff);
+    return (int)(p-(char *)buff);
 }
 /* output solution extended ----------------------------------------------------
 * output solution exteneded infomation
@@ -1770,3 +3215,72 @@ extern void outsolex(FILE *fp, const sol_t *sol, const ssat_t *ssat,
         fwrite(buff,n,1,fp);
     }
 }
+/* convert solution file -------------------------------------------------------
+* convert solution file format (e.g. binary solution to text)
+* args   : char   *infile   I   input solution file (wild-card * expanded)
+*          char   *outfile  I   output file ("": infile + .pos or .bin)
+*          gtime_t ts,te    I   start/end time (ts.time,te.time==0: all)
+*          double tint      I   time interval (s) (0: all)
+*          int    qflg      I   quality flag (0: all)
+*          solopt_t *opt    I   output solution options
+* return : status (0:ok,-1:file read,-3:no input data,-4:file write)
+* notes  : the reference position in the input file header is used for
+*          e/n/u-baseline output.
+*-----------------------------------------------------------------------------*/
+extern int convsol(const char *infile, const char *outfile, gtime_t ts,
+                   gtime_t te, double tint, int qflg, const solopt_t *opt)
+{
+    FILE *fp;
+    solbuf_t solbuf={0};
+    char *p,file[1024],*files[MAXEXFILE]={0};
+    const char *ext=opt->posf==SOLF_BIN?".bin":".pos";
+    int i,nfile,stat,over=0;
+    
+    trace(3,"convsol : infile=%s outfile=%s\n",infile,outfile);
+    
+    /* expand wild-card of infile */
+    for (i=0;i<MAXEXFILE;i++) {
+        if (!(files[i]=(char *)malloc(1024))) {
+            for (i--;i>=0;i--) free(files[i]);
+            return -4;
+        }
+    }
+    if ((nfile=expath(infile,files,MAXEXFILE))<=0) {
+        for (i=0;i<MAXEXFILE;i++) free(files[i]);
+        return -3;
+    }
+    if (!*outfile) {
+        if ((p=strrchr(infile,'.'))) {
+            strncpy(file,infile,p-infile);
+            strcpy(file+(p-infile),ext);
+        }
+        else sprintf(file,"%s%s",infile,ext);
+    }
+    else strcpy(file,outfile);
+    
+    /* read solution file */
+    stat=readsolt(files,nfile,ts,te,tint,qflg,&solbuf);
+    
+    for (i=0;i<nfile;i++) {
+        if (!strcmp(files[i],file)) over=1;
+    }
+    for (i=0;i<MAXEXFILE;i++) free(files[i]);
+    
+    if (!stat) {
+        return -1;
+    }
+    /* write solution file (not to overwrite input file) */
+    if (over||!(fp=fopen(file,"wb"))) {
+        freesolbuf(&solbuf);
+        return -4;
+    }
+    outsolhead(fp,opt);
+    
+    for (i=0;i<solbuf.n;i++) {
+        outsol(fp,solbuf.data+i,solbuf.rb,opt);
+    }
+    stat=ferror(fp);
+    fclose(fp);
+    freesolbuf(&solbuf);
+    return stat?-4:0;
+}
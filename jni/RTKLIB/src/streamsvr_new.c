@@ -111,6 +111,8 @@ extern strconv_t *strconvnew(int itype, int otype, const char *msgs, int staid,
     if (stasel) conv->out.staid=staid;
     sprintf(conv->rtcm.opt,"-EPHALL %s",opt);
     sprintf(conv->raw.opt ,"-EPHALL %s",opt);
+    compopt(conv->rtcm.opt,&conv->rtcm.copt);
+    compopt(conv->raw.opt ,&conv->raw.copt);
     return conv;
 }
 /* free stream converter -------------------------------------------------------
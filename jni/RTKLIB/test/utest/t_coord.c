@@ -85,10 +85,94 @@ void utest3(void)
 
     printf("%s utset3 : OK\n",__FILE__);
 }
+/* ecef2pos_batch(),pos2ecef_batch(),ecef2enu_batch(),covenu_batch() */
+#define NBATCH  100000
+void utest4(void)
+{
+    double *x,*y,*z,*lat,*lon,*h,*P,*Q,r[3],pos[3],e[3],P1[9],Q1[9];
+    double qr[6],dlat=0.0,dh=0.0;
+    int i,j,k,n=NBATCH,idx[]={0,4,8,1,5,2};
+    uint32_t tick;
+    
+    x=mat(n,18); y=x+n; z=y+n; lat=z+n; lon=lat+n; h=lon+n; P=h+n; Q=P+6*n;
+    
+    /* terrestrial and orbital positions including poles */
+    srand(0);
+    for (i=0;i<n;i++) {
+        pos[0]=(i%1000==0?(i%2000?-90.0:90.0):rand()*180.0/RAND_MAX-90.0)*D2R;
+        pos[1]=(rand()*360.0/RAND_MAX-180.0)*D2R;
+        pos[2]=i%10==0?rand()*4E7/RAND_MAX:rand()*1E4/RAND_MAX-500.0;
+        pos2ecef(pos,r);
+        x[i]=r[0]; y[i]=r[1]; z[i]=r[2];
+        for (j=0;j<6;j++) P[j*n+i]=(j<3?1.0:0.1)*rand()/RAND_MAX;
+    }
+    x[1]=y[1]=z[1]=0.0; /* origin */
+    ecef2pos_batch(x,y,z,n,lat,lon,h);
+        assert(h[1]==-RE_WGS84&&lat[1]==-PI/2.0);
+    for (i=0;i<n;i++) {
+        r[0]=x[i]; r[1]=y[i]; r[2]=z[i];
+        ecef2pos(r,pos);
+        assert(lon[i]==pos[1]);
+        if (fabs(lat[i]-pos[0])>dlat) dlat=fabs(lat[i]-pos[0]);
+        if (fabs(h  [i]-pos[2])>dh  ) dh  =fabs(h  [i]-pos[2]);
+    }
+        assert(dlat<1E-12&&dh<1E-6);
+    
+    pos2ecef_batch(lat,lon,h,n,Q,Q+n,Q+2*n);
+    for (i=0;i<n;i++) {
+        pos[0]=lat[i]; pos[1]=lon[i]; pos[2]=h[i];
+        pos2ecef(pos,r);
+        assert(Q[i]==r[0]&&Q[n+i]==r[1]&&Q[2*n+i]==r[2]);
+    }
+    ecef2enu_batch(lat,lon,P,P+n,P+2*n,n,Q,Q+n,Q+2*n);
+    for (i=0;i<n;i++) {
+        pos[0]=lat[i]; pos[1]=lon[i];
+        r[0]=P[i]; r[1]=P[n+i]; r[2]=P[2*n+i];
+        ecef2enu(pos,r,e);
+        assert(Q[i]==e[0]&&Q[n+i]==e[1]&&Q[2*n+i]==e[2]);
+    }
+    covenu_batch(lat,lon,P,n,Q);
+    for (i=0;i<n;i++) {
+        pos[0]=lat[i]; pos[1]=lon[i];
+        for (j=0;j<6;j++) qr[j]=P[j*n+i];
+        P1[0]=qr[0]; P1[4]=qr[1]; P1[8]=qr[2];
+        P1[1]=P1[3]=qr[3]; P1[5]=P1[7]=qr[4]; P1[2]=P1[6]=qr[5];
+        covenu(pos,P1,Q1);
+        for (j=0;j<6;j++) assert(Q[j*n+i]==Q1[idx[j]]);
+    }
+    /* execution time */
+    tick=tickget();
+    for (k=0;k<10;k++) for (i=0;i<n;i++) {
+        r[0]=x[i]; r[1]=y[i]; r[2]=z[i];
+        ecef2pos(r,pos);
+        lat[i]=pos[0]; lon[i]=pos[1]; h[i]=pos[2];
+    }
+    printf("ecef2pos      : %.3f us/point\n",(tickget()-tick)*1E3/(10.0*n));
+    tick=tickget();
+    for (k=0;k<10;k++) ecef2pos_batch(x,y,z,n,lat,lon,h);
+    printf("ecef2pos_batch: %.3f us/point\n",(tickget()-tick)*1E3/(10.0*n));
+    tick=tickget();
+    for (k=0;k<10;k++) for (i=0;i<n;i++) {
+        pos[0]=lat[i]; pos[1]=lon[i];
+        for (j=0;j<6;j++) qr[j]=P[j*n+i];
+        P1[0]=qr[0]; P1[4]=qr[1]; P1[8]=qr[2];
+        P1[1]=P1[3]=qr[3]; P1[5]=P1[7]=qr[4]; P1[2]=P1[6]=qr[5];
+        covenu(pos,P1,Q1);
+        for (j=0;j<6;j++) Q[j*n+i]=Q1[idx[j]];
+    }
+    printf("covenu        : %.3f us/point\n",(tickget()-tick)*1E3/(10.0*n));
+    tick=tickget();
+    for (k=0;k<10;k++) covenu_batch(lat,lon,P,n,Q);
+    printf("covenu_batch  : %.3f us/point\n",(tickget()-tick)*1E3/(10.0*n));
+    free(x);
+    
+    printf("%s utset4 : OK\n",__FILE__);
+}
 int main(void)
 {
     utest1();
     utest2();
     utest3();
+    utest4();
     return 0;
 }
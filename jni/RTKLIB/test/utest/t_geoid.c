@@ -2,6 +2,7 @@
 * rtklib unit test driver : geoid functions
 *-----------------------------------------------------------------------------*/
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <assert.h>
 #include "../../src/rtklib.h"
@@ -38,6 +39,9 @@ static char *file1=DATADIR "WW15MGH.DAC";
 static char *file2=DATADIR "Und_min1x1_egm2008_isw=82_WGS84_TideFree_SE";
 static char *file3=DATADIR "Und_min2.5x2.5_egm2008_isw=82_WGS84_TideFree_SE";
 static char *file4=DATADIR "gsigeome.ver4";
+static char *file5="utest_geoid.dac"; /* synthetic egm96 15x15" grid */
+
+#define NPOS    1000000         /* number of positions of benchmark */
 
 /* opengeoid(), closegeoid() */
 void utest1(void)
@@ -163,10 +167,170 @@ void utest3(void)
     printf("\n");
     printf("%s utset3 : OK\n",__FILE__);
 }
+/* generate synthetic egm96 15x15" grid file */
+static void genegm96(const char *file)
+{
+    FILE *fp;
+    uint8_t buff[2];
+    int i,j,v;
+    
+    fp=fopen(file,"wb");
+        assert(fp);
+    for (j=0;j<721;j++) for (i=0;i<1440;i++) {
+        v=(int)(8000.0*sin(i*0.013)*cos(j*0.021)+(i*j)%997);
+        buff[0]=(uint8_t)((v>>8)&0xFF);
+        buff[1]=(uint8_t)(v&0xFF);
+        fwrite(buff,2,1,fp);
+    }
+    fclose(fp);
+}
+/* reference: egm96 geoid height by file access per grid value */
+static int16_t fget2b_ref(FILE *fp, long off)
+{
+    uint8_t v[2]={0x00};
+    if (fseek(fp,off,SEEK_SET)==EOF||fread(v,2,1,fp)<1) return 0;
+    return ((int16_t)v[0]<<8)+v[1];
+}
+static double geoidh_ref(FILE *fp, const double *pos)
+{
+    const double lon0=0.0,lat0=90.0,dlon=15.0/60.0,dlat=-15.0/60.0;
+    const int nlon=1440,nlat=721;
+    double posd[2],a,b,y[4],h;
+    int i1,i2,j1,j2;
+    
+    posd[1]=pos[1]*R2D; posd[0]=pos[0]*R2D; if (posd[1]<0.0) posd[1]+=360.0;
+    if (posd[1]<0.0||360.0-1E-12<posd[1]||posd[0]<-90.0||90.0<posd[0]) {
+        return 0.0;
+    }
+    a=(posd[1]-lon0)/dlon;
+    b=(posd[0]-lat0)/dlat;
+    i1=(int)a; a-=i1; i2=i1<nlon-1?i1+1:0;
+    j1=(int)b; b-=j1; j2=j1<nlat-1?j1+1:j1;
+    y[0]=fget2b_ref(fp,2L*(i1+j1*nlon))*0.01;
+    y[1]=fget2b_ref(fp,2L*(i2+j1*nlon))*0.01;
+    y[2]=fget2b_ref(fp,2L*(i1+j2*nlon))*0.01;
+    y[3]=fget2b_ref(fp,2L*(i2+j2*nlon))*0.01;
+    h=y[0]*(1.0-a)*(1.0-b)+y[1]*a*(1.0-b)+y[2]*(1.0-a)*b+y[3]*a*b;
+    return fabs(h)>200.0?0.0:h;
+}
+/* random positions clustered in tiles of 0.1x0.1 deg */
+static void genpos(double *pos, int n)
+{
+    double lat=0.0,lon=0.0;
+    int i;
+    
+    srand(4321);
+    for (i=0;i<n;i++) {
+        if (i%1000==0) {
+            lat=rand()/(double)RAND_MAX*179.8-89.9;
+            lon=rand()/(double)RAND_MAX*359.8-179.9;
+        }
+        pos[i*2  ]=(lat+rand()/(double)RAND_MAX*0.1)*D2R;
+        pos[i*2+1]=(lon+rand()/(double)RAND_MAX*0.1)*D2R;
+    }
+}
+/* geoidh_batch(), geoidh_ctx() versus file access */
+void utest4(void)
+{
+    geoid_t gm={0};
+    FILE *fp;
+    double *pos,*h1,*h2,h;
+    int i,n=100000,ret;
+    
+    genegm96(file5);
+    pos=mat(2,n); h1=mat(1,n); h2=mat(1,n);
+        assert(pos&&h1&&h2);
+    genpos(pos,n);
+    pos[0]=90.0*D2R; pos[1]=359.999*D2R; /* edges */
+    pos[2]=-90.0*D2R; pos[3]=-180.0*D2R;
+    pos[4]=91.0*D2R; pos[5]=0.0;
+    
+    fp=fopen(file5,"rb");
+        assert(fp);
+    for (i=0;i<n;i++) h1[i]=geoidh_ref(fp,pos+i*2);
+    fclose(fp);
+    
+    ret=opengeoid(GEOID_EGM96_M150,file5);
+        assert(ret==1);
+    geoidh_batch(pos,n,h2);
+    for (i=0;i<n;i++) {
+        assert(h1[i]==h2[i]);
+        h=geoidh(pos+i*2);
+        assert(h==h1[i]);
+    }
+    closegeoid();
+    
+    ret=opengeoid_ctx(&gm,GEOID_EGM96_M150,file5);
+        assert(ret==1&&gm.data!=NULL);
+    geoidh_batch_ctx(&gm,pos,n,h2);
+    for (i=0;i<n;i++) {
+        assert(h1[i]==h2[i]);
+        h=geoidh_ctx(&gm,pos+i*2);
+        assert(h==h1[i]);
+    }
+    closegeoid_ctx(&gm);
+    
+    /* embedded model */
+    ret=opengeoid_ctx(&gm,GEOID_EMBEDDED,"");
+        assert(ret==1);
+    geoidh_batch_ctx(&gm,pos,n,h2);
+    for (i=0;i<n;i++) {
+        assert(h2[i]==geoidh(pos+i*2));
+    }
+    closegeoid_ctx(&gm);
+    ret=opengeoid_ctx(&gm,GEOID_EGM96_M150,"utest_geoid.xxx");
+        assert(ret==0);
+    
+    free(pos); free(h1); free(h2);
+    printf("%s utset4 : OK\n",__FILE__);
+}
+/* geoidh_batch() throughput */
+void utest5(void)
+{
+    geoid_t gm={0};
+    FILE *fp;
+    double *pos,*h,t,t1=1E9,t2=1E9,t3=1E9;
+    int i,k,n=NPOS/10;
+    
+    pos=mat(2,NPOS); h=mat(1,NPOS);
+        assert(pos&&h);
+    genpos(pos,NPOS);
+    
+    /* best of runs (us/position) */
+    for (k=0;k<3;k++) {
+        fp=fopen(file5,"rb");
+            assert(fp);
+        t=prftick();
+        for (i=0;i<n;i++) h[i]=geoidh_ref(fp,pos+i*2);
+        t=(prftick()-t)/n; if (t<t1) t1=t;
+        fclose(fp);
+    }
+    opengeoid_ctx(&gm,GEOID_EGM96_M150,file5);
+    for (k=0;k<5;k++) {
+        t=prftick();
+        for (i=0;i<NPOS;i++) h[i]=geoidh_ctx(&gm,pos+i*2);
+        t=(prftick()-t)/NPOS; if (t<t2) t2=t;
+    }
+    for (k=0;k<5;k++) {
+        t=prftick();
+        geoidh_batch_ctx(&gm,pos,NPOS,h);
+        t=(prftick()-t)/NPOS; if (t<t3) t3=t;
+    }
+    closegeoid_ctx(&gm);
+    
+    printf("geoid height: file=%.4fus mapped=%.4fus batch=%.4fus (x%.0f)\n",
+           t1,t2,t3,t3>0.0?t1/t3:0.0);
+    
+    free(pos); free(h);
+    remove(file5);
+    printf("%s utset5 : OK\n",__FILE__);
+}
 int main(void)
 {
     utest1();
     utest2();
     utest3();
+    utest4();
+    utest5();
     return 0;
 }
@@ -5,6 +5,8 @@
 #include <assert.h>
 #include "../../src/rtklib.h"
 
+#define NSAT    12              /* number of satellites of benchmark */
+
 static void dumptec(const tec_t *tec, int n, int level)
 {
     const tec_t *p;
@@ -223,11 +225,70 @@ void utest4(void)
     
     printf("%s utest4 : OK\n",__FILE__);
 }
+/* iontec_sats() versus iontec() and benchmark */
+void utest5(void)
+{
+    char *file3="../data/sp3/igrg33*0.10i";
+    nav_t nav={0};
+    gtime_t time0,time;
+    double ep1[]={2010,12, 4, 0, 0, 0};
+    double pos[3]={36.1*D2R,140.1*D2R,67.0},azel[NSAT*2];
+    double delay1[NSAT],var1[NSAT],delay2[NSAT],var2[NSAT];
+    double t1=0.0,t2=0.0,t3=0.0;
+    uint32_t tick;
+    int j,k,n=0,nep=2880*2,stat1[NSAT],stat2[NSAT];
+    
+    time0=epoch2time(ep1);
+    readtec(file3,&nav,0);
+        assert(nav.nt==25);
+    
+    for (k=0;k<nep;k++) {
+        time=timeadd(time0,k*30.0);
+        for (j=0;j<NSAT;j++) {
+            azel[  j*2]=fmod(j*30.0+k*0.01,360.0)*D2R;
+            azel[1+j*2]=(j*8.0-5.0+fmod(k*0.02,10.0))*D2R;
+        }
+        /* monotonic time per satellite */
+        tick=tickget();
+        for (j=0;j<NSAT;j++) {
+            stat1[j]=iontec(time,&nav,pos,azel+j*2,1,delay1+j,var1+j);
+        }
+        t1+=tickget()-tick;
+        
+        /* all satellites of epoch */
+        tick=tickget();
+        n+=iontec_sats(time,&nav,pos,azel,NSAT,1,delay2,var2,stat2);
+        t2+=tickget()-tick;
+        
+        for (j=0;j<NSAT;j++) {
+            assert(stat1[j]==stat2[j]);
+            if (!stat1[j]) continue;
+            assert(delay1[j]==delay2[j]&&var1[j]==var2[j]);
+        }
+    }
+        assert(n>nep*NSAT/2);
+    
+    /* random time per satellite */
+    for (k=0;k<nep;k++) {
+        time=timeadd(time0,(k*7919%nep)*30.0);
+        tick=tickget();
+        for (j=0;j<NSAT;j++) {
+            iontec(time,&nav,pos,azel+j*2,1,delay1+j,var1+j);
+        }
+        t3+=tickget()-tick;
+    }
+    printf("iontec      (monotonic): %6.3f us/sat\n",t1*1E3/nep/NSAT);
+    printf("iontec      (random)   : %6.3f us/sat\n",t3*1E3/nep/NSAT);
+    printf("iontec_sats            : %6.3f us/sat\n",t2*1E3/nep/NSAT);
+    
+    printf("%s utest5 : OK\n",__FILE__);
+}
 int main(int argc, char **argv)
 {
     utest1();
     utest2();
     utest3();
     utest4();
+    utest5();
     return 0;
 }
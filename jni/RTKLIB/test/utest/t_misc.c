@@ -182,11 +182,200 @@ void utest4(void)
     
     printf("%s utset4 : OK\n",__FILE__);
 }
+/* compiled options */
+void utest5(void)
+{
+    const char *opts[]={
+        "","-EPHALL -GL1W -RL2C","-GL1L -GL1W -JL1Z -CL2I -STA=123",
+        "-GALINAV -GLOBIAS=1.5 -TADJ=0.5 -GAP_RESION=60 -GL1","-GL 1C -EL1"
+    };
+    const int sys[]={SYS_GPS,SYS_GLO,SYS_GAL,SYS_QZS,SYS_SBS,SYS_CMP,SYS_IRN};
+    copt_t copt,copt2;
+    int i,j,k;
+    
+    compopt(NULL,&copt);
+        assert(copt.flag==0);
+    compopt(opts[1],&copt);
+        assert(copt.flag==COPT_EPHALL);
+        assert(testsigopt(&copt,SYS_GPS,"1W")&&testsigopt(&copt,SYS_GLO,"2C"));
+        assert(!testsigopt(&copt,SYS_GPS,"1L")&&!testsigopt(&copt,SYS_GLO,"1W"));
+    compopt(opts[2],&copt);
+        assert(copt.flag==COPT_STA&&copt.sta==123);
+        assert(testsigopt(&copt,SYS_GPS,"1L")&&testsigopt(&copt,SYS_GPS,"1W"));
+    compopt(opts[3],&copt);
+        assert(copt.flag==(COPT_GALINAV|COPT_GLOBIAS|COPT_TADJ|COPT_GAPION));
+        assert(copt.globias==1.5&&copt.tadj==0.5&&copt.gapion==60);
+    compopt("EPHALL OBSALL ANT_AUX CONVBASE",&copt);
+        assert(copt.flag==(COPT_EPHALL|COPT_OBSALL|COPT_ANT_AUX|COPT_CONVBASE));
+    
+    /* same priorities as option strings */
+    for (i=0;i<5;i++) {
+        compopt(opts[i],&copt);
+        for (j=0;j<7;j++) for (k=1;k<MAXCODE;k++) {
+            assert(getcodepric(sys[j],(uint8_t)k,&copt)==
+                   getcodepri (sys[j],(uint8_t)k,opts[i]));
+        }
+    }
+    /* code priorities of each instance */
+    compopt("",&copt);
+    compopt("",&copt2);
+    setcodepri(&copt,SYS_GPS|SYS_QZS,0,"XC");
+        assert(getcodepric(SYS_GPS,CODE_L1X,&copt )==14);
+        assert(getcodepric(SYS_GPS,CODE_L1C,&copt )==13);
+        assert(getcodepric(SYS_GPS,CODE_L1P,&copt )==0);
+        assert(getcodepric(SYS_QZS,CODE_L1X,&copt )==14);
+        assert(getcodepric(SYS_GPS,CODE_L1C,&copt2)==14);
+        assert(getcodepric(SYS_GPS,CODE_L1X,&copt2)==0);
+        assert(getcodepric(SYS_GPS,CODE_L1C,NULL  )==14);
+        assert(getcodepric(SYS_GAL,CODE_L1X,&copt )==getcodepric(SYS_GAL,CODE_L1X,NULL));
+    setcodepri(&copt,SYS_GPS,0,"");
+        assert(getcodepric(SYS_GPS,CODE_L1C,&copt )==14);
+    printf("%s utset5 : OK\n",__FILE__);
+}
+/* satsys(), code2idx(), code2freq(), sat2freq() */
+void utest6(void)
+{
+    const int sys[]={SYS_GPS,SYS_GLO,SYS_GAL,SYS_QZS,SYS_CMP,SYS_IRN,SYS_SBS};
+    const int minprn[]={MINPRNGPS,MINPRNGLO,MINPRNGAL,MINPRNQZS,MINPRNCMP,
+                        MINPRNIRN,MINPRNSBS};
+    const int maxprn[]={MAXPRNGPS,MAXPRNGLO,MAXPRNGAL,MAXPRNQZS,MAXPRNCMP,
+                        MAXPRNIRN,MAXPRNSBS};
+    const int nsat[]={NSATGPS,NSATGLO,NSATGAL,NSATQZS,NSATCMP,NSATIRN,NSATSBS};
+    geph_t geph[2]={{0}};
+    nav_t nav={0};
+    int i,prn,sat,n=0;
+    
+    /* satellite number to system and prn (enabled systems) */
+    for (i=0;i<7;i++) for (prn=minprn[i];nsat[i]>0&&prn<=maxprn[i];prn++) {
+        sat=satno(sys[i],prn);
+        assert(sat>0&&satsys(sat,NULL)==sys[i]);
+        assert(satsys(sat,&n)==sys[i]&&n==prn);
+    }
+    assert(satsys(0,&prn)==SYS_NONE&&prn==0);
+    assert(satsys(MAXSAT+1,&prn)==SYS_NONE&&prn==0);
+    
+    /* obs code to frequency index and frequency */
+        assert(code2idx(SYS_GPS,CODE_L1C)==0&&code2freq(SYS_GPS,CODE_L1C,0)==FREQL1);
+        assert(code2idx(SYS_GPS,CODE_L5Q)==2&&code2freq(SYS_GPS,CODE_L5Q,0)==FREQL5);
+        assert(code2idx(SYS_GAL,CODE_L7Q)==1&&code2freq(SYS_GAL,CODE_L7Q,0)==FREQE5b);
+        assert(code2idx(SYS_SBS,CODE_L5I)==1&&code2freq(SYS_SBS,CODE_L5I,0)==FREQL5);
+        assert(code2idx(SYS_CMP,CODE_L2I)==0&&code2freq(SYS_CMP,CODE_L2I,0)==FREQ1_CMP);
+        assert(code2idx(SYS_IRN,CODE_L9A)==1&&code2freq(SYS_IRN,CODE_L9A,0)==FREQs);
+        assert(code2idx(SYS_GPS,CODE_L6X)==-1&&code2freq(SYS_GPS,CODE_L6X,0)==0.0);
+        assert(code2idx(SYS_NONE,CODE_L1C)==-1&&code2idx(SYS_GPS,CODE_NONE)==-1);
+        assert(code2freq(SYS_GLO,CODE_L1C,-7)==FREQ1_GLO-7*DFRQ1_GLO);
+        assert(code2freq(SYS_GLO,CODE_L2P,6)==FREQ2_GLO+6*DFRQ2_GLO);
+        assert(code2freq(SYS_GLO,CODE_L1C,7)==0.0);
+    
+    /* GLONASS FCN resolved by ephemeris or FCN table */
+    geph[0].sat=satno(SYS_GLO,3); geph[0].frq=-4;
+    geph[1].sat=satno(SYS_GLO,3); geph[1].frq=5;
+    nav.geph=geph; nav.ng=2;
+    nav.glo_fcn[4]=1+8;
+    sat=satno(SYS_GLO,3);
+        assert(sat2freq(sat,CODE_L1C,&nav)==FREQ1_GLO-4*DFRQ1_GLO);
+    updatefcn(&nav);
+        assert(nav.glo_frq[2]==-4+8&&nav.glo_frq[4]==1+8&&nav.glo_frq[0]==0);
+        assert(sat2freq(sat,CODE_L1C,&nav)==FREQ1_GLO-4*DFRQ1_GLO);
+        assert(sat2freq(satno(SYS_GLO,5),CODE_L2C,&nav)==FREQ2_GLO+DFRQ2_GLO);
+        assert(sat2freq(satno(SYS_GLO,1),CODE_L1C,&nav)==0.0);
+        assert(sat2freq(satno(SYS_GPS,1),CODE_L2W,NULL)==FREQL2);
+    
+    printf("%s utest6 : OK\n",__FILE__);
+}
+/* prfadd(), prfmerge(), prfquant(), prf2str() */
+void utest7(void)
+{
+    prof_t prof={{{0}}},prof2={{{0}}};
+    char buff[(NPRFSTAGE+1)*128];
+    double t0,t1;
+    int i;
+    
+    /* histogram bins of stage time */
+    prfadd(&prof,PRF_FILTER,0.5);
+    prfadd(&prof,PRF_FILTER,3.0);
+    prfadd(&prof,PRF_FILTER,100.0);
+    prfadd(&prof,PRF_FILTER,-1.0);
+    prfadd(&prof,NPRFSTAGE,1.0);
+        assert(prof.stage[PRF_FILTER].n==4&&prof.stage[PRF_FILTER].sum==103.5);
+        assert(prof.stage[PRF_FILTER].max==100.0);
+        assert(prof.stage[PRF_FILTER].hist[0]==2&&prof.stage[PRF_FILTER].hist[2]==1);
+        assert(prof.stage[PRF_FILTER].hist[7]==1);
+    prfadd(&prof,PRF_READ,1E12);
+        assert(prof.stage[PRF_READ].hist[NPRFBIN-1]==1);
+    
+    /* quantiles by histogram */
+    for (i=0;i<100;i++) prfadd(&prof2,PRF_DDRES,i<90?10.0:1000.0);
+        assert(prfquant(&prof2.stage[PRF_DDRES],0.5)==16.0);
+        assert(prfquant(&prof2.stage[PRF_DDRES],0.9)==16.0);
+        assert(prfquant(&prof2.stage[PRF_DDRES],0.99)==1000.0);
+        assert(prfquant(&prof2.stage[PRF_ZDRES],0.5)==0.0);
+    
+    /* merge and summary */
+    prfmerge(&prof2,&prof);
+        assert(prof2.stage[PRF_FILTER].n==4&&prof2.stage[PRF_DDRES].n==100);
+        assert(prof2.stage[PRF_READ].max==1E12);
+        assert(prf2str(&prof2,"# ",buff)==(int)strlen(buff));
+        assert(strstr(buff,"# filter")&&strstr(buff,"# ddres")&&strstr(buff,"# read"));
+        assert(!strstr(buff,"zdres")&&!strstr(buff,"lambda"));
+    
+    /* monotonic tick */
+    t0=prftick(); t1=prftick();
+        assert(t1>=t0&&t0>0.0);
+    
+    printf("%s utset7 : OK\n",__FILE__);
+}
+/* sortobsc() */
+void utest8(void)
+{
+    double ep0[]={2021,1,1,0,0,0};
+    gtime_t t0=epoch2time(ep0);
+    obsc_t obsc={0};
+    obsd_t data[128]={{{0}}};
+    int i,n,stat;
+    
+    /* epochs unsorted by time, merged epochs of more than MAXOBS records */
+    for (i=0;i<5;i++) {
+        data[i].time=timeadd(t0,1.0); data[i].rcv=1; data[i].sat=i+1;
+        data[i].L[0]=1.0;
+    }
+    stat=addobsc(&obsc,data,5);
+        assert(stat==1);
+    for (i=0;i<60;i++) {
+        data[i].time=t0; data[i].rcv=1; data[i].sat=i+61;
+        data[i].L[0]=i+61.0;
+    }
+    stat=addobsc(&obsc,data,60);
+        assert(stat==1);
+    for (i=0;i<61;i++) {
+        data[i].time=t0; data[i].rcv=1; data[i].sat=i+1;
+        data[i].L[0]=i<60?i+1.0:-1.0; /* duplicated sat 61 */
+    }
+    stat=addobsc(&obsc,data,61);
+        assert(stat==1);
+    
+    n=sortobsc(&obsc);
+        assert(n==2&&obsc.ne==2&&obsc.n==125);
+    n=getobsc(&obsc,0,data,128);
+        assert(n==120&&timediff(data[0].time,t0)==0.0);
+    for (i=0;i<n;i++) {
+        assert(data[i].sat==i+1&&data[i].L[0]==i+1.0);
+    }
+    n=getobsc(&obsc,1,data,128);
+        assert(n==5&&timediff(data[0].time,t0)==1.0);
+    freeobsc(&obsc);
+    
+    printf("%s utest8 : OK\n",__FILE__);
+}
 int main(void)
 {
     utest1();
     utest2();
     utest3();
     utest4();
+    utest5();
+    utest6();
+    utest7();
+    utest8();
     return 0;
 }
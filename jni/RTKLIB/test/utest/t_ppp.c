@@ -2,10 +2,22 @@
 * rtklib unit test driver : ppp functions
 *-----------------------------------------------------------------------------*/
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <assert.h>
 #include "../../src/rtklib.h"
 
+#define SQR(x)  ((x)*(x))
+#define DIRSP3  "../data/sp3/"
+#define DIRNAV  "../data/rinex/"
+#define NSTA    3               /* number of stations of convergence benchmark */
+#define NEPOCH  360             /* number of epochs of convergence benchmark */
+#define TINT    30.0            /* epoch interval (s) */
+#define ERR_CODE 0.3            /* code noise std (m) */
+#define ERR_PHASE 0.003         /* phase noise std (m) */
+#define THRES_CM 0.05           /* error threshold of convergence (m) */
+
 /* eci2ecef() */
 void utest1(void)
 {
@@ -60,7 +72,7 @@ void utest3(void)
     double dr[3]={0};
     int i;
     
-    tidedisp(epoch2time(ep1),rr,1,NULL,NULL,dr);
+    tidedisp(epoch2time(ep1),rr,1,NULL,NULL,NULL,dr);
     
     printf("X_disp=%8.5f %8.5f %8.5f\n",dr[0],dp[0],dr[0]-dp[0]);
     printf("Y_disp=%8.5f %8.5f %8.5f\n",dr[1],dp[1],dr[1]-dp[1]);
@@ -71,10 +83,236 @@ void utest3(void)
     }
     printf("%s utset3 : OK\n",__FILE__);
 }
+/* setastro() */
+void utest4(void)
+{
+    double ep1[]={2010,6,7,1,2,3};
+    double rr[]={-3957198.431,3310198.621,3737713.474}; /* TSKB */
+    double rsun[3],rmoon[3],gmst,U[9],erpv[5]={0},dr1[3],dr2[3];
+    gtime_t time;
+    astro_t astro;
+    int i;
+    
+    time=epoch2time(ep1);
+    setastro(time,NULL,&astro);
+    
+    sunmoonpos(gpst2utc(time),erpv,rsun,rmoon,&gmst);
+    eci2ecef(gpst2utc(time),erpv,U,NULL);
+        assert(fabs(astro.gmst-gmst)<1E-12);
+    for (i=0;i<3;i++) {
+        assert(fabs(astro.rsun [i]-rsun [i])<1E-3);
+        assert(fabs(astro.rmoon[i]-rmoon[i])<1E-6);
+    }
+    for (i=0;i<9;i++) {
+        assert(astro.U[i]==U[i]);
+    }
+    tidedisp(gpst2utc(time),rr,1,NULL,NULL,NULL  ,dr1);
+    tidedisp(gpst2utc(time),rr,1,NULL,NULL,&astro,dr2);
+    
+    for (i=0;i<3;i++) {
+        assert(fabs(dr1[i]-dr2[i])<1E-9);
+    }
+    printf("%s utset4 : OK\n",__FILE__);
+}
+/* gaussian noise ------------------------------------------------------------*/
+static double gnoise(double std)
+{
+    double u1=(rand()+1.0)/(RAND_MAX+2.0),u2=(rand()+1.0)/(RAND_MAX+2.0);
+    return std*sqrt(-2.0*log(u1))*cos(2.0*PI*u2);
+}
+/* simulate observation data by precise ephemeris ----------------------------*/
+static int simobs(gtime_t time, const double *rr, const nav_t *nav,
+                  const int *N1, const int *N2, obsd_t *obs)
+{
+    const double dtr=1E-4,zwd=0.15,zazel[]={0.0,PI/2.0};
+    double pos[3],rs[6],dts[2],var,e[3],azel[2],r,tau,rho,ion,trp,mh,mw;
+    double lam1=CLIGHT/FREQL1,lam2=CLIGHT/FREQL2,gamma=SQR(FREQL1/FREQL2);
+    int i,sat,n=0;
+    
+    ecef2pos(rr,pos);
+    
+    for (sat=1;sat<=MAXPRNGPS&&n<MAXOBS;sat++) {
+        
+        /* signal transmission time and geometric range */
+        for (i=0,tau=0.07;i<3;i++) {
+            if (!peph2pos(timeadd(time,-dtr-tau),sat,nav,1,NULL,rs,dts,&var)) break;
+            r=geodist(rs,rr,e);
+            tau=r/CLIGHT;
+        }
+        if (i<3||dts[0]==0.0||satazel(pos,e,azel)<10.0*D2R) continue;
+        
+        ion=5.0/sin(azel[1]+0.1);
+        mh=tropmapf(time,pos,azel,&mw);
+        trp=tropmodel(time,pos,zazel,0.0)*mh+zwd*mw;
+        rho=r+CLIGHT*(dtr-dts[0])+trp;
+        
+        memset(obs+n,0,sizeof(obsd_t));
+        obs[n].time=time;
+        obs[n].sat=sat;
+        obs[n].rcv=1;
+        obs[n].code[0]=CODE_L1C;
+        obs[n].code[1]=CODE_L2W;
+        obs[n].SNR[0]=obs[n].SNR[1]=(uint16_t)(45.0/SNR_UNIT);
+        obs[n].P[0]=rho+ion      +gnoise(ERR_CODE);
+        obs[n].P[1]=rho+ion*gamma+gnoise(ERR_CODE);
+        obs[n].L[0]=(rho-ion      +gnoise(ERR_PHASE))/lam1+N1[sat-1];
+        obs[n].L[1]=(rho-ion*gamma+gnoise(ERR_PHASE))/lam2+N2[sat-1];
+        n++;
+    }
+    return n;
+}
+/* ppp convergence of simulated station --------------------------------------*/
+static void convppp(const nav_t *nav, const double *rr, int modear, int seed,
+                    double *ttff, double *ttc)
+{
+    prcopt_t opt=prcopt_default;
+    rtk_t *rtk=(rtk_t *)malloc(sizeof(rtk_t));
+    obsd_t obs[MAXOBS];
+    double ep[]={2010,7,1,0,0,0},dr[3];
+    int i,k,n,N1[MAXSAT],N2[MAXSAT];
+    
+    srand(seed);
+    for (i=0;i<MAXSAT;i++) {
+        N1[i]=rand()%200-100;
+        N2[i]=N1[i]-(rand()%21-10);
+    }
+    opt.mode=PMODE_PPP_STATIC;
+    opt.nf=2;
+    opt.navsys=SYS_GPS;
+    opt.sateph=EPHOPT_PREC;
+    opt.ionoopt=IONOOPT_IFLC;
+    opt.tropopt=TROPOPT_EST;
+    opt.maxinno=30.0;
+    opt.modear=modear;
+    rtkinit(rtk,&opt);
+    
+    *ttff=*ttc=-1.0;
+    for (k=0;k<NEPOCH;k++) {
+        n=simobs(timeadd(epoch2time(ep),k*TINT),rr,nav,N1,N2,obs);
+        rtkpos(rtk,obs,n,nav);
+        
+        for (i=0;i<3;i++) dr[i]=rtk->sol.rr[i]-rr[i];
+        
+        if (rtk->sol.stat==SOLQ_FIX&&*ttff<0.0) *ttff=k*TINT;
+        if (rtk->sol.stat==SOLQ_NONE||norm(dr,3)>=THRES_CM) *ttc=-1.0;
+        else if (*ttc<0.0) *ttc=k*TINT;
+    }
+    rtkfree(rtk);
+    free(rtk);
+}
+/* ppp ambiguity resolution convergence benchmark
+*  mean time to 5cm depends on enabled systems (NSYS) of the build:
+*    -DENAGLO -DENAQZS (utest makefile, nsys=3): float=33.3min ar=13.3min
+*    + -DENAGAL -DENACMP -DENAIRN (nsys=6)     : float=63.3min ar=17.0min */
+void utest5(void)
+{
+    const double llh[NSTA][3]={
+        {36.1*D2R,140.1*D2R,67.3},{-31.8*D2R,115.9*D2R,40.0},
+        {50.1*D2R,8.7*D2R,150.0}
+    };
+    nav_t nav={0};
+    double rr[3],ttff,ttc0,ttc1,sum0=0.0,sum1=0.0;
+    int i,stat;
+    
+    readsp3(DIRSP3 "igs15904.sp3",&nav,0);
+    stat=readrnxc(DIRSP3 "igs15904.clk",&nav);
+        assert(stat&&nav.ne>0&&nav.nc>0);
+    stat=readrnx(DIRNAV "brdc1820.10n",1,"",NULL,&nav,NULL);
+        assert(stat==1);
+    
+    for (i=0;i<NSTA;i++) {
+        pos2ecef(llh[i],rr);
+        convppp(&nav,rr,ARMODE_OFF ,i+1,&ttff,&ttc0);
+        convppp(&nav,rr,ARMODE_CONT,i+1,&ttff,&ttc1);
+        printf("station %d: float ttc=%6.1fmin  ar ttff=%6.1fmin ttc=%6.1fmin\n",
+               i+1,ttc0/60.0,ttff/60.0,ttc1/60.0);
+            assert(ttff>=0.0&&ttc1>=0.0);
+            assert(ttc0<0.0||ttc1<=ttc0);
+        sum0+=ttc0<0.0?NEPOCH*TINT:ttc0;
+        sum1+=ttc1;
+    }
+    printf("mean time to %.0fcm (nfreq=%d nsys=%d): float=%.1fmin ar=%.1fmin\n",
+           THRES_CM*100.0,NFREQ,NSYS,sum0/NSTA/60.0,sum1/NSTA/60.0);
+    
+    freenav(&nav,0xFF);
+    printf("%s utset5 : OK\n",__FILE__);
+}
+/* tidedisp_cache() versus tidedisp() */
+void utest6(void)
+{
+    const double tint[]={30.0,300.0,600.0},maxerr[]={1E-6,1E-6,1E-5};
+    double ep1[]={2010,6,7,0,0,0};
+    double rr[]={-3957198.431,3310198.621,3737713.474}; /* TSKB */
+    double odisp[6*11]={0},dr0[3],dr1[3],err,errmax;
+    gtime_t time;
+    tidec_t tc={0};
+    int i,j,k,n=2880*2,t0,t1,t2;
+    
+    for (i=0;i<11;i++) { /* synthetic ocean loading parameters */
+        for (j=0;j<3;j++) {
+            odisp[j  +i*6]=0.01/(i+1);
+            odisp[j+3+i*6]=30.0*(i+j);
+        }
+    }
+    for (i=0;i<3;i++) {
+        
+        /* forward and backward (combined solution) */
+        for (k=0,errmax=0.0;k<2*n;k++) {
+            time=epoch2time(ep1);
+            time=timeadd(time,(k<n?k:2*n-1-k)*30.0+7.5);
+            tidedisp(time,rr,7,NULL,odisp,NULL,dr0);
+            tidedisp_cache(&tc,tint[i],time,rr,7,NULL,odisp,dr1);
+            for (j=0;j<3;j++) {
+                err=fabs(dr1[j]-dr0[j]);
+                if (err>errmax) errmax=err;
+            }
+        }
+        printf("tint=%3.0fs max error=%.5fmm\n",tint[i],errmax*1E3);
+            assert(errmax<maxerr[i]);
+    }
+    /* no cache */
+    tidedisp_cache(&tc,0.0,time,rr,7,NULL,odisp,dr1);
+    tidedisp(time,rr,7,NULL,odisp,NULL,dr0);
+        assert(!memcmp(dr0,dr1,sizeof(dr0)));
+    
+    /* no cache for moving site */
+    for (k=0;k<10;k++) {
+        rr[2]+=1000.0;
+        time=timeadd(time,1.0);
+        tidedisp_cache(&tc,300.0,time,rr,7,NULL,odisp,dr1);
+        tidedisp(time,rr,7,NULL,odisp,NULL,dr0);
+            assert(!memcmp(dr0,dr1,sizeof(dr0)));
+    }
+    /* cache at new site after move */
+    time=timeadd(time,1.0);
+    tidedisp_cache(&tc,300.0,time,rr,7,NULL,odisp,dr1);
+    tidedisp(time,rr,7,NULL,odisp,NULL,dr0);
+    for (j=0;j<3;j++) {
+        assert(fabs(dr1[j]-dr0[j])<1E-5);
+    }
+    /* computation time for a day of 1s epochs */
+    time=epoch2time(ep1);
+    t0=(int)tickget();
+    for (k=0;k<86400;k++) {
+        tidedisp(timeadd(time,k),rr,7,NULL,odisp,NULL,dr0);
+    }
+    t1=(int)tickget();
+    for (k=0;k<86400;k++) {
+        tidedisp_cache(&tc,300.0,timeadd(time,k),rr,7,NULL,odisp,dr1);
+    }
+    t2=(int)tickget();
+    printf("time for 86400 epochs: tidedisp=%dms tidedisp_cache=%dms\n",t1-t0,
+           t2-t1);
+    
+    printf("%s utset6 : OK\n",__FILE__);
+}
 int main(void)
 {
     utest1();
     utest2();
     utest3();
+    utest4();
+    utest5();
+    utest6();
     return 0;
 }
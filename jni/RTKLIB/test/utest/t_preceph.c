@@ -132,9 +132,9 @@ void utest4(void)
         assert(nav.ne>0);
     readrnxc(file2,&nav);
         assert(nav.nc>0);
-    stat=peph2pos(time,0,&nav,0,rs,dts,&var);
+    stat=peph2pos(time,0,&nav,0,NULL,rs,dts,&var);
         assert(!stat);
-    stat=peph2pos(time,160,&nav,0,rs,dts,&var);
+    stat=peph2pos(time,160,&nav,0,NULL,rs,dts,&var);
         assert(!stat);
     
     fp=fopen("testpeph1.out","w");
@@ -145,7 +145,7 @@ void utest4(void)
         t=timeadd(time,(double)i);
         for (j=0;j<6;j++) rs [j]=0.0;
         for (j=0;j<2;j++) dts[j]=0.0;
-        peph2pos(t,sat,&nav,0,rs,dts,&var);
+        peph2pos(t,sat,&nav,0,NULL,rs,dts,&var);
         fprintf(fp,"%02d %6d %14.3f %14.3f %14.3f %14.3f %10.3f %10.3f %10.3f %10.3f\n",
                 sat,i,rs[0],rs[1],rs[2],dts[0]*1E9,rs[3],rs[4],rs[5],dts[1]*1E9);
     }
@@ -198,6 +198,64 @@ void utest5(void)
     fclose(fp);
     printf("%s utest4 : OK\n",__FILE__);
 }
+/* fitpeph() */
+void utest6(void)
+{
+    char *file1="../data/sp3/igs1590*.sp3"; /* 2010/7/1 */
+    nav_t nav={0},nav0;
+    int i,j,sat,stat1,stat2,nf;
+    double ep[]={2010,7,1,0,0,0};
+    double rs1[6],dts1[2],rs2[6],dts2[2],var1,var2,dmax=0.0,vmax=0.0;
+    gtime_t t,time;
+    uint32_t tick;
+    
+    time=epoch2time(ep);
+    
+    readsp3(file1,&nav,0);
+        assert(nav.ne==192&&nav.nf==nav.ne-1);
+    nav0=nav;
+    nav0.pfit=NULL; nav0.nf=0; /* no fit */
+    
+    for (i=-600;i<86400*2+600;i+=97) {
+        t=timeadd(time,(double)i);
+        for (sat=1;sat<=MAXSAT;sat++) {
+            stat1=peph2pos(t,sat,&nav ,0,NULL,rs1,dts1,&var1);
+            stat2=peph2pos(t,sat,&nav0,0,NULL,rs2,dts2,&var2);
+                assert(stat1==stat2);
+            if (!stat1) continue;
+                assert(var1==var2);
+                assert(fabs(dts1[0]-dts2[0])<1E-12);
+                assert(dts1[1]==dts2[1]);
+            for (j=0;j<3;j++) {
+                if (fabs(rs1[j]-rs2[j])>dmax) dmax=fabs(rs1[j]-rs2[j]);
+                if (fabs(rs1[j+3]-rs2[j+3])>vmax) vmax=fabs(rs1[j+3]-rs2[j+3]);
+            }
+        }
+    }
+    printf("max diff: pos=%.2e m vel=%.2e m/s\n",dmax,vmax);
+        assert(dmax<2E-4);
+        assert(vmax<1E-3);
+    
+    /* benchmark */
+    tick=tickget();
+    for (i=0;i<86400;i+=30) for (sat=1;sat<=32;sat++) {
+        peph2pos(timeadd(time,(double)i),sat,&nav,0,NULL,rs1,dts1,&var1);
+    }
+    printf("fit          : %5d ms\n",(int)(tickget()-tick));
+    tick=tickget();
+    for (i=0;i<86400;i+=30) for (sat=1;sat<=32;sat++) {
+        peph2pos(timeadd(time,(double)i),sat,&nav0,0,NULL,rs2,dts2,&var2);
+    }
+    printf("interpolation: %5d ms\n",(int)(tickget()-tick));
+    
+    nf=fitpeph(&nav,0.0);
+        assert(nf==0&&nav.nf==0&&!nav.pfit);
+    nf=fitpeph(&nav,1E-6);
+        assert(nf==nav.ne-1);
+    free(nav.peph); free(nav.pfit);
+    
+    printf("%s utest6 : OK\n",__FILE__);
+}
 int main(int argc, char **argv)
 {
     utest1();
@@ -205,5 +263,6 @@ int main(int argc, char **argv)
     utest3();
     utest4();
     utest5();
+    utest6();
     return 0;
 }
@@ -0,0 +1,342 @@
+/*------------------------------------------------------------------------------
+* rtklib unit test driver : sbas functions
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "../../src/rtklib.h"
+
+#define WEEK    1590            /* gps week of messages */
+#define TOW     345600          /* time of week of messages (s) */
+#define NPOS    200000          /* number of pierce points of benchmark */
+#define FILESBS "utest_sbas.sbs"
+
+static nav_t nav;               /* navigation data */
+
+/* generate sbas message header ----------------------------------------------*/
+static void genmsg(sbsmsg_t *msg, int type, int tow)
+{
+    memset(msg,0,sizeof(sbsmsg_t));
+    msg->week=WEEK;
+    msg->tow=tow;
+    msg->prn=129;
+    setbitu(msg->msg,0,8,0x53);
+    setbitu(msg->msg,8,6,type);
+}
+/* vertical delay and give of igp (same for igp in both band 0-8 and 9-10) ---*/
+static int igpdelay(int lat, int lon)
+{
+    return ((lat+90)*7+(lon+180)*3)%400+1;
+}
+static int igpgive(int lat, int lon)
+{
+    return (lat*3+lon+1000)%16; /* 15: not monitored */
+}
+/* set ionospheric corrections of all bands by type 18 and 26 messages -------*/
+static void setion(int tow, int seed)
+{
+    sbsmsg_t msg;
+    const sbsion_t *ion;
+    int i,j,band,block,iodi=seed&3;
+    
+    for (band=0;band<=MAXBAND;band++) {
+        genmsg(&msg,18,tow);
+        setbitu(msg.msg,14,4,MAXBAND+1);
+        setbitu(msg.msg,18,4,band);
+        setbitu(msg.msg,22,2,iodi);
+        for (i=1;i<=201;i++) { /* mask of 80% igps */
+            setbitu(msg.msg,23+i,1,(i*7+band+seed)%5!=0);
+        }
+        assert(sbsupdatecorr(&msg,&nav)==18);
+        ion=nav.sbsion+band;
+        
+        for (block=0;block*15<ion->nigp;block++) {
+            genmsg(&msg,26,tow);
+            setbitu(msg.msg,14,4,band);
+            setbitu(msg.msg,18,4,block);
+            for (i=0;i<15&&(j=block*15+i)<ion->nigp;i++) {
+                setbitu(msg.msg,22+i*13  ,9,igpdelay(ion->igp[j].lat,ion->igp[j].lon));
+                setbitu(msg.msg,22+i*13+9,4,igpgive (ion->igp[j].lat,ion->igp[j].lon));
+            }
+            setbitu(msg.msg,217,2,iodi);
+            assert(sbsupdatecorr(&msg,&nav)==26);
+        }
+    }
+}
+/* reference: search igps in all bands ---------------------------------------*/
+static void searchigp_ref(const double *pos, const sbsion_t *ion,
+                          const sbsigp_t **igp, double *x, double *y)
+{
+    int i,latp[2],lonp[4];
+    double lat=pos[0]*R2D,lon=pos[1]*R2D;
+    const sbsigp_t *p;
+    
+    if (lon>=180.0) lon-=360.0;
+    if (-55.0<=lat&&lat<55.0) {
+        latp[0]=(int)floor(lat/5.0)*5;
+        latp[1]=latp[0]+5;
+        lonp[0]=lonp[1]=(int)floor(lon/5.0)*5;
+        lonp[2]=lonp[3]=lonp[0]+5;
+        *x=(lon-lonp[0])/5.0;
+        *y=(lat-latp[0])/5.0;
+    }
+    else {
+        latp[0]=(int)floor((lat-5.0)/10.0)*10+5;
+        latp[1]=latp[0]+10;
+        lonp[0]=lonp[1]=(int)floor(lon/10.0)*10;
+        lonp[2]=lonp[3]=lonp[0]+10;
+        *x=(lon-lonp[0])/10.0;
+        *y=(lat-latp[0])/10.0;
+        if (75.0<=lat&&lat<85.0) {
+            lonp[1]=(int)floor(lon/90.0)*90;
+            lonp[3]=lonp[1]+90;
+        }
+        else if (-85.0<=lat&&lat<-75.0) {
+            lonp[0]=(int)floor((lon-50.0)/90.0)*90+40;
+            lonp[2]=lonp[0]+90;
+        }
+        else if (lat>=85.0) {
+            for (i=0;i<4;i++) lonp[i]=(int)floor(lon/90.0)*90;
+        }
+        else if (lat<-85.0) {
+            for (i=0;i<4;i++) lonp[i]=(int)floor((lon-50.0)/90.0)*90+40;
+        }
+    }
+    for (i=0;i<4;i++) if (lonp[i]==180) lonp[i]=-180;
+    for (i=0;i<=MAXBAND;i++) {
+        for (p=ion[i].igp;p<ion[i].igp+ion[i].nigp;p++) {
+            if (p->t0.time==0) continue;
+            if      (p->lat==latp[0]&&p->lon==lonp[0]&&p->give>0) igp[0]=p;
+            else if (p->lat==latp[1]&&p->lon==lonp[1]&&p->give>0) igp[1]=p;
+            else if (p->lat==latp[0]&&p->lon==lonp[2]&&p->give>0) igp[2]=p;
+            else if (p->lat==latp[1]&&p->lon==lonp[3]&&p->give>0) igp[3]=p;
+            if (igp[0]&&igp[1]&&igp[2]&&igp[3]) return;
+        }
+    }
+}
+/* reference: sbas ionospheric delay correction by igp search ----------------*/
+static int sbsioncorr_ref(gtime_t time, const double *pos, const double *azel,
+                          double *delay, double *var)
+{
+    const double var_give[15]={
+        0.0084,0.0333,0.0749,0.1331,0.2079,0.2994,0.4075,0.5322,0.6735,0.8315,
+        1.1974,1.8709,3.326,20.787,187.0826
+    };
+    const sbsigp_t *igp[4]={0};
+    double fp,posp[2],x=0.0,y=0.0,t,w[4]={0};
+    int i,err=0;
+    
+    *delay=*var=0.0;
+    if (pos[2]<-100.0||azel[1]<=0) return 1;
+    
+    fp=ionppp(pos,azel,6378.1363,350.0,posp);
+    searchigp_ref(posp,nav.sbsion,igp,&x,&y);
+    
+    if (igp[0]&&igp[1]&&igp[2]&&igp[3]) {
+        w[0]=(1.0-x)*(1.0-y); w[1]=(1.0-x)*y; w[2]=x*(1.0-y); w[3]=x*y;
+    }
+    else if (igp[0]&&igp[1]&&igp[2]) {
+        w[1]=y; w[2]=x;
+        if ((w[0]=1.0-w[1]-w[2])<0.0) err=1;
+    }
+    else if (igp[0]&&igp[2]&&igp[3]) {
+        w[0]=1.0-x; w[3]=y;
+        if ((w[2]=1.0-w[0]-w[3])<0.0) err=1;
+    }
+    else if (igp[0]&&igp[1]&&igp[3]) {
+        w[0]=1.0-y; w[3]=x;
+        if ((w[1]=1.0-w[0]-w[3])<0.0) err=1;
+    }
+    else if (igp[1]&&igp[2]&&igp[3]) {
+        w[1]=1.0-x; w[2]=1.0-y;
+        if ((w[3]=1.0-w[1]-w[2])<0.0) err=1;
+    }
+    else err=1;
+    
+    if (err) return 0;
+    
+    for (i=0;i<4;i++) {
+        if (!igp[i]) continue;
+        t=timediff(time,igp[i]->t0);
+        *delay+=w[i]*igp[i]->delay;
+        *var+=w[i]*var_give[igp[i]->give-1]*9E-8*fabs(t);
+    }
+    *delay*=fp; *var*=fp*fp;
+    return 1;
+}
+/* random receiver positions and satellite directions ------------------------*/
+static void genpos(double *pos, double *azel, int n)
+{
+    int i;
+    
+    srand(1234);
+    for (i=0;i<n;i++) {
+        pos [i*3  ]=(rand()/(double)RAND_MAX*180.0-90.0)*D2R;
+        pos [i*3+1]=(rand()/(double)RAND_MAX*360.0-180.0)*D2R;
+        pos [i*3+2]=rand()/(double)RAND_MAX*1000.0;
+        azel[i*2  ]=rand()/(double)RAND_MAX*2.0*PI;
+        azel[i*2+1]=(rand()/(double)RAND_MAX*85.0+5.0)*D2R;
+    }
+}
+/* sbsioncorr() versus igp search in all bands */
+void utest1(void)
+{
+    gtime_t time=gpst2time(WEEK,TOW+10);
+    double *pos,*azel,delay1,var1,delay2,var2;
+    int i,j,stat1,stat2,nok;
+    
+    pos=mat(3,NPOS); azel=mat(2,NPOS);
+        assert(pos&&azel);
+    genpos(pos,azel,NPOS);
+    
+    for (j=0;j<2;j++) {
+        setion(TOW,j); /* mask changed by j */
+        
+        for (i=nok=0;i<NPOS;i++) {
+            stat1=sbsioncorr(time,&nav,pos+i*3,azel+i*2,&delay1,&var1);
+            stat2=sbsioncorr_ref(time,pos+i*3,azel+i*2,&delay2,&var2);
+                assert(stat1==stat2&&delay1==delay2&&var1==var2);
+            if (stat1&&delay1>0.0) nok++;
+        }
+        printf("mask %d: corrections=%d/%d\n",j,nok,NPOS);
+            assert(nok>NPOS/4);
+    }
+    free(pos); free(azel);
+    printf("%s utest1 : OK\n",__FILE__);
+}
+/* sbssatcorr() by satellite slots */
+void utest2(void)
+{
+    gtime_t time=gpst2time(WEEK,TOW+5);
+    sbsmsg_t msg;
+    double rs[3],dts[1],var;
+    int i,j,k,sat,prn,stat;
+    
+    for (k=0;k<2;k++) {
+        genmsg(&msg,1,TOW);
+        for (prn=1;prn<=32;prn++) { /* mask of odd or even prns */
+            if (prn%2==k) setbitu(msg.msg,13+prn,1,1);
+        }
+        assert(sbsupdatecorr(&msg,&nav)==1);
+            assert(nav.sbssat.nsat==16);
+        
+        genmsg(&msg,2,TOW);
+        setbitu(msg.msg,16,2,nav.sbssat.iodp);
+        for (i=0;i<13;i++) {
+            setbitu(msg.msg,18+i*12,12,(i+1)*8);
+            setbitu(msg.msg,174+4*i,4,2);
+        }
+        assert(sbsupdatecorr(&msg,&nav)==2);
+        
+        for (i=0;i<nav.sbssat.nsat;i++) {
+            nav.sbssat.sat[i].lcorr.t0=gpst2time(WEEK,TOW);
+            nav.sbssat.sat[i].lcorr.dpos[0]=nav.sbssat.sat[i].sat;
+        }
+        for (prn=1;prn<=32;prn++) {
+            sat=satno(SYS_GPS,prn);
+            rs[0]=rs[1]=rs[2]=dts[0]=0.0;
+            stat=sbssatcorr(time,sat,&nav,rs,dts,&var);
+            j=prn/2-(k?0:1); /* slot in mask */
+            if (prn%2!=k||j>=13) {
+                assert(!stat);
+                continue;
+            }
+                assert(stat&&rs[0]==sat&&dts[0]==(j+1)/CLIGHT);
+        }
+    }
+    printf("%s utest2 : OK\n",__FILE__);
+}
+/* write sbas log file */
+static void writemsgs(const int *tow, int n)
+{
+    FILE *fp;
+    sbsmsg_t msg;
+    int i;
+    
+    fp=fopen(FILESBS,"w");
+        assert(fp);
+    for (i=0;i<n;i++) {
+        genmsg(&msg,63,tow[i]);
+        msg.prn=120+i%3;
+        setbitu(msg.msg,14,16,i);
+        sbsoutmsg(fp,&msg);
+    }
+    fclose(fp);
+}
+/* check order of sbas messages */
+static void checkmsgs(const sbs_t *sbs, int n)
+{
+    int i;
+    
+        assert(sbs->n==n);
+    for (i=1;i<sbs->n;i++) {
+        assert(sbs->msgs[i-1].tow< sbs->msgs[i].tow||
+              (sbs->msgs[i-1].tow==sbs->msgs[i].tow&&
+               sbs->msgs[i-1].prn<=sbs->msgs[i].prn));
+    }
+}
+/* sbsreadmsg() with in-order insertion */
+void utest3(void)
+{
+    sbs_t sbs={0};
+    int i,n=5000,*tow;
+    
+    tow=imat(n,1);
+        assert(tow);
+    
+    /* messages in order with local disorder */
+    for (i=0;i<n;i++) tow[i]=TOW+i/3+(i%3==0?2:0);
+    writemsgs(tow,n);
+    sbsreadmsg(FILESBS,0,&sbs);
+    checkmsgs(&sbs,n);
+    
+    /* message blocks out of order */
+    for (i=0;i<n;i++) tow[i]=TOW+(i<n/2?n/2+i:i-n/2);
+    writemsgs(tow,n);
+    sbs.n=0;
+    sbsreadmsg(FILESBS,0,&sbs);
+    checkmsgs(&sbs,n);
+    
+    free(sbs.msgs);
+    free(tow);
+    remove(FILESBS);
+    printf("%s utest3 : OK\n",__FILE__);
+}
+/* sbsioncorr() throughput */
+void utest4(void)
+{
+    gtime_t time=gpst2time(WEEK,TOW+10);
+    double *pos,*azel,delay,var;
+    uint32_t t0,t1,t2;
+    int i;
+    
+    pos=mat(3,NPOS); azel=mat(2,NPOS);
+        assert(pos&&azel);
+    genpos(pos,azel,NPOS);
+    setion(TOW,0);
+    
+    t0=tickget();
+    for (i=0;i<NPOS;i++) {
+        sbsioncorr(time,&nav,pos+i*3,azel+i*2,&delay,&var);
+    }
+    t1=tickget();
+    for (i=0;i<NPOS;i++) {
+        sbsioncorr_ref(time,pos+i*3,azel+i*2,&delay,&var);
+    }
+    t2=tickget();
+    printf("sbsioncorr: %.3f us/call (igp search: %.3f us/call)\n",
+           (t1-t0)*1E3/NPOS,(t2-t1)*1E3/NPOS);
+    
+    free(pos); free(azel);
+    printf("%s utest4 : OK\n",__FILE__);
+}
+int main(void)
+{
+    utest1();
+    utest2();
+    utest3();
+    utest4();
+    return 0;
+}
@@ -0,0 +1,481 @@
+/*------------------------------------------------------------------------------
+* rtklib unit test driver : solution functions
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "../../src/rtklib.h"
+
+#define NSOL        1000                /* number of solutions per file */
+
+static const char *file1="t_solution1.pos";
+static const char *file2="t_solution2.pos";
+static const char *file3="t_solution3.pos";
+static const char *file4="t_solution4.bin";
+static const char *file5="t_solution5.kml";
+
+/* write solution file -------------------------------------------------------*/
+static void writesolf(const char *file, int ws, int dt, int n, int shuffle,
+                      int posf, int stat)
+{
+    FILE *fp;
+    solopt_t opt=solopt_default;
+    sol_t sol={{0}};
+    gtime_t t0;
+    double pos[3]={35.0*D2R,139.0*D2R,50.0};
+    int i,j,k,*idx;
+    
+    opt.posf=posf; opt.timef=1; opt.outhead=1;
+    t0=gpst2time(2100,345600.0+ws);
+    
+    idx=(int *)malloc(sizeof(int)*n);
+    for (i=0;i<n;i++) idx[i]=i;
+    for (i=n-1;shuffle&&i>0;i--) {
+        j=rand()%(i+1); k=idx[i]; idx[i]=idx[j]; idx[j]=k;
+    }
+    fp=fopen(file,"wb");
+        assert(fp);
+    outsolhead(fp,&opt);
+    for (i=0;i<n;i++) {
+        sol.time=timeadd(t0,idx[i]*dt);
+        pos[2]=50.0+idx[i]*0.001;
+        pos2ecef(pos,sol.rr);
+        for (j=0;j<3;j++) sol.qr[j]=(float)(0.01*(j+1));
+        sol.stat=(uint8_t)stat; sol.ns=(uint8_t)(idx[i]%32);
+        outsol(fp,&sol,sol.rr,&opt);
+    }
+    fclose(fp);
+    free(idx);
+}
+/* check solutions in time order ---------------------------------------------*/
+static void checksol(solbuf_t *solbuf, int n)
+{
+    sol_t *p,*q;
+    int i;
+    
+        assert(solbuf->n==n);
+    for (i=1;i<solbuf->n;i++) {
+        p=getsol(solbuf,i-1); q=getsol(solbuf,i);
+        assert(timediff(q->time,p->time)>=0.0);
+    }
+}
+/* readsolt() of monotonic and shuffled file */
+void utest1(void)
+{
+    gtime_t t0={0};
+    solbuf_t solbuf1={0},solbuf2={0};
+    char *files[1];
+    double pos[3];
+    int i;
+    
+    writesolf(file1,0,1,NSOL,0,SOLF_LLH,SOLQ_FIX);
+    writesolf(file2,0,1,NSOL,1,SOLF_LLH,SOLQ_FIX);
+    
+    files[0]=(char *)file1;
+    assert(readsolt(files,1,t0,t0,0.0,0,&solbuf1));
+    checksol(&solbuf1,NSOL);
+    files[0]=(char *)file2;
+    assert(readsolt(files,1,t0,t0,0.0,0,&solbuf2));
+    checksol(&solbuf2,NSOL);
+    
+    for (i=0;i<NSOL;i++) {
+        assert(timediff(solbuf1.data[i].time,solbuf2.data[i].time)==0.0);
+        assert(solbuf1.data[i].ns==solbuf2.data[i].ns);
+        assert(solbuf1.data[i].stat==SOLQ_FIX);
+        ecef2pos(solbuf1.data[i].rr,pos);
+        assert(fabs(pos[2]-(50.0+i*0.001))<1E-4);
+        assert(fabs(solbuf1.data[i].qr[0]+solbuf1.data[i].qr[1]+
+                    solbuf1.data[i].qr[2]-0.06)<1E-4);
+    }
+    /* time span and interval */
+    files[0]=(char *)file1;
+    freesolbuf(&solbuf2);
+    assert(readsolt(files,1,solbuf1.data[100].time,solbuf1.data[199].time,10.0,
+                    0,&solbuf2));
+    checksol(&solbuf2,10);
+    
+    freesolbuf(&solbuf1);
+    freesolbuf(&solbuf2);
+    printf("%s utest1 : OK\n",__FILE__);
+}
+/* readsolt() of multiple files */
+void utest2(void)
+{
+    gtime_t t0={0};
+    solbuf_t solbuf={0};
+    char *files[4];
+    int i;
+    
+    /* overlapped files in reverse order, different formats */
+    writesolf(file1,2*NSOL,1,NSOL,0,SOLF_XYZ,SOLQ_FIX);
+    writesolf(file2,NSOL/2,2,NSOL,1,SOLF_LLH,SOLQ_FLOAT);
+    writesolf(file3,0,1,NSOL,0,SOLF_LLH,SOLQ_SINGLE);
+    files[0]=(char *)file1;
+    files[1]=(char *)file2;
+    files[2]="t_solution_none.pos"; /* no file */
+    files[3]=(char *)file3;
+    
+    assert(readsolt(files,4,t0,t0,0.0,0,&solbuf));
+    checksol(&solbuf,3*NSOL);
+    
+    /* same times ordered by file (fix,float,single) */
+    for (i=1;i<solbuf.n;i++) {
+        if (timediff(solbuf.data[i].time,solbuf.data[i-1].time)!=0.0) continue;
+        assert(solbuf.data[i-1].stat<solbuf.data[i].stat);
+    }
+    freesolbuf(&solbuf);
+    
+    files[0]="t_solution_none.pos";
+    assert(!readsolt(files,1,t0,t0,0.0,0,&solbuf));
+        assert(solbuf.n==0);
+    
+    remove(file1); remove(file2); remove(file3);
+    printf("%s utest2 : OK\n",__FILE__);
+}
+/* readsolt() performance */
+void utest3(void)
+{
+    gtime_t t0={0};
+    solbuf_t solbuf={0};
+    char *files[2];
+    uint32_t tick;
+    
+    writesolf(file1,0,1,NSOL*100,0,SOLF_LLH,SOLQ_FIX);
+    writesolf(file2,NSOL*100,1,NSOL*100,0,SOLF_LLH,SOLQ_FIX);
+    files[0]=(char *)file1;
+    files[1]=(char *)file2;
+    
+    tick=tickget();
+    assert(readsolt(files,2,t0,t0,0.0,0,&solbuf));
+    checksol(&solbuf,NSOL*200);
+    printf("readsolt: %.3f us/solution\n",(tickget()-tick)*1E3/solbuf.n);
+    
+    freesolbuf(&solbuf);
+    remove(file1); remove(file2);
+    printf("%s utest3 : OK\n",__FILE__);
+}
+/* file size */
+static long filesize(const char *file)
+{
+    FILE *fp;
+    long size;
+    
+    if (!(fp=fopen(file,"rb"))) return 0;
+    fseek(fp,0,SEEK_END);
+    size=ftell(fp);
+    fclose(fp);
+    return size;
+}
+/* binary solution output and readsolt() */
+void utest4(void)
+{
+    gtime_t t0={0};
+    solbuf_t solbuf1={0},solbuf2={0};
+    solopt_t opt=solopt_default;
+    char *files[2];
+    double pos[3];
+    long size1,size2;
+    int i,j;
+    
+    writesolf(file1,0,1,NSOL,1,SOLF_LLH,SOLQ_FIX);
+    writesolf(file4,0,1,NSOL,1,SOLF_BIN,SOLQ_FIX);
+    size1=filesize(file1);
+    size2=filesize(file4);
+        assert(size2==(long)(sizeof(solbinh_t)+sizeof(solbin_t)*NSOL));
+        assert(size2*10<size1*6);
+    
+    files[0]=(char *)file1;
+    assert(readsolt(files,1,t0,t0,0.0,0,&solbuf1));
+    files[0]=(char *)file4;
+    assert(readsolt(files,1,t0,t0,0.0,0,&solbuf2));
+    checksol(&solbuf2,NSOL);
+    
+    for (i=0;i<NSOL;i++) {
+        assert(timediff(solbuf1.data[i].time,solbuf2.data[i].time)==0.0);
+        assert(solbuf1.data[i].ns==solbuf2.data[i].ns);
+        assert(solbuf2.data[i].stat==SOLQ_FIX);
+        ecef2pos(solbuf2.data[i].rr,pos);
+        assert(fabs(pos[2]-(50.0+i*0.001))<1E-8);
+        for (j=0;j<3;j++) {
+            assert(solbuf2.data[i].qr[j]==(float)(0.01*(j+1)));
+        }
+    }
+    freesolbuf(&solbuf1);
+    freesolbuf(&solbuf2);
+    
+    /* binary and text files mixed */
+    writesolf(file1,NSOL,1,NSOL,0,SOLF_XYZ,SOLQ_FLOAT);
+    files[0]=(char *)file4;
+    files[1]=(char *)file1;
+    assert(readsolt(files,2,t0,t0,0.0,0,&solbuf1));
+    checksol(&solbuf1,2*NSOL);
+        assert(solbuf1.data[0].stat==SOLQ_FIX);
+        assert(solbuf1.data[2*NSOL-1].stat==SOLQ_FLOAT);
+    freesolbuf(&solbuf1);
+    
+    /* quality flag */
+    assert(readsolt(files,2,t0,t0,0.0,SOLQ_FIX,&solbuf1));
+    checksol(&solbuf1,NSOL);
+    freesolbuf(&solbuf1);
+    
+    /* convert binary to text */
+    opt.posf=SOLF_XYZ;
+    opt.timeu=9;
+    assert(convsol(file4,file1,t0,t0,0.0,0,&opt)==0);
+    assert(convsol(file4,file4,t0,t0,0.0,0,&opt)==-4); /* overwrite input */
+    files[0]=(char *)file1;
+    assert(readsolt(files,1,t0,t0,0.0,0,&solbuf1));
+    files[0]=(char *)file4;
+    assert(readsolt(files,1,t0,t0,0.0,0,&solbuf2));
+    checksol(&solbuf1,NSOL);
+    for (i=0;i<NSOL;i++) {
+        assert(timediff(solbuf1.data[i].time,solbuf2.data[i].time)==0.0);
+        for (j=0;j<3;j++) {
+            assert(fabs(solbuf1.data[i].rr[j]-solbuf2.data[i].rr[j])<1E-4);
+        }
+    }
+    freesolbuf(&solbuf1);
+    freesolbuf(&solbuf2);
+    
+    remove(file1); remove(file4);
+    printf("%s utest4 : OK\n",__FILE__);
+}
+/* outsols() output format and performance */
+void utest5(void)
+{
+    const char *ref[]={
+        "2020/04/05 01:00:00.125,  35.123456789,-139.987654321,   50.1234,  1, 12,"
+        "  0.0259,  0.0172,  0.0208, -0.0091,  0.0109,  0.0181,  1.50,   3.4,"
+        "   0.40750,   1.03961,  -0.56192,  0.04407, 0.06430, 0.06264, 0.05323,"
+        "-0.06346,-0.05254\r\n",
+        "2100   3600.12   35 07 24.44444 -139 59 15.55556    50.1234   1  12"
+        "   0.0259   0.0172   0.0208  -0.0091   0.0109   0.0181   1.50    3.4\r\n",
+        "2020/04/05 00:59:42.125  -4000020.0865  -3357884.3905   3649106.7964   1"
+        "  12   0.0100   0.0200   0.0300  -0.0045   0.0000   0.0000   1.50    3.4"
+        "\r\n",
+        "2020/04/05 01:00:00.125        -0.0000      2602.3781        -0.5327   1"
+        "  12   0.0172   0.0259   0.0208  -0.0091   0.0181   0.0109   1.50    3.4"
+        "\r\n",
+        "$GPRMC,005942.12,A,3507.4074073,N,13959.2592593,W,2.43,68.60,050420,0.0,"
+        "E,R,V*7F\r\n"
+        "$GPGGA,005942.12,3507.4074073,N,13959.2592593,W,4,12,1.0,82.748,M,"
+        "-32.624,M,1.5,0000*41\r\n"
+    };
+    solopt_t opt;
+    sol_t sol={{0}};
+    double pos[3]={35.123456789*D2R,-139.987654321*D2R,50.1234},rb[3],t;
+    uint8_t buff[1024];
+    uint32_t tick;
+    int i,n;
+    
+    pos2ecef(pos,sol.rr);
+    sol.rr[3]=1.2; sol.rr[4]=-0.35; sol.rr[5]=0.01;
+    sol.qr[0]=0.0001f; sol.qr[1]=0.0004f; sol.qr[2]=0.0009f; sol.qr[3]=-0.00002f;
+    sol.qv[0]=0.01f;
+    sol.stat=SOLQ_FIX; sol.ns=12; sol.age=1.5f; sol.ratio=3.4f;
+    sol.time=gpst2time(2100,3600.125);
+    pos[0]=35.1*D2R;
+    pos2ecef(pos,rb);
+    
+    for (i=0;i<5;i++) {
+        opt=solopt_default;
+        switch (i) {
+            case 0: opt.posf=SOLF_LLH; strcpy(opt.sep,","); opt.outvel=1; break;
+            case 1: opt.posf=SOLF_LLH; opt.degf=1; opt.timef=0; opt.timeu=2; break;
+            case 2: opt.posf=SOLF_XYZ; opt.times=TIMES_UTC; break;
+            case 3: opt.posf=SOLF_ENU; break;
+            case 4: opt.posf=SOLF_NMEA; break;
+        }
+        n=outsols(buff,&sol,rb,&opt);
+        assert(n==(int)strlen(ref[i])&&!memcmp(buff,ref[i],n));
+    }
+    opt=solopt_default;
+    opt.posf=SOLF_GSIF; /* not supported */
+    n=outsols(buff,&sol,rb,&opt);
+        assert(n==0);
+    sol.stat=SOLQ_NONE;
+    n=outnmea_rmc(buff,&sol);
+        assert(n==24&&!memcmp(buff,"$GPRMC,,,,,,,,,,,,,*67\r\n",n));
+    n=outnmea_gga(buff,&sol);
+        assert(n==25&&!memcmp(buff,"$GPGGA,,,,,,,,,,,,,,*56\r\n",n));
+    sol.stat=SOLQ_FIX;
+    
+    /* sentences per second */
+    for (i=0;i<3;i++) {
+        opt=solopt_default;
+        opt.posf=i==0?SOLF_LLH:(i==1?SOLF_XYZ:SOLF_NMEA);
+        tick=tickget();
+        for (n=0;n<NSOL*100;n++) {
+            sol.time.sec=n*0.05-floor(n*0.05);
+            assert(outsols(buff,&sol,rb,&opt)>0);
+        }
+        t=(tickget()-tick)*1E-3;
+        printf("outsols: posf=%d %.0f sentences/s\n",opt.posf,
+               NSOL*100*(i==2?2:1)/(t>0.0?t:1E-3));
+    }
+    printf("%s utest5 : OK\n",__FILE__);
+}
+/* write solution file of curved track --------------------------------------*/
+static void writetrk(const char *file, int n, int posf)
+{
+    FILE *fp;
+    solopt_t opt=solopt_default;
+    sol_t sol={{0}};
+    double pos[3]={35.0*D2R,139.0*D2R,50.0},rr[3],enu[3],dr[3];
+    int i,j;
+    
+    opt.posf=posf; opt.outhead=1;
+    pos2ecef(pos,rr);
+    fp=fopen(file,"wb");
+        assert(fp);
+    outsolhead(fp,&opt);
+    for (i=0;i<n;i++) {
+        sol.time=gpst2time(2100,345600.0+i);
+        enu[0]=100.0*cos(i*0.01)+i*0.1;
+        enu[1]=100.0*sin(i*0.01);
+        enu[2]=0.005*(i%7);
+        enu2ecef(pos,enu,dr);
+        for (j=0;j<3;j++) sol.rr[j]=rr[j]+dr[j];
+        sol.stat=(uint8_t)((i/300)%3==2?SOLQ_FLOAT:SOLQ_FIX);
+        sol.ns=10;
+        outsol(fp,&sol,rr,&opt);
+    }
+    fclose(fp);
+}
+/* distance between point and segment ----------------------------------------*/
+static double distseg(const double *r, const double *r1, const double *r2)
+{
+    double a[3],b[3],t,ab=0.0,bb=0.0;
+    int i;
+    
+    for (i=0;i<3;i++) {
+        a[i]=r[i]-r1[i]; b[i]=r2[i]-r1[i];
+        ab+=a[i]*b[i]; bb+=b[i]*b[i];
+    }
+    t=bb>0.0?ab/bb:0.0;
+    t=t<0.0?0.0:(t>1.0?1.0:t);
+    for (i=0;i<3;i++) a[i]-=t*b[i];
+    return norm(a,3);
+}
+/* solution stream, decimation and streaming kml conversion */
+void utest6(void)
+{
+    gtime_t t0={0},time0;
+    solbuf_t solbuf={0};
+    solfp_t solf;
+    sol_t sol,*all,*dec;
+    FILE *fp;
+    char *files[2],*buff;
+    double off[3]={0},dr[3],rb[3],tol=0.1,t;
+    int i,j,k,n,m,bystat;
+    size_t nb;
+    
+    /* stream of text and binary file same as readsolt() */
+    for (k=0;k<2;k++) {
+        writesolf(file1,0,1,NSOL,0,k?SOLF_BIN:SOLF_XYZ,SOLQ_FIX);
+        files[0]=(char *)file1;
+        assert(readsolt(files,1,t0,t0,0.0,0,&solbuf));
+        assert(solfopen(&solf,files,1,t0,t0,0.0,0));
+        for (n=0;solfread(&solf,&sol);n++) {
+            assert(n<solbuf.n);
+            assert(timediff(sol.time,solbuf.data[n].time)==0.0);
+            assert(sol.ns==solbuf.data[n].ns);
+            for (j=0;j<3;j++) assert(sol.rr[j]==solbuf.data[n].rr[j]);
+        }
+        assert(n==NSOL);
+        solfclose(&solf);
+        freesolbuf(&solbuf);
+    }
+    /* files read in order of files[] */
+    writesolf(file4,NSOL,1,NSOL,0,SOLF_BIN,SOLQ_FLOAT);
+    files[0]=(char *)file4;
+    files[1]=(char *)file1;
+    assert(solfopen(&solf,files,2,t0,t0,0.0,SOLQ_FLOAT));
+    for (n=0;solfread(&solf,&sol);n++) assert(sol.stat==SOLQ_FLOAT);
+    assert(n==NSOL);
+    solfclose(&solf);
+    
+    /* decimation within tolerance */
+    n=NSOL*10;
+    writetrk(file1,n,SOLF_LLH);
+    files[0]=(char *)file1;
+    all=(sol_t *)malloc(sizeof(sol_t)*n);
+    dec=(sol_t *)malloc(sizeof(sol_t)*n);
+    assert(solfopen(&solf,files,1,t0,t0,0.0,0));
+    for (i=0;i<n;i++) assert(solfread(&solf,all+i));
+    assert(!solfread(&solf,&sol));
+    solfclose(&solf);
+    
+    /* offset by mean position */
+    assert(solfoffset(files,1,t0,t0,0.0,0,off,1,dr,rb,&time0)==n);
+        assert(timediff(time0,all[0].time)==0.0&&norm(dr,3)==0.0);
+    assert(solfoffset(files,1,t0,t0,0.0,0,off,0,dr,rb,&time0)==1);
+    
+    for (bystat=0;bystat<2;bystat++) {
+        assert(solfopendp(&solf,files,1,t0,t0,0.0,0,tol,bystat));
+        for (m=0;solfread(&solf,dec+m);m++) assert(m<n);
+        solfclose(&solf);
+            assert(m>2&&m*5<n);
+            assert(timediff(dec[0].time,all[0].time)==0.0);
+            assert(timediff(dec[m-1].time,all[n-1].time)==0.0);
+        
+        for (i=j=0;i<n;i++) {
+            while (j<m-1&&timediff(dec[j+1].time,all[i].time)<=0.0) j++;
+            if (j<m-1) assert(distseg(all[i].rr,dec[j].rr,dec[j+1].rr)<=tol);
+            if (!bystat||i==0||all[i].stat==all[i-1].stat) continue;
+            
+            /* solution status change kept */
+            assert(timediff(dec[j].time,all[i].time)==0.0);
+            assert(timediff(dec[j-1].time,all[i-1].time)==0.0);
+        }
+        printf("solfdecim: tol=%.2f bystat=%d n=%d -> %d\n",tol,bystat,n,m);
+    }
+    free(all);
+    free(dec);
+    
+    /* points per second of stream and kml conversion */
+    n=NSOL*100;
+    for (k=0;k<2;k++) {
+        writetrk(file4,n,k?SOLF_BIN:SOLF_LLH);
+        files[0]=(char *)file4;
+        
+        /* baseline: raw file read without decoding */
+        buff=(char *)malloc(1048576);
+        fp=fopen(file4,"rb");
+            assert(buff&&fp);
+        t=prftick();
+        for (nb=0;(i=(int)fread(buff,1,1048576,fp))>0;nb+=i) ;
+        t=(prftick()-t)*1E-6;
+        fclose(fp);
+        free(buff);
+        printf("fread   : %s %.0f points/s (%.0f MB/s)\n",k?"bin":"llh",
+               n/(t>0.0?t:1E-6),nb*1E-6/(t>0.0?t:1E-6));
+        
+        t=prftick();
+        assert(solfopen(&solf,files,1,t0,t0,0.0,0));
+        for (i=0;solfread(&solf,&sol);i++) ;
+        solfclose(&solf);
+        t=(prftick()-t)*1E-6;
+            assert(i==n);
+        printf("solfread: %s %.0f points/s\n",k?"bin":"llh",n/(t>0.0?t:1E-6));
+        
+        t=prftick();
+        assert(convkmldp(file4,file5,t0,t0,0.0,0,off,6,0,0,0,tol)==0);
+        t=(prftick()-t)*1E-6;
+        printf("convkmldp: %s %.0f points/s\n",k?"bin":"llh",n/(t>0.0?t:1E-6));
+    }
+    remove(file1); remove(file4); remove(file5);
+    printf("%s utest6 : OK\n",__FILE__);
+}
+int main(void)
+{
+    utest1();
+    utest2();
+    utest3();
+    utest4();
+    utest5();
+    utest6();
+    return 0;
+}
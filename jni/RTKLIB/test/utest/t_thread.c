@@ -0,0 +1,443 @@
+/*------------------------------------------------------------------------------
+* rtklib unit test driver : concurrent positioning
+*
+* notes  : to check data races, build all objects and t_thread with
+*          -fsanitize=thread (ThreadSanitizer) and run t_thread. races reported
+*          on the status snapshot copied by rtksvrsnap() and on the server
+*          state flag in utest5 are expected (a torn copy of the snapshot is
+*          detected by the sequence number and discarded)
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stddef.h>
+#include <assert.h>
+#include "../../src/rtklib.h"
+
+#define DIR     "../data/rinex/"
+#define MAXSOL  1024            /* max number of solutions */
+#define NTHREAD 8               /* number of concurrent solutions */
+
+typedef struct {                /* positioning job type */
+    prcopt_t opt;               /* processing options */
+    const char *stat;           /* solution status file ("": no output) */
+    int level;                  /* solution status level */
+    sol_t sol[MAXSOL];          /* solutions */
+    int n;                      /* number of solutions */
+} job_t;
+
+static obs_t obs={0};           /* observation data (rover+base) */
+static nav_t nav={0};           /* navigation data */
+static double rb[3];            /* base station position (ecef) */
+
+/* read rover/base observation and navigation data ---------------------------*/
+static void readdata(void)
+{
+    sta_t sta={{0}};
+    int stat;
+    
+    stat=readrnx(DIR "07590920.05o",1,"",&obs,&nav,NULL);
+        assert(stat==1);
+    stat=readrnx(DIR "30400920.05o",2,"",&obs,&nav,&sta);
+        assert(stat==1);
+    stat=readrnx(DIR "07590920.05n",1,"",&obs,&nav,NULL);
+        assert(stat==1);
+    sortobs(&obs);
+    uniqnav(&nav);
+        assert(obs.n>0&&nav.n>0);
+    matcpy(rb,sta.pos,3,1);
+}
+/* positioning of all epochs -------------------------------------------------*/
+static void *procjob(void *arg)
+{
+    job_t *job=(job_t *)arg;
+    rtk_t *rtk=(rtk_t *)malloc(sizeof(rtk_t));
+    statf_t statf={0};
+    int i,j;
+    
+    rtkinit(rtk,&job->opt);
+    if (*job->stat&&rtkopenstatf(&statf,job->stat,job->level)) {
+        rtk->statf=&statf;
+    }
+    
+    for (i=0,job->n=0;i<obs.n&&job->n<MAXSOL;i=j) {
+        for (j=i+1;j<obs.n;j++) {
+            if (fabs(timediff(obs.data[j].time,obs.data[i].time))>DTTOL) break;
+        }
+        rtkpos(rtk,obs.data+i,j-i,&nav);
+        job->sol[job->n++]=rtk->sol;
+    }
+    rtkclosestatf(&statf);
+    rtkfree(rtk);
+    free(rtk);
+    return NULL;
+}
+/* set processing options ----------------------------------------------------*/
+static void setjob(job_t *job, int mode)
+{
+    job->opt=prcopt_default;
+    job->opt.mode=mode;
+    job->opt.navsys=SYS_GPS;
+    job->opt.nf=mode==PMODE_SINGLE?1:2;
+    job->opt.refpos=POSOPT_POS;
+    matcpy(job->opt.rb,rb,3,1);
+    if (mode>=PMODE_PPP_KINEMA) {
+        job->opt.ionoopt=IONOOPT_IFLC;
+        job->opt.tropopt=TROPOPT_EST;
+    }
+    job->stat="";
+    job->level=2;
+    job->n=0;
+}
+/* compare solutions (bit-identical) -----------------------------------------*/
+static int cmpsols(const job_t *job1, const job_t *job2)
+{
+    const sol_t *s1,*s2;
+    int i;
+    
+    if (job1->n!=job2->n) return 0;
+    for (i=0;i<job1->n;i++) {
+        s1=job1->sol+i; s2=job2->sol+i;
+        if (timediff(s1->time,s2->time)!=0.0||s1->stat!=s2->stat||
+            s1->ns!=s2->ns||s1->ratio!=s2->ratio||
+            memcmp(s1->rr ,s2->rr ,sizeof(s1->rr ))||
+            memcmp(s1->qr ,s2->qr ,sizeof(s1->qr ))||
+            memcmp(s1->dtr,s2->dtr,sizeof(s1->dtr))) return 0;
+    }
+    return 1;
+}
+/* concurrent solutions versus serial solutions */
+void utest1(void)
+{
+    const int modes[]={
+        PMODE_SINGLE,PMODE_DGPS,PMODE_KINEMA,PMODE_STATIC,PMODE_PPP_KINEMA
+    };
+    job_t *ser,*par;
+    thread_t thread[NTHREAD];
+    char file[NTHREAD][32];
+    int i,stat,nmode=(int)(sizeof(modes)/sizeof(*modes));
+    
+    ser=(job_t *)malloc(sizeof(job_t)*nmode);
+    par=(job_t *)malloc(sizeof(job_t)*NTHREAD);
+        assert(ser&&par);
+    
+    /* serial solutions */
+    for (i=0;i<nmode;i++) {
+        setjob(ser+i,modes[i]);
+        procjob(ser+i);
+            assert(ser[i].n>0);
+    }
+    /* concurrent solutions with separate solution status files */
+    for (i=0;i<NTHREAD;i++) {
+        setjob(par+i,modes[i%nmode]);
+        sprintf(file[i],"utest_thread%d.stat",i);
+        par[i].stat=file[i];
+    }
+    for (i=0;i<NTHREAD;i++) {
+        stat=pthread_create(thread+i,NULL,procjob,par+i);
+            assert(!stat);
+    }
+    for (i=0;i<NTHREAD;i++) {
+        pthread_join(thread[i],NULL);
+    }
+    for (i=0;i<NTHREAD;i++) {
+        assert(cmpsols(ser+i%nmode,par+i));
+        remove(file[i]);
+    }
+    free(ser);
+    free(par);
+    
+    printf("%s utest1 : OK\n",__FILE__);
+}
+/* concurrent time_str(), eci2ecef() and sbstropcorr() */
+static void *procfunc(void *arg)
+{
+    gtime_t time=epoch2time((const double *)arg);
+    double erpv[5]={0},U[9],U0[9],gmst,gmst0,pos[3],azel[]={0.0,0.5},var;
+    double trop,trop0;
+    char str[64];
+    int i;
+    
+    for (i=0;i<1000;i++) {
+        pos[0]=(i%90)*D2R; pos[1]=0.0; pos[2]=(i%10)*100.0;
+        
+        time2str(time,str,3);
+        assert(!strcmp(time_str(time,3),str));
+        
+        eci2ecef(time,erpv,U,&gmst);
+        eci2ecef(timeadd(time,0.0),erpv,U0,&gmst0);
+        assert(!memcmp(U,U0,sizeof(U))&&gmst==gmst0);
+        
+        trop=sbstropcorr(time,pos,azel,&var);
+        trop0=sbstropcorr(time,pos,azel,&var);
+        assert(trop==trop0);
+        
+        time=timeadd(time,3600.0);
+    }
+    return NULL;
+}
+void utest2(void)
+{
+    double ep[NTHREAD][6];
+    thread_t thread[NTHREAD];
+    int i,stat;
+    
+    for (i=0;i<NTHREAD;i++) {
+        ep[i][0]=2000+i; ep[i][1]=1; ep[i][2]=1;
+        ep[i][3]=ep[i][4]=ep[i][5]=0.0;
+        stat=pthread_create(thread+i,NULL,procfunc,ep[i]);
+            assert(!stat);
+    }
+    for (i=0;i<NTHREAD;i++) {
+        pthread_join(thread[i],NULL);
+    }
+    printf("%s utest2 : OK\n",__FILE__);
+}
+/* solution ring with concurrent producer and consumer */
+#define NRINGSOL 200000         /* number of solutions put to ring */
+
+static solring_t ring;
+
+static void *putsols(void *arg)
+{
+    sol_t sol={{0}};
+    int i,j,*nput=(int *)arg;
+    
+    for (i=0;i<NRINGSOL;i++) {
+        sol.time.time=i; sol.time.sec=i*1E-3;
+        for (j=0;j<6;j++) sol.rr[j]=i+j;
+        sol.stat=(uint8_t)(i%7); sol.ns=(uint8_t)(i%50);
+        *nput+=solringput(&ring,&sol);
+    }
+    return NULL;
+}
+void utest3(void)
+{
+    thread_t thread;
+    sol_t sol;
+    uint32_t seq,prev=0;
+    int i,stat,nput=0,nget=0;
+    
+    stat=solringinit(&ring,100);
+        assert(!stat);
+    stat=solringinit(&ring,64);
+        assert(stat&&ring.h->nrec==64&&ring.h->size==sizeof(solrec_t));
+    
+    stat=pthread_create(&thread,NULL,putsols,&nput);
+        assert(!stat);
+    /* get solutions while putting and after putting */
+    for (i=0;i<NRINGSOL*2;i++) {
+        if (i==NRINGSOL) pthread_join(thread,NULL);
+        if (!solringget(&ring,&sol,&seq)) {
+            if (i>=NRINGSOL) break;
+            continue;
+        }
+        assert(nget==0||seq>prev);
+        assert(sol.time.time==(time_t)seq&&sol.rr[5]==seq+5.0);
+        assert(sol.stat==seq%7&&sol.ns==seq%50);
+        prev=seq;
+        nget++;
+    }
+    assert(nget==nput&&nput+(int)ring.h->over==NRINGSOL);
+    assert(ring.h->head==ring.h->tail&&ring.h->head==(uint32_t)nput);
+    solringfree(&ring);
+    
+    printf("%s utest3 : OK\n",__FILE__);
+}
+/* binary solution status versus text solution status */
+#define NLOOPSTAT   10          /* number of loops for overhead of status */
+
+static int cmpfile(const char *file1, const char *file2)
+{
+    FILE *fp1,*fp2;
+    int c1,c2;
+    
+    fp1=fopen(file1,"rb");
+    fp2=fopen(file2,"rb");
+        assert(fp1&&fp2);
+    do {
+        c1=fgetc(fp1); c2=fgetc(fp2);
+    } while (c1==c2&&c1!=EOF);
+    fclose(fp1);
+    fclose(fp2);
+    return c1==c2;
+}
+void utest4(void)
+{
+    const int modes[]={PMODE_DGPS,PMODE_KINEMA};
+    const char *file[]={"","utest_stat.stat","utest_statb.stat"};
+    const int level[]={0,2,SSTAT_BIN};
+    job_t *job;
+    solstatbuf_t buf1,buf2;
+    char *files[1];
+    double t[3],tt;
+    int i,j,k;
+    
+    job=(job_t *)malloc(sizeof(job_t));
+        assert(job);
+    
+    for (i=0;i<2;i++) {
+        /* best of interleaved runs of status levels */
+        for (j=0;j<3;j++) t[j]=1E9;
+        for (k=0;k<NLOOPSTAT;k++) for (j=0;j<3;j++) {
+            setjob(job,modes[i]);
+            job->stat=file[j];
+            job->level=level[j];
+            tt=prftick();
+            procjob(job);
+            tt=(prftick()-tt)*1E-6; if (tt<t[j]) t[j]=tt;
+                assert(job->n>0);
+        }
+        /* rendered binary status same as text status */
+        assert(convstat(file[2],"utest_statb.txt")==0);
+        assert(cmpfile(file[1],"utest_statb.txt"));
+        assert(convstat(file[1],"utest_statb.txt")==-2);
+        
+        files[0]=(char *)file[1];
+        assert(readsolstat(files,1,&buf1));
+        files[0]=(char *)file[2];
+        assert(readsolstat(files,1,&buf2));
+            assert(buf1.n==buf2.n);
+        for (k=0;k<buf1.n;k++) {
+            assert(fabs(timediff(buf1.data[k].time,buf2.data[k].time))<1E-3);
+            assert(buf1.data[k].sat==buf2.data[k].sat);
+            assert(buf1.data[k].frq==buf2.data[k].frq);
+            assert(buf1.data[k].flag==buf2.data[k].flag);
+            assert(buf1.data[k].lock==buf2.data[k].lock);
+            assert(fabs(buf1.data[k].resp-buf2.data[k].resp)<1E-4);
+        }
+        freesolstatbuf(&buf1);
+        freesolstatbuf(&buf2);
+        
+        printf("solution status: mode=%d time=%.4f s text=%+.1f%% bin=%+.1f%%\n",
+               modes[i],t[0],(t[1]/t[0]-1.0)*100.0,(t[2]/t[0]-1.0)*100.0);
+    }
+    remove(file[1]);
+    remove(file[2]);
+    remove("utest_statb.txt");
+    free(job);
+    
+    printf("%s utest4 : OK\n",__FILE__);
+}
+/* status snapshot with concurrent server and reader */
+#define FILESNAP    "../data/rcvraw/ubx_20080526.ubx"
+#define NLOOPSNAP   10          /* number of server runs */
+
+static rtksvr_t svr;
+static uint32_t snapend;        /* end flag of snapshot reader */
+
+/* check header and consistency of snapshot */
+static int chksnap(const svrsnap_t *snap)
+{
+    int i;
+    
+    if (snap->ver!=SNAPVER||snap->size!=sizeof(svrsnap_t)||
+        snap->maxobs!=MAXOBS||
+        snap->offobs!=offsetof(svrsnap_t,obs)||
+        snap->sizeobs!=sizeof(snapobs_t)||
+        snap->offsat!=offsetof(svrsnap_t,ssat)||
+        snap->offstr!=offsetof(svrsnap_t,strmsg)||
+        snap->offerr!=offsetof(svrsnap_t,errmsg)) return 0;
+    
+    /* fields written at start and end of update in same snapshot */
+    if (snap->sol.seq!=snap->seq||snap->nsat!=snap->obs[0].ns) return 0;
+    for (i=0;i<snap->nsat;i++) {
+        if (snap->ssat[i].sat!=snap->obs[0].sat[i]) return 0;
+    }
+    return 1;
+}
+static void *getsnaps(void *arg)
+{
+    svrsnap_t *snap=(svrsnap_t *)malloc(sizeof(svrsnap_t));
+    uint32_t prev=0;
+    int *nsnap=(int *)arg; /* {ok,no snapshot} */
+    
+        assert(snap);
+    while (!rtkloadacq(&snapend)) {
+        if (!rtksvrsnap(&svr,snap)) {
+            nsnap[1]++;
+            continue;
+        }
+        assert(chksnap(snap));
+        assert(snap->seq>=prev);
+        prev=snap->seq;
+        nsnap[0]++;
+    }
+    free(snap);
+    return NULL;
+}
+void utest5(void)
+{
+    int strs[8]={STR_FILE},formats[3]={STRFMT_UBX,STRFMT_RTCM2,STRFMT_RTCM2};
+    char *paths[8]={FILESNAP,"","","","","","",""};
+    char *rcvopts[3]={"","",""},*cmds[3]={0},errmsg[2048];
+    solopt_t solopt[2];
+    prcopt_t opt=prcopt_default;
+    thread_t thread;
+    svrsnap_t *snap;
+    svrsnap_t *p;
+    double pos[3]={0};
+    uint32_t seq;
+    int i,j,stat,inb,nsnap[2]={0};
+    
+    snap=(svrsnap_t *)malloc(sizeof(svrsnap_t));
+        assert(snap);
+    solopt[0]=solopt[1]=solopt_default;
+    
+    stat=rtksvrinit(&svr);
+        assert(stat);
+    stat=rtksvrsnap(&svr,snap);
+        assert(!stat); /* no snapshot before start */
+    
+    stat=pthread_create(&thread,NULL,getsnaps,nsnap);
+        assert(!stat);
+    
+    /* server runs reading raw data file while reading snapshots */
+    for (i=0;i<NLOOPSNAP;i++) {
+        stat=rtksvrstart(&svr,1,4096,strs,paths,formats,0,cmds,cmds,rcvopts,
+                         0,0,pos,&opt,solopt,NULL,errmsg);
+            assert(stat);
+        for (j=0;j<1000;j++) {
+            strsum(svr.stream,&inb,NULL,NULL,NULL);
+            if (inb>=262144) break;
+            sleepms(10);
+        }
+        rtksvrstop(&svr,cmds);
+            assert(j<1000);
+    }
+    rtkstorerel(&snapend,1);
+    pthread_join(thread,NULL);
+        assert(nsnap[0]>0);
+    
+    /* last snapshot after stop */
+    seq=svr.snapseq;
+        assert(seq>=(uint32_t)NLOOPSNAP*2);
+    stat=rtksvrsnap(&svr,snap);
+        assert(stat&&snap->seq==seq&&chksnap(snap));
+    
+    /* reject snapshot being written or overwritten */
+    p=svr.snap+(seq&1);
+    p->seq=0;
+    stat=rtksvrsnap(&svr,snap);
+        assert(!stat);
+    p->seq=seq+2;
+    stat=rtksvrsnap(&svr,snap);
+        assert(!stat);
+    p->seq=seq;
+    stat=rtksvrsnap(&svr,snap);
+        assert(stat&&snap->seq==seq);
+    
+    rtksvrfree(&svr);
+    free(snap);
+    
+    printf("status snapshot: seq=%u read=%d fail=%d\n",seq,nsnap[0],nsnap[1]);
+    printf("%s utest5 : OK\n",__FILE__);
+}
+int main(void)
+{
+    readdata();
+    utest1();
+    utest2();
+    utest3();
+    utest4();
+    utest5();
+    return 0;
+}
@@ -0,0 +1,292 @@
+/*------------------------------------------------------------------------------
+* rtklib unit test driver : in-process uncompress functions
+*
+* usage : t_uncomp [file ...]
+*         files are used for the benchmark of in-process stream uncompress
+*         versus uncompress by external commands (e.g. IGS station files of a
+*         day: *.crx.gz, *.??d.Z, *.rnx.gz, *.sp3.Z ...)
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <assert.h>
+#include "../../src/rtklib.h"
+
+#define DIR "../data/rinex/"
+
+/* compare uncompressed stream with file (trailing spaces ignored) -----------*/
+static int cmpfile(FILE *fp1, const char *file)
+{
+    FILE *fp2;
+    char buff1[1024],buff2[1024];
+    int n1,n2,nline=0;
+    
+    if (!(fp2=fopen(file,"r"))) return -1;
+    
+    for (;;) {
+        if (!fgets(buff1,sizeof(buff1),fp1)) *buff1='\0';
+        if (!fgets(buff2,sizeof(buff2),fp2)) *buff2='\0';
+        if (!*buff1&&!*buff2) break;
+        for (n1=(int)strlen(buff1);n1>0&&strchr(" \r\n",buff1[n1-1]);n1--) ;
+        for (n2=(int)strlen(buff2);n2>0&&strchr(" \r\n",buff2[n2-1]);n2--) ;
+        if (n1!=n2||strncmp(buff1,buff2,n1)) {
+            printf("line %d differs:\n%s%s",nline+1,buff1,buff2);
+            fclose(fp2);
+            return -1;
+        }
+        nline++;
+    }
+    fclose(fp2);
+    return nline;
+}
+/* copy file -----------------------------------------------------------------*/
+static int copyfile(const char *src, const char *dst)
+{
+    FILE *fp1,*fp2;
+    char buff[4096];
+    size_t n;
+    
+    if (!(fp1=fopen(src,"rb"))) return 0;
+    if (!(fp2=fopen(dst,"wb"))) {
+        fclose(fp1);
+        return 0;
+    }
+    while ((n=fread(buff,1,sizeof(buff),fp1))>0) fwrite(buff,1,n,fp2);
+    fclose(fp1);
+    fclose(fp2);
+    return 1;
+}
+/* read whole uncompressed stream (bytes) ------------------------------------*/
+static double readall(FILE *fp)
+{
+    char buff[65536];
+    double size=0.0;
+    size_t n;
+    
+    while ((n=fread(buff,1,sizeof(buff),fp))>0) size+=n;
+    return size;
+}
+/* openuncomp(), closeuncomp() */
+void utest1(void)
+{
+    char *file1=DIR "07590920.05o";
+    char *file2=DIR "07590920.05o.gz";
+    char *file3=DIR "30400920.05n.Z";
+    char *file4=DIR "30400920.05d";
+    char *file5=DIR "xxxxxxxx.05o.gz";
+    uncomp_t unc;
+    int stat;
+    
+    stat=openuncomp(file1,&unc);
+        assert(stat==0); /* not compressed */
+    stat=openuncomp(file5,&unc);
+        assert(stat<0); /* no file */
+    
+    stat=openuncomp(file2,&unc);
+        assert(stat==1);
+    stat=cmpfile(unc.fp,DIR "07590920.05o");
+        assert(stat>0);
+    stat=closeuncomp(&unc);
+        assert(stat==0);
+    
+    stat=openuncomp(file3,&unc);
+        assert(stat==1);
+    stat=cmpfile(unc.fp,DIR "30400920.05n");
+        assert(stat>0);
+    stat=closeuncomp(&unc);
+        assert(stat==0);
+    
+    stat=openuncomp(file4,&unc);
+        assert(stat==1);
+    stat=cmpfile(unc.fp,DIR "30400920.05o");
+        assert(stat>0);
+    stat=closeuncomp(&unc);
+        assert(stat==0);
+    
+    /* close before end of stream */
+    stat=openuncomp(file2,&unc);
+        assert(stat==1);
+    stat=closeuncomp(&unc);
+        assert(stat<=0);
+    
+    printf("%s utest1 : OK\n",__FILE__);
+}
+/* rtk_uncompress() */
+void utest2(void)
+{
+    char *file1=DIR "utest.05o.gz";
+    char *file2=DIR "utest.05d";
+    char uncfile[1024];
+    FILE *fp;
+    int stat;
+    
+    stat=rtk_uncompress(DIR "07590920.05o",uncfile);
+        assert(stat==0);
+    
+    stat=copyfile(DIR "07590920.05o.gz",file1);
+        assert(stat);
+    stat=rtk_uncompress(file1,uncfile);
+        assert(stat==1&&!strcmp(uncfile,DIR "utest.05o"));
+    fp=fopen(uncfile,"r");
+        assert(fp);
+    stat=cmpfile(fp,DIR "07590920.05o");
+        assert(stat>0);
+    fclose(fp);
+    remove(file1);
+    remove(uncfile);
+    
+    stat=copyfile(DIR "30400920.05d",file2);
+        assert(stat);
+    stat=rtk_uncompress(file2,uncfile);
+        assert(stat==1&&!strcmp(uncfile,DIR "utest.05o"));
+    fp=fopen(uncfile,"r");
+        assert(fp);
+    stat=cmpfile(fp,DIR "30400920.05o");
+        assert(stat>0);
+    fclose(fp);
+    remove(file2);
+    remove(uncfile);
+    
+    printf("%s utest2 : OK\n",__FILE__);
+}
+/* readrnx() with compressed files */
+void utest3(void)
+{
+    obs_t obs1={0},obs2={0};
+    nav_t nav1={0},nav2={0};
+    int i,stat;
+    
+    stat=readrnx(DIR "30400920.05o",1,"",&obs1,&nav1,NULL);
+        assert(stat==1);
+    stat=readrnx(DIR "30400920.05d",1,"",&obs2,&nav2,NULL);
+        assert(stat==1);
+        assert(obs1.n>0&&obs1.n==obs2.n);
+    for (i=0;i<obs1.n;i++) {
+        assert(timediff(obs1.data[i].time,obs2.data[i].time)==0.0);
+        assert(obs1.data[i].sat==obs2.data[i].sat);
+        assert(obs1.data[i].L[0]==obs2.data[i].L[0]);
+        assert(obs1.data[i].P[1]==obs2.data[i].P[1]);
+        assert(obs1.data[i].LLI[0]==obs2.data[i].LLI[0]);
+    }
+    stat=readrnx(DIR "30400920.05n"  ,1,"",&obs1,&nav1,NULL);
+        assert(stat==1);
+    stat=readrnx(DIR "30400920.05n.Z",1,"",&obs2,&nav2,NULL);
+        assert(stat==1);
+        assert(nav1.n>0&&nav1.n==nav2.n);
+    for (i=0;i<nav1.n;i++) {
+        assert(nav1.eph[i].sat==nav2.eph[i].sat);
+        assert(nav1.eph[i].A==nav2.eph[i].A);
+    }
+    free(obs1.data); free(obs2.data);
+    free(nav1.eph ); free(nav2.eph );
+    
+    printf("%s utest3 : OK\n",__FILE__);
+}
+/* benchmark in-process stream uncompress versus external commands */
+void utest4(int n, char **files)
+{
+    char *deffiles[]={
+        DIR "07590920.05o.gz",DIR "30400920.05n.Z",DIR "30400920.05d"
+    };
+    char cmd[2048],*tmpfile="utest_uncomp.tmp",*p;
+    uncomp_t unc;
+    FILE *fp;
+    double size,t1=0.0,t2=0.0,size1=0.0,size2=0.0;
+    uint32_t tick;
+    int i,stat;
+    
+    if (n<=0) {
+        n=3; files=deffiles;
+    }
+    for (i=0;i<n;i++) {
+        
+        /* in-process stream */
+        tick=tickget();
+        if ((stat=openuncomp(files[i],&unc))<=0) {
+            printf("%s: not compressed\n",files[i]);
+            continue;
+        }
+        size=readall(unc.fp);
+        closeuncomp(&unc);
+        t1+=(tickget()-tick)*1E-3;
+        size1+=size;
+        
+        /* external commands to temporary file (gzip and crx2rnx) */
+        p=strrchr(files[i],'.');
+        if (!strcmp(p,".gz")||!strcmp(p,".Z")) {
+            sprintf(cmd,"gzip -d -c \"%s\" %s> %s",files[i],
+                    strstr(files[i],"crx")||*(p-1)=='d'?"| crx2rnx ":"",
+                    tmpfile);
+        }
+        else sprintf(cmd,"crx2rnx < \"%s\" > %s",files[i],tmpfile);
+        
+        tick=tickget();
+        stat=system(cmd);
+        if (stat||!(fp=fopen(tmpfile,"r"))) {
+            remove(tmpfile);
+            continue;
+        }
+        size=readall(fp);
+        fclose(fp);
+        remove(tmpfile);
+        t2+=(tickget()-tick)*1E-3;
+        size2+=size;
+    }
+    printf("in-process : %10.0f bytes %7.3f s %8.1f MB/s\n",size1,t1,
+           t1>0.0?size1/t1*1E-6:0.0);
+    printf("external   : %10.0f bytes %7.3f s %8.1f MB/s\n",size2,t2,
+           t2>0.0?size2/t2*1E-6:0.0);
+    
+    printf("%s utest4 : OK\n",__FILE__);
+}
+/* CRINEX 3.0 in layout of RNX2CRX output (mixed systems, satellite out and
+   in, missing values, LLI/SSI flags set and cleared) */
+void utest5(void)
+{
+    char *file1=DIR "UTST00XXX_R_20210010000_03M_30S_MO.rnx";
+    char *file2=DIR "UTST00XXX_R_20210010000_03M_30S_MO.crx";
+    char *file3=DIR "UTST00XXX_R_20210010000_03M_30S_MO.crx.gz";
+    obs_t obs1={0},obs2={0};
+    uncomp_t unc;
+    int i,j,stat;
+    
+    stat=openuncomp(file2,&unc);
+        assert(stat==1);
+    stat=cmpfile(unc.fp,file1);
+        assert(stat==29);
+    stat=closeuncomp(&unc);
+        assert(stat==0);
+    
+    stat=openuncomp(file3,&unc);
+        assert(stat==1);
+    stat=cmpfile(unc.fp,file1);
+        assert(stat==29);
+    stat=closeuncomp(&unc);
+        assert(stat==0);
+    
+    stat=readrnx(file1,1,"",&obs1,NULL,NULL);
+        assert(stat==1);
+    stat=readrnx(file3,1,"",&obs2,NULL,NULL);
+        assert(stat==1);
+        assert(obs1.n==14&&obs1.n==obs2.n);
+    for (i=0;i<obs1.n;i++) {
+        assert(timediff(obs1.data[i].time,obs2.data[i].time)==0.0);
+        assert(obs1.data[i].sat==obs2.data[i].sat);
+        for (j=0;j<NFREQ;j++) {
+            assert(obs1.data[i].P[j]==obs2.data[i].P[j]);
+            assert(obs1.data[i].L[j]==obs2.data[i].L[j]);
+            assert(obs1.data[i].SNR[j]==obs2.data[i].SNR[j]);
+            assert(obs1.data[i].LLI[j]==obs2.data[i].LLI[j]);
+        }
+    }
+    free(obs1.data); free(obs2.data);
+    
+    printf("%s utest5 : OK\n",__FILE__);
+}
+int main(int argc, char **argv)
+{
+    utest1();
+    utest2();
+    utest3();
+    utest5();
+    utest4(argc-1,argv+1);
+    return 0;
+}
@@ -49,6 +49,8 @@ static struct {
    jfieldID tropopt;
    jfieldID dynamics;
    jfieldID tidecorr;
+   jfieldID tideint;
+   jfieldID prof;
    jfieldID niter;
    jfieldID codesmooth;
    jfieldID intpref;
@@ -212,6 +214,8 @@ void processing_options2prcopt_t(JNIEnv* env, jobject thiz, prcopt_t *dst)
    GET_FIELD(tropopt, Int)
    GET_FIELD(dynamics, Int)
    GET_FIELD(tidecorr, Int)
+   GET_FIELD(tideint, Double)
+   GET_FIELD(prof, Int)
    GET_FIELD(niter, Int)
    GET_FIELD(codesmooth, Int)
    GET_FIELD(intpref, Int)
@@ -375,6 +379,8 @@ static void ProcessingOptions_load_defaults(JNIEnv* env, jobject thiz)
    SET_FIELD(tropopt, Int)
    SET_FIELD(dynamics, Int)
    SET_FIELD(tidecorr, Int)
+   SET_FIELD(tideint, Double)
+   SET_FIELD(prof, Int)
    SET_FIELD(niter, Int)
    SET_FIELD(codesmooth, Int)
    SET_FIELD(intpref, Int)
@@ -543,6 +549,8 @@ static int init_prcopt_fields_methods(JNIEnv* env, jclass clazz)
    INIT_FIELD(tropopt, "I")
    INIT_FIELD(dynamics, "I")
    INIT_FIELD(tidecorr, "I")
+   INIT_FIELD(tideint, "D")
+   INIT_FIELD(prof, "I")
    INIT_FIELD(niter, "I")
    INIT_FIELD(codesmooth, "I")
    INIT_FIELD(intpref, "I")
@@ -8,6 +8,10 @@
 #define TAG "nativeRtkCommion"
 #define LOGV(...) showmsg(__VA_ARGS__)
 
+static geoid_t ext_geoid;              /* external geoid model context */
+static char ext_geoid_file[1024];      /* external geoid model file */
+static lock_t ext_geoid_lock;          /* lock for external geoid model */
+
 static jobject RtkCommon_get_sat_id(JNIEnv* env, jclass clazz, jint sat_no)
 {
    char sat_id[16];
@@ -63,21 +67,73 @@ static jdouble RtkCommon_geoidh(JNIEnv* env, jclass clazz, jdouble j_lat, jdoubl
    return (jdouble)geoidh(pos);
 }
 
+/* geoid heights by external geoid model kept open between calls */
+static void ext_geoidh(int model, const char *filename, const double *pos, int n, double *h)
+{
+   lock(&ext_geoid_lock);
+   if (ext_geoid.model != model || strcmp(ext_geoid_file, filename)) {
+      closegeoid_ctx(&ext_geoid);
+      if (!opengeoid_ctx(&ext_geoid, model, filename)) {
+	 LOGV("geoid model open error: model=%d file=%s", model, filename);
+      }
+      strncpy(ext_geoid_file, filename, sizeof(ext_geoid_file)-1);
+   }
+   geoidh_batch_ctx(&ext_geoid, pos, n, h);
+   unlock(&ext_geoid_lock);
+}
+
 static jdouble RtkCommon_geoidh_from_external_model(JNIEnv* env, jclass clazz, jdouble j_lat, jdouble j_lon, jint model, jstring geoid_filename)
 {
    double pos[2] = {j_lat, j_lon};
+   double h;
    const char *filename = (*env)->GetStringUTFChars(env, geoid_filename, 0);
-   if (model != GEOID_EMBEDDED)
-   {
-	   int r = opengeoid(model,filename);
+
+   ext_geoidh(model, filename, pos, 1, &h);
+   (*env)->ReleaseStringUTFChars(env,geoid_filename, filename);
+   return (jdouble)h;
+}
+
+static jdoubleArray RtkCommon_geoidh_batch_from_external_model(JNIEnv* env, jclass clazz, jdoubleArray j_lat, jdoubleArray j_lon, jint model, jstring geoid_filename)
+{
+   jdoubleArray j_h;
+   jdouble *lat, *lon;
+   double *pos, *h;
+   const char *filename;
+   int i, n;
+
+   n = (*env)->GetArrayLength(env, j_lat);
+   if ((*env)->GetArrayLength(env, j_lon) != n)
+      return NULL;
+   if ((j_h = (*env)->NewDoubleArray(env, n)) == NULL || n <= 0)
+      return j_h;
+
+   pos = (double *)malloc(sizeof(double) * n * 3);
+   if (pos == NULL)
+      return NULL;
+   h = pos + n * 2;
+
+   lat = (*env)->GetPrimitiveArrayCritical(env, j_lat, NULL);
+   lon = (*env)->GetPrimitiveArrayCritical(env, j_lon, NULL);
+   if (lat != NULL && lon != NULL) {
+      for (i = 0; i < n; i++) {
+	 pos[i*2] = lat[i];
+	 pos[i*2+1] = lon[i];
+      }
    }
-   jdouble correction = (jdouble)geoidh(pos);
-   if (model != GEOID_EMBEDDED)
-   {
-	   closegeoid();
+   if (lon != NULL) (*env)->ReleasePrimitiveArrayCritical(env, j_lon, lon, JNI_ABORT);
+   if (lat != NULL) (*env)->ReleasePrimitiveArrayCritical(env, j_lat, lat, JNI_ABORT);
+   if (lat == NULL || lon == NULL) {
+      free(pos);
+      return NULL;
    }
-   (*env)->ReleaseStringUTFChars(env,geoid_filename, filename);
-   return correction;
+
+   filename = (*env)->GetStringUTFChars(env, geoid_filename, 0);
+   ext_geoidh(model, filename, pos, n, h);
+   (*env)->ReleaseStringUTFChars(env, geoid_filename, filename);
+
+   (*env)->SetDoubleArrayRegion(env, j_h, 0, n, h);
+   free(pos);
+   return j_h;
 }
 
 static void RtkCommon__ecef2pos(JNIEnv* env, jclass clazz, jdouble x,
@@ -129,6 +185,88 @@ static void RtkCommon__covenu(JNIEnv* env, jclass clazz, jdouble j_lat,
    (*env)->SetDoubleArrayRegion(env, j_Q, 0, 9, Q);
 }
 
+/* transformations of structure of arrays (see RtkCommon.TRANSFORM_*) */
+#define TRANSFORM_ECEF2POS 0
+#define TRANSFORM_POS2ECEF 1
+#define TRANSFORM_ECEF2ENU 2
+#define TRANSFORM_COVENU   3
+
+static const int transform_nin[] = {3, 3, 5, 8};  /* src arrays per op */
+static const int transform_nout[] = {3, 3, 3, 6}; /* dst arrays per op */
+
+static void transform_soa(int op, const double *in, double *out, int n)
+{
+   switch (op) {
+      case TRANSFORM_ECEF2POS:
+	 ecef2pos_batch(in, in+n, in+2*n, n, out, out+n, out+2*n);
+	 break;
+      case TRANSFORM_POS2ECEF:
+	 pos2ecef_batch(in, in+n, in+2*n, n, out, out+n, out+2*n);
+	 break;
+      case TRANSFORM_ECEF2ENU:
+	 ecef2enu_batch(in, in+n, in+2*n, in+3*n, in+4*n, n, out, out+n, out+2*n);
+	 break;
+      case TRANSFORM_COVENU:
+	 covenu_batch(in, in+n, in+2*n, n, out);
+	 break;
+   }
+}
+
+static void throw_illegal_argument(JNIEnv* env, const char *msg)
+{
+   (*env)->ThrowNew(env, (*env)->FindClass(env, "java/lang/IllegalArgumentException"), msg);
+}
+
+static void RtkCommon__transform_array(JNIEnv* env, jclass clazz, jint op,
+      jdoubleArray j_src, jdoubleArray j_dst, jint n)
+{
+   double *src, *dst;
+
+   if (op < 0 || op > TRANSFORM_COVENU || n < 0
+	 || (*env)->IsSameObject(env, j_src, j_dst)
+	 || (*env)->GetArrayLength(env, j_src) < transform_nin[op] * n
+	 || (*env)->GetArrayLength(env, j_dst) < transform_nout[op] * n) {
+      throw_illegal_argument(env, "invalid transform arrays");
+      return;
+   }
+   if (n == 0)
+      return;
+
+   /* no copy of whole tracks: arrays pinned during the computation */
+   src = (*env)->GetPrimitiveArrayCritical(env, j_src, NULL);
+   if (src == NULL)
+      return;
+   dst = (*env)->GetPrimitiveArrayCritical(env, j_dst, NULL);
+   if (dst == NULL) {
+      (*env)->ReleasePrimitiveArrayCritical(env, j_src, src, JNI_ABORT);
+      return;
+   }
+   transform_soa(op, src, dst, n);
+   (*env)->ReleasePrimitiveArrayCritical(env, j_dst, dst, 0);
+   (*env)->ReleasePrimitiveArrayCritical(env, j_src, src, JNI_ABORT);
+}
+
+static void RtkCommon__transform_buffer(JNIEnv* env, jclass clazz, jint op,
+      jobject j_src, jobject j_dst, jint n)
+{
+   double *src, *dst;
+
+   if (op < 0 || op > TRANSFORM_COVENU || n < 0) {
+      throw_illegal_argument(env, "invalid transform");
+      return;
+   }
+   src = (*env)->GetDirectBufferAddress(env, j_src);
+   dst = (*env)->GetDirectBufferAddress(env, j_dst);
+   if (src == NULL || dst == NULL
+	 || (*env)->GetDirectBufferCapacity(env, j_src) < (jlong)sizeof(double) * transform_nin[op] * n
+	 || (*env)->GetDirectBufferCapacity(env, j_dst) < (jlong)sizeof(double) * transform_nout[op] * n
+	 || (n > 0 && src < dst + transform_nout[op] * n && dst < src + transform_nin[op] * n)) {
+      throw_illegal_argument(env, "invalid transform buffers");
+      return;
+   }
+   transform_soa(op, src, dst, n);
+}
+
 static void RtkCommon__deg2dms(JNIEnv* env, jclass clazz, jdouble j_deg,
       jdoubleArray j_dst)
 {
@@ -211,12 +349,15 @@ static JNINativeMethod nativeMethods[] = {
    {"closegeoid", "()V",(void*)RtkCommon_closegeoid},
    {"geoidh", "(DD)D", (void*)RtkCommon_geoidh},
    {"geoidh_from_external_model","(DDILjava/lang/String;)D",(void*)RtkCommon_geoidh_from_external_model},
+   {"geoidh_batch_from_external_model","([D[DILjava/lang/String;)[D",(void*)RtkCommon_geoidh_batch_from_external_model},
    {"_deg2dms", "(D[D)V", (void*)RtkCommon__deg2dms},
    {"norm", "([D)D", (void*)RtkCommon_norm},
    {"_ecef2pos", "(DDD[D)V", (void*)RtkCommon__ecef2pos},
    {"_ecef2enu", "(DD[D[D)V", (void*)RtkCommon__ecef2enu},
    {"_pos2ecef", "(DDD[D)V", (void*)RtkCommon__pos2ecef},
    {"_covenu", "(DD[D[D)V", (void*)RtkCommon__covenu},
+   {"_transform_array", "(I[D[DI)V", (void*)RtkCommon__transform_array},
+   {"_transform_buffer", "(ILjava/nio/ByteBuffer;Ljava/nio/ByteBuffer;I)V", (void*)RtkCommon__transform_buffer},
    {"_reppath", "(Ljava/lang/String;JLjava/lang/String;Ljava/lang/String;)Ljava/lang/String;",(void*)RtkCommon_reppath},
    {"_getantlist", "(Ljava/lang/String;)[Ljava/lang/String;", (void*)RtkCommon_getantlist}
 };
@@ -230,6 +371,8 @@ int registerRtkCommonNatives(JNIEnv* env) {
     if (clazz == NULL)
        return JNI_FALSE;
 
+    initlock(&ext_geoid_lock);
+
     if ((*env)->RegisterNatives(env, clazz, nativeMethods, sizeof(nativeMethods)
 	     / sizeof(nativeMethods[0])) != JNI_OK)
        return JNI_FALSE;
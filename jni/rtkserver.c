@@ -11,18 +11,6 @@
 
 static jfieldID m_object_field;
 
-static struct {
-   jfieldID ns;
-   jfieldID time;
-   jfieldID sat;
-   jfieldID az;
-   jfieldID el;
-   jfieldID freq1_snr;
-   jfieldID freq2_snr;
-   jfieldID freq3_snr;
-   jfieldID vsat;
-} obs_status_fields;
-
 struct native_ctx_t {
    rtksvr_t rtksvr;                        // rtk server struct
    stream_t monistr;                       // monitor stream
@@ -345,126 +333,6 @@ static jboolean open_solution_status_file(JNIEnv* env, int level, gtime_t timest
    return JNI_TRUE;
 }
 
-static void RtkServer__get_stream_status(JNIEnv* env, jclass thiz, jobject status_obj)
-{
-   struct native_ctx_t *nctx;
-   jmethodID set_status_mid;
-   jstring jmsg;
-   int sstat[MAXSTRRTK];
-   char msg[MAXSTRMSG] = {0,};
-
-   nctx = (struct native_ctx_t *)(uintptr_t)(*env)->GetLongField(env, thiz, m_object_field);
-   if (nctx == NULL) {
-      LOGV("nctx is null");
-      return;
-   }
-
-   set_status_mid = (*env)->GetMethodID(env,
-	 (*env)->GetObjectClass(env, status_obj),
-	 "setStatus",
-	 "(IIIIIIIILjava/lang/String;)V");
-   if (set_status_mid == NULL) {
-      LOGV("setStatus() not found");
-      return;
-   }
-
-   rtksvrsstat(&nctx->rtksvr, sstat, msg);
-
-   jmsg = (*env)->NewStringUTF(env, msg);
-   if (jmsg == NULL)
-      return;
-
-   (*env)->CallVoidMethod(env, status_obj, set_status_mid,
-	 (jint)sstat[0], (jint)sstat[1], (jint)sstat[2],
-	 (jint)sstat[3], (jint)sstat[4], (jint)sstat[5],
-	 (jint)sstat[6], (jint)sstat[7],
-	 jmsg);
-
-}
-
-static void RtkServer__get_observation_status(JNIEnv* env, jclass thiz,
-      jint receiver, jobject status_obj)
-{
-   struct native_ctx_t *nctx;
-   jobject jgtime, jtmp;
-   int ns;
-   int i;
-   jint *jsnr;
-   gtime_t time;
-   int sat[MAXSAT];
-   int vsat[MAXSAT];
-   double az[MAXSAT];
-   double el[MAXSAT];
-   int *snr0[MAXSAT];
-   int snr[MAXSAT][NFREQ];
-
-   nctx = (struct native_ctx_t *)(uintptr_t)(*env)->GetLongField(env, thiz, m_object_field);
-   if (nctx == NULL) {
-      LOGV("nctx is null");
-      return;
-   }
-
-   for (i=0;i<MAXSAT;i++) {
-      snr0[i]=snr[i];
-   }
-
-   ns = rtksvrostat(&nctx->rtksvr, receiver,
-	 &time, sat, az, el, snr0, vsat);
-
-   if (ns > MAXSAT)
-      ns = MAXSAT;
-
-   // Set number of satellites
-   (*env)->SetIntField(env, status_obj, obs_status_fields.ns, ns);
-
-   if (ns == 0)
-      return;
-
-   // Set time
-   jgtime = (*env)->GetObjectField(env, status_obj, obs_status_fields.time);
-   if (jgtime == NULL) {
-      LOGV("time is null");
-   }
-   set_gtime(env, jgtime, time);
-
-   // Satellite data
-   jtmp = (*env)->GetObjectField(env, status_obj, obs_status_fields.sat);
-   (*env)->SetIntArrayRegion(env, jtmp, 0, ns, sat);
-
-   jtmp = (*env)->GetObjectField(env, status_obj, obs_status_fields.az);
-   (*env)->SetDoubleArrayRegion(env, jtmp, 0, ns, az);
-
-   jtmp = (*env)->GetObjectField(env, status_obj, obs_status_fields.el);
-   (*env)->SetDoubleArrayRegion(env, jtmp, 0, ns, el);
-
-   // freq1 snr
-   jtmp = (*env)->GetObjectField(env, status_obj, obs_status_fields.freq1_snr);
-   jsnr = (*env)->GetIntArrayElements(env, jtmp, NULL);
-   if (jsnr != NULL) {
-      for (i=0; i<ns; ++i) jsnr[i] = snr[i][0];
-      (*env)->ReleaseIntArrayElements(env, jtmp, jsnr, 0);
-   }
-
-   jtmp = (*env)->GetObjectField(env, status_obj, obs_status_fields.freq2_snr);
-   jsnr = (*env)->GetIntArrayElements(env, jtmp, NULL);
-   if (jsnr != NULL) {
-      for (i=0; i<ns; ++i) jsnr[i] = snr[i][1];
-      (*env)->ReleaseIntArrayElements(env, jtmp, jsnr, 0);
-   }
-
-   jtmp = (*env)->GetObjectField(env, status_obj, obs_status_fields.freq3_snr);
-   jsnr = (*env)->GetIntArrayElements(env, jtmp, NULL);
-   if (jsnr != NULL) {
-      for (i=0; i<ns; ++i) jsnr[i] = snr[i][2];
-      (*env)->ReleaseIntArrayElements(env, jtmp, jsnr, 0);
-   }
-
-   // vsat
-   jtmp = (*env)->GetObjectField(env, status_obj, obs_status_fields.vsat);
-   (*env)->SetIntArrayRegion(env, jtmp, 0, ns, vsat);
-
-}
-
 static void RtkServer__write_commands(JNIEnv* env, jclass thiz,
         jobjectArray j_cmds)
 {
@@ -508,167 +376,111 @@ write_commands_end:
 }
 
 
-static int set_solution_buffer(JNIEnv* env, jobject j_solbuf, const sol_t *solutions, int cnt)
+static solring_t *get_solution_ring(JNIEnv* env, jobject thiz)
 {
-   int i;
-   static jfieldID m_n_sol_field = NULL;
-   static jmethodID set_solution_method = NULL;
-
-   if (m_n_sol_field == NULL) {
-      jobject claz = (*env)->GetObjectClass(env, j_solbuf);
-      m_n_sol_field = (*env)->GetFieldID(env, claz, "mNSol", "I");
-      if (m_n_sol_field == NULL) {
-	 LOGV("SolutionBuffer$mNSol field not found");
-	 return -1;
-      }
-      set_solution_method = (*env)->GetMethodID(env,
-	    claz,
-	    "setSolution",
-	    "(IJDIIIFFDDDDDDFFFFFFDDDDDD)V"
-	    );
-      if (set_solution_method == NULL) {
-	 LOGV("setSolution() not found");
-	 return -1;
-      }
-   }
+   struct native_ctx_t *nctx;
 
-   for (i=0; i<cnt; ++i) {
-      const sol_t *s = &solutions[i];
-      (*env)->CallVoidMethod(env, j_solbuf, set_solution_method,
-	    i,
-	    (jlong)s->time.time,
-	    (jdouble)s->time.sec,
-	    (jint)s->type,
-	    (jint)s->stat,
-	    (jint)s->ns,
-	    (jfloat)s->age,
-	    (jfloat)s->ratio,
-	    (jdouble)s->rr[0], (jdouble)s->rr[1], (jdouble)s->rr[2],
-	    (jdouble)s->rr[3], (jdouble)s->rr[4], (jdouble)s->rr[5],
-	    (jfloat)s->qr[0], (jfloat)s->qr[1], (jfloat)s->qr[2],
-	    (jfloat)s->qr[3], (jfloat)s->qr[4], (jfloat)s->qr[5],
-	    (jdouble)s->dtr[0], (jdouble)s->dtr[1], (jdouble)s->dtr[2],
-	    (jdouble)s->dtr[3], (jdouble)s->dtr[4], (jdouble)s->dtr[5]
-	    );
+   nctx = (struct native_ctx_t *)(uintptr_t)(*env)->GetLongField(env, thiz, m_object_field);
+   if (nctx == NULL) {
+      LOGV("nctx is null");
+      return NULL;
    }
+   return nctx->rtksvr.solring.h != NULL ? &nctx->rtksvr.solring : NULL;
+}
+
+/* solution ring memory shared with java (records read without JNI upcalls) */
+static jobject RtkServer__get_solution_ring(JNIEnv* env, jobject thiz)
+{
+   solring_t *ring;
 
-   (*env)->SetIntField(env, j_solbuf, m_n_sol_field, cnt);
+   if ((ring = get_solution_ring(env, thiz)) == NULL)
+      return NULL;
+   return (*env)->NewDirectByteBuffer(env, ring->buff, ring->size);
+}
+
+/* number of written records, acquire to see the records before head */
+static jint RtkServer__get_solution_ring_head(JNIEnv* env, jobject thiz)
+{
+   solring_t *ring;
 
-   return cnt;
+   if ((ring = get_solution_ring(env, thiz)) == NULL)
+      return 0;
+   return (jint)rtkloadacq(&ring->h->head);
 }
 
-static void RtkServer__read_solution_buffer(JNIEnv* env, jclass thiz,
-      jobject j_solbuf)
+/* number of read records, release to return the records before tail */
+static void RtkServer__set_solution_ring_tail(JNIEnv* env, jobject thiz, jint tail)
+{
+   solring_t *ring;
+
+   if ((ring = get_solution_ring(env, thiz)) == NULL)
+      return;
+   rtkstorerel(&ring->h->tail, (uint32_t)tail);
+}
+
+/* copy the last status snapshot to direct buffer, returns sequence (0:none) */
+static jint RtkServer__get_status_snapshot(JNIEnv* env, jobject thiz, jobject j_buf)
 {
    struct native_ctx_t *nctx;
+   svrsnap_t snap;
+   void *buf;
 
    nctx = (struct native_ctx_t *)(uintptr_t)(*env)->GetLongField(env, thiz, m_object_field);
    if (nctx == NULL) {
       LOGV("nctx is null");
-      return;
+      return 0;
    }
 
-   rtksvrlock(&nctx->rtksvr);
-   set_solution_buffer(env, j_solbuf, nctx->rtksvr.solbuf, nctx->rtksvr.nsol);
-   nctx->rtksvr.nsol=0;
-   rtksvrunlock(&nctx->rtksvr);
-}
-
-static int set_rtk_status(JNIEnv* env, jobject j_rtk_control_result, rtk_t *status)
-{
-   static jfieldID sol_field_id = NULL;
-   static jmethodID set_solution_method_id = NULL;
-   static jmethodID set_status_method_id = NULL;
-   jobject sol_obj;
-
-   if (sol_field_id == NULL) {
-      jobject claz = (*env)->GetObjectClass(env, j_rtk_control_result);
-      sol_field_id = (*env)->GetFieldID(env, claz, "sol", "Lgpsplus/rtklib/Solution;");
-      if (sol_field_id == NULL) {
-	 LOGV("Solution field not found");
-	 return -1;
-      }
-   }
-   if (set_status_method_id == NULL) {
-      jobject claz = (*env)->GetObjectClass(env, j_rtk_control_result);
-      set_status_method_id = (*env)->GetMethodID(env,
-	    claz,
-	    "setStatus1",
-	    "(DDDDDDIIDILjava/lang/String;)V"
-	    );
-      if (set_status_method_id == NULL) {
-	 LOGV("setStatus1() not found");
-	 return -1;
-      }
+   buf = (*env)->GetDirectBufferAddress(env, j_buf);
+   if ((buf == NULL)
+	 || ((*env)->GetDirectBufferCapacity(env, j_buf) < (jlong)sizeof(svrsnap_t))) {
+      LOGV("invalid status snapshot buffer");
+      return 0;
    }
 
-   sol_obj = (*env)->GetObjectField(env, j_rtk_control_result, sol_field_id);
-
-   if (set_solution_method_id == NULL) {
-      jobject claz = (*env)->GetObjectClass(env, sol_obj);
-      set_solution_method_id = (*env)->GetMethodID(env,
-	    claz,
-	    "setSolution",
-	    "(JDIIIFFDDDDDDFFFFFFDDDDDD)V"
-	    );
-      if (set_solution_method_id == NULL) {
-	 LOGV("setSolution() not found");
-	 return -1;
-      }
-   }
+   /* copy via stack as the java buffer may not be aligned for svrsnap_t */
+   if (!rtksvrsnap(&nctx->rtksvr, &snap))
+      return 0;
+   memcpy(buf, &snap, sizeof(snap));
 
-   // solution
-   (*env)->CallVoidMethod(env, sol_obj, set_solution_method_id,
-	 (jlong)status->sol.time.time,
-	 (jdouble)status->sol.time.sec,
-	 (jint)status->sol.type,
-	 (jint)status->sol.stat,
-	 (jint)status->sol.ns,
-	 (jfloat)status->sol.age,
-	 (jfloat)status->sol.ratio,
-	 (jdouble)status->sol.rr[0], (jdouble)status->sol.rr[1], (jdouble)status->sol.rr[2],
-	 (jdouble)status->sol.rr[3], (jdouble)status->sol.rr[4], (jdouble)status->sol.rr[5],
-	 (jfloat)status->sol.qr[0], (jfloat)status->sol.qr[1], (jfloat)status->sol.qr[2],
-	 (jfloat)status->sol.qr[3], (jfloat)status->sol.qr[4], (jfloat)status->sol.qr[5],
-	 (jdouble)status->sol.dtr[0], (jdouble)status->sol.dtr[1], (jdouble)status->sol.dtr[2],
-	 (jdouble)status->sol.dtr[3], (jdouble)status->sol.dtr[4], (jdouble)status->sol.dtr[5]
-	 );
-
-   // RTK fields
-   {
-      jstring errmsg;
-      if (status->neb == 0) {
-	 errmsg = (*env)->NewStringUTF(env, "");
-      }else {
-	 status->errbuf[status->neb-1] = '\0';
-	 errmsg = (*env)->NewStringUTF(env, status->errbuf);
-      }
-      if (errmsg == NULL)
-	 return -1;
-
-      (*env)->CallVoidMethod(env, j_rtk_control_result, set_status_method_id,
-	 (jdouble)status->rb[0], (jdouble)status->rb[1], (jdouble)status->rb[2],
-	 (jdouble)status->rb[3], (jdouble)status->rb[4], (jdouble)status->rb[5],
-	 status->nx, status->na, (jdouble)status->tt, status->nfix,
-	 errmsg);
-   }
+   return (jint)snap.seq;
+}
 
-   return 0;
+static jint RtkServer__get_status_snapshot_size(JNIEnv* env, jclass clazz)
+{
+   return (jint)sizeof(svrsnap_t);
 }
 
-static void RtkServer__get_rtk_status(JNIEnv* env, jclass thiz, jobject j_rtk_control_result)
+/* copy the stage profile to direct buffer, returns profiling enabled */
+static jboolean RtkServer__get_stage_profile(JNIEnv* env, jobject thiz, jobject j_buf, jboolean reset)
 {
    struct native_ctx_t *nctx;
+   prof_t prof;
+   void *buf;
+   int stat;
 
    nctx = (struct native_ctx_t *)(uintptr_t)(*env)->GetLongField(env, thiz, m_object_field);
    if (nctx == NULL) {
       LOGV("nctx is null");
-      return;
+      return JNI_FALSE;
    }
 
-   rtksvrlock(&nctx->rtksvr);
-   set_rtk_status(env, j_rtk_control_result, &nctx->rtksvr.rtk);
-   rtksvrunlock(&nctx->rtksvr);
+   buf = (*env)->GetDirectBufferAddress(env, j_buf);
+   if ((buf == NULL)
+	 || ((*env)->GetDirectBufferCapacity(env, j_buf) < (jlong)sizeof(prof_t))) {
+      LOGV("invalid stage profile buffer");
+      return JNI_FALSE;
+   }
+
+   stat = rtksvrpstat(&nctx->rtksvr, &prof, reset ? 1 : 0);
+   memcpy(buf, &prof, sizeof(prof));
+
+   return stat ? JNI_TRUE : JNI_FALSE;
+}
+
+static jint RtkServer__get_stage_profile_size(JNIEnv* env, jclass clazz)
+{
+   return (jint)sizeof(prof_t);
 }
 
 static void RtkServer__readsp3(JNIEnv* env, jclass thiz, jstring file)
@@ -694,8 +506,11 @@ static void RtkServer__readsp3(JNIEnv* env, jclass thiz, jstring file)
 	svr = &nctx->rtksvr;
 	rtksvrlock(svr);
     if (svr->nav.peph) free(svr->nav.peph);
+    if (svr->nav.pfit) free(svr->nav.pfit);
     svr->nav.ne=svr->nav.nemax=nav.ne;
     svr->nav.peph=nav.peph;
+    svr->nav.nf=nav.nf;
+    svr->nav.pfit=nav.pfit;
 
 	rtksvrunlock(svr);
 	(*env)->ReleaseStringUTFChars(env,file, filename);
@@ -749,57 +564,18 @@ static JNINativeMethod nativeMethods[] = {
 	 ")Z"
 	 , (void*)RtkServer__rtksvrstart},
    {"_stop", "([Ljava/lang/String;)V", (void*)RtkServer__stop},
-   {"_getStreamStatus", "(Lgpsplus/rtklib/RtkServerStreamStatus;)V", (void*)RtkServer__get_stream_status},
-   {"_readSolutionBuffer", "(Lgpsplus/rtklib/Solution$SolutionBuffer;)V", (void*)RtkServer__read_solution_buffer},
-   {"_getRtkStatus", "(Lgpsplus/rtklib/RtkControlResult;)V", (void*)RtkServer__get_rtk_status},
-   {"_getObservationStatus", "(ILgpsplus/rtklib/RtkServerObservationStatus$Native;)V", (void*)RtkServer__get_observation_status},
+   {"_getStatusSnapshot", "(Ljava/nio/ByteBuffer;)I", (void*)RtkServer__get_status_snapshot},
+   {"_getStatusSnapshotSize", "()I", (void*)RtkServer__get_status_snapshot_size},
+   {"_getStageProfile", "(Ljava/nio/ByteBuffer;Z)Z", (void*)RtkServer__get_stage_profile},
+   {"_getStageProfileSize", "()I", (void*)RtkServer__get_stage_profile_size},
+   {"_getSolutionRing", "()Ljava/nio/ByteBuffer;", (void*)RtkServer__get_solution_ring},
+   {"_getSolutionRingHead", "()I", (void*)RtkServer__get_solution_ring_head},
+   {"_setSolutionRingTail", "(I)V", (void*)RtkServer__set_solution_ring_tail},
    {"_writeCommands", "([Ljava/lang/String;)V", (void*)RtkServer__write_commands},
    {"_readsp3","(Ljava/lang/String;)V", (void*)RtkServer__readsp3},
    {"_readsatant","(Ljava/lang/String;)V", (void*)RtkServer__readsatant}
 };
 
-static int init_observation_status_fields(JNIEnv* env) {
-    jclass clazz = (*env)->FindClass(env, "gpsplus/rtklib/RtkServerObservationStatus$Native");
-
-    if (clazz == NULL)
-       return JNI_FALSE;
-
-    obs_status_fields.ns = (*env)->GetFieldID(env, clazz, "ns", "I");
-    obs_status_fields.time = (*env)->GetFieldID(env, clazz, "time", "Lgpsplus/rtklib/GTime;");
-    obs_status_fields.sat = (*env)->GetFieldID(env, clazz, "sat", "[I");
-    obs_status_fields.az = (*env)->GetFieldID(env, clazz, "az", "[D");
-    obs_status_fields.el = (*env)->GetFieldID(env, clazz, "el", "[D");
-    obs_status_fields.freq1_snr = (*env)->GetFieldID(env, clazz, "freq1Snr", "[I");
-    obs_status_fields.freq2_snr = (*env)->GetFieldID(env, clazz, "freq2Snr", "[I");
-    obs_status_fields.freq3_snr = (*env)->GetFieldID(env, clazz, "freq3Snr", "[I");
-    obs_status_fields.vsat = (*env)->GetFieldID(env, clazz, "vsat", "[I");
-
-    if ((obs_status_fields.ns == NULL)
-	  || (obs_status_fields.time == NULL)
-	  || (obs_status_fields.sat == NULL)
-	  || (obs_status_fields.az == NULL)
-	  || (obs_status_fields.el == NULL)
-	  || (obs_status_fields.freq1_snr == NULL)
-	  || (obs_status_fields.freq2_snr == NULL)
-	  || (obs_status_fields.freq3_snr == NULL)
-	  || (obs_status_fields.vsat == NULL)) {
-       LOGV("gpsplus/rtklib/RtkServerObservationStatus fields not found:%s%s%s%s%s%s%s%s%s",
-	     (obs_status_fields.ns == NULL ? " ns" : ""),
-	     (obs_status_fields.time == NULL ? " time" : ""),
-	     (obs_status_fields.sat == NULL ? " sat" : ""),
-	     (obs_status_fields.az == NULL ? " az" : ""),
-	     (obs_status_fields.el == NULL ? " el" : ""),
-	     (obs_status_fields.freq1_snr == NULL ? " freq1_snr " : ""),
-	     (obs_status_fields.freq2_snr == NULL ? " freq2_snr " : ""),
-	     (obs_status_fields.freq3_snr == NULL ? " freq3_snr " : ""),
-	     (obs_status_fields.vsat == NULL ? " vsat" : "")
-	     );
-       return JNI_FALSE;
-    }
-
-    return JNI_TRUE;
-}
-
 int registerRtkServerNatives(JNIEnv* env) {
     /* look up the class */
     jclass clazz = (*env)->FindClass(env, "gpsplus/rtklib/RtkServer");
@@ -815,9 +591,6 @@ int registerRtkServerNatives(JNIEnv* env) {
     if (m_object_field == NULL)
        return JNI_FALSE;
 
-    if ( ! init_observation_status_fields(env))
-       return JNI_FALSE;
-
     return JNI_TRUE;
 }
 
@@ -47,7 +47,8 @@ public class OutputSolution1Fragment extends PreferenceFragment {
         SolutionFormat.LLH,
         SolutionFormat.XYZ,
         SolutionFormat.ENU,
-        SolutionFormat.NMEA
+        SolutionFormat.NMEA,
+        SolutionFormat.BIN
     };
 
     private static final SolutionFormat DEFAULT_SOLUTION_FORMAT = SolutionFormat.LLH;
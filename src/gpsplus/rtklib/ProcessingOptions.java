@@ -164,6 +164,12 @@ public class ProcessingOptions {
         /** earth tide correction (0:off,1:solid,2:solid+otl+pole) */
         private int tidecorr;
 
+        /** tide displacement evaluation interval (s) (0:every epoch) */
+        private double tideint;
+
+        /** stage profiling (0:off,1:on) */
+        private int prof;
+
         /** number of filter iteration */
         private int niter;
 
@@ -324,6 +330,8 @@ public class ProcessingOptions {
         mNative.tropopt = src.mNative.tropopt;
         mNative.dynamics = src.mNative.dynamics;
         mNative.tidecorr = src.mNative.tidecorr;
+        mNative.tideint = src.mNative.tideint;
+        mNative.prof = src.mNative.prof;
         mNative.niter = src.mNative.niter;
         mNative.codesmooth = src.mNative.codesmooth;
         mNative.intpref = src.mNative.intpref;
@@ -760,6 +768,34 @@ public class ProcessingOptions {
         this.mNative.tidecorr = type.getRtklibId();
     }
 
+    /**
+     * @return Earth tides evaluation interval (s) (0:every epoch)
+     */
+    public double getEarthTidesInterval() {
+        return this.mNative.tideint;
+    }
+
+    /**
+     * @param interval Earth tides evaluation interval (s) (0:every epoch)
+     */
+    public void setEarthTidesInterval(double interval) {
+        this.mNative.tideint = interval;
+    }
+
+    /**
+     * @return processing time profiling of positioning stages
+     */
+    public boolean isStageProfiling() {
+        return this.mNative.prof != 0;
+    }
+
+    /**
+     * @param on processing time profiling of positioning stages
+     */
+    public void setStageProfiling(boolean on) {
+        this.mNative.prof = on ? 1 : 0;
+    }
+
     /**
      * @return Ionosphere correction
      */
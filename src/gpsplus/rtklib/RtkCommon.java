@@ -7,6 +7,7 @@ import gpsplus.rtklib.constants.GeoidModel;
 import proguard.annotation.Keep;
 
 import java.io.File;
+import java.nio.ByteBuffer;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.Locale;
@@ -105,6 +106,18 @@ public class RtkCommon {
      * @return geoid height (m) (0.0:error)
      */
     public static native double geoidh_from_external_model(double lat, double lon, int model, String file);
+
+    /**
+     * get geoid heights of positions from geoid external model (or mod 0 for embedded)
+     * the model is kept open between calls and positions in the same grid
+     * cell share the grid values, so order positions by area for speed
+     * @param lat geodetic positions lat (rad)
+     * @param lon geodetic positions lon (rad)
+     * @param model
+     * @param file filename with complete path
+     * @return geoid heights (m) (0.0:error), null if lat and lon differ in length
+     */
+    public static native double[] geoidh_batch_from_external_model(double[] lat, double[] lon, int model, String file);
     /**
      * convert degree to degree-minute-second
      * @param deg degree
@@ -256,6 +269,122 @@ public class RtkCommon {
     }
 
 
+    /** transformations for _transform_array() and _transform_buffer() */
+    static final int TRANSFORM_ECEF2POS = 0;
+    static final int TRANSFORM_POS2ECEF = 1;
+    static final int TRANSFORM_ECEF2ENU = 2;
+    static final int TRANSFORM_COVENU = 3;
+
+    /**
+     * transform n points stored as structure of arrays
+     * @param op transformation (TRANSFORM_*)
+     * @param src I source arrays one after another
+     * @param dst O destination arrays one after another (not src)
+     * @param n number of points
+     */
+    static native void _transform_array(int op, double[] src, double[] dst, int n);
+
+    /**
+     * transform n points stored as structure of arrays in direct buffers
+     * of native order doubles
+     * @param op transformation (TRANSFORM_*)
+     * @param src I source arrays one after another
+     * @param dst O destination arrays one after another (not overlapping src)
+     * @param n number of points
+     */
+    static native void _transform_buffer(int op, ByteBuffer src, ByteBuffer dst, int n);
+
+    private static double[] transform(int op, double[] src, int n, int nout, @Nullable double[] dst) {
+        if (dst == null) dst = new double[nout * n];
+        _transform_array(op, src, dst, n);
+        return dst;
+    }
+
+    /**
+     * Transform ecef positions to geodetic positions
+     * @param xyz I ecef positions {x[n],y[n],z[n]} (m)
+     * @param n number of positions
+     * @param dst O geodetic positions {lat[n],lon[n],h[n]} (rad,m) or null. WGS84, ellipsoidal height
+     * @return dst
+     */
+    public static double[] ecef2pos(double[] xyz, int n, @Nullable double[] dst) {
+        return transform(TRANSFORM_ECEF2POS, xyz, n, 3, dst);
+    }
+
+    /**
+     * Transform ecef positions to geodetic positions
+     * @param xyz I direct buffer of ecef positions {x[n],y[n],z[n]} (m)
+     * @param dst O direct buffer of geodetic positions {lat[n],lon[n],h[n]} (rad,m)
+     * @param n number of positions
+     */
+    public static void ecef2pos(ByteBuffer xyz, ByteBuffer dst, int n) {
+        _transform_buffer(TRANSFORM_ECEF2POS, xyz, dst, n);
+    }
+
+    /**
+     * transform geodetic positions to ecef positions
+     * @param pos I geodetic positions {lat[n],lon[n],h[n]} (rad,m)
+     * @param n number of positions
+     * @param dst O ecef positions {x[n],y[n],z[n]} (m) or null
+     * @return dst
+     */
+    public static double[] pos2ecef(double[] pos, int n, @Nullable double[] dst) {
+        return transform(TRANSFORM_POS2ECEF, pos, n, 3, dst);
+    }
+
+    /**
+     * transform geodetic positions to ecef positions
+     * @param pos I direct buffer of geodetic positions {lat[n],lon[n],h[n]} (rad,m)
+     * @param dst O direct buffer of ecef positions {x[n],y[n],z[n]} (m)
+     * @param n number of positions
+     */
+    public static void pos2ecef(ByteBuffer pos, ByteBuffer dst, int n) {
+        _transform_buffer(TRANSFORM_POS2ECEF, pos, dst, n);
+    }
+
+    /**
+     * transform ecef vectors to local tangental coordinate
+     * @param src I {lat[n],lon[n],x[n],y[n],z[n]} geodetic positions (rad) and ecef vectors
+     * @param n number of vectors
+     * @param dst O vectors in local tangental coordinate {e[n],n[n],u[n]} or null
+     * @return dst
+     */
+    public static double[] ecef2enu(double[] src, int n, @Nullable double[] dst) {
+        return transform(TRANSFORM_ECEF2ENU, src, n, 3, dst);
+    }
+
+    /**
+     * transform ecef vectors to local tangental coordinate
+     * @param src I direct buffer of {lat[n],lon[n],x[n],y[n],z[n]}
+     * @param dst O direct buffer of {e[n],n[n],u[n]}
+     * @param n number of vectors
+     */
+    public static void ecef2enu(ByteBuffer src, ByteBuffer dst, int n) {
+        _transform_buffer(TRANSFORM_ECEF2ENU, src, dst, n);
+    }
+
+    /**
+     * transform ecef covariances to local tangental coordinate
+     * @param src I {lat[n],lon[n],xx[n],yy[n],zz[n],xy[n],yz[n],zx[n]} geodetic
+     *            positions (rad) and covariances in ecef coordinate
+     * @param n number of covariances
+     * @param dst O {ee[n],nn[n],uu[n],en[n],nu[n],ue[n]} or null
+     * @return dst
+     */
+    public static double[] covenu(double[] src, int n, @Nullable double[] dst) {
+        return transform(TRANSFORM_COVENU, src, n, 6, dst);
+    }
+
+    /**
+     * transform ecef covariances to local tangental coordinate
+     * @param src I direct buffer of {lat[n],lon[n],xx[n],yy[n],zz[n],xy[n],yz[n],zx[n]}
+     * @param dst O direct buffer of {ee[n],nn[n],uu[n],en[n],nu[n],ue[n]}
+     * @param n number of covariances
+     */
+    public static void covenu(ByteBuffer src, ByteBuffer dst, int n) {
+        _transform_buffer(TRANSFORM_COVENU, src, dst, n);
+    }
+
     public static class Position3d {
         protected final double mPos[];
 
@@ -3,6 +3,8 @@ package gpsplus.rtklib;
 import gpsplus.rtklib.RtkCommon.Position3d;
 import proguard.annotation.Keep;
 
+import java.nio.ByteBuffer;
+
 public class RtkControlResult {
 
     /**
@@ -73,6 +75,23 @@ public class RtkControlResult {
         this.mErrMsg = errMsg;
     }
 
+    /**
+     * Decode rtk status from status snapshot
+     * @param snap status snapshot buffer
+     * @param errMsg error message buffer
+     */
+    void setSnapshot(ByteBuffer snap, String errMsg) {
+        for (int i = 0; i < 6; ++i) {
+            this.mRb[i] = snap.getDouble(RtkServerStatusSnapshot.OFF_RB + 8 * i);
+        }
+        this.sol.setSolution(snap, RtkServerStatusSnapshot.OFF_SOL);
+        this.mNx = snap.getInt(RtkServerStatusSnapshot.OFF_NX);
+        this.mNa = snap.getInt(RtkServerStatusSnapshot.OFF_NA);
+        this.mTt = snap.getDouble(RtkServerStatusSnapshot.OFF_TT);
+        this.mNfix = snap.getInt(RtkServerStatusSnapshot.OFF_NFIX);
+        this.mErrMsg = errMsg;
+    }
+
     public Position3d getBasePosition() {
         return new Position3d(this.mRb[0], this.mRb[1], this.mRb[2]);
     }
@@ -4,6 +4,8 @@ import gpsplus.rtkgps.MainActivity;
 import proguard.annotation.Keep;
 
 import java.io.File;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 
 import javax.annotation.Nonnull;
 
@@ -27,6 +29,22 @@ public class RtkServer {
 
     private final Solution.SolutionBuffer mSolutionBuffer;
 
+    /**
+     * solution ring shared with native rtk server and number of read records
+     */
+    private ByteBuffer mSolutionRing;
+    private int mSolutionRingTail;
+
+    /**
+     * last status snapshot read from native rtk server
+     */
+    private RtkServerStatusSnapshot mStatusSnapshot;
+
+    /**
+     * last stage profile read from native rtk server
+     */
+    private RtkServerStageProfile mStageProfile;
+
     private RtkServerSettings mSettings;
 
 
@@ -67,8 +85,7 @@ public class RtkServer {
     }
 
     public RtkServerStreamStatus getStreamStatus(RtkServerStreamStatus status) {
-        if (status == null) status = new RtkServerStreamStatus();
-        _getStreamStatus(status);
+        status = readStatusSnapshot().getStreamStatus(status);
         // XXX
         if ((mStatus == RtkServerStreamStatus.STATE_WAIT)
                 && (status.getInputRoverStatus() > RtkServerStreamStatus.STATE_WAIT))
@@ -98,17 +115,61 @@ public class RtkServer {
     }
 
     /**
-     * XXX
+     * Read new solutions from the solution ring without locking the rtk server.
+     * At most {@link gpsplus.rtklib.constants.Constants#MAXSOLBUF} solutions are returned, the rest
+     * stay in the ring for the next call.
      */
-    public Solution[] readSolutionBuffer() {
-        _readSolutionBuffer(mSolutionBuffer);
+    public synchronized Solution[] readSolutionBuffer() {
+        if (mSolutionRing == null) {
+            mSolutionRing = _getSolutionRing();
+            if (mSolutionRing == null) return new Solution[0];
+            mSolutionRing.order(ByteOrder.nativeOrder());
+            mSolutionRingTail = mSolutionRing.getInt(Solution.SolutionBuffer.RING_TAIL);
+        }
+        mSolutionRingTail = mSolutionBuffer.readRing(mSolutionRing,
+                _getSolutionRingHead(), mSolutionRingTail);
+        _setSolutionRingTail(mSolutionRingTail);
         return mSolutionBuffer.get();
     }
 
+    /**
+     * @return number of solutions dropped as the solution ring was full
+     */
+    public synchronized int getSolutionRingOverflow() {
+        if (mSolutionRing == null) return 0;
+        return Solution.SolutionBuffer.getRingOverflow(mSolutionRing);
+    }
+
+    /**
+     * Read the last status snapshot of the rtk server with a single native call.
+     * The snapshot is written by the server thread once per epoch and holds observation
+     * status of all receivers, rtk status, stream status and satellite status.
+     * The returned object is reused by the next call.
+     */
+    public synchronized RtkServerStatusSnapshot readStatusSnapshot() {
+        if (mStatusSnapshot == null) {
+            mStatusSnapshot = new RtkServerStatusSnapshot(_getStatusSnapshotSize());
+        }
+        mStatusSnapshot.setSequence(_getStatusSnapshot(mStatusSnapshot.getBuffer()));
+        return mStatusSnapshot;
+    }
+
+    /**
+     * Read the processing time profile of positioning stages and stream read/decode.
+     * The profile is collected only if stage profiling is enabled in the processing
+     * options. The returned object is reused by the next call.
+     * @param reset reset the profile of the rtk server after read
+     */
+    public synchronized RtkServerStageProfile readStageProfile(boolean reset) {
+        if (mStageProfile == null) {
+            mStageProfile = new RtkServerStageProfile(_getStageProfileSize());
+        }
+        mStageProfile.setEnabled(_getStageProfile(mStageProfile.getBuffer(), reset));
+        return mStageProfile;
+    }
+
     public RtkControlResult getRtkStatus(RtkControlResult dst) {
-        if (dst == null) dst = new RtkControlResult();
-        _getRtkStatus(dst);
-        return dst;
+        return readStatusSnapshot().getRtkStatus(dst);
     }
 
     public void setServerSettings(RtkServerSettings settings) {
@@ -121,13 +182,7 @@ public class RtkServer {
     }
 
     private RtkServerObservationStatus getObservationStatus(int receiver, RtkServerObservationStatus status) {
-        if (status == null) {
-            status = new RtkServerObservationStatus(receiver);
-        }else {
-            status.setReceiver(receiver);
-        }
-        _getObservationStatus(receiver, status.getNative());
-        return status;
+        return readStatusSnapshot().getObservationStatus(receiver, status);
     }
 
     public void sendStartupCommands(int stream) {
@@ -174,13 +229,19 @@ public class RtkServer {
 
     private native void _destroy();
 
-    private native void _getStreamStatus(RtkServerStreamStatus status);
+    private native int _getStatusSnapshot(ByteBuffer dst);
+
+    private native int _getStatusSnapshotSize();
+
+    private native boolean _getStageProfile(ByteBuffer dst, boolean reset);
+
+    private native int _getStageProfileSize();
 
-    private native void _getObservationStatus(int receiver, RtkServerObservationStatus.Native status);
+    private native ByteBuffer _getSolutionRing();
 
-    private native void _getRtkStatus(RtkControlResult dst);
+    private native int _getSolutionRingHead();
 
-    private native void _readSolutionBuffer(Solution.SolutionBuffer dst);
+    private native void _setSolutionRingTail(int tail);
 
     private native void _writeCommands(String cmds[]);
 
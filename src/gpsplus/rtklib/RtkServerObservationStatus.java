@@ -7,6 +7,7 @@ import gpsplus.rtklib.constants.Constants;
 
 import org.junit.Assert;
 
+import java.nio.ByteBuffer;
 import java.text.DecimalFormat;
 import java.util.Arrays;
 
@@ -212,6 +213,35 @@ public class RtkServerObservationStatus {
        mNative.vsat[mNative.ns]=vsat;
        mNative.ns++;
     }
+
+    /**
+     * Decode observation status from status snapshot
+     * @param snap status snapshot buffer
+     * @param off offset of observation status (snapobs_t)
+     * @param maxobs size of the snapshot arrays (MAXOBS)
+     */
+    void setSnapshot(ByteBuffer snap, int off, int maxobs) {
+        final int offAz = off + RtkServerStatusSnapshot.OBS_AZ;
+        final int offEl = offAz + 8 * maxobs;
+        final int offSat = offEl + 8 * maxobs;
+        final int offSnr = offSat + 2 * maxobs;
+        final int offVsat = offSnr + 6 * maxobs;
+        final int ns = Math.min(snap.getInt(off + RtkServerStatusSnapshot.OBS_NS), maxobs);
+
+        mNative.time.setGTime(snap.getLong(off + RtkServerStatusSnapshot.OBS_TIME),
+                snap.getDouble(off + RtkServerStatusSnapshot.OBS_SEC));
+        for (int i = 0; i < ns; ++i) {
+            mNative.sat[i] = snap.getShort(offSat + 2 * i);
+            mNative.az[i] = snap.getDouble(offAz + 8 * i);
+            mNative.el[i] = snap.getDouble(offEl + 8 * i);
+            mNative.freq1Snr[i] = snap.getShort(offSnr + 2 * i);
+            mNative.freq2Snr[i] = snap.getShort(offSnr + 2 * (maxobs + i));
+            mNative.freq3Snr[i] = snap.getShort(offSnr + 2 * (2 * maxobs + i));
+            mNative.vsat[i] = snap.get(offVsat + i);
+        }
+        mNative.ns = ns;
+    }
+
     @Override
     public boolean equals(Object o) {
         if (this == o) {
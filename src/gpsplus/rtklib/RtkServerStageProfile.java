@@ -0,0 +1,125 @@
+package gpsplus.rtklib;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * Processing time profile of positioning stages and stream read/decode
+ * (prof_t in rtklib.h). The profile is copied to this direct buffer with a
+ * single native call and decoded here.
+ */
+public class RtkServerStageProfile {
+
+    /* profile stages (PRF_???) */
+    public static final int STAGE_PNTPOS = 0;
+    public static final int STAGE_SATPOSS = 1;
+    public static final int STAGE_ZDRES = 2;
+    public static final int STAGE_DDRES = 3;
+    public static final int STAGE_FILTER = 4;
+    public static final int STAGE_LAMBDA = 5;
+    public static final int STAGE_HOLDAMB = 6;
+    public static final int STAGE_VALPOS = 7;
+    public static final int STAGE_PPPRES = 8;
+    public static final int STAGE_PPPAR = 9;
+    public static final int STAGE_READ = 10;
+    public static final int STAGE_DECODE = 11;
+
+    /** number of profile stages (NPRFSTAGE) */
+    public static final int NSTAGE = 12;
+
+    /** number of histogram bins (NPRFBIN), bin i: time < 2^i us */
+    public static final int NBIN = 20;
+
+    /* profile stage offsets (prfstage_t) */
+    static final int STAGE_SIZE = 104;
+    static final int STG_N = 0;
+    static final int STG_SUM = 8;
+    static final int STG_MAX = 16;
+    static final int STG_HIST = 24;
+
+    private final ByteBuffer mBuffer;
+
+    private boolean mEnabled;
+
+    RtkServerStageProfile(int size) {
+        mBuffer = ByteBuffer.allocateDirect(size).order(ByteOrder.nativeOrder());
+        mEnabled = false;
+    }
+
+    ByteBuffer getBuffer() {
+        return mBuffer;
+    }
+
+    void setEnabled(boolean enabled) {
+        mEnabled = enabled;
+    }
+
+    /**
+     * @return stage profiling enabled in processing options
+     */
+    public boolean isEnabled() {
+        return mEnabled;
+    }
+
+    /**
+     * @return number of calls of stage
+     */
+    public long getCount(int stage) {
+        return mBuffer.getInt(stageOffset(stage) + STG_N) & 0xffffffffL;
+    }
+
+    /**
+     * @return total time of stage (us)
+     */
+    public double getTotalTime(int stage) {
+        return mBuffer.getDouble(stageOffset(stage) + STG_SUM);
+    }
+
+    /**
+     * @return mean time of stage (us)
+     */
+    public double getMeanTime(int stage) {
+        final long n = getCount(stage);
+        return n > 0 ? getTotalTime(stage) / n : 0.0;
+    }
+
+    /**
+     * @return max time of stage (us)
+     */
+    public double getMaxTime(int stage) {
+        return mBuffer.getDouble(stageOffset(stage) + STG_MAX);
+    }
+
+    /**
+     * @param bin histogram bin (0 to {@link #NBIN}-1)
+     * @return number of calls in histogram bin
+     */
+    public long getHistogram(int stage, int bin) {
+        if (bin < 0 || bin >= NBIN) throw new IndexOutOfBoundsException();
+        return mBuffer.getInt(stageOffset(stage) + STG_HIST + bin * 4) & 0xffffffffL;
+    }
+
+    /**
+     * Estimate quantile of stage time from histogram (same as prfquant()).
+     * @param p probability (0-1)
+     * @return upper bound of histogram bin including quantile (us)
+     */
+    public double getQuantile(int stage, double p) {
+        final long n = getCount(stage);
+        final double max = getMaxTime(stage);
+        double c = 0.0, q;
+
+        if (n <= 0) return 0.0;
+        for (int i = 0; i < NBIN - 1; ++i) {
+            if ((c += getHistogram(stage, i)) < p * n) continue;
+            q = Math.scalb(1.0, i);
+            return q < max ? q : max;
+        }
+        return max;
+    }
+
+    private int stageOffset(int stage) {
+        if (stage < 0 || stage >= NSTAGE) throw new IndexOutOfBoundsException();
+        return stage * STAGE_SIZE;
+    }
+}
@@ -0,0 +1,241 @@
+package gpsplus.rtklib;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.Charset;
+
+/**
+ * Packed status snapshot of the rtk server (svrsnap_t in rtklib.h).
+ * The server thread writes the snapshot once per epoch, it is copied to
+ * this direct buffer with a single native call and decoded here.
+ */
+public class RtkServerStatusSnapshot {
+
+    /** snapshot version (SNAPVER) */
+    static final int VERSION = 1;
+
+    /* header offsets (svrsnap_t) */
+    static final int OFF_VER = 0;
+    static final int OFF_SIZE = 4;
+    static final int OFF_SEQ = 8;
+    static final int OFF_MAXOBS = 12;
+    static final int OFF_OFFOBS = 16;
+    static final int OFF_SIZEOBS = 20;
+    static final int OFF_OFFSAT = 24;
+    static final int OFF_OFFSTR = 28;
+    static final int OFF_OFFERR = 32;
+    static final int OFF_SSTAT = 40;
+    static final int OFF_SOL = 72;
+    static final int OFF_RB = 224;
+    static final int OFF_TT = 272;
+    static final int OFF_NX = 280;
+    static final int OFF_NA = 284;
+    static final int OFF_NFIX = 288;
+    static final int OFF_NSAT = 292;
+    static final int OFF_CPUTIME = 296;
+    static final int OFF_PRCOUT = 300;
+
+    /* observation status offsets (snapobs_t), arrays of maxobs elements */
+    static final int OBS_TIME = 0;
+    static final int OBS_SEC = 8;
+    static final int OBS_NS = 16;
+    static final int OBS_AZ = 24;
+
+    /* satellite status offsets (snapsat_t) */
+    static final int SAT_SIZE = 28;
+    static final int SAT_SAT = 0;
+    static final int SAT_VS = 2;
+    static final int SAT_VSAT = 3;
+    static final int SAT_FIX = 4;
+    static final int SAT_SLIP = 7;
+    static final int SAT_LOCK = 8;
+    static final int SAT_OUTC = 10;
+    static final int SAT_AZ = 12;
+    static final int SAT_EL = 16;
+    static final int SAT_RESP = 20;
+    static final int SAT_RESC = 24;
+
+    private static final Charset ASCII = Charset.forName("US-ASCII");
+
+    private final ByteBuffer mBuffer;
+
+    private int mSeq;
+
+    RtkServerStatusSnapshot(int size) {
+        mBuffer = ByteBuffer.allocateDirect(size).order(ByteOrder.nativeOrder());
+        mSeq = 0;
+    }
+
+    ByteBuffer getBuffer() {
+        return mBuffer;
+    }
+
+    void setSequence(int seq) {
+        mSeq = seq;
+    }
+
+    /**
+     * @return sequence number of snapshot (0: no snapshot)
+     */
+    public int getSequence() {
+        return mSeq;
+    }
+
+    public boolean isValid() {
+        return mSeq != 0 && mBuffer.getInt(OFF_VER) == VERSION;
+    }
+
+    /**
+     * @param receiver {@link RtkServer#RECEIVER_ROVER}, {@link RtkServer#RECEIVER_BASE},
+     * {@link RtkServer#RECEIVER_EPHEM}
+     */
+    public RtkServerObservationStatus getObservationStatus(int receiver, RtkServerObservationStatus dst) {
+        if (receiver < RtkServer.RECEIVER_ROVER || receiver > RtkServer.RECEIVER_EPHEM) {
+            throw new IllegalArgumentException();
+        }
+        if (dst == null) dst = new RtkServerObservationStatus(receiver);
+        if (!isValid()) {
+            dst.clear();
+            dst.setReceiver(receiver);
+            return dst;
+        }
+        dst.setReceiver(receiver);
+        dst.setSnapshot(mBuffer,
+                mBuffer.getInt(OFF_OFFOBS) + receiver * mBuffer.getInt(OFF_SIZEOBS),
+                mBuffer.getInt(OFF_MAXOBS));
+        return dst;
+    }
+
+    public RtkControlResult getRtkStatus(RtkControlResult dst) {
+        if (dst == null) dst = new RtkControlResult();
+        if (isValid()) dst.setSnapshot(mBuffer, getString(mBuffer.getInt(OFF_OFFERR)));
+        return dst;
+    }
+
+    public RtkServerStreamStatus getStreamStatus(RtkServerStreamStatus dst) {
+        if (dst == null) dst = new RtkServerStreamStatus();
+        if (!isValid()) {
+            dst.clear();
+            return dst;
+        }
+        dst.setStatus(
+                mBuffer.getInt(OFF_SSTAT),
+                mBuffer.getInt(OFF_SSTAT + 4),
+                mBuffer.getInt(OFF_SSTAT + 8),
+                mBuffer.getInt(OFF_SSTAT + 12),
+                mBuffer.getInt(OFF_SSTAT + 16),
+                mBuffer.getInt(OFF_SSTAT + 20),
+                mBuffer.getInt(OFF_SSTAT + 24),
+                mBuffer.getInt(OFF_SSTAT + 28),
+                getString(mBuffer.getInt(OFF_OFFSTR))
+                );
+        return dst;
+    }
+
+    /**
+     * @return CPU time (ms) for a processing cycle
+     */
+    public int getCpuTime() {
+        return isValid() ? mBuffer.getInt(OFF_CPUTIME) : 0;
+    }
+
+    /**
+     * @return missing observation data count
+     */
+    public int getMissingObsCount() {
+        return isValid() ? mBuffer.getInt(OFF_PRCOUT) : 0;
+    }
+
+    /**
+     * @return number of satellite status (rover satellites)
+     */
+    public int getSatCount() {
+        return isValid() ? mBuffer.getInt(OFF_NSAT) : 0;
+    }
+
+    /**
+     * @return satellite number of satellite status idx
+     */
+    public int getSatNumber(int idx) {
+        return mBuffer.getShort(satOffset(idx) + SAT_SAT);
+    }
+
+    /**
+     * @return valid satellite flag (single, L1)
+     */
+    public boolean isSatValid(int idx) {
+        final int off = satOffset(idx);
+        return mBuffer.get(off + SAT_VS) != 0 || mBuffer.get(off + SAT_VSAT) != 0;
+    }
+
+    /**
+     * @param freq frequency index (0:L1,1:L2,2:L5)
+     * @return ambiguity fix flag (1:fix,2:float,3:hold)
+     */
+    public int getSatFix(int idx, int freq) {
+        return mBuffer.get(satOffset(idx) + SAT_FIX + freq) & 0xff;
+    }
+
+    /**
+     * @param freq frequency index (0:L1,1:L2,2:L5)
+     * @return cycle-slip flag
+     */
+    public boolean isSatSlip(int idx, int freq) {
+        return (mBuffer.get(satOffset(idx) + SAT_SLIP) & (1 << freq)) != 0;
+    }
+
+    /**
+     * @return lock counter of phase L1
+     */
+    public int getSatLock(int idx) {
+        return mBuffer.getShort(satOffset(idx) + SAT_LOCK) & 0xffff;
+    }
+
+    /**
+     * @return obs outage counter of phase L1
+     */
+    public int getSatOutage(int idx) {
+        return mBuffer.getShort(satOffset(idx) + SAT_OUTC) & 0xffff;
+    }
+
+    /**
+     * @return satellite azimuth angle (rad)
+     */
+    public float getSatAzimuth(int idx) {
+        return mBuffer.getFloat(satOffset(idx) + SAT_AZ);
+    }
+
+    /**
+     * @return satellite elevation angle (rad)
+     */
+    public float getSatElevation(int idx) {
+        return mBuffer.getFloat(satOffset(idx) + SAT_EL);
+    }
+
+    /**
+     * @return residual of pseudorange L1 (m)
+     */
+    public float getSatPseudorangeResidual(int idx) {
+        return mBuffer.getFloat(satOffset(idx) + SAT_RESP);
+    }
+
+    /**
+     * @return residual of carrier-phase L1 (m)
+     */
+    public float getSatCarrierPhaseResidual(int idx) {
+        return mBuffer.getFloat(satOffset(idx) + SAT_RESC);
+    }
+
+    private int satOffset(int idx) {
+        if (idx < 0 || idx >= getSatCount()) throw new IndexOutOfBoundsException();
+        return mBuffer.getInt(OFF_OFFSAT) + idx * SAT_SIZE;
+    }
+
+    String getString(int off) {
+        int len = 0;
+        while (mBuffer.get(off + len) != 0) ++len;
+        final byte bytes[] = new byte[len];
+        for (int i = 0; i < len; ++i) bytes[i] = mBuffer.get(off + i);
+        return new String(bytes, ASCII);
+    }
+}
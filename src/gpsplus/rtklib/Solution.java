@@ -6,6 +6,7 @@ import gpsplus.rtklib.constants.Constants;
 import gpsplus.rtklib.constants.SolutionStatus;
 import proguard.annotation.Keep;
 
+import java.nio.ByteBuffer;
 import java.util.Arrays;
 import java.util.Locale;
 
@@ -185,6 +186,26 @@ public class Solution {
         this.mDtr[5] = dtr5;
     }
 
+    /**
+     * set solution from packed solution record (solrec_t)
+     * @param rec solution ring in native byte order
+     * @param off record offset (bytes)
+     */
+    void setSolution(ByteBuffer rec, int off) {
+        this.mTime.setGTime(rec.getLong(off + SolutionBuffer.REC_TIME),
+                rec.getDouble(off + SolutionBuffer.REC_SEC));
+        this.mType = rec.get(off + SolutionBuffer.REC_TYPE) & 0xff;
+        this.mStatus = SolutionStatus.valueOf(rec.get(off + SolutionBuffer.REC_STAT) & 0xff);
+        this.mNs = rec.get(off + SolutionBuffer.REC_NS) & 0xff;
+        this.mAge = rec.getFloat(off + SolutionBuffer.REC_AGE);
+        this.mRatio = rec.getFloat(off + SolutionBuffer.REC_RATIO);
+        for (int i = 0; i < 6; ++i) {
+            this.mRr[i] = rec.getDouble(off + SolutionBuffer.REC_RR + 8 * i);
+            this.mQr[i] = rec.getFloat(off + SolutionBuffer.REC_QR + 4 * i);
+            this.mDtr[i] = rec.getDouble(off + SolutionBuffer.REC_DTR + 8 * i);
+        }
+    }
+
     /**
      * @return solution status
      */
@@ -209,6 +230,27 @@ public class Solution {
 
     public static class SolutionBuffer {
 
+        /* solution ring header offsets (solringh_t) */
+        static final int RING_NREC = 0;
+        static final int RING_SIZE = 4;
+        static final int RING_HEAD = 64;
+        static final int RING_OVER = 68;
+        static final int RING_TAIL = 128;
+        static final int RING_RECORDS = 192;
+
+        /* solution record offsets (solrec_t) */
+        static final int REC_SEQ = 0;
+        static final int REC_TYPE = 4;
+        static final int REC_STAT = 5;
+        static final int REC_NS = 6;
+        static final int REC_TIME = 8;
+        static final int REC_SEC = 16;
+        static final int REC_RR = 24;
+        static final int REC_DTR = 72;
+        static final int REC_QR = 120;
+        static final int REC_AGE = 144;
+        static final int REC_RATIO = 148;
+
         Solution mBuffer[];
 
         /**
@@ -233,26 +275,31 @@ public class Solution {
             return mBuffer[mNSol-1];
         }
 
-        // Used in native code
-        @Keep
-        void setSolution(
-                int idx,
-                long time_time, double time_sec,
-                int type,
-                int status,
-                int ns,
-                float age,
-                float ratio,
-                double rr0, double rr1, double rr2, double rr3, double rr4, double rr5,
-                float qr0, float qr1, float qr2, float qr3, float qr4, float qr5,
-                double dtr0, double dtr1, double dtr2, double dtr3, double dtr4, double dtr5
-                ) {
-            mBuffer[idx].setSolution(time_time, time_sec, type,
-                    status, ns, age, ratio,
-                    rr0, rr1, rr2, rr3, rr4, rr5,
-                    qr0, qr1, qr2, qr3, qr4, qr5,
-                    dtr0, dtr1, dtr2, dtr3, dtr4, dtr5);
+        /**
+         * Read solutions from solution ring (see solringh_t and solrec_t in rtklib.h).
+         * Single consumer: calls must be serialized.
+         * @param ring solution ring in native byte order
+         * @param head number of written records (loaded with acquire)
+         * @param tail number of read records
+         * @return new number of read records
+         */
+        int readRing(ByteBuffer ring, int head, int tail) {
+            final int nrec = ring.getInt(RING_NREC);
+            final int size = ring.getInt(RING_SIZE);
+
+            mNSol = 0;
+            while (tail != head && mNSol < Constants.MAXSOLBUF) {
+                mBuffer[mNSol++].setSolution(ring, RING_RECORDS + (tail & (nrec - 1)) * size);
+                ++tail;
+            }
+            return tail;
         }
 
+        /**
+         * @return number of solutions dropped as solution ring was full
+         */
+        static int getRingOverflow(ByteBuffer ring) {
+            return ring.getInt(RING_OVER);
+        }
     }
 }
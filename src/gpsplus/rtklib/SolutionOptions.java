@@ -56,7 +56,7 @@ public class SolutionOptions {
         /** solution of static mode (0:all,1:single)  */
         private int solstatic;
 
-        /** solution statistics level (0:off,1:states,2:residuals) */
+        /** solution statistics level (0:off,1:states,2:residuals,3:residuals binary) */
         private int sstat;
 
         /** debug trace level (0:off,1-5:debug) */
@@ -236,14 +236,14 @@ public class SolutionOptions {
         return this;
     }
 
-    /** solution statistics level (0:off,1:states,2:residuals) */
+    /** solution statistics level (0:off,1:states,2:residuals,3:residuals binary) */
     public int getSolutionStatsLevel() {
         return this.mNative.sstat;
     }
 
-    /** solution statistics level (0:off,1:states,2:residuals) */
+    /** solution statistics level (0:off,1:states,2:residuals,3:residuals binary) */
     public SolutionOptions setSolutionStatsLevel(int level) {
-        if (level < 0 || level > 2) throw new IllegalArgumentException();
+        if (level < 0 || level > 3) throw new IllegalArgumentException();
         this.mNative.sstat = level;
         return this;
     }
@@ -8,7 +8,8 @@ import gpsplus.rtkgps.R;
  * {@link #XYZ},
  * {@link #ENU},
  * {@link #NMEA},
- * {@link #GSIF}
+ * {@link #GSIF},
+ * {@link #BIN}
  */
 public enum SolutionFormat implements IHasRtklibId {
 
@@ -25,7 +26,10 @@ public enum SolutionFormat implements IHasRtklibId {
     NMEA(3, R.string.solf_nmea),
 
     /** solution format: GSI-F1/2/3 */
-    GSIF(4, R.string.solf_gsif)
+    GSIF(4, R.string.solf_gsif),
+
+    /** solution format: binary records */
+    BIN(6, R.string.solf_bin)
     ;
 
     private final int mRtklibId;